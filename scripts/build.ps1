@@ -96,6 +96,9 @@ This script provides helpers for building msquic.
 .PARAMETER UseSystemOpenSSLCrypto
     Use system provided OpenSSL libcrypto rather then statically linked. Only affects OpenSSL Linux builds
 
+.PARAMETER UseNativeCrypto
+    Use the built-in vectorized ChaCha20 header protection when the CPU supports it. Only affects OpenSSL x64 builds
+
 .PARAMETER EnableHighResolutionTimers
     Configures the system to use high resolution timers.
 
@@ -222,6 +225,9 @@ param (
     [Parameter(Mandatory = $false)]
     [switch]$UseSystemOpenSSLCrypto = $false,
 
+    [Parameter(Mandatory = $false)]
+    [switch]$UseNativeCrypto = $false,
+
     [Parameter(Mandatory = $false)]
     [switch]$EnableHighResolutionTimers = $false,
 
@@ -531,6 +537,9 @@ function CMake-Generate {
     if ($UseSystemOpenSSLCrypto) {
         $Arguments += " -DQUIC_USE_SYSTEM_LIBCRYPTO=on"
     }
+    if ($UseNativeCrypto) {
+        $Arguments += " -DQUIC_NATIVE_CRYPTO=on"
+    }
     if ($EnableHighResolutionTimers) {
         $Arguments += " -DQUIC_HIGH_RES_TIMERS=on"
     }
@@ -1060,51 +1060,36 @@ Error:
     return Status;
 }
 
+//
+// Validates a send and appends it to the stream's queue of API send requests.
+// On success, NeedsFlush is set if no earlier request is still waiting to be
+// flushed, meaning the caller must arrange for the stream to be flushed. In
+// that case a QUIC_STREAM_REF_OPERATION reference is also taken on the stream
+// if AddOperationRef is set.
+//
 _IRQL_requires_max_(DISPATCH_LEVEL)
+static
 QUIC_STATUS
-QUIC_API
-MsQuicStreamSend(
-    _In_ _Pre_defensive_ HQUIC Handle,
-    _In_reads_(BufferCount) _Pre_defensive_
+QuicStreamQueueApiSend(
+    _In_ QUIC_STREAM* Stream,
+    _In_reads_(BufferCount)
         const QUIC_BUFFER * const Buffers,
     _In_ uint32_t BufferCount,
     _In_ QUIC_SEND_FLAGS Flags,
-    _In_opt_ void* ClientSendContext
+    _In_opt_ void* ClientSendContext,
+    _In_ BOOLEAN AddOperationRef,
+    _Out_ BOOLEAN* NeedsFlush
     )
 {
     QUIC_STATUS Status;
-    QUIC_STREAM* Stream;
-    QUIC_CONNECTION* Connection;
+    QUIC_CONNECTION* Connection = Stream->Connection;
     uint64_t TotalLength;
     QUIC_SEND_REQUEST* SendRequest;
-    BOOLEAN QueueOper = TRUE;
-    const BOOLEAN IsPriority = !!(Flags & QUIC_SEND_FLAG_PRIORITY_WORK);
-    BOOLEAN SendInline;
-    QUIC_OPERATION* Oper;
-
-    QuicTraceEvent(
-        ApiEnter,
-        "[ api] Enter %u (%p).",
-        QUIC_TRACE_API_STREAM_SEND,
-        Handle);
-
-    if (!IS_STREAM_HANDLE(Handle) ||
-        (Buffers == NULL && BufferCount != 0)) {
-        Status = QUIC_STATUS_INVALID_PARAMETER;
-        goto Exit;
-    }
-
-#pragma prefast(suppress: __WARNING_25024, "Pointer cast already validated.")
-    Stream = (QUIC_STREAM*)Handle;
-
-    CXPLAT_TEL_ASSERT(!Stream->Flags.HandleClosed);
-    CXPLAT_TEL_ASSERT(!Stream->Flags.Freed);
 
-    Connection = Stream->Connection;
+    *NeedsFlush = FALSE;
 
     if (Connection->State.ClosedRemotely) {
-        Status = QUIC_STATUS_ABORTED;
-        goto Exit;
+        return QUIC_STATUS_ABORTED;
     }
 
     TotalLength = 0;
@@ -1118,20 +1103,18 @@ MsQuicStreamSend(
             "[strm][%p] ERROR, %s.",
             Stream,
             "Send request total length exceeds max");
-        Status = QUIC_STATUS_INVALID_PARAMETER;
-        goto Exit;
+        return QUIC_STATUS_INVALID_PARAMETER;
     }
 
 #pragma prefast(suppress: __WARNING_6014, "Memory is correctly freed (QuicStreamCompleteSendRequest).")
     SendRequest = CxPlatPoolAlloc(&Connection->Partition->SendRequestPool);
     if (SendRequest == NULL) {
-        Status = QUIC_STATUS_OUT_OF_MEMORY;
         QuicTraceEvent(
             AllocFailure,
             "Allocation of '%s' failed. (%llu bytes)",
             "Stream Send request",
             0);
-        goto Exit;
+        return QUIC_STATUS_OUT_OF_MEMORY;
     }
 
     QuicTraceEvent(
@@ -1149,14 +1132,6 @@ MsQuicStreamSend(
     SendRequest->TotalLength = TotalLength;
     SendRequest->ClientContext = ClientSendContext;
 
-#pragma warning(push)
-#pragma warning(disable:6240) // CXPLAT_AT_DISPATCH only really does anything for kernel mode
-    SendInline =
-        !Connection->Settings.SendBufferingEnabled &&
-        !CXPLAT_AT_DISPATCH() && // Never run inline if at DISPATCH
-        Connection->WorkerThreadID == CxPlatCurThreadID();
-#pragma warning(pop)
-
     CxPlatDispatchLockAcquire(&Stream->ApiSendRequestLock);
     if (!Stream->Flags.SendEnabled) {
         Status =
@@ -1165,14 +1140,15 @@ MsQuicStreamSend(
                 QUIC_STATUS_INVALID_STATE;
     } else {
         QUIC_SEND_REQUEST** ApiSendRequestsTail = &Stream->ApiSendRequests;
+        *NeedsFlush = TRUE;
         while (*ApiSendRequestsTail != NULL) {
             ApiSendRequestsTail = &((*ApiSendRequestsTail)->Next);
-            QueueOper = FALSE; // Not necessary if the previous send hasn't been flushed yet.
+            *NeedsFlush = FALSE; // Not necessary if the previous send hasn't been flushed yet.
         }
         *ApiSendRequestsTail = SendRequest;
         Status = QUIC_STATUS_SUCCESS;
 
-        if (!SendInline && QueueOper) {
+        if (AddOperationRef && *NeedsFlush) {
             //
             // Async stream operations need to hold a ref on the stream so that
             // the stream isn't freed before the operation can be processed. The
@@ -1185,6 +1161,69 @@ MsQuicStreamSend(
 
     if (QUIC_FAILED(Status)) {
         CxPlatPoolFree(SendRequest);
+    }
+
+    return Status;
+}
+
+_IRQL_requires_max_(DISPATCH_LEVEL)
+QUIC_STATUS
+QUIC_API
+MsQuicStreamSend(
+    _In_ _Pre_defensive_ HQUIC Handle,
+    _In_reads_(BufferCount) _Pre_defensive_
+        const QUIC_BUFFER * const Buffers,
+    _In_ uint32_t BufferCount,
+    _In_ QUIC_SEND_FLAGS Flags,
+    _In_opt_ void* ClientSendContext
+    )
+{
+    QUIC_STATUS Status;
+    QUIC_STREAM* Stream;
+    QUIC_CONNECTION* Connection;
+    BOOLEAN QueueOper;
+    const BOOLEAN IsPriority = !!(Flags & QUIC_SEND_FLAG_PRIORITY_WORK);
+    BOOLEAN SendInline;
+    QUIC_OPERATION* Oper;
+
+    QuicTraceEvent(
+        ApiEnter,
+        "[ api] Enter %u (%p).",
+        QUIC_TRACE_API_STREAM_SEND,
+        Handle);
+
+    if (!IS_STREAM_HANDLE(Handle) ||
+        (Buffers == NULL && BufferCount != 0)) {
+        Status = QUIC_STATUS_INVALID_PARAMETER;
+        goto Exit;
+    }
+
+#pragma prefast(suppress: __WARNING_25024, "Pointer cast already validated.")
+    Stream = (QUIC_STREAM*)Handle;
+
+    CXPLAT_TEL_ASSERT(!Stream->Flags.HandleClosed);
+    CXPLAT_TEL_ASSERT(!Stream->Flags.Freed);
+
+    Connection = Stream->Connection;
+
+#pragma warning(push)
+#pragma warning(disable:6240) // CXPLAT_AT_DISPATCH only really does anything for kernel mode
+    SendInline =
+        !Connection->Settings.SendBufferingEnabled &&
+        !CXPLAT_AT_DISPATCH() && // Never run inline if at DISPATCH
+        Connection->WorkerThreadID == CxPlatCurThreadID();
+#pragma warning(pop)
+
+    Status =
+        QuicStreamQueueApiSend(
+            Stream,
+            Buffers,
+            BufferCount,
+            Flags,
+            ClientSendContext,
+            !SendInline,
+            &QueueOper);
+    if (QUIC_FAILED(Status)) {
         goto Exit;
     }
 
@@ -1268,6 +1307,161 @@ Exit:
     return Status;
 }
 
+_IRQL_requires_max_(DISPATCH_LEVEL)
+QUIC_STATUS
+QUIC_API
+MsQuicStreamSendBatch(
+    _In_ _Pre_defensive_ HQUIC Handle,
+    _Inout_updates_(EntryCount) _Pre_defensive_
+        QUIC_STREAM_SEND_BATCH_ENTRY* Entries,
+    _In_ uint32_t EntryCount
+    )
+{
+    QUIC_STATUS Status;
+    QUIC_CONNECTION* Connection;
+    QUIC_OPERATION* Oper = NULL;
+    QUIC_API_CONTEXT* ApiCtx = NULL;
+    BOOLEAN IsPriority = FALSE;
+    BOOLEAN SendInline;
+    BOOLEAN AlreadyInline;
+
+    QuicTraceEvent(
+        ApiEnter,
+        "[ api] Enter %u (%p).",
+        QUIC_TRACE_API_STREAM_SEND_BATCH,
+        Handle);
+
+    if (!IS_CONN_HANDLE(Handle) ||
+        Entries == NULL ||
+        EntryCount == 0 ||
+        EntryCount > UINT32_MAX / sizeof(QUIC_STREAM*)) {
+        Status = QUIC_STATUS_INVALID_PARAMETER;
+        goto Exit;
+    }
+
+#pragma prefast(suppress: __WARNING_25024, "Pointer cast already validated.")
+    Connection = (QUIC_CONNECTION*)Handle;
+
+    CXPLAT_TEL_ASSERT(!Connection->State.Freed);
+
+#pragma warning(push)
+#pragma warning(disable:6240) // CXPLAT_AT_DISPATCH only really does anything for kernel mode
+    SendInline =
+        !Connection->Settings.SendBufferingEnabled &&
+        !CXPLAT_AT_DISPATCH() && // Never run inline if at DISPATCH
+        Connection->WorkerThreadID == CxPlatCurThreadID();
+#pragma warning(pop)
+
+    if (!SendInline) {
+        //
+        // Allocate everything needed to queue the batch before queuing any of
+        // the sends, so nothing can fail once they are visible to the worker.
+        //
+        Oper = QuicConnAllocOperation(Connection, QUIC_OPER_TYPE_API_CALL);
+        if (Oper == NULL) {
+            Status = QUIC_STATUS_OUT_OF_MEMORY;
+            QuicTraceEvent(
+                AllocFailure,
+                "Allocation of '%s' failed. (%llu bytes)",
+                "STRM_SEND_BATCH operation",
+                0);
+            goto Exit;
+        }
+        ApiCtx = Oper->API_CALL.Context;
+        ApiCtx->Type = QUIC_API_TYPE_STRM_SEND_BATCH;
+        ApiCtx->STRM_SEND_BATCH.StreamCount = 0;
+        ApiCtx->STRM_SEND_BATCH.Streams =
+            CXPLAT_ALLOC_NONPAGED(EntryCount * sizeof(QUIC_STREAM*), QUIC_POOL_SEND_BATCH);
+        if (ApiCtx->STRM_SEND_BATCH.Streams == NULL) {
+            Status = QUIC_STATUS_OUT_OF_MEMORY;
+            QuicTraceEvent(
+                AllocFailure,
+                "Allocation of '%s' failed. (%llu bytes)",
+                "STRM_SEND_BATCH streams",
+                EntryCount * sizeof(QUIC_STREAM*));
+            QuicOperationFree(Oper);
+            goto Exit;
+        }
+    }
+
+    AlreadyInline = Connection->State.InlineApiExecution;
+    if (SendInline && !AlreadyInline) {
+        Connection->State.InlineApiExecution = TRUE;
+    }
+
+    for (uint32_t i = 0; i < EntryCount; ++i) {
+        QUIC_STREAM_SEND_BATCH_ENTRY* Entry = &Entries[i];
+
+        if (!IS_STREAM_HANDLE(Entry->Stream) ||
+            (Entry->Buffers == NULL && Entry->BufferCount != 0) ||
+            ((QUIC_STREAM*)Entry->Stream)->Connection != Connection) {
+            Entry->Status = QUIC_STATUS_INVALID_PARAMETER;
+            continue;
+        }
+
+#pragma prefast(suppress: __WARNING_25024, "Pointer cast already validated.")
+        QUIC_STREAM* Stream = (QUIC_STREAM*)Entry->Stream;
+
+        CXPLAT_TEL_ASSERT(!Stream->Flags.HandleClosed);
+        CXPLAT_TEL_ASSERT(!Stream->Flags.Freed);
+
+        BOOLEAN NeedsFlush;
+        Entry->Status =
+            QuicStreamQueueApiSend(
+                Stream,
+                Entry->Buffers,
+                Entry->BufferCount,
+                Entry->Flags,
+                Entry->ClientSendContext,
+                !SendInline,
+                &NeedsFlush);
+        if (QUIC_FAILED(Entry->Status)) {
+            continue;
+        }
+        Entry->Status = QUIC_STATUS_PENDING;
+
+        if (Entry->Flags & QUIC_SEND_FLAG_PRIORITY_WORK) {
+            IsPriority = TRUE;
+        }
+
+        if (!NeedsFlush) {
+            continue; // An earlier send (maybe in this batch) will flush it.
+        }
+
+        if (SendInline) {
+            CXPLAT_PASSIVE_CODE();
+            QuicStreamSendFlush(Stream);
+        } else {
+            ApiCtx->STRM_SEND_BATCH.Streams[ApiCtx->STRM_SEND_BATCH.StreamCount++] = Stream;
+        }
+    }
+
+    if (SendInline && !AlreadyInline) {
+        Connection->State.InlineApiExecution = FALSE;
+    }
+
+    if (Oper != NULL) {
+        if (ApiCtx->STRM_SEND_BATCH.StreamCount == 0) {
+            QuicOperationFree(Oper);
+        } else if (IsPriority) {
+            QuicConnQueuePriorityOper(Connection, Oper);
+        } else {
+            QuicConnQueueOper(Connection, Oper);
+        }
+    }
+
+    Status = QUIC_STATUS_PENDING;
+
+Exit:
+
+    QuicTraceEvent(
+        ApiExitStatus,
+        "[ api] Exit %u",
+        Status);
+
+    return Status;
+}
+
 _IRQL_requires_max_(DISPATCH_LEVEL)
 QUIC_STATUS
 QUIC_API
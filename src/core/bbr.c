@@ -670,6 +670,24 @@ BbrCongestionControlGetSendAllowance(
     return SendAllowance;
 }
 
+_IRQL_requires_max_(DISPATCH_LEVEL)
+uint64_t
+BbrCongestionControlGetPacingRate(
+    _In_ const QUIC_CONGESTION_CONTROL* Cc
+    )
+{
+    const QUIC_CONNECTION* Connection = QuicCongestionControlGetConnection(Cc);
+    const QUIC_CONGESTION_CONTROL_BBR* Bbr = &Cc->Bbr;
+
+    if (!Connection->Settings.PacingEnabled ||
+        Bbr->MinRtt == UINT64_MAX ||
+        Bbr->MinRtt < QUIC_SEND_PACING_INTERVAL) {
+        return 0;
+    }
+
+    return BbrCongestionControlGetBandwidth(Cc) * Bbr->PacingGain / GAIN_UNIT / BW_UNIT;
+}
+
 _IRQL_requires_max_(DISPATCH_LEVEL)
 void
 BbrCongestionControlTransitToProbeRtt(
@@ -1069,6 +1087,7 @@ static const QUIC_CONGESTION_CONTROL QuicCongestionControlBbr = {
     .QuicCongestionControlSetExemption = BbrCongestionControlSetExemption,
     .QuicCongestionControlReset = BbrCongestionControlReset,
     .QuicCongestionControlGetSendAllowance = BbrCongestionControlGetSendAllowance,
+    .QuicCongestionControlGetPacingRate = BbrCongestionControlGetPacingRate,
     .QuicCongestionControlGetCongestionWindow = BbrCongestionControlGetCongestionWindow,
     .QuicCongestionControlOnDataSent = BbrCongestionControlOnDataSent,
     .QuicCongestionControlOnDataInvalidated = BbrCongestionControlOnDataInvalidated,
@@ -1201,6 +1201,43 @@ QuicBindingPreprocessPacket(
     return TRUE;
 }
 
+//
+// Validates a datagram from the same coalesced receive as a previously
+// validated short header packet, which only requires checking that it is also
+// a short header packet with the same destination CID. Returns FALSE if the
+// datagram needs to go through QuicBindingPreprocessPacket instead.
+//
+_IRQL_requires_max_(DISPATCH_LEVEL)
+BOOLEAN
+QuicBindingPreprocessCoalescedPacket(
+    _Inout_ QUIC_RX_PACKET* Packet,
+    _In_ const CXPLAT_ROUTE* Route,
+    _In_reads_(DestCidLen)
+        const uint8_t* DestCid,
+    _In_ uint8_t DestCidLen
+    )
+{
+    if (Packet->Route != Route ||
+        Packet->BufferLength < sizeof(uint8_t) + DestCidLen ||
+        ((const QUIC_HEADER_INVARIANT*)Packet->Buffer)->IsLongHeader ||
+        memcmp(Packet->Buffer + sizeof(uint8_t), DestCid, DestCidLen) != 0) {
+        return FALSE;
+    }
+
+    CxPlatZeroMemory(   // Zero out everything from PacketNumber forward
+        &Packet->PacketNumber,
+        sizeof(QUIC_RX_PACKET) - offsetof(QUIC_RX_PACKET, PacketNumber));
+    Packet->AvailBuffer = Packet->Buffer;
+    Packet->AvailBufferLength = Packet->BufferLength;
+    Packet->HeaderLength = sizeof(uint8_t) + DestCidLen;
+    Packet->DestCid = Packet->Invariant->SHORT_HDR.DestCid;
+    Packet->DestCidLen = DestCidLen;
+    Packet->IsShortHeader = TRUE;
+    Packet->ValidatedHeaderInv = TRUE;
+
+    return TRUE;
+}
+
 //
 // Returns TRUE if we should respond to the connection attempt with a Retry
 // packet.
@@ -1611,6 +1648,19 @@ QuicBindingReceive(
     uint32_t SubChainBytes = 0;
     uint32_t TotalChainLength = 0;
     uint32_t TotalDatagramBytes = 0;
+    uint32_t CoalescedEvents = 0;
+    uint32_t CoalescedDatagrams = 0;
+
+    //
+    // State for the current run of datagrams from one coalesced receive. Once
+    // one of them is validated as a short header packet, the rest only need
+    // their destination CID compared to join the same subchain.
+    //
+    uint16_t CoalescedRemaining = 0;
+    uint64_t NextPacketId = 0;
+    const CXPLAT_ROUTE* CoalescedRoute = NULL;
+    const uint8_t* CoalescedDestCid = NULL;
+    uint8_t CoalescedDestCidLen = 0;
 
     CXPLAT_DBG_ASSERT(Socket == Binding->Socket);
 
@@ -1639,9 +1689,28 @@ QuicBindingReceive(
         DatagramChain = Datagram->Next;
         Datagram->Next = NULL;
 
+        //
+        // Packet IDs are reserved once for each coalesced run.
+        //
+        if (CoalescedRemaining != 0) {
+            CoalescedRemaining--;
+        } else if (Datagram->CoalescedCount > 1) {
+            CoalescedRemaining = Datagram->CoalescedCount - 1;
+            CoalescedDestCid = NULL;
+            CoalescedEvents++;
+            CoalescedDatagrams += Datagram->CoalescedCount;
+            NextPacketId =
+                (uint64_t)InterlockedExchangeAdd64(
+                    (int64_t*)&Partition->ReceivePacketId,
+                    Datagram->CoalescedCount) + 1;
+        } else {
+            CoalescedDestCid = NULL;
+            NextPacketId =
+                (uint64_t)InterlockedIncrement64((int64_t*)&Partition->ReceivePacketId);
+        }
+
         QUIC_RX_PACKET* Packet = (QUIC_RX_PACKET*)Datagram;
-        Packet->PacketId =
-            PartitionShifted | InterlockedIncrement64((int64_t*)&Partition->ReceivePacketId);
+        Packet->PacketId = PartitionShifted | NextPacketId++;
         Packet->PacketNumber = 0;
         Packet->SendTimestamp = UINT64_MAX;
         Packet->AvailBuffer = Datagram->Buffer;
@@ -1678,6 +1747,20 @@ QuicBindingReceive(
         }
 #endif
 
+        if (CoalescedDestCid != NULL &&
+            QuicBindingPreprocessCoalescedPacket(
+                Packet, CoalescedRoute, CoalescedDestCid, CoalescedDestCidLen)) {
+            //
+            // Same destination CID as the last packet added to the current
+            // subchain, so it joins it without any further checks.
+            //
+            SubChainLength++;
+            SubChainBytes += Datagram->BufferLength;
+            *SubChainDataTail = Datagram;
+            SubChainDataTail = &Datagram->Next;
+            continue;
+        }
+
         //
         // Perform initial validation.
         //
@@ -1740,6 +1823,14 @@ QuicBindingReceive(
                 SubChainTail = &Datagram->Next;
             }
         }
+
+        if (CoalescedRemaining != 0 && Packet->IsShortHeader) {
+            CoalescedRoute = Datagram->Route;
+            CoalescedDestCid = Packet->DestCid;
+            CoalescedDestCidLen = Packet->DestCidLen;
+        } else {
+            CoalescedDestCid = NULL;
+        }
     }
 
     if (SubChain != NULL) {
@@ -1759,6 +1850,11 @@ QuicBindingReceive(
     QuicPerfCounterAdd(Partition, QUIC_PERF_COUNTER_UDP_RECV, TotalChainLength);
     QuicPerfCounterAdd(Partition, QUIC_PERF_COUNTER_UDP_RECV_BYTES, TotalDatagramBytes);
     QuicPerfCounterIncrement(Partition, QUIC_PERF_COUNTER_UDP_RECV_EVENTS);
+    if (CoalescedEvents != 0) {
+        QuicPerfCounterAdd(Partition, QUIC_PERF_COUNTER_UDP_RECV_COALESCED, CoalescedEvents);
+        QuicPerfCounterAdd(
+            Partition, QUIC_PERF_COUNTER_UDP_RECV_COALESCED_SEGMENTS, CoalescedDatagrams);
+    }
 }
 
 _IRQL_requires_max_(DISPATCH_LEVEL)
@@ -105,6 +105,15 @@ typedef struct QUIC_RX_PACKET {
     //
     QUIC_PACKET_KEY_TYPE KeyType;
 
+    //
+    // The result of decrypting the packet on the receive path, before it was
+    // queued to the connection, along with the key and packet number used.
+    // Only valid if Predecrypted is set.
+    //
+    QUIC_STATUS PredecryptStatus;
+    uint64_t PredecryptPacketNumber;
+    const struct QUIC_PACKET_KEY* PredecryptKey;
+
     union {
     uint32_t Flags;
     struct {
@@ -170,11 +179,38 @@ typedef struct QUIC_RX_PACKET {
     // Flag indicating the packet contained a non-probing frame.
     //
     BOOLEAN HasNonProbingFrame : 1;
+
+    //
+    // Flag indicating the header protection was removed and the payload
+    // decrypted on the receive path, before the packet was queued.
+    //
+    BOOLEAN Predecrypted : 1;
     };
     };
 
 } QUIC_RX_PACKET;
 
+//
+// Returns the time the platform received the packet, falling back to TimeNow
+// if the datapath didn't provide one (or provided one in the future).
+//
+QUIC_INLINE
+uint64_t
+QuicPacketGetRecvTime(
+    _In_ const QUIC_RX_PACKET* const Packet,
+    _In_ uint64_t TimeNow
+    )
+{
+#ifdef __cplusplus
+    const uint64_t ReceiveTimeUs = Packet->_.ReceiveTimeUs;
+#else
+    const uint64_t ReceiveTimeUs = Packet->ReceiveTimeUs;
+#endif
+    return
+        ReceiveTimeUs != 0 && CxPlatTimeAtOrBefore64(ReceiveTimeUs, TimeNow) ?
+            ReceiveTimeUs : TimeNow;
+}
+
 typedef enum QUIC_BINDING_LOOKUP_TYPE {
 
     QUIC_BINDING_LOOKUP_SINGLE,         // Single connection
@@ -108,6 +108,10 @@ typedef struct QUIC_CONGESTION_CONTROL {
         _In_ BOOLEAN TimeSinceLastSendValid
         );
 
+    uint64_t (*QuicCongestionControlGetPacingRate)(
+        _In_ const struct QUIC_CONGESTION_CONTROL* Cc
+        );
+
     void (*QuicCongestionControlOnDataSent)(
         _In_ struct QUIC_CONGESTION_CONTROL* Cc,
         _In_ uint32_t NumRetransmittableBytes
@@ -273,6 +277,20 @@ QuicCongestionControlGetSendAllowance(
     return Cc->QuicCongestionControlGetSendAllowance(Cc, TimeSinceLastSend, TimeSinceLastSendValid);
 }
 
+//
+// Returns the rate, in bytes per second, that sends are currently paced at,
+// or zero if they aren't being paced.
+//
+_IRQL_requires_max_(DISPATCH_LEVEL)
+QUIC_INLINE
+uint64_t
+QuicCongestionControlGetPacingRate(
+    _In_ const QUIC_CONGESTION_CONTROL* Cc
+    )
+{
+    return Cc->QuicCongestionControlGetPacingRate(Cc);
+}
+
 //
 // Called when any retransmittable data is sent.
 //
@@ -16,7 +16,8 @@ Abstract:
     The only requirement here is that this function is not called in parallel
     on multiple threads. The function will drain up to QUIC_SETTINGS_INTERNAL's
     MaxOperationsPerDrain operations per call, so as to not starve any other
-    work.
+    work. If MaxOperationsPerDrain isn't explicitly configured, the worker's
+    adaptive drain budget is used instead.
 
     While most of the connection specific work is managed by other modules,
     the following things are managed in this file:
@@ -51,6 +52,13 @@ QuicConnApplyNewSettings(
     _In_ const QUIC_SETTINGS_INTERNAL* NewSettings
     );
 
+_IRQL_requires_max_(DISPATCH_LEVEL)
+void
+QuicConnRecvDecryptChain(
+    _In_ QUIC_CONNECTION* Connection,
+    _In_ QUIC_RX_PACKET* Packets
+    );
+
 _IRQL_requires_max_(DISPATCH_LEVEL)
 _Must_inspect_result_
 _Success_(return == QUIC_STATUS_SUCCESS)
@@ -120,6 +128,7 @@ QuicConnAlloc(
     QuicSettingsCopy(&Connection->Settings, &MsQuicLib.Settings);
     Connection->Settings.IsSetFlags = 0; // Just grab the global values, not IsSet flags.
     CxPlatDispatchLockInitialize(&Connection->ReceiveQueueLock);
+    CxPlatDispatchLockInitialize(&Connection->RecvDecryptLock);
     CxPlatListInitializeHead(&Connection->DestCids);
     QuicStreamSetInitialize(&Connection->Streams);
     QuicSendBufferInitialize(&Connection->SendBuffer);
@@ -369,6 +378,7 @@ QuicConnFree(
         Path->Binding = NULL;
     }
     CxPlatDispatchLockUninitialize(&Connection->ReceiveQueueLock);
+    CxPlatDispatchLockUninitialize(&Connection->RecvDecryptLock);
     QuicOperationQueueUninitialize(&Connection->OperQ);
     QuicStreamSetUninitialize(&Connection->Streams);
     QuicSendBufferUninitialize(&Connection->SendBuffer);
@@ -3235,6 +3245,10 @@ QuicConnQueueRecvPackets(
         "Queuing %u UDP datagrams",
         PacketChainLength);
 
+    if (MsQuicLib.EnableParallelDecrypt) {
+        QuicConnRecvDecryptChain(Connection, Packets);
+    }
+
     BOOLEAN QueueOperation;
     CxPlatDispatchLockAcquire(&Connection->ReceiveQueueLock);
     if (Connection->ReceiveQueueCount >= QueueLimit) {
@@ -4149,6 +4163,389 @@ QuicConnRecvPrepareDecrypt(
     return TRUE;
 }
 
+//
+// Decrypts the leading packets of a run of encrypted short header packets with
+// a single batched AEAD call, using the 1-RTT key of the given key phase. A
+// packet is only included if QuicConnRecvPrepareDecrypt is guaranteed to
+// arrive at the same key and packet number when it processes it later: it must
+// be in the key phase, and its decompressed packet number must be the same for
+// any expected packet number from ExpectedPacketNumber up to
+// MaxExpectedPacketNumber, as advanced by the packets before it. The headers of
+// included packets are unprotected in place and their masks cleared, so the
+// regular per-packet processing leaves them as is. Returns the number of
+// packets decrypted.
+//
+_IRQL_requires_max_(DISPATCH_LEVEL)
+static
+uint8_t
+QuicConnDecryptShortHeaderBatch(
+    _In_ const QUIC_PACKET_KEY* Key,
+    _In_ BOOLEAN KeyPhase,
+    _In_ uint64_t ExpectedPacketNumber,
+    _In_ uint64_t MaxExpectedPacketNumber,
+    _In_ uint8_t BatchCount,
+    _In_reads_(BatchCount) QUIC_RX_PACKET** Packets,
+    _Inout_updates_(BatchCount * CXPLAT_HP_SAMPLE_LENGTH)
+        uint8_t* HpMask,
+    _Out_writes_to_(BatchCount, return)
+        QUIC_RECV_PREDECRYPTED* Results
+    )
+{
+    CXPLAT_CRYPT_BATCH_ENTRY Entries[QUIC_MAX_CRYPTO_BATCH_COUNT];
+    uint8_t Iv[QUIC_MAX_CRYPTO_BATCH_COUNT][CXPLAT_MAX_IV_LENGTH];
+
+    CXPLAT_DBG_ASSERT(BatchCount <= QUIC_MAX_CRYPTO_BATCH_COUNT);
+    CXPLAT_DBG_ASSERT(Key != NULL);
+    CXPLAT_DBG_ASSERT(MaxExpectedPacketNumber >= ExpectedPacketNumber);
+
+    uint8_t Count = 0;
+    for (; Count < BatchCount; ++Count) {
+        QUIC_RX_PACKET* Packet = Packets[Count];
+        uint8_t* Mask = HpMask + Count * CXPLAT_HP_SAMPLE_LENGTH;
+        CXPLAT_DBG_ASSERT(Packet->IsShortHeader);
+
+        uint8_t FirstByte = Packet->AvailBuffer[0] ^ (Mask[0] & 0x1f);
+        const QUIC_SHORT_HEADER_V1* Header = (const QUIC_SHORT_HEADER_V1*)&FirstByte;
+        const uint8_t CompressedPacketNumberLength = Header->PnLength + 1;
+        if (Header->KeyPhase != KeyPhase ||
+            Packet->PayloadLength < CompressedPacketNumberLength + CXPLAT_ENCRYPTION_OVERHEAD) {
+            break;
+        }
+
+        uint8_t* PnStart = (uint8_t*)Packet->AvailBuffer + Packet->HeaderLength;
+        uint8_t PnBytes[4];
+        for (uint8_t i = 0; i < CompressedPacketNumberLength; i++) {
+            PnBytes[i] = PnStart[i] ^ Mask[1 + i];
+        }
+        uint64_t CompressedPacketNumber = 0;
+        QuicPktNumDecode(CompressedPacketNumberLength, PnBytes, &CompressedPacketNumber);
+
+        //
+        // The expected packet number when this packet is processed lies
+        // between the current one and one past the largest packet number
+        // before it in the batch. Decompression is monotonic in the expected
+        // packet number, so agreeing at both ends means the result is fixed.
+        //
+        const uint64_t PacketNumber =
+            QuicPktNumDecompress(
+                ExpectedPacketNumber,
+                CompressedPacketNumber,
+                CompressedPacketNumberLength);
+        if (PacketNumber > QUIC_VAR_INT_MAX ||
+            PacketNumber !=
+                QuicPktNumDecompress(
+                    MaxExpectedPacketNumber,
+                    CompressedPacketNumber,
+                    CompressedPacketNumberLength)) {
+            break;
+        }
+        if (PacketNumber + 1 > MaxExpectedPacketNumber) {
+            MaxExpectedPacketNumber = PacketNumber + 1;
+        }
+
+        ((uint8_t*)Packet->AvailBuffer)[0] = FirstByte;
+        CxPlatCopyMemory(PnStart, PnBytes, CompressedPacketNumberLength);
+        CxPlatZeroMemory(Mask, CXPLAT_HP_SAMPLE_LENGTH);
+
+        uint8_t* Payload = PnStart + CompressedPacketNumberLength;
+        const uint16_t PayloadLength = Packet->PayloadLength - CompressedPacketNumberLength;
+
+        //
+        // Save the stateless reset token before a failed decryption can
+        // trash it.
+        //
+        CxPlatCopyMemory(
+            Results[Count].ResetToken,
+            Payload + PayloadLength - QUIC_STATELESS_RESET_TOKEN_LENGTH,
+            QUIC_STATELESS_RESET_TOKEN_LENGTH);
+        Results[Count].PacketNumber = PacketNumber;
+
+        QuicCryptoCombineIvAndPacketNumber(Key->Iv, (uint8_t*)&PacketNumber, Iv[Count]);
+        Entries[Count].Iv = Iv[Count];
+        Entries[Count].AuthData = Packet->AvailBuffer;
+        Entries[Count].AuthDataLength = Packet->HeaderLength + CompressedPacketNumberLength;
+        Entries[Count].Buffer = Payload;
+        Entries[Count].BufferLength = PayloadLength;
+        Entries[Count].Sources = NULL;
+        Entries[Count].SourceCount = 0;
+
+        QuicTraceEvent(
+            PacketDecrypt,
+            "[pack][%llu] Decrypting",
+            Packet->PacketId);
+    }
+
+    if (Count != 0) {
+        (void)CxPlatDecryptBatch(Key->PacketKey, Count, Entries);
+        for (uint8_t i = 0; i < Count; ++i) {
+            Results[i].Status = Entries[i].Status;
+        }
+    }
+
+    return Count;
+}
+
+//
+// The cipher and header protection contexts of the key published for the
+// receive path can't be used by two threads at once, so the worker holds
+// RecvDecryptLock while it uses that key itself. The worker is the only writer
+// of RecvDecryptKey, so it can check it without the lock. Returns TRUE if the
+// lock was acquired, to be passed to QuicConnRecvKeyRelease.
+//
+_IRQL_requires_max_(PASSIVE_LEVEL)
+static
+BOOLEAN
+QuicConnRecvKeyAcquire(
+    _In_ QUIC_CONNECTION* Connection,
+    _In_ const QUIC_PACKET_KEY* Key
+    )
+{
+    if (Connection->RecvDecryptKey != NULL && Connection->RecvDecryptKey == Key) {
+        CxPlatDispatchLockAcquire(&Connection->RecvDecryptLock);
+        return TRUE;
+    }
+    return FALSE;
+}
+
+_IRQL_requires_max_(PASSIVE_LEVEL)
+static
+void
+QuicConnRecvKeyRelease(
+    _In_ QUIC_CONNECTION* Connection,
+    _In_ BOOLEAN Acquired
+    )
+{
+    if (Acquired) {
+        CxPlatDispatchLockRelease(&Connection->RecvDecryptLock);
+    }
+}
+
+//
+// Decrypts the leading 1-RTT packets of a receive batch, in the current key
+// phase, with a single batched AEAD call. Returns the number of packets
+// decrypted.
+//
+_IRQL_requires_max_(PASSIVE_LEVEL)
+uint8_t
+QuicConnRecvDecryptBatch(
+    _In_ QUIC_CONNECTION* Connection,
+    _In_ uint8_t BatchCount,
+    _In_reads_(BatchCount) QUIC_RX_PACKET** Packets,
+    _Inout_updates_(BatchCount * CXPLAT_HP_SAMPLE_LENGTH)
+        uint8_t* HpMask,
+    _Out_writes_to_(BatchCount, return)
+        QUIC_RECV_PREDECRYPTED* Results
+    )
+{
+    const QUIC_PACKET_SPACE* PacketSpace = Connection->Packets[QUIC_ENCRYPT_LEVEL_1_RTT];
+
+    uint8_t Count = 0;
+    while (Count < BatchCount &&
+           Packets[Count]->IsShortHeader &&
+           Packets[Count]->Encrypted &&
+           Packets[Count]->KeyType == QUIC_PACKET_KEY_1_RTT) {
+        Count++;
+    }
+
+    const QUIC_PACKET_KEY* Key = Connection->Crypto.TlsState.ReadKeys[QUIC_PACKET_KEY_1_RTT];
+    const BOOLEAN Acquired = QuicConnRecvKeyAcquire(Connection, Key);
+    Count =
+        QuicConnDecryptShortHeaderBatch(
+            Key,
+            PacketSpace->CurrentKeyPhase,
+            PacketSpace->NextRecvPacketNumber,
+            PacketSpace->NextRecvPacketNumber,
+            Count,
+            Packets,
+            HpMask,
+            Results);
+    QuicConnRecvKeyRelease(Connection, Acquired);
+
+    return Count;
+}
+
+//
+// Checks that a packet decrypted on the receive path was decrypted with the
+// key and packet number QuicConnRecvPrepareDecrypt arrived at for it, and
+// fills in its result. Returns TRUE if the packet should continue to be
+// processed further.
+//
+_IRQL_requires_max_(PASSIVE_LEVEL)
+BOOLEAN
+QuicConnRecvGetPredecrypted(
+    _In_ QUIC_CONNECTION* Connection,
+    _In_ QUIC_RX_PACKET* Packet,
+    _Out_ QUIC_RECV_PREDECRYPTED* Result
+    )
+{
+    CXPLAT_DBG_ASSERT(Packet->Predecrypted);
+    CXPLAT_DBG_ASSERT(Packet->PacketNumberSet);
+
+    if (!Packet->Encrypted ||
+        Packet->PacketNumber != Packet->PredecryptPacketNumber ||
+        Connection->Crypto.TlsState.ReadKeys[Packet->KeyType] != Packet->PredecryptKey) {
+        QuicPacketLogDrop(Connection, Packet, "Decrypted with stale key state");
+        return FALSE;
+    }
+
+    CXPLAT_DBG_ASSERT(Packet->PayloadLength >= QUIC_STATELESS_RESET_TOKEN_LENGTH);
+    Result->Status = Packet->PredecryptStatus;
+    Result->PacketNumber = Packet->PacketNumber;
+    CxPlatCopyMemory(
+        Result->ResetToken,
+        Packet->AvailBuffer + Packet->HeaderLength + Packet->PayloadLength -
+            QUIC_STATELESS_RESET_TOKEN_LENGTH,
+        QUIC_STATELESS_RESET_TOKEN_LENGTH);
+
+    return TRUE;
+}
+
+//
+// Removes the header protection from and decrypts the 1-RTT packets of a chain
+// on the datapath thread that received them, before they are queued, with the
+// key and packet numbers last published by the worker. This takes the AEAD
+// work off the worker, which then only checks the results as it processes the
+// packets in order. Packets that can't be decrypted here are left as they are
+// for the worker to decrypt as usual.
+//
+_IRQL_requires_max_(DISPATCH_LEVEL)
+void
+QuicConnRecvDecryptChain(
+    _In_ QUIC_CONNECTION* Connection,
+    _In_ QUIC_RX_PACKET* Packets
+    )
+{
+    QUIC_RX_PACKET* Batch[QUIC_MAX_CRYPTO_BATCH_COUNT];
+    uint8_t Cipher[CXPLAT_HP_SAMPLE_LENGTH * QUIC_MAX_CRYPTO_BATCH_COUNT];
+    uint8_t HpMask[CXPLAT_HP_SAMPLE_LENGTH * QUIC_MAX_CRYPTO_BATCH_COUNT];
+    QUIC_RECV_PREDECRYPTED Results[QUIC_MAX_CRYPTO_BATCH_COUNT];
+
+    CxPlatDispatchLockAcquire(&Connection->RecvDecryptLock);
+
+    const QUIC_PACKET_KEY* Key = Connection->RecvDecryptKey;
+    QUIC_RX_PACKET* Packet = Packets;
+    while (Key != NULL && Packet != NULL) {
+
+        uint8_t BatchCount = 0;
+        for (; Packet != NULL && BatchCount < QUIC_MAX_CRYPTO_BATCH_COUNT;
+            Packet = (QUIC_RX_PACKET*)Packet->Next) {
+            if (!Packet->IsShortHeader ||
+                Packet->AvailBufferLength <
+                    Packet->HeaderLength + 4 + CXPLAT_HP_SAMPLE_LENGTH) {
+                continue;
+            }
+            //
+            // Short header packets take up the rest of the datagram. See
+            // QuicPacketValidateShortHeaderV1 and QuicConnRecvHeader.
+            //
+            Packet->PayloadLength = Packet->AvailBufferLength - Packet->HeaderLength;
+            CxPlatCopyMemory(
+                Cipher + BatchCount * CXPLAT_HP_SAMPLE_LENGTH,
+                Packet->AvailBuffer + Packet->HeaderLength + 4,
+                CXPLAT_HP_SAMPLE_LENGTH);
+            Batch[BatchCount++] = Packet;
+        }
+
+        if (BatchCount == 0 ||
+            QUIC_FAILED(
+            CxPlatHpComputeMask(Key->HeaderKey, BatchCount, Cipher, HpMask))) {
+            break;
+        }
+
+        const uint8_t Count =
+            QuicConnDecryptShortHeaderBatch(
+                Key,
+                Connection->RecvDecryptKeyPhase,
+                Connection->RecvDecryptNextPacketNumber,
+                Connection->RecvDecryptMaxPacketNumber,
+                BatchCount,
+                Batch,
+                HpMask,
+                Results);
+
+        for (uint8_t i = 0; i < Count; ++i) {
+            QUIC_RX_PACKET* Decrypted = Batch[i];
+            Decrypted->Predecrypted = TRUE;
+            Decrypted->PredecryptStatus = Results[i].Status;
+            Decrypted->PredecryptPacketNumber = Results[i].PacketNumber;
+            Decrypted->PredecryptKey = Key;
+            if (QUIC_FAILED(Results[i].Status)) {
+                //
+                // Put the stateless reset token back for the worker to check.
+                //
+                CxPlatCopyMemory(
+                    (uint8_t*)Decrypted->AvailBuffer + Decrypted->AvailBufferLength -
+                        QUIC_STATELESS_RESET_TOKEN_LENGTH,
+                    Results[i].ResetToken,
+                    QUIC_STATELESS_RESET_TOKEN_LENGTH);
+            } else if (Results[i].PacketNumber >= Connection->RecvDecryptMaxPacketNumber) {
+                Connection->RecvDecryptMaxPacketNumber = Results[i].PacketNumber + 1;
+            }
+        }
+
+        if (Count != BatchCount) {
+            //
+            // The worker will decrypt the rest, which may advance its expected
+            // packet number in ways not accounted for here, so stop.
+            //
+            break;
+        }
+    }
+
+    CxPlatDispatchLockRelease(&Connection->RecvDecryptLock);
+}
+
+//
+// Publishes the current 1-RTT read key, key phase and expected packet number
+// for the receive path to decrypt new packets with, if allowed. Only called on
+// the worker, which is the only writer of RecvDecryptKey.
+//
+_IRQL_requires_max_(PASSIVE_LEVEL)
+void
+QuicConnRecvDecryptPublish(
+    _In_ QUIC_CONNECTION* Connection
+    )
+{
+    const QUIC_PACKET_KEY* Key = NULL;
+    if (MsQuicLib.EnableParallelDecrypt &&
+        Connection->State.HandshakeConfirmed &&
+        Connection->State.HeaderProtectionEnabled &&
+        !Connection->State.Disable1RttEncrytion &&
+        !Connection->Paths[0].EncryptionOffloading &&
+        !QuicConnIsClosed(Connection)) {
+        Key = Connection->Crypto.TlsState.ReadKeys[QUIC_PACKET_KEY_1_RTT];
+    }
+
+    if (Key == NULL && Connection->RecvDecryptKey == NULL) {
+        return;
+    }
+
+    CxPlatDispatchLockAcquire(&Connection->RecvDecryptLock);
+    Connection->RecvDecryptKey = Key;
+    if (Key != NULL) {
+        const QUIC_PACKET_SPACE* PacketSpace = Connection->Packets[QUIC_ENCRYPT_LEVEL_1_RTT];
+        Connection->RecvDecryptKeyPhase = PacketSpace->CurrentKeyPhase;
+        Connection->RecvDecryptNextPacketNumber = PacketSpace->NextRecvPacketNumber;
+        if (Connection->RecvDecryptMaxPacketNumber < PacketSpace->NextRecvPacketNumber) {
+            Connection->RecvDecryptMaxPacketNumber = PacketSpace->NextRecvPacketNumber;
+        }
+    }
+    CxPlatDispatchLockRelease(&Connection->RecvDecryptLock);
+}
+
+_IRQL_requires_max_(PASSIVE_LEVEL)
+void
+QuicConnRecvDecryptRevoke(
+    _In_ QUIC_CONNECTION* Connection
+    )
+{
+    if (Connection->RecvDecryptKey != NULL) {
+        CxPlatDispatchLockAcquire(&Connection->RecvDecryptLock);
+        Connection->RecvDecryptKey = NULL;
+        CxPlatDispatchLockRelease(&Connection->RecvDecryptLock);
+    }
+}
+
 //
 // Decrypts the packet's payload and authenticates the whole packet. On
 // successful authentication of the packet, does some final processing of the
@@ -4160,7 +4557,8 @@ BOOLEAN
 QuicConnRecvDecryptAndAuthenticate(
     _In_ QUIC_CONNECTION* Connection,
     _In_ QUIC_PATH* Path,
-    _In_ QUIC_RX_PACKET* Packet
+    _In_ QUIC_RX_PACKET* Packet,
+    _In_opt_ const QUIC_RECV_PREDECRYPTED* Predecrypted
     )
 {
     CXPLAT_DBG_ASSERT(Packet->AvailBufferLength >= Packet->HeaderLength + Packet->PayloadLength);
@@ -4179,34 +4577,48 @@ QuicConnRecvDecryptAndAuthenticate(
         CanCheckForStatelessReset = TRUE;
         CxPlatCopyMemory(
             PacketResetToken,
-            Payload + Packet->PayloadLength - QUIC_STATELESS_RESET_TOKEN_LENGTH,
+            Predecrypted != NULL ?
+                Predecrypted->ResetToken :
+                Payload + Packet->PayloadLength - QUIC_STATELESS_RESET_TOKEN_LENGTH,
             QUIC_STATELESS_RESET_TOKEN_LENGTH);
     }
 
     CXPLAT_DBG_ASSERT(Packet->PacketId != 0);
 
-    uint8_t Iv[CXPLAT_MAX_IV_LENGTH];
-    QuicCryptoCombineIvAndPacketNumber(
-        Connection->Crypto.TlsState.ReadKeys[Packet->KeyType]->Iv,
-        (uint8_t*)&Packet->PacketNumber,
-        Iv);
-
     //
-    // Decrypt the payload with the appropriate key.
+    // Decrypt the payload with the appropriate key, unless that was already
+    // done as part of a batch.
     //
     if (Packet->Encrypted) {
-        QuicTraceEvent(
-            PacketDecrypt,
-            "[pack][%llu] Decrypting",
-            Packet->PacketId);
-        if (QUIC_FAILED(
-            CxPlatDecrypt(
-                Connection->Crypto.TlsState.ReadKeys[Packet->KeyType]->PacketKey,
-                Iv,
-                Packet->HeaderLength,   // HeaderLength
-                Packet->AvailBuffer,    // Header
-                Packet->PayloadLength,  // BufferLength
-                (uint8_t*)Payload))) {  // Buffer
+        QUIC_STATUS Status;
+        if (Predecrypted != NULL) {
+            CXPLAT_DBG_ASSERT(Predecrypted->PacketNumber == Packet->PacketNumber);
+            Status = Predecrypted->Status;
+        } else {
+            const QUIC_PACKET_KEY* Key = Connection->Crypto.TlsState.ReadKeys[Packet->KeyType];
+            uint8_t Iv[CXPLAT_MAX_IV_LENGTH];
+            QuicCryptoCombineIvAndPacketNumber(
+                Key->Iv,
+                (uint8_t*)&Packet->PacketNumber,
+                Iv);
+
+            QuicTraceEvent(
+                PacketDecrypt,
+                "[pack][%llu] Decrypting",
+                Packet->PacketId);
+            const BOOLEAN Acquired = QuicConnRecvKeyAcquire(Connection, Key);
+            Status =
+                CxPlatDecrypt(
+                    Key->PacketKey,
+                    Iv,
+                    Packet->HeaderLength,   // HeaderLength
+                    Packet->AvailBuffer,    // Header
+                    Packet->PayloadLength,  // BufferLength
+                    (uint8_t*)Payload);     // Buffer
+            QuicConnRecvKeyRelease(Connection, Acquired);
+        }
+
+        if (QUIC_FAILED(Status)) {
 
             //
             // Check for a stateless reset packet.
@@ -4448,7 +4860,13 @@ QuicConnRecvFrames(
     const BOOLEAN ClosingState = Connection->State.ClosedLocally && !Connection->State.ClosedRemotely;
     const uint8_t* Payload = Packet->AvailBuffer + Packet->HeaderLength;
     uint16_t PayloadLength = Packet->PayloadLength;
-    uint64_t RecvTime = CxPlatTimeUs64();
+    const uint64_t TimeNow = CxPlatTimeUs64();
+
+    //
+    // The ACK delay is measured from when the platform received the packet, so
+    // that it also covers the time the packet sat in local queues.
+    //
+    const uint64_t RecvTime = QuicPacketGetRecvTime(Packet, TimeNow);
 
     //
     // In closing state, respond to any packet with a new close frame (rate-limited).
@@ -4456,7 +4874,7 @@ QuicConnRecvFrames(
     // in which we should be silent.
     //
     if (ClosingState && !Connection->State.ShutdownComplete) {
-        if (RecvTime - Connection->LastCloseResponseTimeUs >= QUIC_CLOSING_RESPONSE_MIN_INTERVAL) {
+        if (TimeNow - Connection->LastCloseResponseTimeUs >= QUIC_CLOSING_RESPONSE_MIN_INTERVAL) {
             QuicSendSetSendFlag(
                 &Connection->Send,
                 Connection->State.AppClosed ?
@@ -5570,13 +5988,14 @@ QuicConnRecvDatagramBatch(
     }
 
     if (Packet->Encrypted &&
-        Connection->State.HeaderProtectionEnabled) {
-        if (QUIC_FAILED(
-            CxPlatHpComputeMask(
-                Connection->Crypto.TlsState.ReadKeys[Packet->KeyType]->HeaderKey,
-                BatchCount,
-                Cipher,
-                HpMask))) {
+        Connection->State.HeaderProtectionEnabled &&
+        !Packet->Predecrypted) {
+        const QUIC_PACKET_KEY* Key = Connection->Crypto.TlsState.ReadKeys[Packet->KeyType];
+        const BOOLEAN Acquired = QuicConnRecvKeyAcquire(Connection, Key);
+        const QUIC_STATUS Status =
+            CxPlatHpComputeMask(Key->HeaderKey, BatchCount, Cipher, HpMask);
+        QuicConnRecvKeyRelease(Connection, Acquired);
+        if (QUIC_FAILED(Status)) {
             QuicPacketLogDrop(Connection, Packet, "Failed to compute HP mask");
             return;
         }
@@ -5584,6 +6003,21 @@ QuicConnRecvDatagramBatch(
         CxPlatZeroMemory(HpMask, BatchCount * CXPLAT_HP_SAMPLE_LENGTH);
     }
 
+    //
+    // Short header packets arrive in batches of a single key type, so as many
+    // of them as possible are decrypted together before processing each one.
+    //
+    QUIC_RECV_PREDECRYPTED Predecrypted[QUIC_MAX_CRYPTO_BATCH_COUNT];
+    uint8_t PredecryptedCount = 0;
+    if (BatchCount > 1 &&
+        Packet->IsShortHeader &&
+        Packet->KeyType == QUIC_PACKET_KEY_1_RTT &&
+        !Packet->Predecrypted) {
+        PredecryptedCount =
+            QuicConnRecvDecryptBatch(
+                Connection, BatchCount, Packets, HpMask, Predecrypted);
+    }
+
     for (uint8_t i = 0; i < BatchCount; ++i) {
         CXPLAT_DBG_ASSERT(Packets[i]->Allocated);
         CXPLAT_ECN_TYPE ECN = CXPLAT_ECN_FROM_TOS(Packets[i]->TypeOfService);
@@ -5591,7 +6025,14 @@ QuicConnRecvDatagramBatch(
         CXPLAT_DBG_ASSERT(Packet->PacketId != 0);
         if (!QuicConnRecvPrepareDecrypt(
                 Connection, Packet, HpMask + i * CXPLAT_HP_SAMPLE_LENGTH) ||
-            !QuicConnRecvDecryptAndAuthenticate(Connection, Path, Packet)) {
+            (Packet->Predecrypted &&
+             !QuicConnRecvGetPredecrypted(Connection, Packet, &Predecrypted[i])) ||
+            !QuicConnRecvDecryptAndAuthenticate(
+                Connection,
+                Path,
+                Packet,
+                i < PredecryptedCount || Packet->Predecrypted ?
+                    &Predecrypted[i] : NULL)) {
             if (Connection->State.CompatibleVerNegotiationAttempted &&
                 !Connection->State.CompatibleVerNegotiationCompleted) {
                 //
@@ -5758,12 +6199,14 @@ QuicConnRecvDatagrams(
 
             if ((BatchCount != 0) &&
                 (!Packet->IsShortHeader ||
-                (PrevPackKeyType != QUIC_PACKET_KEY_COUNT && PrevPackKeyType != Packet->KeyType))) {
+                (PrevPackKeyType != QUIC_PACKET_KEY_COUNT && PrevPackKeyType != Packet->KeyType) ||
+                Batch[0]->Predecrypted != Packet->Predecrypted)) {
                 //
                 // We already had some batched short header packets and then
                 // encountered a long header packet OR the current packet
-                // has different key type. Finish off the batch first and
-                // then continue with the current packet.
+                // has different key type OR was decrypted on the receive path
+                // while the batch wasn't (or vice versa). Finish off the batch
+                // first and then continue with the current packet.
                 //
                 QuicConnRecvDatagramBatch(
                     Connection,
@@ -5958,6 +6401,8 @@ QuicConnFlushRecv(
     QuicConnRecvDatagrams(
         Connection, ReceiveQueue, ReceiveQueueCount, ReceiveQueueByteCount, FALSE);
 
+    QuicConnRecvDecryptPublish(Connection);
+
     return FlushedAll;
 }
 
@@ -6970,6 +7415,12 @@ QuicConnGetV2Statistics(
     if (STATISTICS_HAS_FIELD(*StatsLength, RttVariance)) {
         Stats->RttVariance = (uint32_t)Path->RttVariance;
     }
+    if (STATISTICS_HAS_FIELD(*StatsLength, RecvAckProcessingTimeUs)) {
+        Stats->RecvAckProcessingTimeUs = Connection->Stats.Recv.AckProcessingTime;
+    }
+    if (STATISTICS_HAS_FIELD(*StatsLength, RecvMaxAckProcessingTimeUs)) {
+        Stats->RecvMaxAckProcessingTimeUs = Connection->Stats.Recv.MaxAckProcessingTime;
+    }
 
     *StatsLength = CXPLAT_MIN(*StatsLength, sizeof(QUIC_STATISTICS_V2));
 
@@ -7719,6 +8170,13 @@ QuicConnProcessApiOperation(
             ApiCtx->STRM_SEND.Stream);
         break;
 
+    case QUIC_API_TYPE_STRM_SEND_BATCH:
+        for (uint32_t i = 0; i < ApiCtx->STRM_SEND_BATCH.StreamCount; ++i) {
+            QuicStreamSendFlush(
+                ApiCtx->STRM_SEND_BATCH.Streams[i]);
+        }
+        break;
+
     case QUIC_API_TYPE_STRM_RECV_COMPLETE:
         QuicStreamReceiveCompletePending(
             ApiCtx->STRM_RECV_COMPLETE.Stream);
@@ -7821,7 +8279,10 @@ QuicConnDrainOperations(
 {
     QUIC_OPERATION* Oper;
     const uint32_t MaxOperationCount =
-        Connection->Settings.MaxOperationsPerDrain;
+        (Connection->Settings.IsSet.MaxOperationsPerDrain ||
+         MsQuicLib.Settings.IsSet.MaxOperationsPerDrain) ?
+            Connection->Settings.MaxOperationsPerDrain :
+            Connection->Worker->DrainBudget;
     uint32_t OperationCount = 0;
     BOOLEAN HasMoreWorkToDo = TRUE;
 
@@ -297,6 +297,8 @@ typedef struct QUIC_CONN_STATS {
         uint64_t DecryptionFailures;    // Count of packets that failed to decrypt.
         uint64_t ValidPackets;          // Count of packets that successfully decrypted or had no encryption.
         uint64_t ValidAckFrames;        // Count of receive ACK frames.
+        uint64_t AckProcessingTime;     // Total time spent processing ACK frames (us).
+        uint64_t MaxAckProcessingTime;  // Longest time spent processing one ACK frame (us).
 
         uint64_t TotalBytes;            // Sum of UDP payloads
         uint64_t TotalStreamBytes;      // Sum of stream payloads
@@ -343,6 +345,14 @@ typedef struct QUIC_CONNECTION {
     //
     QUIC_WORKER* Worker;
 
+    //
+    // An idle worker that has claimed this connection from its current,
+    // overloaded worker. The current worker hands the connection over the next
+    // time it dequeues it.
+    // N.B. Multi-threaded access, synchronized by worker's connection lock.
+    //
+    QUIC_WORKER* StealingWorker;
+
     //
     // The partition this connection is currently assigned to. It is changed at
     // the same time as the worker, but doesn't always need to stay in sync with
@@ -400,6 +410,12 @@ typedef struct QUIC_CONNECTION {
     //
     uint16_t PartitionID;
 
+    //
+    // The timer wheel slot the connection is in. Only valid while TimerLink is
+    // linked into the timer wheel.
+    //
+    uint16_t TimerSlot;
+
     //
     // Number of non-retired desintation CIDs we currently have cached.
     //
@@ -556,6 +572,18 @@ typedef struct QUIC_CONNECTION {
     QUIC_RX_PACKET** ReceiveQueueTail;
     CXPLAT_DISPATCH_LOCK ReceiveQueueLock;
 
+    //
+    // The 1-RTT read key, key phase and packet numbers published by the worker
+    // for decrypting packets on the receive path before they are queued. The
+    // key is NULL when this is not allowed. Protected by RecvDecryptLock, which
+    // the worker also holds while it uses the published key's contexts itself.
+    //
+    const QUIC_PACKET_KEY* RecvDecryptKey;
+    uint64_t RecvDecryptNextPacketNumber;
+    uint64_t RecvDecryptMaxPacketNumber;
+    BOOLEAN RecvDecryptKeyPhase;
+    CXPLAT_DISPATCH_LOCK RecvDecryptLock;
+
     //
     // The queue of operations to process.
     //
@@ -1611,6 +1639,26 @@ QuicConnQueueRecvPackets(
     _In_ uint32_t PacketChainByteLength
     );
 
+//
+// The result of decrypting a packet ahead of its regular processing, as part
+// of a batch.
+//
+typedef struct QUIC_RECV_PREDECRYPTED {
+    QUIC_STATUS Status;
+    uint64_t PacketNumber;
+    uint8_t ResetToken[QUIC_STATELESS_RESET_TOKEN_LENGTH];
+} QUIC_RECV_PREDECRYPTED;
+
+//
+// Stops packets from being decrypted on the receive path with the current
+// 1-RTT read key. Called before the key is changed.
+//
+_IRQL_requires_max_(PASSIVE_LEVEL)
+void
+QuicConnRecvDecryptRevoke(
+    _In_ QUIC_CONNECTION* Connection
+    );
+
 //
 // Queues an unreachable event to a connection for processing.
 //
@@ -2090,6 +2090,12 @@ QuicCryptoUpdateKeyPhase(
     _In_ BOOLEAN LocalUpdate
     )
 {
+    //
+    // The current read key is about to lose its header key, so stop the
+    // receive path from decrypting with it.
+    //
+    QuicConnRecvDecryptRevoke(Connection);
+
     //
     // Free the old read key state (if it exists).
     //
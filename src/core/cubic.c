@@ -174,6 +174,32 @@ CubicCongestionControlReset(
     QuicConnLogCubic(Connection);
 }
 
+//
+// Since the window grows via ACK feedback and since we defer packets when
+// pacing, using the current window to calculate the pacing interval can slow
+// the growth of the window. So instead, use the predicted window of the next
+// round trip. In slowstart, this is double the current window. In congestion
+// avoidance the growth function is more complicated, and we use a simple
+// estimate of 25% growth.
+//
+static
+uint64_t
+CubicCongestionControlGetPacingWindow(
+    _In_ const QUIC_CONGESTION_CONTROL_CUBIC* Cubic
+    )
+{
+    uint64_t EstimatedWnd;
+    if (Cubic->CongestionWindow < Cubic->SlowStartThreshold) {
+        EstimatedWnd = (uint64_t)Cubic->CongestionWindow << 1;
+        if (EstimatedWnd > Cubic->SlowStartThreshold) {
+            EstimatedWnd = Cubic->SlowStartThreshold;
+        }
+    } else {
+        EstimatedWnd = Cubic->CongestionWindow + (Cubic->CongestionWindow >> 2); // CongestionWindow * 1.25
+    }
+    return EstimatedWnd;
+}
+
 _IRQL_requires_max_(DISPATCH_LEVEL)
 uint32_t
 CubicCongestionControlGetSendAllowance(
@@ -210,23 +236,7 @@ CubicCongestionControlGetSendAllowance(
         // size) as the time since the last send times the pacing rate (CWND / RTT).
         //
 
-        //
-        // Since the window grows via ACK feedback and since we defer packets
-        // when pacing, using the current window to calculate the pacing
-        // interval can slow the growth of the window. So instead, use the
-        // predicted window of the next round trip. In slowstart, this is double
-        // the current window. In congestion avoidance the growth function is
-        // more complicated, and we use a simple estimate of 25% growth.
-        //
-        uint64_t EstimatedWnd;
-        if (Cubic->CongestionWindow < Cubic->SlowStartThreshold) {
-            EstimatedWnd = (uint64_t)Cubic->CongestionWindow << 1;
-            if (EstimatedWnd > Cubic->SlowStartThreshold) {
-                EstimatedWnd = Cubic->SlowStartThreshold;
-            }
-        } else {
-            EstimatedWnd = Cubic->CongestionWindow + (Cubic->CongestionWindow >> 2); // CongestionWindow * 1.25
-        }
+        uint64_t EstimatedWnd = CubicCongestionControlGetPacingWindow(Cubic);
 
         SendAllowance =
             Cubic->LastSendAllowance +
@@ -241,6 +251,27 @@ CubicCongestionControlGetSendAllowance(
     return SendAllowance;
 }
 
+_IRQL_requires_max_(DISPATCH_LEVEL)
+uint64_t
+CubicCongestionControlGetPacingRate(
+    _In_ const QUIC_CONGESTION_CONTROL* Cc
+    )
+{
+    const QUIC_CONNECTION* Connection = QuicCongestionControlGetConnection(Cc);
+    if (!Connection->Settings.PacingEnabled ||
+        !Connection->Paths[0].GotFirstRttSample ||
+        Connection->Paths[0].SmoothedRtt < QUIC_MIN_PACING_RTT) {
+        return 0;
+    }
+
+    //
+    // The same rate GetSendAllowance grows the allowance at.
+    //
+    return
+        CubicCongestionControlGetPacingWindow(&Cc->Cubic) * S_TO_US(1) /
+        Connection->Paths[0].SmoothedRtt;
+}
+
 //
 // Returns TRUE if we became unblocked.
 //
@@ -895,6 +926,7 @@ static const QUIC_CONGESTION_CONTROL QuicCongestionControlCubic = {
     .QuicCongestionControlSetExemption = CubicCongestionControlSetExemption,
     .QuicCongestionControlReset = CubicCongestionControlReset,
     .QuicCongestionControlGetSendAllowance = CubicCongestionControlGetSendAllowance,
+    .QuicCongestionControlGetPacingRate = CubicCongestionControlGetPacingRate,
     .QuicCongestionControlOnDataSent = CubicCongestionControlOnDataSent,
     .QuicCongestionControlOnDataInvalidated = CubicCongestionControlOnDataInvalidated,
     .QuicCongestionControlOnDataAcknowledged = CubicCongestionControlOnDataAcknowledged,
@@ -678,6 +678,7 @@ MsQuicLibraryLazyUninitialize(
 #endif
         CxPlatDataPathUninitialize(MsQuicLib.Datapath);
         MsQuicLib.Datapath = NULL;
+        MsQuicLib.SendTxTimeInUse = FALSE;
     }
 
 #if DEBUG
@@ -899,6 +900,19 @@ QuicLibraryLazyInitialize(
 
     CXPLAT_DATAPATH_INIT_CONFIG InitConfig = {0};
     InitConfig.EnableDscpOnRecv = MsQuicLib.EnableDscpOnRecv;
+    InitConfig.EnableSendZeroCopy = MsQuicLib.EnableSendZeroCopy;
+    InitConfig.SendZeroCopyThreshold = MsQuicLib.SendZeroCopyThreshold;
+    InitConfig.EnableCidSteering = MsQuicLib.EnableCidSteering;
+    InitConfig.EnableSendTxTime = MsQuicLib.EnableSendTxTime;
+    InitConfig.EnableRecvTimestamp = MsQuicLib.EnableRecvTimestamp;
+    InitConfig.EnableMemoryDatapath = MsQuicLib.EnableMemoryDatapath;
+    if (MsQuicLib.EnableDatapathEmulation) {
+        InitConfig.Emulation = &MsQuicLib.DatapathEmulation;
+    }
+    if (MsQuicLib.ExecutionConfig &&
+        MsQuicLib.ExecutionConfig->Flags & QUIC_GLOBAL_EXECUTION_CONFIG_FLAG_BUSY_POLL) {
+        InitConfig.BusyPollUs = QuicLibraryGetPollingIdleTimeoutUs();
+    }
 
     Status =
         CxPlatDataPathInitialize(
@@ -913,11 +927,12 @@ QuicLibraryLazyInitialize(
             DataPathInitialized,
             "[data] Initialized, DatapathFeatures=%u",
             QuicLibraryGetDatapathFeatures());
-        if (MsQuicLib.ExecutionConfig &&
-            MsQuicLib.ExecutionConfig->PollingIdleTimeoutUs != 0) {
+        MsQuicLib.SendTxTimeInUse =
+            !!(QuicLibraryGetDatapathFeatures() & CXPLAT_DATAPATH_FEATURE_SEND_TXTIME);
+        if (QuicLibraryGetPollingIdleTimeoutUs() != 0) {
             CxPlatDataPathUpdatePollingIdleTimeout(
                 MsQuicLib.Datapath,
-                MsQuicLib.ExecutionConfig->PollingIdleTimeoutUs);
+                QuicLibraryGetPollingIdleTimeoutUs());
         }
     } else {
         MsQuicLibraryFreePartitions();
@@ -1372,6 +1387,174 @@ QuicLibrarySetGlobalParam(
         break;
     }
 
+    case QUIC_PARAM_GLOBAL_DATAPATH_SEND_ZEROCOPY_ENABLED: {
+
+        if (BufferLength != sizeof(BOOLEAN) || Buffer == NULL) {
+            Status = QUIC_STATUS_INVALID_PARAMETER;
+            break;
+        }
+
+        if (MsQuicLib.LazyInitComplete) {
+            //
+            // The datapath has already been initialized.
+            //
+            Status = QUIC_STATUS_INVALID_STATE;
+            break;
+        }
+
+        MsQuicLib.EnableSendZeroCopy = *(BOOLEAN*)Buffer;
+        Status = QUIC_STATUS_SUCCESS;
+        break;
+    }
+
+    case QUIC_PARAM_GLOBAL_DATAPATH_SEND_ZEROCOPY_THRESHOLD: {
+
+        if (BufferLength != sizeof(uint32_t) || Buffer == NULL) {
+            Status = QUIC_STATUS_INVALID_PARAMETER;
+            break;
+        }
+
+        if (MsQuicLib.LazyInitComplete) {
+            //
+            // The datapath has already been initialized.
+            //
+            Status = QUIC_STATUS_INVALID_STATE;
+            break;
+        }
+
+        MsQuicLib.SendZeroCopyThreshold = *(uint32_t*)Buffer;
+        Status = QUIC_STATUS_SUCCESS;
+        break;
+    }
+
+    case QUIC_PARAM_GLOBAL_DATAPATH_CID_STEERING_ENABLED: {
+
+        if (BufferLength != sizeof(BOOLEAN) || Buffer == NULL) {
+            Status = QUIC_STATUS_INVALID_PARAMETER;
+            break;
+        }
+
+        if (MsQuicLib.LazyInitComplete) {
+            //
+            // The datapath has already been initialized.
+            //
+            Status = QUIC_STATUS_INVALID_STATE;
+            break;
+        }
+
+        MsQuicLib.EnableCidSteering = *(BOOLEAN*)Buffer;
+        Status = QUIC_STATUS_SUCCESS;
+        break;
+    }
+
+    case QUIC_PARAM_GLOBAL_DATAPATH_SEND_TXTIME_ENABLED: {
+
+        if (BufferLength != sizeof(BOOLEAN) || Buffer == NULL) {
+            Status = QUIC_STATUS_INVALID_PARAMETER;
+            break;
+        }
+
+        if (MsQuicLib.LazyInitComplete) {
+            //
+            // The datapath has already been initialized.
+            //
+            Status = QUIC_STATUS_INVALID_STATE;
+            break;
+        }
+
+        MsQuicLib.EnableSendTxTime = *(BOOLEAN*)Buffer;
+        Status = QUIC_STATUS_SUCCESS;
+        break;
+    }
+
+    case QUIC_PARAM_GLOBAL_DATAPATH_RECV_TIMESTAMP_ENABLED: {
+
+        if (BufferLength != sizeof(BOOLEAN) || Buffer == NULL) {
+            Status = QUIC_STATUS_INVALID_PARAMETER;
+            break;
+        }
+
+        if (MsQuicLib.LazyInitComplete) {
+            //
+            // The datapath has already been initialized.
+            //
+            Status = QUIC_STATUS_INVALID_STATE;
+            break;
+        }
+
+        MsQuicLib.EnableRecvTimestamp = *(BOOLEAN*)Buffer;
+        Status = QUIC_STATUS_SUCCESS;
+        break;
+    }
+
+    case QUIC_PARAM_GLOBAL_DATAPATH_MEMORY_ENABLED: {
+
+        if (BufferLength != sizeof(BOOLEAN) || Buffer == NULL) {
+            Status = QUIC_STATUS_INVALID_PARAMETER;
+            break;
+        }
+
+        if (MsQuicLib.LazyInitComplete) {
+            //
+            // The datapath has already been initialized.
+            //
+            Status = QUIC_STATUS_INVALID_STATE;
+            break;
+        }
+
+        MsQuicLib.EnableMemoryDatapath = *(BOOLEAN*)Buffer;
+        Status = QUIC_STATUS_SUCCESS;
+        break;
+    }
+
+    case QUIC_PARAM_GLOBAL_DATAPATH_EMULATION: {
+
+        if (BufferLength != sizeof(QUIC_PRIVATE_DATAPATH_EMULATION) || Buffer == NULL) {
+            Status = QUIC_STATUS_INVALID_PARAMETER;
+            break;
+        }
+
+        if (MsQuicLib.LazyInitComplete) {
+            //
+            // The datapath has already been initialized.
+            //
+            Status = QUIC_STATUS_INVALID_STATE;
+            break;
+        }
+
+        CxPlatCopyMemory(
+            &MsQuicLib.DatapathEmulation,
+            Buffer,
+            sizeof(QUIC_PRIVATE_DATAPATH_EMULATION));
+        MsQuicLib.EnableDatapathEmulation = TRUE;
+        Status = QUIC_STATUS_SUCCESS;
+        break;
+    }
+
+    case QUIC_PARAM_GLOBAL_SEND_FUSED_ENCRYPT_ENABLED: {
+
+        if (BufferLength != sizeof(BOOLEAN) || Buffer == NULL) {
+            Status = QUIC_STATUS_INVALID_PARAMETER;
+            break;
+        }
+
+        MsQuicLib.DisableFusedEncrypt = !*(BOOLEAN*)Buffer;
+        Status = QUIC_STATUS_SUCCESS;
+        break;
+    }
+
+    case QUIC_PARAM_GLOBAL_RECV_PARALLEL_DECRYPT_ENABLED: {
+
+        if (BufferLength != sizeof(BOOLEAN) || Buffer == NULL) {
+            Status = QUIC_STATUS_INVALID_PARAMETER;
+            break;
+        }
+
+        MsQuicLib.EnableParallelDecrypt = *(BOOLEAN*)Buffer;
+        Status = QUIC_STATUS_SUCCESS;
+        break;
+    }
+
     case QUIC_PARAM_GLOBAL_VERSION_NEGOTIATION_ENABLED:
 
         if (Buffer == NULL ||
@@ -1718,7 +1901,8 @@ QuicLibraryGetGlobalParam(
             QUIC_STATISTICS_V2_SIZE_1,
             QUIC_STATISTICS_V2_SIZE_2,
             QUIC_STATISTICS_V2_SIZE_3,
-            QUIC_STATISTICS_V2_SIZE_4
+            QUIC_STATISTICS_V2_SIZE_4,
+            QUIC_STATISTICS_V2_SIZE_5
         };
         static const uint32_t NumStatSizes = ARRAYSIZE(StatSizes);
         uint32_t MaxSizes = *BufferLength / sizeof(uint32_t);
@@ -2132,6 +2316,7 @@ MsQuicOpenVersion(
     Api->StreamShutdown = MsQuicStreamShutdown;
     Api->StreamStart = MsQuicStreamStart;
     Api->StreamSend = MsQuicStreamSend;
+    Api->StreamSendBatch = MsQuicStreamSendBatch;
     Api->StreamReceiveComplete = MsQuicStreamReceiveComplete;
     Api->StreamReceiveSetEnabled = MsQuicStreamReceiveSetEnabled;
     Api->StreamProvideReceiveBuffers = MsQuicStreamProvideReceiveBuffers;
@@ -72,6 +72,61 @@ typedef struct QUIC_LIBRARY {
     //
     BOOLEAN EnableDscpOnRecv : 1;
 
+    //
+    // Whether the datapath will be initialized to send without copying the
+    // payload into the kernel, on platforms that support it.
+    //
+    BOOLEAN EnableSendZeroCopy : 1;
+
+    //
+    // Whether the datapath will be initialized to steer packets to the socket
+    // of the partition encoded in their connection ID, on platforms that
+    // support it.
+    //
+    BOOLEAN EnableCidSteering : 1;
+
+    //
+    // Whether the datapath will be initialized to send with departure times,
+    // on platforms that support it.
+    //
+    BOOLEAN EnableSendTxTime : 1;
+
+    //
+    // Indicates the datapath supports departure times, so paced sends can go
+    // out ahead of time instead of waiting on the pacing timer.
+    //
+    BOOLEAN SendTxTimeInUse : 1;
+
+    //
+    // Whether the datapath will be initialized to timestamp received packets,
+    // on platforms that support it.
+    //
+    BOOLEAN EnableRecvTimestamp : 1;
+
+    //
+    // Whether the datapath will be initialized to loop UDP traffic in process
+    // instead of using the network, on platforms that support it.
+    //
+    BOOLEAN EnableMemoryDatapath : 1;
+
+    //
+    // Whether the memory datapath emulates a network path with the impairments
+    // in DatapathEmulation.
+    //
+    BOOLEAN EnableDatapathEmulation : 1;
+
+    //
+    // Whether stream data is copied into the datagram before being encrypted,
+    // instead of being encrypted directly from the send buffers.
+    //
+    BOOLEAN DisableFusedEncrypt : 1;
+
+    //
+    // Whether 1-RTT packets are decrypted on the receiving datapath thread
+    // before being queued to the connection.
+    //
+    BOOLEAN EnableParallelDecrypt : 1;
+
 #ifdef CxPlatVerifierEnabled
     //
     // The app or driver verifier is globally enabled.
@@ -79,6 +134,17 @@ typedef struct QUIC_LIBRARY {
     BOOLEAN IsVerifying : 1;
 #endif
 
+    //
+    // The minimum send size for zero-copy sends. Zero uses the datapath's
+    // default.
+    //
+    uint32_t SendZeroCopyThreshold;
+
+    //
+    // The network impairments the memory datapath applies.
+    //
+    QUIC_PRIVATE_DATAPATH_EMULATION DatapathEmulation;
+
     //
     // Tracks whether the library has started being used, either by a listener
     // or a client connection being started. Once this state is set, some
@@ -385,6 +451,27 @@ QuicPartitionIdGetIndex(
     return (PartitionId & MsQuicLib.PartitionMask) % MsQuicLib.PartitionCount;
 }
 
+//
+// Returns how long an idle worker keeps polling for new work before it goes to
+// sleep. Busy polling without an explicit timeout uses the default.
+//
+_IRQL_requires_max_(DISPATCH_LEVEL)
+QUIC_INLINE
+uint32_t
+QuicLibraryGetPollingIdleTimeoutUs(
+    void
+    )
+{
+    if (MsQuicLib.ExecutionConfig == NULL) {
+        return 0;
+    }
+    if (MsQuicLib.ExecutionConfig->PollingIdleTimeoutUs == 0 &&
+        MsQuicLib.ExecutionConfig->Flags & QUIC_GLOBAL_EXECUTION_CONFIG_FLAG_BUSY_POLL) {
+        return CXPLAT_DEFAULT_BUSY_POLL_US;
+    }
+    return MsQuicLib.ExecutionConfig->PollingIdleTimeoutUs;
+}
+
 #define QUIC_PERF_SAMPLE_INTERVAL_S    1 // 1 second
 
 _IRQL_requires_max_(DISPATCH_LEVEL)
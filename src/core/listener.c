@@ -346,6 +346,11 @@ MsQuicListenerStart(
             UdpConfig.CibirIdLength);
     }
 
+    // for CID steering (see QuicCidNewRandomSource)
+    UdpConfig.PartitionIdOffsetDst = MsQuicLib.CidServerIdLength;
+    UdpConfig.PartitionIdMask = MsQuicLib.PartitionMask;
+    UdpConfig.PartitionCount = MsQuicLib.PartitionCount;
+
     if (MsQuicLib.Settings.XdpEnabled) {
         UdpConfig.Flags |= CXPLAT_SOCKET_FLAG_XDP;
     }
@@ -7,6 +7,15 @@ Abstract:
 
     Lookup tables for connections.
 
+    Once a lookup is partitioned, local CIDs are found without taking any lock
+    or writing to any shared cache line beyond a per-processor reader count.
+    The partitioned tables are open addressed arrays of immutable CID entries
+    owned by the lookup. Writers still serialize on the lookup's RwLock, but
+    instead of freeing anything they unlink (CID entries, outgrown tables, old
+    partition arrays), they retire it into the current reader epoch. Retired
+    memory is freed once every reader counted in that epoch is gone, either by
+    the next writer or by the last of those readers on its way out.
+
 --*/
 
 #include "precomp.h"
@@ -14,13 +23,107 @@ Abstract:
 #include "lookup.c.clog.h"
 #endif
 
+//
+// Header of anything unlinked from the partitioned hash tables, kept until the
+// lock-free readers that might still see it are gone.
+//
+typedef struct QUIC_LOOKUP_RETIRED {
+
+    QUIC_LOOKUP_RETIRED* Next;
+
+    //
+    // Connection to release (QUIC_CONN_REF_LOOKUP_RESULT) once freed, if any.
+    //
+    QUIC_CONNECTION* Connection;
+
+    //
+    // The pool tag the memory was allocated with.
+    //
+    uint32_t Tag;
+
+} QUIC_LOOKUP_RETIRED;
+
+//
+// A local CID in the partitioned hash tables. A copy of the connection's CID,
+// because the connection frees its CIDs as soon as they are removed.
+//
+typedef struct QUIC_LOOKUP_CID {
+
+    QUIC_LOOKUP_RETIRED Retired;
+
+    //
+    // The connection's CID this was created from. Only used by writers.
+    //
+    QUIC_CID_HASH_ENTRY* SourceCid;
+
+    QUIC_CONNECTION* Connection;
+    uint32_t Hash;
+    uint8_t Length;
+    uint8_t Data[0];
+
+} QUIC_LOOKUP_CID;
+
+//
+// Marks a slot whose entry was removed, without breaking the probe sequence
+// of the entries after it.
+//
+#define QUIC_LOOKUP_CID_TOMBSTONE ((QUIC_LOOKUP_CID*)(uintptr_t)1)
+
+#define QUIC_LOOKUP_CID_TABLE_MIN_SIZE 16
+
+//
+// Linear probing hash table of CID entries. Slots are only ever changed to or
+// from NULL or a tombstone, so readers can probe while a writer adds or
+// removes entries. A table that needs to grow is replaced as a whole.
+//
+typedef struct QUIC_LOOKUP_CID_TABLE {
+
+    QUIC_LOOKUP_RETIRED Retired;
+
+    //
+    // The number of slots minus one. The number of slots is a power of 2.
+    //
+    uint32_t Mask;
+
+    //
+    // The number of entries in the table.
+    //
+    uint32_t Count;
+
+    //
+    // The number of slots that aren't NULL, including tombstones.
+    //
+    uint32_t Used;
+
+    QUIC_LOOKUP_CID* volatile Slots[0];
+
+} QUIC_LOOKUP_CID_TABLE;
+
 typedef struct QUIC_CACHEALIGN QUIC_PARTITIONED_HASHTABLE {
 
-    CXPLAT_DISPATCH_RW_LOCK RwLock;
-    CXPLAT_HASHTABLE Table;
+    QUIC_LOOKUP_CID_TABLE* volatile Table;
 
 } QUIC_PARTITIONED_HASHTABLE;
 
+typedef struct QUIC_LOOKUP_PARTITIONS {
+
+    QUIC_LOOKUP_RETIRED Retired;
+    uint16_t Count;
+    QUIC_PARTITIONED_HASHTABLE Tables[0];
+
+} QUIC_LOOKUP_PARTITIONS;
+
+//
+// Count of the lock-free readers on a single processor, per reader epoch.
+// Padded so that different processors don't share a cache line.
+//
+typedef struct QUIC_LOOKUP_READER_COUNT {
+
+    volatile long Count[2];
+    uint8_t Padding[64 - 2 * sizeof(long)];
+
+} QUIC_LOOKUP_READER_COUNT;
+
 _IRQL_requires_max_(DISPATCH_LEVEL)
 BOOLEAN
 QuicLookupInsertLocalCid(
@@ -30,90 +133,470 @@ QuicLookupInsertLocalCid(
     _In_ BOOLEAN UpdateRefCount
     );
 
+//
+// Stores a pointer that lock-free readers dereference, with a full barrier so
+// that everything it points to is visible before it is.
+//
+QUIC_INLINE
+void
+QuicLookupPublishPointer(
+    _Inout_ void* volatile* Target,
+    _In_opt_ void* Value
+    )
+{
+    //
+    // Writers are serialized by the lookup's RwLock, so this always succeeds.
+    //
+    (void)InterlockedCompareExchangePointer(Target, Value, *Target);
+}
+
+//
+// Returns the partition a CID belongs to.
+//
+QUIC_INLINE
+QUIC_PARTITIONED_HASHTABLE*
+QuicLookupGetPartition(
+    _In_ QUIC_LOOKUP_PARTITIONS* Partitions,
+    _In_reads_(QUIC_MIN_INITIAL_CONNECTION_ID_LENGTH)
+        const uint8_t* const CID
+    )
+{
+    CXPLAT_STATIC_ASSERT(QUIC_CID_PID_LENGTH == 2, "The code below assumes 2 bytes");
+    uint16_t PartitionIndex;
+    CxPlatCopyMemory(&PartitionIndex, CID + MsQuicLib.CidServerIdLength, 2);
+    PartitionIndex &= MsQuicLib.PartitionMask;
+    PartitionIndex %= Partitions->Count;
+    return &Partitions->Tables[PartitionIndex];
+}
+
+_IRQL_requires_max_(DISPATCH_LEVEL)
+QUIC_LOOKUP_CID_TABLE*
+QuicLookupCidTableCreate(
+    _In_ uint32_t SlotCount
+    )
+{
+    CXPLAT_DBG_ASSERT((SlotCount & (SlotCount - 1)) == 0);
+    const size_t Size =
+        sizeof(QUIC_LOOKUP_CID_TABLE) + SlotCount * sizeof(QUIC_LOOKUP_CID*);
+    QUIC_LOOKUP_CID_TABLE* Table =
+        CXPLAT_ALLOC_NONPAGED(Size, QUIC_POOL_LOOKUP_HASHTABLE);
+    if (Table != NULL) {
+        CxPlatZeroMemory(Table, Size);
+        Table->Retired.Tag = QUIC_POOL_LOOKUP_HASHTABLE;
+        Table->Mask = SlotCount - 1;
+    }
+    return Table;
+}
+
+//
+// Looks up a CID in the table. Safe to call without any lock, as long as the
+// table can't be freed underneath.
+//
+_IRQL_requires_max_(DISPATCH_LEVEL)
+QUIC_CONNECTION*
+QuicLookupCidTableFind(
+    _In_ const QUIC_LOOKUP_CID_TABLE* Table,
+    _In_reads_(Length)
+        const uint8_t* const DestCid,
+    _In_ uint8_t Length,
+    _In_ uint32_t Hash
+    )
+{
+    uint32_t Index = Hash & Table->Mask;
+    for (uint32_t i = 0; i <= Table->Mask; i++) {
+        const QUIC_LOOKUP_CID* Entry = QuicReadPtrNoFence(&Table->Slots[Index]);
+        if (Entry == NULL) {
+            break;
+        }
+        if (Entry != QUIC_LOOKUP_CID_TOMBSTONE &&
+            Entry->Hash == Hash &&
+            Entry->Length == Length &&
+            memcmp(DestCid, Entry->Data, Length) == 0) {
+            return Entry->Connection;
+        }
+        Index = (Index + 1) & Table->Mask;
+    }
+    return NULL;
+}
+
+//
+// Adds an entry into a table with room for it. Requires the Lookup->RwLock to
+// be exclusively held.
+//
 _IRQL_requires_max_(DISPATCH_LEVEL)
 void
-QuicLookupInitialize(
-    _Inout_ QUIC_LOOKUP* Lookup
+QuicLookupCidTableAdd(
+    _Inout_ QUIC_LOOKUP_CID_TABLE* Table,
+    _In_ QUIC_LOOKUP_CID* Entry
     )
 {
-    CxPlatZeroMemory(Lookup, sizeof(QUIC_LOOKUP));
-    CxPlatDispatchRwLockInitialize(&Lookup->RwLock);
+    CXPLAT_DBG_ASSERT((Table->Used + 1) * 4 <= (Table->Mask + 1) * 3);
+    uint32_t Index = Entry->Hash & Table->Mask;
+    while (Table->Slots[Index] != NULL &&
+           Table->Slots[Index] != QUIC_LOOKUP_CID_TOMBSTONE) {
+        Index = (Index + 1) & Table->Mask;
+    }
+    if (Table->Slots[Index] == NULL) {
+        Table->Used++;
+    }
+    Table->Count++;
+    QuicLookupPublishPointer((void* volatile*)&Table->Slots[Index], Entry);
 }
 
+//
+// Retires memory unlinked from the partitioned hash tables. Requires the
+// Lookup->RwLock to be exclusively held.
+//
 _IRQL_requires_max_(DISPATCH_LEVEL)
 void
-QuicLookupUninitialize(
-    _In_ QUIC_LOOKUP* Lookup
+QuicLookupRetire(
+    _In_ QUIC_LOOKUP* Lookup,
+    _In_ QUIC_LOOKUP_RETIRED* Retired
     )
 {
-    CXPLAT_DBG_ASSERT(Lookup->CidCount == 0);
+    const long Epoch = Lookup->ReaderEpoch & 1;
+    Retired->Next = Lookup->Retired[Epoch];
+    Lookup->Retired[Epoch] = Retired;
 
-    if (Lookup->PartitionCount == 0) {
-        CXPLAT_DBG_ASSERT(Lookup->SINGLE.Connection == NULL);
-    } else {
-        CXPLAT_DBG_ASSERT(Lookup->HASH.Tables != NULL);
-        for (uint16_t i = 0; i < Lookup->PartitionCount; i++) {
-            QUIC_PARTITIONED_HASHTABLE* Table = &Lookup->HASH.Tables[i];
-            CXPLAT_DBG_ASSERT(Table->Table.NumEntries == 0);
-#pragma warning(push)
-#pragma warning(disable:6001)
-            CxPlatHashtableUninitialize(&Table->Table);
-#pragma warning(pop)
-            CxPlatDispatchRwLockUninitialize(&Table->RwLock);
+    //
+    // Interlocked, so that a reader leaving after this sees it set (see
+    // QuicLookupReadEnd), or is seen by QuicLookupReclaim.
+    //
+    InterlockedIncrement(&Lookup->ReclaimPending);
+}
+
+//
+// Inserts an entry into a partition's table, replacing the table with a
+// larger one first if needed. Lookup is NULL if the partition isn't visible
+// to readers yet. Requires the Lookup->RwLock to be exclusively held.
+//
+_IRQL_requires_max_(DISPATCH_LEVEL)
+BOOLEAN
+QuicLookupCidTableInsert(
+    _In_opt_ QUIC_LOOKUP* Lookup,
+    _Inout_ QUIC_PARTITIONED_HASHTABLE* Partition,
+    _In_ QUIC_LOOKUP_CID* Entry
+    )
+{
+    QUIC_LOOKUP_CID_TABLE* Table = Partition->Table;
+    if ((Table->Used + 1) * 4 > (Table->Mask + 1) * 3) {
+        //
+        // Rebuild the table, which also drops the tombstones, growing it
+        // until it's no more than half full.
+        //
+        uint32_t SlotCount = Table->Mask + 1;
+        while ((Table->Count + 1) * 2 > SlotCount) {
+            SlotCount *= 2;
+        }
+        QUIC_LOOKUP_CID_TABLE* NewTable = QuicLookupCidTableCreate(SlotCount);
+        if (NewTable == NULL) {
+            return FALSE;
         }
-        CXPLAT_FREE(Lookup->HASH.Tables, QUIC_POOL_LOOKUP_HASHTABLE);
+        for (uint32_t i = 0; i <= Table->Mask; i++) {
+            if (Table->Slots[i] != NULL &&
+                Table->Slots[i] != QUIC_LOOKUP_CID_TOMBSTONE) {
+                QuicLookupCidTableAdd(NewTable, Table->Slots[i]);
+            }
+        }
+        QuicLookupPublishPointer((void* volatile*)&Partition->Table, NewTable);
+        if (Lookup != NULL) {
+            QuicLookupRetire(Lookup, &Table->Retired);
+        } else {
+            CXPLAT_FREE(Table, QUIC_POOL_LOOKUP_HASHTABLE);
+        }
+        Table = NewTable;
     }
 
-    if (Lookup->MaximizePartitioning) {
-        CXPLAT_DBG_ASSERT(Lookup->RemoteHashTable.NumEntries == 0);
-        CxPlatHashtableUninitialize(&Lookup->RemoteHashTable);
+    QuicLookupCidTableAdd(Table, Entry);
+    return TRUE;
+}
+
+//
+// Removes the entry for the connection's CID from the table and returns it.
+// Requires the Lookup->RwLock to be exclusively held.
+//
+_IRQL_requires_max_(DISPATCH_LEVEL)
+QUIC_LOOKUP_CID*
+QuicLookupCidTableRemove(
+    _Inout_ QUIC_LOOKUP_CID_TABLE* Table,
+    _In_ const QUIC_CID_HASH_ENTRY* SourceCid,
+    _In_ uint32_t Hash
+    )
+{
+    uint32_t Index = Hash & Table->Mask;
+    while (Table->Slots[Index] == QUIC_LOOKUP_CID_TOMBSTONE ||
+           Table->Slots[Index]->SourceCid != SourceCid) {
+        CXPLAT_DBG_ASSERT(Table->Slots[Index] != NULL);
+        Index = (Index + 1) & Table->Mask;
     }
 
-    CxPlatDispatchRwLockUninitialize(&Lookup->RwLock);
+    QUIC_LOOKUP_CID* Entry = Table->Slots[Index];
+    if (Table->Slots[(Index + 1) & Table->Mask] == NULL) {
+        //
+        // Nothing probes past this slot, so it can be freed up completely.
+        //
+        Table->Slots[Index] = NULL;
+        Table->Used--;
+    } else {
+        Table->Slots[Index] = QUIC_LOOKUP_CID_TOMBSTONE;
+    }
+    Table->Count--;
+
+    return Entry;
+}
+
+_IRQL_requires_max_(DISPATCH_LEVEL)
+void
+QuicLookupFreePartitions(
+    _In_ QUIC_LOOKUP_PARTITIONS* Partitions,
+    _In_ BOOLEAN FreeEntries
+    )
+{
+    for (uint16_t i = 0; i < Partitions->Count; i++) {
+        QUIC_LOOKUP_CID_TABLE* Table = Partitions->Tables[i].Table;
+        if (Table == NULL) {
+            continue;
+        }
+        if (FreeEntries) {
+            for (uint32_t j = 0; j <= Table->Mask; j++) {
+                if (Table->Slots[j] != NULL &&
+                    Table->Slots[j] != QUIC_LOOKUP_CID_TOMBSTONE) {
+                    CXPLAT_FREE(Table->Slots[j], QUIC_POOL_LOOKUP_CID);
+                }
+            }
+        }
+        CXPLAT_FREE(Table, QUIC_POOL_LOOKUP_HASHTABLE);
+    }
+    CXPLAT_FREE(Partitions, QUIC_POOL_LOOKUP_HASHTABLE);
 }
 
 //
-// Allocates and initializes a new partitioned hash table.
+// Allocates and initializes a new set of partitioned hash tables.
 //
 _IRQL_requires_max_(DISPATCH_LEVEL)
-BOOLEAN
-QuicLookupCreateHashTable(
-    _In_ QUIC_LOOKUP* Lookup,
+QUIC_LOOKUP_PARTITIONS*
+QuicLookupCreatePartitions(
     _In_range_(>, 0) uint16_t PartitionCount
     )
 {
-    CXPLAT_DBG_ASSERT(Lookup->LookupTable == NULL);
     CXPLAT_FRE_ASSERT(PartitionCount > 0);
 
-    Lookup->HASH.Tables =
+    const size_t Size =
+        sizeof(QUIC_LOOKUP_PARTITIONS) +
+        sizeof(QUIC_PARTITIONED_HASHTABLE) * PartitionCount;
+    QUIC_LOOKUP_PARTITIONS* Partitions =
+        CXPLAT_ALLOC_NONPAGED(Size, QUIC_POOL_LOOKUP_HASHTABLE);
+    if (Partitions == NULL) {
+        return NULL;
+    }
+
+    CxPlatZeroMemory(Partitions, Size);
+    Partitions->Retired.Tag = QUIC_POOL_LOOKUP_HASHTABLE;
+    Partitions->Count = PartitionCount;
+    for (uint16_t i = 0; i < PartitionCount; i++) {
+        Partitions->Tables[i].Table =
+            QuicLookupCidTableCreate(QUIC_LOOKUP_CID_TABLE_MIN_SIZE);
+        if (Partitions->Tables[i].Table == NULL) {
+            QuicLookupFreePartitions(Partitions, FALSE);
+            return NULL;
+        }
+    }
+
+    return Partitions;
+}
+
+_IRQL_requires_max_(DISPATCH_LEVEL)
+QUIC_LOOKUP_CID*
+QuicLookupCidCreate(
+    _In_ QUIC_CID_HASH_ENTRY* SourceCid,
+    _In_ uint32_t Hash
+    )
+{
+    QUIC_LOOKUP_CID* Entry =
         CXPLAT_ALLOC_NONPAGED(
-            sizeof(QUIC_PARTITIONED_HASHTABLE) * PartitionCount,
-            QUIC_POOL_LOOKUP_HASHTABLE);
-
-    if (Lookup->HASH.Tables != NULL) {
-
-        uint16_t Cleanup = 0;
-        uint8_t Failed = FALSE;
-        for (uint16_t i = 0; i < PartitionCount; i++) {
-            if (!CxPlatHashtableInitializeEx(&Lookup->HASH.Tables[i].Table, CXPLAT_HASH_MIN_SIZE)) {
-                Cleanup = i;
-                Failed = TRUE;
-                break;
-            }
-            CxPlatDispatchRwLockInitialize(&Lookup->HASH.Tables[i].RwLock);
+            sizeof(QUIC_LOOKUP_CID) + SourceCid->CID.Length,
+            QUIC_POOL_LOOKUP_CID);
+    if (Entry != NULL) {
+        Entry->Retired.Next = NULL;
+        Entry->Retired.Connection = NULL;
+        Entry->Retired.Tag = QUIC_POOL_LOOKUP_CID;
+        Entry->SourceCid = SourceCid;
+        Entry->Connection = SourceCid->Connection;
+        Entry->Hash = Hash;
+        Entry->Length = SourceCid->CID.Length;
+        CxPlatCopyMemory(Entry->Data, SourceCid->CID.Data, SourceCid->CID.Length);
+    }
+    return Entry;
+}
+
+//
+// Returns TRUE if no reader counted in the given epoch is left.
+//
+_IRQL_requires_max_(DISPATCH_LEVEL)
+BOOLEAN
+QuicLookupReadersDrained(
+    _In_ const QUIC_LOOKUP* Lookup,
+    _In_ long Epoch
+    )
+{
+    long Count = 0;
+    for (uint32_t i = 0; i < CxPlatProcCount(); i++) {
+        Count += Lookup->ReaderCounts[i].Count[Epoch];
+    }
+    return Count == 0;
+}
+
+//
+// Flips the reader epoch as far as the readers allow, and returns the retired
+// memory no reader can see anymore. Requires the Lookup->RwLock to be
+// exclusively held. The result must be passed to QuicLookupFreeRetired after
+// releasing the lock.
+//
+_IRQL_requires_max_(DISPATCH_LEVEL)
+QUIC_LOOKUP_RETIRED*
+QuicLookupReclaim(
+    _In_ QUIC_LOOKUP* Lookup
+    )
+{
+    QUIC_LOOKUP_RETIRED* Reclaimed = NULL;
+    if (Lookup->ReclaimPending == 0) {
+        return NULL;
+    }
+
+    //
+    // Memory retired in the previous epoch is safe to free once the readers
+    // counted in it are gone, because everyone else started after the flip to
+    // the current epoch. Flipping again then makes the current epoch the
+    // previous one, so with no readers around, all of it is freed in two
+    // passes.
+    //
+    for (uint8_t i = 0; i < 2; i++) {
+        const long Previous = (Lookup->ReaderEpoch & 1) ^ 1;
+        if (!QuicLookupReadersDrained(Lookup, Previous)) {
+            break;
         }
-        if (Failed) {
-            for (uint16_t i = 0; i < Cleanup; i++) {
-                CxPlatHashtableUninitialize(&Lookup->HASH.Tables[i].Table);
-            }
-            CXPLAT_FREE(Lookup->HASH.Tables, QUIC_POOL_LOOKUP_HASHTABLE);
-            Lookup->HASH.Tables = NULL;
-        } else {
-            Lookup->PartitionCount = PartitionCount;
+        QUIC_LOOKUP_RETIRED** Tail = &Lookup->Retired[Previous];
+        while (*Tail != NULL) {
+            Tail = &(*Tail)->Next;
+        }
+        *Tail = Reclaimed;
+        Reclaimed = Lookup->Retired[Previous];
+        Lookup->Retired[Previous] = NULL;
+
+        //
+        // Interlocked, so that a reader still counted in the epoch being left
+        // either is seen by the next pass, or sees the flip on its way out.
+        //
+        InterlockedIncrement(&Lookup->ReaderEpoch);
+    }
+
+    if (Lookup->Retired[0] == NULL && Lookup->Retired[1] == NULL) {
+        Lookup->ReclaimPending = 0;
+    }
+
+    return Reclaimed;
+}
+
+_IRQL_requires_max_(DISPATCH_LEVEL)
+void
+QuicLookupFreeRetired(
+    _In_opt_ QUIC_LOOKUP_RETIRED* Retired
+    )
+{
+    while (Retired != NULL) {
+        QUIC_LOOKUP_RETIRED* Next = Retired->Next;
+        QUIC_CONNECTION* Connection = Retired->Connection;
+        CXPLAT_FREE(Retired, Retired->Tag);
+        if (Connection != NULL) {
+            QuicConnRelease(Connection, QUIC_CONN_REF_LOOKUP_RESULT);
+        }
+        Retired = Next;
+    }
+}
+
+//
+// Starts a lock-free read of the partitioned hash tables. Returns the reader
+// count to pass to QuicLookupReadEnd.
+//
+QUIC_INLINE
+volatile long*
+QuicLookupReadBegin(
+    _In_ QUIC_LOOKUP* Lookup,
+    _In_ QUIC_LOOKUP_READER_COUNT* ReaderCounts,
+    _Out_ long* Epoch
+    )
+{
+    *Epoch = Lookup->ReaderEpoch & 1;
+    volatile long* Count =
+        &ReaderCounts[CxPlatProcCurrentNumber() % CxPlatProcCount()].Count[*Epoch];
+    InterlockedIncrement(Count);
+    return Count;
+}
+
+_IRQL_requires_max_(DISPATCH_LEVEL)
+void
+QuicLookupReadEnd(
+    _In_ QUIC_LOOKUP* Lookup,
+    _In_ long Epoch,
+    _In_ volatile long* Count
+    )
+{
+    //
+    // The last reader of an epoch the writers already moved on from is what
+    // holds up the retired memory, so that reader frees it.
+    //
+    if (InterlockedDecrement(Count) == 0 &&
+        Lookup->ReclaimPending != 0 &&
+        (Lookup->ReaderEpoch & 1) != Epoch) {
+        CxPlatDispatchRwLockAcquireExclusive(&Lookup->RwLock, PrevIrql);
+        QUIC_LOOKUP_RETIRED* Reclaimed = QuicLookupReclaim(Lookup);
+        CxPlatDispatchRwLockReleaseExclusive(&Lookup->RwLock, PrevIrql);
+        QuicLookupFreeRetired(Reclaimed);
+    }
+}
+
+_IRQL_requires_max_(DISPATCH_LEVEL)
+void
+QuicLookupInitialize(
+    _Inout_ QUIC_LOOKUP* Lookup
+    )
+{
+    CxPlatZeroMemory(Lookup, sizeof(QUIC_LOOKUP));
+    CxPlatDispatchRwLockInitialize(&Lookup->RwLock);
+}
+
+_IRQL_requires_max_(DISPATCH_LEVEL)
+void
+QuicLookupUninitialize(
+    _In_ QUIC_LOOKUP* Lookup
+    )
+{
+    CXPLAT_DBG_ASSERT(Lookup->CidCount == 0);
+
+    if (Lookup->PartitionCount == 0) {
+        CXPLAT_DBG_ASSERT(Lookup->SINGLE.Connection == NULL);
+    } else {
+        CXPLAT_DBG_ASSERT(Lookup->HASH.Partitions != NULL);
+#if DEBUG
+        for (uint16_t i = 0; i < Lookup->PartitionCount; i++) {
+            CXPLAT_DBG_ASSERT(Lookup->HASH.Partitions->Tables[i].Table->Count == 0);
         }
+#endif
+        QuicLookupFreePartitions(Lookup->HASH.Partitions, FALSE);
+    }
+
+    QuicLookupFreeRetired(Lookup->Retired[0]);
+    QuicLookupFreeRetired(Lookup->Retired[1]);
+    if (Lookup->ReaderCounts != NULL) {
+        CXPLAT_FREE(Lookup->ReaderCounts, QUIC_POOL_LOOKUP_HASHTABLE);
+    }
+
+    if (Lookup->MaximizePartitioning) {
+        CXPLAT_DBG_ASSERT(Lookup->RemoteHashTable.NumEntries == 0);
+        CxPlatHashtableUninitialize(&Lookup->RemoteHashTable);
     }
 
-    return Lookup->HASH.Tables != NULL;
+    CxPlatDispatchRwLockUninitialize(&Lookup->RwLock);
 }
 
 //
@@ -152,87 +635,106 @@ QuicLookupRebalance(
 
     if (PartitionCount > Lookup->PartitionCount) {
 
-        uint16_t PreviousPartitionCount = Lookup->PartitionCount;
-        void* PreviousLookup = Lookup->LookupTable;
-        Lookup->LookupTable = NULL;
-
         CXPLAT_DBG_ASSERT(PartitionCount != 0);
 
-        if (!QuicLookupCreateHashTable(Lookup, PartitionCount)) {
-            Lookup->LookupTable = PreviousLookup;
+        if (Lookup->ReaderCounts == NULL) {
+            const size_t Size =
+                sizeof(QUIC_LOOKUP_READER_COUNT) * CxPlatProcCount();
+            QUIC_LOOKUP_READER_COUNT* ReaderCounts =
+                CXPLAT_ALLOC_NONPAGED(Size, QUIC_POOL_LOOKUP_HASHTABLE);
+            if (ReaderCounts == NULL) {
+                return FALSE;
+            }
+            CxPlatZeroMemory(ReaderCounts, Size);
+            QuicLookupPublishPointer(
+                (void* volatile*)&Lookup->ReaderCounts, ReaderCounts);
+        }
+
+        QUIC_LOOKUP_PARTITIONS* PreviousPartitions = Lookup->HASH.Partitions;
+        QUIC_LOOKUP_PARTITIONS* Partitions =
+            QuicLookupCreatePartitions(PartitionCount);
+        if (Partitions == NULL) {
             return FALSE;
         }
 
         //
-        // Move the CIDs to the new table.
+        // Fill the new tables before readers can see them.
         //
 
-        if (PreviousPartitionCount == 0) {
+        if (PreviousPartitions == NULL) {
 
             //
             // Only a single connection before. Enumerate all CIDs on the
-            // connection and reinsert them into the new table(s).
+            // connection and insert them into the new table(s).
             //
 
-            if (PreviousLookup != NULL) {
-                CXPLAT_SLIST_ENTRY* Entry =
-                    ((QUIC_CONNECTION*)PreviousLookup)->SourceCids.Next;
+            if (Lookup->SINGLE.Connection != NULL) {
+                CXPLAT_SLIST_ENTRY* Link = Lookup->SINGLE.Connection->SourceCids.Next;
 
-                while (Entry != NULL) {
+                while (Link != NULL) {
                     QUIC_CID_HASH_ENTRY *CID =
                         CXPLAT_CONTAINING_RECORD(
-                            Entry,
+                            Link,
                             QUIC_CID_HASH_ENTRY,
                             Link);
-                    (void)QuicLookupInsertLocalCid(
-                        Lookup,
-                        CxPlatHashSimple(CID->CID.Length, CID->CID.Data),
-                        CID,
-                        FALSE);
-                    Entry = Entry->Next;
+                    Link = Link->Next;
+                    if (!CID->CID.IsInLookupTable) {
+                        continue;
+                    }
+                    QUIC_LOOKUP_CID* Entry =
+                        QuicLookupCidCreate(
+                            CID,
+                            CxPlatHashSimple(CID->CID.Length, CID->CID.Data));
+                    if (Entry == NULL) {
+                        QuicLookupFreePartitions(Partitions, TRUE);
+                        return FALSE;
+                    }
+                    if (!QuicLookupCidTableInsert(
+                            NULL,
+                            QuicLookupGetPartition(Partitions, CID->CID.Data),
+                            Entry)) {
+                        CXPLAT_FREE(Entry, QUIC_POOL_LOOKUP_CID);
+                        QuicLookupFreePartitions(Partitions, TRUE);
+                        return FALSE;
+                    }
                 }
             }
 
         } else {
 
             //
-            // Changes the number of partitioned tables. Remove all the CIDs
-            // from the old tables and insert them into the new tables.
+            // Changes the number of partitioned tables. Insert all the CID
+            // entries into the new tables too.
             //
 
-            QUIC_PARTITIONED_HASHTABLE* PreviousTable = PreviousLookup;
-            for (uint16_t i = 0; i < PreviousPartitionCount; i++) {
-                CXPLAT_HASHTABLE_ENUMERATOR Enumerator;
-#pragma warning(push)
-#pragma warning(disable:6001)
-                CxPlatHashtableEnumerateBegin(&PreviousTable[i].Table, &Enumerator);
-#pragma warning(pop)
-                while (TRUE) {
-                    CXPLAT_HASHTABLE_ENTRY* Entry =
-                        CxPlatHashtableEnumerateNext(&PreviousTable[i].Table, &Enumerator);
-                    if (Entry == NULL) {
-                        CxPlatHashtableEnumerateEnd(&PreviousTable[i].Table, &Enumerator);
-                        break;
+            for (uint16_t i = 0; i < PreviousPartitions->Count; i++) {
+                QUIC_LOOKUP_CID_TABLE* Table = PreviousPartitions->Tables[i].Table;
+                for (uint32_t j = 0; j <= Table->Mask; j++) {
+                    QUIC_LOOKUP_CID* Entry = Table->Slots[j];
+                    if (Entry == NULL || Entry == QUIC_LOOKUP_CID_TOMBSTONE) {
+                        continue;
+                    }
+                    if (!QuicLookupCidTableInsert(
+                            NULL,
+                            QuicLookupGetPartition(Partitions, Entry->Data),
+                            Entry)) {
+                        QuicLookupFreePartitions(Partitions, FALSE);
+                        return FALSE;
                     }
-                    CxPlatHashtableRemove(&PreviousTable[i].Table, Entry, NULL);
-
-                    QUIC_CID_HASH_ENTRY *CID =
-                        CXPLAT_CONTAINING_RECORD(
-                            Entry,
-                            QUIC_CID_HASH_ENTRY,
-                            Entry);
-                    (void)QuicLookupInsertLocalCid(
-                        Lookup,
-                        CxPlatHashSimple(CID->CID.Length, CID->CID.Data),
-                        CID,
-                        FALSE);
                 }
-#pragma warning(push)
-#pragma warning(disable:6001)
-                CxPlatHashtableUninitialize(&PreviousTable[i].Table);
-#pragma warning(pop)
             }
-            CXPLAT_FREE(PreviousTable, QUIC_POOL_LOOKUP_HASHTABLE);
+        }
+
+        QuicLookupPublishPointer(
+            (void* volatile*)&Lookup->HASH.Partitions, Partitions);
+        Lookup->PartitionCount = PartitionCount;
+        Lookup->SINGLE.Connection = NULL;
+
+        if (PreviousPartitions != NULL) {
+            for (uint16_t i = 0; i < PreviousPartitions->Count; i++) {
+                QuicLookupRetire(Lookup, &PreviousPartitions->Tables[i].Table->Retired);
+            }
+            QuicLookupRetire(Lookup, &PreviousPartitions->Retired);
         }
     }
 
@@ -263,7 +765,9 @@ QuicLookupMaximizePartitioning(
         }
     }
 
+    QUIC_LOOKUP_RETIRED* Reclaimed = QuicLookupReclaim(Lookup);
     CxPlatDispatchRwLockReleaseExclusive(&Lookup->RwLock, PrevIrql);
+    QuicLookupFreeRetired(Reclaimed);
 
     return Result;
 }
@@ -299,38 +803,9 @@ QuicCidMatchConnection(
 }
 
 //
-// Uses the hash and destination connection ID to look up the connection in the
-// hash table. Returns the pointer to the connection if found; NULL otherwise.
+// Requires either Lookup->RwLock to be held, or a lock-free read to be in
+// progress (see QuicLookupReadBegin) with the partitioned hash tables set.
 //
-_IRQL_requires_max_(DISPATCH_LEVEL)
-QUIC_CONNECTION*
-QuicHashLookupConnection(
-    _In_ CXPLAT_HASHTABLE* Table,
-    _In_reads_(Length)
-        const uint8_t* const DestCid,
-    _In_ uint8_t Length,
-    _In_ uint32_t Hash
-    )
-{
-    CXPLAT_HASHTABLE_LOOKUP_CONTEXT Context;
-    CXPLAT_HASHTABLE_ENTRY* TableEntry =
-        CxPlatHashtableLookup(Table, Hash, &Context);
-
-    while (TableEntry != NULL) {
-        QUIC_CID_HASH_ENTRY* CIDEntry =
-            CXPLAT_CONTAINING_RECORD(TableEntry, QUIC_CID_HASH_ENTRY, Entry);
-
-        if (CIDEntry->CID.Length == Length &&
-            memcmp(DestCid, CIDEntry->CID.Data, Length) == 0) {
-            return CIDEntry->Connection;
-        }
-
-        TableEntry = CxPlatHashtableLookupNext(Table, &Context);
-    }
-
-    return NULL;
-}
-
 _IRQL_requires_max_(DISPATCH_LEVEL)
 QUIC_CONNECTION*
 QuicLookupFindConnectionByLocalCidInternal(
@@ -342,8 +817,9 @@ QuicLookupFindConnectionByLocalCidInternal(
     )
 {
     QUIC_CONNECTION* Connection = NULL;
+    QUIC_LOOKUP_PARTITIONS* Partitions = QuicReadPtrNoFence(&Lookup->HASH.Partitions);
 
-    if (Lookup->PartitionCount == 0) {
+    if (Partitions == NULL) {
         //
         // Only a single connection is on this binding. Validate that the
         // destination connection ID matches that connection.
@@ -362,21 +838,14 @@ QuicLookupFindConnectionByLocalCidInternal(
         // partitioned hash table array, and look up the connection in that
         // hash table.
         //
-        CXPLAT_STATIC_ASSERT(QUIC_CID_PID_LENGTH == 2, "The code below assumes 2 bytes");
-        uint16_t PartitionIndex;
-        CxPlatCopyMemory(&PartitionIndex, CID + MsQuicLib.CidServerIdLength, 2);
-        PartitionIndex &= MsQuicLib.PartitionMask;
-        PartitionIndex %= Lookup->PartitionCount;
-        QUIC_PARTITIONED_HASHTABLE* Table = &Lookup->HASH.Tables[PartitionIndex];
-
-        CxPlatDispatchRwLockAcquireShared(&Table->RwLock, PrevIrql);
+        QUIC_PARTITIONED_HASHTABLE* Partition =
+            QuicLookupGetPartition(Partitions, CID);
         Connection =
-            QuicHashLookupConnection(
-                &Table->Table,
+            QuicLookupCidTableFind(
+                QuicReadPtrNoFence(&Partition->Table),
                 CID,
                 CIDLen,
                 Hash);
-        CxPlatDispatchRwLockReleaseShared(&Table->RwLock, PrevIrql);
     }
 
 #if QUIC_DEBUG_HASHTABLE_LOOKUP
@@ -478,22 +947,19 @@ QuicLookupInsertLocalCid(
         CXPLAT_DBG_ASSERT(SourceCid->CID.Length >= MsQuicLib.CidServerIdLength + QUIC_CID_PID_LENGTH);
 
         //
-        // Insert the source connection ID into the hash table.
+        // Insert a copy of the source connection ID into the hash table.
         //
-        CXPLAT_STATIC_ASSERT(QUIC_CID_PID_LENGTH == 2, "The code below assumes 2 bytes");
-        uint16_t PartitionIndex;
-        CxPlatCopyMemory(&PartitionIndex, SourceCid->CID.Data + MsQuicLib.CidServerIdLength, 2);
-        PartitionIndex &= MsQuicLib.PartitionMask;
-        PartitionIndex %= Lookup->PartitionCount;
-        QUIC_PARTITIONED_HASHTABLE* Table = &Lookup->HASH.Tables[PartitionIndex];
-
-        CxPlatDispatchRwLockAcquireExclusive(&Table->RwLock, PrevIrql);
-        CxPlatHashtableInsert(
-            &Table->Table,
-            &SourceCid->Entry,
-            Hash,
-            NULL);
-        CxPlatDispatchRwLockReleaseExclusive(&Table->RwLock, PrevIrql);
+        QUIC_LOOKUP_CID* Entry = QuicLookupCidCreate(SourceCid, Hash);
+        if (Entry == NULL) {
+            return FALSE;
+        }
+        if (!QuicLookupCidTableInsert(
+                Lookup,
+                QuicLookupGetPartition(Lookup->HASH.Partitions, SourceCid->CID.Data),
+                Entry)) {
+            CXPLAT_FREE(Entry, QUIC_POOL_LOOKUP_CID);
+            return FALSE;
+        }
     }
 
     if (UpdateRefCount) {
@@ -609,17 +1075,20 @@ QuicLookupRemoveLocalCidInt(
         CXPLAT_DBG_ASSERT(SourceCid->CID.Length >= MsQuicLib.CidServerIdLength + QUIC_CID_PID_LENGTH);
 
         //
-        // Remove the source connection ID from the multi-hash table.
+        // Remove the source connection ID from the multi-hash table. Lock-free
+        // readers might still be looking at the entry, so it's retired along
+        // with a reference on the connection they'd return.
         //
-        CXPLAT_STATIC_ASSERT(QUIC_CID_PID_LENGTH == 2, "The code below assumes 2 bytes");
-        uint16_t PartitionIndex;
-        CxPlatCopyMemory(&PartitionIndex, SourceCid->CID.Data + MsQuicLib.CidServerIdLength, 2);
-        PartitionIndex &= MsQuicLib.PartitionMask;
-        PartitionIndex %= Lookup->PartitionCount;
-        QUIC_PARTITIONED_HASHTABLE* Table = &Lookup->HASH.Tables[PartitionIndex];
-        CxPlatDispatchRwLockAcquireExclusive(&Table->RwLock, PrevIrql);
-        CxPlatHashtableRemove(&Table->Table, &SourceCid->Entry, NULL);
-        CxPlatDispatchRwLockReleaseExclusive(&Table->RwLock, PrevIrql);
+        QUIC_PARTITIONED_HASHTABLE* Partition =
+            QuicLookupGetPartition(Lookup->HASH.Partitions, SourceCid->CID.Data);
+        QUIC_LOOKUP_CID* Entry =
+            QuicLookupCidTableRemove(
+                Partition->Table,
+                SourceCid,
+                CxPlatHashSimple(SourceCid->CID.Length, SourceCid->CID.Data));
+        QuicConnAddRef(Entry->Connection, QUIC_CONN_REF_LOOKUP_RESULT);
+        Entry->Retired.Connection = Entry->Connection;
+        QuicLookupRetire(Lookup, &Entry->Retired);
     }
 }
 
@@ -633,10 +1102,34 @@ QuicLookupFindConnectionByLocalCid(
     )
 {
     uint32_t Hash = CxPlatHashSimple(CIDLen, CID);
+    QUIC_CONNECTION* ExistingConnection;
+
+    //
+    // Once partitioned, look up without taking the lock.
+    //
+    QUIC_LOOKUP_READER_COUNT* ReaderCounts = QuicReadPtrNoFence(&Lookup->ReaderCounts);
+    if (ReaderCounts != NULL) {
+        long Epoch;
+        volatile long* Count = QuicLookupReadBegin(Lookup, ReaderCounts, &Epoch);
+        if (QuicReadPtrNoFence(&Lookup->HASH.Partitions) != NULL) {
+            ExistingConnection =
+                QuicLookupFindConnectionByLocalCidInternal(
+                    Lookup,
+                    CID,
+                    CIDLen,
+                    Hash);
+            if (ExistingConnection != NULL) {
+                QuicConnAddRef(ExistingConnection, QUIC_CONN_REF_LOOKUP_RESULT);
+            }
+            QuicLookupReadEnd(Lookup, Epoch, Count);
+            return ExistingConnection;
+        }
+        QuicLookupReadEnd(Lookup, Epoch, Count);
+    }
 
     CxPlatDispatchRwLockAcquireShared(&Lookup->RwLock, PrevIrql);
 
-    QUIC_CONNECTION* ExistingConnection =
+    ExistingConnection =
         QuicLookupFindConnectionByLocalCidInternal(
             Lookup,
             CID,
@@ -759,7 +1252,9 @@ QuicLookupAddLocalCid(
         }
     }
 
+    QUIC_LOOKUP_RETIRED* Reclaimed = QuicLookupReclaim(Lookup);
     CxPlatDispatchRwLockReleaseExclusive(&Lookup->RwLock, PrevIrql);
+    QuicLookupFreeRetired(Reclaimed);
 
     return Result;
 }
@@ -830,7 +1325,9 @@ QuicLookupRemoveLocalCid(
     QuicLookupRemoveLocalCidInt(Lookup, SourceCid);
     SourceCid->CID.IsInLookupTable = FALSE;
     *Entry = (*Entry)->Next;
+    QUIC_LOOKUP_RETIRED* Reclaimed = QuicLookupReclaim(Lookup);
     CxPlatDispatchRwLockReleaseExclusive(&Lookup->RwLock, PrevIrql);
+    QuicLookupFreeRetired(Reclaimed);
     QuicConnRelease(SourceCid->Connection, QUIC_CONN_REF_LOOKUP_TABLE);
 }
 
@@ -882,7 +1379,9 @@ QuicLookupRemoveLocalCids(
         }
         CXPLAT_FREE(CID, QUIC_POOL_CIDHASH);
     }
+    QUIC_LOOKUP_RETIRED* Reclaimed = QuicLookupReclaim(Lookup);
     CxPlatDispatchRwLockReleaseExclusive(&Lookup->RwLock, PrevIrql);
+    QuicLookupFreeRetired(Reclaimed);
 
     for (uint8_t i = 0; i < ReleaseRefCount; i++) {
 #pragma prefast(suppress:6001, "SAL doesn't understand ref counts")
@@ -913,7 +1412,9 @@ QuicLookupMoveLocalConnectionIDs(
         }
         Entry = Entry->Next;
     }
+    QUIC_LOOKUP_RETIRED* Reclaimed = QuicLookupReclaim(LookupSrc);
     CxPlatDispatchRwLockReleaseExclusive(&LookupSrc->RwLock, PrevIrql1);
+    QuicLookupFreeRetired(Reclaimed);
 
     CxPlatDispatchRwLockAcquireExclusive(&LookupDest->RwLock, PrevIrql2);
 #pragma prefast(suppress:6001, "SAL doesn't understand ref counts")
@@ -925,16 +1426,21 @@ QuicLookupMoveLocalConnectionIDs(
                 QUIC_CID_HASH_ENTRY,
                 Link);
         if (CID->CID.IsInLookupTable) {
-            BOOLEAN Result =
-                QuicLookupInsertLocalCid(
+            if (!QuicLookupInsertLocalCid(
                     LookupDest,
                     CxPlatHashSimple(CID->CID.Length, CID->CID.Data),
                     CID,
-                    TRUE);
-            CXPLAT_DBG_ASSERT(Result);
-            UNREFERENCED_PARAMETER(Result);
+                    TRUE)) {
+                //
+                // Out of memory. Leave the CID out of the new lookup, rather
+                // than have it look like it's in there.
+                //
+                CID->CID.IsInLookupTable = FALSE;
+            }
         }
         Entry = Entry->Next;
     }
+    Reclaimed = QuicLookupReclaim(LookupDest);
     CxPlatDispatchRwLockReleaseExclusive(&LookupDest->RwLock, PrevIrql2);
+    QuicLookupFreeRetired(Reclaimed);
 }
@@ -9,7 +9,9 @@
 extern "C" {
 #endif
 
-typedef struct QUIC_PARTITIONED_HASHTABLE QUIC_PARTITIONED_HASHTABLE;
+typedef struct QUIC_LOOKUP_PARTITIONS QUIC_LOOKUP_PARTITIONS;
+typedef struct QUIC_LOOKUP_RETIRED QUIC_LOOKUP_RETIRED;
+typedef struct QUIC_LOOKUP_READER_COUNT QUIC_LOOKUP_READER_COUNT;
 
 typedef struct QUIC_REMOTE_HASH_ENTRY {
 
@@ -51,22 +53,44 @@ typedef struct QUIC_LOOKUP {
     //
     // Local CID lookup.
     //
-    union {
-        void* LookupTable;
-        struct {
-            //
-            // Single client connection is bound.
-            //
-            QUIC_CONNECTION* Connection;
-        } SINGLE;
-        struct {
-            //
-            // Set of partitioned hash tables.
-            //
-            _Field_size_bytes_(PartitionCount * sizeof(QUIC_PARTITIONED_HASHTABLE))
-            QUIC_PARTITIONED_HASHTABLE* Tables;
-        } HASH;
-    };
+    struct {
+        //
+        // Single client connection is bound.
+        //
+        QUIC_CONNECTION* Connection;
+    } SINGLE;
+    struct {
+        //
+        // Set of partitioned hash tables. Read without holding any lock (see
+        // QuicLookupFindConnectionByLocalCid), so only ever replaced as a
+        // whole.
+        //
+        QUIC_LOOKUP_PARTITIONS* volatile Partitions;
+    } HASH;
+
+    //
+    // Per-processor counts of the lock-free readers of the partitioned hash
+    // tables, for each of the two reader epochs.
+    //
+    QUIC_LOOKUP_READER_COUNT* volatile ReaderCounts;
+
+    //
+    // Incremented each time the reader epoch flips. The low bit is the reader
+    // epoch (0 or 1) that new readers are counted in.
+    //
+    volatile long ReaderEpoch;
+
+    //
+    // Set while anything is retired, so that the last reader out frees it.
+    //
+    volatile long ReclaimPending;
+
+    //
+    // Memory removed from the partitioned hash tables that lock-free readers
+    // might still be looking at, by the reader epoch it was removed in. It's
+    // only freed once all the readers counted in that epoch are gone.
+    //
+    QUIC_LOOKUP_RETIRED* Retired[2];
 
     //
     // Remote Hash lookup.
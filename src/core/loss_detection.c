@@ -98,6 +98,8 @@ QuicLossValidate(
     QUIC_SENT_PACKET_METADATA** Tail = &LossDetection->SentPackets;
     while (*Tail) {
         CXPLAT_DBG_ASSERT(!(*Tail)->Flags.Freed);
+        CXPLAT_DBG_ASSERT(!(*Tail)->Flags.IsLost);
+        CXPLAT_DBG_ASSERT((*Tail)->PrevNext == Tail);
         if ((*Tail)->Flags.IsAckEliciting) {
             AckElicitingPackets++;
         }
@@ -109,6 +111,8 @@ QuicLossValidate(
     Tail = &LossDetection->LostPackets;
     while (*Tail) {
         CXPLAT_DBG_ASSERT(!(*Tail)->Flags.Freed);
+        CXPLAT_DBG_ASSERT((*Tail)->Flags.IsLost);
+        CXPLAT_DBG_ASSERT((*Tail)->PrevNext == Tail);
         Tail = &((*Tail)->Next);
     }
     CXPLAT_DBG_ASSERT(Tail == LossDetection->LostPacketsTail);
@@ -117,6 +121,40 @@ QuicLossValidate(
 #define QuicLossValidate(LossDetection)
 #endif
 
+//
+// Appends a packet to the end of the sent or lost packets list.
+//
+QUIC_INLINE
+void
+QuicLossDetectionAppendPacket(
+    _Inout_ QUIC_SENT_PACKET_METADATA*** Tail,
+    _In_ QUIC_SENT_PACKET_METADATA* Packet
+    )
+{
+    Packet->Next = NULL;
+    Packet->PrevNext = *Tail;
+    **Tail = Packet;
+    *Tail = &Packet->Next;
+}
+
+//
+// Removes a packet from the sent or lost packets list it is in.
+//
+QUIC_INLINE
+void
+QuicLossDetectionUnlinkPacket(
+    _Inout_ QUIC_SENT_PACKET_METADATA*** Tail,
+    _In_ QUIC_SENT_PACKET_METADATA* Packet
+    )
+{
+    *Packet->PrevNext = Packet->Next;
+    if (Packet->Next != NULL) {
+        Packet->Next->PrevNext = Packet->PrevNext;
+    } else {
+        *Tail = Packet->PrevNext;
+    }
+}
+
 _IRQL_requires_max_(PASSIVE_LEVEL)
 void
 QuicLossDetectionInitialize(
@@ -127,6 +165,7 @@ QuicLossDetectionInitialize(
     LossDetection->SentPacketsTail = &LossDetection->SentPackets;
     LossDetection->LostPackets = NULL;
     LossDetection->LostPacketsTail = &LossDetection->LostPackets;
+    QuicSentPacketRingInitialize(&LossDetection->SentPacketRing);
     QuicLossDetectionInitializeInternalState(LossDetection);
 }
 
@@ -165,6 +204,8 @@ QuicLossDetectionUninitialize(
 
         QuicLossDetectionOnPacketDiscarded(LossDetection, Packet, FALSE);
     }
+
+    QuicSentPacketRingUninitialize(&LossDetection->SentPacketRing);
 }
 
 _IRQL_requires_max_(PASSIVE_LEVEL)
@@ -395,8 +436,10 @@ QuicLossDetectionOnPacketSent(
     // Allocate a copy of the packet metadata.
     //
     QUIC_SENT_PACKET_METADATA* SentPacket =
-        QuicSentPacketPoolGetPacketMetadata(
+        QuicSentPacketRingGetPacketMetadata(
+            &LossDetection->SentPacketRing,
             &Connection->Partition->SentPacketPool,
+            TempSentPacket->PacketNumber,
             TempSentPacket->FrameCount);
     if (SentPacket == NULL) {
         //
@@ -424,9 +467,8 @@ QuicLossDetectionOnPacketSent(
     //
     // Add to the outstanding-packet queue.
     //
-    SentPacket->Next = NULL;
-    *LossDetection->SentPacketsTail = SentPacket;
-    LossDetection->SentPacketsTail = &SentPacket->Next;
+    SentPacket->Flags.IsLost = FALSE;
+    QuicLossDetectionAppendPacket(&LossDetection->SentPacketsTail, SentPacket);
 
     CXPLAT_DBG_ASSERT(
         SentPacket->Flags.KeyType != QUIC_PACKET_KEY_0_RTT ||
@@ -949,12 +991,9 @@ QuicLossDetectionDetectAndHandleLostPackets(
                 "[%c][TX][%llu] Forgetting",
                 PtkConnPre(Connection),
                 Packet->PacketNumber);
-            LossDetection->LostPackets = Packet->Next;
+            QuicLossDetectionUnlinkPacket(&LossDetection->LostPacketsTail, Packet);
             QuicLossDetectionOnPacketDiscarded(LossDetection, Packet, TRUE);
         }
-        if (LossDetection->LostPackets == NULL) {
-            LossDetection->LostPacketsTail = &LossDetection->LostPackets;
-        }
 
         QuicLossValidate(LossDetection);
     }
@@ -972,7 +1011,6 @@ QuicLossDetectionDetectAndHandleLostPackets(
         uint64_t Rtt = CXPLAT_MAX(Path->SmoothedRtt, Path->LatestRttSample);
         uint64_t TimeReorderThreshold = QUIC_TIME_REORDER_THRESHOLD(Rtt);
         uint64_t LargestLostPacketNumber = 0;
-        QUIC_SENT_PACKET_METADATA* PrevPacket = NULL;
         Packet = LossDetection->SentPackets;
         while (Packet != NULL) {
 
@@ -983,7 +1021,6 @@ QuicLossDetectionDetectAndHandleLostPackets(
                 QuicKeyTypeToEncryptLevel(Packet->Flags.KeyType);
 
             if (EncryptLevel > LossDetection->LargestAckEncryptLevel) {
-                PrevPacket = Packet;
                 Packet = Packet->Next;
                 continue;
             }
@@ -1035,22 +1072,11 @@ QuicLossDetectionDetectAndHandleLostPackets(
             }
 
             LargestLostPacketNumber = Packet->PacketNumber;
-            if (PrevPacket == NULL) {
-                LossDetection->SentPackets = Packet->Next;
-                if (Packet->Next == NULL) {
-                    LossDetection->SentPacketsTail = &LossDetection->SentPackets;
-                }
-            } else {
-                PrevPacket->Next = Packet->Next;
-                if (Packet->Next == NULL) {
-                    LossDetection->SentPacketsTail = &PrevPacket->Next;
-                }
-            }
-
-            *LossDetection->LostPacketsTail = Packet;
-            LossDetection->LostPacketsTail = &Packet->Next;
-            Packet = Packet->Next;
-            *LossDetection->LostPacketsTail = NULL;
+            QUIC_SENT_PACKET_METADATA* NextPacket = Packet->Next;
+            QuicLossDetectionUnlinkPacket(&LossDetection->SentPacketsTail, Packet);
+            Packet->Flags.IsLost = TRUE;
+            QuicLossDetectionAppendPacket(&LossDetection->LostPacketsTail, Packet);
+            Packet = NextPacket;
         }
 
         QuicLossValidate(LossDetection);
@@ -1094,7 +1120,6 @@ QuicLossDetectionDiscardPackets(
 {
     QUIC_CONNECTION* Connection = QuicLossDetectionGetConnection(LossDetection);
     QUIC_ENCRYPT_LEVEL EncryptLevel = QuicKeyTypeToEncryptLevel(KeyType);
-    QUIC_SENT_PACKET_METADATA* PrevPacket;
     QUIC_SENT_PACKET_METADATA* Packet;
     uint32_t AckedRetransmittableBytes = 0;
     uint64_t TimeNow = CxPlatTimeUs64();
@@ -1105,23 +1130,12 @@ QuicLossDetectionDiscardPackets(
     // Implicitly ACK all outstanding packets.
     //
 
-    PrevPacket = NULL;
     Packet = LossDetection->LostPackets;
     while (Packet != NULL) {
         QUIC_SENT_PACKET_METADATA* NextPacket = Packet->Next;
 
         if (Packet->Flags.KeyType == KeyType) {
-            if (PrevPacket != NULL) {
-                PrevPacket->Next = NextPacket;
-                if (NextPacket == NULL) {
-                    LossDetection->LostPacketsTail = &PrevPacket->Next;
-                }
-            } else {
-                LossDetection->LostPackets = NextPacket;
-                if (NextPacket == NULL) {
-                    LossDetection->LostPacketsTail = &LossDetection->LostPackets;
-                }
-            }
+            QuicLossDetectionUnlinkPacket(&LossDetection->LostPacketsTail, Packet);
 
             QuicTraceLogVerbose(
                 PacketTxAckedImplicit,
@@ -1139,33 +1153,18 @@ QuicLossDetectionDiscardPackets(
 
             QuicSentPacketPoolReturnPacketMetadata(Packet, Connection);
 
-            Packet = NextPacket;
-
-        } else {
-            PrevPacket = Packet;
-            Packet = NextPacket;
         }
+        Packet = NextPacket;
     }
 
     QuicLossValidate(LossDetection);
 
-    PrevPacket = NULL;
     Packet = LossDetection->SentPackets;
     while (Packet != NULL) {
         QUIC_SENT_PACKET_METADATA* NextPacket = Packet->Next;
 
         if (Packet->Flags.KeyType == KeyType) {
-            if (PrevPacket != NULL) {
-                PrevPacket->Next = NextPacket;
-                if (NextPacket == NULL) {
-                    LossDetection->SentPacketsTail = &PrevPacket->Next;
-                }
-            } else {
-                LossDetection->SentPackets = NextPacket;
-                if (NextPacket == NULL) {
-                    LossDetection->SentPacketsTail = &LossDetection->SentPackets;
-                }
-            }
+            QuicLossDetectionUnlinkPacket(&LossDetection->SentPacketsTail, Packet);
 
             QuicTraceLogVerbose(
                 PacketTxAckedImplicit,
@@ -1188,12 +1187,8 @@ QuicLossDetectionDiscardPackets(
 
             QuicSentPacketPoolReturnPacketMetadata(Packet, Connection);
 
-            Packet = NextPacket;
-
-        } else {
-            PrevPacket = Packet;
-            Packet = NextPacket;
         }
+        Packet = NextPacket;
     }
 
     QuicLossValidate(LossDetection);
@@ -1234,7 +1229,6 @@ QuicLossDetectionOnZeroRttRejected(
     )
 {
     QUIC_CONNECTION* Connection = QuicLossDetectionGetConnection(LossDetection);
-    QUIC_SENT_PACKET_METADATA* PrevPacket;
     QUIC_SENT_PACKET_METADATA* Packet;
     uint32_t CountRetransmittableBytes = 0;
 
@@ -1242,23 +1236,12 @@ QuicLossDetectionOnZeroRttRejected(
     // Marks all the packets as lost so they can be retransmitted immediately.
     //
 
-    PrevPacket = NULL;
     Packet = LossDetection->SentPackets;
     while (Packet != NULL) {
         QUIC_SENT_PACKET_METADATA* NextPacket = Packet->Next;
 
         if (Packet->Flags.KeyType == QUIC_PACKET_KEY_0_RTT) {
-            if (PrevPacket != NULL) {
-                PrevPacket->Next = NextPacket;
-                if (NextPacket == NULL) {
-                    LossDetection->SentPacketsTail = &PrevPacket->Next;
-                }
-            } else {
-                LossDetection->SentPackets = NextPacket;
-                if (NextPacket == NULL) {
-                    LossDetection->SentPacketsTail = &LossDetection->SentPackets;
-                }
-            }
+            QuicLossDetectionUnlinkPacket(&LossDetection->SentPacketsTail, Packet);
 
             QuicTraceLogVerbose(
                 PacketTx0RttRejected,
@@ -1273,12 +1256,8 @@ QuicLossDetectionOnZeroRttRejected(
 
             QuicLossDetectionRetransmitFrames(LossDetection, Packet, TRUE);
 
-            Packet = NextPacket;
-
-        } else {
-            PrevPacket = Packet;
-            Packet = NextPacket;
         }
+        Packet = NextPacket;
     }
 
     QuicLossValidate(LossDetection);
@@ -1295,6 +1274,73 @@ QuicLossDetectionOnZeroRttRejected(
     }
 }
 
+//
+// Moves a packet acknowledged by an ACK block from the sent or lost packets
+// list to the end of the list of acknowledged packets.
+//
+QUIC_INLINE
+void
+QuicLossDetectionTakeAckedPacket(
+    _In_ QUIC_LOSS_DETECTION* LossDetection,
+    _In_ QUIC_SENT_PACKET_METADATA* Packet,
+    _Inout_ QUIC_SENT_PACKET_METADATA*** AckedPacketsTail,
+    _Inout_ uint32_t* AckedRetransmittableBytes,
+    _Inout_ QUIC_SENT_PACKET_METADATA** LargestAckedPacket
+    )
+{
+    QUIC_CONNECTION* Connection = QuicLossDetectionGetConnection(LossDetection);
+
+    if (Packet->Flags.IsLost) {
+        //
+        // We mistakenly classified this packet as lost.
+        //
+        QuicTraceLogVerbose(
+            PacketTxSpuriousLoss,
+            "[%c][TX][%llu] Spurious loss detected",
+            PtkConnPre(Connection),
+            Packet->PacketNumber);
+        Connection->Stats.Send.SpuriousLostPackets++;
+        QuicPerfCounterDecrement(
+            Connection->Partition, QUIC_PERF_COUNTER_PKTS_SUSPECTED_LOST);
+        //
+        // NOTE: we don't increment AckedRetransmittableBytes here
+        // because we already told the congestion control module that
+        // this packet left the network.
+        //
+        QuicLossDetectionUnlinkPacket(&LossDetection->LostPacketsTail, Packet);
+
+    } else {
+        if (Packet->Flags.IsAckEliciting) {
+            LossDetection->PacketsInFlight--;
+            *AckedRetransmittableBytes += Packet->PacketLength;
+        }
+        *LargestAckedPacket = Packet;
+        QuicLossDetectionUnlinkPacket(&LossDetection->SentPacketsTail, Packet);
+    }
+
+    Packet->Next = NULL;
+    **AckedPacketsTail = Packet;
+    *AckedPacketsTail = &Packet->Next;
+}
+
+//
+// Returns the metadata of the packets an ACK frame took out of the sent and
+// lost packets lists.
+//
+QUIC_INLINE
+void
+QuicLossDetectionReleaseAckedPackets(
+    _In_ QUIC_CONNECTION* Connection,
+    _In_opt_ QUIC_SENT_PACKET_METADATA* AckedPackets
+    )
+{
+    while (AckedPackets != NULL) {
+        QUIC_SENT_PACKET_METADATA* PacketMeta = AckedPackets;
+        AckedPackets = AckedPackets->Next;
+        QuicSentPacketPoolReturnPacketMetadata(PacketMeta, Connection);
+    }
+}
+
 _IRQL_requires_max_(PASSIVE_LEVEL)
 void
 QuicLossDetectionProcessAckBlocks(
@@ -1314,6 +1360,7 @@ QuicLossDetectionProcessAckBlocks(
     uint32_t AckedRetransmittableBytes = 0;
     QUIC_CONNECTION* Connection = QuicLossDetectionGetConnection(LossDetection);
     uint64_t TimeNow = CxPlatTimeUs64();
+    const uint64_t AckRecvTime = QuicPacketGetRecvTime(Packet, TimeNow);
     uint64_t MinRtt = UINT64_MAX;
     BOOLEAN NewLargestAck = FALSE;
     BOOLEAN NewLargestAckRetransmittable = FALSE;
@@ -1329,117 +1376,97 @@ QuicLossDetectionProcessAckBlocks(
     uint32_t i = 0;
     QUIC_SUBRANGE* AckBlock;
     while ((AckBlock = QuicRangeGetSafe(AckBlocks, i++)) != NULL) {
+        const uint64_t AckBlockHigh = QuicRangeGetHigh(AckBlock);
+
         //
         // ATTACK DETECTION: Check if the skipped packet number is in this ACK
         // block. If so, this indicates a potential injection attack.
         //
         if (Connection->Send.SkippedPacketNumber >= AckBlock->Low &&
-            Connection->Send.SkippedPacketNumber <= QuicRangeGetHigh(AckBlock)) {
+            Connection->Send.SkippedPacketNumber <= AckBlockHigh) {
             QuicTraceLogConnError(
                 AttackDetected,
                 Connection,
                 "Attack detected: Skipped packet number %llu ACKed in range [%llu, %llu]",
                 Connection->Send.SkippedPacketNumber,
                 AckBlock->Low,
-                QuicRangeGetHigh(AckBlock));
+                AckBlockHigh);
             QuicConnTransportError(Connection, QUIC_ERROR_PROTOCOL_VIOLATION);
+            QuicLossDetectionReleaseAckedPackets(Connection, AckedPackets);
             return;
         }
 
-        //
-        // Check to see if any packets in the LostPackets list are acknowledged,
-        // which would mean we mistakenly classified those packets as lost.
-        //
-        if (*LostPacketsStart != NULL) {
-            QUIC_SENT_PACKET_METADATA* LastLostPacket =
-                CXPLAT_CONTAINING_RECORD(
-                    LossDetection->LostPacketsTail, QUIC_SENT_PACKET_METADATA,
-                    Next);
-            if (LastLostPacket->PacketNumber < AckBlock->Low) {
-                goto CheckSentPackets;
-            }
-            while (*LostPacketsStart && (*LostPacketsStart)->PacketNumber < AckBlock->Low) {
-                LostPacketsStart = &((*LostPacketsStart)->Next);
-            }
+        const BOOLEAN HadLostPackets = LossDetection->LostPackets != NULL;
 
-            QUIC_SENT_PACKET_METADATA** End = LostPacketsStart;
-            while (*End && (*End)->PacketNumber <= QuicRangeGetHigh(AckBlock)) {
-                QuicTraceLogVerbose(
-                    PacketTxSpuriousLoss,
-                    "[%c][TX][%llu] Spurious loss detected",
-                    PtkConnPre(Connection),
-                    (*End)->PacketNumber);
-                Connection->Stats.Send.SpuriousLostPackets++;
-                QuicPerfCounterDecrement(
-                    Connection->Partition, QUIC_PERF_COUNTER_PKTS_SUSPECTED_LOST);
-                //
-                // NOTE: we don't increment AckedRetransmittableBytes here
-                // because we already told the congestion control module that
-                // this packet left the network.
-                //
-                End = &((*End)->Next);
+        if (QuicSentPacketRingIsComplete(&LossDetection->SentPacketRing)) {
+            //
+            // Look up the acknowledged packets, lost or not, directly by packet
+            // number.
+            //
+            uint64_t PacketNumber = AckBlock->Low;
+            QUIC_SENT_PACKET_METADATA* AckedPacket;
+            while ((AckedPacket =
+                    QuicSentPacketRingGetNext(
+                        &LossDetection->SentPacketRing,
+                        &PacketNumber,
+                        AckBlockHigh)) != NULL) {
+                QuicLossDetectionTakeAckedPacket(
+                    LossDetection,
+                    AckedPacket,
+                    &AckedPacketsTail,
+                    &AckedRetransmittableBytes,
+                    &LargestAckedPacket);
             }
 
-            if (LostPacketsStart != End) {
-                *AckedPacketsTail = *LostPacketsStart;
-                AckedPacketsTail = End;
-                *LostPacketsStart = *End;
-                *End = NULL;
-                if (End == LossDetection->LostPacketsTail) {
-                    LossDetection->LostPacketsTail = LostPacketsStart;
-                }
-
-                QuicLossValidate(LossDetection);
+        } else {
+            //
+            // Some packets aren't in the ring, so find the acknowledged ones
+            // in the lost and sent packets lists instead. Both lists are in
+            // packet number order, as are the ACK blocks, so neither list is
+            // walked more than once per ACK frame.
+            //
+            while (*LostPacketsStart != NULL &&
+                   (*LostPacketsStart)->PacketNumber < AckBlock->Low) {
+                LostPacketsStart = &((*LostPacketsStart)->Next);
             }
-
-            if (LossDetection->LostPackets == NULL) {
-                //
-                // All previously considered lost packets were found to be
-                // spuriously lost. Inform congestion control.
-                //
-                if (QuicCongestionControlOnSpuriousCongestionEvent(
-                        &Connection->CongestionControl)) {
-                    //
-                    // We were previously blocked and are now unblocked.
-                    //
-                    QuicSendQueueFlush(&Connection->Send, REASON_CONGESTION_CONTROL);
-                }
+            while (*LostPacketsStart != NULL &&
+                   (*LostPacketsStart)->PacketNumber <= AckBlockHigh) {
+                QuicLossDetectionTakeAckedPacket(
+                    LossDetection,
+                    *LostPacketsStart,
+                    &AckedPacketsTail,
+                    &AckedRetransmittableBytes,
+                    &LargestAckedPacket);
             }
-        }
 
-CheckSentPackets:
-        //
-        // Now find all the acknowledged packets in the SentPackets list.
-        //
-        if (*SentPacketsStart != NULL) {
-            while (*SentPacketsStart && (*SentPacketsStart)->PacketNumber < AckBlock->Low) {
+            while (*SentPacketsStart != NULL &&
+                   (*SentPacketsStart)->PacketNumber < AckBlock->Low) {
                 SentPacketsStart = &((*SentPacketsStart)->Next);
             }
-
-            QUIC_SENT_PACKET_METADATA** End = SentPacketsStart;
-            while (*End && (*End)->PacketNumber <= QuicRangeGetHigh(AckBlock)) {
-
-                if ((*End)->Flags.IsAckEliciting) {
-                    LossDetection->PacketsInFlight--;
-                    AckedRetransmittableBytes += (*End)->PacketLength;
-                }
-                LargestAckedPacket = *End;
-                End = &((*End)->Next);
+            while (*SentPacketsStart != NULL &&
+                   (*SentPacketsStart)->PacketNumber <= AckBlockHigh) {
+                QuicLossDetectionTakeAckedPacket(
+                    LossDetection,
+                    *SentPacketsStart,
+                    &AckedPacketsTail,
+                    &AckedRetransmittableBytes,
+                    &LargestAckedPacket);
             }
+        }
 
-            if (SentPacketsStart != End) {
+        QuicLossValidate(LossDetection);
+
+        if (HadLostPackets && LossDetection->LostPackets == NULL) {
+            //
+            // All previously considered lost packets were found to be
+            // spuriously lost. Inform congestion control.
+            //
+            if (QuicCongestionControlOnSpuriousCongestionEvent(
+                    &Connection->CongestionControl)) {
                 //
-                // Remove the ACKed packets from the outstanding packet list.
+                // We were previously blocked and are now unblocked.
                 //
-                *AckedPacketsTail = *SentPacketsStart;
-                AckedPacketsTail = End;
-                *SentPacketsStart = *End;
-                *End = NULL;
-                if (End == LossDetection->SentPacketsTail) {
-                    LossDetection->SentPacketsTail = SentPacketsStart;
-                }
-
-                QuicLossValidate(LossDetection);
+                QuicSendQueueFlush(&Connection->Send, REASON_CONGESTION_CONTROL);
             }
         }
 
@@ -1483,10 +1510,19 @@ CheckSentPackets:
                 Connection,
                 "Incorrect ACK encryption level");
             *InvalidAckBlock = TRUE;
+            QuicLossDetectionReleaseAckedPackets(Connection, AckedPackets);
             return;
         }
 
-        uint64_t PacketRtt = CxPlatTimeDiff64(PacketMeta->SentTime, TimeNow);
+        //
+        // Sample the RTT up to when the platform received the ACK, so that time
+        // spent queued locally before processing isn't counted as path delay.
+        //
+        uint64_t PacketRtt =
+            CxPlatTimeDiff64(
+                PacketMeta->SentTime,
+                CxPlatTimeAtOrBefore64(PacketMeta->SentTime, AckRecvTime) ?
+                    AckRecvTime : TimeNow);
         QuicTraceLogVerbose(
             PacketTxAcked,
             "[%c][TX][%llu] ACKed (%u.%03u ms)",
@@ -1641,12 +1677,7 @@ CheckSentPackets:
 
     LossDetection->ProbeCount = 0;
 
-    AckedPacketsIterator = AckedPackets;
-    while (AckedPacketsIterator != NULL) {
-        QUIC_SENT_PACKET_METADATA* PacketMeta = AckedPacketsIterator;
-        AckedPacketsIterator = AckedPacketsIterator->Next;
-        QuicSentPacketPoolReturnPacketMetadata(PacketMeta, Connection);
-    }
+    QuicLossDetectionReleaseAckedPackets(Connection, AckedPackets);
 
     //
     // At least one packet was ACKed. If all packets were ACKed then we'll
@@ -1708,6 +1739,7 @@ QuicLossDetectionProcessAckFrame(
 
             AckDelay <<= Connection->PeerTransportParams.AckDelayExponent;
 
+            const uint64_t ProcessingStart = CxPlatTimeUs64();
             QuicLossDetectionProcessAckBlocks(
                 LossDetection,
                 Path,
@@ -1717,6 +1749,13 @@ QuicLossDetectionProcessAckFrame(
                 &Connection->DecodedAckRanges,
                 InvalidFrame,
                 FrameType == QUIC_FRAME_ACK_1 ? &Ecn : NULL);
+
+            const uint64_t ProcessingTime =
+                CxPlatTimeDiff64(ProcessingStart, CxPlatTimeUs64());
+            Connection->Stats.Recv.AckProcessingTime += ProcessingTime;
+            if (ProcessingTime > Connection->Stats.Recv.MaxAckProcessingTime) {
+                Connection->Stats.Recv.MaxAckProcessingTime = ProcessingTime;
+            }
         }
     }
 
@@ -5,6 +5,10 @@
 
 --*/
 
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
 typedef struct QUIC_LOSS_DETECTION {
 
     //
@@ -82,6 +86,12 @@ typedef struct QUIC_LOSS_DETECTION {
     QUIC_SENT_PACKET_METADATA* LostPackets;
     QUIC_SENT_PACKET_METADATA** LostPacketsTail;
 
+    //
+    // The packets in the lists above, by packet number. Also the storage for
+    // the metadata of most of them.
+    //
+    QUIC_SENT_PACKET_RING SentPacketRing;
+
     //
     // Number of probes sent.
     //
@@ -187,3 +197,7 @@ void
 QuicLossDetectionProcessTimerOperation(
     _In_ QUIC_LOSS_DETECTION* LossDetection
     );
+
+#if defined(__cplusplus)
+}
+#endif
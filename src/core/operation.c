@@ -20,6 +20,14 @@ Abstract:
     is the only thread that touches the connection itself, which simplifies
     synchronization.
 
+    The queue is lock-free. Producers push onto an intrusive stack (the
+    inbox) with a compare-exchange, and the consumer takes the whole stack
+    with one exchange, reverses it back into arrival order and merges it
+    into its private list, where priority and front insertion are applied.
+    The inbox pointer also carries the queue's scheduling state, so the
+    producer that makes an idle queue non-empty is the one told to start
+    processing it.
+
 --*/
 
 #include "precomp.h"
@@ -33,8 +41,7 @@ QuicOperationQueueInitialize(
     _Inout_ QUIC_OPERATION_QUEUE* OperQ
     )
 {
-    OperQ->ActivelyProcessing = FALSE;
-    CxPlatDispatchLockInitialize(&OperQ->Lock);
+    OperQ->Inbox = NULL;
     CxPlatListInitializeHead(&OperQ->List);
     OperQ->PriorityTail = &OperQ->List.Flink;
 }
@@ -46,9 +53,9 @@ QuicOperationQueueUninitialize(
     )
 {
     UNREFERENCED_PARAMETER(OperQ);
+    CXPLAT_DBG_ASSERT(OperQ->Inbox == NULL);
     CXPLAT_DBG_ASSERT(CxPlatListIsEmpty(&OperQ->List));
     CXPLAT_DBG_ASSERT(OperQ->PriorityTail == &OperQ->List.Flink);
-    CxPlatDispatchLockUninitialize(&OperQ->Lock);
 }
 
 _IRQL_requires_max_(DISPATCH_LEVEL)
@@ -129,6 +136,13 @@ QuicOperationFree(
                     QUIC_POOL_RECVBUF);
             }
             QuicStreamRelease(ApiCtx->STRM_PROVIDE_RECV_BUFFERS.Stream, QUIC_STREAM_REF_OPERATION);
+        } else if (ApiCtx->Type == QUIC_API_TYPE_STRM_SEND_BATCH) {
+            for (uint32_t i = 0; i < ApiCtx->STRM_SEND_BATCH.StreamCount; ++i) {
+                QuicStreamRelease(ApiCtx->STRM_SEND_BATCH.Streams[i], QUIC_STREAM_REF_OPERATION);
+            }
+            if (ApiCtx->STRM_SEND_BATCH.Streams != NULL) {
+                CXPLAT_FREE(ApiCtx->STRM_SEND_BATCH.Streams, QUIC_POOL_SEND_BATCH);
+            }
         }
         CxPlatPoolFree(ApiCtx);
     } else if (Oper->Type == QUIC_OPER_TYPE_FLUSH_STREAM_RECV) {
@@ -141,25 +155,124 @@ QuicOperationFree(
     CxPlatPoolFree(Oper);
 }
 
+//
+// Pushes an operation onto the inbox. Returns TRUE if the queue was idle.
+//
 _IRQL_requires_max_(DISPATCH_LEVEL)
+static
 BOOLEAN
-QuicOperationEnqueue(
+QuicOperationQueuePush(
     _In_ QUIC_OPERATION_QUEUE* OperQ,
     _In_ QUIC_PARTITION* Partition,
-    _In_ QUIC_OPERATION* Oper
+    _In_ QUIC_OPERATION* Oper,
+    _In_ QUIC_OPERATION_QUEUE_POSITION Position
     )
 {
-    BOOLEAN StartProcessing;
-    CxPlatDispatchLockAcquire(&OperQ->Lock);
 #if DEBUG
     CXPLAT_DBG_ASSERT(Oper->Link.Flink == NULL);
 #endif
-    StartProcessing = CxPlatListIsEmpty(&OperQ->List) && !OperQ->ActivelyProcessing;
-    CxPlatListInsertTail(&OperQ->List, &Oper->Link);
-    CxPlatDispatchLockRelease(&OperQ->Lock);
+    Oper->QueuePosition = (uint8_t)Position;
+
+    CXPLAT_LIST_ENTRY* Head;
+    do {
+        Head = (CXPLAT_LIST_ENTRY*)QuicReadPtrNoFence((void* volatile*)&OperQ->Inbox);
+        Oper->Link.Flink = Head;
+    } while (InterlockedCompareExchangePointer(
+                (void* volatile*)&OperQ->Inbox, &Oper->Link, Head) != Head);
+
     QuicPerfCounterAdd(Partition, QUIC_PERF_COUNTER_CONN_OPER_QUEUED, 1);
     QuicPerfCounterAdd(Partition, QUIC_PERF_COUNTER_CONN_OPER_QUEUE_DEPTH, 1);
-    return StartProcessing;
+    return Head == NULL;
+}
+
+//
+// Moves a chain taken from the inbox into the consumer's list.
+//
+_IRQL_requires_max_(DISPATCH_LEVEL)
+static
+void
+QuicOperationQueueSplice(
+    _In_ QUIC_OPERATION_QUEUE* OperQ,
+    _In_opt_ CXPLAT_LIST_ENTRY* Head
+    )
+{
+    //
+    // The inbox is newest first. Reverse it so operations are placed in the
+    // order they were enqueued.
+    //
+    CXPLAT_LIST_ENTRY* Fifo = NULL;
+    while (Head != NULL && Head != QUIC_OPER_QUEUE_ACTIVE) {
+        CXPLAT_LIST_ENTRY* Next = Head->Flink;
+        Head->Flink = Fifo;
+        Fifo = Head;
+        Head = Next;
+    }
+
+    while (Fifo != NULL) {
+        CXPLAT_LIST_ENTRY* Entry = Fifo;
+        Fifo = Fifo->Flink;
+        const QUIC_OPERATION* Oper =
+            CXPLAT_CONTAINING_RECORD(Entry, QUIC_OPERATION, Link);
+        switch (Oper->QueuePosition) {
+        case QUIC_OPER_QUEUE_POSITION_PRIORITY:
+            CxPlatListInsertTail(*OperQ->PriorityTail, Entry);
+            OperQ->PriorityTail = &Entry->Flink;
+            break;
+        case QUIC_OPER_QUEUE_POSITION_FRONT:
+            CxPlatListInsertHead(&OperQ->List, Entry);
+            if (OperQ->PriorityTail == &OperQ->List.Flink) {
+                OperQ->PriorityTail = &Entry->Flink;
+            }
+            break;
+        default:
+            CxPlatListInsertTail(&OperQ->List, Entry);
+            break;
+        }
+    }
+}
+
+//
+// Takes everything in the inbox, leaving the queue marked active.
+//
+_IRQL_requires_max_(DISPATCH_LEVEL)
+static
+void
+QuicOperationQueueFlushInbox(
+    _In_ QUIC_OPERATION_QUEUE* OperQ
+    )
+{
+    CXPLAT_LIST_ENTRY* Head =
+        (CXPLAT_LIST_ENTRY*)QuicReadPtrNoFence((void* volatile*)&OperQ->Inbox);
+    if (Head == NULL || Head == QUIC_OPER_QUEUE_ACTIVE) {
+        return;
+    }
+    Head =
+        (CXPLAT_LIST_ENTRY*)InterlockedExchangePointer(
+            (void* volatile*)&OperQ->Inbox, QUIC_OPER_QUEUE_ACTIVE);
+    QuicOperationQueueSplice(OperQ, Head);
+}
+
+_IRQL_requires_max_(DISPATCH_LEVEL)
+BOOLEAN
+QuicOperationHasPriority(
+    _In_ QUIC_OPERATION_QUEUE* OperQ
+    )
+{
+    QuicOperationQueueFlushInbox(OperQ);
+    return &OperQ->List.Flink != OperQ->PriorityTail;
+}
+
+_IRQL_requires_max_(DISPATCH_LEVEL)
+BOOLEAN
+QuicOperationEnqueue(
+    _In_ QUIC_OPERATION_QUEUE* OperQ,
+    _In_ QUIC_PARTITION* Partition,
+    _In_ QUIC_OPERATION* Oper
+    )
+{
+    return
+        QuicOperationQueuePush(
+            OperQ, Partition, Oper, QUIC_OPER_QUEUE_POSITION_TAIL);
 }
 
 _IRQL_requires_max_(DISPATCH_LEVEL)
@@ -170,18 +283,9 @@ QuicOperationEnqueuePriority(
     _In_ QUIC_OPERATION* Oper
     )
 {
-    BOOLEAN StartProcessing;
-    CxPlatDispatchLockAcquire(&OperQ->Lock);
-#if DEBUG
-    CXPLAT_DBG_ASSERT(Oper->Link.Flink == NULL);
-#endif
-    StartProcessing = CxPlatListIsEmpty(&OperQ->List) && !OperQ->ActivelyProcessing;
-    CxPlatListInsertTail(*OperQ->PriorityTail, &Oper->Link);
-    OperQ->PriorityTail = &Oper->Link.Flink;
-    CxPlatDispatchLockRelease(&OperQ->Lock);
-    QuicPerfCounterAdd(Partition, QUIC_PERF_COUNTER_CONN_OPER_QUEUED, 1);
-    QuicPerfCounterAdd(Partition, QUIC_PERF_COUNTER_CONN_OPER_QUEUE_DEPTH, 1);
-    return StartProcessing;
+    return
+        QuicOperationQueuePush(
+            OperQ, Partition, Oper, QUIC_OPER_QUEUE_POSITION_PRIORITY);
 }
 
 _IRQL_requires_max_(DISPATCH_LEVEL)
@@ -192,20 +296,9 @@ QuicOperationEnqueueFront(
     _In_ QUIC_OPERATION* Oper
     )
 {
-    BOOLEAN StartProcessing;
-    CxPlatDispatchLockAcquire(&OperQ->Lock);
-#if DEBUG
-    CXPLAT_DBG_ASSERT(Oper->Link.Flink == NULL);
-#endif
-    StartProcessing = CxPlatListIsEmpty(&OperQ->List) && !OperQ->ActivelyProcessing;
-    CxPlatListInsertHead(&OperQ->List, &Oper->Link);
-    if (OperQ->PriorityTail == &OperQ->List.Flink) {
-        OperQ->PriorityTail = &Oper->Link.Flink;
-    }
-    CxPlatDispatchLockRelease(&OperQ->Lock);
-    QuicPerfCounterAdd(Partition, QUIC_PERF_COUNTER_CONN_OPER_QUEUED, 1);
-    QuicPerfCounterAdd(Partition, QUIC_PERF_COUNTER_CONN_OPER_QUEUE_DEPTH, 1);
-    return StartProcessing;
+    return
+        QuicOperationQueuePush(
+            OperQ, Partition, Oper, QUIC_OPER_QUEUE_POSITION_FRONT);
 }
 
 _IRQL_requires_max_(DISPATCH_LEVEL)
@@ -215,31 +308,60 @@ QuicOperationDequeue(
     _In_ QUIC_PARTITION* Partition
     )
 {
-    QUIC_OPERATION* Oper;
-    CxPlatDispatchLockAcquire(&OperQ->Lock);
-    if (CxPlatListIsEmpty(&OperQ->List)) {
-        OperQ->ActivelyProcessing = FALSE;
-        Oper = NULL;
-    } else {
-        OperQ->ActivelyProcessing = TRUE;
-        Oper =
-            CXPLAT_CONTAINING_RECORD(
-                CxPlatListRemoveHead(&OperQ->List), QUIC_OPERATION, Link);
-#if DEBUG
-        Oper->Link.Flink = NULL;
-#endif
-        if (OperQ->PriorityTail == &Oper->Link.Flink) {
-            OperQ->PriorityTail = &OperQ->List.Flink;
+    //
+    // Always look at the inbox first so newly queued priority operations
+    // jump ahead of normal ones already in the list.
+    //
+    QuicOperationQueueFlushInbox(OperQ);
+
+    while (CxPlatListIsEmpty(&OperQ->List)) {
+        //
+        // Nothing left. Go idle, unless a producer got in first.
+        //
+        CXPLAT_LIST_ENTRY* Head =
+            (CXPLAT_LIST_ENTRY*)InterlockedCompareExchangePointer(
+                (void* volatile*)&OperQ->Inbox, NULL, QUIC_OPER_QUEUE_ACTIVE);
+        if (Head == NULL || Head == QUIC_OPER_QUEUE_ACTIVE) {
+            return NULL;
         }
+        QuicOperationQueueFlushInbox(OperQ);
     }
-    CxPlatDispatchLockRelease(&OperQ->Lock);
 
-    if (Oper != NULL) {
-        QuicPerfCounterAdd(Partition, QUIC_PERF_COUNTER_CONN_OPER_QUEUE_DEPTH, -1);
+    QUIC_OPERATION* Oper =
+        CXPLAT_CONTAINING_RECORD(
+            CxPlatListRemoveHead(&OperQ->List), QUIC_OPERATION, Link);
+#if DEBUG
+    Oper->Link.Flink = NULL;
+#endif
+    if (OperQ->PriorityTail == &Oper->Link.Flink) {
+        OperQ->PriorityTail = &OperQ->List.Flink;
     }
+
+    QuicPerfCounterAdd(Partition, QUIC_PERF_COUNTER_CONN_OPER_QUEUE_DEPTH, -1);
     return Oper;
 }
 
+//
+// Cleans up after a queued stream send that will never be processed. A stream
+// that was never started has nothing else to complete its queued sends, so it
+// is aborted, which cancels them. Started streams complete them when they are
+// shut down along with the connection.
+//
+_IRQL_requires_max_(DISPATCH_LEVEL)
+static
+void
+QuicOperationClearStreamSend(
+    _In_ QUIC_STREAM* Stream
+    )
+{
+    if (!Stream->Flags.Started) {
+        QuicStreamShutdown(
+            Stream,
+            QUIC_STREAM_SHUTDOWN_FLAG_ABORT | QUIC_STREAM_SHUTDOWN_FLAG_IMMEDIATE,
+            0);
+    }
+}
+
 _IRQL_requires_max_(DISPATCH_LEVEL)
 void
 QuicOperationQueueClear(
@@ -250,11 +372,12 @@ QuicOperationQueueClear(
     CXPLAT_LIST_ENTRY OldList;
     CxPlatListInitializeHead(&OldList);
 
-    CxPlatDispatchLockAcquire(&OperQ->Lock);
-    OperQ->ActivelyProcessing = FALSE;
+    QuicOperationQueueSplice(
+        OperQ,
+        (CXPLAT_LIST_ENTRY*)InterlockedExchangePointer(
+            (void* volatile*)&OperQ->Inbox, NULL));
     CxPlatListMoveItems(&OperQ->List, &OldList);
     OperQ->PriorityTail = &OperQ->List.Flink;
-    CxPlatDispatchLockRelease(&OperQ->Lock);
 
     int64_t OperationsDequeued = 0;
 
@@ -278,12 +401,16 @@ QuicOperationQueueClear(
                             QUIC_STREAM_SHUTDOWN_FLAG_ABORT | QUIC_STREAM_SHUTDOWN_FLAG_IMMEDIATE,
                             0);
                     }
-                } else if (ApiCtx->Type == QUIC_API_TYPE_STRM_SEND &&
-                    !ApiCtx->STRM_START.Stream->Flags.Started) {
-                    QuicStreamShutdown(
-                        ApiCtx->STRM_START.Stream,
-                        QUIC_STREAM_SHUTDOWN_FLAG_ABORT | QUIC_STREAM_SHUTDOWN_FLAG_IMMEDIATE,
-                        0);
+                } else if (ApiCtx->Type == QUIC_API_TYPE_STRM_SEND) {
+                    QuicOperationClearStreamSend(ApiCtx->STRM_SEND.Stream);
+                } else if (ApiCtx->Type == QUIC_API_TYPE_STRM_SEND_BATCH) {
+                    //
+                    // A batch is cleared exactly as if each of its streams
+                    // had its own STRM_SEND operation queued.
+                    //
+                    for (uint32_t i = 0; i < ApiCtx->STRM_SEND_BATCH.StreamCount; ++i) {
+                        QuicOperationClearStreamSend(ApiCtx->STRM_SEND_BATCH.Streams[i]);
+                    }
                 }
             }
             QuicOperationFree(Oper);
@@ -64,6 +64,7 @@ typedef enum QUIC_API_TYPE {
     QUIC_API_TYPE_CONN_COMPLETE_RESUMPTION_TICKET_VALIDATION,
     QUIC_API_TYPE_CONN_COMPLETE_CERTIFICATE_VALIDATION,
     QUIC_API_TYPE_STRM_PROVIDE_RECV_BUFFERS,
+    QUIC_API_TYPE_STRM_SEND_BATCH,
 
 } QUIC_API_TYPE;
 
@@ -159,6 +160,10 @@ typedef struct QUIC_API_CONTEXT {
             QUIC_STREAM* Stream;
             CXPLAT_LIST_ENTRY /* QUIC_RECV_CHUNK */ Chunks;
         } STRM_PROVIDE_RECV_BUFFERS;
+        struct {
+            uint32_t StreamCount;
+            QUIC_STREAM** Streams; // Each holds a QUIC_STREAM_REF_OPERATION ref.
+        } STRM_SEND_BATCH;
 
         struct {
             HQUIC Handle;
@@ -218,6 +223,12 @@ typedef struct QUIC_OPERATION {
     //
     BOOLEAN FreeAfterProcess;
 
+    //
+    // Where the operation goes when the consumer moves it out of the queue's
+    // inbox (QUIC_OPERATION_QUEUE_POSITION).
+    //
+    uint8_t QueuePosition;
+
     union {
         struct {
             void* Reserved; // Nothing.
@@ -286,25 +297,51 @@ QuicOperLog(
     }
 }
 
+//
+// Where an enqueued operation is placed relative to those already queued.
+//
+typedef enum QUIC_OPERATION_QUEUE_POSITION {
+    QUIC_OPER_QUEUE_POSITION_TAIL,      // After all other operations.
+    QUIC_OPER_QUEUE_POSITION_PRIORITY,  // After other priority operations.
+    QUIC_OPER_QUEUE_POSITION_FRONT      // Before all other operations.
+} QUIC_OPERATION_QUEUE_POSITION;
+
+//
+// Inbox value for a queue that is being drained (or scheduled to be) but has
+// no operations waiting in the inbox.
+//
+#define QUIC_OPER_QUEUE_ACTIVE ((CXPLAT_LIST_ENTRY*)(size_t)1)
+
 //
 // A queue of operations to be executed for a connection.
 //
+// Producers never take a lock: they push onto the Inbox stack with a single
+// compare-exchange. The consumer (the worker draining the connection) moves
+// the inbox into List, in push order and honoring each operation's position,
+// before it looks at List. Only the consumer touches List and PriorityTail.
+//
 typedef struct QUIC_OPERATION_QUEUE {
 
     //
-    // TRUE if the queue is being drained.
+    // LIFO stack of newly enqueued operations, linked by Link.Flink and
+    // terminated by NULL or QUIC_OPER_QUEUE_ACTIVE. NULL means the queue is
+    // idle: empty and not being processed. The producer that pushes onto an
+    // idle queue is responsible for scheduling it.
     //
-    BOOLEAN ActivelyProcessing;
+    CXPLAT_LIST_ENTRY* volatile Inbox;
 
     //
-    // Queue of pending operations.
+    // Queue of pending operations, owned by the consumer.
     //
-    CXPLAT_DISPATCH_LOCK Lock;
     CXPLAT_LIST_ENTRY List;
     CXPLAT_LIST_ENTRY** PriorityTail; // Tail of the priority queue.
 
 } QUIC_OPERATION_QUEUE;
 
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
 //
 // Initializes an operation queue.
 //
@@ -343,20 +380,14 @@ QuicOperationFree(
     );
 
 //
-// Returns TRUE if the operation queue has priority operations queued.
+// Returns TRUE if the operation queue has priority operations queued. Must only
+// be called by the consumer.
 //
 _IRQL_requires_max_(DISPATCH_LEVEL)
-QUIC_INLINE
 BOOLEAN
 QuicOperationHasPriority(
     _In_ QUIC_OPERATION_QUEUE* OperQ
-    )
-{
-    CxPlatDispatchLockAcquire(&OperQ->Lock);
-    BOOLEAN HasPriorityWork = (&OperQ->List.Flink != OperQ->PriorityTail);
-    CxPlatDispatchLockRelease(&OperQ->Lock);
-    return HasPriorityWork;
-}
+    );
 
 //
 // Enqueues an operation. Returns TRUE if the queue was previously empty and not
@@ -396,7 +427,8 @@ QuicOperationEnqueueFront(
     );
 
 //
-// Dequeues an operation. Returns NULL if the queue is empty.
+// Dequeues an operation. Returns NULL if the queue is empty, in which case the
+// queue goes idle. Must only be called by the consumer.
 //
 _IRQL_requires_max_(DISPATCH_LEVEL)
 QUIC_OPERATION*
@@ -414,3 +446,7 @@ QuicOperationQueueClear(
     _In_ QUIC_OPERATION_QUEUE* OperQ,
     _In_ QUIC_PARTITION* Partition
     );
+
+#if defined(__cplusplus)
+}
+#endif
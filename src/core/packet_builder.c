@@ -102,6 +102,7 @@ QuicPacketBuilderInitialize(
     Builder->PacketBatchSent = FALSE;
     Builder->PacketBatchRetransmittable = FALSE;
     Builder->WrittenConnectionCloseFrame = FALSE;
+    Builder->EncryptFromSources = FALSE;
     Builder->Metadata = &Builder->MetadataStorage.Metadata;
     Builder->EncryptionOverhead = CXPLAT_ENCRYPTION_OVERHEAD;
     Builder->TotalDatagramsLength = 0;
@@ -128,11 +129,37 @@ QuicPacketBuilderInitialize(
     } else {
         TimeSinceLastSend = 0;
     }
-    Builder->SendAllowance =
-        QuicCongestionControlGetSendAllowance(
-            &Connection->CongestionControl,
-            TimeSinceLastSend,
-            Connection->Send.LastFlushTimeValid);
+    Builder->PacingRate =
+        MsQuicLib.SendTxTimeInUse && Connection->Send.LastFlushTimeValid ?
+            QuicCongestionControlGetPacingRate(&Connection->CongestionControl) : 0;
+    if (Builder->PacingRate != 0) {
+        //
+        // The kernel holds each batch until its departure time, so instead of
+        // a pacing chunk, hand over as much of the window as can be scheduled
+        // within one RTT, continuing from where the last flush left off.
+        //
+        Builder->DepartureTimeUs =
+            CXPLAT_MAX(TimeNow, Connection->Send.NextDepartureTimeUs);
+        const uint64_t Horizon = Builder->DepartureTimeUs - TimeNow;
+        if (Horizon >= Path->SmoothedRtt) {
+            Builder->SendAllowance = 0; // Wait for the pacing timer.
+        } else {
+            const uint64_t ScheduleAllowance =
+                Builder->PacingRate * (Path->SmoothedRtt - Horizon) / S_TO_US(1);
+            Builder->SendAllowance =
+                QuicCongestionControlGetSendAllowance(
+                    &Connection->CongestionControl, 0, FALSE);
+            if (Builder->SendAllowance > ScheduleAllowance) {
+                Builder->SendAllowance = (uint32_t)ScheduleAllowance;
+            }
+        }
+    } else {
+        Builder->SendAllowance =
+            QuicCongestionControlGetSendAllowance(
+                &Connection->CongestionControl,
+                TimeSinceLastSend,
+                Connection->Send.LastFlushTimeValid);
+    }
     if (Builder->SendAllowance > Path->Allowance) {
         Builder->SendAllowance = Path->Allowance;
     }
@@ -154,6 +181,8 @@ QuicPacketBuilderCleanup(
         QuicLossDetectionUpdateTimer(&Builder->Connection->LossDetection, FALSE);
     }
 
+    CXPLAT_DBG_ASSERT(Builder->SourceCount == 0);
+
     QuicSentPacketMetadataReleaseFrames(Builder->Metadata, Builder->Connection);
 
     CxPlatSecureZeroMemory(Builder->HpMask, sizeof(Builder->HpMask));
@@ -266,7 +295,8 @@ QuicPacketBuilderPrepare(
                 Builder->EcnEctSet ? CXPLAT_ECN_ECT_0 : CXPLAT_ECN_NON_ECT,
                 Builder->Connection->Registration->ExecProfile == QUIC_EXECUTION_PROFILE_TYPE_MAX_THROUGHPUT ?
                     CXPLAT_SEND_FLAGS_MAX_THROUGHPUT : CXPLAT_SEND_FLAGS_NONE,
-                Connection->DSCP
+                Connection->DSCP,
+                Builder->PacingRate != 0 ? Builder->DepartureTimeUs : 0
             };
             Builder->SendData =
                 CxPlatSendDataAlloc(Builder->Path->Binding->Socket, &SendConfig);
@@ -371,6 +401,18 @@ QuicPacketBuilderPrepare(
             Builder->EncryptionOverhead = 0;
         }
 
+        //
+        // Only the encryption of short header packets reads the plain
+        // text from the sources, and only with keys that are faster that way.
+        // Decided here, once per packet, rather than for every frame copied in.
+        //
+        Builder->EncryptFromSources =
+            !MsQuicLib.DisableFusedEncrypt &&
+            NewPacketType == SEND_PACKET_SHORT_HEADER_TYPE &&
+            Builder->EncryptionOverhead != 0 &&
+            !Connection->Paths[0].EncryptionOffloading &&
+            CxPlatKeyPrefersSources(Builder->Key->PacketKey);
+
         Builder->Metadata->PacketId =
             PartitionShifted | InterlockedIncrement64((int64_t*)&Partition->SendPacketId);
         QuicTraceEvent(
@@ -676,6 +718,99 @@ QuicPacketBuilderPrepareForStreamFrames(
     return QuicPacketBuilderPrepare(Builder, PacketKeyType, IsTailLossProbe, FALSE);
 }
 
+_IRQL_requires_max_(PASSIVE_LEVEL)
+void
+QuicPacketBuilderCopyPayload(
+    _Inout_ QUIC_PACKET_BUILDER* Builder,
+    _Out_writes_bytes_(Length) uint8_t* Dest,
+    _In_reads_bytes_(Length) const uint8_t* Source,
+    _In_ uint16_t Length
+    )
+{
+    CXPLAT_DBG_ASSERT(Builder->Datagram != NULL);
+    uint8_t* Payload =
+        Builder->Datagram->Buffer + Builder->PacketStart + Builder->HeaderLength;
+    CXPLAT_DBG_ASSERT(Dest >= Payload);
+
+    //
+    // Everything not encrypted from the sources, including packets the datapath
+    // encrypts, gets the data copied in now.
+    //
+    if (Builder->EncryptFromSources &&
+        Builder->SourceCount < QUIC_MAX_CRYPTO_BATCH_COUNT) {
+        const uint8_t i = Builder->SourceCount++;
+        Builder->SourceBuffer[i] = Source;
+        Builder->SourceOffset[i] = (uint16_t)(Dest - Payload);
+        Builder->SourceLength[i] = Length;
+    } else {
+        CxPlatCopyMemory(Dest, Source, Length);
+    }
+}
+
+//
+// Copies the stream data the current packet left to be read during encryption
+// into place, for when its plain text is needed beforehand.
+//
+static
+void
+QuicPacketBuilderCopyDeferredPayload(
+    _Inout_ QUIC_PACKET_BUILDER* Builder,
+    _Inout_ uint8_t* Payload
+    )
+{
+    for (uint8_t i = 0; i < Builder->SourceCount; ++i) {
+        CxPlatCopyMemory(
+            Payload + Builder->SourceOffset[i],
+            Builder->SourceBuffer[i],
+            Builder->SourceLength[i]);
+    }
+    Builder->SourceCount = 0;
+}
+
+//
+// Encrypts the current packet in place, reading any stream data it left in the
+// send buffers directly from there.
+//
+static
+QUIC_STATUS
+QuicPacketBuilderEncrypt(
+    _Inout_ QUIC_PACKET_BUILDER* Builder,
+    _In_reads_bytes_(CXPLAT_IV_LENGTH) const uint8_t* Iv,
+    _In_ uint8_t* Header,
+    _In_ uint16_t PayloadLength
+    )
+{
+    if (Builder->SourceCount == 0) {
+        return
+            CxPlatEncrypt(
+                Builder->Key->PacketKey,
+                Iv,
+                Builder->HeaderLength,
+                Header,
+                PayloadLength,
+                Header + Builder->HeaderLength);
+    }
+
+    CXPLAT_CRYPT_SOURCE Sources[QUIC_MAX_CRYPTO_BATCH_COUNT];
+    for (uint8_t i = 0; i < Builder->SourceCount; ++i) {
+        Sources[i].Buffer = Builder->SourceBuffer[i];
+        Sources[i].Offset = Builder->SourceOffset[i];
+        Sources[i].Length = Builder->SourceLength[i];
+    }
+
+    CXPLAT_CRYPT_BATCH_ENTRY Entry;
+    Entry.Iv = Iv;
+    Entry.AuthData = Header;
+    Entry.AuthDataLength = Builder->HeaderLength;
+    Entry.Buffer = Header + Builder->HeaderLength;
+    Entry.BufferLength = PayloadLength;
+    Entry.Sources = Sources;
+    Entry.SourceCount = Builder->SourceCount;
+    Builder->SourceCount = 0;
+
+    return CxPlatEncryptBatch(Builder->Key->PacketKey, 1, &Entry);
+}
+
 _IRQL_requires_max_(PASSIVE_LEVEL)
 void
 QuicPacketBuilderFinalizeHeaderProtection(
@@ -747,6 +882,7 @@ QuicPacketBuilderFinalize(
                 Builder->Datagram = NULL;
             }
         }
+        CXPLAT_DBG_ASSERT(Builder->SourceCount == 0);
         if (Builder->Path->Allowance != UINT32_MAX) {
             QuicConnAddOutFlowBlockedReason(
                 Connection, QUIC_FLOW_BLOCKED_AMPLIFICATION_PROT);
@@ -821,10 +957,12 @@ QuicPacketBuilderFinalize(
     }
 
 #ifdef QUIC_FUZZER
+    QuicPacketBuilderCopyDeferredPayload(Builder, Header + Builder->HeaderLength);
     QuicFuzzInjectHook(Builder);
 #endif
 
     if (QuicTraceLogVerboseEnabled()) {
+        QuicPacketBuilderCopyDeferredPayload(Builder, Header + Builder->HeaderLength);
         QuicPacketLogHeader(
             Connection,
             FALSE,
@@ -865,13 +1003,11 @@ QuicPacketBuilderFinalize(
         QUIC_STATUS Status;
         if (QUIC_FAILED(
             Status =
-            CxPlatEncrypt(
-                Builder->Key->PacketKey,
+            QuicPacketBuilderEncrypt(
+                Builder,
                 Iv,
-                Builder->HeaderLength,
                 Header,
-                PayloadLength,
-                Payload))) {
+                PayloadLength))) {
             QuicConnFatalError(Connection, Status, "Encryption failure");
             goto Exit;
         }
@@ -970,6 +1106,8 @@ QuicPacketBuilderFinalize(
 
     } else {
 
+        QuicPacketBuilderCopyDeferredPayload(Builder, Header + Builder->HeaderLength);
+
         QuicTraceEvent(
             PacketFinalize,
             "[pack][%llu] Finalizing",
@@ -1092,6 +1230,12 @@ QuicPacketBuilderSendBatch(
         Builder->TotalDatagramsLength,
         Builder->TotalCountDatagrams);
 
+    if (Builder->PacingRate != 0) {
+        Builder->DepartureTimeUs +=
+            Builder->TotalDatagramsLength * S_TO_US(1) / Builder->PacingRate;
+        Builder->Connection->Send.NextDepartureTimeUs = Builder->DepartureTimeUs;
+    }
+
     Builder->PacketBatchSent = TRUE;
     Builder->SendData = NULL;
     Builder->TotalDatagramsLength = 0;
@@ -5,6 +5,10 @@
 
 --*/
 
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
 //
 // All the necessary state for building and sending QUIC packets.
 //
@@ -57,6 +61,16 @@ typedef struct QUIC_PACKET_BUILDER {
     //
     uint8_t* HeaderBatch[QUIC_MAX_CRYPTO_BATCH_COUNT];
 
+    //
+    // Stream data not copied into the current packet, to be encrypted directly
+    // from the send buffers instead. SourceOffset is relative to the start of
+    // the packet's payload.
+    //
+    const uint8_t* SourceBuffer[QUIC_MAX_CRYPTO_BATCH_COUNT];
+    uint16_t SourceOffset[QUIC_MAX_CRYPTO_BATCH_COUNT];
+    uint16_t SourceLength[QUIC_MAX_CRYPTO_BATCH_COUNT];
+    uint8_t SourceCount;
+
     //
     // Indicates a batch of packets has been sent.
     //
@@ -83,6 +97,12 @@ typedef struct QUIC_PACKET_BUILDER {
     //
     uint8_t WrittenConnectionCloseFrame : 1;
 
+    //
+    // Indicates the current QUIC packet's stream data is encrypted directly
+    // from the send buffers (see SourceBuffer) instead of being copied in.
+    //
+    uint8_t EncryptFromSources : 1;
+
     //
     // The total number of datagrams that have been created.
     //
@@ -148,6 +168,17 @@ typedef struct QUIC_PACKET_BUILDER {
 
     uint64_t BatchId;
 
+    //
+    // The rate, in bytes per second, batches are scheduled to depart at, or
+    // zero if they are sent immediately. See MsQuicLib.SendTxTimeInUse.
+    //
+    uint64_t PacingRate;
+
+    //
+    // The departure time of the next batch. Only valid if PacingRate is set.
+    //
+    uint64_t DepartureTimeUs;
+
     //
     // Represents the metadata of the current QUIC packet.
     //
@@ -224,6 +255,21 @@ QuicPacketBuilderFinalize(
     _In_ BOOLEAN FlushBatchedDatagrams
     );
 
+//
+// Copies stream data into the current packet at Dest, or, if the packet is
+// encrypted from the sources (EncryptFromSources), just records where the data
+// is so it can be read directly from Source during encryption. Either way,
+// Source must remain valid until the packet is finalized.
+//
+_IRQL_requires_max_(PASSIVE_LEVEL)
+void
+QuicPacketBuilderCopyPayload(
+    _Inout_ QUIC_PACKET_BUILDER* Builder,
+    _Out_writes_bytes_(Length) uint8_t* Dest,
+    _In_reads_bytes_(Length) const uint8_t* Source,
+    _In_ uint16_t Length
+    );
+
 //
 // Returns TRUE if congestion control isn't currently blocking sends.
 //
@@ -273,3 +319,7 @@ QuicPacketBuilderAddStreamFrame(
     QuicStreamSentMetadataIncrement(Stream);
     return QuicPacketBuilderAddFrame(Builder, FrameType, TRUE);
 }
+
+#if defined(__cplusplus)
+}
+#endif
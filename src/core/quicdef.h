@@ -177,6 +177,28 @@ typedef struct QUIC_RX_PACKET QUIC_RX_PACKET;
 //
 #define QUIC_MAX_OPERATIONS_PER_DRAIN           16
 
+//
+// The bounds of a worker's adaptive drain budget, which replaces
+// QUIC_MAX_OPERATIONS_PER_DRAIN for connections that don't explicitly
+// configure MaxOperationsPerDrain.
+//
+#define QUIC_MIN_ADAPTIVE_OPERATIONS_PER_DRAIN  4
+#define QUIC_MAX_ADAPTIVE_OPERATIONS_PER_DRAIN  128
+
+//
+// The average worker queue delay (in microseconds) above which the adaptive
+// drain budget shrinks, and below which it is allowed to grow.
+//
+#define QUIC_DRAIN_BUDGET_SHRINK_DELAY_US       1000
+#define QUIC_DRAIN_BUDGET_GROW_DELAY_US         100
+
+//
+// The maximum number of queued connections an idle worker inspects, starting
+// from the tail of an overloaded worker's queue, when looking for a connection
+// to steal.
+//
+#define QUIC_WORKER_STEAL_MAX_SCAN              8
+
 //
 // Used as a hint for the maximum number of UDP datagrams to send for each
 // FLUSH_SEND operation. The actual number will generally exceed this value up
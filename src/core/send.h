@@ -283,6 +283,12 @@ typedef struct QUIC_SEND {
     //
     uint64_t LastFlushTime;
 
+    //
+    // The departure time scheduled after the last batch handed to the
+    // datapath, when departure times are used for pacing.
+    //
+    uint64_t NextDepartureTimeUs;
+
     //
     // The total number of packets sent with each corresponding ECT codepoint in all encryption
     // level.
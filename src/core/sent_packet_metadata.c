@@ -14,6 +14,14 @@ Abstract:
     contained in the packet. The allocator uses a different pool for each
     possible size.
 
+    Most packets only carry a few frames though, so each connection also has
+    a ring of fixed size slots, indexed by packet number, which is used first.
+    The same ring is how loss detection finds the packets acknowledged by an
+    ACK range without walking the sent and lost packet lists. Packets are
+    generally acknowledged in the order they are sent, so the ring's storage
+    is freed a block of packet numbers at a time once the last packet in it
+    goes away, instead of each packet being returned to a pool individually.
+
 --*/
 
 #include "precomp.h"
@@ -86,6 +94,12 @@ QuicSentPacketPoolInitialize(
             QUIC_POOL_META,
             Pool->Pools + i);
     }
+
+    CxPlatPoolInitialize(
+        FALSE,  // IsPaged
+        sizeof(QUIC_SENT_PACKET_RING_BLOCK),
+        QUIC_POOL_META,
+        &Pool->RingBlockPool);
 }
 
 _IRQL_requires_max_(DISPATCH_LEVEL)
@@ -97,6 +111,7 @@ QuicSentPacketPoolUninitialize(
     for (size_t i = 0; i < ARRAYSIZE(Pool->Pools); i++) {
         CxPlatPoolUninitialize(Pool->Pools + i);
     }
+    CxPlatPoolUninitialize(&Pool->RingBlockPool);
 }
 
 _IRQL_requires_max_(DISPATCH_LEVEL)
@@ -132,5 +147,323 @@ QuicSentPacketPoolReturnPacketMetadata(
 #endif
 
     QuicSentPacketMetadataReleaseFrames(Metadata, Connection);
-    CxPlatPoolFree(Metadata);
+    QuicSentPacketRingReturnPacketMetadata(
+        &Connection->LossDetection.SentPacketRing, Metadata);
+}
+
+_IRQL_requires_max_(DISPATCH_LEVEL)
+void
+QuicSentPacketRingInitialize(
+    _Out_ QUIC_SENT_PACKET_RING* Ring
+    )
+{
+    Ring->Blocks = Ring->InitialBlocks;
+    Ring->BasePacketNumber = 0;
+    Ring->BlockCount = QUIC_SENT_PACKET_RING_INITIAL_BLOCKS;
+    Ring->Count = 0;
+    Ring->UntrackedCount = 0;
+    Ring->NewestBlock = NULL;
+    CxPlatZeroMemory(Ring->InitialBlocks, sizeof(Ring->InitialBlocks));
+}
+
+QUIC_INLINE
+QUIC_SENT_PACKET_RING_BLOCK**
+QuicSentPacketRingBlockEntry(
+    _In_ const QUIC_SENT_PACKET_RING* Ring,
+    _In_ uint64_t PacketNumber
+    )
+{
+    return
+        &Ring->Blocks[
+            (PacketNumber >> QUIC_SENT_PACKET_RING_BLOCK_SHIFT) & (Ring->BlockCount - 1)];
+}
+
+//
+// Reallocates the block table with a new (larger) size. The blocks themselves
+// don't move.
+//
+_IRQL_requires_max_(DISPATCH_LEVEL)
+static
+BOOLEAN
+QuicSentPacketRingResize(
+    _Inout_ QUIC_SENT_PACKET_RING* Ring,
+    _In_ uint32_t NewBlockCount
+    )
+{
+    CXPLAT_DBG_ASSERT(NewBlockCount > Ring->BlockCount);
+    CXPLAT_DBG_ASSERT((NewBlockCount & (NewBlockCount - 1)) == 0);
+
+    QUIC_SENT_PACKET_RING_BLOCK** NewBlocks =
+        CXPLAT_ALLOC_NONPAGED(
+            NewBlockCount * sizeof(QUIC_SENT_PACKET_RING_BLOCK*),
+            QUIC_POOL_META);
+    if (NewBlocks == NULL) {
+        return FALSE;
+    }
+    CxPlatZeroMemory(NewBlocks, NewBlockCount * sizeof(QUIC_SENT_PACKET_RING_BLOCK*));
+
+    for (uint32_t i = 0; i < Ring->BlockCount; i++) {
+        QUIC_SENT_PACKET_RING_BLOCK* Block = Ring->Blocks[i];
+        if (Block != NULL) {
+            NewBlocks[
+                (Block->BasePacketNumber >> QUIC_SENT_PACKET_RING_BLOCK_SHIFT) &
+                (NewBlockCount - 1)] = Block;
+        }
+    }
+
+    if (Ring->Blocks != Ring->InitialBlocks) {
+        CXPLAT_FREE(Ring->Blocks, QUIC_POOL_META);
+    }
+    Ring->Blocks = NewBlocks;
+    Ring->BlockCount = NewBlockCount;
+    return TRUE;
+}
+
+//
+// Frees a block with nothing outstanding in it.
+//
+QUIC_INLINE
+void
+QuicSentPacketRingFreeBlock(
+    _Inout_ QUIC_SENT_PACKET_RING* Ring,
+    _In_ QUIC_SENT_PACKET_RING_BLOCK* Block
+    )
+{
+    CXPLAT_DBG_ASSERT(Block->Occupied == 0);
+    *QuicSentPacketRingBlockEntry(Ring, Block->BasePacketNumber) = NULL;
+    if (Block == Ring->NewestBlock) {
+        Ring->NewestBlock = NULL;
+    }
+    CxPlatPoolFree(Block);
+}
+
+//
+// Gives back the ring's storage once nothing is outstanding in it, so an idle
+// connection holds no blocks and the next packets start from the initial
+// block table again.
+//
+_IRQL_requires_max_(DISPATCH_LEVEL)
+static
+void
+QuicSentPacketRingRelease(
+    _Inout_ QUIC_SENT_PACKET_RING* Ring
+    )
+{
+    CXPLAT_DBG_ASSERT(Ring->Count == 0);
+    if (Ring->NewestBlock != NULL) {
+        QuicSentPacketRingFreeBlock(Ring, Ring->NewestBlock);
+    }
+    if (Ring->Blocks != Ring->InitialBlocks) {
+        CXPLAT_FREE(Ring->Blocks, QUIC_POOL_META);
+        Ring->Blocks = Ring->InitialBlocks;
+        Ring->BlockCount = QUIC_SENT_PACKET_RING_INITIAL_BLOCKS;
+        CxPlatZeroMemory(Ring->InitialBlocks, sizeof(Ring->InitialBlocks));
+    }
+}
+
+_IRQL_requires_max_(DISPATCH_LEVEL)
+void
+QuicSentPacketRingUninitialize(
+    _Inout_ QUIC_SENT_PACKET_RING* Ring
+    )
+{
+    CXPLAT_DBG_ASSERT(Ring->Count == 0);
+    CXPLAT_DBG_ASSERT(Ring->UntrackedCount == 0);
+    QuicSentPacketRingRelease(Ring);
+}
+
+//
+// Returns the block for the packet number, moving or growing the window and
+// allocating the block as necessary. Returns NULL if the packet can't be
+// added to the ring.
+//
+_IRQL_requires_max_(DISPATCH_LEVEL)
+static
+QUIC_SENT_PACKET_RING_BLOCK*
+QuicSentPacketRingGetBlockForAdd(
+    _Inout_ QUIC_SENT_PACKET_RING* Ring,
+    _In_ QUIC_SENT_PACKET_POOL* Pool,
+    _In_ uint64_t PacketNumber
+    )
+{
+    const uint64_t BasePacketNumber =
+        PacketNumber & ~(uint64_t)(QUIC_SENT_PACKET_RING_BLOCK_SLOTS - 1);
+
+    if (Ring->Count == 0) {
+        //
+        // Nothing is outstanding, so the window can start anywhere.
+        //
+        if (Ring->NewestBlock != NULL &&
+            Ring->NewestBlock->BasePacketNumber != BasePacketNumber) {
+            QuicSentPacketRingFreeBlock(Ring, Ring->NewestBlock);
+        }
+        Ring->BasePacketNumber = BasePacketNumber;
+    } else if (PacketNumber < Ring->BasePacketNumber) {
+        return NULL;
+    }
+
+    while (PacketNumber - Ring->BasePacketNumber >=
+           ((uint64_t)Ring->BlockCount << QUIC_SENT_PACKET_RING_BLOCK_SHIFT)) {
+        //
+        // Move the window past its oldest block if everything in it is gone
+        // already, otherwise make the window bigger.
+        //
+        QUIC_SENT_PACKET_RING_BLOCK* Oldest =
+            *QuicSentPacketRingBlockEntry(Ring, Ring->BasePacketNumber);
+        if (Oldest == NULL || Oldest->Occupied == 0) {
+            if (Oldest != NULL) {
+                QuicSentPacketRingFreeBlock(Ring, Oldest);
+            }
+            Ring->BasePacketNumber += QUIC_SENT_PACKET_RING_BLOCK_SLOTS;
+        } else if (
+            Ring->BlockCount >= QUIC_SENT_PACKET_RING_MAX_BLOCKS ||
+            !QuicSentPacketRingResize(Ring, Ring->BlockCount * 2)) {
+            return NULL;
+        }
+    }
+
+    QUIC_SENT_PACKET_RING_BLOCK** Entry = QuicSentPacketRingBlockEntry(Ring, PacketNumber);
+    QUIC_SENT_PACKET_RING_BLOCK* Block = *Entry;
+    if (Block == NULL) {
+        Block = CxPlatPoolAlloc(&Pool->RingBlockPool);
+        if (Block == NULL) {
+            return NULL;
+        }
+        Block->BasePacketNumber = BasePacketNumber;
+        Block->Occupied = 0;
+        *Entry = Block;
+    }
+    CXPLAT_DBG_ASSERT(Block->BasePacketNumber == BasePacketNumber);
+
+    if (Block != Ring->NewestBlock) {
+        //
+        // Packet numbers only go up, so if the previous newest block is
+        // already empty, nothing will ever be added to it again.
+        //
+        if (Ring->NewestBlock != NULL && Ring->NewestBlock->Occupied == 0) {
+            QuicSentPacketRingFreeBlock(Ring, Ring->NewestBlock);
+        }
+        Ring->NewestBlock = Block;
+    }
+
+    return Block;
+}
+
+_IRQL_requires_max_(DISPATCH_LEVEL)
+QUIC_SENT_PACKET_METADATA*
+QuicSentPacketRingGetPacketMetadata(
+    _Inout_ QUIC_SENT_PACKET_RING* Ring,
+    _In_ QUIC_SENT_PACKET_POOL* Pool,
+    _In_ uint64_t PacketNumber,
+    _In_ uint8_t FrameCount
+    )
+{
+    QUIC_SENT_PACKET_METADATA* Metadata;
+    QUIC_SENT_PACKET_RING_BLOCK* Block =
+        QuicSentPacketRingGetBlockForAdd(Ring, Pool, PacketNumber);
+    if (Block == NULL) {
+        Metadata = QuicSentPacketPoolGetPacketMetadata(Pool, FrameCount);
+        if (Metadata != NULL) {
+            Ring->UntrackedCount++;
+        }
+        return Metadata;
+    }
+
+    const uint32_t Slot = (uint32_t)(PacketNumber - Block->BasePacketNumber);
+    CXPLAT_DBG_ASSERT(!(Block->Occupied & (1ull << Slot)));
+    if (FrameCount <= QUIC_SENT_PACKET_RING_MAX_FRAMES) {
+        Metadata = (QUIC_SENT_PACKET_METADATA*)Block->Slots[Slot];
+#if DEBUG
+        Metadata->Flags.Freed = FALSE;
+#endif
+    } else {
+        Metadata = QuicSentPacketPoolGetPacketMetadata(Pool, FrameCount);
+        if (Metadata == NULL) {
+            return NULL;
+        }
+    }
+
+    Block->Packets[Slot] = Metadata;
+    Block->Occupied |= (1ull << Slot);
+    Ring->Count++;
+    return Metadata;
+}
+
+_IRQL_requires_max_(DISPATCH_LEVEL)
+void
+QuicSentPacketRingReturnPacketMetadata(
+    _Inout_ QUIC_SENT_PACKET_RING* Ring,
+    _In_ QUIC_SENT_PACKET_METADATA* Metadata
+    )
+{
+    QUIC_SENT_PACKET_RING_BLOCK* Block =
+        QuicSentPacketRingGetBlock(Ring, Metadata->PacketNumber);
+    const uint32_t Slot =
+        Block == NULL ? 0 : (uint32_t)(Metadata->PacketNumber - Block->BasePacketNumber);
+    if (Block == NULL ||
+        !(Block->Occupied & (1ull << Slot)) ||
+        Block->Packets[Slot] != Metadata) {
+        CXPLAT_DBG_ASSERT(Ring->UntrackedCount > 0);
+        Ring->UntrackedCount--;
+        CxPlatPoolFree(Metadata);
+        return;
+    }
+
+    Block->Occupied &= ~(1ull << Slot);
+    Ring->Count--;
+    if (Metadata != (QUIC_SENT_PACKET_METADATA*)Block->Slots[Slot]) {
+        CxPlatPoolFree(Metadata);
+    }
+
+    if (Block->Occupied == 0 && Block != Ring->NewestBlock) {
+        QuicSentPacketRingFreeBlock(Ring, Block);
+    }
+    if (Ring->Count == 0) {
+        QuicSentPacketRingRelease(Ring);
+    }
+}
+
+_IRQL_requires_max_(DISPATCH_LEVEL)
+QUIC_SENT_PACKET_METADATA*
+QuicSentPacketRingGetNext(
+    _In_ const QUIC_SENT_PACKET_RING* Ring,
+    _Inout_ uint64_t* PacketNumber,
+    _In_ uint64_t HighPacketNumber
+    )
+{
+    if (Ring->Count == 0) {
+        return NULL;
+    }
+
+    uint64_t Low = *PacketNumber;
+    if (Low < Ring->BasePacketNumber) {
+        Low = Ring->BasePacketNumber;
+    }
+    const uint64_t Last =
+        Ring->BasePacketNumber +
+        ((uint64_t)Ring->BlockCount << QUIC_SENT_PACKET_RING_BLOCK_SHIFT) - 1;
+    if (HighPacketNumber > Last) {
+        HighPacketNumber = Last;
+    }
+
+    while (Low <= HighPacketNumber) {
+        const QUIC_SENT_PACKET_RING_BLOCK* Block = QuicSentPacketRingGetBlock(Ring, Low);
+        if (Block != NULL) {
+            const uint64_t Occupied =
+                Block->Occupied &
+                (~0ull << (Low & (QUIC_SENT_PACKET_RING_BLOCK_SLOTS - 1)));
+            if (Occupied != 0) {
+                const uint64_t Found =
+                    Block->BasePacketNumber + CxPlatFirstSetBit64(Occupied);
+                if (Found > HighPacketNumber) {
+                    break;
+                }
+                *PacketNumber = Found + 1;
+                return Block->Packets[Found - Block->BasePacketNumber];
+            }
+        }
+        Low = (Low | (QUIC_SENT_PACKET_RING_BLOCK_SLOTS - 1)) + 1;
+    }
+
+    return NULL;
 }
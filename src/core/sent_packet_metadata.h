@@ -5,6 +5,10 @@
 
 --*/
 
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
 //
 // The maximum number of frames we will write to a single packet.
 //
@@ -94,6 +98,11 @@ typedef struct QUIC_SEND_PACKET_FLAGS {
     BOOLEAN IsAppLimited            : 1;
     BOOLEAN HasLastAckedPacketInfo  : 1;
     BOOLEAN EcnEctSet               : 1;
+
+    //
+    // TRUE while the packet is in the lost packets list.
+    //
+    BOOLEAN IsLost                  : 1;
 #if DEBUG
     BOOLEAN Freed                   : 1;
 #endif
@@ -141,6 +150,12 @@ typedef struct QUIC_SENT_PACKET_METADATA {
 
     struct QUIC_SENT_PACKET_METADATA *Next;
 
+    //
+    // Points to whatever points to this packet in its list (the list head or
+    // the previous packet's Next), so it can be unlinked in constant time.
+    //
+    struct QUIC_SENT_PACKET_METADATA **PrevNext;
+
     uint64_t PacketId;
     uint64_t PacketNumber;
     //
@@ -210,6 +225,11 @@ typedef struct QUIC_SENT_PACKET_POOL {
 
     CXPLAT_POOL Pools[QUIC_MAX_FRAMES_PER_PACKET];
 
+    //
+    // Blocks for the per-connection sent packet rings.
+    //
+    CXPLAT_POOL RingBlockPool;
+
 } QUIC_SENT_PACKET_POOL;
 
 _IRQL_requires_max_(DISPATCH_LEVEL)
@@ -224,6 +244,220 @@ QuicSentPacketPoolUninitialize(
     _In_ QUIC_SENT_PACKET_POOL* Pool
     );
 
+//
+// Per-connection ring of outstanding sent packets, indexed by packet number.
+// It is both where the metadata of most packets is stored and how the packets
+// acknowledged by an ACK range are found.
+//
+// The ring covers a window of packet numbers starting at BasePacketNumber, in
+// blocks of QUIC_SENT_PACKET_RING_BLOCK_SLOTS consecutive packet numbers. Each
+// block has a fixed size slot per packet number, which holds the metadata of
+// packets with up to QUIC_SENT_PACKET_RING_MAX_FRAMES frames (the common
+// case); larger packets get their metadata from the per frame count pools and
+// are only referenced from their slot. A bitmap per block tracks which slots
+// are in use, so runs of acknowledged packet numbers are skipped 64 at a time.
+//
+// Storage is reclaimed a whole block at a time: once the last packet in a
+// block goes away, the block goes back to the partition's pool, and the window
+// moves forward over it. The window grows, up to
+// QUIC_SENT_PACKET_RING_MAX_BLOCKS, when the oldest outstanding packet is too
+// far behind the newest one. Packets beyond that (or when allocating a block
+// fails) are tracked outside the ring, and until they are gone the ring can't
+// be used to look up acknowledged packets.
+//
+#define QUIC_SENT_PACKET_RING_MAX_FRAMES        4
+#define QUIC_SENT_PACKET_RING_BLOCK_SHIFT       6
+#define QUIC_SENT_PACKET_RING_BLOCK_SLOTS       (1 << QUIC_SENT_PACKET_RING_BLOCK_SHIFT)
+#define QUIC_SENT_PACKET_RING_INITIAL_BLOCKS    4
+#define QUIC_SENT_PACKET_RING_MAX_BLOCKS        (1 << 14)
+
+#define QUIC_SENT_PACKET_RING_SLOT_SIZE \
+    ALIGN_UP(SIZEOF_QUIC_SENT_PACKET_METADATA(QUIC_SENT_PACKET_RING_MAX_FRAMES), uint64_t)
+
+typedef struct QUIC_SENT_PACKET_RING_BLOCK {
+
+    //
+    // The packet number of the first slot. Always a multiple of
+    // QUIC_SENT_PACKET_RING_BLOCK_SLOTS.
+    //
+    uint64_t BasePacketNumber;
+
+    //
+    // Bit set for each slot holding an outstanding packet.
+    //
+    uint64_t Occupied;
+
+    //
+    // The metadata of the packet in each occupied slot. Either the slot's own
+    // storage or, for larger packets, an allocation from the pool.
+    //
+    QUIC_SENT_PACKET_METADATA* Packets[QUIC_SENT_PACKET_RING_BLOCK_SLOTS];
+
+    uint64_t Slots[QUIC_SENT_PACKET_RING_BLOCK_SLOTS][
+        QUIC_SENT_PACKET_RING_SLOT_SIZE / sizeof(uint64_t)];
+
+} QUIC_SENT_PACKET_RING_BLOCK;
+
+CXPLAT_STATIC_ASSERT(
+    QUIC_SENT_PACKET_RING_BLOCK_SLOTS == 8 * sizeof(uint64_t),
+    "Occupied must have one bit per slot");
+
+typedef struct QUIC_SENT_PACKET_RING {
+
+    //
+    // Block for each QUIC_SENT_PACKET_RING_BLOCK_SLOTS packet numbers in the
+    // window, at (packet number / slots per block) modulo BlockCount. NULL
+    // for blocks with nothing outstanding. Points at InitialBlocks until the
+    // window has to grow.
+    //
+    QUIC_SENT_PACKET_RING_BLOCK** Blocks;
+
+    //
+    // The first packet number in the window. Always a multiple of
+    // QUIC_SENT_PACKET_RING_BLOCK_SLOTS.
+    //
+    uint64_t BasePacketNumber;
+
+    //
+    // Number of entries in Blocks. Always a power of 2.
+    //
+    uint32_t BlockCount;
+
+    //
+    // Number of packets in the ring.
+    //
+    uint32_t Count;
+
+    //
+    // Number of outstanding packets that aren't in the ring.
+    //
+    uint32_t UntrackedCount;
+
+    //
+    // The block of the most recently added packet. It's kept while it has
+    // nothing outstanding but other blocks do, since the next packets sent
+    // will most likely go into it. Once the whole ring drains, it goes back to
+    // the pool along with any grown block table, so an idle connection holds
+    // no ring storage.
+    //
+    QUIC_SENT_PACKET_RING_BLOCK* NewestBlock;
+
+    //
+    // The block table until the window grows past
+    // QUIC_SENT_PACKET_RING_INITIAL_BLOCKS.
+    //
+    QUIC_SENT_PACKET_RING_BLOCK* InitialBlocks[QUIC_SENT_PACKET_RING_INITIAL_BLOCKS];
+
+} QUIC_SENT_PACKET_RING;
+
+_IRQL_requires_max_(DISPATCH_LEVEL)
+void
+QuicSentPacketRingInitialize(
+    _Out_ QUIC_SENT_PACKET_RING* Ring
+    );
+
+//
+// Frees the ring's memory. All packets must already have been released.
+//
+_IRQL_requires_max_(DISPATCH_LEVEL)
+void
+QuicSentPacketRingUninitialize(
+    _Inout_ QUIC_SENT_PACKET_RING* Ring
+    );
+
+//
+// Allocates the metadata for a newly sent packet and adds it to the ring, if
+// possible. Packet numbers must be added in increasing order.
+//
+_IRQL_requires_max_(DISPATCH_LEVEL)
+QUIC_SENT_PACKET_METADATA*
+QuicSentPacketRingGetPacketMetadata(
+    _Inout_ QUIC_SENT_PACKET_RING* Ring,
+    _In_ QUIC_SENT_PACKET_POOL* Pool,
+    _In_ uint64_t PacketNumber,
+    _In_ uint8_t FrameCount
+    );
+
+//
+// Removes the packet from the ring, or the count of untracked packets, and
+// frees its metadata.
+//
+_IRQL_requires_max_(DISPATCH_LEVEL)
+void
+QuicSentPacketRingReturnPacketMetadata(
+    _Inout_ QUIC_SENT_PACKET_RING* Ring,
+    _In_ QUIC_SENT_PACKET_METADATA* Metadata
+    );
+
+//
+// Returns TRUE if every outstanding packet is in the ring, so that
+// acknowledged packets can be looked up by packet number.
+//
+QUIC_INLINE
+BOOLEAN
+QuicSentPacketRingIsComplete(
+    _In_ const QUIC_SENT_PACKET_RING* Ring
+    )
+{
+    return Ring->UntrackedCount == 0;
+}
+
+//
+// Returns the block covering the packet number, or NULL if there isn't one.
+//
+_IRQL_requires_max_(DISPATCH_LEVEL)
+QUIC_INLINE
+QUIC_SENT_PACKET_RING_BLOCK*
+QuicSentPacketRingGetBlock(
+    _In_ const QUIC_SENT_PACKET_RING* Ring,
+    _In_ uint64_t PacketNumber
+    )
+{
+    QUIC_SENT_PACKET_RING_BLOCK* Block =
+        Ring->Blocks[
+            (PacketNumber >> QUIC_SENT_PACKET_RING_BLOCK_SHIFT) & (Ring->BlockCount - 1)];
+    if (Block == NULL ||
+        PacketNumber - Block->BasePacketNumber >= QUIC_SENT_PACKET_RING_BLOCK_SLOTS) {
+        return NULL;
+    }
+    return Block;
+}
+
+//
+// Returns the packet with the packet number, or NULL if it isn't in the ring.
+//
+_IRQL_requires_max_(DISPATCH_LEVEL)
+QUIC_INLINE
+QUIC_SENT_PACKET_METADATA*
+QuicSentPacketRingLookup(
+    _In_ const QUIC_SENT_PACKET_RING* Ring,
+    _In_ uint64_t PacketNumber
+    )
+{
+    QUIC_SENT_PACKET_RING_BLOCK* Block = QuicSentPacketRingGetBlock(Ring, PacketNumber);
+    if (Block == NULL) {
+        return NULL;
+    }
+    const uint32_t Slot = (uint32_t)(PacketNumber - Block->BasePacketNumber);
+    if (!(Block->Occupied & (1ull << Slot))) {
+        return NULL;
+    }
+    return Block->Packets[Slot];
+}
+
+//
+// Returns the packet with the lowest packet number in the range
+// [*PacketNumber, HighPacketNumber] and updates *PacketNumber to just past
+// it, or returns NULL if there isn't one.
+//
+_IRQL_requires_max_(DISPATCH_LEVEL)
+QUIC_SENT_PACKET_METADATA*
+QuicSentPacketRingGetNext(
+    _In_ const QUIC_SENT_PACKET_RING* Ring,
+    _Inout_ uint64_t* PacketNumber,
+    _In_ uint64_t HighPacketNumber
+    );
+
 //
 // Allocates a sent packet metadata item.
 //
@@ -243,3 +477,7 @@ QuicSentPacketPoolReturnPacketMetadata(
     _In_ QUIC_SENT_PACKET_METADATA* Metadata,
     _In_ QUIC_CONNECTION* Connection
     );
+
+#if defined(__cplusplus)
+}
+#endif
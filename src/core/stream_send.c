@@ -684,6 +684,7 @@ _IRQL_requires_max_(PASSIVE_LEVEL)
 void
 QuicStreamCopyFromSendRequests(
     _In_ QUIC_STREAM* Stream,
+    _Inout_ QUIC_PACKET_BUILDER* Builder,
     _In_ uint64_t Offset,
     _Out_writes_bytes_(Len) uint8_t* Buf,
     _In_range_(>, 0) uint16_t Len
@@ -691,7 +692,10 @@ QuicStreamCopyFromSendRequests(
 {
     //
     // Copies up to Len stream bytes starting at Offset from the noncontiguous
-    // send request queue into a contiguous frame buffer.
+    // send request queue into a contiguous frame buffer. The packet builder
+    // may instead defer the copy to when the packet is encrypted, reading the
+    // data straight out of the send requests' buffers (which stay around
+    // until the data is acknowledged).
     //
 
     CXPLAT_DBG_ASSERT(Len > 0);
@@ -743,7 +747,8 @@ QuicStreamCopyFromSendRequests(
         uint32_t BufferLeft = Req->Buffers[CurIndex].Length - (uint32_t)CurOffset;
         uint16_t CopyLength = Len < BufferLeft ? Len : (uint16_t)BufferLeft;
         CXPLAT_DBG_ASSERT(CopyLength > 0);
-        CxPlatCopyMemory(Buf, Req->Buffers[CurIndex].Buffer + CurOffset, CopyLength);
+        QuicPacketBuilderCopyPayload(
+            Builder, Buf, Req->Buffers[CurIndex].Buffer + CurOffset, CopyLength);
         Len -= CopyLength;
         Buf += CopyLength;
 
@@ -777,6 +782,7 @@ _IRQL_requires_max_(PASSIVE_LEVEL)
 void
 QuicStreamWriteOneFrame(
     _In_ QUIC_STREAM* Stream,
+    _Inout_ QUIC_PACKET_BUILDER* Builder,
     _In_ BOOLEAN ExplicitDataLength,
     _In_ uint64_t Offset,
     _Inout_ uint16_t* FramePayloadBytes,
@@ -820,7 +826,7 @@ QuicStreamWriteOneFrame(
         }
         Frame.Data = Buffer + HeaderLength;
         QuicStreamCopyFromSendRequests(
-            Stream, Offset, (uint8_t*)Frame.Data, (uint16_t)Frame.Length);
+            Stream, Builder, Offset, (uint8_t*)Frame.Data, (uint16_t)Frame.Length);
         Stream->Connection->Stats.Send.TotalStreamBytes += Frame.Length;
     }
 
@@ -891,6 +897,7 @@ _IRQL_requires_max_(PASSIVE_LEVEL)
 void
 QuicStreamWriteStreamFrames(
     _In_ QUIC_STREAM* Stream,
+    _Inout_ QUIC_PACKET_BUILDER* Builder,
     _In_ BOOLEAN ExplicitDataLength,
     _Inout_ QUIC_SENT_PACKET_METADATA* PacketMetadata,
     _Inout_ uint16_t* BufferLength,
@@ -990,6 +997,7 @@ QuicStreamWriteStreamFrames(
 
         QuicStreamWriteOneFrame(
             Stream,
+            Builder,
             ExplicitDataLength,
             Left,
             &FramePayloadBytes,
@@ -1193,6 +1201,7 @@ QuicStreamSendWrite(
         uint16_t StreamFrameLength = AvailableBufferLength - Builder->DatagramLength;
         QuicStreamWriteStreamFrames(
             Stream,
+            Builder,
             IsInitial,
             Builder->Metadata,
             &StreamFrameLength,
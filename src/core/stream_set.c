@@ -128,9 +128,14 @@ QuicStreamSetLazyInitStreamTable(
 {
     if (StreamSet->StreamTable == NULL) {
         //
-        // Lazily initialize the hash table.
+        // Lazily initialize the hash table. Stream IDs fit entirely in the
+        // signature, so the open addressing table can match them without
+        // touching the streams themselves.
         //
-        if (!CxPlatHashtableInitialize(&StreamSet->StreamTable, CXPLAT_HASH_MIN_SIZE)) {
+        if (!CxPlatHashtableInitializeWithFlags(
+                &StreamSet->StreamTable,
+                CXPLAT_HASH_OPEN_ADDRESSING_MIN_SIZE,
+                CXPLAT_HASH_OPEN_ADDRESSING)) {
             QuicTraceEvent(
                 AllocFailure,
                 "Allocation of '%s' failed. (%llu bytes)",
@@ -153,12 +158,14 @@ QuicStreamSetInsertStream(
     if (!QuicStreamSetLazyInitStreamTable(StreamSet)) {
         return FALSE;
     }
+    if (!CxPlatHashtableInsert(
+            StreamSet->StreamTable,
+            &Stream->TableEntry,
+            Stream->ID,
+            NULL)) {
+        return FALSE;
+    }
     Stream->Flags.InStreamTable = TRUE;
-    CxPlatHashtableInsert(
-        StreamSet->StreamTable,
-        &Stream->TableEntry,
-        (uint32_t)Stream->ID,
-        NULL);
     return TRUE;
 }
 
@@ -176,7 +183,7 @@ QuicStreamSetLookupStream(
 
     CXPLAT_HASHTABLE_LOOKUP_CONTEXT Context;
     CXPLAT_HASHTABLE_ENTRY* Entry =
-        CxPlatHashtableLookup(StreamSet->StreamTable, (uint32_t)ID, &Context);
+        CxPlatHashtableLookup(StreamSet->StreamTable, ID, &Context);
     while (Entry != NULL) {
         QUIC_STREAM* Stream =
             CXPLAT_CONTAINING_RECORD(Entry, QUIC_STREAM, TableEntry);
@@ -21,28 +21,43 @@ Abstract:
         The timer wheel itself doesn't care about anything other than that value
         from the connection.
 
-        Slots - This is a very simple hash table of time slots. Each slot holds
-        all connections with a next expiration time modulo the total slot count.
+        Levels - The timer wheel is a hashed, hierarchical wheel. Time is
+        divided into ticks of 256 us. The inner most level has one slot per
+        tick, and each outer level has slots that each cover all the slots of
+        the level below it. A connection is placed in the inner most level
+        whose window (relative to the current tick) contains its expiration
+        time. Anything beyond the outer most level goes into an overflow slot.
 
-        Slot Entry - Each slot is made up of a sorted, doubly-linked list of
-        connections.
+        Slot Entry - Each slot is made up of an unsorted, doubly-linked list of
+        connections, so insertion and removal are constant time.
+
+        Occupancy - Each level keeps a bitmap of which of its slots are not
+        empty, so the next slot with work can be found with a single bit scan
+        instead of walking the slots.
 
         Next Expiration - Along with all the connections in the timer wheel, the
         timer wheel also explicitly keeps track of the next expiration time and
         connection for quick next delay calculations.
 
     With these parts, the timer wheel is able to support insertion, update and
-    removal of any number of timers (and their associated connection).
+    removal of any number of timers (and their associated connection) in
+    constant time, independent of the number of connections in the wheel.
 
     Insertion or update consists of getting the next expiration time from the
-    connection, calculating the correct slot and then doing an insert into the
-    slot's sorted list of connections. Additionally, the next expiration is
-    updated if the new timer is the soonest to expire.
+    connection, calculating the correct level and slot and then appending to
+    the slot's list of connections. Additionally, the next expiration is updated
+    if the new timer is the soonest to expire.
 
     Removal consists of removing the connection from the doubly-linked list and
     updating the timer wheel's next expiration if this connection was currently
     next to expire.
 
+    Computing the next expiration consists of finding the inner most level with
+    any occupied slot. If it is the inner most level, the one slot is scanned
+    for the exact earliest time. Otherwise, the start of the outer slot is used
+    as the next expiration; when that time is reached, the slot's connections
+    are cascaded down to the inner levels.
+
 --*/
 
 #include "precomp.h"
@@ -50,21 +65,184 @@ Abstract:
 #include "timer_wheel.c.clog.h"
 #endif
 
+#define QUIC_TIMER_WHEEL_SLOT_MASK      ((uint64_t)QUIC_TIMER_WHEEL_LEVEL_SLOTS - 1)
+
+//
+// Helper to get the tick for a given time.
+//
+#define TIME_TO_TICK(TimeUs)            ((TimeUs) >> QUIC_TIMER_WHEEL_TICK_SHIFT)
+#define TICK_TO_TIME(Tick)              ((Tick) << QUIC_TIMER_WHEEL_TICK_SHIFT)
+
+//
+// Helper to get the number of bits of the tick covered by each slot of a level.
+//
+#define LEVEL_SHIFT(Level)              ((Level) * QUIC_TIMER_WHEEL_LEVEL_BITS)
+
+//
+// Returns the first tick of the given (occupied) slot of a level. Only valid
+// for the levels, not the overflow slot.
+//
+QUIC_INLINE
+uint64_t
+QuicTimerWheelSlotStartTick(
+    _In_ const QUIC_TIMER_WHEEL* TimerWheel,
+    _In_ uint32_t Level,
+    _In_ uint32_t Index
+    )
+{
+    const uint32_t WindowShift = LEVEL_SHIFT(Level + 1);
+    return
+        ((TimerWheel->CurrentTick >> WindowShift) << WindowShift) |
+        ((uint64_t)Index << LEVEL_SHIFT(Level));
+}
+
+//
+// Returns the first tick after the range covered by the outer most level, when
+// the overflow slot must be cascaded.
+//
+QUIC_INLINE
+uint64_t
+QuicTimerWheelOverflowTick(
+    _In_ const QUIC_TIMER_WHEEL* TimerWheel
+    )
+{
+    const uint32_t WindowShift = LEVEL_SHIFT(QUIC_TIMER_WHEEL_LEVEL_COUNT);
+    return ((TimerWheel->CurrentTick >> WindowShift) + 1) << WindowShift;
+}
+
+//
+// Calculates the slot a given expiration time belongs in, relative to the
+// current tick. Times already in the past go in the current inner slot.
+//
+QUIC_INLINE
+uint32_t
+QuicTimerWheelGetSlot(
+    _In_ const QUIC_TIMER_WHEEL* TimerWheel,
+    _In_ uint64_t ExpirationTime
+    )
+{
+    uint64_t Tick = TIME_TO_TICK(ExpirationTime);
+    if (Tick < TimerWheel->CurrentTick) {
+        Tick = TimerWheel->CurrentTick;
+    }
+
+    //
+    // The connection goes in the inner most level whose window also contains
+    // the current tick; i.e. all the tick bits above the level match.
+    //
+    const uint64_t Diff = Tick ^ TimerWheel->CurrentTick;
+    for (uint32_t Level = 0; Level < QUIC_TIMER_WHEEL_LEVEL_COUNT; ++Level) {
+        if ((Diff >> LEVEL_SHIFT(Level + 1)) == 0) {
+            return
+                Level * QUIC_TIMER_WHEEL_LEVEL_SLOTS +
+                (uint32_t)((Tick >> LEVEL_SHIFT(Level)) & QUIC_TIMER_WHEEL_SLOT_MASK);
+        }
+    }
+
+    return QUIC_TIMER_WHEEL_OVERFLOW_SLOT;
+}
+
+//
+// Adds the connection to the slot for its current expiration time.
+//
+_IRQL_requires_max_(PASSIVE_LEVEL)
+static
+void
+QuicTimerWheelInsert(
+    _Inout_ QUIC_TIMER_WHEEL* TimerWheel,
+    _Inout_ QUIC_CONNECTION* Connection
+    )
+{
+    const uint32_t Slot =
+        QuicTimerWheelGetSlot(TimerWheel, Connection->EarliestExpirationTime);
+    if (Slot != QUIC_TIMER_WHEEL_OVERFLOW_SLOT) {
+        TimerWheel->Occupied[Slot / QUIC_TIMER_WHEEL_LEVEL_SLOTS] |=
+            1ull << (Slot % QUIC_TIMER_WHEEL_LEVEL_SLOTS);
+    }
+    Connection->TimerSlot = (uint16_t)Slot;
+    CxPlatListInsertTail(&TimerWheel->Slots[Slot], &Connection->TimerLink);
+}
+
 //
-// The initial count of slots in the timer wheel.
+// Removes the connection from its slot. Returns TRUE if the slot is now empty.
 //
-#define QUIC_TIMER_WHEEL_INITIAL_SLOT_COUNT     32
+_IRQL_requires_max_(PASSIVE_LEVEL)
+static
+BOOLEAN
+QuicTimerWheelUnlink(
+    _Inout_ QUIC_TIMER_WHEEL* TimerWheel,
+    _Inout_ QUIC_CONNECTION* Connection
+    )
+{
+    const uint32_t Slot = Connection->TimerSlot;
+    CXPLAT_DBG_ASSERT(Slot < QUIC_TIMER_WHEEL_SLOT_COUNT);
+    CxPlatListEntryRemove(&Connection->TimerLink);
+    if (!CxPlatListIsEmpty(&TimerWheel->Slots[Slot])) {
+        return FALSE;
+    }
+    if (Slot != QUIC_TIMER_WHEEL_OVERFLOW_SLOT) {
+        TimerWheel->Occupied[Slot / QUIC_TIMER_WHEEL_LEVEL_SLOTS] &=
+            ~(1ull << (Slot % QUIC_TIMER_WHEEL_LEVEL_SLOTS));
+    }
+    return TRUE;
+}
 
 //
-// On average, the max number of connections per slot.
+// Moves all the connections from an outer slot to the slots they belong in,
+// relative to the (newly advanced) current tick.
 //
-#define QUIC_TIMER_WHEEL_MAX_LOAD_FACTOR    32
+_IRQL_requires_max_(PASSIVE_LEVEL)
+static
+void
+QuicTimerWheelCascade(
+    _Inout_ QUIC_TIMER_WHEEL* TimerWheel,
+    _In_ uint32_t Slot
+    )
+{
+    CXPLAT_LIST_ENTRY ListHead;
+    CxPlatListInitializeHead(&ListHead);
+    CxPlatListMoveItems(&TimerWheel->Slots[Slot], &ListHead);
+    if (Slot != QUIC_TIMER_WHEEL_OVERFLOW_SLOT) {
+        TimerWheel->Occupied[Slot / QUIC_TIMER_WHEEL_LEVEL_SLOTS] &=
+            ~(1ull << (Slot % QUIC_TIMER_WHEEL_LEVEL_SLOTS));
+    }
+
+    while (!CxPlatListIsEmpty(&ListHead)) {
+        QUIC_CONNECTION* Connection =
+            CXPLAT_CONTAINING_RECORD(
+                CxPlatListRemoveHead(&ListHead),
+                QUIC_CONNECTION,
+                TimerLink);
+        QuicTimerWheelInsert(TimerWheel, Connection);
+    }
+}
 
 //
-// Helper to get the slot index for a given time.
+// Returns the tick of the next occupied slot, or UINT64_MAX if the timer
+// wheel is empty.
 //
-#define TIME_TO_SLOT_INDEX(TimerWheel, TimeUs) \
-    ((US_TO_MS(TimeUs) / 1000) % (TimerWheel)->SlotCount)
+QUIC_INLINE
+uint64_t
+QuicTimerWheelGetNextTick(
+    _In_ const QUIC_TIMER_WHEEL* TimerWheel
+    )
+{
+    for (uint32_t Level = 0; Level < QUIC_TIMER_WHEEL_LEVEL_COUNT; ++Level) {
+        if (TimerWheel->Occupied[Level] != 0) {
+            return
+                QuicTimerWheelSlotStartTick(
+                    TimerWheel,
+                    Level,
+                    CxPlatFirstSetBit64(TimerWheel->Occupied[Level]));
+        }
+    }
+
+    if (!CxPlatListIsEmpty(&TimerWheel->Slots[QUIC_TIMER_WHEEL_OVERFLOW_SLOT])) {
+        return QuicTimerWheelOverflowTick(TimerWheel);
+    }
+
+    return UINT64_MAX;
+}
 
 _IRQL_requires_max_(PASSIVE_LEVEL)
 QUIC_STATUS
@@ -75,18 +253,19 @@ QuicTimerWheelInitialize(
     TimerWheel->NextExpirationTime = UINT64_MAX;
     TimerWheel->ConnectionCount = 0;
     TimerWheel->NextConnection = NULL;
-    TimerWheel->SlotCount = QUIC_TIMER_WHEEL_INITIAL_SLOT_COUNT;
+    TimerWheel->CurrentTick = 0;
+    CxPlatZeroMemory(TimerWheel->Occupied, sizeof(TimerWheel->Occupied));
     TimerWheel->Slots =
-        CXPLAT_ALLOC_NONPAGED(QUIC_TIMER_WHEEL_INITIAL_SLOT_COUNT * sizeof(CXPLAT_LIST_ENTRY), QUIC_POOL_TIMERWHEEL);
+        CXPLAT_ALLOC_NONPAGED(QUIC_TIMER_WHEEL_SLOT_COUNT * sizeof(CXPLAT_LIST_ENTRY), QUIC_POOL_TIMERWHEEL);
     if (TimerWheel->Slots == NULL) {
         QuicTraceEvent(
             AllocFailure,
             "Allocation of '%s' failed. (%llu bytes)", "timerwheel slots",
-            QUIC_TIMER_WHEEL_INITIAL_SLOT_COUNT * sizeof(CXPLAT_LIST_ENTRY));
+            QUIC_TIMER_WHEEL_SLOT_COUNT * sizeof(CXPLAT_LIST_ENTRY));
         return QUIC_STATUS_OUT_OF_MEMORY;
     }
 
-    for (uint32_t i = 0; i < TimerWheel->SlotCount; ++i) {
+    for (uint32_t i = 0; i < QUIC_TIMER_WHEEL_SLOT_COUNT; ++i) {
         CxPlatListInitializeHead(&TimerWheel->Slots[i]);
     }
 
@@ -100,7 +279,7 @@ QuicTimerWheelUninitialize(
     )
 {
     if (TimerWheel->Slots != NULL) {
-        for (uint32_t i = 0; i < TimerWheel->SlotCount; ++i) {
+        for (uint32_t i = 0; i < QUIC_TIMER_WHEEL_SLOT_COUNT; ++i) {
             CXPLAT_LIST_ENTRY* ListHead = &TimerWheel->Slots[i];
             CXPLAT_LIST_ENTRY* Entry = ListHead->Flink;
             while (Entry != ListHead) {
@@ -123,90 +302,6 @@ QuicTimerWheelUninitialize(
     }
 }
 
-_IRQL_requires_max_(PASSIVE_LEVEL)
-void
-QuicTimerWheelResize(
-    _Inout_ QUIC_TIMER_WHEEL* TimerWheel
-    )
-{
-    uint32_t NewSlotCount = TimerWheel->SlotCount * 2;
-    if (NewSlotCount <= TimerWheel->SlotCount) {
-        //
-        // Max size has been reached.
-        //
-        return;
-    }
-
-    CXPLAT_LIST_ENTRY* NewSlots =
-        CXPLAT_ALLOC_NONPAGED(NewSlotCount * sizeof(CXPLAT_LIST_ENTRY), QUIC_POOL_TIMERWHEEL);
-    if (NewSlots == NULL) {
-        QuicTraceEvent(
-            AllocFailure,
-            "Allocation of '%s' failed. (%llu bytes)", "timerwheel slots (realloc)",
-            NewSlotCount * sizeof(CXPLAT_LIST_ENTRY));
-        return;
-    }
-
-    QuicTraceLogVerbose(
-        TimerWheelResize,
-        "[time][%p] Resizing timer wheel (new slot count = %u).",
-        TimerWheel,
-        NewSlotCount);
-
-    for (uint32_t i = 0; i < NewSlotCount; ++i) {
-        CxPlatListInitializeHead(&NewSlots[i]);
-    }
-
-    uint32_t OldSlotCount = TimerWheel->SlotCount;
-    CXPLAT_LIST_ENTRY* OldSlots = TimerWheel->Slots;
-
-    TimerWheel->SlotCount = NewSlotCount;
-    TimerWheel->Slots = NewSlots;
-
-    for (uint32_t i = 0; i < OldSlotCount; ++i) {
-        //
-        // Iterate through each old slot, remove all connections and add them
-        // to the new slots.
-        //
-        while (!CxPlatListIsEmpty(&OldSlots[i])) {
-            QUIC_CONNECTION* Connection =
-                CXPLAT_CONTAINING_RECORD(
-                    CxPlatListRemoveHead(&OldSlots[i]),
-                    QUIC_CONNECTION,
-                    TimerLink);
-            uint64_t ExpirationTime = Connection->EarliestExpirationTime;
-            CXPLAT_DBG_ASSERT(TimerWheel->SlotCount != 0);
-            uint32_t SlotIndex = TIME_TO_SLOT_INDEX(TimerWheel, ExpirationTime);
-
-            //
-            // Insert the connection into the slot, in the correct order. We search
-            // the slot's list in reverse order, with the assumption that most new
-            // timers will on average be later than existing ones.
-            //
-            CXPLAT_LIST_ENTRY* ListHead = &TimerWheel->Slots[SlotIndex];
-            CXPLAT_LIST_ENTRY* Entry = ListHead->Blink;
-
-            while (Entry != ListHead) {
-                QUIC_CONNECTION* ConnectionEntry =
-                    CXPLAT_CONTAINING_RECORD(Entry, QUIC_CONNECTION, TimerLink);
-                uint64_t EntryExpirationTime = ConnectionEntry->EarliestExpirationTime;
-
-                if (ExpirationTime > EntryExpirationTime) {
-                    break;
-                }
-
-                Entry = Entry->Blink;
-            }
-
-            //
-            // Insert after the current entry.
-            //
-            CxPlatListInsertHead(Entry, &Connection->TimerLink);
-        }
-    }
-    CXPLAT_FREE(OldSlots, QUIC_POOL_TIMERWHEEL);
-}
-
 //
 // Called to update NextConnection and NextExpirationTime when the
 // current NextConnection is updated.
@@ -220,26 +315,37 @@ QuicTimerWheelUpdate(
     TimerWheel->NextExpirationTime = UINT64_MAX;
     TimerWheel->NextConnection = NULL;
 
-    //
-    // Loop over the slots to find the connection with the earliest
-    // expiration time.
-    //
-    for (uint32_t i = 0; i < TimerWheel->SlotCount; ++i) {
-        if (!CxPlatListIsEmpty(&TimerWheel->Slots[i])) {
+    if (TimerWheel->Occupied[0] != 0) {
+        //
+        // Everything on the inner most level expires before anything on the
+        // outer levels, so only the first occupied inner slot needs to be
+        // searched for the connection with the earliest expiration time.
+        //
+        const uint32_t Index = CxPlatFirstSetBit64(TimerWheel->Occupied[0]);
+        CXPLAT_LIST_ENTRY* ListHead = &TimerWheel->Slots[Index];
+        for (CXPLAT_LIST_ENTRY* Entry = ListHead->Flink;
+             Entry != ListHead;
+             Entry = Entry->Flink) {
             QUIC_CONNECTION* ConnectionEntry =
-                CXPLAT_CONTAINING_RECORD(
-                    TimerWheel->Slots[i].Flink,
-                    QUIC_CONNECTION,
-                    TimerLink);
+                CXPLAT_CONTAINING_RECORD(Entry, QUIC_CONNECTION, TimerLink);
             uint64_t EntryExpirationTime = ConnectionEntry->EarliestExpirationTime;
             if (EntryExpirationTime < TimerWheel->NextExpirationTime) {
                 TimerWheel->NextExpirationTime = EntryExpirationTime;
                 TimerWheel->NextConnection = ConnectionEntry;
             }
         }
+
+    } else {
+        //
+        // The next thing to do is cascade an outer slot down, at its start.
+        //
+        const uint64_t NextTick = QuicTimerWheelGetNextTick(TimerWheel);
+        if (NextTick != UINT64_MAX) {
+            TimerWheel->NextExpirationTime = TICK_TO_TIME(NextTick);
+        }
     }
 
-    if (TimerWheel->NextConnection == NULL) {
+    if (TimerWheel->NextExpirationTime == UINT64_MAX) {
         QuicTraceLogVerbose(
             TimerWheelNextExpirationNull,
             "[time][%p] Next Expiration = {NULL}.",
@@ -271,11 +377,12 @@ QuicTimerWheelRemoveConnection(
             "[time][%p] Removing Connection %p.",
             TimerWheel,
             Connection);
-        CxPlatListEntryRemove(&Connection->TimerLink);
+        BOOLEAN SlotEmptied = QuicTimerWheelUnlink(TimerWheel, Connection);
         Connection->TimerLink.Flink = NULL;
         TimerWheel->ConnectionCount--;
 
-        if (Connection == TimerWheel->NextConnection) {
+        if (Connection == TimerWheel->NextConnection ||
+            (SlotEmptied && TimerWheel->NextConnection == NULL)) {
             QuicTimerWheelUpdate(TimerWheel);
         }
 
@@ -291,12 +398,13 @@ QuicTimerWheelUpdateConnection(
     )
 {
     uint64_t ExpirationTime = Connection->EarliestExpirationTime;
+    BOOLEAN SlotEmptied = FALSE;
 
     if (Connection->TimerLink.Flink != NULL) {
         //
         // Connection is already in the timer wheel, so remove it first.
         //
-        CxPlatListEntryRemove(&Connection->TimerLink);
+        SlotEmptied = QuicTimerWheelUnlink(TimerWheel, Connection);
 
         if (ExpirationTime == UINT64_MAX || Connection->State.ShutdownComplete) {
             //
@@ -309,7 +417,8 @@ QuicTimerWheelUpdateConnection(
                 TimerWheel,
                 Connection);
 
-            if (Connection == TimerWheel->NextConnection) {
+            if (Connection == TimerWheel->NextConnection ||
+                (SlotEmptied && TimerWheel->NextConnection == NULL)) {
                 QuicTimerWheelUpdate(TimerWheel);
             }
 
@@ -335,33 +444,7 @@ QuicTimerWheelUpdateConnection(
 
     CXPLAT_DBG_ASSERT(ExpirationTime != UINT64_MAX);
     CXPLAT_DBG_ASSERT(!Connection->State.ShutdownComplete);
-    CXPLAT_DBG_ASSERT(TimerWheel->SlotCount != 0);
-    uint32_t SlotIndex = TIME_TO_SLOT_INDEX(TimerWheel, ExpirationTime);
-
-    //
-    // Insert the connection into the slot, in the correct order. We search
-    // the slot's list in reverse order, with the assumption that most new
-    // timers will on average be later than existing ones.
-    //
-    CXPLAT_LIST_ENTRY* ListHead = &TimerWheel->Slots[SlotIndex];
-    CXPLAT_LIST_ENTRY* Entry = ListHead->Blink;
-
-    while (Entry != ListHead) {
-        QUIC_CONNECTION* ConnectionEntry =
-            CXPLAT_CONTAINING_RECORD(Entry, QUIC_CONNECTION, TimerLink);
-        uint64_t EntryExpirationTime = ConnectionEntry->EarliestExpirationTime;
-
-        if (ExpirationTime > EntryExpirationTime) {
-            break;
-        }
-
-        Entry = Entry->Blink;
-    }
-
-    //
-    // Insert after the current entry.
-    //
-    CxPlatListInsertHead(Entry, &Connection->TimerLink);
+    QuicTimerWheelInsert(TimerWheel, Connection);
 
     QuicTraceLogVerbose(
         TimerWheelUpdateConnection,
@@ -381,18 +464,10 @@ QuicTimerWheelUpdateConnection(
             TimerWheel,
             ExpirationTime,
             Connection);
-    } else if (Connection == TimerWheel->NextConnection) {
+    } else if (Connection == TimerWheel->NextConnection ||
+               (SlotEmptied && TimerWheel->NextConnection == NULL)) {
         QuicTimerWheelUpdate(TimerWheel);
     }
-
-    //
-    // Resize the timer wheel if we have too many connections for the
-    // current size.
-    //
-    if (TimerWheel->ConnectionCount >
-        TimerWheel->SlotCount * QUIC_TIMER_WHEEL_MAX_LOAD_FACTOR) {
-        QuicTimerWheelResize(TimerWheel);
-    }
 }
 
 _IRQL_requires_max_(PASSIVE_LEVEL)
@@ -403,33 +478,67 @@ QuicTimerWheelGetExpired(
     _Inout_ CXPLAT_LIST_ENTRY* OutputListHead
     )
 {
-    //
-    // Iterate through every slot to find all the connections that now have
-    // expired timers.
-    //
-    BOOLEAN NeedsUpdate = FALSE;
-    for (uint32_t i = 0; i < TimerWheel->SlotCount; ++i) {
-        CXPLAT_LIST_ENTRY* ListHead = &TimerWheel->Slots[i];
+    const uint64_t NowTick = TIME_TO_TICK(TimeNow);
+
+    for (;;) {
+        //
+        // Move all the expired connections out of the current inner slot.
+        //
+        const uint32_t Index =
+            (uint32_t)(TimerWheel->CurrentTick & QUIC_TIMER_WHEEL_SLOT_MASK);
+        CXPLAT_LIST_ENTRY* ListHead = &TimerWheel->Slots[Index];
         CXPLAT_LIST_ENTRY* Entry = ListHead->Flink;
         while (Entry != ListHead) {
             QUIC_CONNECTION* ConnectionEntry =
                 CXPLAT_CONTAINING_RECORD(Entry, QUIC_CONNECTION, TimerLink);
-            uint64_t EntryExpirationTime = ConnectionEntry->EarliestExpirationTime;
-            if (EntryExpirationTime > TimeNow) {
-                break;
-            }
             Entry = Entry->Flink;
+            if (ConnectionEntry->EarliestExpirationTime > TimeNow) {
+                continue;
+            }
             CxPlatListEntryRemove(&ConnectionEntry->TimerLink);
             CxPlatListInsertTail(OutputListHead, &ConnectionEntry->TimerLink);
-            if (ConnectionEntry == TimerWheel->NextConnection) {
-                NeedsUpdate = TRUE;
-            }
             QuicConnAddRef(ConnectionEntry, QUIC_CONN_REF_WORKER);
             QuicConnRelease(ConnectionEntry, QUIC_CONN_REF_TIMER_WHEEL);
             TimerWheel->ConnectionCount--;
         }
+
+        if (!CxPlatListIsEmpty(ListHead)) {
+            //
+            // The current tick isn't over yet, so nothing later can be expired.
+            //
+            break;
+        }
+        TimerWheel->Occupied[0] &= ~(1ull << Index);
+
+        //
+        // Advance to the next occupied slot, if it has been reached.
+        //
+        const uint64_t NextTick = QuicTimerWheelGetNextTick(TimerWheel);
+        if (NextTick > NowTick) {
+            break;
+        }
+        CXPLAT_DBG_ASSERT(NextTick > TimerWheel->CurrentTick);
+        TimerWheel->CurrentTick = NextTick;
+
+        //
+        // Cascade any outer slots starting at the new tick down to the inner
+        // levels, from the outside in.
+        //
+        if ((NextTick & ((1ull << LEVEL_SHIFT(QUIC_TIMER_WHEEL_LEVEL_COUNT)) - 1)) == 0) {
+            QuicTimerWheelCascade(TimerWheel, QUIC_TIMER_WHEEL_OVERFLOW_SLOT);
+        }
+        for (uint32_t Level = QUIC_TIMER_WHEEL_LEVEL_COUNT - 1; Level > 0; --Level) {
+            if ((NextTick & ((1ull << LEVEL_SHIFT(Level)) - 1)) != 0) {
+                continue; // Not the start of a slot on this level.
+            }
+            const uint32_t LevelIndex =
+                (uint32_t)((NextTick >> LEVEL_SHIFT(Level)) & QUIC_TIMER_WHEEL_SLOT_MASK);
+            if (TimerWheel->Occupied[Level] & (1ull << LevelIndex)) {
+                QuicTimerWheelCascade(
+                    TimerWheel, Level * QUIC_TIMER_WHEEL_LEVEL_SLOTS + LevelIndex);
+            }
+        }
     }
-    if (NeedsUpdate) {
-        QuicTimerWheelUpdate(TimerWheel);
-    }
+
+    QuicTimerWheelUpdate(TimerWheel);
 }
@@ -5,12 +5,34 @@
 
 --*/
 
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
 typedef struct QUIC_CONNECTION QUIC_CONNECTION;
 
+//
+// The timer wheel is made up of QUIC_TIMER_WHEEL_LEVEL_COUNT levels, each with
+// QUIC_TIMER_WHEEL_LEVEL_SLOTS slots. A slot on the inner most level covers a
+// single tick of (1 << QUIC_TIMER_WHEEL_TICK_SHIFT) microseconds and each
+// outer level covers QUIC_TIMER_WHEEL_LEVEL_SLOTS times as much time as the
+// one below it. An additional overflow slot holds anything beyond the range
+// of the outer most level.
+//
+#define QUIC_TIMER_WHEEL_TICK_SHIFT         8   // 256 us
+#define QUIC_TIMER_WHEEL_LEVEL_BITS         6
+#define QUIC_TIMER_WHEEL_LEVEL_SLOTS        (1 << QUIC_TIMER_WHEEL_LEVEL_BITS)
+#define QUIC_TIMER_WHEEL_LEVEL_COUNT        6
+#define QUIC_TIMER_WHEEL_OVERFLOW_SLOT \
+    (QUIC_TIMER_WHEEL_LEVEL_COUNT * QUIC_TIMER_WHEEL_LEVEL_SLOTS)
+#define QUIC_TIMER_WHEEL_SLOT_COUNT         (QUIC_TIMER_WHEEL_OVERFLOW_SLOT + 1)
+
 typedef struct QUIC_TIMER_WHEEL {
 
     //
-    // The expiration time (in us) for the next timer in the timer wheel.
+    // The expiration time (in us) for the next timer in the timer wheel. This
+    // may be earlier than any connection's actual expiration time if an outer
+    // level slot must first be cascaded down to the inner levels.
     //
     uint64_t NextExpirationTime;
 
@@ -20,17 +42,24 @@ typedef struct QUIC_TIMER_WHEEL {
     uint64_t ConnectionCount;
 
     //
-    // The connection with the timer that expires next.
+    // The connection with the timer that expires next. NULL if the next
+    // expiration is a cascade of an outer level slot.
     //
     QUIC_CONNECTION* NextConnection;
 
     //
-    // The number of slots in the Slots array.
+    // The tick (in units of 1 << QUIC_TIMER_WHEEL_TICK_SHIFT us) the timer
+    // wheel has been processed up to. All slots are indexed relative to it.
     //
-    uint32_t SlotCount;
+    uint64_t CurrentTick;
 
     //
-    // An array of slots in the timer wheel.
+    // A bitmap per level of which slots currently contain connections.
+    //
+    uint64_t Occupied[QUIC_TIMER_WHEEL_LEVEL_COUNT];
+
+    //
+    // An array of QUIC_TIMER_WHEEL_SLOT_COUNT slots in the timer wheel.
     //
     CXPLAT_LIST_ENTRY* Slots;
 
@@ -85,3 +114,7 @@ QuicTimerWheelGetExpired(
     _In_ uint64_t TimeNow,
     _Inout_ CXPLAT_LIST_ENTRY* ListHead
     );
+
+#if defined(__cplusplus)
+}
+#endif
@@ -65,6 +65,7 @@ QuicTestPopulateApiTable(
     Api->StreamShutdown = MsQuicStreamShutdown;
     Api->StreamStart = MsQuicStreamStart;
     Api->StreamSend = MsQuicStreamSend;
+    Api->StreamSendBatch = MsQuicStreamSendBatch;
     Api->StreamReceiveComplete = MsQuicStreamReceiveComplete;
     Api->StreamReceiveSetEnabled = MsQuicStreamReceiveSetEnabled;
     Api->StreamProvideReceiveBuffers = MsQuicStreamProvideReceiveBuffers;
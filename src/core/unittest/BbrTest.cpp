@@ -13,3 +13,61 @@ Abstract:
 #ifdef QUIC_CLOG
 #include "BbrTest.cpp.clog.h"
 #endif
+
+//
+// Helper to create a minimal valid connection for testing BBR. Uses a real
+// QUIC_CONNECTION so QuicCongestionControlGetConnection() resolves correctly.
+//
+static void InitializeMockConnection(
+    QUIC_CONNECTION& Connection,
+    uint16_t Mtu)
+{
+    CxPlatZeroMemory(&Connection, sizeof(Connection));
+    Connection.Paths[0].Mtu = Mtu;
+    Connection.Paths[0].IsActive = TRUE;
+    Connection.Settings.PacingEnabled = FALSE;
+}
+
+//
+// Scenario: The pacing rate is zero until pacing is enabled and a usable
+// minimum RTT is known, and is then the bandwidth estimate (in bytes per
+// second) times the pacing gain.
+//
+TEST(BbrTest, GetPacingRate)
+{
+    QUIC_CONNECTION Connection;
+    QUIC_SETTINGS_INTERNAL Settings{};
+    Settings.InitialWindowPackets = 10;
+
+    InitializeMockConnection(Connection, 1280);
+    BbrCongestionControlInitialize(&Connection.CongestionControl, &Settings);
+    QUIC_CONGESTION_CONTROL* Cc = &Connection.CongestionControl;
+    QUIC_CONGESTION_CONTROL_BBR* Bbr = &Cc->Bbr;
+
+    //
+    // The bandwidth filter holds bytes per second scaled by BW_UNIT (8).
+    //
+    const uint64_t Bandwidth = 1000000;
+    QuicSlidingWindowExtremumUpdateMax(
+        &Bbr->BandwidthFilter.WindowedMaxFilter, Bandwidth * 8, 0);
+
+    // Pacing disabled
+    ASSERT_EQ(0u, Cc->QuicCongestionControlGetPacingRate(Cc));
+
+    // Pacing enabled, but no RTT sample yet
+    Connection.Settings.PacingEnabled = TRUE;
+    ASSERT_EQ(0u, Cc->QuicCongestionControlGetPacingRate(Cc));
+
+    // RTT too small to pace
+    Bbr->MinRtt = QUIC_SEND_PACING_INTERVAL - 1;
+    ASSERT_EQ(0u, Cc->QuicCongestionControlGetPacingRate(Cc));
+
+    // Unity gain (GAIN_UNIT is 256) paces at the bandwidth estimate
+    Bbr->MinRtt = 10000;
+    Bbr->PacingGain = 256;
+    ASSERT_EQ(Bandwidth, Cc->QuicCongestionControlGetPacingRate(Cc));
+
+    // Probing up paces 5/4 of it
+    Bbr->PacingGain = 256 * 5 / 4;
+    ASSERT_EQ(Bandwidth * 5 / 4, Cc->QuicCongestionControlGetPacingRate(Cc));
+}
@@ -20,7 +20,6 @@ Abstract:
       QuicBindingTraceRundown        (L245-272, 12 lines) - CxPlatSocketGetLocalAddress
       QuicBindingGetLocalAddress     (L276-285,  5 lines) - Binding->Socket
       QuicBindingSetLocalAddress     (L287-304,  7 lines) - Binding->Socket
-      QuicBindingReceive             (L1594-1762,89 lines) - Full datapath callback
       QuicBindingSend                (L1792-1832,16 lines) - CxPlatSocketSend
       QuicBindingUnreachable         (L1767-1788, 9 lines) - QuicConnQueueUnreachable
 
@@ -1115,6 +1114,15 @@ QuicBindingPreprocessPacket(
     _Out_ BOOLEAN* ReleaseDatagram
     );
 
+BOOLEAN
+QuicBindingPreprocessCoalescedPacket(
+    _Inout_ QUIC_RX_PACKET* Packet,
+    _In_ const CXPLAT_ROUTE* Route,
+    _In_reads_(DestCidLen)
+        const uint8_t* DestCid,
+    _In_ uint8_t DestCidLen
+    );
+
 BOOLEAN
 QuicBindingShouldRetryConnection(
     _In_ const QUIC_BINDING* const Binding,
@@ -1755,6 +1763,204 @@ TEST_F(DeepTest_Binding, DeepTest_PreprocessPacket_Exclusive_ZeroCid)
     UninitializeMockBinding(&Binding);
 }
 
+// =====================================================================
+// QuicBindingPreprocessCoalescedPacket tests
+// =====================================================================
+
+//
+// Scenario: A datagram from the same coalesced receive with the same
+// destination CID as the validated short header packet before it.
+// How: Build a short header packet on the same route carrying the CID and
+// call QuicBindingPreprocessCoalescedPacket.
+// Assertions: Returns TRUE with the invariant fields filled in as
+// QuicBindingPreprocessPacket would.
+//
+TEST_F(DeepTest_Binding, DeepTest_PreprocessCoalescedPacket_SameCid)
+{
+    const uint8_t Cid[8] = { 1, 2, 3, 4, 5, 6, 7, 8 };
+
+    MockPacket Mock;
+    Mock.Buffer[0] = 0x40; // Short header: IsLongHeader=0, FixedBit=1
+    memcpy(Mock.Buffer + 1, Cid, sizeof(Cid));
+    Mock.Packet.PacketNumber = 1234;
+
+    ASSERT_TRUE(
+        QuicBindingPreprocessCoalescedPacket(
+            &Mock.Packet, &Mock.Route, Cid, sizeof(Cid)));
+    ASSERT_TRUE(Mock.Packet.ValidatedHeaderInv);
+    ASSERT_TRUE(Mock.Packet.IsShortHeader);
+    ASSERT_EQ(Mock.Packet.DestCidLen, sizeof(Cid));
+    ASSERT_EQ(Mock.Packet.DestCid, Mock.Buffer + 1);
+    ASSERT_EQ(Mock.Packet.HeaderLength, 1 + sizeof(Cid));
+    ASSERT_EQ(Mock.Packet.AvailBuffer, Mock.Buffer);
+    ASSERT_EQ(Mock.Packet.AvailBufferLength, sizeof(Mock.Buffer));
+    ASSERT_EQ(Mock.Packet.PacketNumber, 0u);
+}
+
+//
+// Scenario: Datagrams that can't share the previous packet's validation.
+// How: Call QuicBindingPreprocessCoalescedPacket with a different CID, a
+// long header, a different route and a buffer too short for the CID.
+// Assertions: Returns FALSE each time and leaves the packet unvalidated.
+//
+TEST_F(DeepTest_Binding, DeepTest_PreprocessCoalescedPacket_Fallback)
+{
+    const uint8_t Cid[8] = { 1, 2, 3, 4, 5, 6, 7, 8 };
+    CXPLAT_ROUTE OtherRoute;
+    CxPlatZeroMemory(&OtherRoute, sizeof(OtherRoute));
+
+    MockPacket Mock;
+    Mock.Buffer[0] = 0x40;
+    memcpy(Mock.Buffer + 1, Cid, sizeof(Cid));
+    Mock.Buffer[sizeof(Cid)] ^= 0xFF;
+    ASSERT_FALSE(
+        QuicBindingPreprocessCoalescedPacket(
+            &Mock.Packet, &Mock.Route, Cid, sizeof(Cid)));
+
+    memcpy(Mock.Buffer + 1, Cid, sizeof(Cid));
+    Mock.Buffer[0] = 0xC0; // Long header
+    ASSERT_FALSE(
+        QuicBindingPreprocessCoalescedPacket(
+            &Mock.Packet, &Mock.Route, Cid, sizeof(Cid)));
+
+    Mock.Buffer[0] = 0x40;
+    ASSERT_FALSE(
+        QuicBindingPreprocessCoalescedPacket(
+            &Mock.Packet, &OtherRoute, Cid, sizeof(Cid)));
+
+    Mock.Packet._.BufferLength = sizeof(Cid);
+    ASSERT_FALSE(
+        QuicBindingPreprocessCoalescedPacket(
+            &Mock.Packet, &Mock.Route, Cid, sizeof(Cid)));
+
+    ASSERT_FALSE(Mock.Packet.ValidatedHeaderInv);
+}
+
+// =====================================================================
+// QuicBindingReceive coalesced receive tests
+// =====================================================================
+
+//
+// Helper: Sends one batch of short header datagrams of SegmentSize bytes over
+// the memory datapath, one per destination CID in Cids. A batch of more than
+// one datagram is received as a single coalesced run.
+//
+static void
+SendShortHeaderBatch(
+    _In_ CXPLAT_SOCKET* Socket,
+    _In_ CXPLAT_ROUTE* Route,
+    _In_ uint16_t SegmentSize,
+    _In_ uint16_t Count,
+    _In_reads_(Count) const uint8_t (*Cids)[8]
+    )
+{
+    CXPLAT_SEND_CONFIG SendConfig = {
+        Route, Count > 1 ? SegmentSize : (uint16_t)0, CXPLAT_ECN_NON_ECT, 0, CXPLAT_DSCP_CS0 };
+    CXPLAT_SEND_DATA* SendData = CxPlatSendDataAlloc(Socket, &SendConfig);
+    ASSERT_NE(nullptr, SendData);
+    for (uint16_t i = 0; i < Count; i++) {
+        QUIC_BUFFER* Buffer = CxPlatSendDataAllocBuffer(SendData, SegmentSize);
+        ASSERT_NE(nullptr, Buffer);
+        CxPlatZeroMemory(Buffer->Buffer, SegmentSize);
+        Buffer->Buffer[0] = 0x40; // Short header: IsLongHeader=0, FixedBit=1
+        CxPlatCopyMemory(Buffer->Buffer + 1, Cids[i], sizeof(Cids[i]));
+    }
+    CxPlatSocketSend(Socket, Route, SendData);
+}
+
+//
+// Scenario: GRO-coalesced runs are received through QuicBindingReceive.
+// How: Bind a client-owned shared binding to a memory datapath socket, then
+// send a run of 4 datagrams for one CID, a single datagram, and a run of 4
+// datagrams split across two CIDs. Nothing matches a connection, so each
+// subchain is dropped with one lookup.
+// Assertions: The coalesced counters count the two runs and their 8
+// datagrams, but not the single datagram. All 9 datagrams are received, and
+// there is exactly one lookup per destination CID (4 drops), so a run with
+// one CID reaches the connection lookup as a single subchain.
+//
+TEST_F(DeepTest_Binding, DeepTest_Receive_CoalescedRuns)
+{
+    QUIC_BINDING Binding;
+    InitializeMockBinding(&Binding, FALSE, FALSE, FALSE);
+
+    const uint8_t SavedCidTotalLength = MsQuicLib.CidTotalLength;
+    MsQuicLib.CidTotalLength = 8;
+
+    //
+    // A single partition, so received datagrams land on MsQuicLib.Partitions[0].
+    //
+    QUIC_GLOBAL_EXECUTION_CONFIG ExecutionConfig = { QUIC_GLOBAL_EXECUTION_CONFIG_FLAG_NONE, 0, 1, {0} };
+    CXPLAT_WORKER_POOL* WorkerPool = CxPlatWorkerPoolCreate(&ExecutionConfig);
+    ASSERT_NE(nullptr, WorkerPool);
+
+    const CXPLAT_UDP_DATAPATH_CALLBACKS UdpCallbacks = {
+        QuicBindingReceive,
+        QuicBindingUnreachable,
+    };
+    CXPLAT_DATAPATH_INIT_CONFIG InitConfig = {0};
+    InitConfig.EnableMemoryDatapath = TRUE;
+    CXPLAT_DATAPATH* Datapath = nullptr;
+    TEST_QUIC_SUCCEEDED(
+        CxPlatDataPathInitialize(
+            sizeof(QUIC_RX_PACKET), &UdpCallbacks, nullptr, WorkerPool, &InitConfig, &Datapath));
+
+    QUIC_ADDR ServerAddress;
+    ASSERT_TRUE(QuicAddrFromString("127.0.0.1", 4433, &ServerAddress));
+    CXPLAT_UDP_CONFIG UdpConfig = {0};
+    UdpConfig.LocalAddress = &ServerAddress;
+    UdpConfig.CallbackContext = &Binding;
+    TEST_QUIC_SUCCEEDED(CxPlatSocketCreateUdp(Datapath, &UdpConfig, &Binding.Socket));
+
+    CXPLAT_SOCKET* Client = nullptr;
+    UdpConfig.LocalAddress = nullptr;
+    UdpConfig.RemoteAddress = &ServerAddress;
+    TEST_QUIC_SUCCEEDED(CxPlatSocketCreateUdp(Datapath, &UdpConfig, &Client));
+    CXPLAT_ROUTE Route;
+    CxPlatZeroMemory(&Route, sizeof(Route));
+    CxPlatSocketGetLocalAddress(Client, &Route.LocalAddress);
+    CxPlatSocketGetRemoteAddress(Client, &Route.RemoteAddress);
+
+    QUIC_PARTITION* Partition = &MsQuicLib.Partitions[0];
+    const int64_t StartRecv = Partition->PerfCounters[QUIC_PERF_COUNTER_UDP_RECV];
+    const int64_t StartCoalesced = Partition->PerfCounters[QUIC_PERF_COUNTER_UDP_RECV_COALESCED];
+    const int64_t StartSegments = Partition->PerfCounters[QUIC_PERF_COUNTER_UDP_RECV_COALESCED_SEGMENTS];
+
+    const uint8_t SameCid[4][8] = {
+        { 1, 1, 1, 1, 1, 1, 1, 1 }, { 1, 1, 1, 1, 1, 1, 1, 1 },
+        { 1, 1, 1, 1, 1, 1, 1, 1 }, { 1, 1, 1, 1, 1, 1, 1, 1 } };
+    const uint8_t SingleCid[1][8] = { { 2, 2, 2, 2, 2, 2, 2, 2 } };
+    const uint8_t TwoCids[4][8] = {
+        { 3, 3, 3, 3, 3, 3, 3, 3 }, { 3, 3, 3, 3, 3, 3, 3, 3 },
+        { 4, 4, 4, 4, 4, 4, 4, 4 }, { 4, 4, 4, 4, 4, 4, 4, 4 } };
+    ASSERT_NO_FATAL_FAILURE(SendShortHeaderBatch(Client, &Route, 64, 4, SameCid));
+    ASSERT_NO_FATAL_FAILURE(SendShortHeaderBatch(Client, &Route, 64, 1, SingleCid));
+    ASSERT_NO_FATAL_FAILURE(SendShortHeaderBatch(Client, &Route, 64, 4, TwoCids));
+
+    for (uint32_t i = 0;
+         i < 200 && Partition->PerfCounters[QUIC_PERF_COUNTER_UDP_RECV] - StartRecv < 9;
+         i++) {
+        CxPlatSleep(10);
+    }
+
+    //
+    // Deleting the socket waits for any receive upcall still in progress.
+    //
+    CxPlatSocketDelete(Client);
+    CxPlatSocketDelete(Binding.Socket);
+    Binding.Socket = nullptr;
+    CxPlatDataPathUninitialize(Datapath);
+    CxPlatWorkerPoolDelete(WorkerPool);
+    MsQuicLib.CidTotalLength = SavedCidTotalLength;
+
+    ASSERT_EQ(9, Partition->PerfCounters[QUIC_PERF_COUNTER_UDP_RECV] - StartRecv);
+    ASSERT_EQ(2, Partition->PerfCounters[QUIC_PERF_COUNTER_UDP_RECV_COALESCED] - StartCoalesced);
+    ASSERT_EQ(8, Partition->PerfCounters[QUIC_PERF_COUNTER_UDP_RECV_COALESCED_SEGMENTS] - StartSegments);
+    ASSERT_EQ(4u, Binding.Stats.Recv.DroppedPackets);
+
+    UninitializeMockBinding(&Binding);
+}
+
 // =====================================================================
 // QuicBindingShouldRetryConnection tests
 // =====================================================================
@@ -13,3 +13,473 @@ Abstract:
 #ifdef QUIC_CLOG
 #include "ConnectionTest.cpp.clog.h"
 #endif
+
+extern "C"
+void
+QuicConnRecvDecryptPublish(
+    _In_ QUIC_CONNECTION* Connection
+    );
+
+extern "C"
+void
+QuicConnRecvDecryptChain(
+    _In_ QUIC_CONNECTION* Connection,
+    _In_ QUIC_RX_PACKET* Packets
+    );
+
+extern "C"
+uint8_t
+QuicConnRecvDecryptBatch(
+    _In_ QUIC_CONNECTION* Connection,
+    _In_ uint8_t BatchCount,
+    _In_reads_(BatchCount) QUIC_RX_PACKET** Packets,
+    _Inout_updates_(BatchCount * CXPLAT_HP_SAMPLE_LENGTH)
+        uint8_t* HpMask,
+    _Out_writes_to_(BatchCount, return)
+        QUIC_RECV_PREDECRYPTED* Results
+    );
+
+#define RECV_TEST_CID_LENGTH        8
+#define RECV_TEST_PN_LENGTH         2
+#define RECV_TEST_HEADER_LENGTH     (1 + RECV_TEST_CID_LENGTH)
+#define RECV_TEST_PAYLOAD_LENGTH    100
+#define RECV_TEST_PACKET_LENGTH \
+    (RECV_TEST_HEADER_LENGTH + RECV_TEST_PN_LENGTH + \
+     RECV_TEST_PAYLOAD_LENGTH + CXPLAT_ENCRYPTION_OVERHEAD)
+
+//
+// A 1-RTT packet as received, protected with the peer's copy of the key.
+//
+struct RecvTestPacket {
+    QUIC_RX_PACKET Rx;
+    uint8_t Buffer[RECV_TEST_PACKET_LENGTH];
+};
+
+//
+// Drives the decryption of 1-RTT packets on the receive path and on the worker
+// for a minimal connection, which has only 1-RTT read and write keys and is
+// never queued to a worker.
+//
+struct ConnectionRecvDecryptTest : public ::testing::Test
+{
+    QUIC_CONNECTION* Connection {nullptr};
+    QUIC_PACKET_SPACE* PacketSpace {nullptr};
+    CXPLAT_SECRET Secret;
+    BOOLEAN SavedEnableParallelDecrypt {FALSE};
+
+    void SetUp() override {
+        Connection = new(std::nothrow) QUIC_CONNECTION;
+        PacketSpace = new(std::nothrow) QUIC_PACKET_SPACE;
+        ASSERT_NE(nullptr, Connection);
+        ASSERT_NE(nullptr, PacketSpace);
+        CxPlatZeroMemory(Connection, sizeof(*Connection));
+        CxPlatZeroMemory(PacketSpace, sizeof(*PacketSpace));
+        CxPlatDispatchLockInitialize(&Connection->RecvDecryptLock);
+
+        Connection->_.Type = QUIC_HANDLE_TYPE_CONNECTION_CLIENT;
+        Connection->Stats.QuicVersion = QuicSupportedVersionList[0].Number;
+        Connection->Packets[QUIC_ENCRYPT_LEVEL_1_RTT] = PacketSpace;
+        Connection->State.HandshakeConfirmed = TRUE;
+        Connection->State.HeaderProtectionEnabled = TRUE;
+
+        Secret.Hash = CXPLAT_HASH_SHA256;
+        Secret.Aead = CXPLAT_AEAD_AES_128_GCM;
+        CxPlatRandom(sizeof(Secret.Secret), Secret.Secret);
+        TEST_QUIC_SUCCEEDED(
+            CreateKey(&Connection->Crypto.TlsState.ReadKeys[QUIC_PACKET_KEY_1_RTT]));
+        TEST_QUIC_SUCCEEDED(
+            CreateKey(&Connection->Crypto.TlsState.WriteKeys[QUIC_PACKET_KEY_1_RTT]));
+
+        SavedEnableParallelDecrypt = MsQuicLib.EnableParallelDecrypt;
+        MsQuicLib.EnableParallelDecrypt = TRUE;
+    }
+
+    void TearDown() override {
+        MsQuicLib.EnableParallelDecrypt = SavedEnableParallelDecrypt;
+        if (Connection != nullptr) {
+            for (uint32_t i = 0; i < QUIC_PACKET_KEY_COUNT; ++i) {
+                QuicPacketKeyFree(Connection->Crypto.TlsState.ReadKeys[i]);
+                QuicPacketKeyFree(Connection->Crypto.TlsState.WriteKeys[i]);
+            }
+            CxPlatDispatchLockUninitialize(&Connection->RecvDecryptLock);
+        }
+        delete PacketSpace;
+        delete Connection;
+    }
+
+    //
+    // Creates a separate copy of the connection's initial 1-RTT key, as the
+    // peer would have.
+    //
+    QUIC_STATUS CreateKey(QUIC_PACKET_KEY** Key) {
+        return
+            QuicPacketKeyDerive(
+                QUIC_PACKET_KEY_1_RTT,
+                &QuicSupportedVersionList[0].HkdfLabels,
+                &Secret,
+                "RecvTest",
+                TRUE,
+                Key);
+    }
+
+    //
+    // Builds a protected 1-RTT packet with the peer's key. Header protection
+    // always uses the initial key's header key.
+    //
+    static
+    void
+    BuildPacket(
+        const QUIC_PACKET_KEY* Key,
+        const QUIC_PACKET_KEY* HeaderKey,
+        BOOLEAN KeyPhase,
+        uint64_t PacketNumber,
+        RecvTestPacket* Packet
+        )
+    {
+        uint8_t* Buffer = Packet->Buffer;
+        Buffer[0] = 0x40 | (KeyPhase ? 0x04 : 0) | (RECV_TEST_PN_LENGTH - 1);
+        CxPlatZeroMemory(Buffer + 1, RECV_TEST_CID_LENGTH);
+        Buffer[RECV_TEST_HEADER_LENGTH] = (uint8_t)(PacketNumber >> 8);
+        Buffer[RECV_TEST_HEADER_LENGTH + 1] = (uint8_t)PacketNumber;
+        uint8_t* Payload = Buffer + RECV_TEST_HEADER_LENGTH + RECV_TEST_PN_LENGTH;
+        for (uint16_t i = 0; i < RECV_TEST_PAYLOAD_LENGTH; ++i) {
+            Payload[i] = (uint8_t)(PacketNumber + i);
+        }
+
+        uint8_t Iv[CXPLAT_MAX_IV_LENGTH];
+        QuicCryptoCombineIvAndPacketNumber(Key->Iv, (uint8_t*)&PacketNumber, Iv);
+        ASSERT_TRUE(QUIC_SUCCEEDED(
+            CxPlatEncrypt(
+                Key->PacketKey,
+                Iv,
+                RECV_TEST_HEADER_LENGTH + RECV_TEST_PN_LENGTH,
+                Buffer,
+                RECV_TEST_PAYLOAD_LENGTH + CXPLAT_ENCRYPTION_OVERHEAD,
+                Payload)));
+
+        uint8_t Mask[CXPLAT_HP_SAMPLE_LENGTH];
+        ASSERT_TRUE(QUIC_SUCCEEDED(
+            CxPlatHpComputeMask(
+                HeaderKey->HeaderKey, 1, Buffer + RECV_TEST_HEADER_LENGTH + 4, Mask)));
+        Buffer[0] ^= Mask[0] & 0x1f;
+        for (uint8_t i = 0; i < RECV_TEST_PN_LENGTH; ++i) {
+            Buffer[RECV_TEST_HEADER_LENGTH + i] ^= Mask[1 + i];
+        }
+
+        CxPlatZeroMemory(&Packet->Rx, sizeof(Packet->Rx));
+        Packet->Rx.PacketId = PacketNumber + 1;
+        Packet->Rx.AvailBuffer = Buffer;
+        Packet->Rx.AvailBufferLength = RECV_TEST_PACKET_LENGTH;
+        Packet->Rx.HeaderLength = RECV_TEST_HEADER_LENGTH;
+        Packet->Rx.KeyType = QUIC_PACKET_KEY_1_RTT;
+        Packet->Rx.IsShortHeader = TRUE;
+        Packet->Rx.Encrypted = TRUE;
+    }
+
+    static
+    void
+    Chain(
+        RecvTestPacket* Packets,
+        uint8_t Count
+        )
+    {
+        for (uint8_t i = 0; i + 1 < Count; ++i) {
+            Packets[i].Rx._.Next = &Packets[i + 1].Rx._;
+        }
+    }
+
+    static
+    bool
+    PayloadMatches(
+        const RecvTestPacket* Packet,
+        uint64_t PacketNumber
+        )
+    {
+        const uint8_t* Payload =
+            Packet->Buffer + RECV_TEST_HEADER_LENGTH + RECV_TEST_PN_LENGTH;
+        for (uint16_t i = 0; i < RECV_TEST_PAYLOAD_LENGTH; ++i) {
+            if (Payload[i] != (uint8_t)(PacketNumber + i)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void
+    ExpectPredecrypted(
+        const RecvTestPacket* Packet,
+        uint64_t PacketNumber
+        )
+    {
+        ASSERT_TRUE(Packet->Rx.Predecrypted);
+        ASSERT_EQ(QUIC_STATUS_SUCCESS, Packet->Rx.PredecryptStatus);
+        ASSERT_EQ(PacketNumber, Packet->Rx.PredecryptPacketNumber);
+        ASSERT_EQ(
+            Connection->Crypto.TlsState.ReadKeys[QUIC_PACKET_KEY_1_RTT],
+            Packet->Rx.PredecryptKey);
+        ASSERT_TRUE(PayloadMatches(Packet, PacketNumber));
+    }
+
+    //
+    // Decrypts packets as the worker does for ones that weren't decrypted on
+    // the receive path. The header protection mask is computed with the
+    // peer's copy of the key, since the test has no worker receive batch.
+    //
+    static
+    uint8_t
+    WorkerDecrypt(
+        QUIC_CONNECTION* Connection,
+        const QUIC_PACKET_KEY* HeaderKey,
+        RecvTestPacket** Packets,
+        uint8_t Count,
+        QUIC_RECV_PREDECRYPTED* Results
+        )
+    {
+        QUIC_RX_PACKET* Batch[QUIC_MAX_CRYPTO_BATCH_COUNT];
+        uint8_t Cipher[CXPLAT_HP_SAMPLE_LENGTH * QUIC_MAX_CRYPTO_BATCH_COUNT];
+        uint8_t HpMask[CXPLAT_HP_SAMPLE_LENGTH * QUIC_MAX_CRYPTO_BATCH_COUNT];
+        for (uint8_t i = 0; i < Count; ++i) {
+            Batch[i] = &Packets[i]->Rx;
+            Batch[i]->PayloadLength = RECV_TEST_PACKET_LENGTH - RECV_TEST_HEADER_LENGTH;
+            CxPlatCopyMemory(
+                Cipher + i * CXPLAT_HP_SAMPLE_LENGTH,
+                Packets[i]->Buffer + RECV_TEST_HEADER_LENGTH + 4,
+                CXPLAT_HP_SAMPLE_LENGTH);
+        }
+        if (QUIC_FAILED(CxPlatHpComputeMask(HeaderKey->HeaderKey, Count, Cipher, HpMask))) {
+            return 0;
+        }
+        return QuicConnRecvDecryptBatch(Connection, Count, Batch, HpMask, Results);
+    }
+};
+
+TEST_F(ConnectionRecvDecryptTest, Publish)
+{
+    QUIC_PACKET_KEY* PeerKey;
+    TEST_QUIC_SUCCEEDED(CreateKey(&PeerKey));
+    RecvTestPacket Packets[2];
+
+    //
+    // Nothing is decrypted on the receive path before the key is published.
+    //
+    BuildPacket(PeerKey, PeerKey, FALSE, 0, &Packets[0]);
+    QuicConnRecvDecryptChain(Connection, &Packets[0].Rx);
+    ASSERT_FALSE(Packets[0].Rx.Predecrypted);
+
+    MsQuicLib.EnableParallelDecrypt = FALSE;
+    QuicConnRecvDecryptPublish(Connection);
+    ASSERT_EQ(nullptr, Connection->RecvDecryptKey);
+
+    MsQuicLib.EnableParallelDecrypt = TRUE;
+    Connection->State.HandshakeConfirmed = FALSE;
+    QuicConnRecvDecryptPublish(Connection);
+    ASSERT_EQ(nullptr, Connection->RecvDecryptKey);
+
+    Connection->State.HandshakeConfirmed = TRUE;
+    PacketSpace->NextRecvPacketNumber = 5;
+    QuicConnRecvDecryptPublish(Connection);
+    ASSERT_EQ(
+        Connection->Crypto.TlsState.ReadKeys[QUIC_PACKET_KEY_1_RTT],
+        Connection->RecvDecryptKey);
+    ASSERT_FALSE(Connection->RecvDecryptKeyPhase);
+    ASSERT_EQ(5u, Connection->RecvDecryptNextPacketNumber);
+    ASSERT_EQ(5u, Connection->RecvDecryptMaxPacketNumber);
+
+    BuildPacket(PeerKey, PeerKey, FALSE, 5, &Packets[0]);
+    BuildPacket(PeerKey, PeerKey, FALSE, 6, &Packets[1]);
+    Chain(Packets, 2);
+    QuicConnRecvDecryptChain(Connection, &Packets[0].Rx);
+    ExpectPredecrypted(&Packets[0], 5);
+    ExpectPredecrypted(&Packets[1], 6);
+    ASSERT_EQ(7u, Connection->RecvDecryptMaxPacketNumber);
+
+    //
+    // The key is withdrawn again once publishing is no longer allowed.
+    //
+    Connection->State.ClosedLocally = TRUE;
+    QuicConnRecvDecryptPublish(Connection);
+    ASSERT_EQ(nullptr, Connection->RecvDecryptKey);
+
+    QuicPacketKeyFree(PeerKey);
+}
+
+TEST_F(ConnectionRecvDecryptTest, RevokeOnKeyUpdate)
+{
+    QUIC_PACKET_KEY* PeerKey;
+    QUIC_PACKET_KEY* PeerNewKey;
+    TEST_QUIC_SUCCEEDED(CreateKey(&PeerKey));
+    TEST_QUIC_SUCCEEDED(
+        QuicPacketKeyUpdate(&QuicSupportedVersionList[0].HkdfLabels, PeerKey, &PeerNewKey));
+    RecvTestPacket Packets[3];
+
+    QuicConnRecvDecryptPublish(Connection);
+    ASSERT_NE(nullptr, Connection->RecvDecryptKey);
+
+    TEST_QUIC_SUCCEEDED(QuicCryptoGenerateNewKeys(Connection));
+    QuicCryptoUpdateKeyPhase(Connection, FALSE);
+    ASSERT_EQ(nullptr, Connection->RecvDecryptKey);
+
+    BuildPacket(PeerNewKey, PeerKey, TRUE, 0, &Packets[0]);
+    QuicConnRecvDecryptChain(Connection, &Packets[0].Rx);
+    ASSERT_FALSE(Packets[0].Rx.Predecrypted);
+
+    //
+    // Once republished, only packets in the new key phase are decrypted, and
+    // the first one in the old phase stops the rest of the chain.
+    //
+    QuicConnRecvDecryptPublish(Connection);
+    ASSERT_EQ(
+        Connection->Crypto.TlsState.ReadKeys[QUIC_PACKET_KEY_1_RTT],
+        Connection->RecvDecryptKey);
+    ASSERT_TRUE(Connection->RecvDecryptKeyPhase);
+
+    BuildPacket(PeerNewKey, PeerKey, TRUE, 0, &Packets[0]);
+    BuildPacket(PeerKey, PeerKey, FALSE, 1, &Packets[1]);
+    BuildPacket(PeerNewKey, PeerKey, TRUE, 2, &Packets[2]);
+    Chain(Packets, 3);
+    QuicConnRecvDecryptChain(Connection, &Packets[0].Rx);
+    ExpectPredecrypted(&Packets[0], 0);
+    ASSERT_FALSE(Packets[1].Rx.Predecrypted);
+    ASSERT_FALSE(Packets[2].Rx.Predecrypted);
+
+    QuicPacketKeyFree(PeerNewKey);
+    QuicPacketKeyFree(PeerKey);
+}
+
+TEST_F(ConnectionRecvDecryptTest, MixedPredecrypted)
+{
+    QUIC_PACKET_KEY* PeerKey;
+    TEST_QUIC_SUCCEEDED(CreateKey(&PeerKey));
+    RecvTestPacket Packets[4];
+    QUIC_RECV_PREDECRYPTED Results[QUIC_MAX_CRYPTO_BATCH_COUNT];
+
+    //
+    // A packet too short to sample is skipped and left to the worker, while
+    // the ones around it are still decrypted on the receive path.
+    //
+    QuicConnRecvDecryptPublish(Connection);
+    for (uint8_t i = 0; i < 4; ++i) {
+        BuildPacket(PeerKey, PeerKey, FALSE, i, &Packets[i]);
+    }
+    Packets[1].Rx.AvailBufferLength = RECV_TEST_HEADER_LENGTH + 4;
+    Chain(Packets, 4);
+    QuicConnRecvDecryptChain(Connection, &Packets[0].Rx);
+    ExpectPredecrypted(&Packets[0], 0);
+    ASSERT_FALSE(Packets[1].Rx.Predecrypted);
+    ExpectPredecrypted(&Packets[2], 2);
+    ExpectPredecrypted(&Packets[3], 3);
+
+    //
+    // A packet in the other key phase stops the receive path, and the worker
+    // decrypts the rest with the same published key.
+    //
+    for (uint8_t i = 0; i < 4; ++i) {
+        BuildPacket(PeerKey, PeerKey, i == 2, i, &Packets[i]);
+    }
+    Chain(Packets, 4);
+    QuicConnRecvDecryptChain(Connection, &Packets[0].Rx);
+    ExpectPredecrypted(&Packets[0], 0);
+    ExpectPredecrypted(&Packets[1], 1);
+    ASSERT_FALSE(Packets[2].Rx.Predecrypted);
+    ASSERT_FALSE(Packets[3].Rx.Predecrypted);
+
+    RecvTestPacket* Rest[] = { &Packets[3] };
+    ASSERT_EQ(1, WorkerDecrypt(Connection, PeerKey, Rest, 1, Results));
+    ASSERT_EQ(QUIC_STATUS_SUCCESS, Results[0].Status);
+    ASSERT_EQ(3u, Results[0].PacketNumber);
+    ASSERT_TRUE(PayloadMatches(&Packets[3], 3));
+
+    QuicPacketKeyFree(PeerKey);
+}
+
+struct RecvDecryptThreadContext {
+    ConnectionRecvDecryptTest* Test;
+    QUIC_PACKET_KEY* PeerKey;
+    uint32_t Iterations;
+    long volatile* ReadyCount;
+    uint32_t Failures;
+};
+
+static
+CXPLAT_THREAD_CALLBACK(RecvDecryptThread, Context)
+{
+    auto Ctx = (RecvDecryptThreadContext*)Context;
+    RecvTestPacket Packets[QUIC_MAX_CRYPTO_BATCH_COUNT];
+
+    InterlockedIncrement(Ctx->ReadyCount);
+    while (*Ctx->ReadyCount < 2) {
+        CxPlatSchedulerYield();
+    }
+
+    for (uint32_t j = 0; j < Ctx->Iterations; ++j) {
+        for (uint8_t i = 0; i < QUIC_MAX_CRYPTO_BATCH_COUNT; ++i) {
+            ConnectionRecvDecryptTest::BuildPacket(
+                Ctx->PeerKey, Ctx->PeerKey, FALSE, i, &Packets[i]);
+        }
+        ConnectionRecvDecryptTest::Chain(Packets, QUIC_MAX_CRYPTO_BATCH_COUNT);
+        QuicConnRecvDecryptChain(Ctx->Test->Connection, &Packets[0].Rx);
+        for (uint8_t i = 0; i < QUIC_MAX_CRYPTO_BATCH_COUNT; ++i) {
+            if (!Packets[i].Rx.Predecrypted ||
+                QUIC_FAILED(Packets[i].Rx.PredecryptStatus) ||
+                !ConnectionRecvDecryptTest::PayloadMatches(&Packets[i], i)) {
+                Ctx->Failures++;
+            }
+        }
+    }
+
+    CXPLAT_THREAD_RETURN(0);
+}
+
+TEST_F(ConnectionRecvDecryptTest, ConcurrentWorkerDecrypt)
+{
+    //
+    // The worker decrypts with the published key while the receive path does
+    // too. Every packet on both must still decrypt correctly.
+    //
+    QUIC_PACKET_KEY* PeerKey;
+    QUIC_PACKET_KEY* WorkerPeerKey;
+    TEST_QUIC_SUCCEEDED(CreateKey(&PeerKey));
+    TEST_QUIC_SUCCEEDED(CreateKey(&WorkerPeerKey));
+    QuicConnRecvDecryptPublish(Connection);
+
+    const uint32_t Iterations = 10000;
+    long volatile ReadyCount = 0;
+    RecvDecryptThreadContext Ctx = { this, PeerKey, Iterations, &ReadyCount, 0 };
+    CXPLAT_THREAD_CONFIG Config = { 0, 0, NULL, RecvDecryptThread, &Ctx };
+    CXPLAT_THREAD Thread;
+    TEST_QUIC_SUCCEEDED(CxPlatThreadCreate(&Config, &Thread));
+
+    InterlockedIncrement(&ReadyCount);
+    while (ReadyCount < 2) {
+        CxPlatSchedulerYield();
+    }
+
+    RecvTestPacket Packets[QUIC_MAX_CRYPTO_BATCH_COUNT];
+    RecvTestPacket* Batch[QUIC_MAX_CRYPTO_BATCH_COUNT];
+    QUIC_RECV_PREDECRYPTED Results[QUIC_MAX_CRYPTO_BATCH_COUNT];
+    uint32_t Failures = 0;
+    for (uint32_t j = 0; j < Iterations; ++j) {
+        for (uint8_t i = 0; i < QUIC_MAX_CRYPTO_BATCH_COUNT; ++i) {
+            BuildPacket(WorkerPeerKey, WorkerPeerKey, FALSE, i, &Packets[i]);
+            Batch[i] = &Packets[i];
+        }
+        const uint8_t Count =
+            WorkerDecrypt(
+                Connection, WorkerPeerKey, Batch, QUIC_MAX_CRYPTO_BATCH_COUNT, Results);
+        for (uint8_t i = 0; i < QUIC_MAX_CRYPTO_BATCH_COUNT; ++i) {
+            if (i >= Count ||
+                QUIC_FAILED(Results[i].Status) ||
+                !PayloadMatches(&Packets[i], i)) {
+                Failures++;
+            }
+        }
+    }
+
+    CxPlatThreadWait(&Thread);
+    CxPlatThreadDelete(&Thread);
+    ASSERT_EQ(0u, Ctx.Failures);
+    ASSERT_EQ(0u, Failures);
+
+    QuicPacketKeyFree(WorkerPeerKey);
+    QuicPacketKeyFree(PeerKey);
+}
@@ -73,11 +73,12 @@ TEST(CubicTest, InitializeComprehensive)
     ASSERT_GT(Cubic->CongestionWindow, 0u);
     ASSERT_EQ(Cubic->BytesInFlightMax, Cubic->CongestionWindow / 2);
 
-    // Verify all 17 function pointers are set
+    // Verify all 18 function pointers are set
     ASSERT_NE(Connection.CongestionControl.QuicCongestionControlCanSend, nullptr);
     ASSERT_NE(Connection.CongestionControl.QuicCongestionControlSetExemption, nullptr);
     ASSERT_NE(Connection.CongestionControl.QuicCongestionControlReset, nullptr);
     ASSERT_NE(Connection.CongestionControl.QuicCongestionControlGetSendAllowance, nullptr);
+    ASSERT_NE(Connection.CongestionControl.QuicCongestionControlGetPacingRate, nullptr);
     ASSERT_NE(Connection.CongestionControl.QuicCongestionControlOnDataSent, nullptr);
     ASSERT_NE(Connection.CongestionControl.QuicCongestionControlOnDataInvalidated, nullptr);
     ASSERT_NE(Connection.CongestionControl.QuicCongestionControlOnDataAcknowledged, nullptr);
@@ -769,3 +770,57 @@ TEST(CubicTest, HyStart_StateTransitions)
                 Cubic->HyStartState <= HYSTART_DONE);
     ASSERT_GE(Cubic->CWndSlowStartGrowthDivisor, 1u);
 }
+
+//
+// Test 18: GetPacingRate (via function pointer)
+// Scenario: The pacing rate is zero whenever GetSendAllowance wouldn't pace, and
+// otherwise matches the rate the paced allowance grows at, so departure times
+// scheduled from it spread the window over the same interval.
+//
+TEST(CubicTest, GetPacingRate)
+{
+    QUIC_CONNECTION Connection;
+    QUIC_SETTINGS_INTERNAL Settings{};
+
+    Settings.InitialWindowPackets = 10;
+    Settings.SendIdleTimeoutMs = 1000;
+
+    InitializeMockConnection(Connection, 1280);
+    CubicCongestionControlInitialize(&Connection.CongestionControl, &Settings);
+
+    // Pacing disabled
+    ASSERT_EQ(0u, Connection.CongestionControl.QuicCongestionControlGetPacingRate(
+        &Connection.CongestionControl));
+
+    // Pacing enabled, but no RTT sample yet
+    Connection.Settings.PacingEnabled = TRUE;
+    ASSERT_EQ(0u, Connection.CongestionControl.QuicCongestionControlGetPacingRate(
+        &Connection.CongestionControl));
+
+    // RTT too small to pace
+    Connection.Paths[0].GotFirstRttSample = TRUE;
+    Connection.Paths[0].SmoothedRtt = QUIC_MIN_PACING_RTT - 1;
+    ASSERT_EQ(0u, Connection.CongestionControl.QuicCongestionControlGetPacingRate(
+        &Connection.CongestionControl));
+
+    // Slow start paces the doubled window over one RTT
+    Connection.Paths[0].SmoothedRtt = 50000; // 50ms
+    QUIC_CONGESTION_CONTROL_CUBIC* Cubic = &Connection.CongestionControl.Cubic;
+    uint64_t Rate = Connection.CongestionControl.QuicCongestionControlGetPacingRate(
+        &Connection.CongestionControl);
+    ASSERT_EQ(Rate, (uint64_t)Cubic->CongestionWindow * 2 * 1000000 / 50000);
+
+    // Allowance after 10ms of pacing is consistent with the rate
+    Cubic->BytesInFlight = Cubic->CongestionWindow / 2;
+    Cubic->LastSendAllowance = 0;
+    uint32_t Allowance = Connection.CongestionControl.QuicCongestionControlGetSendAllowance(
+        &Connection.CongestionControl, 10000, TRUE);
+    ASSERT_EQ((uint64_t)Allowance, Rate * 10000 / 1000000);
+
+    // Congestion avoidance paces 1.25x the window
+    Cubic->SlowStartThreshold = Cubic->CongestionWindow;
+    Rate = Connection.CongestionControl.QuicCongestionControlGetPacingRate(
+        &Connection.CongestionControl);
+    ASSERT_EQ(Rate,
+        ((uint64_t)Cubic->CongestionWindow + (Cubic->CongestionWindow >> 2)) * 1000000 / 50000);
+}
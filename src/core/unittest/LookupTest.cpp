@@ -13,3 +13,499 @@ Abstract:
 #ifdef QUIC_CLOG
 #include "LookupTest.cpp.clog.h"
 #endif
+
+extern "C"
+void
+MsQuicCalculatePartitionMask(
+    void
+    );
+
+#define LOOKUP_TEST_PARTITION_COUNT 4
+
+//
+// Builds a server CID that is unique for the given value. The low bits of the
+// value also make up the partition ID, to spread the CIDs over the partitions.
+//
+static
+uint8_t
+MakeCid(
+    _In_ uint64_t Value,
+    _Out_writes_bytes_(QUIC_MAX_CONNECTION_ID_LENGTH_V1) uint8_t* Cid
+    )
+{
+    CxPlatZeroMemory(Cid, QUIC_MAX_CONNECTION_ID_LENGTH_V1);
+    uint16_t PartitionId = (uint16_t)Value;
+    CxPlatCopyMemory(Cid + MsQuicLib.CidServerIdLength, &PartitionId, QUIC_CID_PID_LENGTH);
+    CxPlatCopyMemory(
+        Cid + MsQuicLib.CidServerIdLength + QUIC_CID_PID_LENGTH, &Value, sizeof(Value));
+    return (uint8_t)(MsQuicLib.CidServerIdLength + QUIC_CID_PID_LENGTH + sizeof(Value));
+}
+
+//
+// Releases a reference taken by a lookup. The tests always hold the last
+// reference on their mock connections, so unlike QuicConnRelease this never
+// needs to free or queue the connection.
+//
+static
+void
+ReleaseLookupResult(
+    _In_ QUIC_CONNECTION* Connection
+    )
+{
+#if DEBUG
+    CxPlatRefDecrement(&Connection->RefTypeBiasedCount[QUIC_CONN_REF_LOOKUP_RESULT]);
+#endif
+    InterlockedDecrement(&Connection->RefCount);
+}
+
+//
+// Test fixture for lookup tests. Spreads the CIDs over several partitions, and
+// uses mock connections that are never freed, since every reference taken by
+// the lookup is on top of the one the test holds.
+//
+class LookupTest : public ::testing::Test {
+protected:
+    uint16_t SavedPartitionCount_;
+    uint16_t SavedPartitionMask_;
+
+    void SetUp() override {
+        SavedPartitionCount_ = MsQuicLib.PartitionCount;
+        SavedPartitionMask_ = MsQuicLib.PartitionMask;
+        MsQuicLib.PartitionCount = LOOKUP_TEST_PARTITION_COUNT;
+        MsQuicCalculatePartitionMask();
+    }
+
+    void TearDown() override {
+        MsQuicLib.PartitionCount = SavedPartitionCount_;
+        MsQuicLib.PartitionMask = SavedPartitionMask_;
+    }
+
+    static void
+    InitializeMockConnection(
+        _Out_ QUIC_CONNECTION* Connection
+        )
+    {
+        CxPlatZeroMemory(Connection, sizeof(*Connection));
+        Connection->_.Type = QUIC_HANDLE_TYPE_CONNECTION_SERVER;
+        Connection->RefCount = 1;
+        CxPlatListInitializeHead(&Connection->RegistrationLink);
+        CxPlatListInitializeHead(&Connection->WorkerLink);
+        CxPlatListInitializeHead(&Connection->TimerLink);
+#if DEBUG
+        for (uint32_t i = 0; i < QUIC_CONN_REF_COUNT; i++) {
+            CxPlatRefInitialize(&Connection->RefTypeBiasedCount[i]);
+        }
+#endif
+    }
+
+    //
+    // Adds a new CID for the connection to the lookup, then links it into the
+    // connection's CID list (after, so it doesn't collide with itself).
+    //
+    static QUIC_CID_HASH_ENTRY*
+    AddCid(
+        _In_ QUIC_LOOKUP* Lookup,
+        _In_ QUIC_CONNECTION* Connection,
+        _In_ uint64_t Value
+        )
+    {
+        uint8_t Data[QUIC_MAX_CONNECTION_ID_LENGTH_V1];
+        uint8_t Length = MakeCid(Value, Data);
+        QUIC_CID_HASH_ENTRY* SourceCid = QuicCidNewSource(Connection, Length, Data);
+        if (SourceCid == NULL) {
+            return NULL;
+        }
+        if (!QuicLookupAddLocalCid(Lookup, SourceCid, NULL)) {
+            CXPLAT_FREE(SourceCid, QUIC_POOL_CIDHASH);
+            return NULL;
+        }
+        SourceCid->Link.Next = Connection->SourceCids.Next;
+        Connection->SourceCids.Next = &SourceCid->Link;
+        return SourceCid;
+    }
+
+    //
+    // Returns the connection found for the CID value, releasing the lookup's
+    // reference on it right away.
+    //
+    static QUIC_CONNECTION*
+    Find(
+        _In_ QUIC_LOOKUP* Lookup,
+        _In_ uint64_t Value
+        )
+    {
+        uint8_t Data[QUIC_MAX_CONNECTION_ID_LENGTH_V1];
+        uint8_t Length = MakeCid(Value, Data);
+        QUIC_CONNECTION* Connection =
+            QuicLookupFindConnectionByLocalCid(Lookup, Data, Length);
+        if (Connection != NULL) {
+            ReleaseLookupResult(Connection);
+        }
+        return Connection;
+    }
+};
+
+TEST_F(LookupTest, SingleConnection)
+{
+    QUIC_LOOKUP Lookup;
+    QuicLookupInitialize(&Lookup);
+
+    QUIC_CONNECTION Connection;
+    InitializeMockConnection(&Connection);
+
+    ASSERT_NE(nullptr, AddCid(&Lookup, &Connection, 1));
+    ASSERT_NE(nullptr, AddCid(&Lookup, &Connection, 2));
+    ASSERT_EQ(0u, Lookup.PartitionCount);
+    ASSERT_EQ(&Connection, Find(&Lookup, 1));
+    ASSERT_EQ(&Connection, Find(&Lookup, 2));
+    ASSERT_EQ(nullptr, Find(&Lookup, 3));
+
+    QuicLookupRemoveLocalCids(&Lookup, &Connection);
+    ASSERT_EQ(0u, Lookup.CidCount);
+    ASSERT_EQ(1, Connection.RefCount);
+    QuicLookupUninitialize(&Lookup);
+}
+
+TEST_F(LookupTest, SecondConnectionPartitions)
+{
+    QUIC_LOOKUP Lookup;
+    QuicLookupInitialize(&Lookup);
+
+    QUIC_CONNECTION Connection1, Connection2;
+    InitializeMockConnection(&Connection1);
+    InitializeMockConnection(&Connection2);
+
+    //
+    // The single connection's CIDs move into the hash table once a second
+    // connection is added.
+    //
+    for (uint64_t i = 0; i < 10; i++) {
+        ASSERT_NE(nullptr, AddCid(&Lookup, &Connection1, i));
+    }
+    ASSERT_EQ(0u, Lookup.PartitionCount);
+    ASSERT_NE(nullptr, AddCid(&Lookup, &Connection2, 100));
+    ASSERT_EQ(1u, Lookup.PartitionCount);
+
+    for (uint64_t i = 0; i < 10; i++) {
+        ASSERT_EQ(&Connection1, Find(&Lookup, i));
+    }
+    ASSERT_EQ(&Connection2, Find(&Lookup, 100));
+    ASSERT_EQ(nullptr, Find(&Lookup, 101));
+
+    QuicLookupRemoveLocalCids(&Lookup, &Connection1);
+    ASSERT_EQ(nullptr, Find(&Lookup, 0));
+    ASSERT_EQ(&Connection2, Find(&Lookup, 100));
+    QuicLookupRemoveLocalCids(&Lookup, &Connection2);
+
+    //
+    // With no reader around, nothing retired is kept.
+    //
+    ASSERT_EQ(0, Lookup.ReclaimPending);
+    ASSERT_EQ(1, Connection1.RefCount);
+    ASSERT_EQ(1, Connection2.RefCount);
+    QuicLookupUninitialize(&Lookup);
+}
+
+TEST_F(LookupTest, AddFindRemove)
+{
+    const uint64_t CidCount = 1000;
+
+    QUIC_LOOKUP Lookup;
+    QuicLookupInitialize(&Lookup);
+    ASSERT_TRUE(QuicLookupMaximizePartitioning(&Lookup));
+    ASSERT_EQ(LOOKUP_TEST_PARTITION_COUNT, Lookup.PartitionCount);
+
+    //
+    // Enough CIDs to grow every partition's table several times, spread over
+    // connections with no more than a realistic number of CIDs each.
+    //
+    QUIC_CONNECTION Connections[8];
+    for (uint32_t i = 0; i < ARRAYSIZE(Connections); i++) {
+        InitializeMockConnection(&Connections[i]);
+    }
+    for (uint64_t i = 0; i < CidCount; i++) {
+        ASSERT_NE(nullptr, AddCid(&Lookup, &Connections[i % ARRAYSIZE(Connections)], i));
+    }
+    ASSERT_EQ(CidCount, Lookup.CidCount);
+
+    //
+    // Duplicates are rejected and report the owner.
+    //
+    uint8_t Data[QUIC_MAX_CONNECTION_ID_LENGTH_V1];
+    uint8_t Length = MakeCid(9, Data);
+    QUIC_CID_HASH_ENTRY* Duplicate = QuicCidNewSource(&Connections[0], Length, Data);
+    ASSERT_NE(nullptr, Duplicate);
+    QUIC_CONNECTION* Collision = NULL;
+    ASSERT_FALSE(QuicLookupAddLocalCid(&Lookup, Duplicate, &Collision));
+    ASSERT_EQ(&Connections[1], Collision);
+    ReleaseLookupResult(Collision);
+    CXPLAT_FREE(Duplicate, QUIC_POOL_CIDHASH);
+
+    for (uint64_t i = 0; i < CidCount; i++) {
+        ASSERT_EQ(&Connections[i % ARRAYSIZE(Connections)], Find(&Lookup, i));
+    }
+    ASSERT_EQ(nullptr, Find(&Lookup, CidCount));
+
+    //
+    // Remove every third CID of the first connection, leaving tombstones in
+    // the middle of the probe sequences of the rest.
+    //
+    uint64_t Removed = 0;
+    CXPLAT_SLIST_ENTRY** Link = &Connections[0].SourceCids.Next;
+    while (*Link != NULL) {
+        QUIC_CID_HASH_ENTRY* SourceCid =
+            CXPLAT_CONTAINING_RECORD(*Link, QUIC_CID_HASH_ENTRY, Link);
+        uint64_t Value;
+        CxPlatCopyMemory(
+            &Value,
+            SourceCid->CID.Data + MsQuicLib.CidServerIdLength + QUIC_CID_PID_LENGTH,
+            sizeof(Value));
+        if (Value % 3 == 0) {
+            QuicLookupRemoveLocalCid(&Lookup, SourceCid, Link);
+            CXPLAT_FREE(SourceCid, QUIC_POOL_CIDHASH);
+            Removed++;
+        } else {
+            Link = &(*Link)->Next;
+        }
+    }
+    ASSERT_EQ(CidCount - Removed, Lookup.CidCount);
+
+    for (uint64_t i = 0; i < CidCount; i++) {
+        if (i % ARRAYSIZE(Connections) == 0 && i % 3 == 0) {
+            ASSERT_EQ(nullptr, Find(&Lookup, i));
+        } else {
+            ASSERT_EQ(&Connections[i % ARRAYSIZE(Connections)], Find(&Lookup, i));
+        }
+    }
+
+    //
+    // Adding them back reuses the tombstones.
+    //
+    for (uint64_t i = 0; i < CidCount; i += 3 * ARRAYSIZE(Connections)) {
+        ASSERT_NE(nullptr, AddCid(&Lookup, &Connections[0], i));
+    }
+    for (uint64_t i = 0; i < CidCount; i++) {
+        ASSERT_EQ(&Connections[i % ARRAYSIZE(Connections)], Find(&Lookup, i));
+    }
+
+    for (uint32_t i = 0; i < ARRAYSIZE(Connections); i++) {
+        QuicLookupRemoveLocalCids(&Lookup, &Connections[i]);
+        ASSERT_EQ(1, Connections[i].RefCount);
+    }
+    ASSERT_EQ(0u, Lookup.CidCount);
+    ASSERT_EQ(0, Lookup.ReclaimPending);
+    QuicLookupUninitialize(&Lookup);
+}
+
+TEST_F(LookupTest, MoveLocalConnectionIDs)
+{
+    QUIC_LOOKUP Source, Dest;
+    QuicLookupInitialize(&Source);
+    QuicLookupInitialize(&Dest);
+    ASSERT_TRUE(QuicLookupMaximizePartitioning(&Source));
+
+    QUIC_CONNECTION Connection;
+    InitializeMockConnection(&Connection);
+
+    for (uint64_t i = 0; i < 20; i++) {
+        ASSERT_NE(nullptr, AddCid(&Source, &Connection, i));
+    }
+
+    QuicLookupMoveLocalConnectionIDs(&Source, &Dest, &Connection);
+    ASSERT_EQ(0u, Source.CidCount);
+    ASSERT_EQ(20u, Dest.CidCount);
+    for (uint64_t i = 0; i < 20; i++) {
+        ASSERT_EQ(nullptr, Find(&Source, i));
+        ASSERT_EQ(&Connection, Find(&Dest, i));
+    }
+
+    QuicLookupRemoveLocalCids(&Dest, &Connection);
+    ASSERT_EQ(1, Connection.RefCount);
+    QuicLookupUninitialize(&Dest);
+    QuicLookupUninitialize(&Source);
+}
+
+struct LookupBenchmarkContext {
+    QUIC_LOOKUP* Lookup;
+    QUIC_CONNECTION* Connections;
+    uint32_t ConnectionCount;
+    uint64_t CidCount;
+    long volatile* ReadyCount;
+    uint32_t ThreadCount;
+    BOOLEAN volatile* Done;
+    uint64_t Lookups;
+    uint64_t ElapsedUs;
+    bool Failed;
+};
+
+//
+// Looks up the stable CIDs until told to stop. Each must always be found,
+// whatever the writer is doing at the same time.
+//
+static
+CXPLAT_THREAD_CALLBACK(LookupBenchmarkReader, Context)
+{
+    auto Ctx = (LookupBenchmarkContext*)Context;
+    uint8_t Cids[64][QUIC_MAX_CONNECTION_ID_LENGTH_V1];
+    QUIC_CONNECTION* Expected[64];
+    uint8_t Length = 0;
+    for (uint64_t i = 0; i < 64; i++) {
+        uint64_t Value = (i * 7919) % Ctx->CidCount;
+        Length = MakeCid(Value, Cids[i]);
+        Expected[i] = &Ctx->Connections[Value % Ctx->ConnectionCount];
+    }
+
+    InterlockedIncrement(Ctx->ReadyCount);
+    while ((uint32_t)*Ctx->ReadyCount < Ctx->ThreadCount) {
+        CxPlatSchedulerYield();
+    }
+
+    uint64_t TimeStart = CxPlatTimeUs64();
+    uint64_t Lookups = 0;
+    while (!*Ctx->Done) {
+        for (uint32_t i = 0; i < 64; i++) {
+            QUIC_CONNECTION* Connection =
+                QuicLookupFindConnectionByLocalCid(Ctx->Lookup, Cids[i], Length);
+            if (Connection != Expected[i]) {
+                Ctx->Failed = true;
+            }
+            if (Connection != NULL) {
+                ReleaseLookupResult(Connection);
+            }
+        }
+        Lookups += 64;
+    }
+    Ctx->ElapsedUs = CxPlatTimeDiff64(TimeStart, CxPlatTimeUs64());
+    Ctx->Lookups = Lookups;
+    CXPLAT_THREAD_RETURN(0);
+}
+
+class LookupBenchmarkTest : public LookupTest {
+protected:
+    //
+    // Runs ReaderCount threads looking up the CIDs of a set of connections,
+    // while this thread keeps adding and removing CIDs of another one for
+    // DurationMs.
+    //
+    void
+    Run(
+        _In_ uint32_t ReaderCount,
+        _In_ uint32_t DurationMs
+        )
+    {
+        const uint64_t CidCount = 4096;
+        const uint32_t ConnectionCount = 64;
+
+        QUIC_LOOKUP Lookup;
+        QuicLookupInitialize(&Lookup);
+        ASSERT_TRUE(QuicLookupMaximizePartitioning(&Lookup));
+
+        QUIC_CONNECTION* Stable = new(std::nothrow) QUIC_CONNECTION[ConnectionCount];
+        QUIC_CONNECTION* Churn = new(std::nothrow) QUIC_CONNECTION;
+        ASSERT_NE(nullptr, Stable);
+        ASSERT_NE(nullptr, Churn);
+        for (uint32_t i = 0; i < ConnectionCount; i++) {
+            InitializeMockConnection(&Stable[i]);
+        }
+        InitializeMockConnection(Churn);
+        for (uint64_t i = 0; i < CidCount; i++) {
+            ASSERT_NE(nullptr, AddCid(&Lookup, &Stable[i % ConnectionCount], i));
+        }
+
+        LookupBenchmarkContext* Contexts = new(std::nothrow) LookupBenchmarkContext[ReaderCount];
+        CXPLAT_THREAD* Threads = new(std::nothrow) CXPLAT_THREAD[ReaderCount];
+        ASSERT_NE(nullptr, Contexts);
+        ASSERT_NE(nullptr, Threads);
+        long volatile ReadyCount = 0;
+        BOOLEAN volatile Done = FALSE;
+
+        for (uint32_t i = 0; i < ReaderCount; ++i) {
+            Contexts[i] = { &Lookup, Stable, ConnectionCount, CidCount, &ReadyCount, ReaderCount, &Done, 0, 0, false };
+            CXPLAT_THREAD_CONFIG Config = { 0, 0, NULL, LookupBenchmarkReader, &Contexts[i] };
+            ASSERT_TRUE(QUIC_SUCCEEDED(CxPlatThreadCreate(&Config, &Threads[i])));
+        }
+        while ((uint32_t)ReadyCount < ReaderCount) {
+            CxPlatSchedulerYield();
+        }
+
+        //
+        // Churn enough CIDs at once to keep growing and rebuilding tables.
+        //
+        uint64_t Writes = 0;
+        uint64_t TimeStart = CxPlatTimeUs64();
+        while (CxPlatTimeDiff64(TimeStart, CxPlatTimeUs64()) < (uint64_t)DurationMs * 1000) {
+            for (uint64_t i = 0; i < 64; i++) {
+                ASSERT_NE(nullptr, AddCid(&Lookup, Churn, CidCount + Writes + i));
+            }
+            while (Churn->SourceCids.Next != NULL) {
+                QUIC_CID_HASH_ENTRY* SourceCid =
+                    CXPLAT_CONTAINING_RECORD(Churn->SourceCids.Next, QUIC_CID_HASH_ENTRY, Link);
+                QuicLookupRemoveLocalCid(&Lookup, SourceCid, &Churn->SourceCids.Next);
+                CXPLAT_FREE(SourceCid, QUIC_POOL_CIDHASH);
+            }
+            Writes += 64;
+        }
+        Done = TRUE;
+
+        uint64_t Lookups = 0;
+        uint64_t MaxElapsedUs = 0;
+        for (uint32_t i = 0; i < ReaderCount; ++i) {
+            CxPlatThreadWait(&Threads[i]);
+            CxPlatThreadDelete(&Threads[i]);
+            ASSERT_FALSE(Contexts[i].Failed);
+            Lookups += Contexts[i].Lookups;
+            if (Contexts[i].ElapsedUs > MaxElapsedUs) {
+                MaxElapsedUs = Contexts[i].ElapsedUs;
+            }
+        }
+
+        const std::string Prefix = "Readers" + std::to_string(ReaderCount);
+        RecordBenchmarkResult(
+            Prefix + "MLookupsPerSec",
+            MaxElapsedUs == 0 ? 0.0 : (double)Lookups / MaxElapsedUs);
+        RecordBenchmarkResult(
+            Prefix + "NsPerLookup",
+            Lookups == 0 ? 0.0 : (double)MaxElapsedUs * 1000 * ReaderCount / Lookups);
+        RecordBenchmarkResult(
+            Prefix + "KCidAddRemovePerSec",
+            MaxElapsedUs == 0 ? 0.0 : (double)Writes * 1000 / MaxElapsedUs);
+
+        for (uint32_t i = 0; i < ConnectionCount; i++) {
+            QuicLookupRemoveLocalCids(&Lookup, &Stable[i]);
+        }
+
+        //
+        // Whatever the readers left behind is freed by the last writer.
+        //
+        ASSERT_EQ(0, Lookup.ReclaimPending);
+        for (uint32_t i = 0; i < ConnectionCount; i++) {
+            ASSERT_EQ(1, Stable[i].RefCount);
+        }
+        ASSERT_EQ(1, Churn->RefCount);
+        QuicLookupUninitialize(&Lookup);
+
+        delete [] Threads;
+        delete [] Contexts;
+        delete Churn;
+        delete [] Stable;
+    }
+};
+
+//
+// The benchmarks are only run explicitly (--gtest_also_run_disabled_tests);
+// the longer one gives more stable numbers.
+//
+
+TEST_F(LookupBenchmarkTest, DISABLED_ConcurrentReaders)
+{
+    for (uint32_t ReaderCount = 1; ReaderCount <= 8; ReaderCount *= 2) {
+        Run(ReaderCount, 100);
+    }
+}
+
+TEST_F(LookupBenchmarkTest, DISABLED_ConcurrentReadersLong)
+{
+    for (uint32_t ReaderCount = 1; ReaderCount <= 64; ReaderCount *= 2) {
+        Run(ReaderCount, 2000);
+    }
+}
@@ -13,3 +13,280 @@ Abstract:
 #ifdef QUIC_CLOG
 #include "LossDetectionTest.cpp.clog.h"
 #endif
+
+extern "C"
+void
+QuicLossDetectionProcessAckBlocks(
+    _In_ QUIC_LOSS_DETECTION* LossDetection,
+    _In_ QUIC_PATH* Path,
+    _In_ QUIC_RX_PACKET* Packet,
+    _In_ QUIC_ENCRYPT_LEVEL EncryptLevel,
+    _In_ uint64_t AckDelay,
+    _In_ QUIC_RANGE* AckBlocks,
+    _Out_ BOOLEAN* InvalidAckBlock,
+    _In_opt_ QUIC_ACK_ECN_EX* Ecn
+    );
+
+//
+// Drives the loss detection module of a minimal connection which is marked as
+// closed, so nothing gets queued to a worker, and which only sends 1-RTT PING
+// packets.
+//
+struct LossDetectionTest : public ::testing::Test
+{
+    QUIC_CONNECTION* Connection {nullptr};
+    QUIC_PARTITION* Partition {nullptr};
+    QUIC_PACKET_SPACE* PacketSpace {nullptr};
+    QUIC_RX_PACKET RxPacket;
+    QUIC_RANGE AckBlocks;
+    uint64_t NextPacketNumber {0};
+
+    void SetUp() override {
+        Connection = new(std::nothrow) QUIC_CONNECTION;
+        Partition = new(std::nothrow) QUIC_PARTITION;
+        PacketSpace = new(std::nothrow) QUIC_PACKET_SPACE;
+        ASSERT_NE(nullptr, Connection);
+        ASSERT_NE(nullptr, Partition);
+        ASSERT_NE(nullptr, PacketSpace);
+        CxPlatZeroMemory(Connection, sizeof(*Connection));
+        CxPlatZeroMemory(Partition, sizeof(*Partition));
+        CxPlatZeroMemory(PacketSpace, sizeof(*PacketSpace));
+        CxPlatZeroMemory(&RxPacket, sizeof(RxPacket));
+        QuicSentPacketPoolInitialize(&Partition->SentPacketPool);
+
+        Connection->_.Type = QUIC_HANDLE_TYPE_CONNECTION_SERVER;
+        Connection->Partition = Partition;
+        Connection->State.ClosedLocally = TRUE;
+        Connection->Packets[QUIC_ENCRYPT_LEVEL_1_RTT] = PacketSpace;
+        Connection->EarliestExpirationTime = UINT64_MAX;
+        for (uint32_t i = 0; i < QUIC_CONN_TIMER_COUNT; ++i) {
+            Connection->ExpirationTimes[i] = UINT64_MAX;
+        }
+        Connection->PeerTransportParams.MaxAckDelay = QUIC_TP_MAX_ACK_DELAY_DEFAULT;
+        Connection->Send.SkippedPacketNumber = UINT64_MAX;
+        Connection->Send.FlushOperationPending = TRUE;
+        CxPlatListInitializeHead(&Connection->Send.SendStreams);
+
+        QUIC_PATH* Path = &Connection->Paths[0];
+        Connection->PathsCount = 1;
+        Path->IsActive = TRUE;
+        Path->IsPeerValidated = TRUE;
+        Path->IsMinMtuValidated = TRUE;
+        Path->Mtu = 1280;
+        Path->EcnValidationState = ECN_VALIDATION_FAILED;
+        Path->GotFirstRttSample = TRUE;
+        Path->SmoothedRtt = MS_TO_US(QUIC_INITIAL_RTT);
+        Path->RttVariance = Path->SmoothedRtt / 2;
+        Path->MinRtt = UINT64_MAX;
+
+        QUIC_SETTINGS_INTERNAL Settings{};
+        Settings.InitialWindowPackets = 1000000;
+        Settings.SendIdleTimeoutMs = 1000;
+        CubicCongestionControlInitialize(&Connection->CongestionControl, &Settings);
+
+        QuicLossDetectionInitialize(&Connection->LossDetection);
+        QuicRangeInitialize(QUIC_MAX_RANGE_DECODE_ACKS, &AckBlocks);
+    }
+
+    void TearDown() override {
+        if (Connection != nullptr) {
+            QuicRangeUninitialize(&AckBlocks);
+            QuicLossDetectionUninitialize(&Connection->LossDetection);
+            QuicSentPacketPoolUninitialize(&Partition->SentPacketPool);
+        }
+        delete PacketSpace;
+        delete Partition;
+        delete Connection;
+    }
+
+    void Send(uint32_t Count) {
+        QUIC_MAX_SENT_PACKET_METADATA Temp;
+        for (uint32_t i = 0; i < Count; ++i) {
+            CxPlatZeroMemory(&Temp, sizeof(Temp));
+            Temp.Metadata.PacketId = NextPacketNumber;
+            Temp.Metadata.PacketNumber = NextPacketNumber++;
+            Temp.Metadata.SentTime = CxPlatTimeUs64();
+            Temp.Metadata.PacketLength = 1200;
+            Temp.Metadata.Flags.KeyType = QUIC_PACKET_KEY_1_RTT;
+            Temp.Metadata.Flags.IsAckEliciting = TRUE;
+            Temp.Metadata.FrameCount = 1;
+            Temp.Metadata.Frames[0].Type = QUIC_FRAME_PING;
+            Connection->Send.NextPacketNumber = NextPacketNumber;
+            QuicLossDetectionOnPacketSent(
+                &Connection->LossDetection, &Connection->Paths[0], &Temp.Metadata);
+        }
+    }
+
+    void Ack(uint64_t Low, uint64_t Count) {
+        BOOLEAN Updated, Invalid;
+        QuicRangeReset(&AckBlocks);
+        ASSERT_NE(nullptr, QuicRangeAddRange(&AckBlocks, Low, Count, &Updated));
+        QuicLossDetectionProcessAckBlocks(
+            &Connection->LossDetection,
+            &Connection->Paths[0],
+            &RxPacket,
+            QUIC_ENCRYPT_LEVEL_1_RTT,
+            0,
+            &AckBlocks,
+            &Invalid,
+            NULL);
+        ASSERT_FALSE(Invalid);
+    }
+
+    uint32_t CountPackets(QUIC_SENT_PACKET_METADATA* Packet) {
+        uint32_t Count = 0;
+        for (; Packet != NULL; Packet = Packet->Next) {
+            Count++;
+        }
+        return Count;
+    }
+
+    //
+    // Acknowledges 2 packets per ACK frame, in order.
+    //
+    void BenchmarkInOrder(uint32_t PacketCount) {
+        uint64_t TimeStart = CxPlatTimeUs64();
+        Send(PacketCount);
+        uint64_t SendTime = CxPlatTimeDiff64(TimeStart, CxPlatTimeUs64());
+
+        TimeStart = CxPlatTimeUs64();
+        for (uint32_t i = 0; i < PacketCount; i += 2) {
+            Ack(i, 2);
+        }
+        uint64_t AckTime = CxPlatTimeDiff64(TimeStart, CxPlatTimeUs64());
+        ASSERT_EQ(0u, Connection->LossDetection.PacketsInFlight);
+        ASSERT_EQ(nullptr, Connection->LossDetection.SentPackets);
+
+        RecordBenchmarkResult("SendNsPerPacket", (double)SendTime * 1000 / PacketCount);
+        RecordBenchmarkResult("NsPerAckFrame", (double)AckTime * 1000 / (PacketCount / 2));
+    }
+
+    //
+    // Acknowledges each odd packet and then each even packet, one per ACK
+    // frame. Most of the even packets are declared lost by then, so they are
+    // found in the lost packet list.
+    //
+    void BenchmarkReordered(uint32_t PacketCount) {
+        Send(PacketCount);
+
+        uint64_t TimeStart = CxPlatTimeUs64();
+        for (uint32_t i = 1; i < PacketCount; i += 2) {
+            Ack(i, 1);
+        }
+        for (uint32_t i = 0; i < PacketCount; i += 2) {
+            Ack(i, 1);
+        }
+        uint64_t AckTime = CxPlatTimeDiff64(TimeStart, CxPlatTimeUs64());
+        ASSERT_EQ(0u, Connection->LossDetection.PacketsInFlight);
+        ASSERT_EQ(nullptr, Connection->LossDetection.SentPackets);
+
+        RecordBenchmarkResult("NsPerAckFrame", (double)AckTime * 1000 / PacketCount);
+    }
+};
+
+TEST_F(LossDetectionTest, AckInOrder)
+{
+    Send(100);
+    ASSERT_EQ(100u, Connection->LossDetection.PacketsInFlight);
+    ASSERT_EQ(100u, CountPackets(Connection->LossDetection.SentPackets));
+    for (uint64_t i = 0; i < 100; ++i) {
+        ASSERT_NE(nullptr, QuicSentPacketRingLookup(&Connection->LossDetection.SentPacketRing, i));
+    }
+
+    Ack(0, 50);
+    ASSERT_EQ(50u, Connection->LossDetection.PacketsInFlight);
+    ASSERT_EQ(49u, Connection->LossDetection.LargestAck);
+    ASSERT_EQ(nullptr, QuicSentPacketRingLookup(&Connection->LossDetection.SentPacketRing, 49));
+    ASSERT_NE(nullptr, QuicSentPacketRingLookup(&Connection->LossDetection.SentPacketRing, 50));
+
+    Ack(50, 50);
+    ASSERT_EQ(0u, Connection->LossDetection.PacketsInFlight);
+    ASSERT_EQ(nullptr, Connection->LossDetection.SentPackets);
+    ASSERT_EQ(nullptr, Connection->LossDetection.LostPackets);
+}
+
+TEST_F(LossDetectionTest, AckWithGapDeclaresLoss)
+{
+    Send(10);
+    Ack(7, 3);
+    ASSERT_EQ(9u, Connection->LossDetection.LargestAck);
+
+    //
+    // Packets more than the reordering threshold below the largest ACK are
+    // lost; the rest are still outstanding.
+    //
+    uint32_t Lost = CountPackets(Connection->LossDetection.LostPackets);
+    uint32_t Outstanding = CountPackets(Connection->LossDetection.SentPackets);
+    ASSERT_EQ(7u, Lost + Outstanding);
+    ASSERT_EQ(9u - QUIC_PACKET_REORDER_THRESHOLD, Lost);
+    ASSERT_EQ(Outstanding, Connection->LossDetection.PacketsInFlight);
+
+    //
+    // A late ACK for the lost packets is a spurious loss.
+    //
+    Ack(0, 7);
+    ASSERT_EQ(Lost, Connection->Stats.Send.SpuriousLostPackets);
+    ASSERT_EQ(nullptr, Connection->LossDetection.SentPackets);
+    ASSERT_EQ(nullptr, Connection->LossDetection.LostPackets);
+}
+
+TEST_F(LossDetectionTest, AckWithUntrackedPacket)
+{
+    //
+    // While some outstanding packet isn't in the ring, acknowledged packets
+    // are found in the sent and lost packets lists instead.
+    //
+    QUIC_SENT_PACKET_RING* Ring = &Connection->LossDetection.SentPacketRing;
+    Send(10);
+    Ring->UntrackedCount++;
+    Send(10);
+    Ack(3, 2);
+    Ack(12, 8);
+    ASSERT_EQ(19u, Connection->LossDetection.LargestAck);
+    uint32_t Lost = CountPackets(Connection->LossDetection.LostPackets);
+    ASSERT_NE(0u, Lost);
+    ASSERT_EQ(10u, CountPackets(Connection->LossDetection.SentPackets) + Lost);
+
+    Ack(0, 12);
+    ASSERT_EQ(Lost, Connection->Stats.Send.SpuriousLostPackets);
+    ASSERT_EQ(nullptr, Connection->LossDetection.SentPackets);
+    ASSERT_EQ(nullptr, Connection->LossDetection.LostPackets);
+    ASSERT_EQ(0u, Ring->Count);
+
+    //
+    // Once it's gone, the ring is used again.
+    //
+    Ring->UntrackedCount--;
+    Send(1);
+    ASSERT_TRUE(QuicSentPacketRingIsComplete(Ring));
+    ASSERT_EQ(1u, Ring->Count);
+    Ack(20, 1);
+    ASSERT_EQ(nullptr, Connection->LossDetection.SentPackets);
+    ASSERT_EQ(0u, Ring->Count);
+}
+
+//
+// The benchmarks are only run explicitly (--gtest_also_run_disabled_tests).
+// The larger ones take a long time with list based lookups (and in debug
+// builds, where the lists are validated on every change).
+//
+
+TEST_F(LossDetectionTest, DISABLED_BenchmarkInOrder10K)
+{
+    BenchmarkInOrder(10000);
+}
+
+TEST_F(LossDetectionTest, DISABLED_BenchmarkReordered10K)
+{
+    BenchmarkReordered(10000);
+}
+
+TEST_F(LossDetectionTest, DISABLED_BenchmarkInOrder100K)
+{
+    BenchmarkInOrder(100000);
+}
+
+TEST_F(LossDetectionTest, DISABLED_BenchmarkReordered100K)
+{
+    BenchmarkReordered(100000);
+}
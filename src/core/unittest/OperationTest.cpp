@@ -13,3 +13,366 @@ Abstract:
 #ifdef QUIC_CLOG
 #include "OperationTest.cpp.clog.h"
 #endif
+
+struct TestOperation {
+    QUIC_OPERATION Oper;
+    uint32_t Producer;
+    uint32_t Sequence;
+};
+
+static
+TestOperation*
+TestOperationFromOper(
+    QUIC_OPERATION* Oper
+    )
+{
+    return CXPLAT_CONTAINING_RECORD(Oper, TestOperation, Oper);
+}
+
+struct OperationTest : public ::testing::Test {
+    QUIC_PARTITION* Partition {nullptr};
+    QUIC_OPERATION_QUEUE OperQ;
+
+    void SetUp() override {
+        //
+        // The queue only touches the partition's perf counters.
+        //
+        Partition = (QUIC_PARTITION*)CXPLAT_ALLOC_NONPAGED(sizeof(QUIC_PARTITION), QUIC_POOL_TEST);
+        ASSERT_NE(nullptr, Partition);
+        CxPlatZeroMemory(Partition, sizeof(QUIC_PARTITION));
+        QuicOperationQueueInitialize(&OperQ);
+    }
+
+    void TearDown() override {
+        QuicOperationQueueUninitialize(&OperQ);
+        CXPLAT_FREE(Partition, QUIC_POOL_TEST);
+    }
+
+    static void InitOperations(TestOperation* Opers, uint32_t Count, uint32_t Producer = 0) {
+        CxPlatZeroMemory(Opers, sizeof(TestOperation) * Count);
+        for (uint32_t i = 0; i < Count; ++i) {
+            Opers[i].Oper.Type = QUIC_OPER_TYPE_TIMER_EXPIRED;
+            Opers[i].Oper.FreeAfterProcess = FALSE;
+            Opers[i].Producer = Producer;
+            Opers[i].Sequence = i;
+        }
+    }
+
+    uint32_t DequeueSequence() {
+        QUIC_OPERATION* Oper = QuicOperationDequeue(&OperQ, Partition);
+        return Oper == nullptr ? UINT32_MAX : TestOperationFromOper(Oper)->Sequence;
+    }
+};
+
+TEST_F(OperationTest, EmptyQueue)
+{
+    ASSERT_EQ(nullptr, QuicOperationDequeue(&OperQ, Partition));
+    ASSERT_FALSE(QuicOperationHasPriority(&OperQ));
+}
+
+TEST_F(OperationTest, StartProcessing)
+{
+    TestOperation Opers[3];
+    InitOperations(Opers, ARRAYSIZE(Opers));
+
+    //
+    // Only the enqueue that finds the queue idle starts processing. The queue
+    // stays active until a dequeue finds it empty.
+    //
+    ASSERT_TRUE(QuicOperationEnqueue(&OperQ, Partition, &Opers[0].Oper));
+    ASSERT_FALSE(QuicOperationEnqueue(&OperQ, Partition, &Opers[1].Oper));
+    ASSERT_EQ(0u, DequeueSequence());
+    ASSERT_EQ(1u, DequeueSequence());
+    ASSERT_FALSE(QuicOperationEnqueuePriority(&OperQ, Partition, &Opers[2].Oper));
+    ASSERT_EQ(2u, DequeueSequence());
+    ASSERT_EQ(UINT32_MAX, DequeueSequence());
+
+    ASSERT_TRUE(QuicOperationEnqueueFront(&OperQ, Partition, &Opers[0].Oper));
+    ASSERT_EQ(0u, DequeueSequence());
+    ASSERT_EQ(UINT32_MAX, DequeueSequence());
+
+    ASSERT_EQ(4, Partition->PerfCounters[QUIC_PERF_COUNTER_CONN_OPER_QUEUED]);
+    ASSERT_EQ(0, Partition->PerfCounters[QUIC_PERF_COUNTER_CONN_OPER_QUEUE_DEPTH]);
+}
+
+TEST_F(OperationTest, PriorityAndFrontOrder)
+{
+    TestOperation Opers[5];
+    InitOperations(Opers, ARRAYSIZE(Opers));
+
+    ASSERT_TRUE(QuicOperationEnqueue(&OperQ, Partition, &Opers[3].Oper));
+    ASSERT_FALSE(QuicOperationEnqueue(&OperQ, Partition, &Opers[4].Oper));
+    ASSERT_FALSE(QuicOperationHasPriority(&OperQ));
+    ASSERT_FALSE(QuicOperationEnqueuePriority(&OperQ, Partition, &Opers[1].Oper));
+    ASSERT_FALSE(QuicOperationEnqueueFront(&OperQ, Partition, &Opers[0].Oper));
+    ASSERT_FALSE(QuicOperationEnqueuePriority(&OperQ, Partition, &Opers[2].Oper));
+    ASSERT_TRUE(QuicOperationHasPriority(&OperQ));
+
+    ASSERT_EQ(0u, DequeueSequence());
+    ASSERT_EQ(1u, DequeueSequence());
+    ASSERT_TRUE(QuicOperationHasPriority(&OperQ));
+    ASSERT_EQ(2u, DequeueSequence());
+    ASSERT_FALSE(QuicOperationHasPriority(&OperQ));
+    ASSERT_EQ(3u, DequeueSequence());
+    ASSERT_EQ(4u, DequeueSequence());
+    ASSERT_EQ(UINT32_MAX, DequeueSequence());
+}
+
+TEST_F(OperationTest, PriorityJumpsQueuedWork)
+{
+    TestOperation Opers[4];
+    InitOperations(Opers, ARRAYSIZE(Opers));
+
+    //
+    // A priority operation enqueued while the consumer is part way through
+    // the list runs before the remaining normal operations.
+    //
+    ASSERT_TRUE(QuicOperationEnqueue(&OperQ, Partition, &Opers[0].Oper));
+    ASSERT_FALSE(QuicOperationEnqueue(&OperQ, Partition, &Opers[2].Oper));
+    ASSERT_FALSE(QuicOperationEnqueue(&OperQ, Partition, &Opers[3].Oper));
+    ASSERT_EQ(0u, DequeueSequence());
+    ASSERT_FALSE(QuicOperationEnqueuePriority(&OperQ, Partition, &Opers[1].Oper));
+    ASSERT_EQ(1u, DequeueSequence());
+    ASSERT_EQ(2u, DequeueSequence());
+    ASSERT_FALSE(QuicOperationEnqueue(&OperQ, Partition, &Opers[0].Oper));
+    ASSERT_EQ(3u, DequeueSequence());
+    ASSERT_EQ(0u, DequeueSequence());
+    ASSERT_EQ(UINT32_MAX, DequeueSequence());
+}
+
+TEST_F(OperationTest, Clear)
+{
+    TestOperation Opers[3];
+    InitOperations(Opers, ARRAYSIZE(Opers));
+
+    ASSERT_TRUE(QuicOperationEnqueue(&OperQ, Partition, &Opers[0].Oper));
+    ASSERT_EQ(0u, DequeueSequence());
+    ASSERT_FALSE(QuicOperationEnqueue(&OperQ, Partition, &Opers[1].Oper));
+    ASSERT_FALSE(QuicOperationHasPriority(&OperQ));
+    ASSERT_FALSE(QuicOperationEnqueuePriority(&OperQ, Partition, &Opers[2].Oper));
+
+    //
+    // Stack operations are only "completed" by Clear, which must also leave the
+    // queue idle.
+    //
+    Opers[1].Oper.Type = QUIC_OPER_TYPE_API_CALL;
+    Opers[2].Oper.Type = QUIC_OPER_TYPE_API_CALL;
+    QUIC_API_CONTEXT ApiCtx;
+    CxPlatZeroMemory(&ApiCtx, sizeof(ApiCtx));
+    ApiCtx.Type = QUIC_API_TYPE_CONN_CLOSE;
+    Opers[1].Oper.API_CALL.Context = &ApiCtx;
+    Opers[2].Oper.API_CALL.Context = &ApiCtx;
+    QuicOperationQueueClear(&OperQ, Partition);
+
+    ASSERT_EQ(0, Partition->PerfCounters[QUIC_PERF_COUNTER_CONN_OPER_QUEUE_DEPTH]);
+    ASSERT_TRUE(QuicOperationEnqueue(&OperQ, Partition, &Opers[0].Oper));
+    ASSERT_EQ(0u, DequeueSequence());
+    ASSERT_EQ(UINT32_MAX, DequeueSequence());
+}
+
+TEST_F(OperationTest, ClearStreamSends)
+{
+    CxPlatPoolInitialize(FALSE, sizeof(QUIC_API_CONTEXT), QUIC_POOL_API_CTX, &Partition->ApiContextPool);
+    CxPlatPoolInitialize(FALSE, sizeof(QUIC_OPERATION), QUIC_POOL_OPER, &Partition->OperPool);
+
+    //
+    // The streams are never freed or shut down here, so they only need enough
+    // state for their references.
+    //
+    QUIC_CONNECTION* Connection = new(std::nothrow) QUIC_CONNECTION;
+    QUIC_STREAM* Streams = new(std::nothrow) QUIC_STREAM[2];
+    ASSERT_NE(nullptr, Connection);
+    ASSERT_NE(nullptr, Streams);
+    CxPlatZeroMemory(Streams, sizeof(QUIC_STREAM) * 2);
+    for (uint32_t i = 0; i < 2; ++i) {
+        Streams[i].Connection = Connection;
+        Streams[i].Flags.Started = TRUE;
+        CxPlatRefInitialize(&Streams[i].RefCount);
+#if DEBUG
+        for (uint32_t j = 0; j < QUIC_STREAM_REF_COUNT; j++) {
+            CxPlatRefInitialize(&Streams[i].RefTypeBiasedCount[j]);
+        }
+#endif
+    }
+
+    //
+    // One single send and one batch covering both streams, each holding an
+    // operation reference on every stream it names.
+    //
+    QUIC_OPERATION* Send = QuicOperationAlloc(Partition, QUIC_OPER_TYPE_API_CALL);
+    ASSERT_NE(nullptr, Send);
+    Send->API_CALL.Context->Type = QUIC_API_TYPE_STRM_SEND;
+    Send->API_CALL.Context->STRM_SEND.Stream = &Streams[0];
+    QuicStreamAddRef(&Streams[0], QUIC_STREAM_REF_OPERATION);
+
+    QUIC_OPERATION* Batch = QuicOperationAlloc(Partition, QUIC_OPER_TYPE_API_CALL);
+    ASSERT_NE(nullptr, Batch);
+    QUIC_API_CONTEXT* ApiCtx = Batch->API_CALL.Context;
+    ApiCtx->Type = QUIC_API_TYPE_STRM_SEND_BATCH;
+    ApiCtx->STRM_SEND_BATCH.Streams =
+        (QUIC_STREAM**)CXPLAT_ALLOC_NONPAGED(2 * sizeof(QUIC_STREAM*), QUIC_POOL_SEND_BATCH);
+    ASSERT_NE(nullptr, ApiCtx->STRM_SEND_BATCH.Streams);
+    ApiCtx->STRM_SEND_BATCH.StreamCount = 2;
+    for (uint32_t i = 0; i < 2; ++i) {
+        ApiCtx->STRM_SEND_BATCH.Streams[i] = &Streams[i];
+        QuicStreamAddRef(&Streams[i], QUIC_STREAM_REF_OPERATION);
+    }
+
+    ASSERT_TRUE(QuicOperationEnqueue(&OperQ, Partition, Send));
+    ASSERT_FALSE(QuicOperationEnqueue(&OperQ, Partition, Batch));
+
+    //
+    // Started streams are left alone by both; only the references go.
+    //
+    QuicOperationQueueClear(&OperQ, Partition);
+    ASSERT_EQ(0, Partition->PerfCounters[QUIC_PERF_COUNTER_CONN_OPER_QUEUE_DEPTH]);
+    for (uint32_t i = 0; i < 2; ++i) {
+        ASSERT_EQ(1, (int64_t)Streams[i].RefCount);
+        ASSERT_FALSE(Streams[i].Flags.LocalCloseReset);
+        ASSERT_FALSE(Streams[i].Flags.ShutdownComplete);
+    }
+
+    delete [] Streams;
+    delete Connection;
+    CxPlatPoolUninitialize(&Partition->OperPool);
+    CxPlatPoolUninitialize(&Partition->ApiContextPool);
+}
+
+struct OperationProducerContext {
+    QUIC_OPERATION_QUEUE* OperQ;
+    QUIC_PARTITION* Partition;
+    TestOperation* Opers;
+    uint32_t Count;
+    long volatile* ReadyCount;
+    uint32_t ThreadCount;
+    long volatile* ScheduleCount;
+    uint64_t ElapsedUs;
+};
+
+static
+CXPLAT_THREAD_CALLBACK(OperationProducerThread, Context)
+{
+    auto Ctx = (OperationProducerContext*)Context;
+
+    InterlockedIncrement(Ctx->ReadyCount);
+    while ((uint32_t)*Ctx->ReadyCount < Ctx->ThreadCount) {
+        CxPlatSchedulerYield();
+    }
+
+    uint64_t TimeStart = CxPlatTimeUs64();
+    for (uint32_t i = 0; i < Ctx->Count; ++i) {
+        if (QuicOperationEnqueue(Ctx->OperQ, Ctx->Partition, &Ctx->Opers[i].Oper)) {
+            //
+            // Stands in for QuicWorkerQueueConnection.
+            //
+            InterlockedIncrement(Ctx->ScheduleCount);
+        }
+    }
+    Ctx->ElapsedUs = CxPlatTimeDiff64(TimeStart, CxPlatTimeUs64());
+    CXPLAT_THREAD_RETURN(0);
+}
+
+static
+void
+OperationQueueBenchmark(
+    QUIC_OPERATION_QUEUE* OperQ,
+    QUIC_PARTITION* Partition,
+    uint32_t ThreadCount,
+    uint32_t Count
+    )
+{
+    //
+    // N producer threads (like app threads calling StreamSend) enqueue while
+    // this thread plays the worker: whenever an enqueue reports the queue went
+    // from idle to non-empty, it drains the queue until a dequeue comes back
+    // empty. Every operation must be seen exactly once, in per-producer order.
+    //
+    TestOperation* Opers = new(std::nothrow) TestOperation[(size_t)ThreadCount * Count];
+    OperationProducerContext* Contexts = new(std::nothrow) OperationProducerContext[ThreadCount];
+    CXPLAT_THREAD* Threads = new(std::nothrow) CXPLAT_THREAD[ThreadCount];
+    uint32_t* NextSequence = new(std::nothrow) uint32_t[ThreadCount];
+    ASSERT_NE(nullptr, Opers);
+    ASSERT_NE(nullptr, Contexts);
+    ASSERT_NE(nullptr, Threads);
+    ASSERT_NE(nullptr, NextSequence);
+    long volatile ReadyCount = 0;
+    long volatile ScheduleCount = 0;
+    const int64_t QueuedStart = Partition->PerfCounters[QUIC_PERF_COUNTER_CONN_OPER_QUEUED];
+
+    for (uint32_t i = 0; i < ThreadCount; ++i) {
+        OperationTest::InitOperations(Opers + (size_t)i * Count, Count, i);
+        NextSequence[i] = 0;
+        Contexts[i] = {
+            OperQ, Partition, Opers + (size_t)i * Count, Count,
+            &ReadyCount, ThreadCount, &ScheduleCount, 0 };
+        CXPLAT_THREAD_CONFIG Config = { 0, 0, NULL, OperationProducerThread, &Contexts[i] };
+        ASSERT_TRUE(QUIC_SUCCEEDED(CxPlatThreadCreate(&Config, &Threads[i])));
+    }
+
+    const uint64_t Total = (uint64_t)ThreadCount * Count;
+    uint64_t Dequeued = 0;
+    long Drains = 0;
+    bool OutOfOrder = false;
+    while (Dequeued < Total) {
+        if (*(long volatile*)&ScheduleCount == Drains) {
+            CxPlatSchedulerYield();
+            continue;
+        }
+        ++Drains;
+        QUIC_OPERATION* Oper;
+        while ((Oper = QuicOperationDequeue(OperQ, Partition)) != nullptr) {
+            TestOperation* TestOper = TestOperationFromOper(Oper);
+            if (TestOper->Sequence != NextSequence[TestOper->Producer]++) {
+                OutOfOrder = true;
+            }
+            ++Dequeued;
+        }
+    }
+
+    uint64_t MaxElapsedUs = 0;
+    for (uint32_t i = 0; i < ThreadCount; ++i) {
+        CxPlatThreadWait(&Threads[i]);
+        CxPlatThreadDelete(&Threads[i]);
+        if (Contexts[i].ElapsedUs > MaxElapsedUs) {
+            MaxElapsedUs = Contexts[i].ElapsedUs;
+        }
+    }
+
+    ASSERT_FALSE(OutOfOrder);
+    ASSERT_EQ(Total, Dequeued);
+    ASSERT_EQ(Drains, (long)ScheduleCount);
+    ASSERT_EQ(nullptr, QuicOperationDequeue(OperQ, Partition));
+    ASSERT_EQ((int64_t)Total, Partition->PerfCounters[QUIC_PERF_COUNTER_CONN_OPER_QUEUED] - QueuedStart);
+    ASSERT_EQ(0, Partition->PerfCounters[QUIC_PERF_COUNTER_CONN_OPER_QUEUE_DEPTH]);
+
+    const std::string Prefix = "Producers" + std::to_string(ThreadCount);
+    RecordBenchmarkResult(
+        Prefix + "MopsPerSec", MaxElapsedUs == 0 ? 0.0 : (double)Total / MaxElapsedUs);
+    RecordBenchmarkResult(
+        Prefix + "NsPerEnqueue", (double)MaxElapsedUs * 1000 * ThreadCount / Total);
+    RecordBenchmarkResult(Prefix + "Drains", (double)Drains);
+
+    delete [] NextSequence;
+    delete [] Threads;
+    delete [] Contexts;
+    delete [] Opers;
+}
+
+//
+// The benchmarks are only run explicitly (--gtest_also_run_disabled_tests).
+//
+
+TEST_F(OperationTest, DISABLED_ProducerBenchmark)
+{
+    for (uint32_t ThreadCount = 1; ThreadCount <= 8; ThreadCount *= 2) {
+        OperationQueueBenchmark(&OperQ, Partition, ThreadCount, 20000);
+    }
+}
+
+TEST_F(OperationTest, DISABLED_ProducerBenchmarkLarge)
+{
+    const uint32_t MaxThreadCount = CxPlatProcCount() * 2;
+    for (uint32_t ThreadCount = 1; ThreadCount <= MaxThreadCount; ThreadCount *= 2) {
+        OperationQueueBenchmark(&OperQ, Partition, ThreadCount, 1000000);
+    }
+}
@@ -13,3 +13,102 @@ Abstract:
 #ifdef QUIC_CLOG
 #include "PacketBuilderTest.cpp.clog.h"
 #endif
+
+//
+// Sets up just enough of a connection for QuicPacketBuilderInitialize, with
+// BBR pacing at Rate bytes per second over a 10ms RTT.
+//
+static void InitializePacingConnection(
+    QUIC_CONNECTION& Connection,
+    QUIC_CID_HASH_ENTRY& SourceCid,
+    QUIC_CID_LIST_ENTRY& DestCid,
+    uint64_t Rate)
+{
+    CxPlatZeroMemory(&Connection, sizeof(Connection));
+    CxPlatZeroMemory(&SourceCid, sizeof(SourceCid));
+    CxPlatZeroMemory(&DestCid, sizeof(DestCid));
+    Connection.SourceCids.Next = &SourceCid.Link;
+
+    QUIC_PATH* Path = &Connection.Paths[0];
+    Path->Mtu = 1280;
+    Path->IsActive = TRUE;
+    Path->DestCid = &DestCid;
+    Path->Allowance = UINT32_MAX;
+    Path->GotFirstRttSample = TRUE;
+    Path->SmoothedRtt = 10000;
+
+    QUIC_SETTINGS_INTERNAL Settings{};
+    Settings.InitialWindowPackets = 1000; // Larger than a paced RTT
+    Connection.Settings.PacingEnabled = TRUE;
+    BbrCongestionControlInitialize(&Connection.CongestionControl, &Settings);
+    QUIC_CONGESTION_CONTROL_BBR* Bbr = &Connection.CongestionControl.Bbr;
+    Bbr->MinRtt = Path->SmoothedRtt;
+    Bbr->PacingGain = 256; // GAIN_UNIT
+    QuicSlidingWindowExtremumUpdateMax(
+        &Bbr->BandwidthFilter.WindowedMaxFilter, Rate * 8, 0); // BW_UNIT
+
+    Connection.Send.LastFlushTimeValid = TRUE;
+    Connection.Send.LastFlushTime = CxPlatTimeUs64();
+}
+
+//
+// Scenario: With departure times in use, the builder schedules batches at the
+// congestion controller's pacing rate. It hands over what can depart within
+// one RTT of the end of the current schedule, and nothing once the schedule
+// is a full RTT ahead.
+//
+TEST(PacketBuilderTest, DepartureTimePacing)
+{
+    const uint64_t Rate = 1000000; // 10000 bytes per 10ms RTT
+    QUIC_CONNECTION Connection;
+    QUIC_CID_HASH_ENTRY SourceCid;
+    QUIC_CID_LIST_ENTRY DestCid;
+    QUIC_PACKET_BUILDER Builder;
+    const BOOLEAN SendTxTimeInUse = MsQuicLib.SendTxTimeInUse;
+    MsQuicLib.SendTxTimeInUse = TRUE;
+
+    //
+    // Nothing scheduled yet: the batch departs now, with a full RTT's worth.
+    //
+    InitializePacingConnection(Connection, SourceCid, DestCid, Rate);
+    CxPlatZeroMemory(&Builder, sizeof(Builder));
+    uint64_t Before = CxPlatTimeUs64();
+    ASSERT_TRUE(QuicPacketBuilderInitialize(&Builder, &Connection, &Connection.Paths[0]));
+    ASSERT_EQ(Rate, Builder.PacingRate);
+    ASSERT_GE(Builder.DepartureTimeUs, Before);
+    ASSERT_LE(Builder.DepartureTimeUs, CxPlatTimeUs64());
+    ASSERT_EQ(Rate * 10000 / 1000000, (uint64_t)Builder.SendAllowance);
+
+    //
+    // Half an RTT already scheduled: continue from there with at most the
+    // other half.
+    //
+    InitializePacingConnection(Connection, SourceCid, DestCid, Rate);
+    CxPlatZeroMemory(&Builder, sizeof(Builder));
+    Before = CxPlatTimeUs64();
+    Connection.Send.NextDepartureTimeUs = Before + 5000;
+    ASSERT_TRUE(QuicPacketBuilderInitialize(&Builder, &Connection, &Connection.Paths[0]));
+    ASSERT_EQ(Connection.Send.NextDepartureTimeUs, Builder.DepartureTimeUs);
+    ASSERT_GE((uint64_t)Builder.SendAllowance, Rate * 5000 / 1000000);
+    ASSERT_LT((uint64_t)Builder.SendAllowance, Rate * 10000 / 1000000);
+
+    //
+    // A full RTT scheduled: wait for the pacing timer.
+    //
+    InitializePacingConnection(Connection, SourceCid, DestCid, Rate);
+    CxPlatZeroMemory(&Builder, sizeof(Builder));
+    Connection.Send.NextDepartureTimeUs = CxPlatTimeUs64() + 10000;
+    ASSERT_TRUE(QuicPacketBuilderInitialize(&Builder, &Connection, &Connection.Paths[0]));
+    ASSERT_EQ(0u, Builder.SendAllowance);
+
+    //
+    // Without departure times, the usual pacing chunk applies instead.
+    //
+    MsQuicLib.SendTxTimeInUse = FALSE;
+    InitializePacingConnection(Connection, SourceCid, DestCid, Rate);
+    CxPlatZeroMemory(&Builder, sizeof(Builder));
+    ASSERT_TRUE(QuicPacketBuilderInitialize(&Builder, &Connection, &Connection.Paths[0]));
+    ASSERT_EQ(0u, Builder.PacingRate);
+
+    MsQuicLib.SendTxTimeInUse = SendTxTimeInUse;
+}
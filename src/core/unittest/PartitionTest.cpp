@@ -48,3 +48,191 @@ TEST(PartitionTest, RandomPartitionId)
 
     MsQuicLib.PartitionCount = OldPartitionCount;
 }
+
+struct PoolBenchmarkContext {
+    CXPLAT_POOL* Pools;
+    uint32_t PoolCount;
+    uint32_t Index;
+    uint32_t Iterations;
+    long volatile* ReadyCount;
+    uint32_t ThreadCount;
+    uint64_t ElapsedUs;
+    bool Failed;
+};
+
+#define POOL_BENCHMARK_BATCH_SIZE 16
+#define POOL_BENCHMARK_ENTRY_SIZE 128
+
+static
+CXPLAT_THREAD_CALLBACK(PoolBenchmarkThread, Context)
+{
+    auto Ctx = (PoolBenchmarkContext*)Context;
+    CXPLAT_POOL* Local = &Ctx->Pools[Ctx->Index % Ctx->PoolCount];
+    CXPLAT_POOL* Remote = &Ctx->Pools[(Ctx->Index + 1) % Ctx->PoolCount];
+    void* Entries[2 * POOL_BENCHMARK_BATCH_SIZE];
+
+    //
+    // Touch the local pool before anyone else does, so it is first in line for
+    // its magazines, then wait for all the other threads to do the same.
+    //
+    CxPlatPoolFree(CxPlatPoolAlloc(Local));
+    InterlockedIncrement(Ctx->ReadyCount);
+    while ((uint32_t)*Ctx->ReadyCount < Ctx->ThreadCount) {
+        CxPlatSchedulerYield();
+    }
+
+    uint64_t TimeStart = CxPlatTimeUs64();
+    for (uint32_t i = 0; i < Ctx->Iterations; ++i) {
+        for (uint32_t j = 0; j < POOL_BENCHMARK_BATCH_SIZE; ++j) {
+            Entries[2*j] = CxPlatPoolAlloc(Local);
+            Entries[2*j+1] = CxPlatPoolAlloc(Remote);
+            if (Entries[2*j] == NULL || Entries[2*j+1] == NULL) {
+                Ctx->Failed = true;
+                CXPLAT_THREAD_RETURN(0);
+            }
+            *(uint32_t*)Entries[2*j] = i;
+            *(uint32_t*)Entries[2*j+1] = i;
+        }
+        for (uint32_t j = 0; j < 2 * POOL_BENCHMARK_BATCH_SIZE; ++j) {
+            if (*(uint32_t*)Entries[j] != i) {
+                Ctx->Failed = true;
+            }
+            CxPlatPoolFree(Entries[j]);
+        }
+    }
+    Ctx->ElapsedUs = CxPlatTimeDiff64(TimeStart, CxPlatTimeUs64());
+    CXPLAT_THREAD_RETURN(0);
+}
+
+static
+void
+PoolBenchmark(
+    uint32_t ThreadCount,
+    uint32_t Iterations
+    )
+{
+    //
+    // Each thread has one local pool (like a partition's worker) and also allocates
+    // from and frees to its neighbor's pool (like an app thread calling into
+    // another partition). With a single thread both are the same pool.
+    //
+    CXPLAT_POOL* Pools = new(std::nothrow) CXPLAT_POOL[ThreadCount];
+    PoolBenchmarkContext* Contexts = new(std::nothrow) PoolBenchmarkContext[ThreadCount];
+    CXPLAT_THREAD* Threads = new(std::nothrow) CXPLAT_THREAD[ThreadCount];
+    ASSERT_NE(nullptr, Pools);
+    ASSERT_NE(nullptr, Contexts);
+    ASSERT_NE(nullptr, Threads);
+    long volatile ReadyCount = 0;
+
+    for (uint32_t i = 0; i < ThreadCount; ++i) {
+        CxPlatPoolInitialize(FALSE, POOL_BENCHMARK_ENTRY_SIZE, QUIC_POOL_TEST, &Pools[i]);
+    }
+
+    for (uint32_t i = 0; i < ThreadCount; ++i) {
+        Contexts[i] = { Pools, ThreadCount, i, Iterations, &ReadyCount, ThreadCount, 0, false };
+        CXPLAT_THREAD_CONFIG Config = { 0, 0, NULL, PoolBenchmarkThread, &Contexts[i] };
+        ASSERT_TRUE(QUIC_SUCCEEDED(CxPlatThreadCreate(&Config, &Threads[i])));
+    }
+
+    uint64_t MaxElapsedUs = 0;
+    for (uint32_t i = 0; i < ThreadCount; ++i) {
+        CxPlatThreadWait(&Threads[i]);
+        CxPlatThreadDelete(&Threads[i]);
+        ASSERT_FALSE(Contexts[i].Failed);
+        if (Contexts[i].ElapsedUs > MaxElapsedUs) {
+            MaxElapsedUs = Contexts[i].ElapsedUs;
+        }
+    }
+
+    for (uint32_t i = 0; i < ThreadCount; ++i) {
+        CxPlatPoolUninitialize(&Pools[i]);
+    }
+
+    const uint64_t TotalOps = (uint64_t)ThreadCount * Iterations * 2 * POOL_BENCHMARK_BATCH_SIZE;
+    const std::string Prefix = "Threads" + std::to_string(ThreadCount);
+    RecordBenchmarkResult(
+        Prefix + "MopsPerSec", MaxElapsedUs == 0 ? 0.0 : (double)TotalOps / MaxElapsedUs);
+    RecordBenchmarkResult(
+        Prefix + "NsPerAllocFree", (double)MaxElapsedUs * 1000 * ThreadCount / TotalOps);
+
+    delete [] Threads;
+    delete [] Contexts;
+    delete [] Pools;
+}
+
+TEST(PartitionTest, PoolCrossThreadFree)
+{
+    //
+    // Entries allocated on this thread and freed on another are cached in the
+    // other thread's magazine until it fills up, then returned to the depot in
+    // one batch, from where this thread takes them all back at once.
+    //
+    CXPLAT_POOL Pool;
+    CxPlatPoolInitialize(FALSE, POOL_BENCHMARK_ENTRY_SIZE, QUIC_POOL_TEST, &Pool);
+
+    const uint32_t EntryCount = CXPLAT_POOL_MAXIMUM_DEPTH + 1;
+    struct FreeContext {
+        void** Entries;
+        uint32_t Count;
+        static CXPLAT_THREAD_CALLBACK(FreeCallback, Context) {
+            auto Ctx = (FreeContext*)Context;
+            for (uint32_t i = 0; i < Ctx->Count; ++i) {
+                CxPlatPoolFree(Ctx->Entries[i]);
+            }
+            CXPLAT_THREAD_RETURN(0);
+        }
+    } Context;
+    Context.Entries = new(std::nothrow) void*[EntryCount];
+    ASSERT_NE(nullptr, Context.Entries);
+    Context.Count = EntryCount;
+
+    for (uint32_t i = 0; i < EntryCount; ++i) {
+        Context.Entries[i] = CxPlatPoolAlloc(&Pool);
+        ASSERT_NE(nullptr, Context.Entries[i]);
+    }
+
+    CXPLAT_THREAD_CONFIG Config = { 0, 0, NULL, FreeContext::FreeCallback, &Context };
+    CXPLAT_THREAD Thread;
+    ASSERT_TRUE(QUIC_SUCCEEDED(CxPlatThreadCreate(&Config, &Thread)));
+    CxPlatThreadWait(&Thread);
+    CxPlatThreadDelete(&Thread);
+
+#if !defined(_WIN32) && !defined(DISABLE_CXPLAT_POOL)
+    if (!CxPlatIsRandomMemoryFailureEnabled()) {
+        //
+        // This thread claimed the first magazine, the freeing thread the second.
+        //
+        ASSERT_EQ(0u, (uint32_t)Pool.Magazines[0].ListDepth);
+        ASSERT_EQ(1u, (uint32_t)Pool.Magazines[1].ListDepth);
+        ASSERT_EQ(CXPLAT_POOL_MAXIMUM_DEPTH, (uint32_t)Pool.DepotDepth);
+        void* Entry = CxPlatPoolAlloc(&Pool);
+        ASSERT_NE(nullptr, Entry);
+        ASSERT_EQ(0u, (uint32_t)Pool.DepotDepth);
+        ASSERT_EQ(CXPLAT_POOL_MAXIMUM_DEPTH - 1, (uint32_t)Pool.Magazines[0].ListDepth);
+        CxPlatPoolFree(Entry);
+        ASSERT_EQ(CXPLAT_POOL_MAXIMUM_DEPTH, (uint32_t)Pool.Magazines[0].ListDepth);
+    }
+#endif
+
+    CxPlatPoolUninitialize(&Pool);
+    delete [] Context.Entries;
+}
+
+//
+// The benchmarks are only run explicitly (--gtest_also_run_disabled_tests);
+// the longer one gives more stable numbers.
+//
+
+TEST(PartitionTest, DISABLED_PoolBenchmark)
+{
+    for (uint32_t ThreadCount = 1; ThreadCount <= 64; ThreadCount *= 2) {
+        PoolBenchmark(ThreadCount, 2000);
+    }
+}
+
+TEST(PartitionTest, DISABLED_PoolBenchmarkLong)
+{
+    for (uint32_t ThreadCount = 1; ThreadCount <= 64; ThreadCount *= 2) {
+        PoolBenchmark(ThreadCount, 100000);
+    }
+}
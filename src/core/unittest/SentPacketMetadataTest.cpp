@@ -13,3 +13,246 @@ Abstract:
 #ifdef QUIC_CLOG
 #include "SentPacketMetadataTest.cpp.clog.h"
 #endif
+
+struct SentPacketRingTest : public ::testing::Test
+{
+    QUIC_SENT_PACKET_POOL Pool;
+    QUIC_SENT_PACKET_RING Ring;
+
+    void SetUp() override {
+        QuicSentPacketPoolInitialize(&Pool);
+        QuicSentPacketRingInitialize(&Ring);
+    }
+
+    void TearDown() override {
+        QuicSentPacketRingUninitialize(&Ring);
+        QuicSentPacketPoolUninitialize(&Pool);
+    }
+
+    QUIC_SENT_PACKET_METADATA* Alloc(uint64_t PacketNumber, uint8_t FrameCount = 1) {
+        QUIC_SENT_PACKET_METADATA* Metadata =
+            QuicSentPacketRingGetPacketMetadata(&Ring, &Pool, PacketNumber, FrameCount);
+        if (Metadata != NULL) {
+            Metadata->PacketNumber = PacketNumber;
+            Metadata->FrameCount = FrameCount;
+        }
+        return Metadata;
+    }
+
+    void Free(QUIC_SENT_PACKET_METADATA* Metadata) {
+        QuicSentPacketRingReturnPacketMetadata(&Ring, Metadata);
+    }
+
+    uint32_t AllocatedBlocks() {
+        uint32_t Count = 0;
+        for (uint32_t i = 0; i < Ring.BlockCount; ++i) {
+            Count += Ring.Blocks[i] != NULL;
+        }
+        return Count;
+    }
+
+    std::vector<uint64_t> Enumerate(uint64_t Low, uint64_t High) {
+        std::vector<uint64_t> Found;
+        QUIC_SENT_PACKET_METADATA* Packet;
+        while ((Packet = QuicSentPacketRingGetNext(&Ring, &Low, High)) != NULL) {
+            Found.push_back(Packet->PacketNumber);
+        }
+        return Found;
+    }
+};
+
+TEST_F(SentPacketRingTest, LookupByPacketNumber)
+{
+    const uint64_t Count = 3 * QUIC_SENT_PACKET_RING_BLOCK_SLOTS + 3;
+    QUIC_SENT_PACKET_METADATA* Packets[Count];
+    for (uint64_t i = 0; i < Count; ++i) {
+        Packets[i] = Alloc(i);
+        ASSERT_NE(nullptr, Packets[i]);
+    }
+    ASSERT_TRUE(QuicSentPacketRingIsComplete(&Ring));
+    ASSERT_EQ((uint32_t)Count, Ring.Count);
+    for (uint64_t i = 0; i < Count; ++i) {
+        ASSERT_EQ(Packets[i], QuicSentPacketRingLookup(&Ring, i));
+    }
+    ASSERT_EQ(nullptr, QuicSentPacketRingLookup(&Ring, Count));
+    ASSERT_EQ(4u, AllocatedBlocks());
+
+    //
+    // Blocks are released as soon as they are empty, except for the newest,
+    // which goes once the whole ring is empty.
+    //
+    for (uint64_t i = 0; i < Count; ++i) {
+        Free(Packets[i]);
+        ASSERT_EQ(nullptr, QuicSentPacketRingLookup(&Ring, i));
+        if (i == Count - 2) {
+            ASSERT_EQ(1u, AllocatedBlocks());
+        }
+    }
+    ASSERT_EQ(0u, Ring.Count);
+    ASSERT_EQ(0u, AllocatedBlocks());
+}
+
+TEST_F(SentPacketRingTest, EnumerateRange)
+{
+    ASSERT_TRUE(Enumerate(0, UINT64_MAX).empty());
+
+    std::vector<QUIC_SENT_PACKET_METADATA*> Packets;
+    for (uint64_t i = 3; i < 1000; ++i) {
+        if (i % 7 != 0) {
+            Packets.push_back(Alloc(i));
+        }
+    }
+    ASSERT_TRUE(QuicSentPacketRingIsComplete(&Ring));
+
+    std::vector<uint64_t> Expected;
+    for (uint64_t i = 100; i <= 200; ++i) {
+        if (i % 7 != 0) {
+            Expected.push_back(i);
+        }
+    }
+    ASSERT_EQ(Expected, Enumerate(100, 200));
+    ASSERT_EQ(std::vector<uint64_t>({3, 4, 5, 6, 8}), Enumerate(0, 8));
+    ASSERT_EQ(std::vector<uint64_t>({998, 999}), Enumerate(998, UINT64_MAX));
+    ASSERT_TRUE(Enumerate(1000, 5000).empty());
+
+    for (auto Packet : Packets) {
+        if (Packet->PacketNumber != 10 &&
+            Packet->PacketNumber != 500 &&
+            Packet->PacketNumber != 999) {
+            Free(Packet);
+        }
+    }
+    ASSERT_EQ(3u, Ring.Count);
+    ASSERT_EQ(std::vector<uint64_t>({10, 500, 999}), Enumerate(0, UINT64_MAX));
+    for (auto Packet : Packets) {
+        if (QuicSentPacketRingLookup(&Ring, Packet->PacketNumber) == Packet) {
+            Free(Packet);
+        }
+    }
+}
+
+TEST_F(SentPacketRingTest, LargePacketsUsePool)
+{
+    QUIC_SENT_PACKET_METADATA* Small = Alloc(1, QUIC_SENT_PACKET_RING_MAX_FRAMES);
+    QUIC_SENT_PACKET_METADATA* Large = Alloc(2, QUIC_SENT_PACKET_RING_MAX_FRAMES + 1);
+    ASSERT_NE(nullptr, Small);
+    ASSERT_NE(nullptr, Large);
+
+    //
+    // Both are found by packet number, but only the small one is stored in
+    // the ring itself.
+    //
+    QUIC_SENT_PACKET_RING_BLOCK* Block = QuicSentPacketRingGetBlock(&Ring, 1);
+    ASSERT_NE(nullptr, Block);
+    ASSERT_EQ((void*)Block->Slots[1], (void*)Small);
+    ASSERT_NE((void*)Block->Slots[2], (void*)Large);
+    ASSERT_EQ(Small, QuicSentPacketRingLookup(&Ring, 1));
+    ASSERT_EQ(Large, QuicSentPacketRingLookup(&Ring, 2));
+    ASSERT_EQ(std::vector<uint64_t>({1, 2}), Enumerate(0, UINT64_MAX));
+
+    Free(Large);
+    Free(Small);
+    ASSERT_EQ(0u, Ring.Count);
+}
+
+TEST_F(SentPacketRingTest, WindowSlidesPastReleasedBlocks)
+{
+    std::vector<QUIC_SENT_PACKET_METADATA*> Packets;
+    for (uint64_t i = 0; i < 10000; ++i) {
+        Packets.push_back(Alloc(i));
+        if (i >= 100) {
+            Free(Packets[i - 100]);
+        }
+    }
+    ASSERT_TRUE(QuicSentPacketRingIsComplete(&Ring));
+    ASSERT_EQ((uint32_t)QUIC_SENT_PACKET_RING_INITIAL_BLOCKS, Ring.BlockCount);
+    ASSERT_LE(AllocatedBlocks(), 3u);
+    ASSERT_EQ(100u, Enumerate(0, UINT64_MAX).size());
+    for (uint64_t i = 9900; i < 10000; ++i) {
+        Free(Packets[i]);
+    }
+}
+
+TEST_F(SentPacketRingTest, GrowsForOldOutstandingPacket)
+{
+    std::vector<QUIC_SENT_PACKET_METADATA*> Packets;
+    for (uint64_t i = 0; i < 10000; ++i) {
+        Packets.push_back(Alloc(i));
+        if (i > 1) {
+            Free(Packets[i - 1]);
+        }
+    }
+    ASSERT_TRUE(QuicSentPacketRingIsComplete(&Ring));
+    ASSERT_GE(
+        (uint64_t)Ring.BlockCount * QUIC_SENT_PACKET_RING_BLOCK_SLOTS, 10000u);
+
+    //
+    // Only the blocks with something outstanding are kept, however big the
+    // window gets.
+    //
+    ASSERT_EQ(2u, AllocatedBlocks());
+    ASSERT_EQ(std::vector<uint64_t>({0, 9999}), Enumerate(0, UINT64_MAX));
+    Free(Packets[0]);
+    Free(Packets[9999]);
+}
+
+TEST_F(SentPacketRingTest, ReleasedWhenDrained)
+{
+    //
+    // Once nothing is outstanding, the ring holds no blocks and is back to
+    // its initial table, however big the window got.
+    //
+    std::vector<QUIC_SENT_PACKET_METADATA*> Packets;
+    for (uint64_t i = 0; i < 1000; ++i) {
+        Packets.push_back(Alloc(i));
+    }
+    ASSERT_GT(Ring.BlockCount, (uint32_t)QUIC_SENT_PACKET_RING_INITIAL_BLOCKS);
+    for (uint64_t i = 0; i < 1000; ++i) {
+        Free(Packets[i]);
+    }
+    ASSERT_EQ(0u, Ring.Count);
+    ASSERT_EQ(nullptr, Ring.NewestBlock);
+    ASSERT_EQ(Ring.InitialBlocks, Ring.Blocks);
+    ASSERT_EQ((uint32_t)QUIC_SENT_PACKET_RING_INITIAL_BLOCKS, Ring.BlockCount);
+    ASSERT_EQ(0u, AllocatedBlocks());
+
+    //
+    // The same goes for a single packet sent and acknowledged at a time.
+    //
+    for (uint64_t i = 1000; i < 1200; ++i) {
+        QUIC_SENT_PACKET_METADATA* Packet = Alloc(i);
+        ASSERT_NE(nullptr, Packet);
+        ASSERT_EQ(Packet, QuicSentPacketRingLookup(&Ring, i));
+        Free(Packet);
+        ASSERT_EQ(nullptr, Ring.NewestBlock);
+        ASSERT_EQ(0u, AllocatedBlocks());
+    }
+}
+
+TEST_F(SentPacketRingTest, UntrackedPackets)
+{
+    //
+    // A packet number below the window can't be added to the ring, and the
+    // ring can't be used for lookups until that packet is gone.
+    //
+    QUIC_SENT_PACKET_METADATA* Tracked = Alloc(200);
+    QUIC_SENT_PACKET_METADATA* Untracked = Alloc(100);
+    ASSERT_NE(nullptr, Tracked);
+    ASSERT_NE(nullptr, Untracked);
+    ASSERT_FALSE(QuicSentPacketRingIsComplete(&Ring));
+    ASSERT_EQ(1u, Ring.Count);
+    ASSERT_EQ(nullptr, QuicSentPacketRingLookup(&Ring, 100));
+
+    Free(Untracked);
+    ASSERT_TRUE(QuicSentPacketRingIsComplete(&Ring));
+    ASSERT_EQ(Tracked, QuicSentPacketRingLookup(&Ring, 200));
+    Free(Tracked);
+
+    //
+    // With nothing outstanding, the window starts over at the next packet.
+    //
+    QUIC_SENT_PACKET_METADATA* Packet = Alloc(150);
+    ASSERT_TRUE(QuicSentPacketRingIsComplete(&Ring));
+    ASSERT_EQ(Packet, QuicSentPacketRingLookup(&Ring, 150));
+    Free(Packet);
+}
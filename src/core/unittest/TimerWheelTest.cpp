@@ -13,3 +13,272 @@ Abstract:
 #ifdef QUIC_CLOG
 #include "TimerWheelTest.cpp.clog.h"
 #endif
+
+struct TimerWheelTest : public ::testing::Test
+{
+    QUIC_TIMER_WHEEL TimerWheel;
+    QUIC_CONNECTION* Connections {nullptr};
+    uint32_t ConnectionCount {0};
+    uint64_t LastRandom {0x2545F4914F6CDD1Dull};
+
+    void SetUp() override {
+        TEST_QUIC_SUCCEEDED(QuicTimerWheelInitialize(&TimerWheel));
+    }
+
+    void TearDown() override {
+        for (uint32_t i = 0; i < ConnectionCount; ++i) {
+            QuicTimerWheelRemoveConnection(&TimerWheel, &Connections[i]);
+        }
+        QuicTimerWheelUninitialize(&TimerWheel);
+        delete [] Connections;
+    }
+
+    void AllocConnections(uint32_t Count) {
+        Connections = new(std::nothrow) QUIC_CONNECTION[Count];
+        ASSERT_NE(nullptr, Connections);
+        ConnectionCount = Count;
+        for (uint32_t i = 0; i < Count; ++i) {
+            QUIC_CONNECTION* Connection = &Connections[i];
+            CxPlatZeroMemory(Connection, sizeof(*Connection));
+            Connection->_.Type = QUIC_HANDLE_TYPE_CONNECTION_SERVER;
+            Connection->RefCount = 1;
+            Connection->EarliestExpirationTime = UINT64_MAX;
+#if DEBUG
+            for (uint32_t j = 0; j < QUIC_CONN_REF_COUNT; j++) {
+                CxPlatRefInitialize(&Connection->RefTypeBiasedCount[j]);
+            }
+#endif
+        }
+    }
+
+    uint64_t Random() {
+        //
+        // Deterministic xorshift so failures are reproducible.
+        //
+        LastRandom ^= LastRandom << 13;
+        LastRandom ^= LastRandom >> 7;
+        LastRandom ^= LastRandom << 17;
+        return LastRandom;
+    }
+
+    void SetTimer(QUIC_CONNECTION* Connection, uint64_t ExpirationTime) {
+        Connection->EarliestExpirationTime = ExpirationTime;
+        QuicTimerWheelUpdateConnection(&TimerWheel, Connection);
+    }
+
+    //
+    // Processes expired timers the same way the worker does and returns the
+    // number of connections that expired.
+    //
+    uint32_t Expire(uint64_t TimeNow) {
+        CXPLAT_LIST_ENTRY ExpiredTimers;
+        CxPlatListInitializeHead(&ExpiredTimers);
+        QuicTimerWheelGetExpired(&TimerWheel, TimeNow, &ExpiredTimers);
+        uint32_t Count = 0;
+        while (!CxPlatListIsEmpty(&ExpiredTimers)) {
+            CXPLAT_LIST_ENTRY* Entry = CxPlatListRemoveHead(&ExpiredTimers);
+            Entry->Flink = NULL;
+            QUIC_CONNECTION* Connection =
+                CXPLAT_CONTAINING_RECORD(Entry, QUIC_CONNECTION, TimerLink);
+            EXPECT_LE(Connection->EarliestExpirationTime, TimeNow);
+            Connection->EarliestExpirationTime = UINT64_MAX;
+            //
+            // Drop the worker reference the timer wheel handed out. The test
+            // always holds the initial reference, so this is never the last.
+            //
+#if DEBUG
+            CxPlatRefDecrement(&Connection->RefTypeBiasedCount[QUIC_CONN_REF_WORKER]);
+#endif
+            InterlockedDecrement(&Connection->RefCount);
+            Count++;
+        }
+        return Count;
+    }
+
+    uint64_t EarliestExpirationTime() {
+        uint64_t Earliest = UINT64_MAX;
+        for (uint32_t i = 0; i < ConnectionCount; ++i) {
+            if (Connections[i].EarliestExpirationTime < Earliest) {
+                Earliest = Connections[i].EarliestExpirationTime;
+            }
+        }
+        return Earliest;
+    }
+
+    void Benchmark(uint32_t Count) {
+        AllocConnections(Count);
+        const uint64_t Start = 1000000;
+
+        uint64_t TimeStart = CxPlatTimeUs64();
+        for (uint32_t i = 0; i < Count; ++i) {
+            SetTimer(&Connections[i], Start + Random() % 30000000);
+        }
+        uint64_t InsertTime = CxPlatTimeDiff64(TimeStart, CxPlatTimeUs64());
+
+        TimeStart = CxPlatTimeUs64();
+        for (uint32_t i = 0; i < Count; ++i) {
+            SetTimer(&Connections[i], Start + Random() % 30000000);
+        }
+        uint64_t UpdateTime = CxPlatTimeDiff64(TimeStart, CxPlatTimeUs64());
+
+        TimeStart = CxPlatTimeUs64();
+        uint32_t Expired = 0;
+        for (uint64_t TimeNow = Start; Expired < Count; TimeNow += 1000) {
+            if (TimerWheel.NextExpirationTime <= TimeNow) {
+                Expired += Expire(TimeNow);
+            }
+        }
+        uint64_t ExpireTime = CxPlatTimeDiff64(TimeStart, CxPlatTimeUs64());
+        ASSERT_EQ(0ull, TimerWheel.ConnectionCount);
+
+        RecordBenchmarkResult("InsertNs", (double)InsertTime * 1000 / Count);
+        RecordBenchmarkResult("UpdateNs", (double)UpdateTime * 1000 / Count);
+        RecordBenchmarkResult("ExpireNs", (double)ExpireTime * 1000 / Count);
+    }
+};
+
+TEST_F(TimerWheelTest, Empty)
+{
+    ASSERT_EQ(UINT64_MAX, TimerWheel.NextExpirationTime);
+    ASSERT_EQ(nullptr, TimerWheel.NextConnection);
+    ASSERT_EQ(0u, Expire(UINT64_MAX - 1));
+}
+
+TEST_F(TimerWheelTest, ExpireInOrder)
+{
+    AllocConnections(4);
+    SetTimer(&Connections[0], 5000);      // Inner level
+    SetTimer(&Connections[1], 100000);    // Second level
+    SetTimer(&Connections[2], 20000000);  // Third level
+    SetTimer(&Connections[3], 4000000000);// Outer level
+    ASSERT_EQ(4ull, TimerWheel.ConnectionCount);
+    ASSERT_EQ(5000ull, TimerWheel.NextExpirationTime);
+    ASSERT_EQ(&Connections[0], TimerWheel.NextConnection);
+
+    ASSERT_EQ(0u, Expire(4999));
+    ASSERT_EQ(1u, Expire(5000));
+    ASSERT_LE(TimerWheel.NextExpirationTime, 100000ull);
+
+    ASSERT_EQ(0u, Expire(99999));
+    ASSERT_EQ(1u, Expire(100000));
+    ASSERT_LE(TimerWheel.NextExpirationTime, 20000000ull);
+
+    ASSERT_EQ(1u, Expire(20000001));
+    ASSERT_EQ(1u, Expire(UINT64_MAX - 1));
+    ASSERT_EQ(0ull, TimerWheel.ConnectionCount);
+    ASSERT_EQ(UINT64_MAX, TimerWheel.NextExpirationTime);
+}
+
+TEST_F(TimerWheelTest, UpdateAndRemove)
+{
+    AllocConnections(3);
+    SetTimer(&Connections[0], 1000);
+    SetTimer(&Connections[1], 2000);
+    SetTimer(&Connections[2], 3000000);
+    ASSERT_EQ(&Connections[0], TimerWheel.NextConnection);
+
+    //
+    // Moving the next connection later makes the next one the earliest.
+    //
+    SetTimer(&Connections[0], 5000000);
+    ASSERT_EQ(2000ull, TimerWheel.NextExpirationTime);
+    ASSERT_EQ(&Connections[1], TimerWheel.NextConnection);
+
+    QuicTimerWheelRemoveConnection(&TimerWheel, &Connections[1]);
+    Connections[1].EarliestExpirationTime = UINT64_MAX;
+    ASSERT_EQ(2ull, TimerWheel.ConnectionCount);
+    ASSERT_LE(TimerWheel.NextExpirationTime, 3000000ull);
+
+    //
+    // Clearing the timer removes the connection.
+    //
+    SetTimer(&Connections[2], UINT64_MAX);
+    ASSERT_EQ(1ull, TimerWheel.ConnectionCount);
+    ASSERT_EQ(nullptr, Connections[2].TimerLink.Flink);
+
+    ASSERT_EQ(0u, Expire(4999999));
+    ASSERT_EQ(1u, Expire(5000000));
+    ASSERT_EQ(UINT64_MAX, TimerWheel.NextExpirationTime);
+}
+
+TEST_F(TimerWheelTest, PastExpiration)
+{
+    AllocConnections(2);
+    SetTimer(&Connections[0], 10000000);
+    ASSERT_EQ(1u, Expire(10000000));
+
+    //
+    // A timer behind the wheel's current time expires on the next check.
+    //
+    SetTimer(&Connections[1], 5000);
+    ASSERT_EQ(5000ull, TimerWheel.NextExpirationTime);
+    ASSERT_EQ(1u, Expire(10000001));
+}
+
+TEST_F(TimerWheelTest, RandomizedAgainstBruteForce)
+{
+    const uint32_t Count = 1000;
+    AllocConnections(Count);
+
+    uint64_t TimeNow = 1000000;
+    for (uint32_t Iteration = 0; Iteration < 2000; ++Iteration) {
+        for (uint32_t i = 0; i < 20; ++i) {
+            QUIC_CONNECTION* Connection = &Connections[Random() % Count];
+            switch (Random() % 8) {
+            case 0:
+                QuicTimerWheelRemoveConnection(&TimerWheel, Connection);
+                Connection->EarliestExpirationTime = UINT64_MAX;
+                break;
+            case 1:
+                SetTimer(Connection, UINT64_MAX);
+                break;
+            case 2:
+                SetTimer(Connection, TimeNow + Random() % (1ull << 40));
+                break;
+            case 3:
+                SetTimer(Connection, TimeNow + Random() % 100000000);
+                break;
+            default:
+                SetTimer(Connection, TimeNow + Random() % 100000);
+                break;
+            }
+        }
+
+        uint64_t Earliest = EarliestExpirationTime();
+        ASSERT_LE(TimerWheel.NextExpirationTime, Earliest);
+        if (TimerWheel.NextConnection != nullptr) {
+            ASSERT_EQ(Earliest, TimerWheel.NextExpirationTime);
+        }
+
+        TimeNow += (Iteration % 100 == 99) ? Random() % 1000000000 : Random() % 50000;
+
+        uint32_t ExpectedExpired = 0;
+        for (uint32_t i = 0; i < Count; ++i) {
+            if (Connections[i].EarliestExpirationTime <= TimeNow) {
+                ExpectedExpired++;
+            }
+        }
+        ASSERT_EQ(ExpectedExpired, Expire(TimeNow));
+        ASSERT_LT(TimeNow, EarliestExpirationTime());
+    }
+}
+
+//
+// The benchmarks are only run explicitly (--gtest_also_run_disabled_tests);
+// the larger ones also need a lot of memory for the connections.
+//
+
+TEST_F(TimerWheelTest, DISABLED_Benchmark10K)
+{
+    Benchmark(10000);
+}
+
+TEST_F(TimerWheelTest, DISABLED_Benchmark100K)
+{
+    Benchmark(100000);
+}
+
+TEST_F(TimerWheelTest, DISABLED_Benchmark1M)
+{
+    Benchmark(1000000);
+}
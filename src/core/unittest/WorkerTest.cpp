@@ -13,3 +13,141 @@ Abstract:
 #ifdef QUIC_CLOG
 #include "WorkerTest.cpp.clog.h"
 #endif
+
+extern "C"
+void
+QuicWorkerTryStealConnection(
+    _In_ QUIC_WORKER* Worker
+    );
+
+extern "C"
+BOOLEAN
+QuicWorkerHandOffConnection(
+    _In_ QUIC_WORKER* Worker,
+    _In_ QUIC_CONNECTION* Connection
+    );
+
+//
+// Two workers of a pool, without threads, with connections queued on the
+// second (overloaded) one for the first (idle) one to steal.
+//
+struct WorkerStealTest : public ::testing::Test
+{
+    static const uint32_t ConnectionCount = 3;
+
+    QUIC_WORKER_POOL* WorkerPool {nullptr};
+    QUIC_PARTITION* Partition {nullptr};
+    QUIC_CONNECTION* Connections[ConnectionCount] {};
+    QUIC_WORKER* Thief {nullptr};
+    QUIC_WORKER* Victim {nullptr};
+
+    void SetUp() override {
+        const size_t PoolSize = sizeof(QUIC_WORKER_POOL) + 2 * sizeof(QUIC_WORKER);
+        WorkerPool = (QUIC_WORKER_POOL*)CXPLAT_ALLOC_NONPAGED(PoolSize, QUIC_POOL_WORKER);
+        Partition = new(std::nothrow) QUIC_PARTITION;
+        ASSERT_NE(nullptr, WorkerPool);
+        ASSERT_NE(nullptr, Partition);
+        CxPlatZeroMemory(WorkerPool, PoolSize);
+        CxPlatZeroMemory(Partition, sizeof(*Partition));
+        WorkerPool->WorkerCount = 2;
+        WorkerPool->WorkStealing = TRUE;
+
+        for (uint16_t i = 0; i < WorkerPool->WorkerCount; ++i) {
+            QUIC_WORKER* Worker = &WorkerPool->Workers[i];
+            Worker->WorkerPool = WorkerPool;
+            Worker->Partition = Partition;
+            Worker->Enabled = TRUE;
+            CxPlatDispatchLockInitialize(&Worker->Lock);
+            CxPlatListInitializeHead(&Worker->Connections);
+            Worker->PriorityConnectionsTail = &Worker->Connections.Flink;
+        }
+        Thief = &WorkerPool->Workers[0];
+        Victim = &WorkerPool->Workers[1];
+        Victim->AverageQueueDelay = MsQuicLib.Settings.MaxWorkerQueueDelayUs + 1;
+
+        for (uint32_t i = 0; i < ConnectionCount; ++i) {
+            Connections[i] = new(std::nothrow) QUIC_CONNECTION;
+            ASSERT_NE(nullptr, Connections[i]);
+            CxPlatZeroMemory(Connections[i], sizeof(QUIC_CONNECTION));
+            Connections[i]->Registration = (QUIC_REGISTRATION*)this;
+            CxPlatListInsertTail(&Victim->Connections, &Connections[i]->WorkerLink);
+        }
+    }
+
+    void TearDown() override {
+        for (uint32_t i = 0; i < ConnectionCount; ++i) {
+            delete Connections[i];
+        }
+        if (WorkerPool != nullptr) {
+            for (uint16_t i = 0; i < WorkerPool->WorkerCount; ++i) {
+                CxPlatDispatchLockUninitialize(&WorkerPool->Workers[i].Lock);
+            }
+            CXPLAT_FREE(WorkerPool, QUIC_POOL_WORKER);
+        }
+        delete Partition;
+    }
+
+    uint32_t ClaimedCount() {
+        uint32_t Count = 0;
+        for (uint32_t i = 0; i < ConnectionCount; ++i) {
+            if (Connections[i]->StealingWorker != NULL) {
+                EXPECT_EQ(Thief, Connections[i]->StealingWorker);
+                Count++;
+            }
+        }
+        return Count;
+    }
+};
+
+TEST_F(WorkerStealTest, OneClaimAtATime)
+{
+    QuicWorkerTryStealConnection(Thief);
+    ASSERT_TRUE(Thief->StealPending);
+    ASSERT_EQ(1u, ClaimedCount());
+    ASSERT_EQ(1, Partition->PerfCounters[QUIC_PERF_COUNTER_WORK_CONN_STOLEN]);
+
+    QuicWorkerTryStealConnection(Thief);
+    ASSERT_EQ(1u, ClaimedCount());
+    ASSERT_EQ(1, Partition->PerfCounters[QUIC_PERF_COUNTER_WORK_CONN_STOLEN]);
+
+    //
+    // The claimed connection moves to the front of the queue, so the victim
+    // hands it over as soon as possible.
+    //
+    ASSERT_EQ(&Connections[ConnectionCount - 1]->WorkerLink, Victim->Connections.Flink);
+}
+
+TEST_F(WorkerStealTest, NothingToSteal)
+{
+    Victim->AverageQueueDelay = 0;
+    QuicWorkerTryStealConnection(Thief);
+    ASSERT_FALSE(Thief->StealPending);
+    ASSERT_EQ(0u, ClaimedCount());
+    ASSERT_EQ(0, Partition->PerfCounters[QUIC_PERF_COUNTER_WORK_CONN_STOLEN]);
+}
+
+TEST_F(WorkerStealTest, DeclinedHandOffReleasesClaim)
+{
+    QuicWorkerTryStealConnection(Thief);
+    ASSERT_EQ(1u, ClaimedCount());
+
+    //
+    // The victim dequeues the claimed connection (now at the front), but the thief was disabled
+    // in the meantime, so the victim keeps it. The thief can steal again.
+    //
+    QUIC_CONNECTION* Claimed =
+        CXPLAT_CONTAINING_RECORD(Victim->Connections.Flink, QUIC_CONNECTION, WorkerLink);
+    ASSERT_EQ(Thief, Claimed->StealingWorker);
+    CxPlatListEntryRemove(&Claimed->WorkerLink);
+    Thief->Enabled = FALSE;
+    ASSERT_FALSE(QuicWorkerHandOffConnection(Victim, Claimed));
+    ASSERT_EQ(nullptr, Claimed->StealingWorker);
+    ASSERT_FALSE(Thief->StealPending);
+    ASSERT_EQ(0, Partition->PerfCounters[QUIC_PERF_COUNTER_WORK_CONN_MIGRATED]);
+
+    Thief->Enabled = TRUE;
+    QuicWorkerTryStealConnection(Thief);
+    ASSERT_TRUE(Thief->StealPending);
+    ASSERT_EQ(1u, ClaimedCount());
+    ASSERT_EQ(2, Partition->PerfCounters[QUIC_PERF_COUNTER_WORK_CONN_STOLEN]);
+}
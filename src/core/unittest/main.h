@@ -19,6 +19,22 @@
 #define COMPARE_TP_FIELD(TpName, Field) \
     if (A->Flags & QUIC_TP_FLAG_##TpName) { ASSERT_EQ(A->Field, B->Field); }
 
+//
+// Benchmarks report their results as test properties, which end up in the XML
+// output (--gtest_output=xml) instead of on the console.
+//
+inline
+void
+RecordBenchmarkResult(
+    _In_ const std::string& Name,
+    _In_ double Value
+    )
+{
+    char Str[32];
+    snprintf(Str, sizeof(Str), "%.2f", Value);
+    ::testing::Test::RecordProperty(Name, Str);
+}
+
 QUIC_INLINE
 std::ostream& operator << (std::ostream& o, const QUIC_FRAME_TYPE& type) {
     switch (type) {
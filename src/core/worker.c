@@ -17,6 +17,14 @@ Abstract:
     Each connection is assigned to a single worker, and is queued whenever it
     has operations to be processed.
 
+    When work stealing is enabled (QUIC_GLOBAL_EXECUTION_CONFIG_FLAG_WORK_STEALING),
+    an overloaded worker wakes an idle sibling, which then claims a queued
+    connection from the tail of the overloaded worker's queue. Ownership only
+    changes hands on the owning worker's thread: the next time it dequeues the
+    claimed connection, it removes it from its timer wheel and moves it to the
+    idle worker instead of processing it, the same way a connection moves when
+    its partition changes.
+
 --*/
 
 #include "precomp.h"
@@ -66,6 +74,7 @@ QuicWorkerInitialize(
     _In_ const QUIC_REGISTRATION* Registration,
     _In_ QUIC_EXECUTION_PROFILE ExecProfile,
     _In_ QUIC_PARTITION* Partition,
+    _In_ QUIC_WORKER_POOL* WorkerPool,
     _Inout_ QUIC_WORKER* Worker
     )
 {
@@ -78,6 +87,10 @@ QuicWorkerInitialize(
 
     Worker->Enabled = TRUE;
     Worker->Partition = Partition;
+    Worker->WorkerPool = WorkerPool;
+    Worker->DrainBudget = QUIC_MAX_OPERATIONS_PER_DRAIN;
+    QuicPerfCounterAdd(
+        Partition, QUIC_PERF_COUNTER_WORK_DRAIN_BUDGET, Worker->DrainBudget);
     CxPlatDispatchLockInitialize(&Worker->Lock);
     CxPlatEventInitialize(&Worker->Done, TRUE, FALSE);
     CxPlatEventInitialize(&Worker->Ready, FALSE, FALSE);
@@ -200,6 +213,11 @@ QuicWorkerUninitialize(
     CxPlatDispatchLockUninitialize(&Worker->Lock);
     QuicTimerWheelUninitialize(&Worker->TimerWheel);
 
+    QuicPerfCounterAdd(
+        Worker->Partition,
+        QUIC_PERF_COUNTER_WORK_DRAIN_BUDGET,
+        -(int64_t)Worker->DrainBudget);
+
     QuicTraceEvent(
         WorkerDestroyed,
         "[wrkr][%p] Destroyed",
@@ -441,6 +459,28 @@ QuicWorkerQueueOperation(
     }
 }
 
+_IRQL_requires_max_(PASSIVE_LEVEL)
+void
+QuicWorkerSetDrainBudget(
+    _In_ QUIC_WORKER* Worker,
+    _In_ uint32_t DrainBudget
+    )
+{
+    if (DrainBudget < QUIC_MIN_ADAPTIVE_OPERATIONS_PER_DRAIN) {
+        DrainBudget = QUIC_MIN_ADAPTIVE_OPERATIONS_PER_DRAIN;
+    } else if (DrainBudget > QUIC_MAX_ADAPTIVE_OPERATIONS_PER_DRAIN) {
+        DrainBudget = QUIC_MAX_ADAPTIVE_OPERATIONS_PER_DRAIN;
+    }
+
+    if (DrainBudget != Worker->DrainBudget) {
+        QuicPerfCounterAdd(
+            Worker->Partition,
+            QUIC_PERF_COUNTER_WORK_DRAIN_BUDGET,
+            (int64_t)DrainBudget - (int64_t)Worker->DrainBudget);
+        Worker->DrainBudget = DrainBudget;
+    }
+}
+
 _IRQL_requires_max_(PASSIVE_LEVEL)
 void
 QuicWorkerUpdateQueueDelay(
@@ -454,6 +494,14 @@ QuicWorkerUpdateQueueDelay(
         "[wrkr][%p] QueueDelay = %u",
         Worker,
         Worker->AverageQueueDelay);
+
+    if (Worker->AverageQueueDelay > QUIC_DRAIN_BUDGET_SHRINK_DELAY_US) {
+        //
+        // Connections are waiting too long for their turn. Give each one a
+        // smaller quantum so the worker cycles through them faster.
+        //
+        QuicWorkerSetDrainBudget(Worker, Worker->DrainBudget - Worker->DrainBudget / 4);
+    }
 }
 
 _IRQL_requires_max_(PASSIVE_LEVEL)
@@ -552,6 +600,181 @@ QuicWorkerGetNextOperation(
     return Operation;
 }
 
+//
+// Returns a connection queued on the (locked) worker that can be handed over
+// to another worker, or NULL. The connection at the head of the queue and any
+// with priority work are left alone.
+//
+_IRQL_requires_max_(DISPATCH_LEVEL)
+QUIC_CONNECTION*
+QuicWorkerFindStealableConnection(
+    _In_ QUIC_WORKER* Worker
+    )
+{
+    const CXPLAT_LIST_ENTRY* FirstNormal = *Worker->PriorityConnectionsTail;
+    if (FirstNormal == &Worker->Connections) {
+        return NULL; // Only priority connections queued.
+    }
+
+    CXPLAT_LIST_ENTRY* Entry = Worker->Connections.Blink;
+
+    for (uint32_t i = 0;
+         i < QUIC_WORKER_STEAL_MAX_SCAN && Entry != Worker->Connections.Flink;
+         ++i, Entry = Entry->Blink) {
+        QUIC_CONNECTION* Connection =
+            CXPLAT_CONTAINING_RECORD(Entry, QUIC_CONNECTION, WorkerLink);
+        if (Connection->StealingWorker == NULL &&
+            Connection->Registration != NULL &&
+            !Connection->State.UpdateWorker &&
+            !Connection->State.Partitioned &&
+            !Connection->State.ShutdownComplete) {
+            return Connection;
+        }
+        if (Entry == FirstNormal) {
+            break; // Don't look into the priority connections.
+        }
+    }
+
+    return NULL;
+}
+
+//
+// Called by an idle worker to claim a queued connection from an overloaded
+// worker in the same pool. Neighboring partitions are tried first.
+//
+_IRQL_requires_max_(PASSIVE_LEVEL)
+void
+QuicWorkerTryStealConnection(
+    _In_ QUIC_WORKER* Worker
+    )
+{
+    QUIC_WORKER_POOL* WorkerPool = Worker->WorkerPool;
+    if (QuicWorkerIsOverloaded(Worker) ||
+        InterlockedFetchAndSetBoolean(&Worker->StealPending)) {
+        return;
+    }
+
+    //
+    // StealPending is set before the claim is made: as soon as the victim's
+    // lock is released, the victim may hand the connection over and clear it.
+    //
+
+    const uint16_t Index = (uint16_t)(Worker - WorkerPool->Workers);
+    for (uint16_t i = 1; i < WorkerPool->WorkerCount; ++i) {
+        QUIC_WORKER* Victim = &WorkerPool->Workers[(Index + i) % WorkerPool->WorkerCount];
+        if (!Victim->Enabled ||
+            !QuicWorkerIsOverloaded(Victim) ||
+            CxPlatListIsEmptyNoFence(&Victim->Connections)) {
+            continue;
+        }
+
+        CxPlatDispatchLockAcquire(&Victim->Lock);
+        QUIC_CONNECTION* Connection = QuicWorkerFindStealableConnection(Victim);
+        if (Connection != NULL) {
+            //
+            // Move the connection to the front of the normal priority queue
+            // so the victim gets to the (cheap) hand over as soon as possible.
+            //
+            Connection->StealingWorker = Worker;
+            CxPlatListEntryRemove(&Connection->WorkerLink);
+            CxPlatListInsertTail(*Victim->PriorityConnectionsTail, &Connection->WorkerLink);
+        }
+        CxPlatDispatchLockRelease(&Victim->Lock);
+
+        if (Connection != NULL) {
+            QuicPerfCounterIncrement(Worker->Partition, QUIC_PERF_COUNTER_WORK_CONN_STOLEN);
+            return;
+        }
+    }
+
+    InterlockedFetchAndClearBoolean(&Worker->StealPending);
+}
+
+//
+// Drops another worker's claim on a connection this worker just took off its
+// queue, so that the other worker can steal again. Returns the claiming worker.
+//
+QUIC_INLINE
+QUIC_WORKER*
+QuicWorkerReleaseStealClaim(
+    _In_ QUIC_CONNECTION* Connection
+    )
+{
+    QUIC_WORKER* StealingWorker = Connection->StealingWorker;
+    CXPLAT_DBG_ASSERT(StealingWorker != NULL);
+    CXPLAT_DBG_ASSERT(StealingWorker->StealPending);
+    Connection->StealingWorker = NULL;
+    InterlockedFetchAndClearBoolean(&StealingWorker->StealPending);
+    return StealingWorker;
+}
+
+//
+// Called by an overloaded worker to wake up an idle worker in the same pool,
+// which will then try to steal some of its connections.
+//
+_IRQL_requires_max_(PASSIVE_LEVEL)
+void
+QuicWorkerWakeIdleSibling(
+    _In_ QUIC_WORKER* Worker
+    )
+{
+    QUIC_WORKER_POOL* WorkerPool = Worker->WorkerPool;
+    const uint16_t Index = (uint16_t)(Worker - WorkerPool->Workers);
+    for (uint16_t i = 1; i < WorkerPool->WorkerCount; ++i) {
+        QUIC_WORKER* Sibling = &WorkerPool->Workers[(Index + i) % WorkerPool->WorkerCount];
+        if (Sibling->Enabled && !Sibling->IsActive && !Sibling->StealPending) {
+            QuicWorkerThreadWake(Sibling);
+            return;
+        }
+    }
+}
+
+//
+// Hands a connection claimed by another worker over to that worker. Returns
+// FALSE if the connection should be processed here instead.
+//
+_IRQL_requires_max_(PASSIVE_LEVEL)
+BOOLEAN
+QuicWorkerHandOffConnection(
+    _In_ QUIC_WORKER* Worker,
+    _In_ QUIC_CONNECTION* Connection
+    )
+{
+    QUIC_WORKER* NewWorker = QuicWorkerReleaseStealClaim(Connection);
+
+    if (!NewWorker->Enabled ||
+        QuicOperationHasPriority(&Connection->OperQ) ||
+        Connection->State.Partitioned) {
+        return FALSE;
+    }
+
+    if (!Connection->State.UpdateWorker) {
+        //
+        // The timers move with the connection. The new worker adds them to its
+        // timer wheel when it first processes the connection. (If UpdateWorker
+        // is already set, the connection just arrived and has no timers here.)
+        //
+        QuicTimerWheelRemoveConnection(&Worker->TimerWheel, Connection);
+        Connection->State.UpdateWorker = TRUE;
+    }
+
+    CxPlatDispatchLockAcquire(&Worker->Lock);
+    Connection->WorkerProcessing = FALSE;
+    Connection->HasQueuedWork = TRUE;
+    CxPlatDispatchLockRelease(&Worker->Lock);
+
+    QuicPerfCounterIncrement(Worker->Partition, QUIC_PERF_COUNTER_WORK_CONN_MIGRATED);
+
+    //
+    // Assigning the worker also moves the connection's allocations over to the
+    // new worker's partition.
+    //
+    QuicWorkerAssignConnection(NewWorker, Connection);
+    QuicWorkerMoveConnection(NewWorker, Connection, FALSE);
+    QuicConnRelease(Connection, QUIC_CONN_REF_WORKER);
+    return TRUE;
+}
+
 _IRQL_requires_max_(PASSIVE_LEVEL)
 void
 QuicWorkerProcessTimers(
@@ -595,6 +818,11 @@ QuicWorkerProcessConnection(
     _Inout_ uint64_t* TimeNow
     )
 {
+    if (Connection->StealingWorker != NULL &&
+        QuicWorkerHandOffConnection(Worker, Connection)) {
+        return;
+    }
+
     QuicTraceEvent(
         ConnScheduleState,
         "[conn][%p] Scheduling: %u",
@@ -665,6 +893,17 @@ QuicWorkerProcessConnection(
     Connection->WorkerProcessing = FALSE;
     Connection->HasQueuedWork |= StillHasWorkToDo;
 
+    if (StillHasWorkToDo &&
+        !Connection->State.UpdateWorker &&
+        CxPlatListIsEmpty(&Worker->Connections) &&
+        Worker->AverageQueueDelay < QUIC_DRAIN_BUDGET_GROW_DELAY_US) {
+        //
+        // The connection used up its whole quantum and nobody else is waiting
+        // on the worker, so let bulk work run longer between reschedules.
+        //
+        QuicWorkerSetDrainBudget(Worker, Worker->DrainBudget + Worker->DrainBudget / 4);
+    }
+
     BOOLEAN DoneWithConnection = TRUE;
     if (!Connection->State.UpdateWorker) {
         if (Connection->HasQueuedWork) {
@@ -790,6 +1029,9 @@ QuicWorkerLoopCleanup(
         if (Worker->PriorityConnectionsTail == &Connection->WorkerLink.Flink) {
             Worker->PriorityConnectionsTail = &Worker->Connections.Flink;
         }
+        if (Connection->StealingWorker != NULL) {
+            QuicWorkerReleaseStealClaim(Connection);
+        }
         if (!Connection->State.ExternalOwner) {
             //
             // If there is no external owner, shut down the connection so
@@ -881,6 +1123,13 @@ QuicWorkerLoop(
         QuicWorkerProcessConnection(Worker, Connection, State->ThreadID, &State->TimeNow);
         Worker->ExecutionContext.Ready = TRUE;
         State->NoWorkCount = 0;
+        if (Worker->WorkerPool->WorkStealing &&
+            QuicWorkerIsOverloaded(Worker) &&
+            !CxPlatListIsEmptyNoFence(&Worker->Connections)) {
+            QuicWorkerWakeIdleSibling(Worker);
+        }
+    } else if (Worker->WorkerPool->WorkStealing) {
+        QuicWorkerTryStealConnection(Worker);
     }
 
     QUIC_LISTENER* Listener = QuicWorkerGetNextListener(Worker);
@@ -908,8 +1157,7 @@ QuicWorkerLoop(
         return TRUE;
     }
 
-    if (MsQuicLib.ExecutionConfig &&
-        (uint64_t)MsQuicLib.ExecutionConfig->PollingIdleTimeoutUs >
+    if ((uint64_t)QuicLibraryGetPollingIdleTimeoutUs() >
             CxPlatTimeDiff64(State->LastWorkTime, State->TimeNow)) {
         //
         // Busy loop for a while to keep the thread hot in case new work comes
@@ -1007,6 +1255,10 @@ QuicWorkerPoolInitialize(
 
     CxPlatZeroMemory(WorkerPool, WorkerPoolSize);
     WorkerPool->WorkerCount = WorkerCount;
+    WorkerPool->WorkStealing =
+        WorkerCount > 1 &&
+        MsQuicLib.ExecutionConfig != NULL &&
+        (MsQuicLib.ExecutionConfig->Flags & QUIC_GLOBAL_EXECUTION_CONFIG_FLAG_WORK_STEALING);
 
     //
     // Create the set of worker threads and soft affinitize them in order to
@@ -1020,6 +1272,7 @@ QuicWorkerPoolInitialize(
                 Registration,
                 ExecProfile,
                 &MsQuicLib.Partitions[i],
+                WorkerPool,
                 &WorkerPool->Workers[i]);
         if (QUIC_FAILED(Status)) {
             for (uint16_t j = 0; j < i; j++) {
@@ -20,6 +20,11 @@ typedef struct QUIC_CACHEALIGN QUIC_WORKER {
     //
     QUIC_PARTITION* Partition;
 
+    //
+    // The pool this worker is a part of.
+    //
+    QUIC_WORKER_POOL* WorkerPool;
+
     //
     // Event to signal when the execution context (i.e. worker thread) is
     // complete.
@@ -46,6 +51,14 @@ typedef struct QUIC_CACHEALIGN QUIC_WORKER {
     //
     uint32_t AverageQueueDelay;
 
+    //
+    // The number of operations a connection may process per drain, if it
+    // doesn't explicitly configure MaxOperationsPerDrain. Grows while bulk
+    // connections have the worker to themselves and shrinks as queue delay
+    // rises.
+    //
+    uint32_t DrainBudget;
+
     //
     // Timers for the worker's connections.
     //
@@ -84,6 +97,14 @@ typedef struct QUIC_CACHEALIGN QUIC_WORKER {
     uint32_t OperationCount;
     uint64_t DroppedOperationCount;
 
+    //
+    // TRUE if this worker has claimed a connection from another worker that
+    // hasn't been handed over yet. Limits an idle worker to one steal at a time.
+    // Set by this worker and cleared by the other one, so only ever changed
+    // with interlocked operations.
+    //
+    BOOLEAN volatile StealPending;
+
 } QUIC_WORKER;
 
 //
@@ -96,6 +117,11 @@ typedef struct QUIC_WORKER_POOL {
     //
     uint16_t WorkerCount;
 
+    //
+    // TRUE if idle workers may take queued connections from overloaded ones.
+    //
+    BOOLEAN WorkStealing;
+
     //
     // Last least loaded worker.
     //
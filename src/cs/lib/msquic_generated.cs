@@ -219,6 +219,8 @@ namespace Microsoft.Quic
         NO_IDEAL_PROC = 0x0008,
         HIGH_PRIORITY = 0x0010,
         AFFINITIZE = 0x0020,
+        WORK_STEALING = 0x0040,
+        BUSY_POLL = 0x0080,
     }
 
     internal unsafe partial struct QUIC_GLOBAL_EXECUTION_CONFIG
@@ -924,6 +926,12 @@ namespace Microsoft.Quic
 
         [NativeTypeName("uint32_t")]
         internal uint RttVariance;
+
+        [NativeTypeName("uint64_t")]
+        internal ulong RecvAckProcessingTimeUs;
+
+        [NativeTypeName("uint64_t")]
+        internal ulong RecvMaxAckProcessingTimeUs;
     }
 
     internal partial struct QUIC_NETWORK_STATISTICS
@@ -994,6 +1002,11 @@ namespace Microsoft.Quic
         SEND_STATELESS_RETRY,
         CONN_LOAD_REJECT,
         LISTEN_QUEUE_DEPTH,
+        WORK_DRAIN_BUDGET,
+        UDP_RECV_COALESCED,
+        UDP_RECV_COALESCED_SEGMENTS,
+        WORK_CONN_STOLEN,
+        WORK_CONN_MIGRATED,
         MAX,
     }
 
@@ -3400,6 +3413,26 @@ namespace Microsoft.Quic
         }
     }
 
+    internal unsafe partial struct QUIC_STREAM_SEND_BATCH_ENTRY
+    {
+        [NativeTypeName("HQUIC")]
+        internal QUIC_HANDLE* Stream;
+
+        [NativeTypeName("const QUIC_BUFFER *")]
+        internal QUIC_BUFFER* Buffers;
+
+        [NativeTypeName("uint32_t")]
+        internal uint BufferCount;
+
+        internal QUIC_SEND_FLAGS Flags;
+
+        [NativeTypeName("void *")]
+        internal void* ClientSendContext;
+
+        [NativeTypeName("HRESULT")]
+        internal int Status;
+    }
+
     [System.Flags]
     internal enum QUIC_CONNECTION_POOL_FLAGS
     {
@@ -3559,6 +3592,9 @@ namespace Microsoft.Quic
 
         [NativeTypeName("QUIC_REGISTRATION_CLOSE2_FN")]
         internal delegate* unmanaged[Cdecl]<QUIC_HANDLE*, delegate* unmanaged[Cdecl]<void*, void>, void*, void> RegistrationClose2;
+
+        [NativeTypeName("QUIC_STREAM_SEND_BATCH_FN")]
+        internal delegate* unmanaged[Cdecl]<QUIC_HANDLE*, QUIC_STREAM_SEND_BATCH_ENTRY*, uint, int> StreamSendBatch;
     }
 
     internal static unsafe partial class MsQuic
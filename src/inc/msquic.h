@@ -277,6 +277,8 @@ typedef enum QUIC_GLOBAL_EXECUTION_CONFIG_FLAGS {
     QUIC_GLOBAL_EXECUTION_CONFIG_FLAG_NO_IDEAL_PROC    = 0x0008,
     QUIC_GLOBAL_EXECUTION_CONFIG_FLAG_HIGH_PRIORITY    = 0x0010,
     QUIC_GLOBAL_EXECUTION_CONFIG_FLAG_AFFINITIZE       = 0x0020,
+    QUIC_GLOBAL_EXECUTION_CONFIG_FLAG_WORK_STEALING    = 0x0040,
+    QUIC_GLOBAL_EXECUTION_CONFIG_FLAG_BUSY_POLL        = 0x0080,
 } QUIC_GLOBAL_EXECUTION_CONFIG_FLAGS;
 
 DEFINE_ENUM_FLAG_OPERATORS(QUIC_GLOBAL_EXECUTION_CONFIG_FLAGS)
@@ -637,6 +639,9 @@ typedef struct QUIC_STATISTICS_V2 {
 
     uint32_t RttVariance;                   // In microseconds
 
+    uint64_t RecvAckProcessingTimeUs;       // Total time spent processing received ACK frames.
+    uint64_t RecvMaxAckProcessingTimeUs;    // Longest time spent processing a single received ACK frame.
+
     // N.B. New fields must be appended to end
 
 } QUIC_STATISTICS_V2;
@@ -659,6 +664,7 @@ typedef struct QUIC_NETWORK_STATISTICS
 #define QUIC_STATISTICS_V2_SIZE_2   QUIC_STRUCT_SIZE_THRU_FIELD(QUIC_STATISTICS_V2, DestCidUpdateCount)     // MsQuic v2.1 final size
 #define QUIC_STATISTICS_V2_SIZE_3   QUIC_STRUCT_SIZE_THRU_FIELD(QUIC_STATISTICS_V2, SendEcnCongestionCount) // MsQuic v2.2 final size
 #define QUIC_STATISTICS_V2_SIZE_4   QUIC_STRUCT_SIZE_THRU_FIELD(QUIC_STATISTICS_V2, RttVariance)            // MsQuic v2.5 final size
+#define QUIC_STATISTICS_V2_SIZE_5   QUIC_STRUCT_SIZE_THRU_FIELD(QUIC_STATISTICS_V2, RecvMaxAckProcessingTimeUs) // MsQuic v2.6 final size
 
 typedef struct QUIC_LISTENER_STATISTICS {
 
@@ -703,6 +709,11 @@ typedef enum QUIC_PERFORMANCE_COUNTERS {
     QUIC_PERF_COUNTER_SEND_STATELESS_RETRY, // Total stateless retry packets sent ever.
     QUIC_PERF_COUNTER_CONN_LOAD_REJECT,     // Total connections rejected due to worker load.
     QUIC_PERF_COUNTER_LISTEN_QUEUE_DEPTH,   // Current listeners queued for processing.
+    QUIC_PERF_COUNTER_WORK_DRAIN_BUDGET,    // Current sum of worker per-connection drain budgets.
+    QUIC_PERF_COUNTER_UDP_RECV_COALESCED,   // Total coalesced (GRO/URO) UDP receives.
+    QUIC_PERF_COUNTER_UDP_RECV_COALESCED_SEGMENTS, // Total UDP datagrams received in coalesced receives.
+    QUIC_PERF_COUNTER_WORK_CONN_STOLEN,     // Total connections claimed from overloaded workers.
+    QUIC_PERF_COUNTER_WORK_CONN_MIGRATED,   // Total connections handed over to idle workers.
     QUIC_PERF_COUNTER_MAX,
 } QUIC_PERFORMANCE_COUNTERS;
 
@@ -1747,6 +1758,40 @@ QUIC_STATUS
     _In_reads_(BufferCount) const QUIC_BUFFER* Buffers
     );
 
+//
+// A single send in a StreamSendBatch call. The fields mirror the StreamSend
+// parameters. Status is set to the result of the individual send:
+// QUIC_STATUS_PENDING if it was queued, otherwise a failure, in which case no
+// SEND_COMPLETE event will be indicated for it.
+//
+typedef struct QUIC_STREAM_SEND_BATCH_ENTRY {
+    HQUIC Stream;
+    _Field_size_(BufferCount)
+    const QUIC_BUFFER* Buffers;
+    uint32_t BufferCount;
+    QUIC_SEND_FLAGS Flags;
+    void* ClientSendContext;
+    QUIC_STATUS Status;
+} QUIC_STREAM_SEND_BATCH_ENTRY;
+
+//
+// Sends data on many streams of the same connection at once. The sends are
+// handed to the connection as a single unit of work, rather than one per
+// stream. Returns QUIC_STATUS_PENDING if the batch was accepted, with each
+// entry's Status saying whether its send was queued. Like StreamSend, the data
+// is sent asynchronously: each queued send is completed later by its own
+// QUIC_STREAM_EVENT_SEND_COMPLETE.
+//
+typedef
+_IRQL_requires_max_(DISPATCH_LEVEL)
+QUIC_STATUS
+(QUIC_API * QUIC_STREAM_SEND_BATCH_FN)(
+    _In_ _Pre_defensive_ HQUIC Connection,
+    _Inout_updates_(EntryCount) _Pre_defensive_
+        QUIC_STREAM_SEND_BATCH_ENTRY* Entries,
+    _In_ uint32_t EntryCount
+    );
+
 #endif
 
 //
@@ -1882,6 +1927,7 @@ typedef struct QUIC_API_TABLE {
     QUIC_EXECUTION_POLL_FN              ExecutionPoll;      // Available from v2.5
 #endif // _KERNEL_MODE
     QUIC_REGISTRATION_CLOSE2_FN         RegistrationClose2; // Available from v2.6
+    QUIC_STREAM_SEND_BATCH_FN           StreamSendBatch;    // Available from v2.6
 #endif // QUIC_API_ENABLE_PREVIEW_FEATURES
 
 } QUIC_API_TABLE;
@@ -102,6 +102,24 @@ typedef struct QUIC_PRIVATE_TRANSPORT_PARAMETER {
     const uint8_t* Buffer;
 } QUIC_PRIVATE_TRANSPORT_PARAMETER;
 
+//
+// Impairments the in-process memory datapath applies to each datagram, to
+// emulate a network path. Zero disables the respective impairment.
+//
+typedef struct QUIC_PRIVATE_DATAPATH_EMULATION {
+    uint32_t DelayUs;           // One-way delay added to every datagram.
+    uint32_t JitterUs;          // Maximum random extra delay. Keeps datagram order.
+    uint32_t LossPpm;           // Random loss probability, in parts per million.
+    uint32_t BurstLossPpm;      // Probability, in ppm, that a loss burst starts.
+    uint32_t BurstLossLength;   // Datagrams dropped by each loss burst.
+    uint32_t ReorderPpm;        // Probability, in ppm, a datagram is held back.
+    uint32_t ReorderDelayUs;    // Extra delay of held back datagrams.
+    uint32_t BandwidthKbps;     // Link rate of the token bucket.
+    uint32_t BucketBytes;       // Token bucket size. Zero is one datagram.
+    uint32_t QueueBytes;        // Bottleneck queue depth; tail drops beyond.
+    uint32_t Seed;              // Seeds the random impairments.
+} QUIC_PRIVATE_DATAPATH_EMULATION;
+
 #define QUIC_PARAM_PREFIX_PRIVATE                        0x80000000
 
 //
@@ -126,6 +144,67 @@ typedef struct QUIC_PRIVATE_TRANSPORT_PARAMETER {
 //
 #define QUIC_PARAM_GLOBAL_DATAPATH_DSCP_RECV_ENABLED    0x81000007 // BOOLEAN
 
+//
+// Sets whether the datapath will be initialized to send without copying the
+// payload into the kernel, on platforms that support it.
+//
+#define QUIC_PARAM_GLOBAL_DATAPATH_SEND_ZEROCOPY_ENABLED 0x81000008 // BOOLEAN
+
+//
+// Sets the minimum size, in bytes, of a send for it to go out zero-copy. Zero
+// uses the datapath's default.
+//
+#define QUIC_PARAM_GLOBAL_DATAPATH_SEND_ZEROCOPY_THRESHOLD 0x81000009 // uint32_t
+
+//
+// Sets whether listener sockets steer packets to the socket of the partition
+// encoded in their connection ID, on platforms that support it.
+//
+#define QUIC_PARAM_GLOBAL_DATAPATH_CID_STEERING_ENABLED 0x8100000A // BOOLEAN
+
+//
+// Sets whether paced sends are handed to the kernel with departure times
+// (e.g. SO_TXTIME), on platforms that support it, instead of being held back
+// by the pacing timer.
+//
+#define QUIC_PARAM_GLOBAL_DATAPATH_SEND_TXTIME_ENABLED 0x8100000B // BOOLEAN
+
+//
+// Sets whether received packets are stamped with the time the kernel received
+// them (e.g. SO_TIMESTAMPING), on platforms that support it, so ACK delays and
+// RTT samples exclude the time spent queued before processing.
+//
+#define QUIC_PARAM_GLOBAL_DATAPATH_RECV_TIMESTAMP_ENABLED 0x8100000C // BOOLEAN
+
+//
+// Sets whether UDP traffic is looped through an in-process memory datapath,
+// on platforms that support it, instead of the network. Both endpoints must
+// run in the same process. Intended for measuring protocol CPU cost only.
+//
+#define QUIC_PARAM_GLOBAL_DATAPATH_MEMORY_ENABLED 0x8100000D // BOOLEAN
+
+//
+// Sets the delay, loss, reordering and bandwidth the in-process memory
+// datapath applies to emulate a network path. Only takes effect along with
+// QUIC_PARAM_GLOBAL_DATAPATH_MEMORY_ENABLED.
+//
+#define QUIC_PARAM_GLOBAL_DATAPATH_EMULATION 0x8100000E // QUIC_PRIVATE_DATAPATH_EMULATION
+
+//
+// Sets whether stream data is encrypted directly from the application's send
+// buffers into the datagram, instead of first being copied into the datagram
+// and then encrypted in place. Enabled by default, but only used with packet
+// keys whose crypto provider is faster that way (see CxPlatKeyPrefersSources).
+//
+#define QUIC_PARAM_GLOBAL_SEND_FUSED_ENCRYPT_ENABLED 0x8100000F // BOOLEAN
+
+//
+// Sets whether 1-RTT packets are decrypted on the datapath thread that
+// receives them, before they are queued to the connection's worker, instead of
+// on the worker itself. Disabled by default.
+//
+#define QUIC_PARAM_GLOBAL_RECV_PARALLEL_DECRYPT_ENABLED 0x81000010 // BOOLEAN
+
 //
 // The different private parameters for Configuration.
 //
@@ -329,6 +329,76 @@ CxPlatDecrypt(
         uint8_t* Buffer
     );
 
+//
+// A run of plain text that hasn't been copied into a batch entry's Buffer yet.
+// Offset is relative to the start of Buffer.
+//
+typedef struct CXPLAT_CRYPT_SOURCE {
+    const uint8_t* Buffer;
+    uint16_t Offset;
+    uint16_t Length;
+} CXPLAT_CRYPT_SOURCE;
+
+//
+// A single packet's input to a batched AEAD operation. The fields match the
+// parameters of CxPlatEncrypt/CxPlatDecrypt; Status is written with the result
+// for this packet.
+//
+// For encryption, Sources optionally lists (in increasing, non-overlapping
+// Offset order) ranges of the plain text that are read from elsewhere instead
+// of from Buffer. The cipher text is always written to Buffer, so this lets the
+// caller skip copying the plain text in first. Decryption requires SourceCount
+// to be zero.
+//
+typedef struct CXPLAT_CRYPT_BATCH_ENTRY {
+    const uint8_t* Iv;
+    const uint8_t* AuthData;
+    uint8_t* Buffer;
+    const CXPLAT_CRYPT_SOURCE* Sources;
+    uint16_t AuthDataLength;
+    uint16_t BufferLength;
+    uint8_t SourceCount;
+    QUIC_STATUS Status;
+} CXPLAT_CRYPT_BATCH_ENTRY;
+
+//
+// Encrypts a batch of packets with the same key. Equivalent to calling
+// CxPlatEncrypt on each entry in order (after copying in any Sources), but lets
+// the implementation amortize per call setup and interleave the packets.
+// Processing stops at the first failure, which is returned.
+//
+_IRQL_requires_max_(DISPATCH_LEVEL)
+QUIC_STATUS
+CxPlatEncryptBatch(
+    _In_ CXPLAT_KEY* Key,
+    _In_ uint8_t BatchSize,
+    _Inout_updates_(BatchSize) CXPLAT_CRYPT_BATCH_ENTRY* Batch
+    );
+
+//
+// Returns TRUE if CxPlatEncryptBatch encrypts the key's packets faster from
+// Sources than after the caller copies the plain text into Buffer. Otherwise
+// Sources still work, but callers should copy the plain text in themselves.
+//
+_IRQL_requires_max_(DISPATCH_LEVEL)
+BOOLEAN
+CxPlatKeyPrefersSources(
+    _In_ const CXPLAT_KEY* Key
+    );
+
+//
+// Decrypts a batch of packets with the same key. Every entry is processed and
+// its Status set independently, so one packet failing authentication doesn't
+// affect the others. Returns success only if all entries were decrypted.
+//
+_IRQL_requires_max_(DISPATCH_LEVEL)
+QUIC_STATUS
+CxPlatDecryptBatch(
+    _In_ CXPLAT_KEY* Key,
+    _In_ uint8_t BatchSize,
+    _Inout_updates_(BatchSize) CXPLAT_CRYPT_BATCH_ENTRY* Batch
+    );
+
 _IRQL_requires_max_(DISPATCH_LEVEL)
 QUIC_STATUS
 CxPlatHpKeyCreate(
@@ -406,6 +476,34 @@ CxPlatKbKdfDerive(
     _Out_writes_(OutputLength) uint8_t* Output
     );
 
+#ifdef CXPLAT_NATIVE_CRYPTO
+
+//
+// Instruction set extensions used by the built-in ChaCha20 header protection,
+// when present on the CPU.
+//
+#define CXPLAT_NATIVE_CRYPT_CHACHA_AVX2     0x1 // AVX2
+
+//
+// Returns the CXPLAT_NATIVE_CRYPT_* features currently in use.
+//
+uint32_t
+CxPlatCryptGetNativeFeatures(
+    void
+    );
+
+//
+// Restricts the native features used by keys created afterwards. Features not
+// supported by the CPU are ignored. Keys whose algorithm has no enabled native
+// implementation fall back to OpenSSL.
+//
+void
+CxPlatCryptSetNativeFeatures(
+    _In_ uint32_t Features
+    );
+
+#endif // CXPLAT_NATIVE_CRYPTO
+
 #if defined(__cplusplus)
 }
 #endif
@@ -159,6 +159,12 @@ PacketSizeFromUdpPayloadSize(
 //
 typedef struct CXPLAT_DATAPATH CXPLAT_DATAPATH;
 typedef struct CXPLAT_DATAPATH_RAW CXPLAT_DATAPATH_RAW;
+typedef struct CXPLAT_DATAPATH_MEMORY CXPLAT_DATAPATH_MEMORY;
+
+//
+// Network impairments for the memory datapath. Defined in msquicp.h.
+//
+typedef struct QUIC_PRIVATE_DATAPATH_EMULATION QUIC_PRIVATE_DATAPATH_EMULATION;
 
 //
 // Represents a UDP or TCP abstraction.
@@ -243,6 +249,12 @@ typedef struct CXPLAT_RECV_DATA {
     _Field_size_(BufferLength)
     uint8_t* Buffer;
 
+    //
+    // The time, in CxPlatTimeUs64 units, the datagram was received by the
+    // platform, or zero if unknown. See CXPLAT_DATAPATH_FEATURE_RECV_TIMESTAMP.
+    //
+    uint64_t ReceiveTimeUs;
+
     //
     // Length of the valid data in Buffer.
     //
@@ -273,6 +285,14 @@ typedef struct CXPLAT_RECV_DATA {
     uint16_t Reserved : 4;           // PACKET_TYPE (at least 3 bits)
     uint16_t ReservedEx : 8;         // Header length
 
+    //
+    // The number of datagrams, starting with this one, that were split from
+    // the same coalesced (GRO/URO) receive. The rest directly follow this one
+    // in the chain, share its route and IP header fields, and their buffers
+    // are laid out back to back. One if the datagram was not coalesced.
+    //
+    uint16_t CoalescedCount;
+
     //
     // Variable length data (of size `ClientRecvContextLength` passed into
     // CxPlatDataPathInitialize) directly follows.
@@ -436,6 +456,10 @@ typedef enum CXPLAT_DATAPATH_FEATURES {
     CXPLAT_DATAPATH_FEATURE_TTL                = 0x00000080,
     CXPLAT_DATAPATH_FEATURE_SEND_DSCP          = 0x00000100,
     CXPLAT_DATAPATH_FEATURE_RECV_DSCP          = 0x00000200,
+    CXPLAT_DATAPATH_FEATURE_SEND_ZEROCOPY      = 0x00000400,
+    CXPLAT_DATAPATH_FEATURE_CID_STEERING       = 0x00000800,
+    CXPLAT_DATAPATH_FEATURE_SEND_TXTIME        = 0x00001000,
+    CXPLAT_DATAPATH_FEATURE_RECV_TIMESTAMP     = 0x00002000,
 } CXPLAT_DATAPATH_FEATURES;
 
 DEFINE_ENUM_FLAG_OPERATORS(CXPLAT_DATAPATH_FEATURES)
@@ -476,6 +500,62 @@ typedef struct CXPLAT_DATAPATH_INIT_CONFIG {
     // the Windows fast path causing a large performance regression.
     //
     BOOLEAN EnableDscpOnRecv;
+
+    //
+    // Whether the datapath should transmit straight out of its send buffers,
+    // without the kernel copying the payload, where the platform supports it.
+    // CXPLAT_DATAPATH_FEATURE_SEND_ZEROCOPY indicates if it is in use.
+    //
+    BOOLEAN EnableSendZeroCopy;
+
+    //
+    // The minimum payload size of a single send for it to go out zero-copy.
+    // Smaller sends are cheaper to copy than to track until the kernel
+    // releases them. Zero uses the platform default.
+    //
+    uint32_t SendZeroCopyThreshold;
+
+    //
+    // Whether server sockets should steer short header packets to the socket
+    // of the partition encoded in their destination CID, where the platform
+    // supports it. See CXPLAT_UDP_CONFIG's PartitionIdOffsetDst.
+    // CXPLAT_DATAPATH_FEATURE_CID_STEERING indicates if it is in use.
+    //
+    BOOLEAN EnableCidSteering;
+
+    //
+    // The time, in microseconds, sockets should busy poll the device receive
+    // queue for, where the platform supports it. Zero disables busy polling.
+    //
+    uint32_t BusyPollUs;
+
+    //
+    // Whether sends may carry a departure time for the kernel to hold them
+    // until, where the platform supports it. CXPLAT_DATAPATH_FEATURE_SEND_TXTIME
+    // indicates if it is in use.
+    //
+    BOOLEAN EnableSendTxTime;
+
+    //
+    // Whether received datagrams should carry the time the kernel received
+    // them, where the platform supports it. CXPLAT_DATAPATH_FEATURE_RECV_TIMESTAMP
+    // indicates if it is in use.
+    //
+    BOOLEAN EnableRecvTimestamp;
+
+    //
+    // Whether UDP sockets should be created on the in-process memory datapath
+    // instead of the network, where the platform supports it. Sends are looped
+    // directly into the receive path of the socket bound to the destination
+    // port in the same process. Intended for benchmarking only.
+    //
+    BOOLEAN EnableMemoryDatapath;
+
+    //
+    // The network impairments the memory datapath applies to each datagram,
+    // or NULL to deliver them immediately.
+    //
+    const QUIC_PRIVATE_DATAPATH_EMULATION* Emulation;
 } CXPLAT_DATAPATH_INIT_CONFIG;
 
 //
@@ -622,6 +702,11 @@ typedef struct CXPLAT_UDP_CONFIG {
     uint8_t CibirIdOffsetSrc;           // CIBIR ID offset in source CID
     uint8_t CibirIdOffsetDst;           // CIBIR ID offset in destination CID
     uint8_t CibirId[6];                 // CIBIR ID data
+
+    // used for CID steering (CXPLAT_DATAPATH_INIT_CONFIG.EnableCidSteering)
+    uint8_t PartitionIdOffsetDst;       // Partition ID offset in destination CID
+    uint16_t PartitionIdMask;           // Partition ID bits holding the index
+    uint16_t PartitionCount;            // Must match the datapath's partition count, else steering isn't used
 } CXPLAT_UDP_CONFIG;
 
 //
@@ -749,6 +834,7 @@ typedef struct CXPLAT_SEND_CONFIG {
     uint8_t ECN; // CXPLAT_ECN_TYPE
     uint8_t Flags; // CXPLAT_SEND_FLAGS
     uint8_t DSCP; // CXPLAT_DSCP_TYPE
+    uint64_t DepartureTimeUs; // Zero to send immediately. See CXPLAT_DATAPATH_FEATURE_SEND_TXTIME.
 } CXPLAT_SEND_CONFIG;
 
 //
@@ -853,6 +939,22 @@ CxPlatSocketGetTcpStatistics(
     _Out_ CXPLAT_TCP_STATISTICS* Statistics
     );
 
+typedef struct CXPLAT_UDP_STATISTICS {
+    uint64_t ZeroCopySends;             // Sends the kernel took without copying
+    uint64_t ZeroCopySendsCompleted;    // Of those, the ones it released
+} CXPLAT_UDP_STATISTICS;
+
+//
+// Queries UDP socket statistics, summed over the socket's per-processor
+// sockets.
+//
+_IRQL_requires_max_(DISPATCH_LEVEL)
+QUIC_STATUS
+CxPlatSocketGetUdpStatistics(
+    _In_ CXPLAT_SOCKET* Socket,
+    _Out_ CXPLAT_UDP_STATISTICS* Statistics
+    );
+
 //
 // Function pointer type for datapath route resolution callbacks.
 //
@@ -11,6 +11,15 @@ Abstract:
     enumeration means enumeration that requires exclusive access to the table
     during the entire enumeration.
 
+    Two backends share this interface. By default, tables are chained (linear
+    hashing over doubly-linked bucket lists). Tables created with the
+    CXPLAT_HASH_OPEN_ADDRESSING flag instead use a flat, open-addressing layout
+    with one control byte per slot, probed a group of 16 slots at a time, and
+    the full 64-bit signature stored inline next to the entry pointer. For
+    keys that fit in the signature (e.g. stream IDs) a lookup never touches an
+    entry that doesn't match. Open addressing tables may fail to insert if they
+    are full and can't grow.
+
 Usage examples:
 
     void
@@ -85,8 +94,10 @@ extern "C" {
 #pragma warning(disable:4201)  // nonstandard extension used: nameless struct/union
 
 #define CXPLAT_HASH_ALLOCATED_HEADER 0x00000001
+#define CXPLAT_HASH_OPEN_ADDRESSING  0x00000002
 
 #define CXPLAT_HASH_MIN_SIZE 128
+#define CXPLAT_HASH_OPEN_ADDRESSING_MIN_SIZE 16
 
 typedef struct CXPLAT_HASHTABLE_ENTRY {
     CXPLAT_LIST_ENTRY Linkage;
@@ -111,8 +122,19 @@ typedef struct CXPLAT_HASHTABLE_LOOKUP_CONTEXT {
     // 3. Signature is used primarily as a safety check in insertion. This field
     //    must match the Signature of the entry being inserted.
     //
-    CXPLAT_LIST_ENTRY* ChainHead;
-    CXPLAT_LIST_ENTRY* PrevLinkage;
+    // Open addressing tables instead track where in the probe sequence the
+    // last match was found, so that the lookup can be resumed from there.
+    //
+    union {
+        struct {
+            CXPLAT_LIST_ENTRY* ChainHead;
+            CXPLAT_LIST_ENTRY* PrevLinkage;
+        };
+        struct {
+            uint32_t ProbeIndex;
+            uint32_t SlotIndex;
+        };
+    };
     uint64_t Signature;
 } CXPLAT_HASHTABLE_LOOKUP_CONTEXT;
 
@@ -132,7 +154,10 @@ typedef struct CXPLAT_HASHTABLE {
 
     // Entries used in bucket computation.
     uint32_t TableSize;
-    uint32_t Pivot;
+    union {
+        uint32_t Pivot;
+        uint32_t NumDeleted; // When CXPLAT_HASH_OPEN_ADDRESSING
+    };
     uint32_t DivisorMask;
 
     // Counters
@@ -145,6 +170,7 @@ typedef struct CXPLAT_HASHTABLE {
         void* Directory;
         CXPLAT_LIST_ENTRY* SecondLevelDir; // When TableSize <= HT_SECOND_LEVEL_DIR_MIN_SIZE
         CXPLAT_LIST_ENTRY** FirstLevelDir; // When TableSize > HT_SECOND_LEVEL_DIR_MIN_SIZE
+        uint8_t* Control; // When CXPLAT_HASH_OPEN_ADDRESSING, followed by slots
     };
 
 } CXPLAT_HASHTABLE;
@@ -158,6 +184,16 @@ CxPlatHashtableInitialize(
     _In_ uint32_t InitialSize
     );
 
+_Must_inspect_result_
+_Success_(return != FALSE)
+BOOLEAN
+CxPlatHashtableInitializeWithFlags(
+    _Inout_ _When_(NULL == *HashTable, _At_(*HashTable, __drv_allocatesMem(Mem) _Post_notnull_))
+        CXPLAT_HASHTABLE** HashTable,
+    _In_ uint32_t InitialSize,
+    _In_ uint32_t Flags
+    );
+
 QUIC_INLINE
 _Must_inspect_result_
 _Success_(return != FALSE)
@@ -178,7 +214,11 @@ CxPlatHashtableUninitialize(
         CXPLAT_HASHTABLE* HashTable
     );
 
-void
+//
+// Always succeeds for chained tables. Open addressing tables return FALSE if
+// the table is full and could not be grown.
+//
+BOOLEAN
 CxPlatHashtableInsert(
     _In_ CXPLAT_HASHTABLE* HashTable,
     _In_ __drv_aliasesMem CXPLAT_HASHTABLE_ENTRY* Entry,
@@ -161,6 +161,8 @@ typedef struct CXPLAT_SLIST_ENTRY {
 #define QUIC_POOL_DATAPATH_RSS_CONFIG       'F4cQ' // Qc4F - QUIC Datapath RSS configuration
 #define QUIC_POOL_TLS_AUX_DATA              '05cQ' // Qc50 - QUIC TLS Backing Aux data
 #define QUIC_POOL_TLS_RECORD_ENTRY          '15cQ' // Qc51 - QUIC TLS Backing Record storage
+#define QUIC_POOL_LOOKUP_CID                '25cQ' // Qc52 - QUIC Lookup CID Entry
+#define QUIC_POOL_SEND_BATCH                '35cQ' // Qc53 - QUIC Stream send batch
 
 typedef enum CXPLAT_THREAD_FLAGS {
     CXPLAT_THREAD_FLAG_NONE               = 0x0000,
@@ -430,6 +432,32 @@ CxPlatListPopEntry(
     return FirstEntry;
 }
 
+//
+// Returns the index of the least significant set bit. The mask must not be 0.
+//
+FORCEINLINE
+uint32_t
+CxPlatFirstSetBit64(
+    _In_ uint64_t Mask
+    )
+{
+    CXPLAT_DBG_ASSERT(Mask != 0);
+#if defined(_MSC_VER)
+    unsigned long Index;
+#if defined(_WIN64)
+    _BitScanForward64(&Index, Mask);
+#else
+    if (!_BitScanForward(&Index, (unsigned long)Mask)) {
+        _BitScanForward(&Index, (unsigned long)(Mask >> 32));
+        Index += 32;
+    }
+#endif
+    return (uint32_t)Index;
+#else
+    return (uint32_t)__builtin_ctzll(Mask);
+#endif
+}
+
 #include "quic_hashtable.h"
 #include "quic_toeplitz.h"
 
@@ -471,6 +499,13 @@ typedef struct CXPLAT_EXECUTION_STATE {
 
 typedef struct CXPLAT_WORKER_POOL CXPLAT_WORKER_POOL;
 
+//
+// The default time, in microseconds, a busy polling worker keeps polling for
+// new work after its last work item, if the execution config's
+// PollingIdleTimeoutUs doesn't specify one.
+//
+#define CXPLAT_DEFAULT_BUSY_POLL_US 50
+
 #ifndef _KERNEL_MODE
 
 //
@@ -246,6 +246,17 @@ InterlockedExchangePointer(
     return __sync_lock_test_and_set(Target, Value);
 }
 
+QUIC_INLINE
+void*
+InterlockedCompareExchangePointer(
+    _Inout_ _Interlocked_operand_ void* volatile *Destination,
+    _In_opt_ void* ExChange,
+    _In_opt_ void* Comperand
+    )
+{
+    return __sync_val_compare_and_swap(Destination, Comperand, ExChange);
+}
+
 QUIC_INLINE
 void*
 InterlockedFetchAndClearPointer(
@@ -486,7 +497,19 @@ CXPLAT_SLIST_ENTRY*
 CxPlatListPopEntry(
     _Inout_ CXPLAT_SLIST_ENTRY* ListHead
     );
-typedef struct CXPLAT_POOL {
+//
+// Number of per-thread magazines in each pool. A pool is generally only hit by
+// a handful of threads (the partition's worker, the datapath threads and the
+// occasional app thread); any further threads share the depot directly.
+//
+#define CXPLAT_POOL_MAGAZINE_COUNT  4
+
+//
+// A per-thread cache of free entries. Only the thread that claimed the
+// magazine ever touches it, so it needs no synchronization. Padded out so that
+// the magazines of different threads never share a cache line.
+//
+typedef struct CXPLAT_POOL_MAGAZINE {
 
     //
     // List of free entries.
@@ -494,18 +517,56 @@ typedef struct CXPLAT_POOL {
 
     CXPLAT_SLIST_ENTRY ListHead;
 
+    //
+    // Last entry in the list, so the whole list can be returned to the depot
+    // in a single push.
+    //
+
+    CXPLAT_SLIST_ENTRY* ListTail;
+
     //
     // Number of free entries in the list.
     //
 
     uint16_t ListDepth;
 
+    uint8_t Reserved[128 - 2 * sizeof(void*) - sizeof(uint16_t)];
+
+} CXPLAT_POOL_MAGAZINE;
+
+typedef struct CXPLAT_POOL {
+
     //
-    // Lock to synchronize access to the List.
-    // LINUX_TODO: Check how to make this lock free?
+    // The thread that claimed each magazine. Claimed by the first allocs and
+    // frees from each thread and kept for the lifetime of the pool. Kept apart
+    // from the magazines themselves, so looking up the calling thread's magazine
+    // only reads this (mostly read-only) array.
     //
 
-    CXPLAT_LOCK Lock;
+    void* volatile MagazineOwners[CXPLAT_POOL_MAGAZINE_COUNT];
+
+    //
+    // Set while a thread is popping from the depot. Only allowing a single
+    // popper at a time is what makes the depot safe from ABA. Threads that find
+    // it already set don't wait; they fall back to the system allocator.
+    //
+
+    BOOLEAN DepotBusy;
+
+    //
+    // Lock free stack of free entries (the depot). Magazines return their
+    // entries here in batches when they fill up, and take the whole depot back
+    // in one batch when they run empty. This is how entries freed on one thread
+    // make their way back to the thread that allocates them.
+    //
+
+    CXPLAT_SLIST_ENTRY* volatile DepotHead;
+
+    //
+    // Approximate number of free entries in the depot.
+    //
+
+    int64_t DepotDepth;
 
     //
     // Size of entries.
@@ -519,6 +580,12 @@ typedef struct CXPLAT_POOL {
 
     uint32_t Tag;
 
+    //
+    // Per-thread caches of free entries.
+    //
+
+    CXPLAT_POOL_MAGAZINE Magazines[CXPLAT_POOL_MAGAZINE_COUNT];
+
 } CXPLAT_POOL;
 
 #define CXPLAT_MEMORY_ALIGNMENT 16
@@ -548,6 +615,12 @@ CxPlatGetAllocFailDenominator(
     );
 #endif
 
+//
+// Identifies the calling thread for magazine ownership. pthread_self is used
+// instead of CxPlatCurThreadID because it doesn't need a system call.
+//
+#define CxPlatPoolCurThread() ((void*)(uintptr_t)pthread_self())
+
 QUIC_INLINE
 void
 CxPlatPoolInitialize(
@@ -559,24 +632,182 @@ CxPlatPoolInitialize(
 {
     Pool->Size = Size + sizeof(CXPLAT_POOL_HEADER); // Add space for the pool header
     Pool->Tag = Tag;
-    CxPlatLockInitialize(&Pool->Lock);
-    Pool->ListDepth = 0;
-    CxPlatZeroMemory(&Pool->ListHead, sizeof(Pool->ListHead));
+    for (uint32_t i = 0; i < CXPLAT_POOL_MAGAZINE_COUNT; ++i) {
+        Pool->MagazineOwners[i] = NULL;
+        Pool->Magazines[i].ListHead.Next = NULL;
+        Pool->Magazines[i].ListTail = NULL;
+        Pool->Magazines[i].ListDepth = 0;
+    }
+    Pool->DepotBusy = FALSE;
+    Pool->DepotHead = NULL;
+    Pool->DepotDepth = 0;
     UNREFERENCED_PARAMETER(IsPaged);
 }
 
 QUIC_INLINE
 void
-CxPlatPoolUninitialize(
-    _Inout_ CXPLAT_POOL* Pool
+CxPlatPoolFreeList(
+    _In_ CXPLAT_POOL* Pool,
+    _In_opt_ CXPLAT_SLIST_ENTRY* List
     )
 {
     CXPLAT_POOL_HEADER* Entry;
-    while ((Entry = (CXPLAT_POOL_HEADER*)CxPlatListPopEntry(&Pool->ListHead)) != NULL) {
+    while ((Entry = (CXPLAT_POOL_HEADER*)List) != NULL) {
+        List = List->Next;
         CXPLAT_DBG_ASSERT(Entry->SpecialFlag == CXPLAT_POOL_FREE_FLAG);
         CxPlatFree(Entry, Pool->Tag);
     }
-    CxPlatLockUninitialize(&Pool->Lock);
+}
+
+QUIC_INLINE
+void
+CxPlatPoolUninitialize(
+    _Inout_ CXPLAT_POOL* Pool
+    )
+{
+    for (uint32_t i = 0; i < CXPLAT_POOL_MAGAZINE_COUNT; ++i) {
+        CxPlatPoolFreeList(Pool, Pool->Magazines[i].ListHead.Next);
+        Pool->Magazines[i].ListHead.Next = NULL;
+        Pool->Magazines[i].ListTail = NULL;
+        Pool->Magazines[i].ListDepth = 0;
+        Pool->MagazineOwners[i] = NULL;
+    }
+    CxPlatPoolFreeList(Pool, Pool->DepotHead);
+    Pool->DepotHead = NULL;
+    Pool->DepotDepth = 0;
+}
+
+//
+// Returns the calling thread's magazine, optionally claiming a free one if it
+// doesn't have one yet. Returns NULL if the thread has no magazine and none
+// could be claimed.
+//
+QUIC_INLINE
+CXPLAT_POOL_MAGAZINE*
+CxPlatPoolGetMagazine(
+    _Inout_ CXPLAT_POOL* Pool,
+    _In_ BOOLEAN Claim
+    )
+{
+    void* Self = CxPlatPoolCurThread();
+    for (uint32_t i = 0; i < CXPLAT_POOL_MAGAZINE_COUNT; ++i) {
+        void* Owner = QuicReadPtrNoFence(&Pool->MagazineOwners[i]);
+        if (Owner == Self) {
+            return &Pool->Magazines[i];
+        }
+        if (Owner == NULL && Claim &&
+            InterlockedCompareExchangePointer(
+                &Pool->MagazineOwners[i], Self, NULL) == NULL) {
+            return &Pool->Magazines[i];
+        }
+    }
+    return NULL;
+}
+
+//
+// Pushes a chain of free entries onto the depot with a single compare
+// exchange. Safe to call from any thread.
+//
+QUIC_INLINE
+void
+CxPlatPoolDepotPush(
+    _Inout_ CXPLAT_POOL* Pool,
+    _Inout_ CXPLAT_SLIST_ENTRY* First,
+    _Inout_ CXPLAT_SLIST_ENTRY* Last,
+    _In_ uint16_t Count
+    )
+{
+    CXPLAT_SLIST_ENTRY* Head;
+    do {
+        Head = QuicReadPtrNoFence(&Pool->DepotHead);
+        Last->Next = Head;
+    } while (InterlockedCompareExchangePointer(
+                (void* volatile*)&Pool->DepotHead, First, Head) != Head);
+    InterlockedExchangeAdd64(&Pool->DepotDepth, Count);
+}
+
+//
+// Returns all of a magazine's entries to the depot in one batch, unless the
+// depot is already full.
+//
+QUIC_INLINE
+void
+CxPlatPoolMagazineFlush(
+    _Inout_ CXPLAT_POOL* Pool,
+    _Inout_ CXPLAT_POOL_MAGAZINE* Magazine
+    )
+{
+    if (Magazine->ListDepth == 0 ||
+        QuicReadLongPtrNoFence(&Pool->DepotDepth) >= CXPLAT_POOL_MAXIMUM_DEPTH) {
+        return;
+    }
+    CxPlatPoolDepotPush(
+        Pool,
+        Magazine->ListHead.Next,
+        Magazine->ListTail,
+        Magazine->ListDepth);
+    Magazine->ListHead.Next = NULL;
+    Magazine->ListTail = NULL;
+    Magazine->ListDepth = 0;
+}
+
+//
+// Pops from the depot, returning NULL if it is empty or another thread is
+// already popping. Since there is only ever a single popper, the head can't be
+// popped and pushed back between reading its Next and the compare exchange.
+// If the caller has a magazine, it takes the whole depot, keeps one entry and
+// refills its magazine with the rest.
+//
+QUIC_INLINE
+CXPLAT_POOL_HEADER*
+CxPlatPoolDepotPop(
+    _Inout_ CXPLAT_POOL* Pool,
+    _Inout_opt_ CXPLAT_POOL_MAGAZINE* Magazine
+    )
+{
+    if (QuicReadPtrNoFence(&Pool->DepotHead) == NULL ||
+        InterlockedFetchAndSetBoolean(&Pool->DepotBusy)) {
+        return NULL;
+    }
+
+    CXPLAT_SLIST_ENTRY* Head;
+    if (Magazine != NULL) {
+        CXPLAT_DBG_ASSERT(Magazine->ListDepth == 0);
+        Head =
+            (CXPLAT_SLIST_ENTRY*)InterlockedExchangePointer(
+                (void* volatile*)&Pool->DepotHead, NULL);
+        if (Head != NULL) {
+            int64_t Count = 1;
+            CXPLAT_SLIST_ENTRY* Entry = Head->Next;
+            if (Entry != NULL) {
+                Magazine->ListHead.Next = Entry;
+                while (Entry->Next != NULL) {
+                    Entry = Entry->Next;
+                    Count++;
+                }
+                Magazine->ListTail = Entry;
+                Magazine->ListDepth = (uint16_t)Count;
+                Count++;
+            }
+            InterlockedExchangeAdd64(&Pool->DepotDepth, -Count);
+        }
+    } else {
+        CXPLAT_SLIST_ENTRY* Prev;
+        Head = QuicReadPtrNoFence(&Pool->DepotHead);
+        while (Head != NULL) {
+            Prev = Head;
+            Head =
+                (CXPLAT_SLIST_ENTRY*)InterlockedCompareExchangePointer(
+                    (void* volatile*)&Pool->DepotHead, Head->Next, Head);
+            if (Head == Prev) {
+                InterlockedDecrement64(&Pool->DepotDepth);
+                break;
+            }
+        }
+    }
+
+    InterlockedFetchAndClearBoolean(&Pool->DepotBusy);
+    return (CXPLAT_POOL_HEADER*)Head;
 }
 
 QUIC_INLINE
@@ -585,19 +816,29 @@ CxPlatPoolAlloc(
     _Inout_ CXPLAT_POOL* Pool
     )
 {
-    CxPlatLockAcquire(&Pool->Lock);
-    CXPLAT_POOL_HEADER* Header =
-    #if DEBUG
-        CxPlatGetAllocFailDenominator() ? NULL : // No pool when using simulated alloc failures
-    #endif
-        (CXPLAT_POOL_HEADER*)CxPlatListPopEntry(&Pool->ListHead);
+    CXPLAT_POOL_HEADER* Header = NULL;
+#if DEBUG
+    if (CxPlatGetAllocFailDenominator()) {
+        //
+        // No pool when using simulated alloc failures.
+        //
+    } else
+#endif
+    {
+        CXPLAT_POOL_MAGAZINE* Magazine = CxPlatPoolGetMagazine(Pool, TRUE);
+        if (Magazine != NULL && Magazine->ListDepth != 0) {
+            Header = (CXPLAT_POOL_HEADER*)CxPlatListPopEntry(&Magazine->ListHead);
+            if (--Magazine->ListDepth == 0) {
+                Magazine->ListTail = NULL;
+            }
+        } else {
+            Header = CxPlatPoolDepotPop(Pool, Magazine);
+        }
+    }
+
     if (Header != NULL) {
-        CXPLAT_DBG_ASSERT(Pool->ListDepth > 0);
         CXPLAT_DBG_ASSERT(Header->SpecialFlag == CXPLAT_POOL_FREE_FLAG);
-        Pool->ListDepth--;
-    }
-    CxPlatLockRelease(&Pool->Lock);
-    if (Header == NULL) {
+    } else {
         Header = (CXPLAT_POOL_HEADER*)CxPlatAlloc(Pool->Size, Pool->Tag);
         if (Header == NULL) {
             return NULL;
@@ -626,13 +867,30 @@ CxPlatPoolFree(
     }
     Header->SpecialFlag = CXPLAT_POOL_FREE_FLAG;
 #endif
-    if (Pool->ListDepth >= CXPLAT_POOL_MAXIMUM_DEPTH) {
+    CXPLAT_POOL_MAGAZINE* Magazine = CxPlatPoolGetMagazine(Pool, TRUE);
+    if (Magazine == NULL) {
+        if (QuicReadLongPtrNoFence(&Pool->DepotDepth) >= CXPLAT_POOL_MAXIMUM_DEPTH) {
+            CxPlatFree(Header, Pool->Tag);
+        } else {
+            CxPlatPoolDepotPush(Pool, &Header->Entry, &Header->Entry, 1);
+        }
+        return;
+    }
+
+    if (Magazine->ListDepth >= CXPLAT_POOL_MAXIMUM_DEPTH) {
+        //
+        // Full magazine. Hand it back to the depot in one batch, so the
+        // thread(s) allocating from this pool can pick the entries up again.
+        //
+        CxPlatPoolMagazineFlush(Pool, Magazine);
+    }
+    if (Magazine->ListDepth >= CXPLAT_POOL_MAXIMUM_DEPTH) {
         CxPlatFree(Header, Pool->Tag);
     } else {
-        CxPlatLockAcquire(&Pool->Lock);
-        CxPlatListPushEntry(&Pool->ListHead, &Header->Entry);
-        Pool->ListDepth++;
-        CxPlatLockRelease(&Pool->Lock);
+        if (Magazine->ListDepth++ == 0) {
+            Magazine->ListTail = &Header->Entry;
+        }
+        CxPlatListPushEntry(&Magazine->ListHead, &Header->Entry);
     }
 }
 
@@ -642,13 +900,16 @@ CxPlatPoolPrune(
     _Inout_ CXPLAT_POOL* Pool
     )
 {
-    CxPlatLockAcquire(&Pool->Lock);
-    void* Entry = CxPlatListPopEntry(&Pool->ListHead);
-    if (Entry != NULL) {
-        CXPLAT_FRE_ASSERT(Pool->ListDepth > 0);
-        Pool->ListDepth--;
+    void* Entry = CxPlatPoolDepotPop(Pool, NULL);
+    if (Entry == NULL) {
+        CXPLAT_POOL_MAGAZINE* Magazine = CxPlatPoolGetMagazine(Pool, FALSE);
+        if (Magazine != NULL && Magazine->ListDepth != 0) {
+            Entry = CxPlatListPopEntry(&Magazine->ListHead);
+            if (--Magazine->ListDepth == 0) {
+                Magazine->ListTail = NULL;
+            }
+        }
     }
-    CxPlatLockRelease(&Pool->Lock);
     if (Entry == NULL) {
         return FALSE;
     }
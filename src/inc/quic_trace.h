@@ -109,6 +109,7 @@ typedef enum QUIC_TRACE_API_TYPE {
     QUIC_TRACE_API_EXECUTION_DELETE,
     QUIC_TRACE_API_EXECUTION_POLL,
     QUIC_TRACE_API_REGISTRATION_CLOSE2,
+    QUIC_TRACE_API_STREAM_SEND_BATCH,
     QUIC_TRACE_API_COUNT // Must be last
 } QUIC_TRACE_API_TYPE;
 
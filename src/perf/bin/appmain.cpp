@@ -315,7 +315,7 @@ main(
     const char* FileName = nullptr;
     TryGetValue(argc, argv, "extraOutputFile", &FileName);
 
-    if (!TryGetTarget(argc, argv)) { // Only create certificate on server
+    if (!TryGetTarget(argc, argv) || IsMemoryIo(argc, argv)) { // Only create certificate on server
         SelfSignedCredConfig =
             CxPlatGetSelfSignedCert(CXPLAT_SELF_SIGN_CERT_USER, FALSE, NULL);
         if (!SelfSignedCredConfig) {
@@ -15,6 +15,45 @@ Abstract:
 #include "PerfClient.cpp.clog.h"
 #endif
 
+#if !defined(_KERNEL_MODE) && \
+    (defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__))
+#define PERF_CYCLES_SUPPORTED 1
+#ifdef _WIN32
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#include <sys/resource.h>
+#endif
+
+//
+// Returns the CPU time used so far by all the threads of the process.
+//
+static
+uint64_t
+GetProcessCpuTimeUs() {
+#ifdef _WIN32
+    FILETIME Creation, Exit, Kernel, User;
+    if (!GetProcessTimes(GetCurrentProcess(), &Creation, &Exit, &Kernel, &User)) {
+        return 0;
+    }
+    ULARGE_INTEGER KernelTime, UserTime;
+    KernelTime.LowPart = Kernel.dwLowDateTime;
+    KernelTime.HighPart = Kernel.dwHighDateTime;
+    UserTime.LowPart = User.dwLowDateTime;
+    UserTime.HighPart = User.dwHighDateTime;
+    return (KernelTime.QuadPart + UserTime.QuadPart) / 10; // 100ns units
+#else
+    struct rusage Usage;
+    if (getrusage(RUSAGE_SELF, &Usage) != 0) {
+        return 0;
+    }
+    return
+        S_TO_US((uint64_t)Usage.ru_utime.tv_sec + (uint64_t)Usage.ru_stime.tv_sec) +
+        (uint64_t)Usage.ru_utime.tv_usec + (uint64_t)Usage.ru_stime.tv_usec;
+#endif
+}
+#endif
+
 QUIC_STATUS
 PerfClient::Init(
     _In_ int argc,
@@ -148,7 +187,9 @@ PerfClient::Init(
     TryGetValue(argc, argv, "encrypt", &UseEncryption);
     TryGetValue(argc, argv, "pacing", &UsePacing);
     TryGetValue(argc, argv, "sendbuf", &UseSendBuffering);
+    TryGetValue(argc, argv, "batch", &UseSendBatch);
     TryGetValue(argc, argv, "ptput", &PrintThroughput);
+    TryGetValue(argc, argv, "pcycles", &PrintCycles);
     TryGetValue(argc, argv, "pctput", &PrintConnThroughput);
     TryGetValue(argc, argv, "prate", &PrintIoRate);
     TryGetValue(argc, argv, "pconnection", &PrintConnections);
@@ -203,6 +244,10 @@ PerfClient::Init(
             WriteOutput("TCP mode doesn't support CIBIR!\n");
             return QUIC_STATUS_INVALID_PARAMETER;
         }
+        if (UseSendBatch) {
+            WriteOutput("TCP mode doesn't support batched sends!\n");
+            return QUIC_STATUS_INVALID_PARAMETER;
+        }
     }
 
     if ((Upload || Download) && !StreamCount) {
@@ -294,6 +339,14 @@ PerfClient::Start(
     ) {
     CompletionEvent = StopEvent;
 
+#ifdef PERF_CYCLES_SUPPORTED
+    if (PrintCycles) {
+        CpuStartUs = GetProcessCpuTimeUs();
+        TscStart = __rdtsc();
+        WallStartUs = CxPlatTimeUs64();
+    }
+#endif
+
     //
     // Configure and start all the workers.
     //
@@ -390,6 +443,22 @@ PerfClient::Wait(
         if (UploadRate) {
             WriteOutput("Result: Upload %llu kbps.\n", UploadRate);
         }
+#ifdef PERF_CYCLES_SUPPORTED
+        //
+        // The process CPU time, converted to cycles at the (invariant) TSC
+        // rate measured over the run, spread over all the bytes uploaded.
+        //
+        const uint64_t BytesUploaded = GetBytesUploaded();
+        const uint64_t WallUs = CxPlatTimeDiff64(WallStartUs, CxPlatTimeUs64());
+        if (PrintCycles && BytesUploaded != 0 && WallUs != 0) {
+            const double TscPerUs = (double)(__rdtsc() - TscStart) / WallUs;
+            const double Cycles = (double)(GetProcessCpuTimeUs() - CpuStartUs) * TscPerUs;
+            WriteOutput(
+                "Result: Upload CPU %.2f cycles/byte (%.0f MHz).\n",
+                Cycles / BytesUploaded,
+                TscPerUs);
+        }
+#endif
         unsigned long long DownloadRate = GetDownloadRate();
         if (DownloadRate) {
             WriteOutput("Result: Download %llu kbps.\n", DownloadRate);
@@ -644,9 +713,7 @@ PerfClientConnection::OnHandshakeComplete() {
         Worker.OnConnectionComplete();
         Shutdown();
     } else {
-        for (uint32_t i = 0; i < Client.StreamCount; ++i) {
-            StartNewStream();
-        }
+        StartNewStreams(Client.StreamCount);
     }
 }
 
@@ -698,6 +765,61 @@ PerfClientConnection::StartNewStream() {
     Stream->Send();
 }
 
+void
+PerfClientConnection::StartNewStreams(_In_ uint64_t Count) {
+    //
+    // With batching enabled, the first sends on all the new streams are handed
+    // to MsQuic in as few StreamSendBatch calls as possible. Streams started
+    // from a callback while a batch is being collected just join that batch.
+    //
+    const bool StartBatch = Client.UseSendBatch && !Batching;
+    if (StartBatch) {
+        Batching = true;
+    }
+    for (uint64_t i = 0; i < Count; ++i) {
+        StartNewStream();
+    }
+    if (StartBatch) {
+        Batching = false;
+        FlushSendBatch();
+    }
+}
+
+void
+PerfClientConnection::QueueSend(
+    _In_ HQUIC Stream,
+    _In_ QUIC_BUFFER* Buffer,
+    _In_ QUIC_SEND_FLAGS Flags
+    ) {
+    if (SendBatchInUse) {
+        //
+        // Called back inline while the batch is being submitted.
+        //
+        MsQuic->StreamSend(Stream, Buffer, 1, Flags, Buffer);
+        return;
+    }
+    if (SendBatchCount == PERF_MAX_SEND_BATCH) {
+        FlushSendBatch();
+    }
+    auto& Entry = SendBatch[SendBatchCount++];
+    Entry.Stream = Stream;
+    Entry.Buffers = Buffer;
+    Entry.BufferCount = 1;
+    Entry.Flags = Flags;
+    Entry.ClientSendContext = Buffer;
+    Entry.Status = QUIC_STATUS_SUCCESS;
+}
+
+void
+PerfClientConnection::FlushSendBatch() {
+    if (SendBatchCount != 0) {
+        SendBatchInUse = true;
+        MsQuic->StreamSendBatch(Handle, SendBatch, SendBatchCount);
+        SendBatchInUse = false;
+        SendBatchCount = 0;
+    }
+}
+
 PerfClientStream::PerfClientStream(_In_ PerfClientConnection& Connection)
     : Connection{Connection} {
     if (Connection.Client.UseSendBuffering) {
@@ -718,8 +840,8 @@ PerfClientConnection::OnStreamShutdown() {
             Shutdown();
         }
     } else if (Client.RepeatStreams) {
-        while (StreamsActive < Client.StreamCount) {
-            StartNewStream();
+        if (StreamsActive < Client.StreamCount) {
+            StartNewStreams(Client.StreamCount - StreamsActive);
         }
     } else {
         if (!StreamsActive && StreamsCreated == Client.StreamCount) {
@@ -893,6 +1015,8 @@ PerfClientStream::Send() {
             SendData->Length = DataLength;
             SendData->Fin = (Flags & QUIC_SEND_FLAG_FIN) ? TRUE : FALSE;
             Connection.TcpConn->Send(SendData);
+        } else if (Connection.Batching) {
+            Connection.QueueSend(Handle, Buffer, Flags);
         } else {
             MsQuic->StreamSend(Handle, Buffer, 1, Flags, Buffer);
         }
@@ -994,6 +1118,9 @@ PerfClientStream::OnShutdown() {
             InterlockedExchangeAdd64(
                 (int64_t*)&Connection.Worker.UploadRate,
                 Rate);
+            InterlockedExchangeAdd64(
+                (int64_t*)&Connection.Worker.BytesUploaded,
+                (int64_t)TotalBytes);
         }
     }
 
@@ -25,10 +25,17 @@ struct PerfClientConnection {
     uint64_t StreamsCreated {0};
     uint64_t StreamsActive {0};
     bool WorkerConnComplete {false}; // Indicated completion to worker
+    bool Batching {false}; // Collect sends into SendBatch instead of sending
+    bool SendBatchInUse {false}; // SendBatch is being submitted to MsQuic
+    uint32_t SendBatchCount {0};
+    QUIC_STREAM_SEND_BATCH_ENTRY SendBatch[PERF_MAX_SEND_BATCH];
     PerfClientConnection(_In_ PerfClient& Client, _In_ PerfClientWorker& Worker) : Client(Client), Worker(Worker) { }
     ~PerfClientConnection();
     void Initialize();
     void StartNewStream();
+    void StartNewStreams(_In_ uint64_t Count);
+    void QueueSend(_In_ HQUIC Stream, _In_ QUIC_BUFFER* Buffer, _In_ QUIC_SEND_FLAGS Flags);
+    void FlushSendBatch();
     void OnHandshakeComplete();
     void OnShutdownComplete();
     void OnStreamShutdown();
@@ -97,6 +104,7 @@ struct QUIC_CACHEALIGN PerfClientWorker {
     uint64_t StreamsCompleted {0};
     uint64_t UploadRate {0};
     uint64_t DownloadRate {0};
+    uint64_t BytesUploaded {0};
     UniquePtr<char[]> Target;
     QuicAddr LocalAddr;
     QuicAddr RemoteAddr;
@@ -192,7 +200,9 @@ struct PerfClient {
     uint8_t UseEncryption {TRUE};
     uint8_t UsePacing {TRUE};
     uint8_t UseSendBuffering {FALSE};
+    uint8_t UseSendBatch {FALSE};
     uint8_t PrintThroughput {FALSE};
+    uint8_t PrintCycles {FALSE};
     uint8_t PrintConnThroughput {FALSE};
     uint8_t PrintIoRate {FALSE};
     uint8_t PrintConnections {FALSE};
@@ -209,6 +219,11 @@ struct PerfClient {
     uint8_t RepeatConnections {FALSE};
     uint8_t RepeatStreams {FALSE};
     uint64_t RunTime {0};
+    // Process CPU time, TSC and wall clock when the workers were started (for
+    // PrintCycles).
+    uint64_t CpuStartUs {0};
+    uint64_t TscStart {0};
+    uint64_t WallStartUs {0};
 
     struct PerfIoBuffer {
         QUIC_BUFFER* Buffer {nullptr};
@@ -267,6 +282,13 @@ struct PerfClient {
         }
         return UploadRate;
     }
+    uint64_t GetBytesUploaded() const {
+        uint64_t BytesUploaded = 0;
+        for (uint32_t i = 0; i < WorkerCount; ++i) {
+            BytesUploaded += Workers[i].BytesUploaded;
+        }
+        return BytesUploaded;
+    }
     uint64_t GetDownloadRate() const {
         uint64_t DownloadRate = 0;
         for (uint32_t i = 0; i < WorkerCount; ++i) {
@@ -40,6 +40,7 @@ Abstract:
 #define PERF_DEFAULT_IO_SIZE                0x10000
 
 #define PERF_MAX_THREAD_COUNT               128
+#define PERF_MAX_SEND_BATCH                 64 // Sends per StreamSendBatch call
 #define PERF_MAX_REQUESTS_PER_SECOND        2000000 // best guess - must increase if we can do better
 
 typedef enum TCP_EXECUTION_PROFILE {
@@ -105,6 +106,21 @@ TryGetTarget(
     return Target;
 }
 
+//
+// The memory datapath (-io:memory) only connects endpoints in the same
+// process, so the client runs the server alongside itself.
+//
+QUIC_INLINE
+bool
+IsMemoryIo(
+    _In_ int argc,
+    _In_reads_(argc) _Null_terminated_ char* argv[]
+    )
+{
+    const char* IoMode = nullptr;
+    return TryGetValue(argc, argv, "io", &IoMode) && IsValue(IoMode, "memory");
+}
+
 #ifdef _KERNEL_MODE
 extern volatile int BufferCurrent;
 constexpr int BufferLength = 40 * 1024 * 1024;
@@ -107,7 +107,9 @@ PrintHelp(
         "  -encrypt:<0/1>           Disables/enables encryption. (def:1)\n"
         "  -pacing:<0/1>            Disables/enables send pacing. (def:1)\n"
         "  -sendbuf:<0/1>           Disables/enables send buffering. (def:0)\n"
+        "  -batch:<0/1>             Disables/enables batching the first sends of new streams. (def:0)\n"
         "  -ptput:<0/1>             Print throughput information. (def:0)\n"
+        "  -pcycles:<0/1>           Print the process's CPU cycles per uploaded byte (x86/x64 user mode only). (def:0)\n"
         "  -pconn:<0/1>             Print connection statistics. (def:0)\n"
         "  -pstream:<0/1>           Print stream statistics. (def:0)\n"
         "  -platency<0/1>           Print latency statistics. (def:0)\n"
@@ -131,11 +133,12 @@ PrintHelp(
         "  -cc:<algo>               Congestion control algorithm to use.\n"
         "                            - {cubic, bbr}.\n"
         "  -pollidle:<time_us>      Amount of time to poll while idle before sleeping (default: 0).\n"
+        "  -busypoll:<0/1>          Spins worker threads on their event queues (for -pollidle time) instead of blocking. (def:0)\n"
         "  -ecn:<0/1>               Enables/disables sender-side ECN support. (def:0)\n"
         "  -qeo:<0/1>               Allows/disallowes QUIC encryption offload. (def:0)\n"
 #ifndef _KERNEL_MODE
         "  -io:<mode>               Configures a requested network IO model to be used.\n"
-        "                            - {iocp, xdp, qtip, epoll, iouring, kqueue}\n"
+        "                            - {iocp, xdp, qtip, epoll, iouring, kqueue, memory}\n"
 #else
         "  -io:<mode>               Configures a requested network IO model to be used.\n"
         "                            - {wsk}\n"
@@ -144,6 +147,25 @@ PrintHelp(
         "  -cipher:<value>          Decimal value of 1 or more QUIC_ALLOWED_CIPHER_SUITE_FLAGS.\n"
         "  -highpri:<0/1>           Configures MsQuic to run threads at high priority. (def:0)\n"
         "  -dscp:<0-63>             Specify DSCP value to mark sent packets with. (def:0)\n"
+        "  -zerocopy:<0/1>          Sends without copying payload into the kernel, if supported. (def:0)\n"
+        "  -cidsteer:<0/1>          Steers server packets to their connection's partition by CID, if supported. (def:0)\n"
+        "  -txtime:<0/1>            Paces sends with kernel departure times (SO_TXTIME), if supported. (def:0)\n"
+        "  -rxtstamp:<0/1>          Stamps received packets with the kernel receive time (SO_TIMESTAMPING), if supported. (def:0)\n"
+        "  -fusedenc:<0/1>          Encrypts stream data directly from the send buffers instead of copying it first. (def:1)\n"
+        "  -pardecrypt:<0/1>        Decrypts received packets on the receiving datapath thread instead of the connection's worker. (def:0)\n"
+        "\n"
+        "  Network emulation options (with -io:memory only):\n"
+        "  -emurtt:<time_us>        The round trip time added by the path. (def:0)\n"
+        "  -emujitter:<time_us>     The maximum random delay added in each direction, without reordering. (def:0)\n"
+        "  -emuloss:<ppm>           The random loss rate, in parts per million. (def:0)\n"
+        "  -emuburst:<ppm>          The rate loss bursts start at, in parts per million. (def:0)\n"
+        "  -emuburstlen:<####>      The number of datagrams dropped by each loss burst. (def:1)\n"
+        "  -emureorder:<ppm>        The rate datagrams are held back at, in parts per million. (def:0)\n"
+        "  -emureorderdelay:<time_us> How long held back datagrams are delayed. (def:0)\n"
+        "  -emurate:<kbps>          The bottleneck bandwidth. (def:0, unlimited)\n"
+        "  -emubucket:<bytes>       The token bucket size at the bottleneck. (def:0, one datagram)\n"
+        "  -emuqueue:<bytes>        The bottleneck queue depth, beyond which datagrams are dropped. (def:0, unlimited)\n"
+        "  -emuseed:<####>          Seeds the random impairments, for reproducible runs. (def:0)\n"
         "\n",
         PERF_DEFAULT_PORT,
         PERF_DEFAULT_PORT
@@ -196,6 +218,136 @@ QuicMainStart(
         Settings.SetGlobal();
     }
 
+    if (IsMemoryIo(argc, argv)) {
+        BOOLEAN Enabled = TRUE;
+        if (QUIC_FAILED(
+            Status =
+            MsQuic->SetParam(
+                nullptr,
+                QUIC_PARAM_GLOBAL_DATAPATH_MEMORY_ENABLED,
+                sizeof(Enabled),
+                &Enabled))) {
+            WriteOutput("Failed to set memory datapath %d\n", Status);
+            return Status;
+        }
+
+        QUIC_PRIVATE_DATAPATH_EMULATION Emulation = {0};
+        uint32_t RttUs = 0;
+        bool Emulate = TryGetValue(argc, argv, "emurtt", &RttUs);
+        Emulation.DelayUs = RttUs / 2;
+        Emulate |= TryGetValue(argc, argv, "emujitter", &Emulation.JitterUs);
+        Emulate |= TryGetValue(argc, argv, "emuloss", &Emulation.LossPpm);
+        Emulate |= TryGetValue(argc, argv, "emuburst", &Emulation.BurstLossPpm);
+        Emulate |= TryGetValue(argc, argv, "emuburstlen", &Emulation.BurstLossLength);
+        Emulate |= TryGetValue(argc, argv, "emureorder", &Emulation.ReorderPpm);
+        Emulate |= TryGetValue(argc, argv, "emureorderdelay", &Emulation.ReorderDelayUs);
+        Emulate |= TryGetValue(argc, argv, "emurate", &Emulation.BandwidthKbps);
+        Emulate |= TryGetValue(argc, argv, "emubucket", &Emulation.BucketBytes);
+        Emulate |= TryGetValue(argc, argv, "emuqueue", &Emulation.QueueBytes);
+        Emulate |= TryGetValue(argc, argv, "emuseed", &Emulation.Seed);
+        if (Emulate &&
+            QUIC_FAILED(
+            Status =
+            MsQuic->SetParam(
+                nullptr,
+                QUIC_PARAM_GLOBAL_DATAPATH_EMULATION,
+                sizeof(Emulation),
+                &Emulation))) {
+            WriteOutput("Failed to set datapath emulation %d\n", Status);
+            return Status;
+        }
+    }
+
+    uint8_t ZeroCopy = 0;
+    if (TryGetValue(argc, argv, "zerocopy", &ZeroCopy)) {
+        BOOLEAN Enabled = ZeroCopy != 0;
+        if (QUIC_FAILED(
+            Status =
+            MsQuic->SetParam(
+                nullptr,
+                QUIC_PARAM_GLOBAL_DATAPATH_SEND_ZEROCOPY_ENABLED,
+                sizeof(Enabled),
+                &Enabled))) {
+            WriteOutput("Failed to set zero-copy sends %d\n", Status);
+            return Status;
+        }
+    }
+
+    uint8_t CidSteering = 0;
+    if (TryGetValue(argc, argv, "cidsteer", &CidSteering)) {
+        BOOLEAN Enabled = CidSteering != 0;
+        if (QUIC_FAILED(
+            Status =
+            MsQuic->SetParam(
+                nullptr,
+                QUIC_PARAM_GLOBAL_DATAPATH_CID_STEERING_ENABLED,
+                sizeof(Enabled),
+                &Enabled))) {
+            WriteOutput("Failed to set CID steering %d\n", Status);
+            return Status;
+        }
+    }
+
+    uint8_t TxTime = 0;
+    if (TryGetValue(argc, argv, "txtime", &TxTime)) {
+        BOOLEAN Enabled = TxTime != 0;
+        if (QUIC_FAILED(
+            Status =
+            MsQuic->SetParam(
+                nullptr,
+                QUIC_PARAM_GLOBAL_DATAPATH_SEND_TXTIME_ENABLED,
+                sizeof(Enabled),
+                &Enabled))) {
+            WriteOutput("Failed to set departure time pacing %d\n", Status);
+            return Status;
+        }
+    }
+
+    uint8_t RxTimestamp = 0;
+    if (TryGetValue(argc, argv, "rxtstamp", &RxTimestamp)) {
+        BOOLEAN Enabled = RxTimestamp != 0;
+        if (QUIC_FAILED(
+            Status =
+            MsQuic->SetParam(
+                nullptr,
+                QUIC_PARAM_GLOBAL_DATAPATH_RECV_TIMESTAMP_ENABLED,
+                sizeof(Enabled),
+                &Enabled))) {
+            WriteOutput("Failed to set receive timestamps %d\n", Status);
+            return Status;
+        }
+    }
+
+    uint8_t FusedEncrypt = 1;
+    if (TryGetValue(argc, argv, "fusedenc", &FusedEncrypt)) {
+        BOOLEAN Enabled = FusedEncrypt != 0;
+        if (QUIC_FAILED(
+            Status =
+            MsQuic->SetParam(
+                nullptr,
+                QUIC_PARAM_GLOBAL_SEND_FUSED_ENCRYPT_ENABLED,
+                sizeof(Enabled),
+                &Enabled))) {
+            WriteOutput("Failed to set fused encryption %d\n", Status);
+            return Status;
+        }
+    }
+
+    uint8_t ParallelDecrypt = 0;
+    if (TryGetValue(argc, argv, "pardecrypt", &ParallelDecrypt)) {
+        BOOLEAN Enabled = ParallelDecrypt != 0;
+        if (QUIC_FAILED(
+            Status =
+            MsQuic->SetParam(
+                nullptr,
+                QUIC_PARAM_GLOBAL_RECV_PARALLEL_DECRYPT_ENABLED,
+                sizeof(Enabled),
+                &Enabled))) {
+            WriteOutput("Failed to set parallel decryption %d\n", Status);
+            return Status;
+        }
+    }
+
     const char* CpuStr;
     if ((CpuStr = GetValue(argc, argv, "cpu")) != nullptr) {
         SetConfig = true;
@@ -228,6 +380,12 @@ QuicMainStart(
         SetConfig = true;
     }
 
+    uint8_t BusyPoll = 0;
+    if (TryGetValue(argc, argv, "busypoll", &BusyPoll) && BusyPoll) {
+        Config->Flags |= QUIC_GLOBAL_EXECUTION_CONFIG_FLAG_BUSY_POLL;
+        SetConfig = true;
+    }
+
     if (SetConfig &&
         QUIC_FAILED(
         Status =
@@ -320,6 +478,15 @@ QuicMainStart(
     }
 
     if (Target) {
+        if (IsMemoryIo(argc, argv)) {
+            CXPLAT_FRE_ASSERT(SelfSignedCredConfig);
+            Server = new(std::nothrow) PerfServer(SelfSignedCredConfig);
+            if (QUIC_FAILED(Status = Server->Init(argc, argv)) ||
+                QUIC_FAILED(Status = Server->Start(StopEvent))) {
+                WriteOutput("In-process server failed to start: %d\n", Status);
+                return Status; // QuicMainFree is called on failure
+            }
+        }
         Client = new(std::nothrow) PerfClient;
         if ((QUIC_SUCCEEDED(Status = Client->Init(argc, argv, Target)) &&
              QUIC_SUCCEEDED(Status = Client->Start(StopEvent)))) {
@@ -515,6 +515,78 @@ CxPlatDecrypt(
     return NtStatusToQuicStatus(Status);
 }
 
+_IRQL_requires_max_(DISPATCH_LEVEL)
+QUIC_STATUS
+CxPlatEncryptBatch(
+    _In_ CXPLAT_KEY* Key,
+    _In_ uint8_t BatchSize,
+    _Inout_updates_(BatchSize) CXPLAT_CRYPT_BATCH_ENTRY* Batch
+    )
+{
+    //
+    // BCrypt has no multi-buffer AEAD interface, so just process the packets
+    // back to back. It also can't read the plain text from more than one
+    // place, so any sources are copied in first.
+    //
+    for (uint8_t i = 0; i < BatchSize; ++i) {
+        CXPLAT_CRYPT_BATCH_ENTRY* Entry = &Batch[i];
+        for (uint8_t j = 0; j < Entry->SourceCount; ++j) {
+            CxPlatCopyMemory(
+                Entry->Buffer + Entry->Sources[j].Offset,
+                Entry->Sources[j].Buffer,
+                Entry->Sources[j].Length);
+        }
+        Entry->Status =
+            CxPlatEncrypt(
+                Key,
+                Entry->Iv,
+                Entry->AuthDataLength,
+                Entry->AuthData,
+                Entry->BufferLength,
+                Entry->Buffer);
+        if (QUIC_FAILED(Entry->Status)) {
+            return Entry->Status;
+        }
+    }
+    return QUIC_STATUS_SUCCESS;
+}
+
+_IRQL_requires_max_(DISPATCH_LEVEL)
+BOOLEAN
+CxPlatKeyPrefersSources(
+    _In_ const CXPLAT_KEY* Key
+    )
+{
+    UNREFERENCED_PARAMETER(Key);
+    return FALSE;
+}
+
+_IRQL_requires_max_(DISPATCH_LEVEL)
+QUIC_STATUS
+CxPlatDecryptBatch(
+    _In_ CXPLAT_KEY* Key,
+    _In_ uint8_t BatchSize,
+    _Inout_updates_(BatchSize) CXPLAT_CRYPT_BATCH_ENTRY* Batch
+    )
+{
+    QUIC_STATUS Status = QUIC_STATUS_SUCCESS;
+    for (uint8_t i = 0; i < BatchSize; ++i) {
+        CXPLAT_CRYPT_BATCH_ENTRY* Entry = &Batch[i];
+        Entry->Status =
+            CxPlatDecrypt(
+                Key,
+                Entry->Iv,
+                Entry->AuthDataLength,
+                Entry->AuthData,
+                Entry->BufferLength,
+                Entry->Buffer);
+        if (QUIC_FAILED(Entry->Status)) {
+            Status = Entry->Status;
+        }
+    }
+    return Status;
+}
+
 _IRQL_requires_max_(DISPATCH_LEVEL)
 QUIC_STATUS
 CxPlatHpKeyCreate(
@@ -121,9 +121,18 @@ CxPlatLoadHMACCTX(
     return 1;
 }
 
+//
+// The number of bytes of plain text gathered from the sources and encrypted at
+// a time. A multiple of both the AES and ChaCha20 block sizes.
+//
+#define CXPLAT_OPENSSL_GATHER_CHUNK 512
+
 typedef struct CXPLAT_HP_KEY {
     EVP_CIPHER_CTX* CipherCtx;
     CXPLAT_AEAD_TYPE Aead;
+#ifdef CXPLAT_NATIVE_CRYPTO
+    CXPLAT_NATIVE_HP_KEY* Native;
+#endif
 } CXPLAT_HP_KEY;
 
 QUIC_STATUS
@@ -175,6 +184,10 @@ CxPlatCryptInitialize(
     }
     EVP_MAC_free(mac);
 
+#ifdef CXPLAT_NATIVE_CRYPTO
+    CxPlatNativeCryptInitialize();
+#endif
+
     return QUIC_STATUS_SUCCESS;
 
 Error:
@@ -233,14 +246,15 @@ CxPlatCryptUninitialize(
 }
 
 _IRQL_requires_max_(DISPATCH_LEVEL)
+static
 QUIC_STATUS
-CxPlatKeyCreate(
+CxPlatEvpKeyCreate(
     _In_ CXPLAT_AEAD_TYPE AeadType,
     _When_(AeadType == CXPLAT_AEAD_AES_128_GCM, _In_reads_(16))
     _When_(AeadType == CXPLAT_AEAD_AES_256_GCM, _In_reads_(32))
     _When_(AeadType == CXPLAT_AEAD_CHACHA20_POLY1305, _In_reads_(32))
         const uint8_t* const RawKey,
-    _Out_ CXPLAT_KEY** NewKey
+    _Out_ EVP_CIPHER_CTX** NewCipherCtx
     )
 {
     QUIC_STATUS Status = QUIC_STATUS_SUCCESS;
@@ -291,16 +305,30 @@ CxPlatKeyCreate(
         goto Exit;
     }
 
-    *NewKey = (CXPLAT_KEY*)CipherCtx;
+    *NewCipherCtx = CipherCtx;
     CipherCtx = NULL;
 
 Exit:
 
-    CxPlatKeyFree((CXPLAT_KEY*)CipherCtx);
+    EVP_CIPHER_CTX_free(CipherCtx);
 
     return Status;
 }
 
+_IRQL_requires_max_(DISPATCH_LEVEL)
+QUIC_STATUS
+CxPlatKeyCreate(
+    _In_ CXPLAT_AEAD_TYPE AeadType,
+    _When_(AeadType == CXPLAT_AEAD_AES_128_GCM, _In_reads_(16))
+    _When_(AeadType == CXPLAT_AEAD_AES_256_GCM, _In_reads_(32))
+    _When_(AeadType == CXPLAT_AEAD_CHACHA20_POLY1305, _In_reads_(32))
+        const uint8_t* const RawKey,
+    _Out_ CXPLAT_KEY** NewKey
+    )
+{
+    return CxPlatEvpKeyCreate(AeadType, RawKey, (EVP_CIPHER_CTX**)NewKey);
+}
+
 _IRQL_requires_max_(DISPATCH_LEVEL)
 void
 CxPlatKeyFree(
@@ -310,19 +338,28 @@ CxPlatKeyFree(
     EVP_CIPHER_CTX_free((EVP_CIPHER_CTX*)Key);
 }
 
+//
+// Encrypts a single packet with an EVP cipher context. Any Sources are
+// gathered into Buffer a chunk at a time, right before each chunk is encrypted
+// in place; encrypting out of place straight from the sources is slower with
+// EVP.
+//
 _IRQL_requires_max_(DISPATCH_LEVEL)
+static
 QUIC_STATUS
-CxPlatEncrypt(
-    _In_ CXPLAT_KEY* Key,
+CxPlatEvpEncrypt(
+    _In_ EVP_CIPHER_CTX* CipherCtx,
     _In_reads_bytes_(CXPLAT_IV_LENGTH)
         const uint8_t* const Iv,
     _In_ uint16_t AuthDataLength,
     _In_reads_bytes_opt_(AuthDataLength)
         const uint8_t* const AuthData,
     _In_ uint16_t BufferLength,
-    _When_(BufferLength > CXPLAT_ENCRYPTION_OVERHEAD, _Inout_updates_bytes_(BufferLength))
-    _When_(BufferLength <= CXPLAT_ENCRYPTION_OVERHEAD, _Out_writes_bytes_(BufferLength))
-        uint8_t* Buffer
+    _Inout_updates_bytes_(BufferLength)
+        uint8_t* Buffer,
+    _In_ uint8_t SourceCount,
+    _In_reads_opt_(SourceCount)
+        const CXPLAT_CRYPT_SOURCE* Sources
     )
 {
     CXPLAT_DBG_ASSERT(CXPLAT_ENCRYPTION_OVERHEAD <= BufferLength);
@@ -331,7 +368,6 @@ CxPlatEncrypt(
     uint8_t *Tag = Buffer + PlainTextLength;
     int OutLen;
 
-    EVP_CIPHER_CTX* CipherCtx = (EVP_CIPHER_CTX*)Key;
     OSSL_PARAM AlgParam[2];
 
     if (EVP_EncryptInit_ex(CipherCtx, NULL, NULL, NULL, Iv) != 1) {
@@ -351,12 +387,21 @@ CxPlatEncrypt(
         return QUIC_STATUS_TLS_ERROR;
     }
 
-    if (EVP_EncryptUpdate(CipherCtx, Buffer, &OutLen, Buffer, (int)PlainTextLength) != 1) {
-        QuicTraceEvent(
-            LibraryError,
-            "[ lib] ERROR, %s.",
-            "EVP_EncryptUpdate (Cipher) failed");
-        return QUIC_STATUS_TLS_ERROR;
+    CXPLAT_CRYPT_GATHER Gather;
+    CxPlatCryptGatherInit(&Gather, SourceCount, Sources);
+    const uint16_t ChunkLength =
+        SourceCount != 0 ? CXPLAT_OPENSSL_GATHER_CHUNK : PlainTextLength;
+    for (uint16_t Offset = 0; Offset < PlainTextLength; Offset += ChunkLength) {
+        const uint16_t Length = CXPLAT_MIN(PlainTextLength - Offset, ChunkLength);
+        CxPlatCryptGather(&Gather, Buffer, Offset + Length);
+        if (EVP_EncryptUpdate(
+                CipherCtx, Buffer + Offset, &OutLen, Buffer + Offset, (int)Length) != 1) {
+            QuicTraceEvent(
+                LibraryError,
+                "[ lib] ERROR, %s.",
+                "EVP_EncryptUpdate (Cipher) failed");
+            return QUIC_STATUS_TLS_ERROR;
+        }
     }
 
     if (EVP_EncryptFinal_ex(CipherCtx, Tag, &OutLen) != 1) {
@@ -382,9 +427,10 @@ CxPlatEncrypt(
 }
 
 _IRQL_requires_max_(DISPATCH_LEVEL)
+static
 QUIC_STATUS
-CxPlatDecrypt(
-    _In_ CXPLAT_KEY* Key,
+CxPlatEvpDecrypt(
+    _In_ EVP_CIPHER_CTX* CipherCtx,
     _In_reads_bytes_(CXPLAT_IV_LENGTH)
         const uint8_t* const Iv,
     _In_ uint16_t AuthDataLength,
@@ -401,7 +447,6 @@ CxPlatDecrypt(
     uint8_t *Tag = Buffer + CipherTextLength;
     int OutLen;
 
-    EVP_CIPHER_CTX* CipherCtx = (EVP_CIPHER_CTX*)Key;
     OSSL_PARAM AlgParam[2];
 
     if (EVP_DecryptInit_ex(CipherCtx, NULL, NULL, NULL, Iv) != 1) {
@@ -455,6 +500,115 @@ CxPlatDecrypt(
     return QUIC_STATUS_SUCCESS;
 }
 
+_IRQL_requires_max_(DISPATCH_LEVEL)
+QUIC_STATUS
+CxPlatEncrypt(
+    _In_ CXPLAT_KEY* Key,
+    _In_reads_bytes_(CXPLAT_IV_LENGTH)
+        const uint8_t* const Iv,
+    _In_ uint16_t AuthDataLength,
+    _In_reads_bytes_opt_(AuthDataLength)
+        const uint8_t* const AuthData,
+    _In_ uint16_t BufferLength,
+    _When_(BufferLength > CXPLAT_ENCRYPTION_OVERHEAD, _Inout_updates_bytes_(BufferLength))
+    _When_(BufferLength <= CXPLAT_ENCRYPTION_OVERHEAD, _Out_writes_bytes_(BufferLength))
+        uint8_t* Buffer
+    )
+{
+    return
+        CxPlatEvpEncrypt(
+            (EVP_CIPHER_CTX*)Key, Iv, AuthDataLength, AuthData, BufferLength, Buffer, 0, NULL);
+}
+
+_IRQL_requires_max_(DISPATCH_LEVEL)
+QUIC_STATUS
+CxPlatDecrypt(
+    _In_ CXPLAT_KEY* Key,
+    _In_reads_bytes_(CXPLAT_IV_LENGTH)
+        const uint8_t* const Iv,
+    _In_ uint16_t AuthDataLength,
+    _In_reads_bytes_opt_(AuthDataLength)
+        const uint8_t* const AuthData,
+    _In_ uint16_t BufferLength,
+    _Inout_updates_bytes_(BufferLength)
+        uint8_t* Buffer
+    )
+{
+    return CxPlatEvpDecrypt((EVP_CIPHER_CTX*)Key, Iv, AuthDataLength, AuthData, BufferLength, Buffer);
+}
+
+_IRQL_requires_max_(DISPATCH_LEVEL)
+QUIC_STATUS
+CxPlatEncryptBatch(
+    _In_ CXPLAT_KEY* Key,
+    _In_ uint8_t BatchSize,
+    _Inout_updates_(BatchSize) CXPLAT_CRYPT_BATCH_ENTRY* Batch
+    )
+{
+    for (uint8_t i = 0; i < BatchSize; ++i) {
+        CXPLAT_CRYPT_BATCH_ENTRY* Entry = &Batch[i];
+        Entry->Status =
+            CxPlatEvpEncrypt(
+                (EVP_CIPHER_CTX*)Key,
+                Entry->Iv,
+                Entry->AuthDataLength,
+                Entry->AuthData,
+                Entry->BufferLength,
+                Entry->Buffer,
+                Entry->SourceCount,
+                Entry->Sources);
+        if (QUIC_FAILED(Entry->Status)) {
+            return Entry->Status;
+        }
+    }
+
+    return QUIC_STATUS_SUCCESS;
+}
+
+//
+// EVP gathers the sources in a chunk at a time, which measured no faster than
+// copying the plain text in first for AES-GCM and about 30% slower for
+// ChaCha20-Poly1305.
+//
+_IRQL_requires_max_(DISPATCH_LEVEL)
+BOOLEAN
+CxPlatKeyPrefersSources(
+    _In_ const CXPLAT_KEY* Key
+    )
+{
+    UNREFERENCED_PARAMETER(Key);
+    return FALSE;
+}
+
+_IRQL_requires_max_(DISPATCH_LEVEL)
+QUIC_STATUS
+CxPlatDecryptBatch(
+    _In_ CXPLAT_KEY* Key,
+    _In_ uint8_t BatchSize,
+    _Inout_updates_(BatchSize) CXPLAT_CRYPT_BATCH_ENTRY* Batch
+    )
+{
+    QUIC_STATUS Status = QUIC_STATUS_SUCCESS;
+
+    for (uint8_t i = 0; i < BatchSize; ++i) {
+        CXPLAT_CRYPT_BATCH_ENTRY* Entry = &Batch[i];
+        CXPLAT_DBG_ASSERT(Entry->SourceCount == 0);
+        Entry->Status =
+            CxPlatEvpDecrypt(
+                (EVP_CIPHER_CTX*)Key,
+                Entry->Iv,
+                Entry->AuthDataLength,
+                Entry->AuthData,
+                Entry->BufferLength,
+                Entry->Buffer);
+        if (QUIC_FAILED(Entry->Status)) {
+            Status = Entry->Status;
+        }
+    }
+
+    return Status;
+}
+
 _IRQL_requires_max_(DISPATCH_LEVEL)
 QUIC_STATUS
 CxPlatHpKeyCreate(
@@ -480,6 +634,15 @@ CxPlatHpKeyCreate(
 
     Key->Aead = AeadType;
 
+#ifdef CXPLAT_NATIVE_CRYPTO
+    Key->CipherCtx = NULL;
+    Key->Native = NULL;
+    if (QUIC_SUCCEEDED(CxPlatNativeHpKeyCreate(AeadType, RawKey, &Key->Native))) {
+        *NewKey = Key;
+        return QUIC_STATUS_SUCCESS;
+    }
+#endif
+
     Key->CipherCtx = EVP_CIPHER_CTX_new();
     if (Key->CipherCtx == NULL) {
         QuicTraceEvent(
@@ -536,6 +699,9 @@ CxPlatHpKeyFree(
     )
 {
     if (Key != NULL) {
+#ifdef CXPLAT_NATIVE_CRYPTO
+        CxPlatNativeHpKeyFree(Key->Native);
+#endif
         EVP_CIPHER_CTX_free(Key->CipherCtx);
         CXPLAT_FREE(Key, QUIC_POOL_TLS_HP_KEY);
     }
@@ -552,6 +718,13 @@ CxPlatHpComputeMask(
         uint8_t* Mask
     )
 {
+#ifdef CXPLAT_NATIVE_CRYPTO
+    if (Key->Native != NULL) {
+        CxPlatNativeHpComputeMask(Key->Native, BatchSize, Cipher, Mask);
+        return QUIC_STATUS_SUCCESS;
+    }
+#endif
+
     int OutLen = 0;
     if (Key->Aead == CXPLAT_AEAD_CHACHA20_POLY1305) {
         static const uint8_t Zero[] = { 0, 0, 0, 0, 0 };
@@ -80,6 +80,17 @@ typedef struct CXPLAT_SEND_DATA {
     //
     CXPLAT_LIST_ENTRY TxEntry;
 
+    //
+    // Entry in the socket's zero-copy queue, while the kernel may still
+    // reference the buffer.
+    //
+    CXPLAT_LIST_ENTRY ZeroCopyEntry;
+
+    //
+    // The kernel's completion notification ID for a zero-copy send.
+    //
+    uint32_t ZeroCopyId;
+
     //
     // The local address to bind to.
     //
@@ -95,6 +106,12 @@ typedef struct CXPLAT_SEND_DATA {
     //
     QUIC_BUFFER ClientBuffer;
 
+    //
+    // The earliest time, in microseconds (see CxPlatTimeUs64), the kernel
+    // should transmit the send at. Zero transmits immediately.
+    //
+    uint64_t DepartureTimeUs;
+
     //
     // Total number of packet buffers allocated (and iovecs used if !GSO).
     //
@@ -127,6 +144,11 @@ typedef struct CXPLAT_SEND_DATA {
     //
     uint8_t SegmentationSupported : 1;
 
+    //
+    // Indicates the send should go out with MSG_ZEROCOPY.
+    //
+    uint8_t ZeroCopy : 1;
+
     //
     // Space for ancillary control data.
     //
@@ -136,6 +158,9 @@ typedef struct CXPLAT_SEND_DATA {
         CMSG_SPACE(sizeof(struct in6_pktinfo))  // IP_PKTINFO || IPV6_PKTINFO
     #ifdef UDP_SEGMENT
         + CMSG_SPACE(sizeof(uint16_t))          // UDP_SEGMENT
+    #endif
+    #ifdef SCM_TXTIME
+        + CMSG_SPACE(sizeof(uint64_t))          // SCM_TXTIME
     #endif
         ];
     CXPLAT_STATIC_ASSERT(
@@ -163,7 +188,11 @@ typedef struct CXPLAT_SEND_DATA {
 
 typedef struct CXPLAT_RECV_MSG_CONTROL_BUFFER {
     char Data[CMSG_SPACE(sizeof(struct in6_pktinfo)) + // IP_PKTINFO
-              3 * CMSG_SPACE(sizeof(int))]; // TOS + IP_TTL
+              3 * CMSG_SPACE(sizeof(int)) // TOS + IP_TTL
+    #ifdef SO_TIMESTAMPING
+              + CMSG_SPACE(sizeof(struct scm_timestamping)) // SCM_TIMESTAMPING
+    #endif
+              ];
 
 } CXPLAT_RECV_MSG_CONTROL_BUFFER;
 
@@ -198,7 +227,6 @@ DataPathInitialize(
     )
 {
     UNREFERENCED_PARAMETER(TcpCallbacks);
-    UNREFERENCED_PARAMETER(InitConfig);
 
     if (NewDatapath == NULL) {
         return QUIC_STATUS_INVALID_PARAMETER;
@@ -249,6 +277,39 @@ DataPathInitialize(
     CxPlatRefInitializeEx(&Datapath->RefCount, Datapath->PartitionCount);
     CxPlatDataPathCalculateFeatureSupport(Datapath);
 
+#ifdef MSG_ZEROCOPY
+    //
+    // Only segmented (GSO) sends get large enough for zero-copy to beat the
+    // cost of pinning the pages and processing the completions.
+    //
+    if (InitConfig->EnableSendZeroCopy &&
+        Datapath->Features & CXPLAT_DATAPATH_FEATURE_SEND_SEGMENTATION) {
+        Datapath->Features |= CXPLAT_DATAPATH_FEATURE_SEND_ZEROCOPY;
+        Datapath->SendZeroCopyThreshold =
+            InitConfig->SendZeroCopyThreshold != 0 ?
+                InitConfig->SendZeroCopyThreshold :
+                CXPLAT_DEFAULT_SEND_ZEROCOPY_THRESHOLD;
+    }
+#endif
+
+    if (InitConfig->EnableCidSteering && CxPlatDataPathIsCidSteeringSupported()) {
+        Datapath->Features |= CXPLAT_DATAPATH_FEATURE_CID_STEERING;
+    }
+
+#ifdef SO_TXTIME
+    if (InitConfig->EnableSendTxTime) {
+        Datapath->Features |= CXPLAT_DATAPATH_FEATURE_SEND_TXTIME;
+    }
+#endif
+
+#ifdef SO_TIMESTAMPING
+    if (InitConfig->EnableRecvTimestamp) {
+        Datapath->Features |= CXPLAT_DATAPATH_FEATURE_RECV_TIMESTAMP;
+    }
+#endif
+
+    Datapath->BusyPollUs = InitConfig->BusyPollUs;
+
     if (Datapath->Features & CXPLAT_DATAPATH_FEATURE_SEND_SEGMENTATION) {
         Datapath->SendDataSize = sizeof(CXPLAT_SEND_DATA);
         Datapath->SendIoVecCount = 1;
@@ -686,6 +747,37 @@ CxPlatSocketContextInitialize(
         }
     #endif
 
+    #ifdef MSG_ZEROCOPY
+        if (Datapath->Features & CXPLAT_DATAPATH_FEATURE_SEND_ZEROCOPY) {
+            //
+            // Best effort. Kernels without UDP zero-copy support reject the
+            // option, in which case sends are copied as usual.
+            //
+            Option = TRUE;
+            Result =
+                setsockopt(
+                    SocketContext->SocketFd,
+                    SOL_SOCKET,
+                    SO_ZEROCOPY,
+                    (const void*)&Option,
+                    sizeof(Option));
+            if (Result == SOCKET_ERROR) {
+                QuicTraceEvent(
+                    DatapathErrorStatus,
+                    "[data][%p] ERROR, %u, %s.",
+                    Binding,
+                    errno,
+                    "setsockopt(SO_ZEROCOPY) failed");
+            } else {
+                SocketContext->ZeroCopyEnabled = TRUE;
+            }
+        }
+    #endif
+
+        CxPlatSocketConfigureBusyPoll(SocketContext);
+        CxPlatSocketConfigureTxTime(SocketContext);
+        CxPlatSocketConfigureRecvTimestamp(SocketContext);
+
         //
         // The socket is shared by multiple QUIC endpoints, so increase the receive
         // buffer size.
@@ -932,6 +1024,13 @@ CxPlatSocketRelease(
     }
 }
 
+#ifdef MSG_ZEROCOPY
+void
+CxPlatSocketContextDrainZeroCopySends(
+    _In_ CXPLAT_SOCKET_CONTEXT* SocketContext
+    );
+#endif
+
 void
 CxPlatSocketContextUninitializeComplete(
     _In_ CXPLAT_SOCKET_CONTEXT* SocketContext
@@ -953,10 +1052,34 @@ CxPlatSocketContextUninitializeComplete(
     CXPLAT_DBG_ASSERT(SocketContext->AcceptSocket == NULL);
 
     if (SocketContext->SocketFd != INVALID_SOCKET) {
+#ifdef MSG_ZEROCOPY
+        //
+        // No more zero-copy completions are delivered once the socket is
+        // closed, so collect them while it's still open.
+        //
+        if (SocketContext->ZeroCopyEnabled) {
+            CxPlatSocketContextDrainZeroCopySends(SocketContext);
+        }
+#endif
         epoll_ctl(*SocketContext->DatapathPartition->EventQ, EPOLL_CTL_DEL, SocketContext->SocketFd, NULL);
         close(SocketContext->SocketFd);
     }
 
+    //
+    // The kernel may still be transmitting from any sends it didn't release in
+    // time. Their buffers go straight back to the heap instead of the pool,
+    // which would hand them to the very next send.
+    //
+    while (!CxPlatListIsEmpty(&SocketContext->ZeroCopyQueue)) {
+        CXPLAT_SEND_DATA* SendData =
+            CXPLAT_CONTAINING_RECORD(
+                CxPlatListRemoveHead(&SocketContext->ZeroCopyQueue),
+                CXPLAT_SEND_DATA,
+                ZeroCopyEntry);
+        CXPLAT_POOL_HEADER* Header = (CXPLAT_POOL_HEADER*)SendData - 1;
+        CxPlatFree(Header, Header->Owner->Tag);
+    }
+
     if (SocketContext->SqeInitialized) {
         CxPlatSqeCleanup(SocketContext->DatapathPartition->EventQ, &SocketContext->ShutdownSqe);
         CxPlatSqeCleanup(SocketContext->DatapathPartition->EventQ, &SocketContext->IoSqe.Sqe);
@@ -1069,7 +1192,19 @@ SocketCreateUdp(
     const BOOLEAN IsPartitioned =
         Config->Flags & CXPLAT_SOCKET_FLAG_PARTITIONED || Config->RemoteAddress != NULL;
     const BOOLEAN NumPerProcessorSockets = !IsPartitioned && Datapath->PartitionCount > 1;
-    const uint16_t SocketCount = NumPerProcessorSockets ? (uint16_t)CxPlatProcCount() : 1;
+    const BOOLEAN CidSteering =
+        NumPerProcessorSockets &&
+        (Datapath->Features & CXPLAT_DATAPATH_FEATURE_CID_STEERING) &&
+        Config->PartitionCount == Datapath->PartitionCount;
+    //
+    // With CID steering, there is exactly one socket per partition so that a
+    // socket's index is also its partition index. That only holds if the
+    // caller partitions its CIDs the same way the datapath partitions its
+    // sockets.
+    //
+    const uint16_t SocketCount =
+        NumPerProcessorSockets ?
+            (CidSteering ? (uint16_t)Datapath->PartitionCount : (uint16_t)CxPlatProcCount()) : 1;
 
     CXPLAT_DBG_ASSERT(Datapath->UdpHandlers.Receive != NULL || Config->Flags & CXPLAT_SOCKET_FLAG_PCP);
 
@@ -1102,6 +1237,7 @@ SocketCreateUdp(
     Binding->HasFixedRemoteAddress = (Config->RemoteAddress != NULL);
     Binding->Mtu = CXPLAT_MAX_MTU;
     Binding->Type = CXPLAT_SOCKET_UDP;
+    Binding->SocketCount = SocketCount;
     CxPlatRefInitializeEx(&Binding->RefCount, SocketCount);
     if (Config->LocalAddress) {
         CxPlatConvertToMappedV6(Config->LocalAddress, &Binding->LocalAddress);
@@ -1116,6 +1252,7 @@ SocketCreateUdp(
         Binding->SocketContexts[i].Binding = Binding;
         Binding->SocketContexts[i].SocketFd = INVALID_SOCKET;
         CxPlatListInitializeHead(&Binding->SocketContexts[i].TxQueue);
+        CxPlatListInitializeHead(&Binding->SocketContexts[i].ZeroCopyQueue);
         CxPlatLockInitialize(&Binding->SocketContexts[i].TxQueueLock);
         CxPlatRundownInitialize(&Binding->SocketContexts[i].UpcallRundown);
     }
@@ -1139,7 +1276,10 @@ SocketCreateUdp(
         // round robin, but each flow will be sent to the same socket, just not
         // based on RSS.
         //
-        (void)CxPlatSocketConfigureRss(&Binding->SocketContexts[0], SocketCount);
+        if (!CidSteering ||
+            QUIC_FAILED(CxPlatSocketConfigureCidSteering(&Binding->SocketContexts[0], Config, SocketCount))) {
+            (void)CxPlatSocketConfigureRss(&Binding->SocketContexts[0], SocketCount);
+        }
     }
 
     CxPlatConvertFromMappedV6(&Binding->LocalAddress, &Binding->LocalAddress);
@@ -1240,12 +1380,14 @@ CxPlatSocketCreateTcpInternal(
                 ((uint16_t)(CxPlatProcCurrentNumber() % Datapath->PartitionCount)) : 0;
     }
 
+    Binding->SocketCount = 1;
     CxPlatRefInitializeEx(&Binding->RefCount, 1);
 
     SocketContext = &Binding->SocketContexts[0];
     SocketContext->Binding = Binding;
     SocketContext->SocketFd = INVALID_SOCKET;
     CxPlatListInitializeHead(&SocketContext->TxQueue);
+    CxPlatListInitializeHead(&SocketContext->ZeroCopyQueue);
     CxPlatLockInitialize(&SocketContext->TxQueueLock);
     CxPlatRundownInitialize(&SocketContext->UpcallRundown);
 
@@ -1401,6 +1543,7 @@ SocketCreateTcpListener(
     } else {
         Binding->LocalAddress.Ip.sa_family = QUIC_ADDRESS_FAMILY_INET6;
     }
+    Binding->SocketCount = SocketCount;
     CxPlatRefInitializeEx(&Binding->RefCount, SocketCount);
 
     CXPLAT_UDP_CONFIG Config = {
@@ -1412,6 +1555,7 @@ SocketCreateTcpListener(
         Binding->SocketContexts[i].Binding = Binding;
         Binding->SocketContexts[i].SocketFd = INVALID_SOCKET;
         CxPlatListInitializeHead(&Binding->SocketContexts[i].TxQueue);
+        CxPlatListInitializeHead(&Binding->SocketContexts[i].ZeroCopyQueue);
         CxPlatLockInitialize(&Binding->SocketContexts[i].TxQueueLock);
         CxPlatRundownInitialize(&Binding->SocketContexts[i].UpcallRundown);
     }
@@ -1529,10 +1673,7 @@ SocketDelete(
     Socket->Uninitialized = TRUE;
 #endif
 
-    const uint16_t SocketCount =
-        Socket->NumPerProcessorSockets ? (uint16_t)CxPlatProcCount() : 1;
-
-    for (uint32_t i = 0; i < SocketCount; ++i) {
+    for (uint32_t i = 0; i < Socket->SocketCount; ++i) {
         CxPlatSocketContextUninitialize(&Socket->SocketContexts[i]);
     }
 }
@@ -1580,6 +1721,7 @@ CxPlatSocketContextRecvComplete(
     uint32_t BytesTransferred = 0;
     CXPLAT_RECV_DATA* DatagramHead = NULL;
     CXPLAT_RECV_DATA** DatagramTail = &DatagramHead;
+    CXPLAT_RECV_TIMESTAMP_CLOCK RecvClock = {0};
     for (int CurrentMessage = 0; CurrentMessage < MessagesReceived; CurrentMessage++) {
         DATAPATH_RX_IO_BLOCK* IoBlock = IoBlocks[CurrentMessage];
         IoBlocks[CurrentMessage] = NULL;
@@ -1588,6 +1730,7 @@ CxPlatSocketContextRecvComplete(
         uint8_t TOS = 0;
         int HopLimitTTL = 0;
         uint16_t SegmentLength = 0;
+        uint64_t ReceiveTimeUs = 0;
         BOOLEAN FoundLocalAddr = FALSE, FoundTOS = FALSE, FoundTTL = FALSE;
         QUIC_ADDR* LocalAddr = &IoBlock->Route.LocalAddress;
         QUIC_ADDR* RemoteAddr = &IoBlock->Route.RemoteAddress;
@@ -1596,7 +1739,8 @@ CxPlatSocketContextRecvComplete(
 
         //
         // Process the ancillary control messages to get the local address,
-        // type of service and possibly the GRO segmentation length.
+        // type of service, possibly the GRO segmentation length and the receive
+        // timestamp.
         //
         struct msghdr* Msg = &RecvMsgHdr[CurrentMessage].msg_hdr;
         for (struct cmsghdr *CMsg = CMSG_FIRSTHDR(Msg); CMsg != NULL; CMsg = CMSG_NXTHDR(Msg, CMsg)) {
@@ -1640,6 +1784,12 @@ CxPlatSocketContextRecvComplete(
                     CXPLAT_DBG_ASSERT_CMSG(CMsg, uint16_t);
                     SegmentLength = *(uint16_t*)CMSG_DATA(CMsg);
                 }
+#endif
+            } else if (CMsg->cmsg_level == SOL_SOCKET) {
+#ifdef SO_TIMESTAMPING
+                if (CMsg->cmsg_type == SCM_TIMESTAMPING) {
+                    ReceiveTimeUs = CxPlatSocketGetRecvTimestamp(CMsg, &RecvClock);
+                }
 #endif
             } else {
                 CXPLAT_DBG_ASSERT(FALSE);
@@ -1663,6 +1813,14 @@ CxPlatSocketContextRecvComplete(
             SegmentLength = RecvMsgHdr[CurrentMessage].msg_len;
         }
 
+        uint32_t SegmentCount = 0;
+        if (SegmentLength != 0) {
+            SegmentCount =
+                CXPLAT_MIN(
+                    (RecvMsgHdr[CurrentMessage].msg_len + SegmentLength - 1) / SegmentLength,
+                    CXPLAT_MAX_IO_BATCH_SIZE);
+        }
+
         DATAPATH_RX_PACKET* Datagram = (DATAPATH_RX_PACKET*)(IoBlock + 1);
         uint8_t* RecvBuffer =
             (uint8_t*)IoBlock + SocketContext->DatapathPartition->Datapath->RecvBlockBufferOffset;
@@ -1681,6 +1839,7 @@ CxPlatSocketContextRecvComplete(
             RecvData->Next = NULL;
             RecvData->Route = &IoBlock->Route;
             RecvData->Buffer = RecvBuffer + Offset;
+            RecvData->ReceiveTimeUs = ReceiveTimeUs;
             if (RecvMsgHdr[CurrentMessage].msg_len - Offset < SegmentLength) {
                 RecvData->BufferLength = (uint16_t)(RecvMsgHdr[CurrentMessage].msg_len - Offset);
             } else {
@@ -1689,6 +1848,7 @@ CxPlatSocketContextRecvComplete(
             RecvData->PartitionIndex = SocketContext->DatapathPartition->PartitionIndex;
             RecvData->TypeOfService = TOS;
             RecvData->HopLimitTTL = (uint8_t)HopLimitTTL;
+            RecvData->CoalescedCount = (uint16_t)(SegmentCount - IoBlock->RefCount + 1);
             RecvData->Allocated = TRUE;
             RecvData->Route->DatapathType = RecvData->DatapathType = CXPLAT_DATAPATH_TYPE_NORMAL;
             RecvData->QueuedOnConnection = FALSE;
@@ -1933,10 +2093,12 @@ CxPlatSocketReceiveTcpData(
 
             Data->Next = NULL;
             Data->Buffer = Buffer;
+            Data->ReceiveTimeUs = 0;
             Data->BufferLength = NumberOfBytesTransferred;
             Data->Route = &IoBlock->Route;
             Data->PartitionIndex = SocketContext->DatapathPartition->PartitionIndex;
             Data->TypeOfService = 0;
+            Data->CoalescedCount = 1;
             Data->Allocated = TRUE;
             Data->Route->DatapathType = Data->DatapathType = CXPLAT_DATAPATH_TYPE_NORMAL;
             Data->QueuedOnConnection = FALSE;
@@ -2025,10 +2187,13 @@ SendDataAlloc(
         SendData->ControlBufferLength = 0;
         SendData->ECN = Config->ECN;
         SendData->DSCP = Config->DSCP;
+        SendData->DepartureTimeUs =
+            SocketContext->TxTimeEnabled ? Config->DepartureTimeUs : 0;
         SendData->Flags = Config->Flags;
         SendData->OnConnectedSocket = Socket->Connected;
         SendData->SegmentationSupported =
             !!(Socket->Datapath->Features & CXPLAT_DATAPATH_FEATURE_SEND_SEGMENTATION);
+        SendData->ZeroCopy = FALSE;
         SendData->Iovs[0].iov_len = 0;
         SendData->Iovs[0].iov_base = SendData->Buffer;
         SendData->DatapathType = Config->Route->DatapathType = CXPLAT_DATAPATH_TYPE_NORMAL;
@@ -2136,7 +2301,8 @@ SendDataIsFull(
 
 QUIC_STATUS
 CxPlatSendDataSend(
-    _In_ CXPLAT_SEND_DATA* SendData
+    _In_ CXPLAT_SEND_DATA* SendData,
+    _Out_ BOOLEAN* ZeroCopyPending
     );
 
 void
@@ -2168,11 +2334,18 @@ SocketSend(
     CxPlatConvertToMappedV6(&Route->RemoteAddress, &SendData->RemoteAddress);
     SendData->LocalAddress = Route->LocalAddress;
 
+    CXPLAT_SOCKET_CONTEXT* SocketContext = SendData->SocketContext;
+#ifdef MSG_ZEROCOPY
+    SendData->ZeroCopy =
+        SocketContext->ZeroCopyEnabled &&
+        SendData->SegmentationSupported &&
+        SendData->TotalSize >= SocketContext->DatapathPartition->Datapath->SendZeroCopyThreshold;
+#endif
+
     //
     // Check to see if we need to pend because there's already queue.
     //
     BOOLEAN SendPending = FALSE, FlushTxQueue = FALSE;
-    CXPLAT_SOCKET_CONTEXT* SocketContext = SendData->SocketContext;
     CxPlatLockAcquire(&SocketContext->TxQueueLock);
     if (/*SendData->Flags & CXPLAT_SEND_FLAGS_MAX_THROUGHPUT ||*/
         !CxPlatListIsEmpty(&SocketContext->TxQueue)) {
@@ -2194,7 +2367,8 @@ SocketSend(
     //
     // Go ahead and try to send on the socket.
     //
-    QUIC_STATUS Status = CxPlatSendDataSend(SendData);
+    BOOLEAN ZeroCopyPending;
+    QUIC_STATUS Status = CxPlatSendDataSend(SendData, &ZeroCopyPending);
     if (Status == QUIC_STATUS_PENDING) {
         //
         // Couldn't send right now, so queue up the send and wait for send
@@ -2204,7 +2378,11 @@ SocketSend(
         CxPlatListInsertTail(&SocketContext->TxQueue, &SendData->TxEntry);
         CxPlatLockRelease(&SocketContext->TxQueueLock);
         CxPlatSocketContextSetEvents(SocketContext, EPOLL_CTL_MOD, EPOLLIN | EPOLLOUT);
-    } else {
+    } else if (!ZeroCopyPending) {
+        //
+        // Zero-copy sends are freed once the kernel releases them, possibly
+        // already on another thread, so they must not be touched here.
+        //
         if (Socket->Type != CXPLAT_SOCKET_UDP) {
             SocketContext->Binding->Datapath->TcpHandlers.SendComplete(
                 SocketContext->Binding,
@@ -2275,15 +2453,29 @@ CxPlatSendDataPopulateAncillaryData(
     }
 #endif
 
+#ifdef SCM_TXTIME
+    if (SendData->DepartureTimeUs != 0) {
+        Mhdr->msg_controllen += CMSG_SPACE(sizeof(uint64_t));
+        CMsg = CXPLAT_CMSG_NXTHDR(CMsg);
+        CMsg->cmsg_level = SOL_SOCKET;
+        CMsg->cmsg_type = SCM_TXTIME;
+        CMsg->cmsg_len = CMSG_LEN(sizeof(uint64_t));
+        *((uint64_t*)CMSG_DATA(CMsg)) = US_TO_NS(SendData->DepartureTimeUs);
+    }
+#endif
+
     CXPLAT_DBG_ASSERT(Mhdr->msg_controllen <= sizeof(SendData->ControlBuffer));
     SendData->ControlBufferLength = (uint8_t)Mhdr->msg_controllen;
 }
 
 BOOLEAN
 CxPlatSendDataSendSegmented(
-    _In_ CXPLAT_SEND_DATA* SendData
+    _In_ CXPLAT_SEND_DATA* SendData,
+    _Out_ BOOLEAN* ZeroCopyPending
     )
 {
+    *ZeroCopyPending = FALSE;
+
     struct msghdr msghdr;
     msghdr.msg_name = (void*)&SendData->RemoteAddress;
     msghdr.msg_namelen = sizeof(SendData->RemoteAddress);
@@ -2298,6 +2490,37 @@ CxPlatSendDataSendSegmented(
         msghdr.msg_controllen = SendData->ControlBufferLength;
     }
 
+#ifdef MSG_ZEROCOPY
+    if (SendData->ZeroCopy) {
+        //
+        // The kernel numbers zero-copy sends in the order it accepts them, so
+        // the send and the queue insert happen under the same lock to keep the
+        // queue in notification ID order.
+        //
+        CXPLAT_SOCKET_CONTEXT* SocketContext = SendData->SocketContext;
+        CxPlatLockAcquire(&SocketContext->TxQueueLock);
+        if (sendmsg(SocketContext->SocketFd, &msghdr, MSG_ZEROCOPY) >= 0) {
+            SendData->ZeroCopyId = SocketContext->ZeroCopyNextId++;
+            SocketContext->ZeroCopySends++;
+            CxPlatListInsertTail(&SocketContext->ZeroCopyQueue, &SendData->ZeroCopyEntry);
+            CxPlatLockRelease(&SocketContext->TxQueueLock);
+            *ZeroCopyPending = TRUE;
+            return TRUE;
+        }
+        CxPlatLockRelease(&SocketContext->TxQueueLock);
+
+        if (errno != ENOBUFS) {
+            return FALSE;
+        }
+
+        //
+        // Too many completions are outstanding for the socket's option memory,
+        // so copy this one instead.
+        //
+        SendData->ZeroCopy = FALSE;
+    }
+#endif
+
     if (sendmsg(SendData->SocketContext->SocketFd, &msghdr, 0) < 0) {
         return FALSE;
     }
@@ -2396,7 +2619,8 @@ CxPlatSendDataSendTcp(
 
 QUIC_STATUS
 CxPlatSendDataSend(
-    _In_ CXPLAT_SEND_DATA* SendData
+    _In_ CXPLAT_SEND_DATA* SendData,
+    _Out_ BOOLEAN* ZeroCopyPending
     )
 {
     CXPLAT_DBG_ASSERT(SendData != NULL);
@@ -2407,11 +2631,13 @@ CxPlatSendDataSend(
     CXPLAT_SOCKET_CONTEXT* SocketContext = SendData->SocketContext;
     BOOLEAN Success;
 
+    *ZeroCopyPending = FALSE;
     if (SocketType == CXPLAT_SOCKET_UDP) {
         Success =
 #ifdef UDP_SEGMENT
             SendData->SegmentationSupported ?
-                CxPlatSendDataSendSegmented(SendData) : CxPlatSendDataSendMessages(SendData);
+                CxPlatSendDataSendSegmented(SendData, ZeroCopyPending) :
+                CxPlatSendDataSendMessages(SendData);
 #else
             CxPlatSendDataSendMessages(SendData);
 #endif
@@ -2506,7 +2732,8 @@ CxPlatSocketContextFlushTxQueue(
     CxPlatLockRelease(&SocketContext->TxQueueLock);
 
     while (SendData != NULL) {
-        QUIC_STATUS Status = CxPlatSendDataSend(SendData);
+        BOOLEAN ZeroCopyPending;
+        QUIC_STATUS Status = CxPlatSendDataSend(SendData, &ZeroCopyPending);
         if (Status == QUIC_STATUS_PENDING) {
             if (!SendAlreadyPending) {
                 //
@@ -2526,7 +2753,9 @@ CxPlatSocketContextFlushTxQueue(
                 Status,
                 SendData->TotalSize);
         }
-        CxPlatSendDataFree(SendData);
+        if (!ZeroCopyPending) {
+            CxPlatSendDataFree(SendData);
+        }
         if (!CxPlatListIsEmpty(&SocketContext->TxQueue)) {
             SendData =
                 CXPLAT_CONTAINING_RECORD(
@@ -2569,6 +2798,150 @@ CxPlatSocketGetTcpStatistics(
     return QUIC_STATUS_NOT_SUPPORTED;
 }
 
+_IRQL_requires_max_(DISPATCH_LEVEL)
+QUIC_STATUS
+CxPlatSocketGetUdpStatistics(
+    _In_ CXPLAT_SOCKET* Socket,
+    _Out_ CXPLAT_UDP_STATISTICS* Statistics
+    )
+{
+    if (Socket->IsMemorySocket || Socket->Type != CXPLAT_SOCKET_UDP) {
+        return QUIC_STATUS_NOT_SUPPORTED;
+    }
+
+    CxPlatZeroMemory(Statistics, sizeof(*Statistics));
+    for (uint32_t i = 0; i < Socket->SocketCount; ++i) {
+        CXPLAT_SOCKET_CONTEXT* SocketContext = &Socket->SocketContexts[i];
+        CxPlatLockAcquire(&SocketContext->TxQueueLock);
+        Statistics->ZeroCopySends += SocketContext->ZeroCopySends;
+        Statistics->ZeroCopySendsCompleted += SocketContext->ZeroCopySendsCompleted;
+        CxPlatLockRelease(&SocketContext->TxQueueLock);
+    }
+
+    return QUIC_STATUS_SUCCESS;
+}
+
+#ifdef MSG_ZEROCOPY
+//
+// Frees the zero-copy sends with notification IDs in the [First, Last] range,
+// which the kernel no longer references.
+//
+void
+CxPlatSocketContextCompleteZeroCopySends(
+    _In_ CXPLAT_SOCKET_CONTEXT* SocketContext,
+    _In_ uint32_t First,
+    _In_ uint32_t Last
+    )
+{
+    CXPLAT_LIST_ENTRY Completed;
+    CxPlatListInitializeHead(&Completed);
+
+    CxPlatLockAcquire(&SocketContext->TxQueueLock);
+    CXPLAT_LIST_ENTRY* Entry = SocketContext->ZeroCopyQueue.Flink;
+    while (Entry != &SocketContext->ZeroCopyQueue) {
+        CXPLAT_SEND_DATA* SendData =
+            CXPLAT_CONTAINING_RECORD(Entry, CXPLAT_SEND_DATA, ZeroCopyEntry);
+        Entry = Entry->Flink;
+        if ((int32_t)(SendData->ZeroCopyId - Last) > 0) {
+            break; // The queue is in ID order, so the rest are still in use.
+        }
+        if (SendData->ZeroCopyId - First <= Last - First) {
+            CxPlatListEntryRemove(&SendData->ZeroCopyEntry);
+            CxPlatListInsertTail(&Completed, &SendData->ZeroCopyEntry);
+            SocketContext->ZeroCopySendsCompleted++;
+        }
+    }
+    CxPlatLockRelease(&SocketContext->TxQueueLock);
+
+    while (!CxPlatListIsEmpty(&Completed)) {
+        CxPlatSendDataFree(
+            CXPLAT_CONTAINING_RECORD(
+                CxPlatListRemoveHead(&Completed),
+                CXPLAT_SEND_DATA,
+                ZeroCopyEntry));
+    }
+}
+
+//
+// Drains the MSG_ZEROCOPY completion notifications from the socket's error
+// queue, which signals EPOLLERR while it is not empty.
+//
+void
+CxPlatSocketContextProcessZeroCopyCompletions(
+    _In_ CXPLAT_SOCKET_CONTEXT* SocketContext
+    )
+{
+    while (TRUE) {
+        alignas(8) char ControlBuffer[
+            CMSG_SPACE(sizeof(struct sock_extended_err) + sizeof(struct sockaddr_in6))];
+        struct msghdr Msg = {0};
+        Msg.msg_control = ControlBuffer;
+        Msg.msg_controllen = sizeof(ControlBuffer);
+
+        if (recvmsg(SocketContext->SocketFd, &Msg, MSG_ERRQUEUE) < 0) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                QuicTraceEvent(
+                    DatapathErrorStatus,
+                    "[data][%p] ERROR, %u, %s.",
+                    SocketContext->Binding,
+                    errno,
+                    "recvmsg(MSG_ERRQUEUE) failed");
+            }
+            break;
+        }
+
+        for (struct cmsghdr *CMsg = CMSG_FIRSTHDR(&Msg); CMsg != NULL; CMsg = CMSG_NXTHDR(&Msg, CMsg)) {
+            if (!(CMsg->cmsg_level == IPPROTO_IP && CMsg->cmsg_type == IP_RECVERR) &&
+                !(CMsg->cmsg_level == IPPROTO_IPV6 && CMsg->cmsg_type == IPV6_RECVERR)) {
+                continue;
+            }
+            CXPLAT_DBG_ASSERT_CMSG(CMsg, struct sock_extended_err);
+            const struct sock_extended_err* Error =
+                (const struct sock_extended_err*)CMSG_DATA(CMsg);
+            if (Error->ee_errno == 0 && Error->ee_origin == SO_EE_ORIGIN_ZEROCOPY) {
+                CxPlatSocketContextCompleteZeroCopySends(
+                    SocketContext, Error->ee_info, Error->ee_data);
+            }
+        }
+    }
+}
+
+//
+// Waits, for up to CXPLAT_ZEROCOPY_DRAIN_TIMEOUT_MS, for the kernel to
+// release every outstanding zero-copy send of a socket about to be closed.
+//
+void
+CxPlatSocketContextDrainZeroCopySends(
+    _In_ CXPLAT_SOCKET_CONTEXT* SocketContext
+    )
+{
+    const uint64_t StartMs = CxPlatTimeMs64();
+    while (TRUE) {
+        CxPlatSocketContextProcessZeroCopyCompletions(SocketContext);
+        if (CxPlatListIsEmpty(&SocketContext->ZeroCopyQueue)) {
+            break;
+        }
+
+        const uint64_t ElapsedMs = CxPlatTimeDiff64(StartMs, CxPlatTimeMs64());
+        if (ElapsedMs >= CXPLAT_ZEROCOPY_DRAIN_TIMEOUT_MS) {
+            QuicTraceEvent(
+                DatapathErrorStatus,
+                "[data][%p] ERROR, %u, %s.",
+                SocketContext->Binding,
+                ETIMEDOUT,
+                "zero-copy sends outstanding at close");
+            break;
+        }
+
+        //
+        // POLLERR is always reported, and is set while completions are queued.
+        //
+        struct pollfd PollFd = { SocketContext->SocketFd, 0, 0 };
+        (void)poll(&PollFd, 1, (int)(CXPLAT_ZEROCOPY_DRAIN_TIMEOUT_MS - ElapsedMs));
+    }
+}
+#endif
+
 void
 CxPlatSocketContextIoEventComplete(
     _In_ CXPLAT_CQE* Cqe
@@ -2579,6 +2952,11 @@ CxPlatSocketContextIoEventComplete(
 
     if (CxPlatRundownAcquire(&SocketContext->UpcallRundown)) {
         if (EPOLLERR & Cqe->events) {
+#ifdef MSG_ZEROCOPY
+            if (SocketContext->ZeroCopyEnabled) {
+                CxPlatSocketContextProcessZeroCopyCompletions(SocketContext);
+            }
+#endif
             CxPlatSocketHandleErrors(SocketContext);
         }
         if (EPOLLIN & Cqe->events) {
@@ -128,6 +128,12 @@ typedef struct CXPLAT_SEND_DATA {
     //
     QUIC_BUFFER ClientBuffer;
 
+    //
+    // The earliest time, in microseconds (see CxPlatTimeUs64), the kernel
+    // should transmit the send at. Zero transmits immediately.
+    //
+    uint64_t DepartureTimeUs;
+
     //
     // Total number of packet buffers allocated (and iovecs used if !GSO).
     //
@@ -160,6 +166,28 @@ typedef struct CXPLAT_SEND_DATA {
     //
     uint8_t SegmentationSupported : 1;
 
+    //
+    // Indicates the send goes out without the kernel copying the payload, so
+    // the buffer is only released once the kernel's notification completes.
+    //
+    uint8_t ZeroCopy : 1;
+
+    //
+    // Indicates the send data belongs to the partition's registered buffers
+    // instead of the SendBlockPool.
+    //
+    uint8_t Registered : 1;
+
+    //
+    // Indicates the send completed but its zero-copy notification hasn't.
+    //
+    uint8_t ZeroCopyNotifyPending : 1;
+
+    //
+    // Entry in the partition's list of free registered send buffers.
+    //
+    CXPLAT_SLIST_ENTRY RegisteredEntry;
+
     //
     // The message header for the send.
     //
@@ -174,6 +202,9 @@ typedef struct CXPLAT_SEND_DATA {
         CMSG_SPACE(sizeof(struct in6_pktinfo))  // IP_PKTINFO || IPV6_PKTINFO
     #ifdef UDP_SEGMENT
         + CMSG_SPACE(sizeof(uint16_t))          // UDP_SEGMENT
+    #endif
+    #ifdef SCM_TXTIME
+        + CMSG_SPACE(sizeof(uint64_t))          // SCM_TXTIME
     #endif
         ];
     CXPLAT_STATIC_ASSERT(
@@ -205,7 +236,11 @@ typedef struct CXPLAT_SEND_DATA {
 
 typedef struct CXPLAT_RECV_MSG_CONTROL_BUFFER {
     char Data[CMSG_SPACE(sizeof(struct in6_pktinfo)) + // IP_PKTINFO
-              3 * CMSG_SPACE(sizeof(int))]; // TOS + IP_TTL
+              3 * CMSG_SPACE(sizeof(int)) // TOS + IP_TTL
+    #ifdef SO_TIMESTAMPING
+              + CMSG_SPACE(sizeof(struct scm_timestamping)) // SCM_TIMESTAMPING
+    #endif
+              ];
 
 } CXPLAT_RECV_MSG_CONTROL_BUFFER;
 
@@ -217,6 +252,7 @@ const struct msghdr CxPlatRecvMsgHdr = {
     .msg_controllen = CXPLAT_FIELD_SIZE(CXPLAT_RECV_MSG_CONTROL_BUFFER, Data),
 };
 const uint32_t RecvBufCount = 1024;
+const uint32_t SendRegisteredBufCount = 64;
 
 void
 CxPlatSocketIoStart(
@@ -343,6 +379,95 @@ Exit:
     return Status;
 }
 
+BOOLEAN
+CxPlatSendZeroCopySupported(
+    _In_ CXPLAT_EVENTQ* EventQ
+    )
+{
+    struct io_uring_probe* Probe = io_uring_get_probe_ring(&EventQ->Ring);
+    if (Probe == NULL) {
+        return FALSE;
+    }
+    BOOLEAN Supported =
+        io_uring_opcode_supported(Probe, IORING_OP_SEND_ZC) &&
+        io_uring_opcode_supported(Probe, IORING_OP_SENDMSG_ZC);
+    io_uring_free_probe(Probe);
+    return Supported;
+}
+
+void
+CxPlatFreeSendRegisteredBufferPool(
+    _In_ CXPLAT_DATAPATH_PARTITION* DatapathPartition
+    )
+{
+    CXPLAT_REGISTERED_BUFFER_POOL* Pool = &DatapathPartition->SendRegisteredBufferPool;
+    if (Pool->Buffers != NULL) {
+        io_uring_unregister_buffers(&DatapathPartition->EventQ->Ring);
+        free(Pool->Buffers);
+        Pool->Buffers = NULL;
+        DatapathPartition->SendRegisteredFreeList.Next = NULL;
+        CxPlatLockUninitialize(&Pool->Lock);
+    }
+}
+
+//
+// Allocates the send contexts for the partition in one block and registers it
+// with the io_uring as a fixed buffer, so sends from it skip pinning the pages
+// on each IO.
+//
+QUIC_STATUS
+CxPlatCreateSendRegisteredBufferPool(
+    _In_ CXPLAT_DATAPATH_PARTITION* DatapathPartition,
+    _In_ uint32_t BufferSize,
+    _In_ uint32_t BufferCount
+    )
+{
+    CXPLAT_REGISTERED_BUFFER_POOL* Pool = &DatapathPartition->SendRegisteredBufferPool;
+    void* Buffers = NULL;
+
+    CXPLAT_DBG_ASSERT(BufferSize % CXPLAT_MEMORY_ALIGNMENT == 0);
+
+    const uint32_t TotalSize = BufferCount * BufferSize;
+    if (posix_memalign(&Buffers, getpagesize(), TotalSize)) {
+        QuicTraceEvent(
+            AllocFailure,
+            "Allocation of '%s' failed. (%llu bytes)",
+            "CXPLAT_REGISTERED_BUFFER_POOL",
+            TotalSize);
+        return QUIC_STATUS_OUT_OF_MEMORY;
+    }
+
+    struct iovec Iov = { .iov_base = Buffers, .iov_len = TotalSize };
+    int Result = io_uring_register_buffers(&DatapathPartition->EventQ->Ring, &Iov, 1);
+    if (Result < 0) {
+        QUIC_STATUS Status = (QUIC_STATUS)-Result;
+        QuicTraceEvent(
+            DatapathErrorStatus,
+            "[data][%p] ERROR, %u, %s.",
+            DatapathPartition,
+            Status,
+            "io_uring_register_buffers failed");
+        free(Buffers);
+        return Status;
+    }
+
+    CxPlatZeroMemory(Pool, sizeof(*Pool));
+    CxPlatLockInitialize(&Pool->Lock);
+    Pool->Buffers = (uint8_t*)Buffers;
+    Pool->BufferSize = BufferSize;
+    Pool->TotalSize = TotalSize;
+
+    DatapathPartition->SendRegisteredFreeList.Next = NULL;
+    for (uint32_t i = BufferCount; i > 0; i--) {
+        CXPLAT_SEND_DATA* SendData =
+            (CXPLAT_SEND_DATA*)CxPlatGetBufferPoolBuffer(Pool, i - 1);
+        CxPlatListPushEntry(
+            &DatapathPartition->SendRegisteredFreeList, &SendData->RegisteredEntry);
+    }
+
+    return QUIC_STATUS_SUCCESS;
+}
+
 QUIC_STATUS
 CxPlatProcessorContextInitialize(
     _In_ CXPLAT_DATAPATH* Datapath,
@@ -384,6 +509,18 @@ CxPlatProcessorContextInitialize(
     }
     io_uring_buf_ring_advance(DatapathPartition->RecvRegisteredBufferPool.Ring, RecvBufCount);
 
+    if (Datapath->Features & CXPLAT_DATAPATH_FEATURE_SEND_ZEROCOPY) {
+        //
+        // Best effort. Registration is bounded by RLIMIT_MEMLOCK, and without
+        // it zero-copy sends still work from the SendBlockPool, they just
+        // pin their pages on every send.
+        //
+        (void)CxPlatCreateSendRegisteredBufferPool(
+            DatapathPartition,
+            ALIGN_UP_BY(Datapath->SendDataSize, CXPLAT_MEMORY_ALIGNMENT),
+            SendRegisteredBufCount);
+    }
+
 Exit:
 
     return Status;
@@ -400,7 +537,6 @@ DataPathInitialize(
     )
 {
     UNREFERENCED_PARAMETER(TcpCallbacks);
-    UNREFERENCED_PARAMETER(InitConfig);
 
     if (NewDatapath == NULL) {
         return QUIC_STATUS_INVALID_PARAMETER;
@@ -451,6 +587,29 @@ DataPathInitialize(
     CxPlatRefInitializeEx(&Datapath->RefCount, Datapath->PartitionCount);
     CxPlatDataPathCalculateFeatureSupport(Datapath);
 
+    if (InitConfig->EnableSendZeroCopy &&
+        CxPlatSendZeroCopySupported(CxPlatWorkerPoolGetEventQ(WorkerPool, 0))) {
+        Datapath->Features |= CXPLAT_DATAPATH_FEATURE_SEND_ZEROCOPY;
+    }
+
+    if (InitConfig->EnableCidSteering && CxPlatDataPathIsCidSteeringSupported()) {
+        Datapath->Features |= CXPLAT_DATAPATH_FEATURE_CID_STEERING;
+    }
+
+#ifdef SO_TXTIME
+    if (InitConfig->EnableSendTxTime) {
+        Datapath->Features |= CXPLAT_DATAPATH_FEATURE_SEND_TXTIME;
+    }
+#endif
+
+#ifdef SO_TIMESTAMPING
+    if (InitConfig->EnableRecvTimestamp) {
+        Datapath->Features |= CXPLAT_DATAPATH_FEATURE_RECV_TIMESTAMP;
+    }
+#endif
+
+    Datapath->BusyPollUs = InitConfig->BusyPollUs;
+
     if (Datapath->Features & CXPLAT_DATAPATH_FEATURE_SEND_SEGMENTATION) {
         Datapath->SendDataSize = sizeof(CXPLAT_SEND_DATA);
         Datapath->SendIoVecCount = 1;
@@ -528,6 +687,7 @@ CxPlatProcessorContextRelease(
         CxPlatFreeBufferPool(
             DatapathPartition, CxPlatIoRingBufGroupRecv,
             &DatapathPartition->RecvRegisteredBufferPool);
+        CxPlatFreeSendRegisteredBufferPool(DatapathPartition);
         CxPlatPoolUninitialize(&DatapathPartition->SendBlockPool);
         CxPlatDataPathRelease(DatapathPartition->Datapath);
     }
@@ -873,6 +1033,10 @@ CxPlatSocketContextInitialize(
         }
     #endif
 
+        CxPlatSocketConfigureBusyPoll(SocketContext);
+        CxPlatSocketConfigureTxTime(SocketContext);
+        CxPlatSocketConfigureRecvTimestamp(SocketContext);
+
         //
         // The socket is shared by multiple QUIC endpoints, so increase the receive
         // buffer size.
@@ -1260,7 +1424,19 @@ SocketCreateUdp(
     QUIC_STATUS Status = QUIC_STATUS_SUCCESS;
     const BOOLEAN IsServerSocket = Config->RemoteAddress == NULL;
     const BOOLEAN NumPerProcessorSockets = IsServerSocket && Datapath->PartitionCount > 1;
-    const uint16_t SocketCount = NumPerProcessorSockets ? (uint16_t)CxPlatProcCount() : 1;
+    const BOOLEAN CidSteering =
+        NumPerProcessorSockets &&
+        (Datapath->Features & CXPLAT_DATAPATH_FEATURE_CID_STEERING) &&
+        Config->PartitionCount == Datapath->PartitionCount;
+    //
+    // With CID steering, there is exactly one socket per partition so that a
+    // socket's index is also its partition index. That only holds if the
+    // caller partitions its CIDs the same way the datapath partitions its
+    // sockets.
+    //
+    const uint16_t SocketCount =
+        NumPerProcessorSockets ?
+            (CidSteering ? (uint16_t)Datapath->PartitionCount : (uint16_t)CxPlatProcCount()) : 1;
 
     CXPLAT_DBG_ASSERT(Datapath->UdpHandlers.Receive != NULL || Config->Flags & CXPLAT_SOCKET_FLAG_PCP);
 
@@ -1293,6 +1469,7 @@ SocketCreateUdp(
     Binding->HasFixedRemoteAddress = (Config->RemoteAddress != NULL);
     Binding->Mtu = CXPLAT_MAX_MTU;
     Binding->Type = CXPLAT_SOCKET_UDP;
+    Binding->SocketCount = SocketCount;
     CxPlatRefInitializeEx(&Binding->RefCount, SocketCount);
     if (Config->LocalAddress) {
         CxPlatConvertToMappedV6(Config->LocalAddress, &Binding->LocalAddress);
@@ -1329,7 +1506,10 @@ SocketCreateUdp(
         // round robin, but each flow will be sent to the same socket, just not
         // based on RSS.
         //
-        (void)CxPlatSocketConfigureRss(&Binding->SocketContexts[0], SocketCount);
+        if (!CidSteering ||
+            QUIC_FAILED(CxPlatSocketConfigureCidSteering(&Binding->SocketContexts[0], Config, SocketCount))) {
+            (void)CxPlatSocketConfigureRss(&Binding->SocketContexts[0], SocketCount);
+        }
     }
 
     CxPlatConvertFromMappedV6(&Binding->LocalAddress, &Binding->LocalAddress);
@@ -1417,10 +1597,7 @@ SocketDelete(
     Socket->Uninitialized = TRUE;
 #endif
 
-    const uint16_t SocketCount =
-        Socket->NumPerProcessorSockets ? (uint16_t)CxPlatProcCount() : 1;
-
-    for (uint32_t i = 0; i < SocketCount; ++i) {
+    for (uint32_t i = 0; i < Socket->SocketCount; ++i) {
         CxPlatSocketContextUninitialize(&Socket->SocketContexts[i]);
     }
 }
@@ -1502,6 +1679,7 @@ CxPlatSocketContextRecvComplete(
     uint32_t BytesTransferred = 0;
     CXPLAT_RECV_DATA* DatagramHead = NULL;
     CXPLAT_RECV_DATA** DatagramTail = &DatagramHead;
+    CXPLAT_RECV_TIMESTAMP_CLOCK RecvClock = {0};
     for (int CurrentMessage = 0; CurrentMessage < 1; CurrentMessage++) {
         DATAPATH_RX_IO_BLOCK* IoBlock = IoBlocks[CurrentMessage];
         IoBlocks[CurrentMessage] = NULL;
@@ -1511,6 +1689,7 @@ CxPlatSocketContextRecvComplete(
         uint8_t TOS = 0;
         int HopLimitTTL = 0;
         uint16_t SegmentLength = 0;
+        uint64_t ReceiveTimeUs = 0;
         BOOLEAN FoundLocalAddr = FALSE, FoundTOS = FALSE, FoundTTL = FALSE;
         QUIC_ADDR* LocalAddr = &IoBlock->Route.LocalAddress;
         QUIC_ADDR* RemoteAddr = RecvMsgHdr->msg_name;
@@ -1519,7 +1698,8 @@ CxPlatSocketContextRecvComplete(
 
         //
         // Process the ancillary control messages to get the local address,
-        // type of service and possibly the GRO segmentation length.
+        // type of service, possibly the GRO segmentation length and the receive
+        // timestamp.
         //
         struct msghdr* Msg = RecvMsgHdr;
         for (struct cmsghdr*CMsg = CMSG_FIRSTHDR(Msg); CMsg != NULL; CMsg = CMSG_NXTHDR(Msg, CMsg)) {
@@ -1563,6 +1743,12 @@ CxPlatSocketContextRecvComplete(
                     CXPLAT_DBG_ASSERT_CMSG(CMsg, uint16_t);
                     SegmentLength = *(uint16_t*)CMSG_DATA(CMsg);
                 }
+#endif
+            } else if (CMsg->cmsg_level == SOL_SOCKET) {
+#ifdef SO_TIMESTAMPING
+                if (CMsg->cmsg_type == SCM_TIMESTAMPING) {
+                    ReceiveTimeUs = CxPlatSocketGetRecvTimestamp(CMsg, &RecvClock);
+                }
 #endif
             } else {
                 CXPLAT_DBG_ASSERT(FALSE);
@@ -1586,6 +1772,14 @@ CxPlatSocketContextRecvComplete(
             SegmentLength = MsgLen;
         }
 
+        uint32_t SegmentCount = 0;
+        if (SegmentLength != 0) {
+            SegmentCount =
+                CXPLAT_MIN(
+                    (MsgLen + SegmentLength - 1) / SegmentLength,
+                    CXPLAT_MAX_IO_BATCH_SIZE);
+        }
+
         DATAPATH_RX_PACKET* Datagram = (DATAPATH_RX_PACKET*)(IoBlock + 1);
         uint8_t* RecvBuffer = Msg->msg_iov->iov_base;
         IoBlock->RefCount = 0;
@@ -1603,6 +1797,7 @@ CxPlatSocketContextRecvComplete(
             RecvData->Next = NULL;
             RecvData->Route = &IoBlock->Route;
             RecvData->Buffer = RecvBuffer + Offset;
+            RecvData->ReceiveTimeUs = ReceiveTimeUs;
             if (MsgLen - Offset < SegmentLength) {
                 RecvData->BufferLength = (uint16_t)(MsgLen - Offset);
             } else {
@@ -1611,6 +1806,7 @@ CxPlatSocketContextRecvComplete(
             RecvData->PartitionIndex = SocketContext->DatapathPartition->PartitionIndex;
             RecvData->TypeOfService = TOS;
             RecvData->HopLimitTTL = (uint8_t)HopLimitTTL;
+            RecvData->CoalescedCount = (uint16_t)(SegmentCount - IoBlock->RefCount + 1);
             RecvData->Allocated = TRUE;
             RecvData->Route->DatapathType = RecvData->DatapathType = CXPLAT_DATAPATH_TYPE_NORMAL;
             RecvData->QueuedOnConnection = FALSE;
@@ -1787,9 +1983,27 @@ SendDataAlloc(
     }
 
     CXPLAT_SOCKET_CONTEXT* SocketContext = (CXPLAT_SOCKET_CONTEXT*)Config->Route->Queue;
+    CXPLAT_DATAPATH_PARTITION* DatapathPartition = SocketContext->DatapathPartition;
     CXPLAT_DBG_ASSERT(SocketContext->Binding == Socket);
-    CXPLAT_DBG_ASSERT(SocketContext->Binding->Datapath == SocketContext->DatapathPartition->Datapath);
-    CXPLAT_SEND_DATA* SendData = CxPlatPoolAlloc(&SocketContext->DatapathPartition->SendBlockPool);
+    CXPLAT_DBG_ASSERT(SocketContext->Binding->Datapath == DatapathPartition->Datapath);
+    const BOOLEAN ZeroCopy =
+        Socket->Type == CXPLAT_SOCKET_UDP &&
+        !!(Socket->Datapath->Features & CXPLAT_DATAPATH_FEATURE_SEND_ZEROCOPY);
+    BOOLEAN Registered = FALSE;
+    CXPLAT_SEND_DATA* SendData = NULL;
+    if (ZeroCopy && DatapathPartition->SendRegisteredBufferPool.Buffers != NULL) {
+        CxPlatLockAcquire(&DatapathPartition->SendRegisteredBufferPool.Lock);
+        CXPLAT_SLIST_ENTRY* Entry =
+            CxPlatListPopEntry(&DatapathPartition->SendRegisteredFreeList);
+        CxPlatLockRelease(&DatapathPartition->SendRegisteredBufferPool.Lock);
+        if (Entry != NULL) {
+            SendData = CXPLAT_CONTAINING_RECORD(Entry, CXPLAT_SEND_DATA, RegisteredEntry);
+            Registered = TRUE;
+        }
+    }
+    if (SendData == NULL) {
+        SendData = CxPlatPoolAlloc(&DatapathPartition->SendBlockPool);
+    }
     if (SendData != NULL) {
         SendData->SocketContext = SocketContext;
         SendData->ClientBuffer.Buffer = SendData->Buffer;
@@ -1805,10 +2019,15 @@ SendDataAlloc(
         SendData->ControlBufferLength = 0;
         SendData->ECN = Config->ECN;
         SendData->DSCP = Config->DSCP;
+        SendData->DepartureTimeUs =
+            SocketContext->TxTimeEnabled ? Config->DepartureTimeUs : 0;
         SendData->Flags = Config->Flags;
         SendData->OnConnectedSocket = Socket->Connected;
         SendData->SegmentationSupported =
             !!(Socket->Datapath->Features & CXPLAT_DATAPATH_FEATURE_SEND_SEGMENTATION);
+        SendData->ZeroCopy = ZeroCopy;
+        SendData->Registered = Registered;
+        SendData->ZeroCopyNotifyPending = FALSE;
         SendData->Iovs[0].iov_len = 0;
         SendData->Iovs[0].iov_base = SendData->Buffer;
         SendData->DatapathType = Config->Route->DatapathType = CXPLAT_DATAPATH_TYPE_NORMAL;
@@ -1825,7 +2044,14 @@ SendDataFree(
     )
 {
     CXPLAT_DBG_ASSERT(SendDataUpdateState(SendData, SendStateFreed) != SendStateFreed);
-    CxPlatPoolFree(SendData);
+    if (SendData->Registered) {
+        CXPLAT_DATAPATH_PARTITION* DatapathPartition = SendData->SocketContext->DatapathPartition;
+        CxPlatLockAcquire(&DatapathPartition->SendRegisteredBufferPool.Lock);
+        CxPlatListPushEntry(&DatapathPartition->SendRegisteredFreeList, &SendData->RegisteredEntry);
+        CxPlatLockRelease(&DatapathPartition->SendRegisteredBufferPool.Lock);
+    } else {
+        CxPlatPoolFree(SendData);
+    }
 }
 
 static
@@ -2019,6 +2245,17 @@ CxPlatSendDataPopulateAncillaryData(
     }
 #endif
 
+#ifdef SCM_TXTIME
+    if (SendData->DepartureTimeUs != 0) {
+        Mhdr->msg_controllen += CMSG_SPACE(sizeof(uint64_t));
+        CMsg = CXPLAT_CMSG_NXTHDR(CMsg);
+        CMsg->cmsg_level = SOL_SOCKET;
+        CMsg->cmsg_type = SCM_TXTIME;
+        CMsg->cmsg_len = CMSG_LEN(sizeof(uint64_t));
+        *((uint64_t*)CMSG_DATA(CMsg)) = US_TO_NS(SendData->DepartureTimeUs);
+    }
+#endif
+
     CXPLAT_DBG_ASSERT(Mhdr->msg_controllen <= sizeof(SendData->ControlBuffer));
     SendData->ControlBufferLength = (uint8_t)Mhdr->msg_controllen;
 }
@@ -2073,7 +2310,24 @@ CxPlatSendDataSendSegmented(
         SendData->MsgHdr.msg_controllen = SendData->ControlBufferLength;
     }
 
-    io_uring_prep_sendmsg(Sqe, SendData->SocketContext->SocketFd, &SendData->MsgHdr, 0);
+    if (!SendData->ZeroCopy) {
+        io_uring_prep_sendmsg(Sqe, SocketContext->SocketFd, &SendData->MsgHdr, 0);
+    } else if (
+        SendData->Registered &&
+        SendData->OnConnectedSocket &&
+        SendData->ECN == 0 && SendData->DSCP == 0 &&
+        SendData->Iovs[0].iov_len <= SendData->SegmentSize) {
+        //
+        // Nothing needs to be carried in the control data (the TOS is the
+        // socket default and there is no segmentation), so send straight from
+        // the registered buffer.
+        //
+        io_uring_prep_send_zc_fixed(
+            Sqe, SocketContext->SocketFd, SendData->Iovs[0].iov_base,
+            SendData->Iovs[0].iov_len, 0, 0, 0);
+    } else {
+        io_uring_prep_sendmsg_zc(Sqe, SocketContext->SocketFd, &SendData->MsgHdr, 0);
+    }
     io_uring_sqe_set_data(Sqe, (void*)&SendData->Sqe);
     CxPlatBatchSqeInitialize(
         DatapathPartition->EventQ, CxPlatSocketContextIoEventComplete, &SendData->Sqe.Sqe);
@@ -2186,9 +2440,37 @@ CxPlatSocketContextSendComplete(
 {
     CXPLAT_SQE* Sqe = CxPlatCqeGetSqe(&Cqe);
     CXPLAT_SEND_DATA* SendData = CXPLAT_CONTAINING_RECORD(Sqe, CXPLAT_SEND_DATA, Sqe);
+    BOOLEAN IoComplete = TRUE;
+
+    if (SendData->ZeroCopy) {
+        if (Cqe->flags & IORING_CQE_F_NOTIF) {
+            //
+            // The kernel released the buffer of a send that already completed.
+            //
+            CXPLAT_DBG_ASSERT(SendData->ZeroCopyNotifyPending);
+            SocketContext->ZeroCopySendsCompleted++;
+            CxPlatSendDataFree(SendData);
+            CxPlatSocketIoComplete(SocketContext, IoTagSend);
+            return;
+        }
+
+        //
+        // IORING_CQE_F_MORE means a notification completion will follow once
+        // the kernel no longer references the buffer. Until then, the send
+        // data and its IO reference must be kept.
+        //
+        SendData->ZeroCopyNotifyPending = !!(Cqe->flags & IORING_CQE_F_MORE);
+        if (SendData->ZeroCopyNotifyPending) {
+            SocketContext->ZeroCopySends++;
+        }
+    }
 
     CXPLAT_DBG_ASSERT(SendDataUpdateState(SendData, SendStateSendComplete) == SendStateSending);
-    CxPlatSendDataFree(SendData);
+    if (SendData->ZeroCopyNotifyPending) {
+        IoComplete = FALSE;
+    } else {
+        CxPlatSendDataFree(SendData);
+    }
     SendData = NULL;
 
     if (SocketContext->LockedFlags.Shutdown) {
@@ -2227,7 +2509,9 @@ CxPlatSocketContextSendComplete(
 
 Exit:
 
-    CxPlatSocketIoComplete(SocketContext, IoTagSend);
+    if (IoComplete) {
+        CxPlatSocketIoComplete(SocketContext, IoTagSend);
+    }
 }
 
 _IRQL_requires_max_(DISPATCH_LEVEL)
@@ -2242,6 +2526,27 @@ CxPlatSocketGetTcpStatistics(
     return QUIC_STATUS_NOT_SUPPORTED;
 }
 
+_IRQL_requires_max_(DISPATCH_LEVEL)
+QUIC_STATUS
+CxPlatSocketGetUdpStatistics(
+    _In_ CXPLAT_SOCKET* Socket,
+    _Out_ CXPLAT_UDP_STATISTICS* Statistics
+    )
+{
+    if (Socket->IsMemorySocket || Socket->Type != CXPLAT_SOCKET_UDP) {
+        return QUIC_STATUS_NOT_SUPPORTED;
+    }
+
+    CxPlatZeroMemory(Statistics, sizeof(*Statistics));
+    for (uint32_t i = 0; i < Socket->SocketCount; ++i) {
+        CXPLAT_SOCKET_CONTEXT* SocketContext = &Socket->SocketContexts[i];
+        Statistics->ZeroCopySends += SocketContext->ZeroCopySends;
+        Statistics->ZeroCopySendsCompleted += SocketContext->ZeroCopySendsCompleted;
+    }
+
+    return QUIC_STATUS_SUCCESS;
+}
+
 CXPLAT_SOCKET_CONTEXT*
 GetSocketContextFromSqe(
     _In_ CXPLAT_SQE* Sqe
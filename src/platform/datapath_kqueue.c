@@ -592,6 +592,7 @@ CxPlatDataPathAllocRxIoBlock(
         IoBlock->Route.State = RouteResolved;
         IoBlock->OwningPool = &DatapathPartition->RecvBlockPool;
         IoBlock->RecvPacket.Buffer = IoBlock->Buffer;
+        IoBlock->RecvPacket.CoalescedCount = 1;
         IoBlock->RecvPacket.Allocated = TRUE;
     }
     return IoBlock;
@@ -1112,6 +1113,7 @@ CxPlatSocketContextRecvComplete(
 
     RecvPacket->Route->Queue = (CXPLAT_QUEUE*)SocketContext;
     RecvPacket->TypeOfService = 0;
+    RecvPacket->ReceiveTimeUs = 0;
     RecvPacket->HopLimitTTL = 0; // TODO: We are not supporting this on MacOS (yet) unless there's a business need.
 
     struct cmsghdr *CMsg;
@@ -2115,6 +2117,18 @@ CxPlatSocketGetTcpStatistics(
     return QUIC_STATUS_NOT_SUPPORTED;
 }
 
+_IRQL_requires_max_(DISPATCH_LEVEL)
+QUIC_STATUS
+CxPlatSocketGetUdpStatistics(
+    _In_ CXPLAT_SOCKET* Socket,
+    _Out_ CXPLAT_UDP_STATISTICS* Statistics
+    )
+{
+    UNREFERENCED_PARAMETER(Socket);
+    UNREFERENCED_PARAMETER(Statistics);
+    return QUIC_STATUS_NOT_SUPPORTED;
+}
+
 _IRQL_requires_max_(PASSIVE_LEVEL)
 void
 QuicCopyRouteInfo(
@@ -236,6 +236,300 @@ CxPlatSocketConfigureRss(
 #endif
 }
 
+#ifdef SO_ATTACH_REUSEPORT_CBPF
+//
+// Steers short header packets to the socket with the same index as the
+// partition encoded in their destination CID, modulo the number of sockets in
+// the reuseport group. Everything else (long headers and runts) gets an out of
+// range index, so the kernel falls back to its flow hash.
+//
+static
+int
+CxPlatSocketAttachCidSteering(
+    _In_ int SocketFd,
+    _In_ uint8_t PartitionIdOffsetDst,
+    _In_ uint16_t PartitionIdMask,
+    _In_ uint32_t SocketCount
+    )
+{
+    //
+    // The reuseport program runs with the UDP payload at offset 0. The
+    // destination CID starts right after the first byte of a short header.
+    //
+    const uint32_t PidOffset = 1 + PartitionIdOffsetDst;
+    const uint32_t FallbackIndex = UINT32_MAX;
+
+    //
+    // The partition ID is written into the CID in host byte order.
+    //
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    const uint32_t PidHighOffset = PidOffset;
+    const uint32_t PidLowOffset = PidOffset + 1;
+#else
+    const uint32_t PidHighOffset = PidOffset + 1;
+    const uint32_t PidLowOffset = PidOffset;
+#endif
+
+    struct sock_filter BpfCode[] = {
+        {BPF_LD | BPF_W | BPF_LEN, 0, 0, 0},                    // Load payload length
+        {BPF_JMP | BPF_JGE | BPF_K, 0, 10, PidOffset + 2},      // Fall back if too short
+        {BPF_LD | BPF_B | BPF_ABS, 0, 0, 0},                    // Load first byte
+        {BPF_JMP | BPF_JSET | BPF_K, 8, 0, 0x80},               // Fall back if long header
+        {BPF_LD | BPF_B | BPF_ABS, 0, 0, PidHighOffset},        // Load partition ID
+        {BPF_ALU | BPF_LSH | BPF_K, 0, 0, 8},
+        {BPF_MISC | BPF_TAX, 0, 0, 0},
+        {BPF_LD | BPF_B | BPF_ABS, 0, 0, PidLowOffset},
+        {BPF_ALU | BPF_OR | BPF_X, 0, 0, 0},
+        {BPF_ALU | BPF_AND | BPF_K, 0, 0, PartitionIdMask},     // Extract the index
+        {BPF_ALU | BPF_MOD | BPF_K, 0, 0, SocketCount},         // MOD by SocketCount
+        {BPF_RET | BPF_A, 0, 0, 0},                             // Return
+        {BPF_RET | BPF_K, 0, 0, FallbackIndex}                  // Return (fall back)
+    };
+
+    struct sock_fprog BpfConfig = {0};
+    BpfConfig.len = ARRAYSIZE(BpfCode);
+    BpfConfig.filter = BpfCode;
+
+    return
+        setsockopt(
+            SocketFd,
+            SOL_SOCKET,
+            SO_ATTACH_REUSEPORT_CBPF,
+            (const void*)&BpfConfig,
+            sizeof(BpfConfig)) == SOCKET_ERROR ? errno : 0;
+}
+#endif
+
+BOOLEAN
+CxPlatDataPathIsCidSteeringSupported(
+    void
+    )
+{
+#ifdef SO_ATTACH_REUSEPORT_CBPF
+    //
+    // Attach the program to a throwaway reuseport socket, so the feature is
+    // only reported where the kernel actually accepts it.
+    //
+    BOOLEAN Supported = FALSE;
+    int Option = 1;
+    int Socket = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK, IPPROTO_UDP);
+    if (Socket == INVALID_SOCKET) {
+        return FALSE;
+    }
+    if (setsockopt(Socket, SOL_SOCKET, SO_REUSEPORT, &Option, sizeof(Option)) != SOCKET_ERROR &&
+        CxPlatSocketAttachCidSteering(Socket, 0, 0xFFFF, 2) == 0) {
+        Supported = TRUE;
+    }
+    close(Socket);
+    return Supported;
+#else
+    return FALSE;
+#endif
+}
+
+QUIC_STATUS
+CxPlatSocketConfigureCidSteering(
+    _In_ CXPLAT_SOCKET_CONTEXT* SocketContext,
+    _In_ const CXPLAT_UDP_CONFIG* Config,
+    _In_ uint32_t SocketCount
+    )
+{
+#ifdef SO_ATTACH_REUSEPORT_CBPF
+    QUIC_STATUS Status =
+        CxPlatSocketAttachCidSteering(
+            SocketContext->SocketFd,
+            Config->PartitionIdOffsetDst,
+            Config->PartitionIdMask,
+            SocketCount);
+    if (QUIC_FAILED(Status)) {
+        QuicTraceEvent(
+            DatapathErrorStatus,
+            "[data][%p] ERROR, %u, %s.",
+            SocketContext->Binding,
+            Status,
+            "setsockopt(SO_ATTACH_REUSEPORT_CBPF) failed");
+    }
+
+    return Status;
+#else
+    UNREFERENCED_PARAMETER(SocketContext);
+    UNREFERENCED_PARAMETER(Config);
+    UNREFERENCED_PARAMETER(SocketCount);
+    return QUIC_STATUS_NOT_SUPPORTED;
+#endif
+}
+
+//
+// Best effort. Raising SO_BUSY_POLL above net.core.busy_read requires
+// CAP_NET_ADMIN, and older kernels don't know SO_PREFER_BUSY_POLL, in which
+// case receives are interrupt driven as usual.
+//
+void
+CxPlatSocketConfigureBusyPoll(
+    _In_ CXPLAT_SOCKET_CONTEXT* SocketContext
+    )
+{
+#ifdef SO_BUSY_POLL
+    const uint32_t BusyPollUs = SocketContext->Binding->Datapath->BusyPollUs;
+    if (BusyPollUs == 0) {
+        return;
+    }
+
+    int Option = (int)CXPLAT_MIN(BusyPollUs, INT32_MAX);
+    if (setsockopt(
+            SocketContext->SocketFd,
+            SOL_SOCKET,
+            SO_BUSY_POLL,
+            (const void*)&Option,
+            sizeof(Option)) == SOCKET_ERROR) {
+        QuicTraceEvent(
+            DatapathErrorStatus,
+            "[data][%p] ERROR, %u, %s.",
+            SocketContext->Binding,
+            errno,
+            "setsockopt(SO_BUSY_POLL) failed");
+        return;
+    }
+
+#ifdef SO_PREFER_BUSY_POLL
+    Option = TRUE;
+    if (setsockopt(
+            SocketContext->SocketFd,
+            SOL_SOCKET,
+            SO_PREFER_BUSY_POLL,
+            (const void*)&Option,
+            sizeof(Option)) == SOCKET_ERROR) {
+        QuicTraceEvent(
+            DatapathErrorStatus,
+            "[data][%p] ERROR, %u, %s.",
+            SocketContext->Binding,
+            errno,
+            "setsockopt(SO_PREFER_BUSY_POLL) failed");
+    }
+#endif
+#else
+    UNREFERENCED_PARAMETER(SocketContext);
+#endif
+}
+
+//
+// Best effort. The departure times only take effect under a qdisc that honors
+// them (i.e. fq), otherwise the kernel transmits immediately. CLOCK_MONOTONIC
+// is what fq expects and what CxPlatTimeUs64 uses.
+//
+void
+CxPlatSocketConfigureTxTime(
+    _Inout_ CXPLAT_SOCKET_CONTEXT* SocketContext
+    )
+{
+#ifdef SO_TXTIME
+    if (!(SocketContext->Binding->Datapath->Features & CXPLAT_DATAPATH_FEATURE_SEND_TXTIME)) {
+        return;
+    }
+
+    struct sock_txtime TxTimeConfig = {0};
+    TxTimeConfig.clockid = CLOCK_MONOTONIC;
+    if (setsockopt(
+            SocketContext->SocketFd,
+            SOL_SOCKET,
+            SO_TXTIME,
+            (const void*)&TxTimeConfig,
+            sizeof(TxTimeConfig)) == SOCKET_ERROR) {
+        QuicTraceEvent(
+            DatapathErrorStatus,
+            "[data][%p] ERROR, %u, %s.",
+            SocketContext->Binding,
+            errno,
+            "setsockopt(SO_TXTIME) failed");
+        return;
+    }
+
+    SocketContext->TxTimeEnabled = TRUE;
+#else
+    UNREFERENCED_PARAMETER(SocketContext);
+#endif
+}
+
+//
+// Best effort. Only software timestamps are requested: hardware ones are in the
+// NIC's clock domain, which isn't guaranteed to be synchronized to the system's.
+//
+void
+CxPlatSocketConfigureRecvTimestamp(
+    _In_ CXPLAT_SOCKET_CONTEXT* SocketContext
+    )
+{
+#ifdef SO_TIMESTAMPING
+    if (!(SocketContext->Binding->Datapath->Features & CXPLAT_DATAPATH_FEATURE_RECV_TIMESTAMP)) {
+        return;
+    }
+
+    int Option = SOF_TIMESTAMPING_RX_SOFTWARE | SOF_TIMESTAMPING_SOFTWARE;
+    if (setsockopt(
+            SocketContext->SocketFd,
+            SOL_SOCKET,
+            SO_TIMESTAMPING,
+            (const void*)&Option,
+            sizeof(Option)) == SOCKET_ERROR) {
+        QuicTraceEvent(
+            DatapathErrorStatus,
+            "[data][%p] ERROR, %u, %s.",
+            SocketContext->Binding,
+            errno,
+            "setsockopt(SO_TIMESTAMPING) failed");
+    }
+#else
+    UNREFERENCED_PARAMETER(SocketContext);
+#endif
+}
+
+//
+// Converts an SCM_TIMESTAMPING control message to CxPlatTimeUs64 units. The
+// kernel stamps packets with CLOCK_REALTIME, so the timestamp's age is measured
+// against that clock and subtracted from the current CLOCK_MONOTONIC time.
+// Returns zero if the message carries no usable timestamp.
+//
+uint64_t
+CxPlatSocketGetRecvTimestamp(
+    _In_ const struct cmsghdr* CMsg,
+    _Inout_ CXPLAT_RECV_TIMESTAMP_CLOCK* Clock
+    )
+{
+#ifdef SO_TIMESTAMPING
+    CXPLAT_DBG_ASSERT_CMSG(CMsg, struct scm_timestamping);
+    const struct scm_timestamping* Timestamps =
+        (const struct scm_timestamping*)CMSG_DATA(CMsg);
+    const uint64_t RecvTimeUs =
+        S_TO_US((uint64_t)Timestamps->ts[0].tv_sec) +
+        NS_TO_US((uint64_t)Timestamps->ts[0].tv_nsec);
+    if (RecvTimeUs == 0) {
+        return 0;
+    }
+
+    if (Clock->RealTimeUs == 0) {
+        struct timespec Now;
+        clock_gettime(CLOCK_REALTIME, &Now);
+        Clock->RealTimeUs = S_TO_US((uint64_t)Now.tv_sec) + NS_TO_US((uint64_t)Now.tv_nsec);
+        Clock->MonotonicTimeUs = CxPlatTimeUs64();
+    }
+
+    if (RecvTimeUs >= Clock->RealTimeUs) {
+        return Clock->MonotonicTimeUs;
+    }
+
+    const uint64_t AgeUs = Clock->RealTimeUs - RecvTimeUs;
+    if (AgeUs > CXPLAT_MAX_RECV_TIMESTAMP_AGE_US || AgeUs >= Clock->MonotonicTimeUs) {
+        return 0;
+    }
+
+    return Clock->MonotonicTimeUs - AgeUs;
+#else
+    UNREFERENCED_PARAMETER(CMsg);
+    UNREFERENCED_PARAMETER(Clock);
+    return 0;
+#endif
+}
+
 void
 CxPlatSocketHandleError(
     _In_ CXPLAT_SOCKET_CONTEXT* SocketContext,
@@ -8,10 +8,13 @@
 #pragma once
 
 #include <fcntl.h>
+#include <linux/errqueue.h>
 #include <linux/filter.h>
 #include <linux/in6.h>
+#include <linux/net_tstamp.h>
 #include <linux/stddef.h>
 #include <netinet/udp.h>
+#include <poll.h>
 
 //
 // The maximum single buffer size for single packet/datagram IO payloads.
@@ -31,6 +34,33 @@
 //
 #define CXPLAT_MAX_IO_BATCH_SIZE ((uint16_t)(CXPLAT_LARGE_IO_BUFFER_SIZE / (1280 - CXPLAT_MIN_IPV6_HEADER_SIZE - CXPLAT_UDP_HEADER_SIZE)))
 
+//
+// The default minimum payload size of a send for it to use MSG_ZEROCOPY. Below
+// this, page pinning and completion notifications cost more than the copy.
+//
+#define CXPLAT_DEFAULT_SEND_ZEROCOPY_THRESHOLD 0x4000
+
+//
+// How long closing a socket waits for the kernel to release the buffers of its
+// outstanding MSG_ZEROCOPY sends.
+//
+#define CXPLAT_ZEROCOPY_DRAIN_TIMEOUT_MS    100
+
+//
+// Kernel receive timestamps further in the past than this, by the time they are
+// processed, are assumed to come from a step of the realtime clock and dropped.
+//
+#define CXPLAT_MAX_RECV_TIMESTAMP_AGE_US    1000000
+
+//
+// A CLOCK_REALTIME/CLOCK_MONOTONIC pair, sampled once per receive completion,
+// to convert kernel receive timestamps to CxPlatTimeUs64 units.
+//
+typedef struct CXPLAT_RECV_TIMESTAMP_CLOCK {
+    uint64_t RealTimeUs; // Zero until first needed.
+    uint64_t MonotonicTimeUs;
+} CXPLAT_RECV_TIMESTAMP_CLOCK;
+
 #define CXPLAT_DBG_ASSERT_CMSG(CMsg, type) \
     CXPLAT_DBG_ASSERT((CMsg)->cmsg_len >= CMSG_LEN(sizeof(type)))
 
@@ -45,6 +75,39 @@ CxPlatSocketConfigureRss(
     _In_ uint32_t SocketCount
     );
 
+BOOLEAN
+CxPlatDataPathIsCidSteeringSupported(
+    void
+    );
+
+QUIC_STATUS
+CxPlatSocketConfigureCidSteering(
+    _In_ CXPLAT_SOCKET_CONTEXT* SocketContext,
+    _In_ const CXPLAT_UDP_CONFIG* Config,
+    _In_ uint32_t SocketCount
+    );
+
+void
+CxPlatSocketConfigureBusyPoll(
+    _In_ CXPLAT_SOCKET_CONTEXT* SocketContext
+    );
+
+void
+CxPlatSocketConfigureTxTime(
+    _Inout_ CXPLAT_SOCKET_CONTEXT* SocketContext
+    );
+
+void
+CxPlatSocketConfigureRecvTimestamp(
+    _In_ CXPLAT_SOCKET_CONTEXT* SocketContext
+    );
+
+uint64_t
+CxPlatSocketGetRecvTimestamp(
+    _In_ const struct cmsghdr* CMsg,
+    _Inout_ CXPLAT_RECV_TIMESTAMP_CLOCK* Clock
+    );
+
 _IRQL_requires_max_(PASSIVE_LEVEL)
 void
 DataPathUpdatePollingIdleTimeout(
@@ -0,0 +1,1233 @@
+/*++
+
+    Copyright (c) Microsoft Corporation.
+    Licensed under the MIT License.
+
+Abstract:
+
+    QUIC In-Process Memory Datapath Implementation (User Mode)
+
+    Sends are handed directly to the receive path of the socket bound to the
+    destination port in the same process, without any system calls or copies,
+    so benchmarks can measure the CPU cost of the protocol alone. A segmented
+    send is delivered as a coalesced chain of receive data pointing into the
+    send buffer, the same way GRO would deliver it.
+
+    Sockets are identified by their local port only; IP addresses are carried
+    along in the routes but otherwise ignored. Only UDP is supported.
+
+    Optionally, each datagram is put through an emulated network path on its
+    way to the peer: a token bucket bottleneck with a finite queue, random and
+    burst loss, and delay with jitter and reordering. Delayed datagrams wait
+    on a per-partition delay queue, which is drained by an execution context
+    on the partition's worker once they are due. All randomness comes from a
+    seeded generator per sending socket, so runs are reproducible.
+
+--*/
+
+#include "platform_internal.h"
+
+#ifdef QUIC_CLOG
+#include "datapath_memory.c.clog.h"
+#endif
+
+//
+// The largest payload a single (segmented) send can carry.
+//
+#define CXPLAT_MEMORY_SEND_BUFFER_SIZE      0xFFE3
+
+//
+// The most segments a single send can carry.
+//
+#define CXPLAT_MEMORY_MAX_SEGMENTS          64
+
+//
+// The range local ports are assigned from when none is specified.
+//
+#define CXPLAT_MEMORY_EPHEMERAL_PORT_START  49152
+
+//
+// Emulated loss and reordering probabilities are in parts per million.
+//
+#define CXPLAT_MEMORY_PPM                   1000000
+
+typedef struct CXPLAT_SOCKET_MEMORY CXPLAT_SOCKET_MEMORY;
+
+//
+// Per-partition queue of emulated datagrams waiting for their delivery time.
+//
+typedef struct CXPLAT_MEMORY_DELAY_QUEUE {
+
+    //
+    // Runs on the partition's worker to deliver the datagrams that are due.
+    //
+    CXPLAT_EXECUTION_CONTEXT ExecutionContext;
+
+    CXPLAT_DATAPATH_MEMORY* MemoryDataPath;
+
+    //
+    // Protects Packets and the execution context's NextTimeUs.
+    //
+    CXPLAT_LOCK Lock;
+
+    //
+    // Receive packets ordered by delivery time. Each holds a reference on the
+    // socket it is sent to.
+    //
+    CXPLAT_LIST_ENTRY Packets;
+
+} CXPLAT_MEMORY_DELAY_QUEUE;
+
+//
+// The emulated network path state of a sending socket.
+//
+typedef struct CXPLAT_MEMORY_LINK {
+
+    CXPLAT_LOCK Lock;
+
+    //
+    // The state of the random number generator (xorshift64*).
+    //
+    uint64_t RandomState;
+
+    //
+    // The theoretical arrival time, in nanoseconds, of the next datagram at
+    // the token bucket (GCRA). The bottleneck queue is backlogged while it is
+    // ahead of the current time by more than the bucket size.
+    //
+    uint64_t TatNs;
+
+    //
+    // The delivery time of the last datagram that wasn't reordered, which
+    // later ones can't overtake.
+    //
+    uint64_t LastDeliveryTimeUs;
+
+    //
+    // The number of datagrams left to drop in the current loss burst.
+    //
+    uint32_t BurstLossRemaining;
+
+} CXPLAT_MEMORY_LINK;
+
+typedef struct CXPLAT_DATAPATH_MEMORY {
+
+    //
+    // The parent datapath, holding the UDP callbacks.
+    //
+    CXPLAT_DATAPATH* ParentDataPath;
+
+    CXPLAT_WORKER_POOL* WorkerPool;
+
+    //
+    // Held by every socket until it is freed, and by each delay queue until
+    // its execution context is removed.
+    //
+    CXPLAT_RUNDOWN_REF SocketRundown;
+
+    //
+    // Pool of send data, which also carry the receive data for the peer.
+    //
+    CXPLAT_POOL SendDataPool;
+
+    //
+    // The size of a receive packet, including the client's receive context.
+    //
+    uint32_t RecvPacketStride;
+
+    uint16_t PartitionCount;
+
+    //
+    // The next local port to try to assign from the ephemeral range.
+    //
+    uint16_t NextEphemeralPort;
+
+    //
+    // Protects Sockets and NextEphemeralPort.
+    //
+    CXPLAT_LOCK Lock;
+
+    //
+    // Table of bound sockets, keyed by local port.
+    //
+    CXPLAT_HASHTABLE Sockets;
+
+    //
+    // The network path emulated for every datagram, if DelayQueues is set.
+    //
+    QUIC_PRIVATE_DATAPATH_EMULATION Emulation;
+
+    //
+    // The bottleneck queue depth, in time at the link rate. Zero is unlimited.
+    //
+    uint64_t QueueNs;
+
+    //
+    // Delay queues, one per partition, when emulating a network path.
+    //
+    CXPLAT_MEMORY_DELAY_QUEUE* DelayQueues;
+
+    //
+    // Tells the delay queues to drop everything and remove themselves.
+    //
+    BOOLEAN ShuttingDown;
+
+} CXPLAT_DATAPATH_MEMORY;
+
+//
+// Per-partition queue of received data waiting for a socket upcall.
+//
+typedef struct CXPLAT_MEMORY_RECV_QUEUE {
+
+    CXPLAT_SOCKET_MEMORY* Socket;
+
+    CXPLAT_EVENTQ* EventQ;
+
+    //
+    // Queued to EventQ to indicate the received data.
+    //
+    CXPLAT_SQE Sqe;
+
+    //
+    // Protects the chain and SqeQueued.
+    //
+    CXPLAT_LOCK Lock;
+
+    CXPLAT_RECV_DATA* Head;
+    CXPLAT_RECV_DATA** Tail;
+
+    uint16_t PartitionIndex;
+
+    BOOLEAN SqeInitialized : 1;
+    BOOLEAN SqeQueued : 1;
+
+} CXPLAT_MEMORY_RECV_QUEUE;
+
+//
+// Follows the common CXPLAT_SOCKET in the same allocation.
+//
+typedef struct CXPLAT_SOCKET_MEMORY {
+
+    //
+    // Entry in the datapath's socket table.
+    //
+    CXPLAT_HASHTABLE_ENTRY Entry;
+
+    CXPLAT_DATAPATH_MEMORY* MemoryDataPath;
+
+    //
+    // Held by the creator and each queued receive queue SQE.
+    //
+    CXPLAT_REF_COUNT RefCount;
+
+    //
+    // Prevents receive upcalls once the socket is deleted.
+    //
+    CXPLAT_RUNDOWN_REF UpcallRundown;
+
+    //
+    // The emulated network path of datagrams sent on the socket.
+    //
+    CXPLAT_MEMORY_LINK Link;
+
+    uint16_t QueueCount;
+
+    //
+    // Receive queues, one per partition for unconnected and unpartitioned
+    // sockets or just one otherwise.
+    //
+    CXPLAT_MEMORY_RECV_QUEUE Queues[0];
+
+} CXPLAT_SOCKET_MEMORY;
+
+typedef struct CXPLAT_SEND_DATA_MEMORY {
+    CXPLAT_SEND_DATA_COMMON;
+
+    CXPLAT_DATAPATH_MEMORY* MemoryDataPath;
+
+    //
+    // The current buffer handed out to the client.
+    //
+    QUIC_BUFFER ClientBuffer;
+
+    //
+    // The number of finalized segments.
+    //
+    uint16_t BufferCount;
+
+    //
+    // The receive data still held by the peer.
+    //
+    long RecvRefCount;
+
+    //
+    // The route of the datagrams as seen by the peer.
+    //
+    CXPLAT_ROUTE RecvRoute;
+
+    //
+    // Payload of all the segments.
+    //
+    uint8_t Buffer[CXPLAT_MEMORY_SEND_BUFFER_SIZE];
+
+    //
+    // Receive packets, one for each segment, follow.
+    //
+    // CXPLAT_MEMORY_RECV_PACKET Packets[CXPLAT_MEMORY_MAX_SEGMENTS];
+
+} CXPLAT_SEND_DATA_MEMORY;
+
+typedef struct CXPLAT_MEMORY_RECV_PACKET {
+
+    //
+    // The send data whose buffer holds the payload.
+    //
+    CXPLAT_SEND_DATA_MEMORY* SendData;
+
+    //
+    // Entry in the delay queue, when emulating a network path.
+    //
+    CXPLAT_LIST_ENTRY Link;
+
+    uint64_t DeliveryTimeUs;
+
+    //
+    // Publicly visible receive data. The client's receive context follows.
+    //
+    CXPLAT_RECV_DATA Data;
+
+} CXPLAT_MEMORY_RECV_PACKET;
+
+QUIC_INLINE
+CXPLAT_SOCKET_MEMORY*
+CxPlatSocketToMemory(
+    _In_ CXPLAT_SOCKET* Socket
+    )
+{
+    return (CXPLAT_SOCKET_MEMORY*)(Socket + 1);
+}
+
+QUIC_INLINE
+CXPLAT_SOCKET*
+CxPlatMemoryToSocket(
+    _In_ CXPLAT_SOCKET_MEMORY* Socket
+    )
+{
+    return (CXPLAT_SOCKET*)Socket - 1;
+}
+
+QUIC_INLINE
+CXPLAT_MEMORY_RECV_PACKET*
+CxPlatSendDataGetRecvPacket(
+    _In_ CXPLAT_SEND_DATA_MEMORY* SendData,
+    _In_ uint16_t Index
+    )
+{
+    return
+        (CXPLAT_MEMORY_RECV_PACKET*)
+            ((uint8_t*)(SendData + 1) +
+             (size_t)Index * SendData->MemoryDataPath->RecvPacketStride);
+}
+
+static
+_IRQL_requires_max_(PASSIVE_LEVEL)
+BOOLEAN
+CxPlatMemoryDelayQueueRun(
+    _Inout_ void* Context,
+    _Inout_ CXPLAT_EXECUTION_STATE* State
+    );
+
+_IRQL_requires_max_(PASSIVE_LEVEL)
+QUIC_STATUS
+MemoryDataPathInitialize(
+    _In_ uint32_t ClientRecvContextLength,
+    _In_ CXPLAT_DATAPATH* ParentDataPath,
+    _In_ CXPLAT_WORKER_POOL* WorkerPool,
+    _In_opt_ const QUIC_PRIVATE_DATAPATH_EMULATION* Emulation,
+    _Out_ CXPLAT_DATAPATH_MEMORY** NewDataPath
+    )
+{
+    CXPLAT_DATAPATH_MEMORY* DataPath =
+        CXPLAT_ALLOC_NONPAGED(sizeof(CXPLAT_DATAPATH_MEMORY), QUIC_POOL_DATAPATH);
+    if (DataPath == NULL) {
+        QuicTraceEvent(
+            AllocFailure,
+            "Allocation of '%s' failed. (%llu bytes)",
+            "CXPLAT_DATAPATH_MEMORY",
+            sizeof(CXPLAT_DATAPATH_MEMORY));
+        return QUIC_STATUS_OUT_OF_MEMORY;
+    }
+
+    CxPlatZeroMemory(DataPath, sizeof(*DataPath));
+    if (!CxPlatHashtableInitializeEx(&DataPath->Sockets, CXPLAT_HASH_MIN_SIZE)) {
+        CXPLAT_FREE(DataPath, QUIC_POOL_DATAPATH);
+        return QUIC_STATUS_OUT_OF_MEMORY;
+    }
+
+    DataPath->ParentDataPath = ParentDataPath;
+    DataPath->WorkerPool = WorkerPool;
+    DataPath->PartitionCount = (uint16_t)CxPlatWorkerPoolGetCount(WorkerPool);
+    DataPath->NextEphemeralPort = CXPLAT_MEMORY_EPHEMERAL_PORT_START;
+    DataPath->RecvPacketStride =
+        (uint32_t)(sizeof(CXPLAT_MEMORY_RECV_PACKET) + ClientRecvContextLength + 15) & ~15u;
+    CxPlatLockInitialize(&DataPath->Lock);
+    CxPlatRundownInitialize(&DataPath->SocketRundown);
+    CxPlatPoolInitialize(
+        TRUE,
+        sizeof(CXPLAT_SEND_DATA_MEMORY) +
+            CXPLAT_MEMORY_MAX_SEGMENTS * DataPath->RecvPacketStride,
+        QUIC_POOL_PLATFORM_SENDCTX,
+        &DataPath->SendDataPool);
+
+    if (Emulation != NULL) {
+        const size_t DelayQueuesLength =
+            DataPath->PartitionCount * sizeof(CXPLAT_MEMORY_DELAY_QUEUE);
+        DataPath->DelayQueues =
+            CXPLAT_ALLOC_NONPAGED(DelayQueuesLength, QUIC_POOL_DATAPATH);
+        if (DataPath->DelayQueues == NULL) {
+            QuicTraceEvent(
+                AllocFailure,
+                "Allocation of '%s' failed. (%llu bytes)",
+                "CXPLAT_MEMORY_DELAY_QUEUE",
+                DelayQueuesLength);
+            MemoryDataPathUninitialize(DataPath);
+            return QUIC_STATUS_OUT_OF_MEMORY;
+        }
+
+        DataPath->Emulation = *Emulation;
+        if (Emulation->BandwidthKbps != 0) {
+            DataPath->QueueNs =
+                (uint64_t)Emulation->QueueBytes * 8000000 / Emulation->BandwidthKbps;
+        }
+
+        CxPlatZeroMemory(DataPath->DelayQueues, DelayQueuesLength);
+        for (uint16_t i = 0; i < DataPath->PartitionCount; ++i) {
+            CXPLAT_MEMORY_DELAY_QUEUE* DelayQueue = &DataPath->DelayQueues[i];
+            DelayQueue->MemoryDataPath = DataPath;
+            CxPlatLockInitialize(&DelayQueue->Lock);
+            CxPlatListInitializeHead(&DelayQueue->Packets);
+            DelayQueue->ExecutionContext.Context = DelayQueue;
+            DelayQueue->ExecutionContext.Callback = CxPlatMemoryDelayQueueRun;
+            DelayQueue->ExecutionContext.NextTimeUs = UINT64_MAX;
+            CXPLAT_FRE_ASSERT(CxPlatRundownAcquire(&DataPath->SocketRundown));
+            CxPlatWorkerPoolAddExecutionContext(
+                WorkerPool, &DelayQueue->ExecutionContext, i);
+        }
+    }
+
+    *NewDataPath = DataPath;
+    return QUIC_STATUS_SUCCESS;
+}
+
+_IRQL_requires_max_(PASSIVE_LEVEL)
+void
+MemoryDataPathUninitialize(
+    _In_ CXPLAT_DATAPATH_MEMORY* DataPath
+    )
+{
+    if (DataPath->DelayQueues != NULL) {
+        //
+        // Have the delay queues drop any datagrams still in flight, releasing
+        // the sockets they are sent to, and remove themselves.
+        //
+        DataPath->ShuttingDown = TRUE;
+        for (uint16_t i = 0; i < DataPath->PartitionCount; ++i) {
+            DataPath->DelayQueues[i].ExecutionContext.Ready = TRUE;
+            CxPlatWakeExecutionContext(&DataPath->DelayQueues[i].ExecutionContext);
+        }
+    }
+
+    //
+    // Sockets are freed once their queued upcalls complete on the workers, so
+    // wait for all of them before tearing down the shared state.
+    //
+    CxPlatRundownReleaseAndWait(&DataPath->SocketRundown);
+    CxPlatRundownUninitialize(&DataPath->SocketRundown);
+    if (DataPath->DelayQueues != NULL) {
+        for (uint16_t i = 0; i < DataPath->PartitionCount; ++i) {
+            CXPLAT_DBG_ASSERT(CxPlatListIsEmpty(&DataPath->DelayQueues[i].Packets));
+            CxPlatLockUninitialize(&DataPath->DelayQueues[i].Lock);
+        }
+        CXPLAT_FREE(DataPath->DelayQueues, QUIC_POOL_DATAPATH);
+    }
+    CxPlatPoolUninitialize(&DataPath->SendDataPool);
+    CxPlatHashtableUninitialize(&DataPath->Sockets);
+    CxPlatLockUninitialize(&DataPath->Lock);
+    CXPLAT_FREE(DataPath, QUIC_POOL_DATAPATH);
+}
+
+_IRQL_requires_max_(DISPATCH_LEVEL)
+CXPLAT_DATAPATH_FEATURES
+MemoryDataPathGetSupportedFeatures(
+    _In_ CXPLAT_DATAPATH_MEMORY* DataPath
+    )
+{
+    UNREFERENCED_PARAMETER(DataPath);
+    return
+        CXPLAT_DATAPATH_FEATURE_SEND_SEGMENTATION |
+        CXPLAT_DATAPATH_FEATURE_RECV_COALESCING;
+}
+
+//
+// Looks up the socket bound to the port and takes a reference on it. Must be
+// called with the datapath lock held.
+//
+static
+CXPLAT_SOCKET_MEMORY*
+CxPlatMemoryLookupSocket(
+    _In_ CXPLAT_DATAPATH_MEMORY* DataPath,
+    _In_ uint16_t Port
+    )
+{
+    CXPLAT_HASHTABLE_ENTRY* Entry =
+        CxPlatHashtableLookup(&DataPath->Sockets, Port, NULL);
+    if (Entry == NULL) {
+        return NULL;
+    }
+    CXPLAT_SOCKET_MEMORY* Socket =
+        CXPLAT_CONTAINING_RECORD(Entry, CXPLAT_SOCKET_MEMORY, Entry);
+    CxPlatRefIncrement(&Socket->RefCount);
+    return Socket;
+}
+
+static
+void
+CxPlatMemorySocketRelease(
+    _In_ CXPLAT_SOCKET_MEMORY* Socket
+    )
+{
+    if (CxPlatRefDecrement(&Socket->RefCount)) {
+        CXPLAT_DATAPATH_MEMORY* DataPath = Socket->MemoryDataPath;
+        for (uint16_t i = 0; i < Socket->QueueCount; ++i) {
+            CXPLAT_MEMORY_RECV_QUEUE* Queue = &Socket->Queues[i];
+            CXPLAT_DBG_ASSERT(!Queue->SqeQueued);
+            if (Queue->Head != NULL) {
+                MemoryRecvDataReturn(Queue->Head);
+            }
+            if (Queue->SqeInitialized) {
+                CxPlatSqeCleanup(Queue->EventQ, &Queue->Sqe);
+            }
+            CxPlatLockUninitialize(&Queue->Lock);
+        }
+        CxPlatLockUninitialize(&Socket->Link.Lock);
+        CxPlatRundownUninitialize(&Socket->UpcallRundown);
+        CXPLAT_FREE(CxPlatMemoryToSocket(Socket), QUIC_POOL_SOCKET);
+        CxPlatRundownRelease(&DataPath->SocketRundown);
+    }
+}
+
+//
+// Appends the chain to the receive queue and queues its SQE if it isn't
+// already. Takes over the caller's reference on the queue's socket.
+//
+static
+void
+CxPlatMemoryRecvQueueAppend(
+    _In_ CXPLAT_MEMORY_RECV_QUEUE* Queue,
+    _In_ CXPLAT_RECV_DATA* Head,
+    _In_ CXPLAT_RECV_DATA** Tail
+    )
+{
+    CxPlatLockAcquire(&Queue->Lock);
+    *Queue->Tail = Head;
+    Queue->Tail = Tail;
+    const BOOLEAN QueueSqe = !Queue->SqeQueued;
+    Queue->SqeQueued = TRUE;
+    CxPlatLockRelease(&Queue->Lock);
+
+    if (QueueSqe) {
+        //
+        // The queued SQE holds the reference until it completes.
+        //
+        CxPlatEventQEnqueue(Queue->EventQ, &Queue->Sqe);
+    } else {
+        CxPlatMemorySocketRelease(Queue->Socket);
+    }
+}
+
+static
+_IRQL_requires_max_(PASSIVE_LEVEL)
+BOOLEAN
+CxPlatMemoryDelayQueueRun(
+    _Inout_ void* Context,
+    _Inout_ CXPLAT_EXECUTION_STATE* State
+    )
+{
+    CXPLAT_MEMORY_DELAY_QUEUE* DelayQueue = (CXPLAT_MEMORY_DELAY_QUEUE*)Context;
+    CXPLAT_DATAPATH_MEMORY* DataPath = DelayQueue->MemoryDataPath;
+    const BOOLEAN ShuttingDown = DataPath->ShuttingDown;
+
+    CXPLAT_LIST_ENTRY Due;
+    CxPlatListInitializeHead(&Due);
+
+    CxPlatLockAcquire(&DelayQueue->Lock);
+    while (!CxPlatListIsEmpty(&DelayQueue->Packets)) {
+        CXPLAT_MEMORY_RECV_PACKET* Packet =
+            CXPLAT_CONTAINING_RECORD(
+                DelayQueue->Packets.Flink, CXPLAT_MEMORY_RECV_PACKET, Link);
+        if (!ShuttingDown && Packet->DeliveryTimeUs > State->TimeNow) {
+            break;
+        }
+        CxPlatListEntryRemove(&Packet->Link);
+        CxPlatListInsertTail(&Due, &Packet->Link);
+    }
+    DelayQueue->ExecutionContext.NextTimeUs =
+        CxPlatListIsEmpty(&DelayQueue->Packets) ?
+            UINT64_MAX :
+            CXPLAT_CONTAINING_RECORD(
+                DelayQueue->Packets.Flink, CXPLAT_MEMORY_RECV_PACKET, Link)->DeliveryTimeUs;
+    CxPlatLockRelease(&DelayQueue->Lock);
+
+    //
+    // Hand consecutive datagrams for the same receive queue over as one chain.
+    //
+    while (!CxPlatListIsEmpty(&Due)) {
+        CXPLAT_MEMORY_RECV_PACKET* Packet =
+            CXPLAT_CONTAINING_RECORD(
+                CxPlatListRemoveHead(&Due), CXPLAT_MEMORY_RECV_PACKET, Link);
+        CXPLAT_MEMORY_RECV_QUEUE* Queue =
+            (CXPLAT_MEMORY_RECV_QUEUE*)Packet->Data.Route->Queue;
+        CXPLAT_RECV_DATA* Head = &Packet->Data;
+        CXPLAT_RECV_DATA** Tail = &Packet->Data.Next;
+
+        while (!CxPlatListIsEmpty(&Due)) {
+            Packet = CXPLAT_CONTAINING_RECORD(Due.Flink, CXPLAT_MEMORY_RECV_PACKET, Link);
+            if ((CXPLAT_MEMORY_RECV_QUEUE*)Packet->Data.Route->Queue != Queue) {
+                break;
+            }
+            CxPlatListEntryRemove(&Packet->Link);
+            *Tail = &Packet->Data;
+            Tail = &Packet->Data.Next;
+
+            //
+            // The chain only needs the one reference.
+            //
+            CxPlatMemorySocketRelease(Queue->Socket);
+        }
+
+        if (ShuttingDown) {
+            MemoryRecvDataReturn(Head);
+            CxPlatMemorySocketRelease(Queue->Socket);
+        } else {
+            CxPlatMemoryRecvQueueAppend(Queue, Head, Tail);
+        }
+    }
+
+    if (ShuttingDown) {
+        CxPlatRundownRelease(&DataPath->SocketRundown);
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+//
+// Returns a uniformly distributed random value (xorshift64*).
+//
+static
+uint32_t
+CxPlatMemoryLinkRandom(
+    _Inout_ CXPLAT_MEMORY_LINK* Link
+    )
+{
+    uint64_t X = Link->RandomState;
+    X ^= X >> 12;
+    X ^= X << 25;
+    X ^= X >> 27;
+    Link->RandomState = X;
+    return (uint32_t)((X * 0x2545F4914F6CDD1DULL) >> 32);
+}
+
+static
+BOOLEAN
+CxPlatMemoryLinkChance(
+    _Inout_ CXPLAT_MEMORY_LINK* Link,
+    _In_ uint32_t Ppm
+    )
+{
+    return Ppm != 0 && CxPlatMemoryLinkRandom(Link) % CXPLAT_MEMORY_PPM < Ppm;
+}
+
+//
+// Puts the chain sent on the socket through its emulated network path. The
+// datagrams that make it through are queued on the delay queue of the receive
+// queue's partition until their delivery time. Takes over the caller's
+// reference on the receive queue's socket.
+//
+static
+void
+CxPlatMemoryLinkSend(
+    _In_ CXPLAT_DATAPATH_MEMORY* DataPath,
+    _In_ CXPLAT_SOCKET_MEMORY* Socket,
+    _In_ CXPLAT_MEMORY_RECV_QUEUE* Queue,
+    _In_ CXPLAT_RECV_DATA* Chain
+    )
+{
+    const QUIC_PRIVATE_DATAPATH_EMULATION* Emulation = &DataPath->Emulation;
+    CXPLAT_MEMORY_LINK* Link = &Socket->Link;
+    CXPLAT_MEMORY_DELAY_QUEUE* DelayQueue = &DataPath->DelayQueues[Queue->PartitionIndex];
+    const uint64_t TimeNow = CxPlatTimeUs64();
+    CXPLAT_RECV_DATA* Dropped = NULL;
+    CXPLAT_LIST_ENTRY Delayed;
+    uint32_t DelayedCount = 0;
+    CxPlatListInitializeHead(&Delayed);
+
+    CXPLAT_DBG_ASSERT(!DataPath->ShuttingDown);
+
+    CxPlatLockAcquire(&Link->Lock);
+    while (Chain != NULL) {
+        CXPLAT_RECV_DATA* Datagram = Chain;
+        Chain = Chain->Next;
+        Datagram->Next = NULL;
+        Datagram->CoalescedCount = 1; // Delivered on its own.
+
+        uint64_t DepartureTimeUs = TimeNow;
+        BOOLEAN Drop = FALSE;
+        if (Emulation->BandwidthKbps != 0) {
+            //
+            // Shape to the link rate with a token bucket (GCRA) and tail drop
+            // once the queue behind it is full.
+            //
+            const uint64_t TimeNowNs = TimeNow * 1000;
+            const uint64_t TransmitNs =
+                (uint64_t)Datagram->BufferLength * 8000000 / Emulation->BandwidthKbps;
+            const uint64_t BucketNs =
+                Emulation->BucketBytes == 0 ?
+                    TransmitNs :
+                    (uint64_t)Emulation->BucketBytes * 8000000 / Emulation->BandwidthKbps;
+            if (Link->TatNs < TimeNowNs) {
+                Link->TatNs = TimeNowNs;
+            }
+            const uint64_t DepartureTimeNs =
+                Link->TatNs > TimeNowNs + BucketNs ? Link->TatNs - BucketNs : TimeNowNs;
+            if (DataPath->QueueNs != 0 && DepartureTimeNs - TimeNowNs > DataPath->QueueNs) {
+                Drop = TRUE;
+            } else {
+                Link->TatNs += TransmitNs;
+                DepartureTimeUs = DepartureTimeNs / 1000;
+            }
+        }
+
+        if (Drop) {
+            //
+            // Tail dropped by the bottleneck queue.
+            //
+        } else if (Link->BurstLossRemaining != 0) {
+            Link->BurstLossRemaining--;
+            Drop = TRUE;
+        } else if (CxPlatMemoryLinkChance(Link, Emulation->BurstLossPpm)) {
+            Link->BurstLossRemaining =
+                Emulation->BurstLossLength > 1 ? Emulation->BurstLossLength - 1 : 0;
+            Drop = TRUE;
+        } else {
+            Drop = CxPlatMemoryLinkChance(Link, Emulation->LossPpm);
+        }
+
+        if (Drop) {
+            Datagram->Next = Dropped;
+            Dropped = Datagram;
+            continue;
+        }
+
+        uint64_t DeliveryTimeUs = DepartureTimeUs + Emulation->DelayUs;
+        if (Emulation->JitterUs != 0) {
+            DeliveryTimeUs += CxPlatMemoryLinkRandom(Link) % (Emulation->JitterUs + 1);
+        }
+        if (CxPlatMemoryLinkChance(Link, Emulation->ReorderPpm)) {
+            DeliveryTimeUs += Emulation->ReorderDelayUs;
+        } else {
+            //
+            // Jitter alone doesn't reorder.
+            //
+            if (DeliveryTimeUs < Link->LastDeliveryTimeUs) {
+                DeliveryTimeUs = Link->LastDeliveryTimeUs;
+            }
+            Link->LastDeliveryTimeUs = DeliveryTimeUs;
+        }
+
+        CXPLAT_MEMORY_RECV_PACKET* Packet =
+            CXPLAT_CONTAINING_RECORD(Datagram, CXPLAT_MEMORY_RECV_PACKET, Data);
+        Packet->DeliveryTimeUs = DeliveryTimeUs;
+        CxPlatListInsertTail(&Delayed, &Packet->Link);
+        DelayedCount++;
+    }
+    CxPlatLockRelease(&Link->Lock);
+
+    if (Dropped != NULL) {
+        MemoryRecvDataReturn(Dropped);
+    }
+
+    if (DelayedCount == 0) {
+        CxPlatMemorySocketRelease(Queue->Socket);
+        return;
+    }
+
+    //
+    // Each delayed datagram holds its own reference on the socket.
+    //
+    for (uint32_t i = 1; i < DelayedCount; ++i) {
+        CxPlatRefIncrement(&Queue->Socket->RefCount);
+    }
+
+    CxPlatLockAcquire(&DelayQueue->Lock);
+    while (!CxPlatListIsEmpty(&Delayed)) {
+        CXPLAT_MEMORY_RECV_PACKET* Packet =
+            CXPLAT_CONTAINING_RECORD(
+                CxPlatListRemoveHead(&Delayed), CXPLAT_MEMORY_RECV_PACKET, Link);
+
+        //
+        // Datagrams are mostly queued in delivery time order, so search for
+        // the insertion point from the tail.
+        //
+        CXPLAT_LIST_ENTRY* Prev = DelayQueue->Packets.Blink;
+        while (Prev != &DelayQueue->Packets &&
+               CXPLAT_CONTAINING_RECORD(Prev, CXPLAT_MEMORY_RECV_PACKET, Link)->DeliveryTimeUs >
+                    Packet->DeliveryTimeUs) {
+            Prev = Prev->Blink;
+        }
+        CxPlatListInsertHead(Prev, &Packet->Link);
+    }
+    const uint64_t NextTimeUs =
+        CXPLAT_CONTAINING_RECORD(
+            DelayQueue->Packets.Flink, CXPLAT_MEMORY_RECV_PACKET, Link)->DeliveryTimeUs;
+    const BOOLEAN Wake = NextTimeUs < DelayQueue->ExecutionContext.NextTimeUs;
+    if (Wake) {
+        DelayQueue->ExecutionContext.NextTimeUs = NextTimeUs;
+    }
+    CxPlatLockRelease(&DelayQueue->Lock);
+
+    if (Wake) {
+        //
+        // Have the worker pick up the earlier delivery time.
+        //
+        CxPlatWakeExecutionContext(&DelayQueue->ExecutionContext);
+    }
+}
+
+//
+// Runs on the partition's worker to indicate everything queued so far.
+//
+static
+void
+CxPlatMemoryRecvQueueComplete(
+    _In_ CXPLAT_CQE* Cqe
+    )
+{
+    CXPLAT_MEMORY_RECV_QUEUE* Queue =
+        CXPLAT_CONTAINING_RECORD(CxPlatCqeGetSqe(Cqe), CXPLAT_MEMORY_RECV_QUEUE, Sqe);
+    CXPLAT_SOCKET_MEMORY* Socket = Queue->Socket;
+
+    CxPlatLockAcquire(&Queue->Lock);
+    CXPLAT_RECV_DATA* Chain = Queue->Head;
+    Queue->Head = NULL;
+    Queue->Tail = &Queue->Head;
+    Queue->SqeQueued = FALSE;
+    CxPlatLockRelease(&Queue->Lock);
+
+    if (Chain != NULL) {
+        if (CxPlatRundownAcquire(&Socket->UpcallRundown)) {
+            CXPLAT_SOCKET* Binding = CxPlatMemoryToSocket(Socket);
+            CXPLAT_DBG_ASSERT(Binding->Datapath->UdpHandlers.Receive);
+            Binding->Datapath->UdpHandlers.Receive(
+                Binding,
+                Binding->ClientContext,
+                Chain);
+            CxPlatRundownRelease(&Socket->UpcallRundown);
+        } else {
+            MemoryRecvDataReturn(Chain);
+        }
+    }
+
+    CxPlatMemorySocketRelease(Socket);
+}
+
+_IRQL_requires_max_(PASSIVE_LEVEL)
+QUIC_STATUS
+MemorySocketCreateUdp(
+    _In_ CXPLAT_DATAPATH* Datapath,
+    _In_ const CXPLAT_UDP_CONFIG* Config,
+    _Out_ CXPLAT_SOCKET** NewSocket
+    )
+{
+    CXPLAT_DATAPATH_MEMORY* DataPath = Datapath->MemoryDataPath;
+    QUIC_STATUS Status = QUIC_STATUS_SUCCESS;
+    const BOOLEAN IsPartitioned = !!(Config->Flags & CXPLAT_SOCKET_FLAG_PARTITIONED);
+    const uint16_t QueueCount =
+        (IsPartitioned || Config->RemoteAddress != NULL) ? 1 : DataPath->PartitionCount;
+
+    CXPLAT_DBG_ASSERT(Datapath->UdpHandlers.Receive != NULL || Config->Flags & CXPLAT_SOCKET_FLAG_PCP);
+    CXPLAT_DBG_ASSERT(!IsPartitioned || Config->PartitionIndex < DataPath->PartitionCount);
+
+    const size_t SocketLength =
+        sizeof(CXPLAT_SOCKET) + sizeof(CXPLAT_SOCKET_MEMORY) +
+        QueueCount * sizeof(CXPLAT_MEMORY_RECV_QUEUE);
+    CXPLAT_SOCKET* Binding = CXPLAT_ALLOC_PAGED(SocketLength, QUIC_POOL_SOCKET);
+    if (Binding == NULL) {
+        QuicTraceEvent(
+            AllocFailure,
+            "Allocation of '%s' failed. (%llu bytes)",
+            "CXPLAT_SOCKET",
+            SocketLength);
+        return QUIC_STATUS_OUT_OF_MEMORY;
+    }
+
+    QuicTraceEvent(
+        DatapathCreated,
+        "[data][%p] Created, local=%!ADDR!, remote=%!ADDR!",
+        Binding,
+        CASTED_CLOG_BYTEARRAY(Config->LocalAddress ? sizeof(*Config->LocalAddress) : 0, Config->LocalAddress),
+        CASTED_CLOG_BYTEARRAY(Config->RemoteAddress ? sizeof(*Config->RemoteAddress) : 0, Config->RemoteAddress));
+
+    CxPlatZeroMemory(Binding, SocketLength);
+    Binding->Datapath = Datapath;
+    Binding->ClientContext = Config->CallbackContext;
+    Binding->HasFixedRemoteAddress = (Config->RemoteAddress != NULL);
+    Binding->Mtu = CXPLAT_MAX_MTU;
+    Binding->IsMemorySocket = TRUE;
+    if (Config->LocalAddress) {
+        Binding->LocalAddress = *Config->LocalAddress;
+    }
+    if (Config->RemoteAddress) {
+        Binding->RemoteAddress = *Config->RemoteAddress;
+        if (QuicAddrIsWildCard(&Binding->LocalAddress)) {
+            //
+            // Connected sockets need a concrete source address for the peer.
+            //
+            QuicAddrSetFamily(&Binding->LocalAddress, QuicAddrGetFamily(Config->RemoteAddress));
+            QuicAddrSetToLoopback(&Binding->LocalAddress);
+        }
+    } else if (QuicAddrGetFamily(&Binding->LocalAddress) == QUIC_ADDRESS_FAMILY_UNSPEC) {
+        QuicAddrSetFamily(&Binding->LocalAddress, QUIC_ADDRESS_FAMILY_INET6);
+    }
+
+    CXPLAT_SOCKET_MEMORY* Socket = CxPlatSocketToMemory(Binding);
+    Socket->MemoryDataPath = DataPath;
+    Socket->QueueCount = QueueCount;
+    CxPlatRefInitialize(&Socket->RefCount);
+    CxPlatRundownInitialize(&Socket->UpcallRundown);
+    CxPlatLockInitialize(&Socket->Link.Lock);
+
+    //
+    // Hold the datapath until the socket is freed. Released on cleanup below
+    // if anything fails.
+    //
+    CXPLAT_FRE_ASSERT(CxPlatRundownAcquire(&DataPath->SocketRundown));
+
+    for (uint16_t i = 0; i < QueueCount; ++i) {
+        CXPLAT_MEMORY_RECV_QUEUE* Queue = &Socket->Queues[i];
+        Queue->Socket = Socket;
+        Queue->Tail = &Queue->Head;
+        Queue->PartitionIndex = IsPartitioned ? Config->PartitionIndex : i;
+        Queue->EventQ = CxPlatWorkerPoolGetEventQ(DataPath->WorkerPool, Queue->PartitionIndex);
+        CxPlatLockInitialize(&Queue->Lock);
+    }
+
+    for (uint16_t i = 0; i < QueueCount; ++i) {
+        CXPLAT_MEMORY_RECV_QUEUE* Queue = &Socket->Queues[i];
+        if (!CxPlatSqeInitialize(Queue->EventQ, CxPlatMemoryRecvQueueComplete, &Queue->Sqe)) {
+            Status = QUIC_STATUS_INTERNAL_ERROR;
+            goto Exit;
+        }
+        Queue->SqeInitialized = TRUE;
+    }
+
+    CxPlatLockAcquire(&DataPath->Lock);
+    uint16_t Port = QuicAddrGetPort(&Binding->LocalAddress);
+    if (Port == 0) {
+        //
+        // Find the next free port in the ephemeral range.
+        //
+        const uint32_t RangeSize = 0x10000 - CXPLAT_MEMORY_EPHEMERAL_PORT_START;
+        for (uint32_t i = 0; i < RangeSize; ++i) {
+            uint16_t Candidate = DataPath->NextEphemeralPort;
+            DataPath->NextEphemeralPort =
+                Candidate == UINT16_MAX ?
+                    CXPLAT_MEMORY_EPHEMERAL_PORT_START : Candidate + 1;
+            if (CxPlatHashtableLookup(&DataPath->Sockets, Candidate, NULL) == NULL) {
+                Port = Candidate;
+                break;
+            }
+        }
+    } else if (CxPlatHashtableLookup(&DataPath->Sockets, Port, NULL) != NULL) {
+        Port = 0;
+    }
+    if (Port != 0) {
+        //
+        // Seed the emulated path from the port, so each direction of a flow
+        // sees its own, reproducible, sequence of impairments.
+        //
+        Socket->Link.RandomState =
+            ((((uint64_t)DataPath->Emulation.Seed << 16) | Port) * 0x9E3779B97F4A7C15ULL) | 1;
+        QuicAddrSetPort(&Binding->LocalAddress, Port);
+        (void)CxPlatHashtableInsert(&DataPath->Sockets, &Socket->Entry, Port, NULL);
+    }
+    CxPlatLockRelease(&DataPath->Lock);
+
+    if (Port == 0) {
+        Status = QUIC_STATUS_ADDRESS_IN_USE;
+        goto Exit;
+    }
+
+    *NewSocket = Binding;
+    Binding = NULL;
+
+Exit:
+
+    if (Binding != NULL) {
+        CxPlatRundownReleaseAndWait(&Socket->UpcallRundown);
+        CxPlatMemorySocketRelease(Socket);
+    }
+
+    return Status;
+}
+
+_IRQL_requires_max_(PASSIVE_LEVEL)
+void
+MemorySocketDelete(
+    _In_ CXPLAT_SOCKET* Binding
+    )
+{
+    CXPLAT_SOCKET_MEMORY* Socket = CxPlatSocketToMemory(Binding);
+    CXPLAT_DATAPATH_MEMORY* DataPath = Socket->MemoryDataPath;
+
+    QuicTraceEvent(
+        DatapathDestroyed,
+        "[data][%p] Destroyed",
+        Binding);
+
+    CxPlatLockAcquire(&DataPath->Lock);
+    CxPlatHashtableRemove(&DataPath->Sockets, &Socket->Entry, NULL);
+    CxPlatLockRelease(&DataPath->Lock);
+
+    //
+    // Blocks until all receive upcalls have completed. Anything still queued
+    // is returned when the queue's SQE completes.
+    //
+    CxPlatRundownReleaseAndWait(&Socket->UpcallRundown);
+    CxPlatMemorySocketRelease(Socket);
+}
+
+_IRQL_requires_max_(DISPATCH_LEVEL)
+void
+MemoryRecvDataReturn(
+    _In_ CXPLAT_RECV_DATA* RecvDataChain
+    )
+{
+    CXPLAT_RECV_DATA* Datagram;
+    while ((Datagram = RecvDataChain) != NULL) {
+        RecvDataChain = RecvDataChain->Next;
+        CXPLAT_MEMORY_RECV_PACKET* Packet =
+            CXPLAT_CONTAINING_RECORD(Datagram, CXPLAT_MEMORY_RECV_PACKET, Data);
+        if (InterlockedDecrement(&Packet->SendData->RecvRefCount) == 0) {
+            CxPlatPoolFree(Packet->SendData);
+        }
+    }
+}
+
+_IRQL_requires_max_(DISPATCH_LEVEL)
+_Success_(return != NULL)
+CXPLAT_SEND_DATA*
+MemorySendDataAlloc(
+    _In_ CXPLAT_SOCKET* Socket,
+    _Inout_ CXPLAT_SEND_CONFIG* Config
+    )
+{
+    CXPLAT_DATAPATH_MEMORY* DataPath = CxPlatSocketToMemory(Socket)->MemoryDataPath;
+    CXPLAT_SEND_DATA_MEMORY* SendData = CxPlatPoolAlloc(&DataPath->SendDataPool);
+    if (SendData != NULL) {
+        SendData->MemoryDataPath = DataPath;
+        SendData->ClientBuffer.Buffer = SendData->Buffer;
+        SendData->ClientBuffer.Length = 0;
+        SendData->TotalSize = 0;
+        SendData->SegmentSize = Config->MaxPacketSize;
+        SendData->BufferCount = 0;
+        SendData->RecvRefCount = 0;
+        SendData->ECN = Config->ECN;
+        SendData->DSCP = Config->DSCP;
+        SendData->DatapathType = Config->Route->DatapathType = CXPLAT_DATAPATH_TYPE_MEMORY;
+    }
+    return (CXPLAT_SEND_DATA*)SendData;
+}
+
+_IRQL_requires_max_(DISPATCH_LEVEL)
+void
+MemorySendDataFree(
+    _In_ CXPLAT_SEND_DATA* SendData
+    )
+{
+    CxPlatPoolFree(SendData);
+}
+
+static
+void
+CxPlatMemorySendDataFinalizeSendBuffer(
+    _In_ CXPLAT_SEND_DATA_MEMORY* SendData
+    )
+{
+    if (SendData->ClientBuffer.Length == 0) { // No buffer to finalize.
+        return;
+    }
+
+    CXPLAT_DBG_ASSERT(SendData->SegmentSize == 0 || SendData->ClientBuffer.Length <= SendData->SegmentSize);
+    CXPLAT_DBG_ASSERT(SendData->TotalSize + SendData->ClientBuffer.Length <= sizeof(SendData->Buffer));
+
+    SendData->BufferCount++;
+    SendData->TotalSize += SendData->ClientBuffer.Length;
+    if (SendData->SegmentSize == 0 ||
+        SendData->ClientBuffer.Length < SendData->SegmentSize ||
+        SendData->TotalSize + SendData->SegmentSize > sizeof(SendData->Buffer) ||
+        SendData->BufferCount == CXPLAT_MEMORY_MAX_SEGMENTS) {
+        //
+        // Only the last segment may be shorter than the segment size, and
+        // without a segment size there is only one.
+        //
+        SendData->ClientBuffer.Buffer = NULL;
+    } else {
+        SendData->ClientBuffer.Buffer += SendData->SegmentSize;
+    }
+    SendData->ClientBuffer.Length = 0;
+}
+
+_IRQL_requires_max_(DISPATCH_LEVEL)
+_Success_(return != NULL)
+QUIC_BUFFER*
+MemorySendDataAllocBuffer(
+    _In_ CXPLAT_SEND_DATA* Data,
+    _In_ uint16_t MaxBufferLength
+    )
+{
+    CXPLAT_SEND_DATA_MEMORY* SendData = (CXPLAT_SEND_DATA_MEMORY*)Data;
+    CXPLAT_DBG_ASSERT(MaxBufferLength > 0);
+    CxPlatMemorySendDataFinalizeSendBuffer(SendData);
+    CXPLAT_DBG_ASSERT(SendData->SegmentSize == 0 || SendData->SegmentSize >= MaxBufferLength);
+    if (SendData->ClientBuffer.Buffer == NULL) {
+        return NULL;
+    }
+    SendData->ClientBuffer.Length = MaxBufferLength;
+    return &SendData->ClientBuffer;
+}
+
+_IRQL_requires_max_(DISPATCH_LEVEL)
+void
+MemorySendDataFreeBuffer(
+    _In_ CXPLAT_SEND_DATA* Data,
+    _In_ QUIC_BUFFER* Buffer
+    )
+{
+    //
+    // This must be the final send buffer; earlier segments cannot be freed.
+    //
+    CXPLAT_DBG_ASSERT(Buffer == &((CXPLAT_SEND_DATA_MEMORY*)Data)->ClientBuffer);
+    Buffer->Length = 0;
+    UNREFERENCED_PARAMETER(Data);
+}
+
+_IRQL_requires_max_(DISPATCH_LEVEL)
+BOOLEAN
+MemorySendDataIsFull(
+    _In_ CXPLAT_SEND_DATA* Data
+    )
+{
+    CXPLAT_SEND_DATA_MEMORY* SendData = (CXPLAT_SEND_DATA_MEMORY*)Data;
+    CxPlatMemorySendDataFinalizeSendBuffer(SendData);
+    return SendData->ClientBuffer.Buffer == NULL;
+}
+
+_IRQL_requires_max_(DISPATCH_LEVEL)
+void
+MemorySocketSend(
+    _In_ CXPLAT_SOCKET* Binding,
+    _In_ const CXPLAT_ROUTE* Route,
+    _In_ CXPLAT_SEND_DATA* Data
+    )
+{
+    CXPLAT_SEND_DATA_MEMORY* SendData = (CXPLAT_SEND_DATA_MEMORY*)Data;
+    CXPLAT_DATAPATH_MEMORY* DataPath = SendData->MemoryDataPath;
+
+    CxPlatMemorySendDataFinalizeSendBuffer(SendData);
+    if (SendData->BufferCount == 0) {
+        CxPlatPoolFree(SendData);
+        return;
+    }
+
+    const QUIC_ADDR* RemoteAddress =
+        Binding->HasFixedRemoteAddress ? &Binding->RemoteAddress : &Route->RemoteAddress;
+
+    CxPlatLockAcquire(&DataPath->Lock);
+    CXPLAT_SOCKET_MEMORY* Peer =
+        CxPlatMemoryLookupSocket(DataPath, QuicAddrGetPort(RemoteAddress));
+    CxPlatLockRelease(&DataPath->Lock);
+
+    if (Peer == NULL) {
+        //
+        // Nothing is bound to the destination port; drop it like the network
+        // would.
+        //
+        CxPlatPoolFree(SendData);
+        return;
+    }
+
+    //
+    // The peer sees the route reversed. The source address comes from the
+    // socket when the route doesn't have a specific one (e.g. not yet used to
+    // receive).
+    //
+    CXPLAT_ROUTE* RecvRoute = &SendData->RecvRoute;
+    CxPlatZeroMemory(RecvRoute, sizeof(*RecvRoute));
+    RecvRoute->LocalAddress = *RemoteAddress;
+    RecvRoute->RemoteAddress =
+        QuicAddrIsWildCard(&Route->LocalAddress) ?
+            Binding->LocalAddress : Route->LocalAddress;
+    if (QuicAddrIsWildCard(&RecvRoute->RemoteAddress)) {
+        QuicAddrSetFamily(&RecvRoute->RemoteAddress, QuicAddrGetFamily(RemoteAddress));
+        QuicAddrSetToLoopback(&RecvRoute->RemoteAddress);
+    }
+    QuicAddrSetPort(&RecvRoute->RemoteAddress, QuicAddrGetPort(&Binding->LocalAddress));
+    RecvRoute->DatapathType = CXPLAT_DATAPATH_TYPE_MEMORY;
+    RecvRoute->State = RouteResolved;
+
+    //
+    // Flows to an unconnected socket are spread across its partitions by the
+    // sender's port, much like RSS would.
+    //
+    CXPLAT_MEMORY_RECV_QUEUE* Queue =
+        &Peer->Queues[QuicAddrGetPort(&RecvRoute->RemoteAddress) % Peer->QueueCount];
+    RecvRoute->Queue = (CXPLAT_QUEUE*)Queue;
+
+    //
+    // Build the coalesced chain of segments over the send buffer.
+    //
+    CXPLAT_RECV_DATA* Head = NULL;
+    CXPLAT_RECV_DATA** Tail = &Head;
+    uint32_t Offset = 0;
+    for (uint16_t i = 0; i < SendData->BufferCount; ++i) {
+        CXPLAT_MEMORY_RECV_PACKET* Packet = CxPlatSendDataGetRecvPacket(SendData, i);
+        CXPLAT_RECV_DATA* RecvData = &Packet->Data;
+        Packet->SendData = SendData;
+        CxPlatZeroMemory(RecvData, sizeof(*RecvData));
+        RecvData->Route = RecvRoute;
+        RecvData->Buffer = SendData->Buffer + Offset;
+        RecvData->BufferLength =
+            SendData->SegmentSize == 0 ?
+                (uint16_t)SendData->TotalSize :
+                (uint16_t)CXPLAT_MIN(SendData->SegmentSize, SendData->TotalSize - Offset);
+        RecvData->PartitionIndex = Queue->PartitionIndex;
+        RecvData->TypeOfService = (uint8_t)(SendData->ECN | (SendData->DSCP << 2));
+        RecvData->CoalescedCount = (uint16_t)(SendData->BufferCount - i);
+        RecvData->Allocated = TRUE;
+        RecvData->DatapathType = CXPLAT_DATAPATH_TYPE_MEMORY;
+        Offset += RecvData->BufferLength;
+        *Tail = RecvData;
+        Tail = &RecvData->Next;
+    }
+    SendData->RecvRefCount = SendData->BufferCount;
+
+    //
+    // Either hands over the lookup reference.
+    //
+    if (DataPath->DelayQueues != NULL) {
+        CxPlatMemoryLinkSend(DataPath, CxPlatSocketToMemory(Binding), Queue, Head);
+    } else {
+        CxPlatMemoryRecvQueueAppend(Queue, Head, Tail);
+    }
+}
@@ -47,6 +47,7 @@ RawDataPathInitialize(
     CXPLAT_FRE_ASSERT(CxPlatWorkerPoolAddRef(WorkerPool));
 
     DataPath->WorkerPool = WorkerPool;
+    DataPath->ParentDataPath = ParentDataPath;
 
     if (!CxPlatSockPoolInitialize(&DataPath->SocketPool)) {
         goto Error;
@@ -65,7 +66,6 @@ RawDataPathInitialize(
     }
 
     *NewDataPath = DataPath;
-    DataPath->ParentDataPath = ParentDataPath;
     DataPath = NULL;
 
 Error:
@@ -33,20 +33,34 @@ Abstract:
 #define FRAME_SIZE         XSK_UMEM__DEFAULT_FRAME_SIZE // TODO: 2K mode
 #define INVALID_UMEM_FRAME UINT64_MAX
 
+//
+// The free frames of one queue. The UMEM is shared, but each queue owns a
+// fixed share of its frames, which are only ever filled into, sent from and
+// returned to that queue. So queues never contend with each other for frames.
+//
+struct XskFrameList {
+    CXPLAT_LOCK Lock; // Protects the free frames.
+    uint32_t FrameCount;
+    uint32_t FrameFree;
+    uint64_t FrameAddr[0];
+};
+
 struct XskSocketInfo {
     struct xsk_ring_cons Rx;
     struct xsk_ring_prod Tx;
+    struct xsk_ring_prod Fq;
+    struct xsk_ring_cons Cq;
     struct XskUmemInfo *UmemInfo;
     struct xsk_socket *Xsk;
-
-    CXPLAT_LOCK UmemLock;
-    uint64_t UmemFrameAddr[NUM_FRAMES];
-    uint32_t UmemFrameFree;
+    struct XskFrameList Frames; // Must be last.
 };
 
+//
+// A UMEM shared by the sockets of all the queues of an interface, which keeps
+// the buffer footprint fixed per interface. Each socket still has its own fill
+// and completion rings, and its own frames.
+//
 struct XskUmemInfo {
-    struct xsk_ring_prod Fq;
-    struct xsk_ring_cons Cq;
     struct xsk_umem *Umem;
     void *Buffer;
     uint32_t RxHeadRoom;
@@ -65,6 +79,13 @@ typedef struct XDP_DATAPATH { // NOLINT(clang-analyzer-optin.performance.Padding
     uint32_t BufferCount;
 
     uint32_t PollingIdleTimeoutUs;
+
+    //
+    // The time, in microseconds, the kernel busy polls XSKs for when woken by
+    // the workers. Zero if preferred busy polling is disabled.
+    //
+    uint32_t BusyPollUs;
+
     BOOLEAN TxAlwaysPoke;
     BOOLEAN SkipXsum;
     BOOLEAN Running;        // Signal to stop workers.
@@ -75,6 +96,7 @@ typedef struct XDP_DATAPATH { // NOLINT(clang-analyzer-optin.performance.Padding
 
 typedef struct XDP_INTERFACE {
     XDP_INTERFACE_COMMON;
+    struct XskUmemInfo *UmemInfo;
     struct xsk_socket_config *XskCfg;
     struct bpf_object *BpfObj;
     struct xdp_program *XdpProg;
@@ -265,10 +287,7 @@ CxPlatDpRawInterfaceUninitialize(
                 }
                 xsk_socket__delete(Queue->XskInfo->Xsk);
             }
-            if (Queue->XskInfo->UmemInfo) {
-                UninitializeUmem(Queue->XskInfo->UmemInfo);
-            }
-            CxPlatLockUninitialize(&Queue->XskInfo->UmemLock);
+            CxPlatLockUninitialize(&Queue->XskInfo->Frames.Lock);
             free(Queue->XskInfo);
         }
 
@@ -282,6 +301,14 @@ CxPlatDpRawInterfaceUninitialize(
         CxPlatFree(Interface->Queues, QUEUE_TAG);
     }
 
+    //
+    // Only once all the sockets sharing it are deleted.
+    //
+    if (Interface->UmemInfo) {
+        UninitializeUmem(Interface->UmemInfo);
+        Interface->UmemInfo = NULL;
+    }
+
     DetachXdpProgram(Interface, false);
 
     if (Interface->XdpProg) {
@@ -293,13 +320,23 @@ CxPlatDpRawInterfaceUninitialize(
     }
 }
 
-static QUIC_STATUS InitializeUmem(uint32_t FrameSize, uint32_t NumFrames, uint32_t RxHeadRoom, uint32_t TxHeadRoom, struct XskUmemInfo* UmemInfo)
+//
+// Creates the UMEM along with the fill and completion rings of the first socket
+// to use it. Later sockets create their own rings when they share it.
+//
+static QUIC_STATUS InitializeUmem(uint32_t FrameSize, uint32_t NumFrames, uint32_t RxHeadRoom, uint32_t TxHeadRoom, struct xsk_ring_prod* Fq, struct xsk_ring_cons* Cq, struct XskUmemInfo** NewUmemInfo)
 {
+    struct XskUmemInfo *UmemInfo = calloc(1, sizeof(struct XskUmemInfo));
+    if (!UmemInfo) {
+        return QUIC_STATUS_OUT_OF_MEMORY;
+    }
+
     void *Buffer = NULL;
     if (posix_memalign(&Buffer, getpagesize(), (size_t)(FrameSize) * NumFrames)) {
         QuicTraceLogVerbose(
             XdpAllocUmem,
             "[ xdp] Failed to allocate umem");
+        free(UmemInfo);
         return QUIC_STATUS_OUT_OF_MEMORY;
     }
 
@@ -311,42 +348,105 @@ static QUIC_STATUS InitializeUmem(uint32_t FrameSize, uint32_t NumFrames, uint32
         .flags = 0
     };
 
-    int Ret = xsk_umem__create(&UmemInfo->Umem, Buffer, (uint64_t)(FrameSize) * NumFrames, &UmemInfo->Fq, &UmemInfo->Cq, &UmemConfig);
+    int Ret = xsk_umem__create(&UmemInfo->Umem, Buffer, (uint64_t)(FrameSize) * NumFrames, Fq, Cq, &UmemConfig);
     if (Ret) {
         errno = -Ret;
         free(Buffer);
+        free(UmemInfo);
         return QUIC_STATUS_INTERNAL_ERROR;
     }
 
     UmemInfo->Buffer = Buffer;
     UmemInfo->RxHeadRoom = RxHeadRoom;
     UmemInfo->TxHeadRoom = TxHeadRoom;
+    *NewUmemInfo = UmemInfo;
     return QUIC_STATUS_SUCCESS;
 }
 
-static uint64_t XskUmemFreeFrames(struct XskSocketInfo *Xsk)
+//
+// Gives a queue the UMEM frames [FirstFrame, FirstFrame + NumFrames).
+//
+static void XskFrameListInitialize(struct XskFrameList *Frames, uint32_t FirstFrame, uint32_t NumFrames, uint32_t FrameSize)
+{
+    CxPlatLockInitialize(&Frames->Lock);
+    Frames->FrameCount = NumFrames;
+    for (uint32_t i = 0; i < NumFrames; i++) {
+        Frames->FrameAddr[i] = (uint64_t)(FirstFrame + i) * FrameSize;
+    }
+    Frames->FrameFree = NumFrames;
+}
+
+static uint64_t XskFreeFrames(struct XskFrameList *Frames)
 {
-    return Xsk->UmemFrameFree;
+    return Frames->FrameFree;
 }
 
-static uint64_t XskUmemFrameAlloc(struct XskSocketInfo *Xsk)
+static uint64_t XskFrameAlloc(struct XskFrameList *Frames)
 {
     uint64_t Frame;
-    if (Xsk->UmemFrameFree == 0) {
+    if (Frames->FrameFree == 0) {
         QuicTraceLogVerbose(
             XdpUmemAllocFails,
             "[ xdp][umem] Out of UMEM frame, OOM");
         return INVALID_UMEM_FRAME;
     }
-    Frame = Xsk->UmemFrameAddr[--Xsk->UmemFrameFree];
-    Xsk->UmemFrameAddr[Xsk->UmemFrameFree] = INVALID_UMEM_FRAME;
+    Frame = Frames->FrameAddr[--Frames->FrameFree];
+    Frames->FrameAddr[Frames->FrameFree] = INVALID_UMEM_FRAME;
     return Frame;
 }
 
-static void XskUmemFrameFree(struct XskSocketInfo *Xsk, uint64_t Frame)
+static void XskFrameFree(struct XskFrameList *Frames, uint64_t Frame)
+{
+    assert(Frames->FrameFree < Frames->FrameCount);
+    Frames->FrameAddr[Frames->FrameFree++] = Frame;
+}
+
+//
+// Best effort. Has the kernel process the XSK's device queue from the workers'
+// receive and send syscalls, while they keep busy, instead of from interrupts.
+// Requires the device's napi_defer_hard_irqs and gro_flush_timeout to be set
+// to take full effect.
+//
+static void XskConfigureBusyPoll(const XDP_DATAPATH* Xdp, struct xsk_socket *Xsk)
 {
-    assert(Xsk->UmemFrameFree < NUM_FRAMES);
-    Xsk->UmemFrameAddr[Xsk->UmemFrameFree++] = Frame;
+#if defined(SO_PREFER_BUSY_POLL) && defined(SO_BUSY_POLL_BUDGET)
+    if (Xdp->BusyPollUs == 0) {
+        return;
+    }
+
+    const int Fd = xsk_socket__fd(Xsk);
+    int Option = TRUE;
+    if (setsockopt(Fd, SOL_SOCKET, SO_PREFER_BUSY_POLL, (const void*)&Option, sizeof(Option)) != 0) {
+        QuicTraceEvent(
+            XdpEpollErrorStatus,
+            "[ xdp]ERROR, %u, %s.",
+            errno,
+            "setsockopt(SO_PREFER_BUSY_POLL) failed");
+        return;
+    }
+
+    Option = (int)CXPLAT_MIN(Xdp->BusyPollUs, INT32_MAX);
+    if (setsockopt(Fd, SOL_SOCKET, SO_BUSY_POLL, (const void*)&Option, sizeof(Option)) != 0) {
+        QuicTraceEvent(
+            XdpEpollErrorStatus,
+            "[ xdp]ERROR, %u, %s.",
+            errno,
+            "setsockopt(SO_BUSY_POLL) failed");
+        return;
+    }
+
+    Option = RX_BATCH_SIZE;
+    if (setsockopt(Fd, SOL_SOCKET, SO_BUSY_POLL_BUDGET, (const void*)&Option, sizeof(Option)) != 0) {
+        QuicTraceEvent(
+            XdpEpollErrorStatus,
+            "[ xdp]ERROR, %u, %s.",
+            errno,
+            "setsockopt(SO_BUSY_POLL_BUDGET) failed");
+    }
+#else
+    UNREFERENCED_PARAMETER(Xdp);
+    UNREFERENCED_PARAMETER(Xsk);
+#endif
 }
 
 QUIC_STATUS
@@ -539,42 +639,47 @@ CxPlatDpRawInterfaceInitialize(
         CxPlatLockInitialize(&Queue->FqLock);
         CxPlatLockInitialize(&Queue->CqLock);
 
-        // Initialize shared packet_buffer for umem usage
-        struct XskUmemInfo *UmemInfo = calloc(1, sizeof(struct XskUmemInfo));
-        if (!UmemInfo) {
+        struct XskSocketInfo *XskInfo =
+            calloc(1, sizeof(*XskInfo) + (size_t)NUM_FRAMES * sizeof(uint64_t));
+        if (!XskInfo) {
             Status = QUIC_STATUS_OUT_OF_MEMORY;
             goto Error;
         }
+        XskFrameListInitialize(&XskInfo->Frames, i * NUM_FRAMES, NUM_FRAMES, FrameSize);
+        Queue->XskInfo = XskInfo;
 
-        Status = InitializeUmem(FRAME_SIZE, NUM_FRAMES, RxHeadroom, TxHeadroom, UmemInfo);
-        if (QUIC_FAILED(Status)) {
-            QuicTraceLogVerbose(
-                XdpConfigureUmem,
-                "[ xdp] Failed to configure Umem");
-            free(UmemInfo);
-            goto Error;
+        if (i == 0) {
+            //
+            // The first socket uses the rings created along with the UMEM.
+            //
+            Status =
+                InitializeUmem(
+                    FrameSize,
+                    NUM_FRAMES * Interface->QueueCount,
+                    RxHeadroom,
+                    TxHeadroom,
+                    &XskInfo->Fq,
+                    &XskInfo->Cq,
+                    &Interface->UmemInfo);
+            if (QUIC_FAILED(Status)) {
+                QuicTraceLogVerbose(
+                    XdpConfigureUmem,
+                    "[ xdp] Failed to configure Umem");
+                goto Error;
+            }
         }
+        struct XskUmemInfo *UmemInfo = Interface->UmemInfo;
+        XskInfo->UmemInfo = UmemInfo;
 
         //
         // Create AF_XDP socket.
         //
-        struct XskSocketInfo *XskInfo = calloc(1, sizeof(*XskInfo));
-        if (!XskInfo) {
-            Status = QUIC_STATUS_OUT_OF_MEMORY;
-            free(UmemInfo->Buffer);
-            free(UmemInfo);
-            goto Error;
-        }
-        CxPlatLockInitialize(&XskInfo->UmemLock);
-        Queue->XskInfo = XskInfo;
-        XskInfo->UmemInfo = UmemInfo;
-
         int RetryCount = 10;
         int Ret = 0;
         do {
-            Ret = xsk_socket__create(&XskInfo->Xsk, Interface->IfName,
+            Ret = xsk_socket__create_shared(&XskInfo->Xsk, Interface->IfName,
                         i, UmemInfo->Umem, &XskInfo->Rx,
-                        &XskInfo->Tx, XskCfg);
+                        &XskInfo->Tx, &XskInfo->Fq, &XskInfo->Cq, XskCfg);
             if (Ret == -EBUSY) {
                 CxPlatSleep(100);
             }
@@ -594,29 +699,30 @@ CxPlatDpRawInterfaceInitialize(
             goto Error;
         }
 
-        for (int i = 0; i < NUM_FRAMES; i++) {
-            XskInfo->UmemFrameAddr[i] = i * FrameSize;
-        }
-        XskInfo->UmemFrameFree = NUM_FRAMES;
+        XskConfigureBusyPoll(Xdp, XskInfo->Xsk);
 
         // Setup fill queue for Rx
         uint32_t FqIdx = 0;
-        Ret = xsk_ring_prod__reserve(&XskInfo->UmemInfo->Fq, PROD_NUM_DESCS, &FqIdx);
+        Ret = xsk_ring_prod__reserve(&XskInfo->Fq, PROD_NUM_DESCS, &FqIdx);
         if (Ret != PROD_NUM_DESCS) {
-            return QUIC_STATUS_OUT_OF_MEMORY;
+            Status = QUIC_STATUS_OUT_OF_MEMORY;
+            goto Error;
         }
-        for (uint32_t i = 0; i < PROD_NUM_DESCS; i ++) {
-            uint64_t Addr = XskUmemFrameAlloc(XskInfo);
+        uint32_t Filled = 0;
+        CxPlatLockAcquire(&XskInfo->Frames.Lock);
+        for (; Filled < PROD_NUM_DESCS; Filled++) {
+            uint64_t Addr = XskFrameAlloc(&XskInfo->Frames);
             if (Addr == INVALID_UMEM_FRAME) {
                 QuicTraceLogVerbose(
                     FailRxAlloc,
                     "[ xdp][rx  ] OOM for Rx");
                 break;
             }
-            *xsk_ring_prod__fill_addr(&XskInfo->UmemInfo->Fq, FqIdx++) = Addr;
+            *xsk_ring_prod__fill_addr(&XskInfo->Fq, FqIdx++) = Addr;
         }
+        CxPlatLockRelease(&XskInfo->Frames.Lock);
 
-        xsk_ring_prod__submit(&XskInfo->UmemInfo->Fq, PROD_NUM_DESCS);
+        xsk_ring_prod__submit(&XskInfo->Fq, Filled);
     }
 
     //
@@ -681,6 +787,8 @@ CxPlatDpRawInitialize(
 
     CxPlatListInitializeHead(&Xdp->Interfaces);
     Xdp->PollingIdleTimeoutUs = 0;
+    Xdp->BusyPollUs =
+        Datapath->ParentDataPath != NULL ? Datapath->ParentDataPath->BusyPollUs : 0;
     Xdp->PartitionCount = CxPlatWorkerPoolGetCount(WorkerPool);
     for (uint32_t i = 0; i < Xdp->PartitionCount; i++) {
         Xdp->Partitions[i].Processor = (uint16_t)
@@ -1025,25 +1133,28 @@ CxPlatDpRawRxFree(
     _In_opt_ const CXPLAT_RECV_DATA* PacketChain
     )
 {
-    uint32_t Count = 0;
-    struct XskSocketInfo *XskInfo = NULL;
-    if (PacketChain) {
+    //
+    // Frames go back to the queue they were received on, whichever partition
+    // they are returned on. Chains are usually from a single queue, so the
+    // lock is only switched when the queue changes.
+    //
+    struct XskFrameList *Frames = NULL;
+    while (PacketChain) {
         const XDP_RX_PACKET* Packet =
             CXPLAT_CONTAINING_RECORD(PacketChain, XDP_RX_PACKET, RecvData);
-        XskInfo = Packet->Queue->XskInfo;
-
-        CxPlatLockAcquire(&XskInfo->UmemLock);
-        while (PacketChain) {
-            Packet =
-                CXPLAT_CONTAINING_RECORD(PacketChain, XDP_RX_PACKET, RecvData);
-            PacketChain = PacketChain->Next;
-            XskUmemFrameFree(Packet->Queue->XskInfo, Packet->Addr);
-            Count++;
+        PacketChain = PacketChain->Next;
+        if (&Packet->Queue->XskInfo->Frames != Frames) {
+            if (Frames) {
+                CxPlatLockRelease(&Frames->Lock);
+            }
+            Frames = &Packet->Queue->XskInfo->Frames;
+            CxPlatLockAcquire(&Frames->Lock);
         }
+        XskFrameFree(Frames, Packet->Addr);
     }
 
-    if (Count > 0) {
-        CxPlatLockRelease(&XskInfo->UmemLock);
+    if (Frames) {
+        CxPlatLockRelease(&Frames->Lock);
     }
 }
 
@@ -1057,9 +1168,9 @@ CxPlatDpRawTxAlloc(
     XDP_TX_PACKET* Packet = NULL;
     CXPLAT_QUEUE* Queue = Config->Route->Queue;
     struct XskSocketInfo* XskInfo = Queue->XskInfo;
-    CxPlatLockAcquire(&XskInfo->UmemLock);
-    uint64_t BaseAddr = XskUmemFrameAlloc(XskInfo);
-    CxPlatLockRelease(&XskInfo->UmemLock);
+    CxPlatLockAcquire(&XskInfo->Frames.Lock);
+    uint64_t BaseAddr = XskFrameAlloc(&XskInfo->Frames);
+    CxPlatLockRelease(&XskInfo->Frames.Lock);
     if (BaseAddr == INVALID_UMEM_FRAME) {
         QuicTraceLogVerbose(
             FailTxAlloc,
@@ -1100,17 +1211,27 @@ KickTx(
     )
 {
     struct XskSocketInfo* XskInfo = Queue->XskInfo;
-    if (sendto(xsk_socket__fd(XskInfo->Xsk), NULL, 0, MSG_DONTWAIT, NULL, 0) < 0) {
-        if (errno == EAGAIN || errno == EWOULDBLOCK) {
-            if (!SendAlreadyPending) {
-                XdpSocketContextSetEvents(Queue, EPOLL_CTL_MOD, EPOLLIN | EPOLLOUT);
+    const XDP_DATAPATH* Xdp = Queue->Partition->Xdp;
+
+    //
+    // With need_wakeup, the kernel only needs the syscall when it isn't
+    // already processing the TX ring. With busy polling, the syscall is what
+    // drives the device, so always make it.
+    //
+    if (Xdp->TxAlwaysPoke || Xdp->BusyPollUs != 0 ||
+        xsk_ring_prod__needs_wakeup(&XskInfo->Tx)) {
+        if (sendto(xsk_socket__fd(XskInfo->Xsk), NULL, 0, MSG_DONTWAIT, NULL, 0) < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                if (!SendAlreadyPending) {
+                    XdpSocketContextSetEvents(Queue, EPOLL_CTL_MOD, EPOLLIN | EPOLLOUT);
+                }
+                return;
             }
-            return;
         }
+        QuicTraceLogVerbose(
+            DoneSendTo,
+            "[ xdp][TX  ] Done sendto.");
     }
-    QuicTraceLogVerbose(
-        DoneSendTo,
-        "[ xdp][TX  ] Done sendto.");
 
     if (SendAlreadyPending) {
         XdpSocketContextSetEvents(Queue, EPOLL_CTL_MOD, EPOLLIN);
@@ -1119,16 +1240,16 @@ KickTx(
     uint32_t Completed;
     uint32_t CqIdx;
     CxPlatLockAcquire(&Queue->CqLock);
-    Completed = xsk_ring_cons__peek(&XskInfo->UmemInfo->Cq, CONS_NUM_DESCS, &CqIdx);
+    Completed = xsk_ring_cons__peek(&XskInfo->Cq, CONS_NUM_DESCS, &CqIdx);
     if (Completed > 0) {
-        CxPlatLockAcquire(&XskInfo->UmemLock);
+        CxPlatLockAcquire(&XskInfo->Frames.Lock);
         for (uint32_t i = 0; i < Completed; i++) {
-            uint64_t addr = *xsk_ring_cons__comp_addr(&XskInfo->UmemInfo->Cq, CqIdx++) - XskInfo->UmemInfo->TxHeadRoom;
-            XskUmemFrameFree(XskInfo, addr);
+            uint64_t addr = *xsk_ring_cons__comp_addr(&XskInfo->Cq, CqIdx++) - XskInfo->UmemInfo->TxHeadRoom;
+            XskFrameFree(&XskInfo->Frames, addr);
         }
-        CxPlatLockRelease(&XskInfo->UmemLock);
+        CxPlatLockRelease(&XskInfo->Frames.Lock);
 
-        xsk_ring_cons__release(&XskInfo->UmemInfo->Cq, Completed);
+        xsk_ring_cons__release(&XskInfo->Cq, Completed);
         QuicTraceLogVerbose(
             ReleaseCons,
             "[ xdp][cq  ] Release %d from completion queue", Completed);
@@ -1150,9 +1271,10 @@ CxPlatDpRawTxEnqueue(
     uint32_t TxIdx = 0;
     CxPlatLockAcquire(&Queue->TxLock);
     if (xsk_ring_prod__reserve(&XskInfo->Tx, 1, &TxIdx) != 1) {
-        CxPlatLockAcquire(&XskInfo->UmemLock);
-        XskUmemFrameFree(XskInfo, Packet->UmemRelativeAddr);
-        CxPlatLockRelease(&XskInfo->UmemLock);
+        CxPlatLockAcquire(&XskInfo->Frames.Lock);
+        XskFrameFree(&XskInfo->Frames, Packet->UmemRelativeAddr);
+        CxPlatLockRelease(&XskInfo->Frames.Lock);
+        CxPlatLockRelease(&Queue->TxLock);
         QuicTraceLogVerbose(
             FailTxReserve,
             "[ xdp][tx  ] Failed to reserve");
@@ -1277,6 +1399,15 @@ CxPlatXdpRx(
 
     CxPlatLockAcquire(&Queue->RxLock);
     Rcvd = xsk_ring_cons__peek(&XskInfo->Rx, RX_BATCH_SIZE, &RxIdx);
+    if (Rcvd == 0 &&
+        (Xdp->BusyPollUs != 0 || xsk_ring_prod__needs_wakeup(&XskInfo->Fq))) {
+        //
+        // Have the kernel process the device queue: with busy polling it only
+        // does so from this syscall, and with need_wakeup it stopped once the
+        // fill ring ran dry.
+        //
+        recvfrom(xsk_socket__fd(XskInfo->Xsk), NULL, 0, MSG_DONTWAIT, NULL, NULL);
+    }
 
     // Process received packets
     CXPLAT_RECV_DATA* Buffers[RX_BATCH_SIZE] = {};
@@ -1315,10 +1446,13 @@ CxPlatXdpRx(
 
         if (Packet->RecvData.Buffer) {
             Packet->Addr = Addr - (XDP_PACKET_HEADROOM + XskInfo->UmemInfo->RxHeadRoom);
+            Packet->RecvData.CoalescedCount = 1;
             Packet->RecvData.Allocated = TRUE;
             Buffers[PacketCount++] = &Packet->RecvData;
         } else {
-            XskUmemFrameFree(XskInfo, Addr - (XDP_PACKET_HEADROOM + XskInfo->UmemInfo->RxHeadRoom));
+            CxPlatLockAcquire(&XskInfo->Frames.Lock);
+            XskFrameFree(&XskInfo->Frames, Addr - (XDP_PACKET_HEADROOM + XskInfo->UmemInfo->RxHeadRoom));
+            CxPlatLockRelease(&XskInfo->Frames.Lock);
         }
     }
 
@@ -1327,33 +1461,33 @@ CxPlatXdpRx(
     }
     CxPlatLockRelease(&Queue->RxLock);
 
-    CxPlatLockAcquire(&XskInfo->UmemLock);
+    CxPlatLockAcquire(&XskInfo->Frames.Lock);
     CxPlatLockAcquire(&Queue->FqLock);
     // Stuff the ring with as much frames as possible
-    Available = xsk_prod_nb_free(&XskInfo->UmemInfo->Fq, XskUmemFreeFrames(XskInfo));
+    Available = xsk_prod_nb_free(&XskInfo->Fq, XskFreeFrames(&XskInfo->Frames));
     if (Available > 0) {
-        ret = xsk_ring_prod__reserve(&XskInfo->UmemInfo->Fq, Available, &FqIdx);
+        ret = xsk_ring_prod__reserve(&XskInfo->Fq, Available, &FqIdx);
 
         // This should not happen, but just in case
         while (ret != Available) {
-            ret = xsk_ring_prod__reserve(&XskInfo->UmemInfo->Fq, Rcvd, &FqIdx);
+            ret = xsk_ring_prod__reserve(&XskInfo->Fq, Rcvd, &FqIdx);
         }
         for (i = 0; i < Available; i++) {
-            uint64_t addr = XskUmemFrameAlloc(XskInfo);
+            uint64_t addr = XskFrameAlloc(&XskInfo->Frames);
             if (addr == INVALID_UMEM_FRAME) {
                 QuicTraceLogVerbose(
                     FailRxAlloc,
                     "[ xdp][rx  ] OOM for Rx");
                 break;
             }
-            *xsk_ring_prod__fill_addr(&XskInfo->UmemInfo->Fq, FqIdx++) = addr;
+            *xsk_ring_prod__fill_addr(&XskInfo->Fq, FqIdx++) = addr;
         }
         if (i > 0) {
-            xsk_ring_prod__submit(&XskInfo->UmemInfo->Fq, i);
+            xsk_ring_prod__submit(&XskInfo->Fq, i);
         }
     }
     CxPlatLockRelease(&Queue->FqLock);
-    CxPlatLockRelease(&XskInfo->UmemLock);
+    CxPlatLockRelease(&XskInfo->Frames.Lock);
 
     if (PacketCount) {
         CxPlatDpRawRxEthernet(
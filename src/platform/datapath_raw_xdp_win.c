@@ -1652,6 +1652,7 @@ CxPlatXdpRx(
         CXPLAT_DBG_ASSERT(Packet->RecvData.Route->Queue != NULL);
 
         if (Packet->RecvData.Buffer) {
+            Packet->RecvData.CoalescedCount = 1;
             Packet->RecvData.Allocated = TRUE;
             Buffers[PacketCount++] = &Packet->RecvData;
         } else {
@@ -2303,9 +2303,14 @@ CxPlatDataPathSocketReceive(
             CXPLAT_DBG_ASSERT(Datagram != NULL);
             Datagram->IoBlock = IoBlock;
             Datagram->Data.Next = NULL;
+            Datagram->Data.ReceiveTimeUs = 0;
             Datagram->Data.PartitionIndex = (uint16_t)(CurProcNumber % Binding->Datapath->ProcCount);
             Datagram->Data.TypeOfService = (uint8_t)TypeOfService;
             Datagram->Data.HopLimitTTL = (uint8_t)HopLimitTTL;
+            Datagram->Data.CoalescedCount =
+                (uint16_t)CXPLAT_MIN(
+                    (DataLength + MessageLength - 1) / MessageLength,
+                    (SIZE_T)(URO_MAX_DATAGRAMS_PER_INDICATION - IoBlock->ReferenceCount));
             Datagram->Data.Allocated = TRUE;
             Datagram->Data.QueuedOnConnection = FALSE;
 
@@ -2980,6 +2985,18 @@ CxPlatSocketGetTcpStatistics(
     return QUIC_STATUS_NOT_SUPPORTED;
 }
 
+_IRQL_requires_max_(DISPATCH_LEVEL)
+QUIC_STATUS
+CxPlatSocketGetUdpStatistics(
+    _In_ CXPLAT_SOCKET* Socket,
+    _Out_ CXPLAT_UDP_STATISTICS* Statistics
+    )
+{
+    UNREFERENCED_PARAMETER(Socket);
+    UNREFERENCED_PARAMETER(Statistics);
+    return QUIC_STATUS_NOT_SUPPORTED;
+}
+
 void
 DataPathProcessCqe(
     _In_ CXPLAT_CQE* Cqe
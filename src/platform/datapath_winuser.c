@@ -3127,6 +3127,9 @@ CxPlatDataPathUdpRecvComplete(
             CXPLAT_CONTAINING_RECORD(
                 Datagram, DATAPATH_RX_PACKET, Data)->IoBlock = IoBlock;
 
+            Datagram->CoalescedCount =
+                (uint16_t)((NumberOfBytesTransferred + MessageLength - 1) / MessageLength);
+
             if (MessageLength > NumberOfBytesTransferred) {
                 //
                 // The last message is smaller than all the rest.
@@ -3136,6 +3139,7 @@ CxPlatDataPathUdpRecvComplete(
 
             Datagram->Next = NULL;
             Datagram->Buffer = RecvPayload;
+            Datagram->ReceiveTimeUs = 0;
             Datagram->BufferLength = MessageLength;
             Datagram->Route = &IoBlock->Route;
             Datagram->PartitionIndex =
@@ -3312,10 +3316,12 @@ CxPlatDataPathTcpRecvComplete(
 
         Data->Next = NULL;
         Data->Buffer = ((PUCHAR)IoBlock) + Datapath->RecvPayloadOffset;
+        Data->ReceiveTimeUs = 0;
         Data->BufferLength = NumberOfBytesTransferred;
         Data->Route = &IoBlock->Route;
         Data->PartitionIndex = SocketProc->DatapathProc->PartitionIndex;
         Data->TypeOfService = 0;
+        Data->CoalescedCount = 1;
         Data->Allocated = TRUE;
         Data->Route->DatapathType = Data->DatapathType = CXPLAT_DATAPATH_TYPE_NORMAL;
         Data->QueuedOnConnection = FALSE;
@@ -4073,6 +4079,18 @@ CxPlatSocketGetTcpStatistics(
 #endif
 }
 
+_IRQL_requires_max_(DISPATCH_LEVEL)
+QUIC_STATUS
+CxPlatSocketGetUdpStatistics(
+    _In_ CXPLAT_SOCKET* Socket,
+    _Out_ CXPLAT_UDP_STATISTICS* Statistics
+    )
+{
+    UNREFERENCED_PARAMETER(Socket);
+    UNREFERENCED_PARAMETER(Statistics);
+    return QUIC_STATUS_NOT_SUPPORTED;
+}
+
 _IRQL_requires_max_(PASSIVE_LEVEL)
 void
 CxPlatIoRecvEventComplete(
@@ -47,14 +47,35 @@ CxPlatDataPathInitialize(
         goto Error;
     }
 
-    //
-    // Best effort try to initialize the raw datapath.
-    //
-    RawDataPathInitialize(
-        ClientRecvContextLength,
-        *NewDataPath,
-        WorkerPool,
-        &((*NewDataPath)->RawDataPath));
+    if (InitConfig->EnableMemoryDatapath) {
+        //
+        // UDP sockets never touch the network with the memory datapath, so
+        // there is no need for the raw datapath either.
+        //
+        Status =
+            MemoryDataPathInitialize(
+                ClientRecvContextLength,
+                *NewDataPath,
+                WorkerPool,
+                InitConfig->Emulation,
+                &((*NewDataPath)->MemoryDataPath));
+        if (QUIC_FAILED(Status)) {
+            QuicTraceLogVerbose(
+                DatapathInitFail,
+                "[  dp] Failed to initialize datapath, status:%d", Status);
+            DataPathUninitialize(*NewDataPath);
+            *NewDataPath = NULL;
+        }
+    } else {
+        //
+        // Best effort try to initialize the raw datapath.
+        //
+        RawDataPathInitialize(
+            ClientRecvContextLength,
+            *NewDataPath,
+            WorkerPool,
+            &((*NewDataPath)->RawDataPath));
+    }
 
 Error:
 
@@ -67,6 +88,9 @@ CxPlatDataPathUninitialize(
     _In_ CXPLAT_DATAPATH* Datapath
     )
 {
+    if (Datapath->MemoryDataPath) {
+        MemoryDataPathUninitialize(Datapath->MemoryDataPath);
+    }
     if (Datapath->RawDataPath) {
         RawDataPathUninitialize(Datapath->RawDataPath);
     }
@@ -94,6 +118,9 @@ CxPlatDataPathGetSupportedFeatures(
     _In_ CXPLAT_SOCKET_FLAGS SocketFlags
     )
 {
+    if (Datapath->MemoryDataPath) {
+        return MemoryDataPathGetSupportedFeatures(Datapath->MemoryDataPath);
+    }
     if (Datapath->RawDataPath && (SocketFlags & CXPLAT_SOCKET_FLAG_XDP)) {
         return DataPathGetSupportedFeatures(Datapath) |
                RawDataPathGetSupportedFeatures(Datapath->RawDataPath);
@@ -108,6 +135,9 @@ CxPlatDataPathIsPaddingPreferred(
     _In_ CXPLAT_SEND_DATA* SendData
     )
 {
+    if (DatapathType(SendData) == CXPLAT_DATAPATH_TYPE_MEMORY) {
+        return TRUE;
+    }
     CXPLAT_DBG_ASSERT(
         DatapathType(SendData) == CXPLAT_DATAPATH_TYPE_NORMAL ||
         DatapathType(SendData) == CXPLAT_DATAPATH_TYPE_RAW);
@@ -127,6 +157,10 @@ CxPlatSocketCreateUdp(
     QUIC_STATUS Status = QUIC_STATUS_SUCCESS;
     BOOLEAN CreateRaw = Config->Flags & CXPLAT_SOCKET_FLAG_XDP;
 
+    if (Datapath->MemoryDataPath) {
+        return MemorySocketCreateUdp(Datapath, Config, NewSocket);
+    }
+
     //
     // In a real production (XDP/QTIP+XDP) scenario, we never have to loop more than once
     // because server admins will ensure whatever port they are binding to is available.
@@ -219,6 +253,10 @@ CxPlatSocketDelete(
     _In_ CXPLAT_SOCKET* Socket
     )
 {
+    if (Socket->IsMemorySocket) {
+        MemorySocketDelete(Socket);
+        return;
+    }
     if (Socket->RawSocketAvailable) {
         RawSocketDelete(CxPlatSocketToRaw(Socket));
     }
@@ -280,6 +318,10 @@ CxPlatRecvDataReturn(
     if (RecvDataChain == NULL) {
         return;
     }
+    if (RecvDataChain->DatapathType == CXPLAT_DATAPATH_TYPE_MEMORY) {
+        MemoryRecvDataReturn(RecvDataChain);
+        return;
+    }
     CXPLAT_DBG_ASSERT(
         RecvDataChain->DatapathType == CXPLAT_DATAPATH_TYPE_NORMAL ||
         RecvDataChain->DatapathType == CXPLAT_DATAPATH_TYPE_RAW);
@@ -297,7 +339,9 @@ CxPlatSendDataAlloc(
 {
     CXPLAT_SEND_DATA* SendData = NULL;
     // TODO: fallback?
-    if (Config->Route->DatapathType == CXPLAT_DATAPATH_TYPE_RAW ||
+    if (Socket->IsMemorySocket) {
+        SendData = MemorySendDataAlloc(Socket, Config);
+    } else if (Config->Route->DatapathType == CXPLAT_DATAPATH_TYPE_RAW ||
         (Config->Route->DatapathType == CXPLAT_DATAPATH_TYPE_UNKNOWN &&
         Socket->RawSocketAvailable && !IS_LOOPBACK(Config->Route->RemoteAddress))) {
         SendData = RawSendDataAlloc(Config);
@@ -313,6 +357,10 @@ CxPlatSendDataFree(
     _In_ CXPLAT_SEND_DATA* SendData
     )
 {
+    if (DatapathType(SendData) == CXPLAT_DATAPATH_TYPE_MEMORY) {
+        MemorySendDataFree(SendData);
+        return;
+    }
     CXPLAT_DBG_ASSERT(
         DatapathType(SendData) == CXPLAT_DATAPATH_TYPE_NORMAL ||
         DatapathType(SendData) == CXPLAT_DATAPATH_TYPE_RAW);
@@ -328,6 +376,9 @@ CxPlatSendDataAllocBuffer(
     _In_ uint16_t MaxBufferLength
     )
 {
+    if (DatapathType(SendData) == CXPLAT_DATAPATH_TYPE_MEMORY) {
+        return MemorySendDataAllocBuffer(SendData, MaxBufferLength);
+    }
     CXPLAT_DBG_ASSERT(
         DatapathType(SendData) == CXPLAT_DATAPATH_TYPE_NORMAL ||
         DatapathType(SendData) == CXPLAT_DATAPATH_TYPE_RAW);
@@ -343,6 +394,10 @@ CxPlatSendDataFreeBuffer(
     _In_ QUIC_BUFFER* Buffer
     )
 {
+    if (DatapathType(SendData) == CXPLAT_DATAPATH_TYPE_MEMORY) {
+        MemorySendDataFreeBuffer(SendData, Buffer);
+        return;
+    }
     CXPLAT_DBG_ASSERT(
         DatapathType(SendData) == CXPLAT_DATAPATH_TYPE_NORMAL ||
         DatapathType(SendData) == CXPLAT_DATAPATH_TYPE_RAW);
@@ -356,6 +411,9 @@ CxPlatSendDataIsFull(
     _In_ CXPLAT_SEND_DATA* SendData
     )
 {
+    if (DatapathType(SendData) == CXPLAT_DATAPATH_TYPE_MEMORY) {
+        return MemorySendDataIsFull(SendData);
+    }
     CXPLAT_DBG_ASSERT(
         DatapathType(SendData) == CXPLAT_DATAPATH_TYPE_NORMAL ||
         DatapathType(SendData) == CXPLAT_DATAPATH_TYPE_RAW);
@@ -373,6 +431,8 @@ CxPlatSocketSend(
 {
     if (DatapathType(SendData) == CXPLAT_DATAPATH_TYPE_NORMAL) {
         SocketSend(Socket, Route, SendData);
+     } else if (DatapathType(SendData) == CXPLAT_DATAPATH_TYPE_MEMORY) {
+        MemorySocketSend(Socket, Route, SendData);
      } else {
         CXPLAT_DBG_ASSERT(DatapathType(SendData) == CXPLAT_DATAPATH_TYPE_RAW);
         RawSocketSend(CxPlatSocketToRaw(Socket), Route, SendData);
@@ -389,7 +449,8 @@ QuicCopyRouteInfo(
     if (SrcRoute->DatapathType == CXPLAT_DATAPATH_TYPE_RAW) {
         CxPlatCopyMemory(DstRoute, SrcRoute, (uint8_t*)&SrcRoute->State - (uint8_t*)SrcRoute);
         CxPlatUpdateRoute(DstRoute, SrcRoute);
-    } else if (SrcRoute->DatapathType == CXPLAT_DATAPATH_TYPE_NORMAL) {
+    } else if (SrcRoute->DatapathType == CXPLAT_DATAPATH_TYPE_NORMAL ||
+               SrcRoute->DatapathType == CXPLAT_DATAPATH_TYPE_MEMORY) {
         *DstRoute = *SrcRoute;
     } else {
         CXPLAT_DBG_ASSERT(FALSE);
@@ -40,6 +40,15 @@ Notes:
     hash table now has information about the location, and does not have to
     traverse the hash table chains again.
 
+    Tables created with CXPLAT_HASH_OPEN_ADDRESSING use a separate, flat
+    backend instead (see the end of this file). Each slot holds the signature
+    and entry pointer, and a parallel array of control bytes holds either a
+    7-bit fragment of the mixed signature or an EMPTY/DELETED marker. Control
+    bytes are compared 16 at a time (one SSE2 compare where available), so a
+    lookup usually reads a single cache line of control bytes plus the one slot
+    that matches. Groups of 16 are probed quadratically and the table doubles
+    (or is rehashed in place to drop tombstones) once it is 7/8 used.
+
 --*/
 
 #include "platform_internal.h"
@@ -47,6 +56,11 @@ Notes:
 #include "hashtable.c.clog.h"
 #endif
 
+#if defined(_M_X64) || defined(_M_AMD64) || defined(__SSE2__)
+#include <emmintrin.h>
+#define CXPLAT_HASH_OA_SSE2 1
+#endif
+
 #define CXPLAT_HASH_RESERVED_SIGNATURE 0
 
 //
@@ -77,6 +91,31 @@ Notes:
 
 #define BASE_HASH_TABLE_SIZE HT_SECOND_LEVEL_DIR_MIN_SIZE
 
+//
+// Open addressing tables are probed in groups of control bytes. A control byte
+// is either EMPTY, DELETED (a tombstone) or, for a full slot, the low 7 bits of
+// the mixed signature; so the high bit is set exactly for free slots.
+//
+#define CXPLAT_HASH_OA_GROUP_SIZE   16
+#define CXPLAT_HASH_OA_CTRL_EMPTY   ((uint8_t)0x80)
+#define CXPLAT_HASH_OA_CTRL_DELETED ((uint8_t)0xFE)
+#define CXPLAT_HASH_OA_MAX_SIZE     (1u << 27)
+
+//
+// Open addressing tables are resized once full and deleted slots make up 7/8
+// of the table.
+//
+#define CXPLAT_HASH_OA_MAX_USED(Size) ((Size) - ((Size) / 8))
+
+CXPLAT_STATIC_ASSERT(
+    CXPLAT_HASH_OPEN_ADDRESSING_MIN_SIZE >= CXPLAT_HASH_OA_GROUP_SIZE,
+    "Open addressing tables must hold at least one group");
+
+typedef struct CXPLAT_HASHTABLE_OA_SLOT {
+    uint64_t Signature;
+    CXPLAT_HASHTABLE_ENTRY* Entry;
+} CXPLAT_HASHTABLE_OA_SLOT;
+
 CXPLAT_STATIC_ASSERT(
     CXPLAT_HASH_MIN_SIZE == BASE_HASH_TABLE_SIZE,
     "Hash table sizes should match!");
@@ -120,6 +159,43 @@ CxPlatHashTableExpand(
     _Inout_ CXPLAT_HASHTABLE* HashTable
     );
 
+static
+BOOLEAN
+CxPlatHashtableOaInitialize(
+    _Inout_ CXPLAT_HASHTABLE* HashTable,
+    _In_ uint32_t InitialSize
+    );
+
+static
+BOOLEAN
+CxPlatHashtableOaInsert(
+    _In_ CXPLAT_HASHTABLE* HashTable,
+    _In_ CXPLAT_HASHTABLE_ENTRY* Entry,
+    _In_ uint64_t Signature
+    );
+
+static
+void
+CxPlatHashtableOaRemove(
+    _In_ CXPLAT_HASHTABLE* HashTable,
+    _In_ CXPLAT_HASHTABLE_ENTRY* Entry
+    );
+
+static
+CXPLAT_HASHTABLE_ENTRY*
+CxPlatHashtableOaLookup(
+    _In_ const CXPLAT_HASHTABLE* HashTable,
+    _Inout_ CXPLAT_HASHTABLE_LOOKUP_CONTEXT* Context,
+    _In_ uint32_t SkipMask
+    );
+
+static
+CXPLAT_HASHTABLE_ENTRY*
+CxPlatHashtableOaEnumerateNext(
+    _In_ const CXPLAT_HASHTABLE* HashTable,
+    _Inout_ CXPLAT_HASHTABLE_ENUMERATOR* Enumerator
+    );
+
 #ifndef BitScanReverse
 static
 uint8_t
@@ -472,6 +548,19 @@ CxPlatHashtableInitialize(
         CXPLAT_HASHTABLE* *HashTable,
     _In_ uint32_t InitialSize
     )
+{
+    return CxPlatHashtableInitializeWithFlags(HashTable, InitialSize, 0);
+}
+
+_Must_inspect_result_
+_Success_(return != FALSE)
+BOOLEAN
+CxPlatHashtableInitializeWithFlags(
+    _Inout_ _When_(NULL == *HashTable, _At_(*HashTable, __drv_allocatesMem(Mem) _Post_notnull_))
+        CXPLAT_HASHTABLE* *HashTable,
+    _In_ uint32_t InitialSize,
+    _In_ uint32_t Flags
+    )
 /*++
 
 Routine Description:
@@ -491,7 +580,10 @@ Arguments:
         which case a CXPLAT_HASHTABLE will be allocated, or can contain a
         pre-allocated CXPLAT_HASHTABLE.
 
-    InitialSize - The initial size of the hash table in number of buckets.
+    InitialSize - The initial size of the hash table in number of buckets (or
+        slots, for open addressing tables).
+
+    Flags - Either 0 or CXPLAT_HASH_OPEN_ADDRESSING.
 
 Return Value:
 
@@ -499,10 +591,21 @@ Return Value:
 
 --*/
 {
+    if ((Flags & ~CXPLAT_HASH_OPEN_ADDRESSING) != 0) {
+        return FALSE;
+    }
+
     //
     // Initial size must be a power of two and within the allowed range.
     //
-    if (!IS_POWER_OF_TWO(InitialSize) ||
+    if (Flags & CXPLAT_HASH_OPEN_ADDRESSING) {
+        if (!IS_POWER_OF_TWO(InitialSize) ||
+            (InitialSize > CXPLAT_HASH_OA_MAX_SIZE) ||
+            (InitialSize < CXPLAT_HASH_OPEN_ADDRESSING_MIN_SIZE)) {
+            return FALSE;
+        }
+    } else if (
+        !IS_POWER_OF_TWO(InitialSize) ||
         (InitialSize > MAX_HASH_TABLE_SIZE) ||
         (InitialSize < BASE_HASH_TABLE_SIZE)) {
         return FALSE;
@@ -531,7 +634,17 @@ Return Value:
     }
 
     CxPlatZeroMemory(Table, sizeof(CXPLAT_HASHTABLE));
-    Table->Flags = LocalFlags;
+    Table->Flags = LocalFlags | Flags;
+
+    if (Flags & CXPLAT_HASH_OPEN_ADDRESSING) {
+        if (!CxPlatHashtableOaInitialize(Table, InitialSize)) {
+            CxPlatHashtableUninitialize(Table);
+            return FALSE;
+        }
+        *HashTable = Table;
+        return TRUE;
+    }
+
     Table->TableSize = InitialSize;
     Table->DivisorMask = Table->TableSize - 1;
     Table->Pivot = 0;
@@ -645,7 +758,14 @@ Arguments:
     CXPLAT_DBG_ASSERT(HashTable->NumEnumerators == 0);
     CXPLAT_DBG_ASSERT(HashTable->NumEntries == 0);
 
-    if (HashTable->TableSize <= HT_SECOND_LEVEL_DIR_MIN_SIZE) {
+    if (HashTable->Flags & CXPLAT_HASH_OPEN_ADDRESSING) {
+
+        if (HashTable->Control != NULL) {
+            CXPLAT_FREE(HashTable->Control, QUIC_POOL_HASHTABLE_MEMBER);
+            HashTable->Control = NULL;
+        }
+
+    } else if (HashTable->TableSize <= HT_SECOND_LEVEL_DIR_MIN_SIZE) {
 
         if (HashTable->SecondLevelDir != NULL) {
             CXPLAT_FREE(HashTable->SecondLevelDir, QUIC_POOL_HASHTABLE_MEMBER);
@@ -705,7 +825,7 @@ Arguments:
     }
 }
 
-void
+BOOLEAN
 CxPlatHashtableInsert(
     _In_ CXPLAT_HASHTABLE* HashTable,
     _In_ __drv_aliasesMem CXPLAT_HASHTABLE_ENTRY* Entry,
@@ -736,7 +856,13 @@ Arguments:
 
     Signature - Signature of the entry to be inserted.
 
-    Context - Pointer to optional context that can be passed in.
+    Context - Pointer to optional context that can be passed in. Ignored by
+        open addressing tables.
+
+Return Value:
+
+    TRUE if the entry was inserted. Only open addressing tables can return
+    FALSE, when the table is full and could not be grown.
 
 --*/
 {
@@ -747,6 +873,10 @@ Arguments:
         Signature = CXPLAT_HASH_ALT_SIGNATURE;
     }
 
+    if (HashTable->Flags & CXPLAT_HASH_OPEN_ADDRESSING) {
+        return CxPlatHashtableOaInsert(HashTable, Entry, Signature);
+    }
+
     Entry->Signature = Signature;
 
     HashTable->NumEntries++;
@@ -789,6 +919,8 @@ Arguments:
         } while ((RestructAttempts > 0) &&
                  (HashTable->NumEntries > CXPLAT_HASHTABLE_MAX_CHAIN_LENGTH * HashTable->NonEmptyBuckets));
     }
+
+    return TRUE;
 }
 
 void
@@ -826,6 +958,11 @@ Arguments:
 
 --*/
 {
+    if (HashTable->Flags & CXPLAT_HASH_OPEN_ADDRESSING) {
+        CxPlatHashtableOaRemove(HashTable, Entry);
+        return;
+    }
+
     uint64_t Signature = Entry->Signature;
 
     CXPLAT_DBG_ASSERT(HashTable->NumEntries > 0);
@@ -918,6 +1055,13 @@ Return Value:
     CXPLAT_HASHTABLE_LOOKUP_CONTEXT* ContextPtr =
         (Context != NULL) ? Context : &LocalContext; // cppcheck-suppress uninitvar
 
+    if (HashTable->Flags & CXPLAT_HASH_OPEN_ADDRESSING) {
+        ContextPtr->ProbeIndex = 0;
+        ContextPtr->SlotIndex = 0;
+        ContextPtr->Signature = Signature;
+        return CxPlatHashtableOaLookup(HashTable, ContextPtr, 0);
+    }
+
     CxPlatPopulateContext(HashTable, ContextPtr, Signature);
 
     CXPLAT_LIST_ENTRY* CurEntry = ContextPtr->PrevLinkage->Flink;
@@ -974,6 +1118,16 @@ Return Value:
 --*/
 {
     CXPLAT_DBG_ASSERT(NULL != Context);
+
+    if (HashTable->Flags & CXPLAT_HASH_OPEN_ADDRESSING) {
+        //
+        // Resume in the group of the last match, skipping it and every slot
+        // before it.
+        //
+        uint32_t Offset = Context->SlotIndex & (CXPLAT_HASH_OA_GROUP_SIZE - 1);
+        return CxPlatHashtableOaLookup(HashTable, Context, (2u << Offset) - 1);
+    }
+
     CXPLAT_DBG_ASSERT(NULL != Context->ChainHead);
     CXPLAT_DBG_ASSERT(Context->PrevLinkage->Flink != Context->ChainHead);
 
@@ -1062,6 +1216,14 @@ Arguments:
 {
     CXPLAT_DBG_ASSERT(Enumerator != NULL);
 
+    if (HashTable->Flags & CXPLAT_HASH_OPEN_ADDRESSING) {
+        HashTable->NumEnumerators++;
+        Enumerator->BucketIndex = 0;
+        Enumerator->ChainHead = NULL;
+        Enumerator->HashEntry.Signature = CXPLAT_HASH_RESERVED_SIGNATURE;
+        return;
+    }
+
     CXPLAT_HASHTABLE_LOOKUP_CONTEXT LocalContext;
     CxPlatPopulateContext(HashTable, &LocalContext, 0);
     HashTable->NumEnumerators++;
@@ -1116,6 +1278,11 @@ Return Value:
 --*/
 {
     CXPLAT_DBG_ASSERT(Enumerator != NULL);
+
+    if (HashTable->Flags & CXPLAT_HASH_OPEN_ADDRESSING) {
+        return CxPlatHashtableOaEnumerateNext(HashTable, Enumerator);
+    }
+
     CXPLAT_DBG_ASSERT(Enumerator->ChainHead != NULL);
     CXPLAT_DBG_ASSERT(CXPLAT_HASH_RESERVED_SIGNATURE == Enumerator->HashEntry.Signature);
 
@@ -1202,6 +1369,11 @@ Arguments:
     CXPLAT_DBG_ASSERT(HashTable->NumEnumerators > 0);
     HashTable->NumEnumerators--;
 
+    if (HashTable->Flags & CXPLAT_HASH_OPEN_ADDRESSING) {
+        Enumerator->ChainHead = NULL;
+        return;
+    }
+
     if (!CxPlatListIsEmpty(&(Enumerator->HashEntry.Linkage))) {
         CXPLAT_DBG_ASSERT(Enumerator->ChainHead != NULL);
 
@@ -1473,3 +1645,340 @@ CxPlatHashTableContract(
 }
 
 #endif // CXPLAT_HASHTABLE_CONTRACT_SUPPORT
+
+//
+// Open addressing backend.
+//
+
+QUIC_INLINE
+CXPLAT_HASHTABLE_OA_SLOT*
+CxPlatHashOaSlots(
+    _In_ const CXPLAT_HASHTABLE* HashTable
+    )
+{
+    //
+    // The slots directly follow the control bytes. Since the table size is a
+    // multiple of the group size, they stay aligned.
+    //
+    return (CXPLAT_HASHTABLE_OA_SLOT*)(HashTable->Control + HashTable->TableSize);
+}
+
+QUIC_INLINE
+QUIC_NO_SANITIZE("unsigned-integer-overflow")
+uint64_t
+CxPlatHashOaMix(
+    _In_ uint64_t Signature
+    )
+{
+    //
+    // Signatures are often small or sequential (stream IDs, ports), so spread
+    // them with a multiplicative hash and fold the high bits back down, since
+    // both the low 7 bits and the group index bits are used.
+    //
+    uint64_t Hash = Signature * 0x9E3779B97F4A7C15ull;
+    return Hash ^ (Hash >> 32);
+}
+
+QUIC_INLINE
+uint32_t
+CxPlatHashOaGroup(
+    _In_ const CXPLAT_HASHTABLE* HashTable,
+    _In_ uint64_t Hash,
+    _In_ uint32_t ProbeIndex
+    )
+{
+    //
+    // Triangular probing over a power of two number of groups visits every
+    // group exactly once.
+    //
+    uint64_t Group = (Hash >> 7) + (((uint64_t)ProbeIndex * (ProbeIndex + 1)) / 2);
+    return (uint32_t)Group & (HashTable->DivisorMask / CXPLAT_HASH_OA_GROUP_SIZE);
+}
+
+//
+// Returns a bitmask of the slots in the group whose control byte equals Value.
+//
+QUIC_INLINE
+uint32_t
+CxPlatHashOaMatch(
+    _In_reads_(CXPLAT_HASH_OA_GROUP_SIZE) const uint8_t* Control,
+    _In_ uint8_t Value
+    )
+{
+#if CXPLAT_HASH_OA_SSE2
+    __m128i Group = _mm_loadu_si128((const __m128i*)Control);
+    return (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(Group, _mm_set1_epi8((char)Value)));
+#else
+    uint32_t Mask = 0;
+    for (uint32_t i = 0; i < CXPLAT_HASH_OA_GROUP_SIZE; ++i) {
+        Mask |= (uint32_t)(Control[i] == Value) << i;
+    }
+    return Mask;
+#endif
+}
+
+//
+// Returns a bitmask of the slots in the group that are EMPTY or DELETED.
+//
+QUIC_INLINE
+uint32_t
+CxPlatHashOaMatchFree(
+    _In_reads_(CXPLAT_HASH_OA_GROUP_SIZE) const uint8_t* Control
+    )
+{
+#if CXPLAT_HASH_OA_SSE2
+    return (uint32_t)_mm_movemask_epi8(_mm_loadu_si128((const __m128i*)Control));
+#else
+    uint32_t Mask = 0;
+    for (uint32_t i = 0; i < CXPLAT_HASH_OA_GROUP_SIZE; ++i) {
+        Mask |= (uint32_t)(Control[i] >> 7) << i;
+    }
+    return Mask;
+#endif
+}
+
+static
+uint32_t
+CxPlatHashOaFindFreeSlot(
+    _In_ const CXPLAT_HASHTABLE* HashTable,
+    _In_ uint64_t Hash
+    )
+{
+    uint32_t GroupCount = HashTable->TableSize / CXPLAT_HASH_OA_GROUP_SIZE;
+    for (uint32_t Probe = 0; Probe < GroupCount; ++Probe) {
+        uint32_t Group = CxPlatHashOaGroup(HashTable, Hash, Probe);
+        uint32_t Free =
+            CxPlatHashOaMatchFree(HashTable->Control + Group * CXPLAT_HASH_OA_GROUP_SIZE);
+        if (Free != 0) {
+            return Group * CXPLAT_HASH_OA_GROUP_SIZE + CxPlatFirstSetBit64(Free);
+        }
+    }
+    CXPLAT_FRE_ASSERTMSG(FALSE, "Open addressing table has no free slot");
+    return 0;
+}
+
+static
+BOOLEAN
+CxPlatHashtableOaAllocate(
+    _Inout_ CXPLAT_HASHTABLE* HashTable,
+    _In_ uint32_t Size
+    )
+{
+    size_t AllocSize =
+        (size_t)Size * (sizeof(uint8_t) + sizeof(CXPLAT_HASHTABLE_OA_SLOT));
+    uint8_t* Control = CXPLAT_ALLOC_NONPAGED(AllocSize, QUIC_POOL_HASHTABLE_MEMBER);
+    if (Control == NULL) {
+        QuicTraceEvent(
+            AllocFailure,
+            "Allocation of '%s' failed. (%llu bytes)",
+            "open addressing slots",
+            AllocSize);
+        return FALSE;
+    }
+
+    memset(Control, CXPLAT_HASH_OA_CTRL_EMPTY, Size);
+    HashTable->Control = Control;
+    HashTable->TableSize = Size;
+    HashTable->DivisorMask = Size - 1;
+    HashTable->NumDeleted = 0;
+    return TRUE;
+}
+
+static
+BOOLEAN
+CxPlatHashtableOaInitialize(
+    _Inout_ CXPLAT_HASHTABLE* HashTable,
+    _In_ uint32_t InitialSize
+    )
+{
+    return CxPlatHashtableOaAllocate(HashTable, InitialSize);
+}
+
+static
+BOOLEAN
+CxPlatHashtableOaResize(
+    _Inout_ CXPLAT_HASHTABLE* HashTable
+    )
+/*++
+
+Routine Description:
+
+    Moves every entry of an open addressing table into a new slot array. The
+    table doubles if at least half of it is in use; otherwise it is rebuilt at
+    the same size, which clears out all the tombstones.
+
+--*/
+{
+    if (HashTable->NumEnumerators > 0) {
+        return FALSE;
+    }
+
+    uint32_t NewSize = HashTable->TableSize;
+    if (HashTable->NumEntries >= HashTable->TableSize / 2) {
+        if (HashTable->TableSize == CXPLAT_HASH_OA_MAX_SIZE) {
+            return FALSE;
+        }
+        NewSize *= 2;
+    }
+
+    uint8_t* OldControl = HashTable->Control;
+    CXPLAT_HASHTABLE_OA_SLOT* OldSlots = CxPlatHashOaSlots(HashTable);
+    uint32_t OldSize = HashTable->TableSize;
+
+    if (!CxPlatHashtableOaAllocate(HashTable, NewSize)) {
+        return FALSE;
+    }
+
+    CXPLAT_HASHTABLE_OA_SLOT* Slots = CxPlatHashOaSlots(HashTable);
+    for (uint32_t i = 0; i < OldSize; ++i) {
+        if (OldControl[i] & 0x80) {
+            continue;
+        }
+        uint64_t Hash = CxPlatHashOaMix(OldSlots[i].Signature);
+        uint32_t Slot = CxPlatHashOaFindFreeSlot(HashTable, Hash);
+        HashTable->Control[Slot] = OldControl[i];
+        Slots[Slot] = OldSlots[i];
+    }
+
+    CXPLAT_FREE(OldControl, QUIC_POOL_HASHTABLE_MEMBER);
+    return TRUE;
+}
+
+static
+BOOLEAN
+CxPlatHashtableOaInsert(
+    _In_ CXPLAT_HASHTABLE* HashTable,
+    _In_ CXPLAT_HASHTABLE_ENTRY* Entry,
+    _In_ uint64_t Signature
+    )
+{
+    if (HashTable->NumEntries + HashTable->NumDeleted >=
+        CXPLAT_HASH_OA_MAX_USED(HashTable->TableSize)) {
+        //
+        // Growing is best effort. As long as there is a free slot left, the
+        // insert still succeeds (with longer probes) and the next insert tries
+        // again.
+        //
+        (void)CxPlatHashtableOaResize(HashTable);
+        if (HashTable->NumEntries == HashTable->TableSize) {
+            return FALSE;
+        }
+    }
+
+    uint64_t Hash = CxPlatHashOaMix(Signature);
+    uint32_t Slot = CxPlatHashOaFindFreeSlot(HashTable, Hash);
+    if (HashTable->Control[Slot] == CXPLAT_HASH_OA_CTRL_DELETED) {
+        HashTable->NumDeleted--;
+    }
+
+    Entry->Signature = Signature;
+    HashTable->Control[Slot] = (uint8_t)(Hash & 0x7F);
+    CxPlatHashOaSlots(HashTable)[Slot].Signature = Signature;
+    CxPlatHashOaSlots(HashTable)[Slot].Entry = Entry;
+    HashTable->NumEntries++;
+    return TRUE;
+}
+
+static
+CXPLAT_HASHTABLE_ENTRY*
+CxPlatHashtableOaLookup(
+    _In_ const CXPLAT_HASHTABLE* HashTable,
+    _Inout_ CXPLAT_HASHTABLE_LOOKUP_CONTEXT* Context,
+    _In_ uint32_t SkipMask
+    )
+/*++
+
+Routine Description:
+
+    Finds the next slot holding Context->Signature, starting at the group
+    Context->ProbeIndex and ignoring the slots of that group in SkipMask. The
+    search ends at the first group with an EMPTY slot, since an insert would
+    never have probed past it.
+
+--*/
+{
+    const CXPLAT_HASHTABLE_OA_SLOT* Slots = CxPlatHashOaSlots(HashTable);
+    uint64_t Hash = CxPlatHashOaMix(Context->Signature);
+    uint8_t Fragment = (uint8_t)(Hash & 0x7F);
+    uint32_t GroupCount = HashTable->TableSize / CXPLAT_HASH_OA_GROUP_SIZE;
+
+    for (uint32_t Probe = Context->ProbeIndex; Probe < GroupCount; ++Probe) {
+        uint32_t Group = CxPlatHashOaGroup(HashTable, Hash, Probe);
+        const uint8_t* Control = HashTable->Control + Group * CXPLAT_HASH_OA_GROUP_SIZE;
+
+        uint32_t Match = CxPlatHashOaMatch(Control, Fragment) & ~SkipMask;
+        SkipMask = 0;
+        while (Match != 0) {
+            uint32_t Slot = Group * CXPLAT_HASH_OA_GROUP_SIZE + CxPlatFirstSetBit64(Match);
+            if (Slots[Slot].Signature == Context->Signature) {
+                Context->ProbeIndex = Probe;
+                Context->SlotIndex = Slot;
+                return Slots[Slot].Entry;
+            }
+            Match &= Match - 1;
+        }
+
+        if (CxPlatHashOaMatch(Control, CXPLAT_HASH_OA_CTRL_EMPTY) != 0) {
+            break;
+        }
+    }
+
+    return NULL;
+}
+
+static
+void
+CxPlatHashtableOaRemove(
+    _In_ CXPLAT_HASHTABLE* HashTable,
+    _In_ CXPLAT_HASHTABLE_ENTRY* Entry
+    )
+{
+    CXPLAT_HASHTABLE_LOOKUP_CONTEXT Context;
+    Context.ProbeIndex = 0;
+    Context.SlotIndex = 0;
+    Context.Signature = Entry->Signature;
+
+    CXPLAT_HASHTABLE_ENTRY* Found = CxPlatHashtableOaLookup(HashTable, &Context, 0);
+    while (Found != Entry) {
+        CXPLAT_FRE_ASSERTMSG(Found != NULL, "Removing entry not in the hash table");
+        uint32_t Offset = Context.SlotIndex & (CXPLAT_HASH_OA_GROUP_SIZE - 1);
+        Found = CxPlatHashtableOaLookup(HashTable, &Context, (2u << Offset) - 1);
+    }
+
+    CXPLAT_DBG_ASSERT(HashTable->NumEntries > 0);
+    HashTable->NumEntries--;
+
+    //
+    // If the group still has an EMPTY slot, no probe sequence ever continued
+    // past it, so this slot can become EMPTY too. Otherwise leave a tombstone
+    // so later entries in the same probe sequences remain reachable.
+    //
+    uint32_t Group = Context.SlotIndex & ~(CXPLAT_HASH_OA_GROUP_SIZE - 1);
+    if (CxPlatHashOaMatch(HashTable->Control + Group, CXPLAT_HASH_OA_CTRL_EMPTY) != 0) {
+        HashTable->Control[Context.SlotIndex] = CXPLAT_HASH_OA_CTRL_EMPTY;
+    } else {
+        HashTable->Control[Context.SlotIndex] = CXPLAT_HASH_OA_CTRL_DELETED;
+        HashTable->NumDeleted++;
+    }
+}
+
+static
+CXPLAT_HASHTABLE_ENTRY*
+CxPlatHashtableOaEnumerateNext(
+    _In_ const CXPLAT_HASHTABLE* HashTable,
+    _Inout_ CXPLAT_HASHTABLE_ENUMERATOR* Enumerator
+    )
+{
+    //
+    // Entries never move while an enumerator is active (resizing is blocked),
+    // so the slot index is a stable cursor even if entries are removed.
+    //
+    for (uint32_t i = Enumerator->BucketIndex; i < HashTable->TableSize; ++i) {
+        if ((HashTable->Control[i] & 0x80) == 0) {
+            Enumerator->BucketIndex = i + 1;
+            return CxPlatHashOaSlots(HashTable)[i].Entry;
+        }
+    }
+    Enumerator->BucketIndex = HashTable->TableSize;
+    return NULL;
+}
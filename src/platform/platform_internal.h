@@ -61,6 +61,11 @@ typedef struct CXPLAT_DATAPATH_COMMON {
     CXPLAT_DATAPATH_FEATURES Features;
 
     CXPLAT_DATAPATH_RAW* RawDataPath;
+
+    //
+    // The in-process memory datapath, if enabled. All UDP sockets use it.
+    //
+    CXPLAT_DATAPATH_MEMORY* MemoryDataPath;
 } CXPLAT_DATAPATH_COMMON;
 
 typedef struct CXPLAT_SOCKET_COMMON {
@@ -88,6 +93,11 @@ typedef struct CXPLAT_SOCKET_COMMON {
     // The local interface's MTU.
     //
     uint16_t Mtu;
+
+    //
+    // Indicates the socket belongs to the in-process memory datapath.
+    //
+    BOOLEAN IsMemorySocket;
 } CXPLAT_SOCKET_COMMON;
 
 typedef struct CXPLAT_SEND_DATA_COMMON {
@@ -118,6 +128,7 @@ typedef enum CXPLAT_DATAPATH_TYPE {
     CXPLAT_DATAPATH_TYPE_UNKNOWN = 0,
     CXPLAT_DATAPATH_TYPE_NORMAL,
     CXPLAT_DATAPATH_TYPE_RAW, // currently raw == xdp
+    CXPLAT_DATAPATH_TYPE_MEMORY,
 } CXPLAT_DATAPATH_TYPE;
 
 typedef enum CXPLAT_SOCKET_TYPE {
@@ -718,6 +729,113 @@ CxPlatCryptUninitialize(
     void
     );
 
+//
+// Tracks the out of line plain text (CXPLAT_CRYPT_SOURCE) of a packet being
+// encrypted. Providers pull each chunk's source bytes into the buffer just
+// before encrypting that chunk, so the plain text is read from its source once
+// and is still in L1 when it's overwritten with the cipher text.
+//
+typedef struct CXPLAT_CRYPT_GATHER {
+    const CXPLAT_CRYPT_SOURCE* Sources;
+    uint8_t Count;
+    uint8_t Index;
+
+    //
+    // The number of bytes of Sources[Index] already copied.
+    //
+    uint16_t Copied;
+} CXPLAT_CRYPT_GATHER;
+
+QUIC_INLINE
+void
+CxPlatCryptGatherInit(
+    _Out_ CXPLAT_CRYPT_GATHER* Gather,
+    _In_ uint8_t SourceCount,
+    _In_reads_opt_(SourceCount) const CXPLAT_CRYPT_SOURCE* Sources
+    )
+{
+    Gather->Sources = Sources;
+    Gather->Count = SourceCount;
+    Gather->Index = 0;
+    Gather->Copied = 0;
+}
+
+//
+// Copies any source bytes that belong before End into Buffer.
+//
+QUIC_INLINE
+void
+CxPlatCryptGather(
+    _Inout_opt_ CXPLAT_CRYPT_GATHER* Gather,
+    _Inout_ uint8_t* Buffer,
+    _In_ uint32_t End
+    )
+{
+    if (Gather == NULL) {
+        return;
+    }
+    while (Gather->Index < Gather->Count) {
+        const CXPLAT_CRYPT_SOURCE* Source = &Gather->Sources[Gather->Index];
+        const uint32_t Start = (uint32_t)Source->Offset + Gather->Copied;
+        if (Start >= End) {
+            break;
+        }
+        const uint32_t SourceEnd = (uint32_t)Source->Offset + Source->Length;
+        const uint32_t Stop = CXPLAT_MIN(End, SourceEnd);
+        CxPlatCopyMemory(Buffer + Start, Source->Buffer + Gather->Copied, Stop - Start);
+        if (Stop != SourceEnd) {
+            Gather->Copied = (uint16_t)(Stop - Source->Offset);
+            break;
+        }
+        Gather->Index++;
+        Gather->Copied = 0;
+    }
+}
+
+#ifdef CXPLAT_NATIVE_CRYPTO
+
+//
+// Built-in vectorized ChaCha20 header protection (crypt_native.c).
+//
+
+typedef struct CXPLAT_NATIVE_HP_KEY CXPLAT_NATIVE_HP_KEY;
+
+void
+CxPlatNativeCryptInitialize(
+    void
+    );
+
+//
+// Returns QUIC_STATUS_NOT_SUPPORTED if the CPU (or the currently enabled
+// features) can't compute the masks natively, or if EVP is faster for them.
+//
+QUIC_STATUS
+CxPlatNativeHpKeyCreate(
+    _In_ CXPLAT_AEAD_TYPE AeadType,
+    _When_(AeadType == CXPLAT_AEAD_AES_128_GCM, _In_reads_(16))
+    _When_(AeadType == CXPLAT_AEAD_AES_256_GCM, _In_reads_(32))
+    _When_(AeadType == CXPLAT_AEAD_CHACHA20_POLY1305, _In_reads_(32))
+        const uint8_t* const RawKey,
+    _Out_ CXPLAT_NATIVE_HP_KEY** NewKey
+    );
+
+void
+CxPlatNativeHpKeyFree(
+    _In_opt_ CXPLAT_NATIVE_HP_KEY* Key
+    );
+
+void
+CxPlatNativeHpComputeMask(
+    _In_ const CXPLAT_NATIVE_HP_KEY* Key,
+    _In_ uint8_t BatchSize,
+    _In_reads_bytes_(CXPLAT_HP_SAMPLE_LENGTH * BatchSize)
+        const uint8_t* const Cipher,
+    _Out_writes_bytes_(CXPLAT_HP_SAMPLE_LENGTH * BatchSize)
+        uint8_t* Mask
+    );
+
+#endif // CXPLAT_NATIVE_CRYPTO
+
 //
 // Queries the raw datapath stack for the total size needed to allocate the
 // datapath structure.
@@ -795,6 +913,29 @@ typedef struct QUIC_CACHEALIGN CXPLAT_SOCKET_CONTEXT {
     //
     CXPLAT_LOCK TxQueueLock;
 
+#ifndef CXPLAT_USE_IO_URING
+    //
+    // The head of list containing all MSG_ZEROCOPY sends whose buffers the
+    // kernel may still reference, in the order they were sent. Protected by
+    // TxQueueLock.
+    //
+    CXPLAT_LIST_ENTRY ZeroCopyQueue;
+
+    //
+    // The kernel's completion notification ID for the next MSG_ZEROCOPY send.
+    // Protected by TxQueueLock.
+    //
+    uint32_t ZeroCopyNextId;
+#endif
+
+    //
+    // The number of zero-copy sends, and of those the kernel released.
+    // Protected by TxQueueLock with epoll; only updated on the socket's event
+    // thread with io_uring.
+    //
+    uint64_t ZeroCopySends;
+    uint64_t ZeroCopySendsCompleted;
+
     //
     // Rundown for synchronizing clean up with upcalls.
     //
@@ -819,6 +960,18 @@ typedef struct QUIC_CACHEALIGN CXPLAT_SOCKET_CONTEXT {
     //
     BOOLEAN IoStarted : 1;
 
+    //
+    // Indicates SO_TXTIME is set, so sends may carry a departure time.
+    //
+    BOOLEAN TxTimeEnabled : 1;
+
+#ifndef CXPLAT_USE_IO_URING
+    //
+    // Indicates SO_ZEROCOPY is set, so large sends may use MSG_ZEROCOPY.
+    //
+    BOOLEAN ZeroCopyEnabled : 1;
+#endif
+
 #ifdef CXPLAT_USE_IO_URING
     struct {
         //
@@ -860,6 +1013,11 @@ typedef struct CXPLAT_SOCKET {
     //
     uint32_t RecvBufLen;
 
+    //
+    // The number of entries in SocketContexts.
+    //
+    uint16_t SocketCount;
+
     //
     // Indicates the binding connected to a remote IP address.
     //
@@ -965,9 +1123,13 @@ typedef struct QUIC_CACHEALIGN CXPLAT_DATAPATH_PARTITION {
 
 #ifdef CXPLAT_USE_IO_URING
     //
-    // Backing pool of registered buffers for the SendBlockPool.
+    // Send contexts and buffers registered with the io_uring for zero-copy
+    // sends. Only used if CXPLAT_DATAPATH_FEATURE_SEND_ZEROCOPY is enabled,
+    // and then ahead of the SendBlockPool, which is the fallback when all of
+    // these are in flight.
     //
     CXPLAT_REGISTERED_BUFFER_POOL SendRegisteredBufferPool;
+    CXPLAT_SLIST_ENTRY SendRegisteredFreeList;
 #endif
 
     //
@@ -1025,6 +1187,17 @@ typedef struct CXPLAT_DATAPATH {
     //
     uint32_t RecvBlockSize;
 
+    //
+    // The minimum payload size of a send for it to go out zero-copy. Only used
+    // if CXPLAT_DATAPATH_FEATURE_SEND_ZEROCOPY is enabled.
+    //
+    uint32_t SendZeroCopyThreshold;
+
+    //
+    // The time, in microseconds, to busy poll sockets for. Zero if disabled.
+    //
+    uint32_t BusyPollUs;
+
 #if DEBUG
     uint8_t Uninitialized : 1;
     uint8_t Freed : 1;
@@ -1312,4 +1485,93 @@ RawUpdateRoute(
     _In_ CXPLAT_ROUTE* SrcRoute
     );
 
+//
+// In-process memory datapath (datapath_memory.c).
+//
+
+_IRQL_requires_max_(PASSIVE_LEVEL)
+QUIC_STATUS
+MemoryDataPathInitialize(
+    _In_ uint32_t ClientRecvContextLength,
+    _In_ CXPLAT_DATAPATH* ParentDataPath,
+    _In_ CXPLAT_WORKER_POOL* WorkerPool,
+    _In_opt_ const QUIC_PRIVATE_DATAPATH_EMULATION* Emulation,
+    _Out_ CXPLAT_DATAPATH_MEMORY** DataPath
+    );
+
+_IRQL_requires_max_(PASSIVE_LEVEL)
+void
+MemoryDataPathUninitialize(
+    _In_ CXPLAT_DATAPATH_MEMORY* Datapath
+    );
+
+_IRQL_requires_max_(DISPATCH_LEVEL)
+CXPLAT_DATAPATH_FEATURES
+MemoryDataPathGetSupportedFeatures(
+    _In_ CXPLAT_DATAPATH_MEMORY* Datapath
+    );
+
+_IRQL_requires_max_(PASSIVE_LEVEL)
+QUIC_STATUS
+MemorySocketCreateUdp(
+    _In_ CXPLAT_DATAPATH* Datapath,
+    _In_ const CXPLAT_UDP_CONFIG* Config,
+    _Out_ CXPLAT_SOCKET** NewSocket
+    );
+
+_IRQL_requires_max_(PASSIVE_LEVEL)
+void
+MemorySocketDelete(
+    _In_ CXPLAT_SOCKET* Socket
+    );
+
+_IRQL_requires_max_(DISPATCH_LEVEL)
+void
+MemoryRecvDataReturn(
+    _In_ CXPLAT_RECV_DATA* RecvDataChain
+    );
+
+_IRQL_requires_max_(DISPATCH_LEVEL)
+_Success_(return != NULL)
+CXPLAT_SEND_DATA*
+MemorySendDataAlloc(
+    _In_ CXPLAT_SOCKET* Socket,
+    _Inout_ CXPLAT_SEND_CONFIG* Config
+    );
+
+_IRQL_requires_max_(DISPATCH_LEVEL)
+void
+MemorySendDataFree(
+    _In_ CXPLAT_SEND_DATA* SendData
+    );
+
+_IRQL_requires_max_(DISPATCH_LEVEL)
+_Success_(return != NULL)
+QUIC_BUFFER*
+MemorySendDataAllocBuffer(
+    _In_ CXPLAT_SEND_DATA* SendData,
+    _In_ uint16_t MaxBufferLength
+    );
+
+_IRQL_requires_max_(DISPATCH_LEVEL)
+void
+MemorySendDataFreeBuffer(
+    _In_ CXPLAT_SEND_DATA* SendData,
+    _In_ QUIC_BUFFER* Buffer
+    );
+
+_IRQL_requires_max_(DISPATCH_LEVEL)
+BOOLEAN
+MemorySendDataIsFull(
+    _In_ CXPLAT_SEND_DATA* SendData
+    );
+
+_IRQL_requires_max_(DISPATCH_LEVEL)
+void
+MemorySocketSend(
+    _In_ CXPLAT_SOCKET* Socket,
+    _In_ const CXPLAT_ROUTE* Route,
+    _In_ CXPLAT_SEND_DATA* SendData
+    );
+
 #endif // CX_PLATFORM_LINUX || _WIN32
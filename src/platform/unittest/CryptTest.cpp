@@ -529,6 +529,75 @@ TEST_F(CryptTest, HpMaskAes128)
     CxPlatHpKeyFree(HpKey);
 }
 
+//
+// The benchmarks take several seconds each, so they are only run explicitly
+// (--gtest_also_run_disabled_tests).
+//
+
+TEST_P(CryptTest, DISABLED_HpMaskBenchmark)
+{
+    int AEAD = GetParam();
+
+    const uint8_t BatchSize = 8;
+    const uint32_t Iterations = 100000;
+
+    uint8_t RawKey[32];
+    uint8_t Samples[CXPLAT_HP_SAMPLE_LENGTH * BatchSize];
+    uint8_t Mask[CXPLAT_HP_SAMPLE_LENGTH * BatchSize];
+    CxPlatRandom(sizeof(RawKey), RawKey);
+    CxPlatRandom(sizeof(Samples), Samples);
+
+#ifdef CXPLAT_NATIVE_CRYPTO
+    const uint32_t SavedFeatures = CxPlatCryptGetNativeFeatures();
+    const uint32_t FeatureSets[] = { UINT32_MAX, 0 };
+#else
+    const uint32_t FeatureSets[] = { 0 };
+#endif
+
+    for (uint32_t Features : FeatureSets) {
+#ifdef CXPLAT_NATIVE_CRYPTO
+        CxPlatCryptSetNativeFeatures(Features);
+        Features = CxPlatCryptGetNativeFeatures();
+#endif
+        CXPLAT_HP_KEY* HpKey = nullptr;
+        QUIC_STATUS Status = CxPlatHpKeyCreate((CXPLAT_AEAD_TYPE)AEAD, RawKey, &HpKey);
+        if (Status == QUIC_STATUS_NOT_SUPPORTED) {
+            GTEST_SKIP_(": AEAD Type unsupported");
+        }
+        VERIFY_QUIC_SUCCESS(Status);
+
+        uint64_t Start = CxPlatTimeUs64();
+        for (uint32_t j = 0; j < Iterations; ++j) {
+            for (uint8_t i = 0; i < BatchSize; ++i) {
+                VERIFY_QUIC_SUCCESS(
+                    CxPlatHpComputeMask(
+                        HpKey,
+                        1,
+                        Samples + i * CXPLAT_HP_SAMPLE_LENGTH,
+                        Mask + i * CXPLAT_HP_SAMPLE_LENGTH));
+            }
+        }
+        const uint64_t SingleUs = CxPlatTimeDiff64(Start, CxPlatTimeUs64());
+
+        Start = CxPlatTimeUs64();
+        for (uint32_t j = 0; j < Iterations; ++j) {
+            VERIFY_QUIC_SUCCESS(CxPlatHpComputeMask(HpKey, BatchSize, Samples, Mask));
+        }
+        const uint64_t BatchUs = CxPlatTimeDiff64(Start, CxPlatTimeUs64());
+
+        CxPlatHpKeyFree(HpKey);
+
+        const double Masks = (double)Iterations * BatchSize;
+        const std::string Prefix = "Features" + std::to_string(Features);
+        RecordBenchmarkResult(Prefix + "SingleNsPerMask", SingleUs * 1000.0 / Masks);
+        RecordBenchmarkResult(Prefix + "BatchNsPerMask", BatchUs * 1000.0 / Masks);
+    }
+
+#ifdef CXPLAT_NATIVE_CRYPTO
+    CxPlatCryptSetNativeFeatures(SavedFeatures);
+#endif
+}
+
 TEST_F(CryptTest, KbKdfDerive)
 {
     QuicBuffer Key256("3edc6b5b8f7aadbd713732b482b8f979286e1ea3b8f8f99c30c884cfe3349b83");
@@ -619,6 +688,361 @@ TEST_P(CryptTest, Encryption)
     ASSERT_FALSE(Key.Decrypt(Iv, sizeof(AuthData), AuthData, sizeof(Buffer), Buffer));
 }
 
+TEST_P(CryptTest, EncryptionBatch)
+{
+    int AEAD = GetParam();
+
+    const uint8_t BatchSize = 8;
+    const uint16_t HeaderLength = 13;
+    const uint16_t PacketLength = 1200;
+
+    uint8_t RawKey[32];
+    CxPlatRandom(sizeof(RawKey), RawKey);
+    QuicKey Key((CXPLAT_AEAD_TYPE)AEAD, RawKey);
+    if (Key.Ptr == NULL) return;
+
+    uint8_t Iv[BatchSize][CXPLAT_MAX_IV_LENGTH];
+    uint8_t Packets[BatchSize][PacketLength];
+    uint8_t Expected[BatchSize][PacketLength];
+    CXPLAT_CRYPT_BATCH_ENTRY Batch[BatchSize];
+    for (uint8_t i = 0; i < BatchSize; ++i) {
+        CxPlatRandom(CXPLAT_IV_LENGTH, Iv[i]);
+        CxPlatRandom(PacketLength, Packets[i]);
+        memcpy(Expected[i], Packets[i], PacketLength);
+        ASSERT_TRUE(
+            Key.Encrypt(
+                Iv[i],
+                HeaderLength,
+                Expected[i],
+                PacketLength - HeaderLength,
+                Expected[i] + HeaderLength));
+
+        Batch[i].Iv = Iv[i];
+        Batch[i].AuthData = Packets[i];
+        Batch[i].AuthDataLength = HeaderLength;
+        Batch[i].Buffer = Packets[i] + HeaderLength;
+        Batch[i].BufferLength = PacketLength - HeaderLength;
+        Batch[i].Sources = NULL;
+        Batch[i].SourceCount = 0;
+    }
+
+    //
+    // The batch must produce exactly what individual calls do.
+    //
+    VERIFY_QUIC_SUCCESS(CxPlatEncryptBatch(Key.Ptr, BatchSize, Batch));
+    for (uint8_t i = 0; i < BatchSize; ++i) {
+        ASSERT_EQ(QUIC_STATUS_SUCCESS, Batch[i].Status);
+        ASSERT_EQ(0, memcmp(Expected[i], Packets[i], PacketLength));
+    }
+
+    //
+    // A corrupted packet only fails its own entry.
+    //
+    Packets[3][PacketLength - 1] ^= 1;
+    ASSERT_TRUE(QUIC_FAILED(CxPlatDecryptBatch(Key.Ptr, BatchSize, Batch)));
+    for (uint8_t i = 0; i < BatchSize; ++i) {
+        if (i == 3) {
+            ASSERT_TRUE(QUIC_FAILED(Batch[i].Status));
+        } else {
+            ASSERT_EQ(QUIC_STATUS_SUCCESS, Batch[i].Status);
+            ASSERT_TRUE(
+                Key.Decrypt(
+                    Iv[i],
+                    HeaderLength,
+                    Expected[i],
+                    PacketLength - HeaderLength,
+                    Expected[i] + HeaderLength));
+            ASSERT_EQ(
+                0,
+                memcmp(
+                    Expected[i] + HeaderLength,
+                    Packets[i] + HeaderLength,
+                    PacketLength - HeaderLength - CXPLAT_ENCRYPTION_OVERHEAD));
+        }
+    }
+}
+
+TEST_P(CryptTest, DISABLED_EncryptionBatchBenchmark)
+{
+    int AEAD = GetParam();
+
+    const uint8_t BatchSize = 8;
+    const uint16_t HeaderLength = 13;
+    const uint16_t PacketLengths[] = { 1200, 1452, 9000 };
+    const uint32_t BytesPerRun = 64 * 1024 * 1024;
+
+    uint8_t RawKey[32];
+    CxPlatRandom(sizeof(RawKey), RawKey);
+    QuicKey Key((CXPLAT_AEAD_TYPE)AEAD, RawKey);
+    if (Key.Ptr == NULL) return;
+
+    uint8_t Iv[BatchSize][CXPLAT_MAX_IV_LENGTH];
+    CXPLAT_CRYPT_BATCH_ENTRY Batch[BatchSize];
+    std::vector<uint8_t> Packets(BatchSize * 9000);
+    CxPlatRandom((uint32_t)Packets.size(), Packets.data());
+
+    for (uint16_t PacketLength : PacketLengths) {
+        const uint32_t BatchCount = BytesPerRun / (PacketLength * BatchSize);
+        for (uint8_t i = 0; i < BatchSize; ++i) {
+            CxPlatRandom(CXPLAT_IV_LENGTH, Iv[i]);
+            Batch[i].Iv = Iv[i];
+            Batch[i].AuthData = Packets.data() + i * PacketLength;
+            Batch[i].AuthDataLength = HeaderLength;
+            Batch[i].Buffer = Packets.data() + i * PacketLength + HeaderLength;
+            Batch[i].BufferLength = PacketLength - HeaderLength;
+            Batch[i].Sources = NULL;
+            Batch[i].SourceCount = 0;
+        }
+
+        uint64_t Start = CxPlatTimeUs64();
+        for (uint32_t j = 0; j < BatchCount; ++j) {
+            for (uint8_t i = 0; i < BatchSize; ++i) {
+                ASSERT_TRUE(
+                    Key.Encrypt(
+                        Batch[i].Iv,
+                        Batch[i].AuthDataLength,
+                        Batch[i].AuthData,
+                        Batch[i].BufferLength,
+                        Batch[i].Buffer));
+            }
+        }
+        const uint64_t SingleUs = CxPlatTimeDiff64(Start, CxPlatTimeUs64());
+
+        Start = CxPlatTimeUs64();
+        for (uint32_t j = 0; j < BatchCount; ++j) {
+            VERIFY_QUIC_SUCCESS(CxPlatEncryptBatch(Key.Ptr, BatchSize, Batch));
+        }
+        const uint64_t BatchUs = CxPlatTimeDiff64(Start, CxPlatTimeUs64());
+
+        const uint64_t Bytes = (uint64_t)BatchCount * BatchSize * PacketLength;
+        const std::string Prefix = "Packet" + std::to_string(PacketLength);
+        RecordBenchmarkResult(Prefix + "SingleMBps", SingleUs ? (double)Bytes / SingleUs : 0.0);
+        RecordBenchmarkResult(Prefix + "BatchMBps", BatchUs ? (double)Bytes / BatchUs : 0.0);
+    }
+}
+
+TEST_P(CryptTest, KeyPrefersSources)
+{
+    int AEAD = GetParam();
+
+    uint8_t RawKey[32];
+    CxPlatRandom(sizeof(RawKey), RawKey);
+
+    //
+    // Neither EVP nor BCrypt is faster encrypting from the sources.
+    //
+    QuicKey Key((CXPLAT_AEAD_TYPE)AEAD, RawKey);
+    if (Key.Ptr == NULL) return;
+    ASSERT_FALSE(CxPlatKeyPrefersSources(Key.Ptr));
+}
+
+TEST_P(CryptTest, EncryptionBatchSources)
+{
+    int AEAD = GetParam();
+
+    const uint8_t BatchSize = 8;
+    const uint8_t MaxSources = 6;
+    const uint16_t HeaderLength = 13;
+    const uint16_t PacketLengths[BatchSize] = { 34, 60, 200, 577, 1200, 1452, 1452, 4000 };
+
+    uint8_t RawKey[32];
+    CxPlatRandom(sizeof(RawKey), RawKey);
+
+    QuicKey Key((CXPLAT_AEAD_TYPE)AEAD, RawKey);
+    if (Key.Ptr == NULL) return;
+
+    for (uint32_t Round = 0; Round < 50; ++Round) {
+        uint8_t Iv[BatchSize][CXPLAT_MAX_IV_LENGTH];
+        std::vector<uint8_t> Packets[BatchSize];
+        std::vector<uint8_t> Expected[BatchSize];
+        CXPLAT_CRYPT_SOURCE Sources[BatchSize][MaxSources];
+        CXPLAT_CRYPT_BATCH_ENTRY Batch[BatchSize];
+
+        for (uint8_t i = 0; i < BatchSize; ++i) {
+            const uint16_t PacketLength = PacketLengths[i];
+            const uint16_t PlainTextLength =
+                PacketLength - HeaderLength - CXPLAT_ENCRYPTION_OVERHEAD;
+            CxPlatRandom(CXPLAT_IV_LENGTH, Iv[i]);
+            Expected[i].resize(PacketLength);
+            CxPlatRandom(PacketLength, Expected[i].data());
+            Packets[i] = Expected[i];
+            ASSERT_TRUE(
+                Key.Encrypt(
+                    Iv[i],
+                    HeaderLength,
+                    Expected[i].data(),
+                    PacketLength - HeaderLength,
+                    Expected[i].data() + HeaderLength));
+
+            //
+            // Move random ranges of the plain text out of line (trashing
+            // them in the packet), leaving random gaps in between.
+            //
+            uint8_t* PlainText = Packets[i].data() + HeaderLength;
+            uint8_t Count = 0;
+            uint16_t Offset = 0;
+            while (Count < MaxSources && Offset < PlainTextLength) {
+                uint16_t Random[2];
+                CxPlatRandom(sizeof(Random), Random);
+                Offset += Random[0] % 48;
+                if (Offset >= PlainTextLength) {
+                    break;
+                }
+                const uint16_t Length =
+                    (uint16_t)CXPLAT_MIN(1 + Random[1] % 700, PlainTextLength - Offset);
+                uint8_t* Copy = new uint8_t[Length];
+                memcpy(Copy, PlainText + Offset, Length);
+                memset(PlainText + Offset, 0xCC, Length);
+                Sources[i][Count].Buffer = Copy;
+                Sources[i][Count].Offset = Offset;
+                Sources[i][Count].Length = Length;
+                Offset += Length;
+                ++Count;
+            }
+
+            Batch[i].Iv = Iv[i];
+            Batch[i].AuthData = Packets[i].data();
+            Batch[i].AuthDataLength = HeaderLength;
+            Batch[i].Buffer = PlainText;
+            Batch[i].BufferLength = PacketLength - HeaderLength;
+            Batch[i].Sources = Sources[i];
+            Batch[i].SourceCount = Count;
+        }
+
+        //
+        // Reading the plain text from the sources must produce exactly
+        // what encrypting it in place does.
+        //
+        VERIFY_QUIC_SUCCESS(CxPlatEncryptBatch(Key.Ptr, BatchSize, Batch));
+        for (uint8_t i = 0; i < BatchSize; ++i) {
+            ASSERT_EQ(QUIC_STATUS_SUCCESS, Batch[i].Status);
+            ASSERT_EQ(Expected[i], Packets[i]);
+            for (uint8_t j = 0; j < Batch[i].SourceCount; ++j) {
+                delete [] Sources[i][j].Buffer;
+            }
+        }
+    }
+}
+
+TEST_P(CryptTest, DISABLED_EncryptionSourcesBenchmark)
+{
+    int AEAD = GetParam();
+
+    //
+    // Streams through an application buffer much larger than the cache, as
+    // a bulk upload does, comparing copying each packet's stream data in
+    // before encrypting it against encrypting it directly from the source.
+    //
+    const uint8_t BatchSize = 8;
+    const uint16_t HeaderLength = 13;
+    const uint16_t FrameHeaderLength = 12;
+    const uint16_t PacketLength = 1452;
+    const uint16_t DataLength =
+        PacketLength - HeaderLength - FrameHeaderLength - CXPLAT_ENCRYPTION_OVERHEAD;
+    const uint32_t AppLength = 128 * 1024 * 1024;
+
+    uint8_t RawKey[32];
+    CxPlatRandom(sizeof(RawKey), RawKey);
+    std::vector<uint8_t> App(AppLength);
+    CxPlatRandom(AppLength, App.data());
+    uint8_t Iv[CXPLAT_MAX_IV_LENGTH];
+    CxPlatRandom(CXPLAT_IV_LENGTH, Iv);
+    uint8_t Packets[BatchSize][PacketLength];
+    CxPlatRandom(sizeof(Packets), Packets);
+    CXPLAT_CRYPT_SOURCE Sources[BatchSize];
+    CXPLAT_CRYPT_BATCH_ENTRY Batch[BatchSize];
+    for (uint8_t i = 0; i < BatchSize; ++i) {
+        Batch[i].Iv = Iv;
+        Batch[i].AuthData = Packets[i];
+        Batch[i].AuthDataLength = HeaderLength;
+        Batch[i].Buffer = Packets[i] + HeaderLength;
+        Batch[i].BufferLength = PacketLength - HeaderLength;
+        Sources[i].Offset = FrameHeaderLength;
+        Sources[i].Length = DataLength;
+    }
+
+    QuicKey Key((CXPLAT_AEAD_TYPE)AEAD, RawKey);
+    if (Key.Ptr == NULL) return;
+
+    //
+    // Alternate between the two, keeping the best of several runs each.
+    //
+    uint64_t ElapsedUs[2] = { UINT64_MAX, UINT64_MAX };
+    for (uint32_t Run = 0; Run < 6; ++Run) {
+        const uint32_t Fused = Run % 2;
+        const uint64_t Start = CxPlatTimeUs64();
+        for (uint32_t AppOffset = 0;
+             AppOffset + BatchSize * DataLength <= AppLength;
+             AppOffset += BatchSize * DataLength) {
+            for (uint8_t i = 0; i < BatchSize; ++i) {
+                const uint8_t* Data = App.data() + AppOffset + i * DataLength;
+                if (Fused) {
+                    Sources[i].Buffer = Data;
+                    Batch[i].Sources = &Sources[i];
+                    Batch[i].SourceCount = 1;
+                } else {
+                    memcpy(Batch[i].Buffer + FrameHeaderLength, Data, DataLength);
+                    Batch[i].Sources = NULL;
+                    Batch[i].SourceCount = 0;
+                }
+            }
+            VERIFY_QUIC_SUCCESS(CxPlatEncryptBatch(Key.Ptr, BatchSize, Batch));
+        }
+        ElapsedUs[Fused] =
+            CXPLAT_MIN(ElapsedUs[Fused], CxPlatTimeDiff64(Start, CxPlatTimeUs64()));
+    }
+
+    RecordBenchmarkResult("CopyMBps", (double)AppLength / CXPLAT_MAX(ElapsedUs[0], 1));
+    RecordBenchmarkResult("FromSourceMBps", (double)AppLength / CXPLAT_MAX(ElapsedUs[1], 1));
+}
+
+#ifdef CXPLAT_NATIVE_CRYPTO
+
+TEST_F(CryptTest, NativeHpMaskMatchesOpenSsl)
+{
+    uint8_t RawKey[32];
+    CxPlatRandom(sizeof(RawKey), RawKey);
+
+    const uint32_t SavedFeatures = CxPlatCryptGetNativeFeatures();
+    CxPlatCryptSetNativeFeatures(0);
+    CXPLAT_HP_KEY* ReferenceHp = nullptr;
+    QUIC_STATUS Status =
+        CxPlatHpKeyCreate(CXPLAT_AEAD_CHACHA20_POLY1305, RawKey, &ReferenceHp);
+    CxPlatCryptSetNativeFeatures(SavedFeatures);
+    if (Status == QUIC_STATUS_NOT_SUPPORTED) {
+        GTEST_SKIP_(": AEAD Type unsupported");
+    }
+    VERIFY_QUIC_SUCCESS(Status);
+
+    CXPLAT_HP_KEY* HpKey = nullptr;
+    VERIFY_QUIC_SUCCESS(CxPlatHpKeyCreate(CXPLAT_AEAD_CHACHA20_POLY1305, RawKey, &HpKey));
+
+    uint8_t Samples[CXPLAT_HP_SAMPLE_LENGTH * 20];
+    uint8_t ExpectedMask[sizeof(Samples)];
+    uint8_t ActualMask[sizeof(Samples)];
+    CxPlatRandom(sizeof(Samples), Samples);
+    for (uint8_t BatchSize = 1; BatchSize <= sizeof(Samples) / CXPLAT_HP_SAMPLE_LENGTH; ++BatchSize) {
+        VERIFY_QUIC_SUCCESS(CxPlatHpComputeMask(ReferenceHp, BatchSize, Samples, ExpectedMask));
+        VERIFY_QUIC_SUCCESS(CxPlatHpComputeMask(HpKey, BatchSize, Samples, ActualMask));
+        for (uint8_t i = 0; i < BatchSize; ++i) {
+            //
+            // Only the first five bytes of each mask are used.
+            //
+            ASSERT_EQ(
+                0,
+                memcmp(
+                    ExpectedMask + i * CXPLAT_HP_SAMPLE_LENGTH,
+                    ActualMask + i * CXPLAT_HP_SAMPLE_LENGTH,
+                    5));
+        }
+    }
+
+    CxPlatHpKeyFree(HpKey);
+    CxPlatHpKeyFree(ReferenceHp);
+}
+
+#endif // CXPLAT_NATIVE_CRYPTO
+
 TEST_P(CryptTest, HashWellKnown)
 {
     int HASH = GetParam();
@@ -15,6 +15,12 @@ Abstract:
 #include "quic_datapath.h"
 
 #include "msquic.h"
+#include "msquicp.h"
+#ifdef CX_PLATFORM_LINUX
+#include <dirent.h>
+#include <linux/net_tstamp.h>
+#include <vector>
+#endif
 #ifdef QUIC_CLOG
 #include "DataPathTest.cpp.clog.h"
 #endif
@@ -92,6 +98,8 @@ struct UdpRecvContext {
     CXPLAT_DSCP_TYPE Dscp {CXPLAT_DSCP_CS0};
     bool TtlSupported;
     bool DscpSupported;
+    bool RecvTimestampSupported {false};
+    uint64_t SendTimeUs {0};
     UdpRecvContext() {
         CxPlatEventInitialize(&ClientCompletion, FALSE, FALSE);
     }
@@ -100,6 +108,33 @@ struct UdpRecvContext {
     }
 };
 
+struct CidSteeringRecvContext {
+    CXPLAT_EVENT Received;
+    uint16_t PartitionIndex {0};
+    CidSteeringRecvContext() {
+        CxPlatEventInitialize(&Received, FALSE, FALSE);
+    }
+    ~CidSteeringRecvContext() {
+        CxPlatEventUninitialize(Received);
+    }
+};
+
+struct MemoryRecvContext {
+    CXPLAT_EVENT Received;
+    uint32_t DatagramCount {0};
+    uint32_t TotalLength {0};
+    uint8_t TypeOfService {0};
+    uint16_t SourcePort {0};
+    uint16_t CoalescedCount {0};
+    bool ContentMatches {true};
+    MemoryRecvContext() {
+        CxPlatEventInitialize(&Received, FALSE, FALSE);
+    }
+    ~MemoryRecvContext() {
+        CxPlatEventUninitialize(Received);
+    }
+};
+
 struct TcpClientContext {
     bool Connected : 1;
     bool Disconnected : 1;
@@ -141,6 +176,9 @@ struct TcpListenerContext {
     }
 };
 
+struct CxPlatDataPath;
+struct CxPlatSocket;
+
 struct DataPathTest : public ::testing::TestWithParam<int32_t>
 {
 protected:
@@ -243,6 +281,28 @@ protected:
         }
     }
 
+    //
+    // Creates a server socket that echoes what it receives, and a client
+    // socket connected to it.
+    //
+    void
+    CreateUdpEchoSockets(
+        _In_ CxPlatDataPath& Datapath,
+        _Inout_ UdpRecvContext& RecvContext,
+        _Inout_ CxPlatSocket& Server,
+        _Inout_ CxPlatSocket& Client
+        );
+
+    //
+    // Sends one datagram from the client and waits for the echo to come back.
+    //
+    static void
+    UdpEchoRoundTrip(
+        _In_ CxPlatSocket& Client,
+        _Inout_ UdpRecvContext& RecvContext,
+        _In_ uint64_t DepartureTimeUs = 0
+        );
+
     static void SetUpTestSuite()
     {
         //
@@ -310,6 +370,14 @@ protected:
                 ASSERT_EQ(CXPLAT_DSCP_FROM_TOS(RecvData->TypeOfService), 0);
             }
 
+            if (RecvContext->RecvTimestampSupported) {
+                ASSERT_NE(0ull, (unsigned long long)RecvData->ReceiveTimeUs);
+                ASSERT_GE(RecvData->ReceiveTimeUs, RecvContext->SendTimeUs);
+                ASSERT_LE(RecvData->ReceiveTimeUs, CxPlatTimeUs64());
+            } else {
+                ASSERT_EQ(0ull, (unsigned long long)RecvData->ReceiveTimeUs);
+            }
+
             if (RecvData->Route->LocalAddress.Ipv4.sin_port == RecvContext->DestinationAddress.Ipv4.sin_port) {
 
                 ASSERT_EQ(CXPLAT_ECN_FROM_TOS(RecvData->TypeOfService), RecvContext->EcnType);
@@ -336,6 +404,44 @@ protected:
         CxPlatRecvDataReturn(RecvDataChain);
     }
 
+    static void
+    CidSteeringRecvCallback(
+        _In_ CXPLAT_SOCKET* /* Socket */,
+        _In_ void* Context,
+        _In_ CXPLAT_RECV_DATA* RecvDataChain
+        )
+    {
+        CidSteeringRecvContext* RecvContext = (CidSteeringRecvContext*)Context;
+        for (CXPLAT_RECV_DATA* RecvData = RecvDataChain; RecvData != NULL; RecvData = RecvData->Next) {
+            RecvContext->PartitionIndex = RecvData->PartitionIndex;
+            CxPlatEventSet(RecvContext->Received);
+        }
+        CxPlatRecvDataReturn(RecvDataChain);
+    }
+
+    static void
+    MemoryRecvCallback(
+        _In_ CXPLAT_SOCKET* /* Socket */,
+        _In_ void* Context,
+        _In_ CXPLAT_RECV_DATA* RecvDataChain
+        )
+    {
+        MemoryRecvContext* RecvContext = (MemoryRecvContext*)Context;
+        RecvContext->CoalescedCount = RecvDataChain->CoalescedCount;
+        for (CXPLAT_RECV_DATA* RecvData = RecvDataChain; RecvData != NULL; RecvData = RecvData->Next) {
+            RecvContext->DatagramCount++;
+            RecvContext->TotalLength += RecvData->BufferLength;
+            RecvContext->TypeOfService = RecvData->TypeOfService;
+            RecvContext->SourcePort = QuicAddrGetPort(&RecvData->Route->RemoteAddress);
+            if (RecvData->BufferLength > ExpectedDataSize ||
+                memcmp(RecvData->Buffer, ExpectedData, RecvData->BufferLength)) {
+                RecvContext->ContentMatches = false;
+            }
+        }
+        CxPlatRecvDataReturn(RecvDataChain);
+        CxPlatEventSet(RecvContext->Received);
+    }
+
     static QUIC_STATUS
     EmptyAcceptCallback(
         _In_ CXPLAT_SOCKET* /* ListenerSocket */,
@@ -430,6 +536,16 @@ protected:
         EmptyUnreachableCallback,
     };
 
+    const CXPLAT_UDP_DATAPATH_CALLBACKS CidSteeringRecvCallbacks = {
+        CidSteeringRecvCallback,
+        EmptyUnreachableCallback,
+    };
+
+    const CXPLAT_UDP_DATAPATH_CALLBACKS MemoryRecvCallbacks = {
+        MemoryRecvCallback,
+        EmptyUnreachableCallback,
+    };
+
     const CXPLAT_TCP_DATAPATH_CALLBACKS EmptyTcpCallbacks = {
         EmptyAcceptCallback,
         EmptyConnectCallback,
@@ -460,20 +576,21 @@ struct CxPlatDataPath {
         _In_opt_ const CXPLAT_UDP_DATAPATH_CALLBACKS* UdpCallbacks,
         _In_opt_ const CXPLAT_TCP_DATAPATH_CALLBACKS* TcpCallbacks = nullptr,
         _In_ uint32_t ClientRecvContextLength = 0,
-        _In_opt_ QUIC_GLOBAL_EXECUTION_CONFIG* Config = nullptr
+        _In_opt_ QUIC_GLOBAL_EXECUTION_CONFIG* Config = nullptr,
+        _In_opt_ CXPLAT_DATAPATH_INIT_CONFIG* InitConfig = nullptr
         ) noexcept
     {
         WorkerPool =
             CxPlatWorkerPoolCreate(Config ? Config : &DefaultExecutionConfig);
-        CXPLAT_DATAPATH_INIT_CONFIG InitConfig = {0};
-        InitConfig.EnableDscpOnRecv = TRUE;
+        CXPLAT_DATAPATH_INIT_CONFIG DefaultInitConfig = {0};
+        DefaultInitConfig.EnableDscpOnRecv = TRUE;
         InitStatus =
             CxPlatDataPathInitialize(
                 ClientRecvContextLength,
                 UdpCallbacks,
                 TcpCallbacks,
                 WorkerPool,
-                &InitConfig,
+                InitConfig ? InitConfig : &DefaultInitConfig,
                 &Datapath);
     }
     ~CxPlatDataPath() noexcept {
@@ -679,6 +796,93 @@ struct CxPlatSocket {
     }
 };
 
+void
+DataPathTest::CreateUdpEchoSockets(
+    _In_ CxPlatDataPath& Datapath,
+    _Inout_ UdpRecvContext& RecvContext,
+    _Inout_ CxPlatSocket& Server,
+    _Inout_ CxPlatSocket& Client
+    )
+{
+    RecvContext.TtlSupported = Datapath.IsSupported(CXPLAT_DATAPATH_FEATURE_TTL);
+    RecvContext.DscpSupported = Datapath.IsDscpSupported();
+
+    auto unspecAddress = GetNewUnspecAddr();
+    Server.CreateUdp(Datapath, &unspecAddress.SockAddr, nullptr, &RecvContext);
+    while (Server.GetInitStatus() == QUIC_STATUS_ADDRESS_IN_USE) {
+        unspecAddress.SockAddr.Ipv4.sin_port = GetNextPort();
+        Server.CreateUdp(Datapath, &unspecAddress.SockAddr, nullptr, &RecvContext);
+    }
+    VERIFY_QUIC_SUCCESS(Server.GetInitStatus());
+    ASSERT_NE(nullptr, Server.Socket);
+
+    auto serverAddress = GetNewLocalAddr();
+    RecvContext.DestinationAddress = serverAddress.SockAddr;
+    RecvContext.DestinationAddress.Ipv4.sin_port = Server.GetLocalAddress().Ipv4.sin_port;
+    ASSERT_NE(RecvContext.DestinationAddress.Ipv4.sin_port, (uint16_t)0);
+
+    Client.CreateUdp(Datapath, nullptr, &RecvContext.DestinationAddress, &RecvContext);
+    VERIFY_QUIC_SUCCESS(Client.GetInitStatus());
+    ASSERT_NE(nullptr, Client.Socket);
+}
+
+void
+DataPathTest::UdpEchoRoundTrip(
+    _In_ CxPlatSocket& Client,
+    _Inout_ UdpRecvContext& RecvContext,
+    _In_ uint64_t DepartureTimeUs
+    )
+{
+    CXPLAT_SEND_CONFIG SendConfig = {
+        &Client.Route, 0, (uint8_t)RecvContext.EcnType, 0, (uint8_t)RecvContext.Dscp, DepartureTimeUs };
+    auto ClientSendData = CxPlatSendDataAlloc(Client, &SendConfig);
+    ASSERT_NE(nullptr, ClientSendData);
+    auto ClientBuffer = CxPlatSendDataAllocBuffer(ClientSendData, ExpectedDataSize);
+    ASSERT_NE(nullptr, ClientBuffer);
+    memcpy(ClientBuffer->Buffer, ExpectedData, ExpectedDataSize);
+
+    Client.Send(ClientSendData);
+    ASSERT_TRUE(CxPlatEventWaitWithTimeout(RecvContext.ClientCompletion, 2000));
+}
+
+#ifdef CX_PLATFORM_LINUX
+//
+// Finds the process's UDP sockets bound to the port, so tests can check the
+// options the datapath set on them.
+//
+static
+std::vector<int>
+GetUdpSocketFds(
+    _In_ uint16_t Port // Network byte order
+    )
+{
+    std::vector<int> Fds;
+    DIR* Dir = opendir("/proc/self/fd");
+    if (Dir == nullptr) {
+        return Fds;
+    }
+    struct dirent* Entry;
+    while ((Entry = readdir(Dir)) != nullptr) {
+        const int Fd = atoi(Entry->d_name);
+        if (Fd <= 0 || Fd == dirfd(Dir)) {
+            continue;
+        }
+        int Type = 0;
+        socklen_t TypeLength = sizeof(Type);
+        QUIC_ADDR Address = {0};
+        socklen_t AddressLength = sizeof(Address);
+        if (getsockopt(Fd, SOL_SOCKET, SO_TYPE, &Type, &TypeLength) == 0 &&
+            Type == SOCK_DGRAM &&
+            getsockname(Fd, (struct sockaddr*)&Address, &AddressLength) == 0 &&
+            Address.Ipv4.sin_port == Port) {
+            Fds.push_back(Fd);
+        }
+    }
+    closedir(Dir);
+    return Fds;
+}
+#endif
+
 TEST_F(DataPathTest, Initialize)
 {
     {
@@ -989,6 +1193,523 @@ TEST_P(DataPathTest, UdpDataECT0)
     ASSERT_TRUE(CxPlatEventWaitWithTimeout(RecvContext.ClientCompletion, 2000));
 }
 
+TEST_P(DataPathTest, UdpDataZeroCopy)
+{
+    CXPLAT_DATAPATH_INIT_CONFIG InitConfig = {0};
+    InitConfig.EnableDscpOnRecv = TRUE;
+    InitConfig.EnableSendZeroCopy = TRUE;
+    InitConfig.SendZeroCopyThreshold = 1; // Even small test sends go zero-copy.
+    UdpRecvContext RecvContext;
+    CxPlatDataPath Datapath(&UdpRecvCallbacks, nullptr, 0, nullptr, &InitConfig);
+    VERIFY_QUIC_SUCCESS(Datapath.GetInitStatus());
+    ASSERT_NE(nullptr, Datapath.Datapath);
+    if (!Datapath.IsSupported(CXPLAT_DATAPATH_FEATURE_SEND_ZEROCOPY)) {
+        std::cout << "SKIP: Send Zero-Copy Feature Unsupported" << std::endl;
+        return;
+    }
+
+    CxPlatSocket Server, Client;
+    ASSERT_NO_FATAL_FAILURE(CreateUdpEchoSockets(Datapath, RecvContext, Server, Client));
+
+    //
+    // Run enough round trips that send buffers must be recycled after the
+    // kernel releases them.
+    //
+    const uint32_t RoundTrips = 256;
+    for (uint32_t i = 0; i < RoundTrips; ++i) {
+        ASSERT_NO_FATAL_FAILURE(UdpEchoRoundTrip(Client, RecvContext));
+    }
+
+    //
+    // Every zero-copy send must eventually be completed by the kernel's
+    // notification. Sends refused with ENOBUFS are copied instead, so not all
+    // of them have to go zero-copy.
+    //
+    CXPLAT_UDP_STATISTICS Stats = {0};
+    for (uint32_t i = 0; i < 200; ++i) {
+        VERIFY_QUIC_SUCCESS(CxPlatSocketGetUdpStatistics(Client, &Stats));
+        if (Stats.ZeroCopySendsCompleted == Stats.ZeroCopySends) {
+            break;
+        }
+        CxPlatSleep(10);
+    }
+    ASSERT_NE(0ull, (unsigned long long)Stats.ZeroCopySends);
+    ASSERT_LE(Stats.ZeroCopySends, (uint64_t)RoundTrips);
+    ASSERT_EQ(Stats.ZeroCopySends, Stats.ZeroCopySendsCompleted);
+}
+
+TEST_P(DataPathTest, UdpDataZeroCopyClose)
+{
+    CXPLAT_DATAPATH_INIT_CONFIG InitConfig = {0};
+    InitConfig.EnableSendZeroCopy = TRUE;
+    InitConfig.SendZeroCopyThreshold = 1;
+    MemoryRecvContext RecvContext;
+    CxPlatDataPath Datapath(&MemoryRecvCallbacks, nullptr, 0, nullptr, &InitConfig);
+    VERIFY_QUIC_SUCCESS(Datapath.GetInitStatus());
+    ASSERT_NE(nullptr, Datapath.Datapath);
+    if (!Datapath.IsSupported(CXPLAT_DATAPATH_FEATURE_SEND_ZEROCOPY)) {
+        std::cout << "SKIP: Send Zero-Copy Feature Unsupported" << std::endl;
+        return;
+    }
+
+    auto serverAddress = GetNewLocalAddr();
+    CxPlatSocket Server(Datapath, &serverAddress.SockAddr, nullptr, &RecvContext);
+    while (Server.GetInitStatus() == QUIC_STATUS_ADDRESS_IN_USE) {
+        serverAddress.SockAddr.Ipv4.sin_port = GetNextPort();
+        Server.CreateUdp(Datapath, &serverAddress.SockAddr, nullptr, &RecvContext);
+    }
+    VERIFY_QUIC_SUCCESS(Server.GetInitStatus());
+
+    //
+    // Each client closes right after its burst of sends, without waiting for
+    // their completions, so the kernel's notifications for them are collected
+    // by the socket teardown. The buffers of one client's sends are reused by
+    // the next one's, and every datagram must still arrive intact.
+    //
+    const uint32_t ClientCount = 4;
+    const uint32_t BurstSize = 32;
+    uint64_t ZeroCopySends = 0;
+    for (uint32_t i = 0; i < ClientCount; ++i) {
+        CxPlatSocket Client(Datapath, nullptr, &serverAddress.SockAddr, &RecvContext);
+        VERIFY_QUIC_SUCCESS(Client.GetInitStatus());
+        for (uint32_t j = 0; j < BurstSize; ++j) {
+            CXPLAT_SEND_CONFIG SendConfig = { &Client.Route, 0, CXPLAT_ECN_NON_ECT, 0, CXPLAT_DSCP_CS0 };
+            auto SendData = CxPlatSendDataAlloc(Client, &SendConfig);
+            ASSERT_NE(nullptr, SendData);
+            auto Buffer = CxPlatSendDataAllocBuffer(SendData, ExpectedDataSize);
+            ASSERT_NE(nullptr, Buffer);
+            memcpy(Buffer->Buffer, ExpectedData, ExpectedDataSize);
+            Client.Send(SendData);
+        }
+        CXPLAT_UDP_STATISTICS Stats = {0};
+        VERIFY_QUIC_SUCCESS(CxPlatSocketGetUdpStatistics(Client, &Stats));
+        ASSERT_LE(Stats.ZeroCopySendsCompleted, Stats.ZeroCopySends);
+        ZeroCopySends += Stats.ZeroCopySends;
+    }
+    ASSERT_NE(0ull, (unsigned long long)ZeroCopySends);
+
+    const uint32_t Expected = ClientCount * BurstSize;
+    while (RecvContext.DatagramCount < Expected &&
+           CxPlatEventWaitWithTimeout(RecvContext.Received, 2000)) {
+    }
+    ASSERT_EQ(Expected, RecvContext.DatagramCount);
+    ASSERT_EQ(Expected * ExpectedDataSize, RecvContext.TotalLength);
+    ASSERT_TRUE(RecvContext.ContentMatches);
+}
+
+TEST_P(DataPathTest, UdpDataBusyPoll)
+{
+    QUIC_GLOBAL_EXECUTION_CONFIG Config = { QUIC_GLOBAL_EXECUTION_CONFIG_FLAG_BUSY_POLL, 1000, 0 };
+    CXPLAT_DATAPATH_INIT_CONFIG InitConfig = {0};
+    InitConfig.EnableDscpOnRecv = TRUE;
+    InitConfig.BusyPollUs = Config.PollingIdleTimeoutUs;
+    UdpRecvContext RecvContext;
+    CxPlatDataPath Datapath(&UdpRecvCallbacks, nullptr, 0, &Config, &InitConfig);
+    VERIFY_QUIC_SUCCESS(Datapath.GetInitStatus());
+    ASSERT_NE(nullptr, Datapath.Datapath);
+
+    CxPlatSocket Server, Client;
+    ASSERT_NO_FATAL_FAILURE(CreateUdpEchoSockets(Datapath, RecvContext, Server, Client));
+
+#if defined(CX_PLATFORM_LINUX) && defined(SO_BUSY_POLL)
+    if (!Datapath.IsSupported(CXPLAT_DATAPATH_FEATURE_RAW)) {
+        //
+        // Raising SO_BUSY_POLL needs CAP_NET_ADMIN. Without it, the datapath
+        // leaves the sockets as they are.
+        //
+        int Expected = (int)InitConfig.BusyPollUs;
+        int Probe = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+        ASSERT_NE(-1, Probe);
+        if (setsockopt(Probe, SOL_SOCKET, SO_BUSY_POLL, &Expected, sizeof(Expected)) != 0) {
+            Expected = 0;
+        }
+        close(Probe);
+
+        const uint16_t Ports[] = {
+            Server.GetLocalAddress().Ipv4.sin_port, Client.GetLocalAddress().Ipv4.sin_port };
+        for (uint16_t Port : Ports) {
+            auto Fds = GetUdpSocketFds(Port);
+            ASSERT_FALSE(Fds.empty());
+            for (int Fd : Fds) {
+                int BusyPollUs = -1;
+                socklen_t Length = sizeof(BusyPollUs);
+                ASSERT_EQ(0, getsockopt(Fd, SOL_SOCKET, SO_BUSY_POLL, &BusyPollUs, &Length));
+                ASSERT_EQ(Expected, BusyPollUs);
+            }
+        }
+    }
+#endif
+
+    //
+    // Space out the round trips so some of them arrive after the sockets'
+    // busy poll window has passed.
+    //
+    for (uint32_t i = 0; i < 16; ++i) {
+        ASSERT_NO_FATAL_FAILURE(UdpEchoRoundTrip(Client, RecvContext));
+        if (i % 2 == 0) {
+            CxPlatSleep(5);
+        }
+    }
+}
+
+//
+// Only run explicitly (--gtest_also_run_disabled_tests).
+//
+TEST_P(DataPathTest, DISABLED_UdpDataXdpBenchmark)
+{
+    if (!UseDuoNic) {
+        std::cout << "SKIP: XDP benchmark requires the duonic veth pair" << std::endl;
+        return;
+    }
+
+    //
+    // Runs a one-way burst over the local veth pair with preferred busy
+    // polling on the AF_XDP sockets, and reports the achieved rate.
+    //
+    QUIC_GLOBAL_EXECUTION_CONFIG Config = { QUIC_GLOBAL_EXECUTION_CONFIG_FLAG_BUSY_POLL, 1000, 0 };
+    CXPLAT_DATAPATH_INIT_CONFIG InitConfig = {0};
+    InitConfig.BusyPollUs = Config.PollingIdleTimeoutUs;
+    MemoryRecvContext RecvContext;
+    CxPlatDataPath Datapath(&MemoryRecvCallbacks, nullptr, 0, &Config, &InitConfig);
+    VERIFY_QUIC_SUCCESS(Datapath.GetInitStatus());
+    ASSERT_NE(nullptr, Datapath.Datapath);
+    ASSERT_TRUE(Datapath.IsSupported(CXPLAT_DATAPATH_FEATURE_RAW, CXPLAT_SOCKET_FLAG_XDP));
+
+    auto serverAddress = GetNewLocalAddr();
+    CxPlatSocket Server(Datapath, &serverAddress.SockAddr, nullptr, &RecvContext, CXPLAT_SOCKET_FLAG_XDP);
+    while (Server.GetInitStatus() == QUIC_STATUS_ADDRESS_IN_USE) {
+        serverAddress.SockAddr.Ipv4.sin_port = GetNextPort();
+        Server.CreateUdp(Datapath, &serverAddress.SockAddr, nullptr, &RecvContext, CXPLAT_SOCKET_FLAG_XDP);
+    }
+    VERIFY_QUIC_SUCCESS(Server.GetInitStatus());
+
+    CxPlatSocket Client(Datapath, nullptr, &serverAddress.SockAddr, &RecvContext, CXPLAT_SOCKET_FLAG_XDP);
+    VERIFY_QUIC_SUCCESS(Client.GetInitStatus());
+
+    //
+    // Datagrams go out in windows small enough for the receive rings, and each
+    // window must fully arrive before the next is sent. Every datagram the
+    // client actually sent must then be delivered intact.
+    //
+    const uint32_t DatagramCount = 100000;
+    const uint32_t WindowSize = 64;
+    uint32_t Sent = 0;
+    const uint64_t StartTime = CxPlatTimeUs64();
+    for (uint32_t i = 0; i < DatagramCount; i += WindowSize) {
+        for (uint32_t j = 0; j < WindowSize; ++j) {
+            CXPLAT_SEND_CONFIG SendConfig = { &Client.Route, 0, CXPLAT_ECN_NON_ECT, 0, CXPLAT_DSCP_CS0 };
+            auto SendData = CxPlatSendDataAlloc(Client, &SendConfig);
+            if (SendData == nullptr) {
+                break; // Out of transmit frames; wait for completions.
+            }
+            auto Buffer = CxPlatSendDataAllocBuffer(SendData, ExpectedDataSize);
+            ASSERT_NE(nullptr, Buffer);
+            memcpy(Buffer->Buffer, ExpectedData, ExpectedDataSize);
+            Client.Send(SendData);
+            ++Sent;
+        }
+        while (RecvContext.DatagramCount < Sent &&
+               CxPlatEventWaitWithTimeout(RecvContext.Received, 2000)) {
+        }
+        ASSERT_EQ(Sent, RecvContext.DatagramCount);
+    }
+    const uint64_t ElapsedUs = CxPlatTimeDiff64(StartTime, CxPlatTimeUs64());
+
+    RecordBenchmarkResult("Datagrams", (double)Sent);
+    RecordBenchmarkResult("PacketsPerSec", ElapsedUs ? (double)Sent * 1000000 / ElapsedUs : 0.0);
+    ASSERT_NE(0u, Sent);
+    ASSERT_EQ(Sent, RecvContext.DatagramCount);
+    ASSERT_EQ(Sent * ExpectedDataSize, RecvContext.TotalLength);
+    ASSERT_TRUE(RecvContext.ContentMatches);
+}
+
+TEST_P(DataPathTest, UdpDataTxTime)
+{
+    CXPLAT_DATAPATH_INIT_CONFIG InitConfig = {0};
+    InitConfig.EnableDscpOnRecv = TRUE;
+    InitConfig.EnableSendTxTime = TRUE;
+    UdpRecvContext RecvContext;
+    CxPlatDataPath Datapath(&UdpRecvCallbacks, nullptr, 0, nullptr, &InitConfig);
+    VERIFY_QUIC_SUCCESS(Datapath.GetInitStatus());
+    ASSERT_NE(nullptr, Datapath.Datapath);
+    if (!Datapath.IsSupported(CXPLAT_DATAPATH_FEATURE_SEND_TXTIME)) {
+        std::cout << "SKIP: Send TX Time Feature Unsupported" << std::endl;
+        return;
+    }
+
+    CxPlatSocket Server, Client;
+    ASSERT_NO_FATAL_FAILURE(CreateUdpEchoSockets(Datapath, RecvContext, Server, Client));
+
+#if defined(CX_PLATFORM_LINUX) && defined(SO_TXTIME)
+    //
+    // Departure times are in the CxPlatTimeUs64 domain.
+    //
+    auto Fds = GetUdpSocketFds(Client.GetLocalAddress().Ipv4.sin_port);
+    ASSERT_FALSE(Fds.empty());
+    for (int Fd : Fds) {
+        struct sock_txtime TxTimeConfig = {0};
+        TxTimeConfig.clockid = -1;
+        socklen_t Length = sizeof(TxTimeConfig);
+        ASSERT_EQ(0, getsockopt(Fd, SOL_SOCKET, SO_TXTIME, &TxTimeConfig, &Length));
+        ASSERT_EQ(CLOCK_MONOTONIC, TxTimeConfig.clockid);
+    }
+#endif
+
+    //
+    // The kernel rejects sends whose departure time it can't honor, so each
+    // one must still be delivered, whether or not the local qdisc delays it.
+    //
+    for (uint32_t i = 0; i < 4; ++i) {
+        ASSERT_NO_FATAL_FAILURE(UdpEchoRoundTrip(Client, RecvContext, CxPlatTimeUs64() + i * 1000));
+    }
+}
+
+TEST_P(DataPathTest, UdpDataRecvTimestamp)
+{
+    CXPLAT_DATAPATH_INIT_CONFIG InitConfig = {0};
+    InitConfig.EnableDscpOnRecv = TRUE;
+    InitConfig.EnableRecvTimestamp = TRUE;
+    UdpRecvContext RecvContext;
+    CxPlatDataPath Datapath(&UdpRecvCallbacks, nullptr, 0, nullptr, &InitConfig);
+    VERIFY_QUIC_SUCCESS(Datapath.GetInitStatus());
+    ASSERT_NE(nullptr, Datapath.Datapath);
+    RecvContext.RecvTimestampSupported = Datapath.IsSupported(CXPLAT_DATAPATH_FEATURE_RECV_TIMESTAMP);
+    if (!RecvContext.RecvTimestampSupported) {
+        std::cout << "SKIP: Receive Timestamp Feature Unsupported" << std::endl;
+        return;
+    }
+
+    CxPlatSocket Server, Client;
+    ASSERT_NO_FATAL_FAILURE(CreateUdpEchoSockets(Datapath, RecvContext, Server, Client));
+
+    //
+    // The receive callback checks every datagram carries a receive time
+    // between the send and the callback.
+    //
+    for (uint32_t i = 0; i < 4; ++i) {
+        RecvContext.SendTimeUs = CxPlatTimeUs64();
+        ASSERT_NO_FATAL_FAILURE(UdpEchoRoundTrip(Client, RecvContext));
+    }
+}
+
+TEST_P(DataPathTest, UdpDataMemory)
+{
+    CXPLAT_DATAPATH_INIT_CONFIG InitConfig = {0};
+    InitConfig.EnableMemoryDatapath = TRUE;
+    MemoryRecvContext RecvContext;
+    CxPlatDataPath Datapath(&MemoryRecvCallbacks, nullptr, 0, nullptr, &InitConfig);
+    VERIFY_QUIC_SUCCESS(Datapath.GetInitStatus());
+    ASSERT_NE(nullptr, Datapath.Datapath);
+    ASSERT_TRUE(Datapath.IsSupported(CXPLAT_DATAPATH_FEATURE_SEND_SEGMENTATION));
+
+    auto serverAddress = GetNewLocalAddr();
+    CxPlatSocket Server(Datapath, &serverAddress.SockAddr, nullptr, &RecvContext);
+    VERIFY_QUIC_SUCCESS(Server.GetInitStatus());
+
+    CxPlatSocket Duplicate(Datapath, &serverAddress.SockAddr, nullptr, &RecvContext);
+    ASSERT_EQ(QUIC_STATUS_ADDRESS_IN_USE, Duplicate.GetInitStatus());
+
+    CxPlatSocket Client(Datapath, nullptr, &serverAddress.SockAddr, &RecvContext);
+    VERIFY_QUIC_SUCCESS(Client.GetInitStatus());
+    ASSERT_NE((uint16_t)0, QuicAddrGetPort(&Client.Route.LocalAddress));
+
+    //
+    // A segmented send is delivered as one coalesced chain, without loss.
+    //
+    const uint16_t SegmentCount = 4;
+    const uint16_t LastSegmentSize = ExpectedDataSize / 2;
+    CXPLAT_SEND_CONFIG SendConfig = {
+        &Client.Route, (uint16_t)ExpectedDataSize, CXPLAT_ECN_ECT_0, 0, CXPLAT_DSCP_LE };
+    auto SendData = CxPlatSendDataAlloc(Client, &SendConfig);
+    ASSERT_NE(nullptr, SendData);
+    for (uint16_t i = 0; i < SegmentCount; ++i) {
+        const uint16_t Length = i == SegmentCount - 1 ? LastSegmentSize : (uint16_t)ExpectedDataSize;
+        auto Buffer = CxPlatSendDataAllocBuffer(SendData, Length);
+        ASSERT_NE(nullptr, Buffer);
+        memcpy(Buffer->Buffer, ExpectedData, Length);
+    }
+    ASSERT_TRUE(CxPlatSendDataIsFull(SendData)); // The short segment ends the batch.
+    Client.Send(SendData);
+
+    ASSERT_TRUE(CxPlatEventWaitWithTimeout(RecvContext.Received, 2000));
+    ASSERT_EQ((uint32_t)SegmentCount, RecvContext.DatagramCount);
+    ASSERT_EQ(SegmentCount, RecvContext.CoalescedCount);
+    ASSERT_EQ((SegmentCount - 1) * ExpectedDataSize + LastSegmentSize, RecvContext.TotalLength);
+    ASSERT_TRUE(RecvContext.ContentMatches);
+    ASSERT_EQ(CXPLAT_ECN_ECT_0, CXPLAT_ECN_FROM_TOS(RecvContext.TypeOfService));
+    ASSERT_EQ(CXPLAT_DSCP_LE, CXPLAT_DSCP_FROM_TOS(RecvContext.TypeOfService));
+    ASSERT_EQ(QuicAddrGetPort(&Client.Route.LocalAddress), RecvContext.SourcePort);
+
+    //
+    // Sends to a port nothing is bound to are dropped.
+    //
+    CxPlatSocket Unconnected(Datapath, nullptr, nullptr, &RecvContext);
+    VERIFY_QUIC_SUCCESS(Unconnected.GetInitStatus());
+    CXPLAT_ROUTE UnboundRoute = Unconnected.Route;
+    UnboundRoute.RemoteAddress = serverAddress.SockAddr;
+    QuicAddrSetPort(&UnboundRoute.RemoteAddress, GetNextPort());
+    SendConfig.Route = &UnboundRoute;
+    SendConfig.MaxPacketSize = 0;
+    SendData = CxPlatSendDataAlloc(Unconnected, &SendConfig);
+    ASSERT_NE(nullptr, SendData);
+    auto Buffer = CxPlatSendDataAllocBuffer(SendData, ExpectedDataSize);
+    ASSERT_NE(nullptr, Buffer);
+    memcpy(Buffer->Buffer, ExpectedData, ExpectedDataSize);
+    Unconnected.Send(UnboundRoute, SendData);
+    ASSERT_FALSE(CxPlatEventWaitWithTimeout(RecvContext.Received, 100));
+}
+
+TEST_P(DataPathTest, UdpDataMemoryEmulation)
+{
+    //
+    // Every datagram is held back for the emulated one-way delay.
+    //
+    {
+        QUIC_PRIVATE_DATAPATH_EMULATION Emulation = {0};
+        Emulation.DelayUs = 50000;
+        CXPLAT_DATAPATH_INIT_CONFIG InitConfig = {0};
+        InitConfig.EnableMemoryDatapath = TRUE;
+        InitConfig.Emulation = &Emulation;
+        MemoryRecvContext RecvContext;
+        CxPlatDataPath Datapath(&MemoryRecvCallbacks, nullptr, 0, nullptr, &InitConfig);
+        VERIFY_QUIC_SUCCESS(Datapath.GetInitStatus());
+        ASSERT_NE(nullptr, Datapath.Datapath);
+
+        auto serverAddress = GetNewLocalAddr();
+        CxPlatSocket Server(Datapath, &serverAddress.SockAddr, nullptr, &RecvContext);
+        VERIFY_QUIC_SUCCESS(Server.GetInitStatus());
+        CxPlatSocket Client(Datapath, nullptr, &serverAddress.SockAddr, &RecvContext);
+        VERIFY_QUIC_SUCCESS(Client.GetInitStatus());
+
+        const uint16_t SegmentCount = 4;
+        CXPLAT_SEND_CONFIG SendConfig = {
+            &Client.Route, (uint16_t)ExpectedDataSize, CXPLAT_ECN_NON_ECT, 0, CXPLAT_DSCP_CS0 };
+        auto SendData = CxPlatSendDataAlloc(Client, &SendConfig);
+        ASSERT_NE(nullptr, SendData);
+        for (uint16_t i = 0; i < SegmentCount; ++i) {
+            auto Buffer = CxPlatSendDataAllocBuffer(SendData, ExpectedDataSize);
+            ASSERT_NE(nullptr, Buffer);
+            memcpy(Buffer->Buffer, ExpectedData, ExpectedDataSize);
+        }
+        const uint64_t SendTime = CxPlatTimeUs64();
+        Client.Send(SendData);
+
+        while (RecvContext.DatagramCount < SegmentCount) {
+            ASSERT_TRUE(CxPlatEventWaitWithTimeout(RecvContext.Received, 2000));
+        }
+        ASSERT_LE(Emulation.DelayUs, CxPlatTimeDiff64(SendTime, CxPlatTimeUs64()));
+        ASSERT_EQ(SegmentCount * ExpectedDataSize, RecvContext.TotalLength);
+        ASSERT_TRUE(RecvContext.ContentMatches);
+    }
+
+    //
+    // Nothing makes it through a path with total loss.
+    //
+    {
+        QUIC_PRIVATE_DATAPATH_EMULATION Emulation = {0};
+        Emulation.LossPpm = 1000000;
+        CXPLAT_DATAPATH_INIT_CONFIG InitConfig = {0};
+        InitConfig.EnableMemoryDatapath = TRUE;
+        InitConfig.Emulation = &Emulation;
+        MemoryRecvContext RecvContext;
+        CxPlatDataPath Datapath(&MemoryRecvCallbacks, nullptr, 0, nullptr, &InitConfig);
+        VERIFY_QUIC_SUCCESS(Datapath.GetInitStatus());
+        ASSERT_NE(nullptr, Datapath.Datapath);
+
+        auto serverAddress = GetNewLocalAddr();
+        CxPlatSocket Server(Datapath, &serverAddress.SockAddr, nullptr, &RecvContext);
+        VERIFY_QUIC_SUCCESS(Server.GetInitStatus());
+        CxPlatSocket Client(Datapath, nullptr, &serverAddress.SockAddr, &RecvContext);
+        VERIFY_QUIC_SUCCESS(Client.GetInitStatus());
+
+        CXPLAT_SEND_CONFIG SendConfig = {
+            &Client.Route, 0, CXPLAT_ECN_NON_ECT, 0, CXPLAT_DSCP_CS0 };
+        auto SendData = CxPlatSendDataAlloc(Client, &SendConfig);
+        ASSERT_NE(nullptr, SendData);
+        auto Buffer = CxPlatSendDataAllocBuffer(SendData, ExpectedDataSize);
+        ASSERT_NE(nullptr, Buffer);
+        memcpy(Buffer->Buffer, ExpectedData, ExpectedDataSize);
+        Client.Send(SendData);
+        ASSERT_FALSE(CxPlatEventWaitWithTimeout(RecvContext.Received, 100));
+    }
+}
+
+TEST_P(DataPathTest, UdpCidSteering)
+{
+    //
+    // Use two partitions (even on a single processor), so that packets have a
+    // socket to be steered to other than the one the flow hash picks.
+    //
+    const uint16_t PartitionCount = 2;
+    const uint16_t PartitionMask = 3;
+    uint8_t RawConfig[QUIC_GLOBAL_EXECUTION_CONFIG_MIN_SIZE + PartitionCount * sizeof(uint16_t)] = {0};
+    QUIC_GLOBAL_EXECUTION_CONFIG* Config = (QUIC_GLOBAL_EXECUTION_CONFIG*)RawConfig;
+    Config->ProcessorCount = PartitionCount;
+    Config->ProcessorList[0] = 0;
+    Config->ProcessorList[1] = (uint16_t)(CxPlatProcCount() > 1 ? 1 : 0);
+
+    CXPLAT_DATAPATH_INIT_CONFIG InitConfig = {0};
+    InitConfig.EnableCidSteering = TRUE;
+    CidSteeringRecvContext RecvContext;
+    CxPlatDataPath Datapath(&CidSteeringRecvCallbacks, nullptr, 0, Config, &InitConfig);
+    VERIFY_QUIC_SUCCESS(Datapath.GetInitStatus());
+    ASSERT_NE(nullptr, Datapath.Datapath);
+    if (!Datapath.IsSupported(CXPLAT_DATAPATH_FEATURE_CID_STEERING) || UseDuoNic) {
+        std::cout << "SKIP: CID Steering Feature Unsupported" << std::endl;
+        return;
+    }
+
+    auto unspecAddress = GetNewUnspecAddr();
+    CXPLAT_UDP_CONFIG UdpConfig = {0};
+    UdpConfig.LocalAddress = &unspecAddress.SockAddr;
+    UdpConfig.CallbackContext = &RecvContext;
+    UdpConfig.PartitionIdOffsetDst = 0;
+    UdpConfig.PartitionIdMask = PartitionMask;
+    UdpConfig.PartitionCount = PartitionCount;
+    CXPLAT_SOCKET* Server = nullptr;
+    QUIC_STATUS Status = CxPlatSocketCreateUdp(Datapath, &UdpConfig, &Server);
+    while (Status == QUIC_STATUS_ADDRESS_IN_USE) {
+        unspecAddress.SockAddr.Ipv4.sin_port = GetNextPort();
+        Status = CxPlatSocketCreateUdp(Datapath, &UdpConfig, &Server);
+    }
+    VERIFY_QUIC_SUCCESS(Status);
+    ASSERT_NE(nullptr, Server);
+
+    QUIC_ADDR ServerAddress = GetNewLocalAddr().SockAddr;
+    CxPlatSocketGetLocalAddress(Server, &unspecAddress.SockAddr);
+    ServerAddress.Ipv4.sin_port = unspecAddress.SockAddr.Ipv4.sin_port;
+
+    CxPlatSocket Client(Datapath, nullptr, &ServerAddress, nullptr);
+    VERIFY_QUIC_SUCCESS(Client.GetInitStatus());
+    ASSERT_NE(nullptr, Client.Socket);
+
+    //
+    // Every short header packet must land on the partition its CID encodes,
+    // whatever the random upper bits of the partition ID are.
+    //
+    for (uint32_t i = 0; i < 16; ++i) {
+        const uint16_t ExpectedPartition = (uint16_t)(i % PartitionCount);
+        uint16_t PartitionId;
+        CxPlatRandom(sizeof(PartitionId), &PartitionId);
+        PartitionId = (uint16_t)((PartitionId & ~PartitionMask) | ExpectedPartition);
+
+        CXPLAT_SEND_CONFIG SendConfig = { &Client.Route, 0, CXPLAT_ECN_NON_ECT, 0, CXPLAT_DSCP_CS0 };
+        auto ClientSendData = CxPlatSendDataAlloc(Client, &SendConfig);
+        ASSERT_NE(nullptr, ClientSendData);
+        auto ClientBuffer = CxPlatSendDataAllocBuffer(ClientSendData, 64);
+        ASSERT_NE(nullptr, ClientBuffer);
+        CxPlatZeroMemory(ClientBuffer->Buffer, 64);
+        ClientBuffer->Buffer[0] = 0x40; // Short header
+        memcpy(ClientBuffer->Buffer + 1, &PartitionId, sizeof(PartitionId));
+
+        Client.Send(ClientSendData);
+        ASSERT_TRUE(CxPlatEventWaitWithTimeout(RecvContext.Received, 2000));
+        ASSERT_EQ(ExpectedPartition, RecvContext.PartitionIndex);
+    }
+
+    CxPlatSocketDelete(Server);
+}
+
 TEST_P(DataPathTest, UdpShareClientSocket)
 {
     UdpRecvContext RecvContext;
@@ -0,0 +1,360 @@
+/*++
+
+    Copyright (c) Microsoft Corporation.
+    Licensed under the MIT License.
+
+Abstract:
+
+    Unit test and benchmark for the chained and open addressing hash table
+    backends.
+
+--*/
+
+#include "main.h"
+#include <stdio.h>
+#include <vector>
+#include <algorithm>
+#include <random>
+
+#ifdef QUIC_CLOG
+#include "HashtableTest.cpp.clog.h"
+#endif
+
+struct HashtableTestEntry {
+    CXPLAT_HASHTABLE_ENTRY Entry;
+    uint64_t Key;
+    bool Visited;
+};
+
+//
+// Spreads sequential indexes over the whole 64-bit signature space.
+//
+static
+uint64_t
+HashtableTestKey(
+    uint64_t Index
+    )
+{
+    uint64_t Z = Index + 0x9E3779B97F4A7C15ull;
+    Z = (Z ^ (Z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    Z = (Z ^ (Z >> 27)) * 0x94D049BB133111EBull;
+    return Z ^ (Z >> 31);
+}
+
+static
+uint32_t
+HashtableTestInitialSize(
+    uint32_t Flags
+    )
+{
+    return
+        (Flags & CXPLAT_HASH_OPEN_ADDRESSING) ?
+            CXPLAT_HASH_OPEN_ADDRESSING_MIN_SIZE : CXPLAT_HASH_MIN_SIZE;
+}
+
+struct HashtableTest : public ::testing::TestWithParam<uint32_t> {
+    CXPLAT_HASHTABLE* Table {nullptr};
+
+    void SetUp() override {
+        ASSERT_TRUE(
+            CxPlatHashtableInitializeWithFlags(
+                &Table, HashtableTestInitialSize(GetParam()), GetParam()));
+    }
+
+    void TearDown() override {
+        if (Table != nullptr) {
+            CxPlatHashtableUninitialize(Table);
+        }
+    }
+
+    HashtableTestEntry* Find(uint64_t Key) {
+        CXPLAT_HASHTABLE_LOOKUP_CONTEXT Context;
+        CXPLAT_HASHTABLE_ENTRY* Entry = CxPlatHashtableLookup(Table, Key, &Context);
+        while (Entry != nullptr) {
+            auto TestEntry = CXPLAT_CONTAINING_RECORD(Entry, HashtableTestEntry, Entry);
+            if (TestEntry->Key == Key) {
+                return TestEntry;
+            }
+            Entry = CxPlatHashtableLookupNext(Table, &Context);
+        }
+        return nullptr;
+    }
+
+    uint32_t Enumerate(bool Remove) {
+        uint32_t Count = 0;
+        CXPLAT_HASHTABLE_ENUMERATOR Enumerator;
+        CXPLAT_HASHTABLE_ENTRY* Entry;
+        CxPlatHashtableEnumerateBegin(Table, &Enumerator);
+        while ((Entry = CxPlatHashtableEnumerateNext(Table, &Enumerator)) != nullptr) {
+            auto TestEntry = CXPLAT_CONTAINING_RECORD(Entry, HashtableTestEntry, Entry);
+            EXPECT_FALSE(TestEntry->Visited);
+            TestEntry->Visited = true;
+            if (Remove) {
+                CxPlatHashtableRemove(Table, Entry, nullptr);
+            }
+            Count++;
+        }
+        CxPlatHashtableEnumerateEnd(Table, &Enumerator);
+        return Count;
+    }
+};
+
+TEST(HashtableTest, InvalidInitialize)
+{
+    CXPLAT_HASHTABLE* Table = nullptr;
+    ASSERT_FALSE(CxPlatHashtableInitializeWithFlags(&Table, 100, CXPLAT_HASH_OPEN_ADDRESSING));
+    ASSERT_FALSE(CxPlatHashtableInitializeWithFlags(&Table, 8, CXPLAT_HASH_OPEN_ADDRESSING));
+    ASSERT_FALSE(CxPlatHashtableInitializeWithFlags(&Table, CXPLAT_HASH_MIN_SIZE, 0x80));
+    ASSERT_EQ(nullptr, Table);
+}
+
+TEST_P(HashtableTest, InsertLookupRemove)
+{
+    const uint32_t Count = 5000;
+    std::vector<HashtableTestEntry> Entries(Count);
+    for (uint32_t i = 0; i < Count; ++i) {
+        Entries[i].Key = HashtableTestKey(i);
+        Entries[i].Visited = false;
+        ASSERT_TRUE(CxPlatHashtableInsert(Table, &Entries[i].Entry, Entries[i].Key, nullptr));
+    }
+    ASSERT_EQ(Count, Table->NumEntries);
+
+    for (uint32_t i = 0; i < Count; ++i) {
+        ASSERT_EQ(&Entries[i], Find(Entries[i].Key));
+    }
+    ASSERT_EQ(nullptr, Find(HashtableTestKey(Count)));
+
+    for (uint32_t i = 0; i < Count; i += 2) {
+        CxPlatHashtableRemove(Table, &Entries[i].Entry, nullptr);
+    }
+    ASSERT_EQ(Count / 2, Table->NumEntries);
+
+    for (uint32_t i = 0; i < Count; ++i) {
+        ASSERT_EQ((i % 2) ? &Entries[i] : nullptr, Find(Entries[i].Key));
+    }
+
+    for (uint32_t i = 1; i < Count; i += 2) {
+        CxPlatHashtableRemove(Table, &Entries[i].Entry, nullptr);
+    }
+    ASSERT_EQ(0u, Table->NumEntries);
+}
+
+TEST_P(HashtableTest, SequentialSignatures)
+{
+    //
+    // Stream IDs are sequential with a stride of 4, and 0 is a valid ID.
+    //
+    const uint32_t Count = 2000;
+    std::vector<HashtableTestEntry> Entries(Count);
+    for (uint32_t i = 0; i < Count; ++i) {
+        Entries[i].Key = (uint64_t)i * 4;
+        Entries[i].Visited = false;
+        ASSERT_TRUE(CxPlatHashtableInsert(Table, &Entries[i].Entry, Entries[i].Key, nullptr));
+    }
+    for (uint32_t i = 0; i < Count; ++i) {
+        ASSERT_EQ(&Entries[i], Find(Entries[i].Key));
+        ASSERT_EQ(nullptr, Find(Entries[i].Key + 1));
+    }
+    for (uint32_t i = 0; i < Count; ++i) {
+        CxPlatHashtableRemove(Table, &Entries[i].Entry, nullptr);
+    }
+}
+
+TEST_P(HashtableTest, DuplicateSignatures)
+{
+    const uint32_t Count = 40;
+    std::vector<HashtableTestEntry> Entries(Count);
+    for (uint32_t i = 0; i < Count; ++i) {
+        Entries[i].Key = 0x1234;
+        Entries[i].Visited = false;
+        ASSERT_TRUE(CxPlatHashtableInsert(Table, &Entries[i].Entry, Entries[i].Key, nullptr));
+    }
+
+    uint32_t Found = 0;
+    CXPLAT_HASHTABLE_LOOKUP_CONTEXT Context;
+    CXPLAT_HASHTABLE_ENTRY* Entry = CxPlatHashtableLookup(Table, 0x1234, &Context);
+    while (Entry != nullptr) {
+        auto TestEntry = CXPLAT_CONTAINING_RECORD(Entry, HashtableTestEntry, Entry);
+        ASSERT_FALSE(TestEntry->Visited);
+        TestEntry->Visited = true;
+        Found++;
+        Entry = CxPlatHashtableLookupNext(Table, &Context);
+    }
+    ASSERT_EQ(Count, Found);
+
+    for (uint32_t i = 0; i < Count; ++i) {
+        CxPlatHashtableRemove(Table, &Entries[i].Entry, nullptr);
+    }
+    ASSERT_EQ(nullptr, CxPlatHashtableLookup(Table, 0x1234, nullptr));
+}
+
+TEST_P(HashtableTest, EnumerateAndRemove)
+{
+    const uint32_t Count = 1000;
+    std::vector<HashtableTestEntry> Entries(Count);
+    for (uint32_t i = 0; i < Count; ++i) {
+        Entries[i].Key = HashtableTestKey(i);
+        Entries[i].Visited = false;
+        ASSERT_TRUE(CxPlatHashtableInsert(Table, &Entries[i].Entry, Entries[i].Key, nullptr));
+    }
+
+    ASSERT_EQ(Count, Enumerate(false));
+    for (auto& TestEntry : Entries) {
+        ASSERT_TRUE(TestEntry.Visited);
+        TestEntry.Visited = false;
+    }
+
+    ASSERT_EQ(Count, Enumerate(true));
+    ASSERT_EQ(0u, Table->NumEntries);
+    ASSERT_EQ(0u, Enumerate(false));
+}
+
+TEST_P(HashtableTest, Churn)
+{
+    //
+    // Keeps the table at a steady size while cycling through many keys, which
+    // leaves tombstones behind in the open addressing table.
+    //
+    const uint32_t Live = 300;
+    const uint32_t Rounds = 50;
+    std::vector<HashtableTestEntry> Entries(Live);
+    for (uint32_t i = 0; i < Live; ++i) {
+        Entries[i].Key = HashtableTestKey(i);
+        ASSERT_TRUE(CxPlatHashtableInsert(Table, &Entries[i].Entry, Entries[i].Key, nullptr));
+    }
+
+    for (uint32_t Round = 1; Round < Rounds; ++Round) {
+        for (uint32_t i = 0; i < Live; ++i) {
+            CxPlatHashtableRemove(Table, &Entries[i].Entry, nullptr);
+            ASSERT_EQ(nullptr, Find(Entries[i].Key));
+            Entries[i].Key = HashtableTestKey((uint64_t)Round * Live + i);
+            ASSERT_TRUE(CxPlatHashtableInsert(Table, &Entries[i].Entry, Entries[i].Key, nullptr));
+        }
+        for (uint32_t i = 0; i < Live; ++i) {
+            ASSERT_EQ(&Entries[i], Find(Entries[i].Key));
+        }
+    }
+    ASSERT_EQ(Live, Table->NumEntries);
+
+    if (GetParam() & CXPLAT_HASH_OPEN_ADDRESSING) {
+        //
+        // Tombstones are recycled rather than growing the table without bound.
+        //
+        ASSERT_LE(Table->TableSize, 1024u);
+    }
+
+    for (uint32_t i = 0; i < Live; ++i) {
+        CxPlatHashtableRemove(Table, &Entries[i].Entry, nullptr);
+    }
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    HashtableTest,
+    HashtableTest,
+    ::testing::Values(0u, (uint32_t)CXPLAT_HASH_OPEN_ADDRESSING));
+
+struct HashtableBenchmarkTest : public ::testing::Test {
+
+    static
+    double
+    NsPerOp(
+        uint64_t StartUs,
+        uint32_t Count
+        )
+    {
+        return (double)CxPlatTimeDiff64(StartUs, CxPlatTimeUs64()) * 1000.0 / Count;
+    }
+
+    static
+    void
+    Run(
+        uint32_t Flags,
+        uint32_t Count
+        )
+    {
+        std::vector<HashtableTestEntry> Entries(Count);
+        std::vector<uint32_t> Order(Count);
+        for (uint32_t i = 0; i < Count; ++i) {
+            Entries[i].Key = HashtableTestKey(i);
+            Order[i] = i;
+        }
+        std::shuffle(Order.begin(), Order.end(), std::mt19937(Count));
+
+        CXPLAT_HASHTABLE* Table = nullptr;
+        ASSERT_TRUE(
+            CxPlatHashtableInitializeWithFlags(
+                &Table, HashtableTestInitialSize(Flags), Flags));
+
+        uint64_t Start = CxPlatTimeUs64();
+        for (uint32_t i = 0; i < Count; ++i) {
+            ASSERT_TRUE(CxPlatHashtableInsert(Table, &Entries[i].Entry, Entries[i].Key, nullptr));
+        }
+        double InsertNs = NsPerOp(Start, Count);
+
+        uint32_t Found = 0;
+        Start = CxPlatTimeUs64();
+        for (uint32_t i = 0; i < Count; ++i) {
+            const uint64_t Key = Entries[Order[i]].Key;
+            CXPLAT_HASHTABLE_LOOKUP_CONTEXT Context;
+            CXPLAT_HASHTABLE_ENTRY* Entry = CxPlatHashtableLookup(Table, Key, &Context);
+            while (Entry != nullptr) {
+                if (CXPLAT_CONTAINING_RECORD(Entry, HashtableTestEntry, Entry)->Key == Key) {
+                    Found++;
+                    break;
+                }
+                Entry = CxPlatHashtableLookupNext(Table, &Context);
+            }
+        }
+        double LookupNs = NsPerOp(Start, Count);
+        ASSERT_EQ(Count, Found);
+
+        Start = CxPlatTimeUs64();
+        for (uint32_t i = 0; i < Count; ++i) {
+            Found += CxPlatHashtableLookup(Table, HashtableTestKey((uint64_t)Count + i), nullptr) != nullptr;
+        }
+        double MissNs = NsPerOp(Start, Count);
+        ASSERT_EQ(Count, Found);
+
+        Start = CxPlatTimeUs64();
+        for (uint32_t i = 0; i < Count; ++i) {
+            CxPlatHashtableRemove(Table, &Entries[Order[i]].Entry, nullptr);
+        }
+        double RemoveNs = NsPerOp(Start, Count);
+
+        const std::string Prefix =
+            ((Flags & CXPLAT_HASH_OPEN_ADDRESSING) ? "OpenAddressing" : "Chained") +
+            std::to_string(Count);
+        RecordBenchmarkResult(Prefix + "InsertNs", InsertNs);
+        RecordBenchmarkResult(Prefix + "LookupNs", LookupNs);
+        RecordBenchmarkResult(Prefix + "MissNs", MissNs);
+        RecordBenchmarkResult(Prefix + "RemoveNs", RemoveNs);
+
+        CxPlatHashtableUninitialize(Table);
+    }
+
+    static
+    void
+    RunAll(
+        uint32_t MaxCount
+        )
+    {
+        for (uint32_t Count = 1000; Count <= MaxCount; Count *= 10) {
+            Run(0, Count);
+            Run(CXPLAT_HASH_OPEN_ADDRESSING, Count);
+        }
+    }
+};
+
+//
+// The benchmarks are only run explicitly (--gtest_also_run_disabled_tests).
+//
+
+TEST_F(HashtableBenchmarkTest, DISABLED_InsertLookupRemove)
+{
+    RunAll(100000);
+}
+
+TEST_F(HashtableBenchmarkTest, DISABLED_InsertLookupRemoveLarge)
+{
+    RunAll(10000000);
+}
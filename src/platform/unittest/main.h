@@ -19,3 +19,19 @@
 
 #define GTEST_SKIP_NO_RETURN_(message) \
   GTEST_MESSAGE_(message, ::testing::TestPartResult::kSkip)
+
+//
+// Benchmarks report their results as test properties, which end up in the XML
+// output (--gtest_output=xml) instead of on the console.
+//
+inline
+void
+RecordBenchmarkResult(
+    _In_ const std::string& Name,
+    _In_ double Value
+    )
+{
+    char Str[32];
+    snprintf(Str, sizeof(Str), "%.2f", Value);
+    ::testing::Test::RecordProperty(Name, Str);
+}
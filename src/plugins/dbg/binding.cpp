@@ -71,15 +71,19 @@ EXT_COMMAND(
             Conn.TypeStr());
     } else {
         for (UCHAR i = 0; i < PartitionCount; i++) {
-            HashTable Hash(Lookup.GetLookupTable(i).GetTablePtr());
-            Dml("\t<link cmd=\"dt msquic!CXPLAT_HASHTABLE 0x%I64X\">Hash Table %d</link> (%u entries)\n",
-                Hash.Addr,
+            LookupHashTable Table = Lookup.GetLookupTable(i);
+            Dml("\t<link cmd=\"dt msquic!QUIC_LOOKUP_CID_TABLE 0x%I64X\">Hash Table %d</link> (%u entries)\n",
+                Table.Addr,
                 i,
-                Hash.NumEntries());
-            ULONG64 EntryPtr;
-            while (!CheckControlC() && Hash.GetNextEntry(&EntryPtr)) {
-                CidHashEntry Entry = CidHashEntry::FromEntry(EntryPtr);
-                Cid Cid(Entry.GetCid());
+                Table.Count());
+            ULONG SlotCount = Table.SlotCount();
+            for (ULONG j = 0; j < SlotCount && !CheckControlC(); j++) {
+                ULONG64 EntryPtr = Table.GetSlot(j);
+                if (EntryPtr == 0) {
+                    continue;
+                }
+                LookupCid Entry(EntryPtr);
+                Cid Cid(Entry.GetSourceCid().GetCid());
                 Connection Conn(Entry.GetConnection());
                 Dml("\t  <link cmd=\"!quicconnection 0x%I64X\">Connection 0x%I64X</link> [%s] [%s]\n",
                     Conn.Addr,
@@ -336,12 +336,15 @@ ComputeDirIndices(
     *FirstLevelIndex -= KDEXT_RTL_HT_SECOND_LEVEL_DIR_SHIFT;
 }
 
+#define CXPLAT_HASH_OPEN_ADDRESSING 0x00000002
+
 struct HashTable : Struct {
 
     ULONG TableSize;
     ULONG64 Directory;
     ULONG EntryLinksOffset;
     int Indirection;
+    bool OpenAddressing;
 
     bool ReadBucketHead;
     ULONG Bucket;
@@ -354,6 +357,7 @@ struct HashTable : Struct {
     HashTable(ULONG64 addr) : Struct("msquic!CXPLAT_HASHTABLE", addr) {
         TableSize = ReadType<ULONG>("TableSize");
         Directory = ReadPointer("Directory");
+        OpenAddressing = (ReadType<ULONG>("Flags") & CXPLAT_HASH_OPEN_ADDRESSING) != 0;
         GetFieldOffset("msquic!CXPLAT_HASHTABLE_ENTRY", "Linkage", &EntryLinksOffset);
         Indirection = (TableSize <= KDEXT_RTL_HT_SECOND_LEVEL_DIR_SIZE) ? 1 : 2;
 
@@ -368,7 +372,37 @@ struct HashTable : Struct {
         return ReadType<ULONG>("NumEntries");
     }
 
+    bool GetNextOpenAddressingEntry(ULONG64* EntryAddress) {
+        //
+        // Control bytes are followed by { uint64_t Signature; Entry* } slots.
+        //
+        ULONG SlotSize = 8 + ((g_ExtInstance.m_PtrSize + 7) & ~7);
+        for (; Bucket < TableSize; Bucket++) {
+            UCHAR Control;
+            if (!ReadTypeAtAddr<UCHAR>(Directory + Bucket, &Control)) {
+                dprintf("Failed to read control byte %08lx\n", Bucket);
+                return false;
+            }
+            if (Control & 0x80) {
+                continue; // Empty or deleted
+            }
+            if (!ReadPointerAtAddr(
+                    Directory + TableSize + Bucket * SlotSize + 8,
+                    EntryAddress)) {
+                dprintf("Failed to read slot %08lx\n", Bucket);
+                return false;
+            }
+            Bucket++;
+            return true;
+        }
+        return false;
+    }
+
     bool GetNextEntry(ULONG64* EntryAddress) {
+        if (OpenAddressing) {
+            return GetNextOpenAddressingEntry(EntryAddress);
+        }
+
         for (Bucket; Bucket < TableSize; Bucket++) {
 
             if (ReadBucketHead) {
@@ -1032,6 +1066,7 @@ typedef enum QUIC_API_TYPE {
     QUIC_API_TYPE_DATAGRAM_SEND,
     QUIC_API_TYPE_CONN_COMPLETE_RESUMPTION_TICKET_VALIDATION,
     QUIC_API_TYPE_CONN_COMPLETE_CERTIFICATE_VALIDATION,
+    QUIC_API_TYPE_STRM_SEND_BATCH,
 
 } QUIC_API_TYPE;
 
@@ -1069,6 +1104,8 @@ struct ApiCall : Struct {
             return "API_TYPE_STRM_RECV_SET_ENABLED";
         case QUIC_API_TYPE_STRM_PROVIDE_RECV_BUFFERS:
             return "API_TYPE_STRM_PROVIDE_RECV_BUFFERS";
+        case QUIC_API_TYPE_STRM_SEND_BATCH:
+            return "API_STRM_SEND_BATCH";
         case QUIC_API_TYPE_SET_PARAM:
             return "API_SET_PARAM";
         case QUIC_API_TYPE_GET_PARAM:
@@ -1526,12 +1563,38 @@ struct Registration : Struct {
     }
 };
 
+struct LookupCid : Struct {
+
+    LookupCid(ULONG64 Addr) : Struct("msquic!QUIC_LOOKUP_CID", Addr) { }
+
+    ULONG64 GetConnection() {
+        return ReadPointer("Connection");
+    }
+
+    CidHashEntry GetSourceCid() {
+        return CidHashEntry(ReadPointer("SourceCid"));
+    }
+};
+
 struct LookupHashTable : Struct {
 
-    LookupHashTable(ULONG64 Addr) : Struct("msquic!QUIC_PARTITIONED_HASHTABLE", Addr) { }
+    LookupHashTable(ULONG64 Addr) : Struct("msquic!QUIC_LOOKUP_CID_TABLE", Addr) { }
+
+    ULONG Count() {
+        return ReadType<ULONG>("Count");
+    }
 
-    ULONG64 GetTablePtr() {
-        return AddrOf("Table"); // TODO - Need Hash Table Enumeration.
+    ULONG SlotCount() {
+        return ReadType<ULONG>("Mask") + 1;
+    }
+
+    //
+    // Returns the CID entry in the slot, or 0 for an empty slot or tombstone.
+    //
+    ULONG64 GetSlot(ULONG Index) {
+        ULONG64 Entry = 0;
+        ReadPointerAtAddr(AddrOf("Slots") + Index * g_ExtInstance.m_PtrSize, &Entry);
+        return Entry <= 1 ? 0 : Entry;
     }
 };
 
@@ -1552,13 +1615,17 @@ struct Lookup : Struct {
     }
 
     ULONG64 GetLookupPtr() {
-        return ReadPointer("LookupTable");
+        return ReadPointer("SINGLE.Connection");
     }
 
     LookupHashTable GetLookupTable(UCHAR Index) {
-        ULONG64 ArrayAddr = ReadPointer("LookupTable");
+        ULONG64 PartitionsAddr = ReadPointer("HASH.Partitions");
+        ULONG TablesOffset = 0;
+        GetFieldOffset("msquic!QUIC_LOOKUP_PARTITIONS", "Tables", &TablesOffset);
         ULONG TypeSize = GetTypeSize("msquic!QUIC_PARTITIONED_HASHTABLE");
-        return LookupHashTable(ArrayAddr + Index * TypeSize);
+        ULONG64 TableAddr = 0;
+        ReadPointerAtAddr(PartitionsAddr + TablesOffset + Index * TypeSize, &TableAddr);
+        return LookupHashTable(TableAddr);
     }
 };
 
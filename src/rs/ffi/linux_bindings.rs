@@ -442,6 +442,10 @@ pub const QUIC_GLOBAL_EXECUTION_CONFIG_FLAGS_QUIC_GLOBAL_EXECUTION_CONFIG_FLAG_H
     QUIC_GLOBAL_EXECUTION_CONFIG_FLAGS = 16;
 pub const QUIC_GLOBAL_EXECUTION_CONFIG_FLAGS_QUIC_GLOBAL_EXECUTION_CONFIG_FLAG_AFFINITIZE:
     QUIC_GLOBAL_EXECUTION_CONFIG_FLAGS = 32;
+pub const QUIC_GLOBAL_EXECUTION_CONFIG_FLAGS_QUIC_GLOBAL_EXECUTION_CONFIG_FLAG_WORK_STEALING:
+    QUIC_GLOBAL_EXECUTION_CONFIG_FLAGS = 64;
+pub const QUIC_GLOBAL_EXECUTION_CONFIG_FLAGS_QUIC_GLOBAL_EXECUTION_CONFIG_FLAG_BUSY_POLL:
+    QUIC_GLOBAL_EXECUTION_CONFIG_FLAGS = 128;
 pub type QUIC_GLOBAL_EXECUTION_CONFIG_FLAGS = ::std::os::raw::c_uint;
 #[repr(C)]
 #[derive(Debug, Copy, Clone)]
@@ -1195,10 +1199,12 @@ pub struct QUIC_STATISTICS_V2 {
     pub SendEcnCongestionCount: u32,
     pub HandshakeHopLimitTTL: u8,
     pub RttVariance: u32,
+    pub RecvAckProcessingTimeUs: u64,
+    pub RecvMaxAckProcessingTimeUs: u64,
 }
 #[allow(clippy::unnecessary_operation, clippy::identity_op)]
 const _: () = {
-    ["Size of QUIC_STATISTICS_V2"][::std::mem::size_of::<QUIC_STATISTICS_V2>() - 208usize];
+    ["Size of QUIC_STATISTICS_V2"][::std::mem::size_of::<QUIC_STATISTICS_V2>() - 224usize];
     ["Alignment of QUIC_STATISTICS_V2"][::std::mem::align_of::<QUIC_STATISTICS_V2>() - 8usize];
     ["Offset of field: QUIC_STATISTICS_V2::CorrelationId"]
         [::std::mem::offset_of!(QUIC_STATISTICS_V2, CorrelationId) - 0usize];
@@ -1266,6 +1272,10 @@ const _: () = {
         [::std::mem::offset_of!(QUIC_STATISTICS_V2, HandshakeHopLimitTTL) - 200usize];
     ["Offset of field: QUIC_STATISTICS_V2::RttVariance"]
         [::std::mem::offset_of!(QUIC_STATISTICS_V2, RttVariance) - 204usize];
+    ["Offset of field: QUIC_STATISTICS_V2::RecvAckProcessingTimeUs"]
+        [::std::mem::offset_of!(QUIC_STATISTICS_V2, RecvAckProcessingTimeUs) - 208usize];
+    ["Offset of field: QUIC_STATISTICS_V2::RecvMaxAckProcessingTimeUs"]
+        [::std::mem::offset_of!(QUIC_STATISTICS_V2, RecvMaxAckProcessingTimeUs) - 216usize];
 };
 impl QUIC_STATISTICS_V2 {
     #[inline]
@@ -1683,7 +1693,17 @@ pub const QUIC_PERFORMANCE_COUNTERS_QUIC_PERF_COUNTER_CONN_LOAD_REJECT: QUIC_PER
     31;
 pub const QUIC_PERFORMANCE_COUNTERS_QUIC_PERF_COUNTER_LISTEN_QUEUE_DEPTH:
     QUIC_PERFORMANCE_COUNTERS = 32;
-pub const QUIC_PERFORMANCE_COUNTERS_QUIC_PERF_COUNTER_MAX: QUIC_PERFORMANCE_COUNTERS = 33;
+pub const QUIC_PERFORMANCE_COUNTERS_QUIC_PERF_COUNTER_WORK_DRAIN_BUDGET:
+    QUIC_PERFORMANCE_COUNTERS = 33;
+pub const QUIC_PERFORMANCE_COUNTERS_QUIC_PERF_COUNTER_UDP_RECV_COALESCED:
+    QUIC_PERFORMANCE_COUNTERS = 34;
+pub const QUIC_PERFORMANCE_COUNTERS_QUIC_PERF_COUNTER_UDP_RECV_COALESCED_SEGMENTS:
+    QUIC_PERFORMANCE_COUNTERS = 35;
+pub const QUIC_PERFORMANCE_COUNTERS_QUIC_PERF_COUNTER_WORK_CONN_STOLEN:
+    QUIC_PERFORMANCE_COUNTERS = 36;
+pub const QUIC_PERFORMANCE_COUNTERS_QUIC_PERF_COUNTER_WORK_CONN_MIGRATED:
+    QUIC_PERFORMANCE_COUNTERS = 37;
+pub const QUIC_PERFORMANCE_COUNTERS_QUIC_PERF_COUNTER_MAX: QUIC_PERFORMANCE_COUNTERS = 38;
 pub type QUIC_PERFORMANCE_COUNTERS = ::std::os::raw::c_uint;
 #[repr(C)]
 #[derive(Debug, Copy, Clone)]
@@ -6549,6 +6569,42 @@ pub type QUIC_STREAM_PROVIDE_RECEIVE_BUFFERS_FN = ::std::option::Option<
         Buffers: *const QUIC_BUFFER,
     ) -> ::std::os::raw::c_uint,
 >;
+#[repr(C)]
+#[derive(Debug, Copy, Clone)]
+pub struct QUIC_STREAM_SEND_BATCH_ENTRY {
+    pub Stream: HQUIC,
+    pub Buffers: *const QUIC_BUFFER,
+    pub BufferCount: u32,
+    pub Flags: QUIC_SEND_FLAGS,
+    pub ClientSendContext: *mut ::std::os::raw::c_void,
+    pub Status: ::std::os::raw::c_uint,
+}
+#[allow(clippy::unnecessary_operation, clippy::identity_op)]
+const _: () = {
+    ["Size of QUIC_STREAM_SEND_BATCH_ENTRY"]
+        [::std::mem::size_of::<QUIC_STREAM_SEND_BATCH_ENTRY>() - 40usize];
+    ["Alignment of QUIC_STREAM_SEND_BATCH_ENTRY"]
+        [::std::mem::align_of::<QUIC_STREAM_SEND_BATCH_ENTRY>() - 8usize];
+    ["Offset of field: QUIC_STREAM_SEND_BATCH_ENTRY::Stream"]
+        [::std::mem::offset_of!(QUIC_STREAM_SEND_BATCH_ENTRY, Stream) - 0usize];
+    ["Offset of field: QUIC_STREAM_SEND_BATCH_ENTRY::Buffers"]
+        [::std::mem::offset_of!(QUIC_STREAM_SEND_BATCH_ENTRY, Buffers) - 8usize];
+    ["Offset of field: QUIC_STREAM_SEND_BATCH_ENTRY::BufferCount"]
+        [::std::mem::offset_of!(QUIC_STREAM_SEND_BATCH_ENTRY, BufferCount) - 16usize];
+    ["Offset of field: QUIC_STREAM_SEND_BATCH_ENTRY::Flags"]
+        [::std::mem::offset_of!(QUIC_STREAM_SEND_BATCH_ENTRY, Flags) - 20usize];
+    ["Offset of field: QUIC_STREAM_SEND_BATCH_ENTRY::ClientSendContext"]
+        [::std::mem::offset_of!(QUIC_STREAM_SEND_BATCH_ENTRY, ClientSendContext) - 24usize];
+    ["Offset of field: QUIC_STREAM_SEND_BATCH_ENTRY::Status"]
+        [::std::mem::offset_of!(QUIC_STREAM_SEND_BATCH_ENTRY, Status) - 32usize];
+};
+pub type QUIC_STREAM_SEND_BATCH_FN = ::std::option::Option<
+    unsafe extern "C" fn(
+        Connection: HQUIC,
+        Entries: *mut QUIC_STREAM_SEND_BATCH_ENTRY,
+        EntryCount: u32,
+    ) -> ::std::os::raw::c_uint,
+>;
 pub type QUIC_DATAGRAM_SEND_FN = ::std::option::Option<
     unsafe extern "C" fn(
         Connection: HQUIC,
@@ -6655,10 +6711,11 @@ pub struct QUIC_API_TABLE {
     pub ExecutionDelete: QUIC_EXECUTION_DELETE_FN,
     pub ExecutionPoll: QUIC_EXECUTION_POLL_FN,
     pub RegistrationClose2: QUIC_REGISTRATION_CLOSE2_FN,
+    pub StreamSendBatch: QUIC_STREAM_SEND_BATCH_FN,
 }
 #[allow(clippy::unnecessary_operation, clippy::identity_op)]
 const _: () = {
-    ["Size of QUIC_API_TABLE"][::std::mem::size_of::<QUIC_API_TABLE>() - 304usize];
+    ["Size of QUIC_API_TABLE"][::std::mem::size_of::<QUIC_API_TABLE>() - 312usize];
     ["Alignment of QUIC_API_TABLE"][::std::mem::align_of::<QUIC_API_TABLE>() - 8usize];
     ["Offset of field: QUIC_API_TABLE::SetContext"]
         [::std::mem::offset_of!(QUIC_API_TABLE, SetContext) - 0usize];
@@ -6740,6 +6797,8 @@ const _: () = {
         [::std::mem::offset_of!(QUIC_API_TABLE, ExecutionPoll) - 288usize];
     ["Offset of field: QUIC_API_TABLE::RegistrationClose2"]
         [::std::mem::offset_of!(QUIC_API_TABLE, RegistrationClose2) - 296usize];
+    ["Offset of field: QUIC_API_TABLE::StreamSendBatch"]
+        [::std::mem::offset_of!(QUIC_API_TABLE, StreamSendBatch) - 304usize];
 };
 pub const QUIC_STATUS_SUCCESS: QUIC_STATUS = 0;
 pub const QUIC_STATUS_PENDING: QUIC_STATUS = 4294967294;
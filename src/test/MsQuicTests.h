@@ -610,6 +610,10 @@ void
 QuicTestStreamMultiReceive(
     );
 
+void
+QuicTestStreamSendBatch(
+    );
+
 void
 QuicTestStreamBlockUnblockConnFlowControl(
     _In_ BOOLEAN Bidirectional
@@ -1415,4 +1419,7 @@ struct QUIC_RUN_CONNECTION_POOL_CREATE_PARAMS {
     QUIC_CTL_CODE(138, METHOD_BUFFERED, FILE_WRITE_DATA)
     // int - Family
 
-#define QUIC_MAX_IOCTL_FUNC_CODE 138
+#define IOCTL_QUIC_RUN_STREAM_SEND_BATCH \
+    QUIC_CTL_CODE(139, METHOD_BUFFERED, FILE_WRITE_DATA)
+
+#define QUIC_MAX_IOCTL_FUNC_CODE 139
@@ -2377,6 +2377,15 @@ TEST(Misc, StreamAppProvidedBuffersOutOfSpace) {
         QuicTestStreamAppProvidedBuffersOutOfSpace();
     }
 }
+
+TEST(Misc, StreamSendBatch) {
+    TestLogger Logger("QuicTestStreamSendBatch");
+    if (TestingKernelMode) {
+        ASSERT_TRUE(DriverClient.Run(IOCTL_QUIC_RUN_STREAM_SEND_BATCH));
+    } else {
+        QuicTestStreamSendBatch();
+    }
+}
 #endif // QUIC_API_ENABLE_PREVIEW_FEATURES
 
 TEST(Misc, StreamBlockUnblockUnidiConnFlowControl) {
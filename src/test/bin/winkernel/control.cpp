@@ -537,6 +537,7 @@ size_t QUIC_IOCTL_BUFFER_SIZES[] =
     0,
     0,
     sizeof(INT32),
+    0,
 };
 
 CXPLAT_STATIC_ASSERT(
@@ -1534,6 +1535,10 @@ QuicTestCtlEvtIoDeviceControl(
         QuicTestCtlRun(QuicTestStreamAppProvidedBuffersOutOfSpace());
         break;
 
+    case IOCTL_QUIC_RUN_STREAM_SEND_BATCH:
+        QuicTestCtlRun(QuicTestStreamSendBatch());
+        break;
+
     case IOCTL_QUIC_RUN_CONNECTION_POOL_CREATE:
         CXPLAT_FRE_ASSERT(Params != nullptr);
         QuicTestCtlRun(
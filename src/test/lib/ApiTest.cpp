@@ -1520,6 +1520,38 @@ void QuicTestValidateStream(bool Connect)
                     QUIC_SEND_FLAG_NONE,
                     nullptr));
 
+#ifdef QUIC_API_ENABLE_PREVIEW_FEATURES
+            //
+            // Invalid send batches.
+            //
+            {
+                TestScopeLogger logScope("Invalid send batches");
+                QUIC_STREAM_SEND_BATCH_ENTRY Entries[2] = {};
+                TEST_QUIC_STATUS(
+                    QUIC_STATUS_INVALID_PARAMETER,
+                    MsQuic->StreamSendBatch(nullptr, Entries, ARRAYSIZE(Entries)));
+                TEST_QUIC_STATUS(
+                    QUIC_STATUS_INVALID_PARAMETER,
+                    MsQuic->StreamSendBatch(Client.GetConnection(), nullptr, 1));
+                TEST_QUIC_STATUS(
+                    QUIC_STATUS_INVALID_PARAMETER,
+                    MsQuic->StreamSendBatch(Client.GetConnection(), Entries, 0));
+
+                //
+                // Bad entries fail individually.
+                //
+                Entries[0].Stream = nullptr;
+                Entries[0].Buffers = Buffers;
+                Entries[0].BufferCount = ARRAYSIZE(Buffers);
+                Entries[1].Stream = Client.GetConnection();
+                TEST_QUIC_STATUS(
+                    QUIC_STATUS_PENDING,
+                    MsQuic->StreamSendBatch(Client.GetConnection(), Entries, ARRAYSIZE(Entries)));
+                TEST_QUIC_STATUS(QUIC_STATUS_INVALID_PARAMETER, Entries[0].Status);
+                TEST_QUIC_STATUS(QUIC_STATUS_INVALID_PARAMETER, Entries[1].Status);
+            }
+#endif
+
             //
             // Never started (close).
             //
@@ -2308,18 +2340,27 @@ void QuicTestGlobalParam()
         {
             TestScopeLogger LogScope1("GetParam");
             {
+                SimpleGetParamTest(nullptr, QUIC_PARAM_GLOBAL_PERF_COUNTERS, QUIC_PERF_COUNTER_MAX * sizeof(int64_t), nullptr, true);
 #if DEBUG
                 //
                 // Only test this in debug mode, because release tests may be run on
                 // the installed binary that is actively being used, and the counters
-                // can be non-zero.
+                // can be non-zero. The drain budget is a per-worker setting rather
+                // than activity, so it is non-zero whenever any worker exists.
                 //
-                int64_t Buffer[QUIC_PERF_COUNTER_MAX] = {};
-                int64_t* ExpectedData = Buffer;
-#else
-                int64_t* ExpectedData = nullptr;
+                int64_t ActualBuffer[QUIC_PERF_COUNTER_MAX] = {};
+                int64_t ExpectedBuffer[QUIC_PERF_COUNTER_MAX] = {};
+                uint32_t Length = sizeof(ActualBuffer);
+                TEST_QUIC_SUCCEEDED(
+                    MsQuic->GetParam(
+                        nullptr,
+                        QUIC_PARAM_GLOBAL_PERF_COUNTERS,
+                        &Length,
+                        ActualBuffer));
+                TEST_EQUAL(Length, sizeof(ActualBuffer));
+                ActualBuffer[QUIC_PERF_COUNTER_WORK_DRAIN_BUDGET] = 0;
+                TEST_EQUAL(memcmp(ActualBuffer, ExpectedBuffer, Length), 0);
 #endif
-                SimpleGetParamTest(nullptr, QUIC_PARAM_GLOBAL_PERF_COUNTERS, QUIC_PERF_COUNTER_MAX * sizeof(int64_t), ExpectedData, true);
             }
 
             //
@@ -2896,7 +2937,8 @@ void QuicTestGlobalParam()
             QUIC_STATISTICS_V2_SIZE_1,
             QUIC_STATISTICS_V2_SIZE_2,
             QUIC_STATISTICS_V2_SIZE_3,
-            QUIC_STATISTICS_V2_SIZE_4
+            QUIC_STATISTICS_V2_SIZE_4,
+            QUIC_STATISTICS_V2_SIZE_5
         };
 
         //
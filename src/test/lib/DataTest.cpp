@@ -5058,4 +5058,127 @@ QuicTestStreamAppProvidedBuffersOutOfSpace(
     QuicTestStreamAppProvidedBuffersOutOfSpace_ServerSend();
 }
 
+//
+// Sends one buffer on each of several streams, plus a second one on the first
+// stream, with a single StreamSendBatch call.
+//
+struct StreamSendBatchTestContext {
+    static const uint32_t StreamCount = 4;
+    static const uint32_t EntryCount = StreamCount + 1;
+    static const uint32_t SendLength = 1000;
+
+    uint8_t SendData[SendLength] {0};
+    QUIC_BUFFER SendBuffer {SendLength, SendData};
+    long SendCompleteCount[EntryCount] {0};
+    long TotalSendCompleteCount {0};
+    long SendCanceledCount {0};
+    CxPlatEvent AllSendsComplete;
+
+    uint64_t ReceivedLength {0};
+    long ServerStreamsFinished {0};
+    CxPlatEvent AllStreamsFinished;
+
+    static QUIC_STATUS ClientStreamCallback(_In_ MsQuicStream*, _In_opt_ void* Context, _Inout_ QUIC_STREAM_EVENT* Event) {
+        auto TestContext = (StreamSendBatchTestContext*)Context;
+        if (Event->Type == QUIC_STREAM_EVENT_SEND_COMPLETE) {
+            InterlockedIncrement((long*)Event->SEND_COMPLETE.ClientContext);
+            if (Event->SEND_COMPLETE.Canceled) {
+                InterlockedIncrement(&TestContext->SendCanceledCount);
+            }
+            if (InterlockedIncrement(&TestContext->TotalSendCompleteCount) == (long)EntryCount) {
+                TestContext->AllSendsComplete.Set();
+            }
+        }
+        return QUIC_STATUS_SUCCESS;
+    }
+
+    static QUIC_STATUS ServerStreamCallback(_In_ MsQuicStream*, _In_opt_ void* Context, _Inout_ QUIC_STREAM_EVENT* Event) {
+        auto TestContext = (StreamSendBatchTestContext*)Context;
+        if (Event->Type == QUIC_STREAM_EVENT_RECEIVE) {
+            InterlockedExchangeAdd64((int64_t*)&TestContext->ReceivedLength, (int64_t)Event->RECEIVE.TotalBufferLength);
+        } else if (Event->Type == QUIC_STREAM_EVENT_PEER_SEND_SHUTDOWN) {
+            if (InterlockedIncrement(&TestContext->ServerStreamsFinished) == (long)StreamCount) {
+                TestContext->AllStreamsFinished.Set();
+            }
+        }
+        return QUIC_STATUS_SUCCESS;
+    }
+
+    static QUIC_STATUS ConnCallback(_In_ MsQuicConnection*, _In_opt_ void* Context, _Inout_ QUIC_CONNECTION_EVENT* Event) {
+        if (Event->Type == QUIC_CONNECTION_EVENT_PEER_STREAM_STARTED) {
+            new(std::nothrow) MsQuicStream(Event->PEER_STREAM_STARTED.Stream, CleanUpAutoDelete, ServerStreamCallback, Context);
+        }
+        return QUIC_STATUS_SUCCESS;
+    }
+};
+
+void
+QuicTestStreamSendBatch(
+    )
+{
+    MsQuicRegistration Registration(true);
+    TEST_QUIC_SUCCEEDED(Registration.GetInitStatus());
+
+    MsQuicConfiguration ServerConfiguration(Registration, "MsQuicTest", MsQuicSettings().SetPeerUnidiStreamCount(StreamSendBatchTestContext::StreamCount), ServerSelfSignedCredConfig);
+    TEST_QUIC_SUCCEEDED(ServerConfiguration.GetInitStatus());
+
+    MsQuicConfiguration ClientConfiguration(Registration, "MsQuicTest", MsQuicCredentialConfig());
+    TEST_QUIC_SUCCEEDED(ClientConfiguration.GetInitStatus());
+
+    StreamSendBatchTestContext Context;
+    MsQuicAutoAcceptListener Listener(Registration, ServerConfiguration, StreamSendBatchTestContext::ConnCallback, &Context);
+    TEST_QUIC_SUCCEEDED(Listener.GetInitStatus());
+    TEST_QUIC_SUCCEEDED(Listener.Start("MsQuicTest"));
+    QuicAddr ServerLocalAddr;
+    TEST_QUIC_SUCCEEDED(Listener.GetLocalAddr(ServerLocalAddr));
+
+    MsQuicConnection Connection(Registration);
+    TEST_QUIC_SUCCEEDED(Connection.GetInitStatus());
+    TEST_QUIC_SUCCEEDED(Connection.Start(ClientConfiguration, ServerLocalAddr.GetFamily(), QUIC_TEST_LOOPBACK_FOR_AF(ServerLocalAddr.GetFamily()), ServerLocalAddr.GetPort()));
+    TEST_TRUE(Connection.HandshakeCompleteEvent.WaitTimeout(TestWaitTimeout));
+    TEST_TRUE(Connection.HandshakeComplete);
+
+    UniquePtr<MsQuicStream> Streams[StreamSendBatchTestContext::StreamCount];
+    for (uint32_t i = 0; i < StreamSendBatchTestContext::StreamCount; ++i) {
+        Streams[i].reset(new(std::nothrow) MsQuicStream(Connection, QUIC_STREAM_OPEN_FLAG_UNIDIRECTIONAL, CleanUpManual, StreamSendBatchTestContext::ClientStreamCallback, &Context));
+        TEST_NOT_EQUAL(nullptr, Streams[i]);
+        TEST_QUIC_SUCCEEDED(Streams[i]->GetInitStatus());
+        TEST_QUIC_SUCCEEDED(Streams[i]->Start());
+    }
+
+    //
+    // The first stream gets two entries; only its last one has the FIN.
+    //
+    QUIC_STREAM_SEND_BATCH_ENTRY Entries[StreamSendBatchTestContext::EntryCount] = {};
+    for (uint32_t i = 0; i < StreamSendBatchTestContext::EntryCount; ++i) {
+        const uint32_t StreamIndex = i % StreamSendBatchTestContext::StreamCount;
+        Entries[i].Stream = Streams[StreamIndex]->Handle;
+        Entries[i].Buffers = &Context.SendBuffer;
+        Entries[i].BufferCount = 1;
+        Entries[i].Flags = i == 0 ? QUIC_SEND_FLAG_NONE : QUIC_SEND_FLAG_FIN;
+        Entries[i].ClientSendContext = &Context.SendCompleteCount[i];
+        Entries[i].Status = QUIC_STATUS_INTERNAL_ERROR;
+    }
+
+    TEST_QUIC_STATUS(
+        QUIC_STATUS_PENDING,
+        MsQuic->StreamSendBatch(Connection.Handle, Entries, ARRAYSIZE(Entries)));
+    for (uint32_t i = 0; i < StreamSendBatchTestContext::EntryCount; ++i) {
+        TEST_QUIC_STATUS(QUIC_STATUS_PENDING, Entries[i].Status);
+    }
+
+    //
+    // Every entry completes exactly once, and all the data arrives.
+    //
+    TEST_TRUE(Context.AllSendsComplete.WaitTimeout(TestWaitTimeout));
+    TEST_TRUE(Context.AllStreamsFinished.WaitTimeout(TestWaitTimeout));
+    for (uint32_t i = 0; i < StreamSendBatchTestContext::EntryCount; ++i) {
+        TEST_EQUAL(1, Context.SendCompleteCount[i]);
+    }
+    TEST_EQUAL(0, Context.SendCanceledCount);
+    TEST_EQUAL(
+        (uint64_t)StreamSendBatchTestContext::EntryCount * StreamSendBatchTestContext::SendLength,
+        Context.ReceivedLength);
+}
+
 #endif // QUIC_API_ENABLE_PREVIEW_FEATURES
@@ -314,6 +314,21 @@ QuicTraceGlobalEvent(
             case QUIC_PERF_COUNTER_LISTEN_QUEUE_DEPTH:
                 printf("    Current listeners queued for processing:            ");
                 break;
+            case QUIC_PERF_COUNTER_WORK_DRAIN_BUDGET:
+                printf("    Current sum of worker drain budgets:                ");
+                break;
+            case QUIC_PERF_COUNTER_UDP_RECV_COALESCED:
+                printf("    Total coalesced UDP receives:                       ");
+                break;
+            case QUIC_PERF_COUNTER_UDP_RECV_COALESCED_SEGMENTS:
+                printf("    Total UDP datagrams in coalesced receives:          ");
+                break;
+            case QUIC_PERF_COUNTER_WORK_CONN_STOLEN:
+                printf("    Total connections stolen by idle workers:           ");
+                break;
+            case QUIC_PERF_COUNTER_WORK_CONN_MIGRATED:
+                printf("    Total connections handed over to idle workers:      ");
+                break;
             default:
                 printf("    Unknown:                                            ");
                 break;